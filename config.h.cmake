@@ -241,6 +241,7 @@
 #cmakedefine HAVE_RENAME 1
 #cmakedefine HAVE_RINT 1
 #cmakedefine HAVE_RWLOCK_INIT 1
+#cmakedefine HAVE_SCHED_GETCPU 1
 #cmakedefine HAVE_SCHED_YIELD 1
 #cmakedefine HAVE_SELECT 1
 #cmakedefine HAVE_SETFD 1
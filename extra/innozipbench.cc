@@ -0,0 +1,371 @@
+/*
+   Copyright (c) 2016, Facebook, Inc. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+/*
+  InnoDB page compression benchmark.
+
+  Reads the B-tree pages of uncompressed tablespace files or page dumps,
+  and compresses the record area of every page with each of the page
+  compression algorithms of innodb_compression_algorithm. Prints the
+  compression ratio, the share of pages that would fit in each
+  KEY_BLOCK_SIZE and the compression and decompression throughput.
+
+  With --dict-size a zstd dictionary trained on the pages is measured
+  too, to estimate what a per-table dictionary would gain.
+*/
+
+#include <my_config.h>
+#include <my_global.h>
+#include <my_sys.h>
+#include <my_getopt.h>
+#include <m_string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#include <lz4.h>
+#include <zstd.h>
+#include <zdict.h>
+#include <string>
+#include <vector>
+
+/* Offsets of the tablespace page format, see fil0fil.h and page0page.h */
+#define FIL_PAGE_TYPE           24
+#define FIL_PAGE_INDEX          17855
+#define FIL_PAGE_DATA           38
+#define FIL_PAGE_DATA_END       8
+#define PAGE_HEADER_SIZE        56
+#define PAGE_DATA               (FIL_PAGE_DATA + PAGE_HEADER_SIZE)
+
+static ulong page_size= 16384;
+static uint level= 6;
+static uint rounds= 10;
+static ulong dict_size= 0;
+
+static struct my_option innozipbench_options[]=
+{
+  {"help", '?', "Displays this help and exits.",
+    0, 0, 0, GET_NO_ARG, NO_ARG, 0, 0, 0, 0, 0, 0},
+  {"page-size", 'p', "Page size of the files.",
+    &page_size, &page_size, 0, GET_ULONG, REQUIRED_ARG,
+    16384, 4096, 65536, 0, 1024, 0},
+  {"level", 'l', "Compression level of zlib and zstd, as in "
+    "innodb_compression_level.",
+    &level, &level, 0, GET_UINT, REQUIRED_ARG, 6, 1, 9, 0, 1, 0},
+  {"rounds", 'n', "Times every page is compressed and decompressed.",
+    &rounds, &rounds, 0, GET_UINT, REQUIRED_ARG, 10, 1, 1000, 0, 1, 0},
+  {"dict-size", 'd', "Also measure zstd with a dictionary of this size "
+    "trained on the pages. 0 disables it.",
+    &dict_size, &dict_size, 0, GET_ULONG, REQUIRED_ARG,
+    0, 0, 1024 * 1024, 0, 1, 0},
+  {0, 0, 0, 0, 0, 0, GET_NO_ARG, NO_ARG, 0, 0, 0, 0, 0, 0}
+};
+
+static void usage(void)
+{
+  printf("InnoDB page compression benchmark.\n");
+  printf("Usage: %s [-p <page size>] [-l <level>] [-n <rounds>] "
+         "[-d <dictionary size>] <file> ...\n", my_progname);
+  my_print_help(innozipbench_options);
+  my_print_variables(innozipbench_options);
+}
+
+extern "C" my_bool
+innozipbench_get_one_option(int optid,
+                            const struct my_option *opt MY_ATTRIBUTE((unused)),
+                            char *argument MY_ATTRIBUTE((unused)))
+{
+  if (optid == '?')
+  {
+    usage();
+    exit(0);
+  }
+  return 0;
+}
+
+
+/** A page compression algorithm under test. */
+class Codec
+{
+public:
+  Codec(const char *name) : m_name(name) {}
+  virtual ~Codec() {}
+
+  const char *name() const { return m_name; }
+
+  /** @return compressed length, or 0 on failure */
+  virtual size_t compress(const uchar *src, size_t len,
+                          uchar *dst, size_t capacity)= 0;
+
+  /** @return decompressed length, or 0 on failure */
+  virtual size_t decompress(const uchar *src, size_t len,
+                            uchar *dst, size_t capacity)= 0;
+
+private:
+  const char *m_name;
+};
+
+
+class Zlib_codec : public Codec
+{
+public:
+  Zlib_codec() : Codec("zlib") {}
+
+  size_t compress(const uchar *src, size_t len, uchar *dst, size_t capacity)
+  {
+    uLongf out= capacity;
+    if (compress2(dst, &out, src, len, level) != Z_OK)
+      return 0;
+    return out;
+  }
+
+  size_t decompress(const uchar *src, size_t len, uchar *dst, size_t capacity)
+  {
+    uLongf out= capacity;
+    if (uncompress(dst, &out, src, len) != Z_OK)
+      return 0;
+    return out;
+  }
+};
+
+
+class Lz4_codec : public Codec
+{
+public:
+  Lz4_codec() : Codec("lz4") {}
+
+  size_t compress(const uchar *src, size_t len, uchar *dst, size_t capacity)
+  {
+    int out= LZ4_compress_default((const char*) src, (char*) dst,
+                                  (int) len, (int) capacity);
+    return out > 0 ? out : 0;
+  }
+
+  size_t decompress(const uchar *src, size_t len, uchar *dst, size_t capacity)
+  {
+    int out= LZ4_decompress_safe((const char*) src, (char*) dst,
+                                 (int) len, (int) capacity);
+    return out > 0 ? out : 0;
+  }
+};
+
+
+class Zstd_codec : public Codec
+{
+public:
+  Zstd_codec(const char *name, const std::string &dict)
+    : Codec(name), m_cctx(ZSTD_createCCtx()), m_dctx(ZSTD_createDCtx()),
+      m_cdict(NULL), m_ddict(NULL)
+  {
+    if (!dict.empty())
+    {
+      m_cdict= ZSTD_createCDict(dict.data(), dict.size(), level);
+      m_ddict= ZSTD_createDDict(dict.data(), dict.size());
+    }
+  }
+
+  ~Zstd_codec()
+  {
+    ZSTD_freeCDict(m_cdict);
+    ZSTD_freeDDict(m_ddict);
+    ZSTD_freeCCtx(m_cctx);
+    ZSTD_freeDCtx(m_dctx);
+  }
+
+  size_t compress(const uchar *src, size_t len, uchar *dst, size_t capacity)
+  {
+    size_t out= m_cdict
+      ? ZSTD_compress_usingCDict(m_cctx, dst, capacity, src, len, m_cdict)
+      : ZSTD_compressCCtx(m_cctx, dst, capacity, src, len, level);
+    return ZSTD_isError(out) ? 0 : out;
+  }
+
+  size_t decompress(const uchar *src, size_t len, uchar *dst, size_t capacity)
+  {
+    size_t out= m_ddict
+      ? ZSTD_decompress_usingDDict(m_dctx, dst, capacity, src, len, m_ddict)
+      : ZSTD_decompressDCtx(m_dctx, dst, capacity, src, len);
+    return ZSTD_isError(out) ? 0 : out;
+  }
+
+private:
+  ZSTD_CCtx *m_cctx;
+  ZSTD_DCtx *m_dctx;
+  ZSTD_CDict *m_cdict;
+  ZSTD_DDict *m_ddict;
+};
+
+
+/** Append the record area of the index pages of a file to pages. */
+static bool read_index_pages(const char *filename,
+                             std::vector<std::string> *pages)
+{
+  FILE *file= my_fopen(filename, O_RDONLY | O_BINARY, MYF(MY_WME));
+  if (!file)
+    return true;
+
+  std::vector<uchar> page(page_size);
+  while (fread(&page[0], 1, page_size, file) == page_size)
+  {
+    if ((page[FIL_PAGE_TYPE] << 8 | page[FIL_PAGE_TYPE + 1]) !=
+        FIL_PAGE_INDEX)
+      continue;
+    pages->push_back(std::string((const char*) &page[PAGE_DATA],
+                                 page_size - PAGE_DATA - FIL_PAGE_DATA_END));
+  }
+
+  my_fclose(file, MYF(0));
+  return false;
+}
+
+
+static void run_codec(Codec *codec, const std::vector<std::string> &pages)
+{
+  static const ulong block_sizes[]= { 8192, 4096, 2048, 1024 };
+  ulong fits[array_elements(block_sizes)]= { 0 };
+  std::vector<std::string> zipped(pages.size());
+  std::vector<uchar> buf(2 * page_size);
+  ulonglong in_bytes= 0, out_bytes= 0;
+
+  ulonglong start= my_micro_time();
+  for (uint r= 0; r < rounds; r++)
+  {
+    for (size_t i= 0; i < pages.size(); i++)
+    {
+      size_t len= codec->compress((const uchar*) pages[i].data(),
+                                  pages[i].size(), &buf[0], buf.size());
+      if (r == 0)
+        zipped[i].assign((const char*) &buf[0], len);
+    }
+  }
+  ulonglong compress_usecs= my_micro_time() - start;
+
+  start= my_micro_time();
+  for (uint r= 0; r < rounds; r++)
+  {
+    for (size_t i= 0; i < pages.size(); i++)
+    {
+      size_t len= codec->decompress((const uchar*) zipped[i].data(),
+                                    zipped[i].size(), &buf[0], buf.size());
+      if (r == 0 && (len != pages[i].size() ||
+                     memcmp(&buf[0], pages[i].data(), len)))
+      {
+        fprintf(stderr, "Error: %s failed to restore page %lu\n",
+                codec->name(), (ulong) i);
+        exit(1);
+      }
+    }
+  }
+  ulonglong decompress_usecs= my_micro_time() - start;
+
+  for (size_t i= 0; i < pages.size(); i++)
+  {
+    in_bytes+= pages[i].size();
+    out_bytes+= zipped[i].size();
+    for (uint b= 0; b < array_elements(block_sizes); b++)
+    {
+      /* The page header is stored uncompressed. */
+      if (zipped[i].size() + PAGE_DATA + FIL_PAGE_DATA_END <= block_sizes[b])
+        fits[b]++;
+    }
+  }
+
+  printf("%-10s %6.2f %9.1f %9.1f", codec->name(),
+         out_bytes ? (double) in_bytes / out_bytes : 0.0,
+         compress_usecs ? (double) in_bytes * rounds / compress_usecs : 0.0,
+         decompress_usecs ?
+         (double) in_bytes * rounds / decompress_usecs : 0.0);
+  for (uint b= 0; b < array_elements(block_sizes); b++)
+    printf(" %5.1f%%", 100.0 * fits[b] / pages.size());
+  printf("\n");
+}
+
+
+int main(int argc, char **argv)
+{
+  std::vector<std::string> pages;
+  std::string dict;
+
+  MY_INIT(argv[0]);
+
+  if (handle_options(&argc, &argv, innozipbench_options,
+                     innozipbench_get_one_option))
+    exit(1);
+
+  if (!argc)
+  {
+    fprintf(stderr, "Error: file name missing\n");
+    usage();
+    exit(1);
+  }
+
+  for (int i= 0; i < argc; i++)
+  {
+    if (read_index_pages(argv[i], &pages))
+      exit(1);
+  }
+
+  if (pages.empty())
+  {
+    fprintf(stderr, "Error: no index pages found\n");
+    exit(1);
+  }
+
+  if (dict_size)
+  {
+    std::string samples;
+    std::vector<size_t> sizes;
+
+    for (size_t i= 0; i < pages.size(); i++)
+    {
+      samples.append(pages[i]);
+      sizes.push_back(pages[i].size());
+    }
+
+    dict.resize(dict_size);
+    size_t len= ZDICT_trainFromBuffer(&dict[0], dict.size(), samples.data(),
+                                      &sizes[0], (uint) sizes.size());
+    if (ZDICT_isError(len))
+    {
+      fprintf(stderr, "Error: training the dictionary failed: %s\n",
+              ZDICT_getErrorName(len));
+      exit(1);
+    }
+    dict.resize(len);
+  }
+
+  printf("# %lu index pages, level %u, %u rounds\n",
+         (ulong) pages.size(), level, rounds);
+  printf("%-10s %6s %9s %9s %6s %6s %6s %6s\n", "algorithm", "ratio",
+         "comp MB/s", "dec MB/s", "8K", "4K", "2K", "1K");
+
+  Zlib_codec zlib;
+  Lz4_codec lz4;
+  Zstd_codec zstd("zstd", std::string());
+  run_codec(&zlib, pages);
+  run_codec(&lz4, pages);
+  run_codec(&zstd, pages);
+
+  if (!dict.empty())
+  {
+    Zstd_codec zstd_dict("zstd+dict", dict);
+    run_codec(&zstd_dict, pages);
+  }
+
+  my_end(0);
+  return 0;
+}
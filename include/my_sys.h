@@ -754,6 +754,22 @@ extern my_bool radixsort_is_appliccable(uint n_items, size_t size_of_element);
 extern void my_string_ptr_sort(uchar *base,uint items,size_t size);
 extern void radixsort_for_str_ptr(uchar* base[], uint number_of_elements,
 				  size_t size_of_element,uchar *buffer[]);
+
+/*
+  Pointer to a fixed length string, with the first bytes of the string
+  as a big-endian number: comparing prefixes compares these bytes.
+*/
+#define SORT_PREFIX_LENGTH 8
+typedef struct st_sort_prefixed_ptr
+{
+  ulonglong prefix;
+  uchar *ptr;
+} SORT_PREFIXED_PTR;
+
+extern void radixsort_for_prefixed_str_ptr(SORT_PREFIXED_PTR *base,
+                                           uint number_of_elements,
+                                           size_t size_of_element,
+                                           SORT_PREFIXED_PTR *buffer);
 extern qsort_t my_qsort(void *base_ptr, size_t total_elems, size_t size,
                         qsort_cmp cmp);
 extern qsort_t my_qsort2(void *base_ptr, size_t total_elems, size_t size,
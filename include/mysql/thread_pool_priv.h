@@ -96,6 +96,8 @@ bool init_new_connection_handler_thread();
 bool setup_connection_thread_globals(THD *thd);
 /* Prepare connection as part of connection set-up */
 bool thd_prepare_connection(THD *thd);
+/* Log in a new connection and set up its per user session state */
+bool thd_setup_connection(THD *thd, ulong launch_time);
 /* Release auditing before executing statement */
 void mysql_audit_release(THD *thd);
 /* Check if connection is still alive */
@@ -104,6 +106,10 @@ bool thd_is_connection_alive(THD *thd);
 void close_connection(THD *thd, uint errcode);
 /* End the connection before closing it */
 void end_connection(THD *thd);
+/* Account network statistics of a connection that is about to end */
+void thd_update_net_stats(THD *thd);
+/* Release the connection from admission control */
+int multi_tenancy_close_connection(THD *thd);
 /* Release resources of the THD object */
 void thd_release_resources(THD *thd);
 /* Decrement connection counter */
@@ -57,3 +57,47 @@ void radixsort_for_str_ptr(uchar **base, uint number_of_elements, size_t size_of
   next:;
   }
 }
+
+/*
+  As radixsort_for_str_ptr(), but the first SORT_PREFIX_LENGTH bytes of
+  the strings are read from the prefixes, without touching the strings.
+*/
+
+static inline uint prefixed_str_byte(const SORT_PREFIXED_PTR *elem, int pos)
+{
+  if (pos < SORT_PREFIX_LENGTH)
+    return (uint) (elem->prefix >> (8 * (SORT_PREFIX_LENGTH - 1 - pos))) &
+           0xff;
+  return elem->ptr[pos];
+}
+
+void radixsort_for_prefixed_str_ptr(SORT_PREFIXED_PTR *base,
+                                    uint number_of_elements,
+                                    size_t size_of_element,
+                                    SORT_PREFIXED_PTR *buffer)
+{
+  SORT_PREFIXED_PTR *end,*ptr,*buffer_ptr;
+  uint32 *count_ptr,*count_end,count[256];
+  int pass;
+
+  end=base+number_of_elements; count_end=count+256;
+  for (pass=(int) size_of_element-1 ; pass >= 0 ; pass--)
+  {
+    memset(count, 0, sizeof(uint32)*256);
+    for (ptr= base ; ptr < end ; ptr++)
+      count[prefixed_str_byte(ptr, pass)]++;
+    if (count[0] == number_of_elements)
+      goto next;
+    for (count_ptr=count+1 ; count_ptr < count_end ; count_ptr++)
+    {
+      if (*count_ptr == number_of_elements)
+	goto next;
+      (*count_ptr)+= *(count_ptr-1);
+    }
+    for (ptr= end ; ptr-- != base ;)
+      buffer[--count[prefixed_str_byte(ptr, pass)]]= *ptr;
+    for (ptr=base, buffer_ptr=buffer ; ptr < end ;)
+      (*ptr++) = *buffer_ptr++;
+  next:;
+  }
+}
@@ -0,0 +1,91 @@
+/* Copyright (c) 2016, Facebook, Inc. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#ifndef THREADPOOL_INCLUDED
+#define THREADPOOL_INCLUDED
+
+#include <my_global.h>
+#include <my_pthread.h>
+#include <mysql/thread_pool_priv.h>
+
+/*
+  Pool-of-threads scheduler.
+
+  Connections are spread over thread_pool_size thread groups (by default
+  one per CPU).  Each group owns an epoll descriptor, a queue of
+  connections that have pending requests and a small set of worker
+  threads.  At any time one of the workers acts as the listener and waits
+  in epoll_wait() for network events; the others execute requests.  A
+  group tries to keep exactly one thread actively executing (plus
+  thread_pool_oversubscribe extra ones); threads that block inside the
+  server report it through thd_wait_begin()/thd_wait_end() so that
+  another worker can be woken up.
+
+  A timer thread checks all groups every thread_pool_stall_limit
+  milliseconds.  A group that has not dequeued anything since the last
+  check while its queue is non-empty is considered stalled and gets an
+  additional worker.  The same thread enforces wait_timeout for idle
+  connections.
+*/
+
+#define MAX_THREAD_GROUPS 1024
+
+enum tp_high_prio_mode
+{
+  TP_HIGH_PRIO_MODE_TRANSACTIONS,
+  TP_HIGH_PRIO_MODE_STATEMENTS,
+  TP_HIGH_PRIO_MODE_NONE
+};
+
+/* Configuration, see the system variables in threadpool_common.cc */
+extern uint threadpool_size;
+extern uint threadpool_stall_limit;
+extern uint threadpool_max_threads;
+extern uint threadpool_oversubscribe;
+extern uint threadpool_idle_timeout;
+extern uint threadpool_high_prio_tickets;
+extern ulong threadpool_high_prio_mode;
+
+/* Counters exposed as status variables */
+struct TP_STATISTICS
+{
+  /* Number of worker threads in all groups */
+  volatile int32 num_worker_threads;
+  /* Number of times the timer thread detected a stalled group */
+  volatile int64 stall_count;
+  /* Number of connections dequeued from the high priority queue */
+  volatile int64 high_prio_dequeues;
+  /* Number of connections dequeued from the normal queue */
+  volatile int64 low_prio_dequeues;
+};
+
+extern TP_STATISTICS tp_stats;
+
+/* Scheduler entry points, threadpool_unix.cc */
+bool tp_init();
+void tp_end();
+void tp_add_connection(THD *thd);
+void tp_wait_begin(THD *thd, int wait_type);
+void tp_wait_end(THD *thd);
+void tp_post_kill_notification(THD *thd);
+int tp_get_idle_thread_count();
+
+/* Connection life cycle, threadpool_common.cc */
+int threadpool_add_connection(THD *thd, bool *logged_in);
+int threadpool_process_request(THD *thd);
+void threadpool_remove_connection(THD *thd, bool logged_in);
+bool threadpool_connection_in_transaction(THD *thd);
+
+#endif
@@ -0,0 +1,375 @@
+/* Copyright (c) 2016, Facebook, Inc. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  Pool-of-threads scheduler plugin: connection life cycle, system and
+  status variables and the plugin descriptor.  The scheduling itself
+  lives in threadpool_unix.cc.
+*/
+
+#include "threadpool.h"
+#include <mysql/plugin.h>
+#include <mysql/service_thread_scheduler.h>
+
+uint threadpool_size;
+uint threadpool_stall_limit;
+uint threadpool_max_threads;
+uint threadpool_oversubscribe;
+uint threadpool_idle_timeout;
+uint threadpool_high_prio_tickets;
+ulong threadpool_high_prio_mode;
+
+TP_STATISTICS tp_stats;
+
+/**
+  Attach the connection to the current worker thread.
+
+  The THD may have been served by a different worker before, so the
+  thread local pointers and the stack start used for overrun checks have
+  to be re-established every time.
+*/
+
+static bool thread_attach(THD *thd, char *stack_start)
+{
+  thd_set_thread_stack(thd, stack_start);
+  thd_clear_errors(thd);
+  return thd_store_globals(thd) != 0;
+}
+
+
+/**
+  Detach the connection from the current worker thread.
+
+  mysys_var points into the worker's thread local storage; clear it
+  under LOCK_thd_data so that KILL never signals a condition of a worker
+  that is already serving another connection.
+*/
+
+static void thread_detach(THD *thd)
+{
+  thd_lock_data(thd);
+  thd_set_mysys_var(thd, NULL);
+  thd_unlock_data(thd);
+}
+
+
+/**
+  Authenticate a new connection.
+
+  @param[out] logged_in  Set if login succeeded, even when the connection
+                         died right after it and still has to be removed
+
+  @retval 0  Connection is established and waits for its first command
+  @retval 1  Login failed, the caller must remove the connection
+*/
+
+int threadpool_add_connection(THD *thd, bool *logged_in)
+{
+  int retval= 1;
+  char stack_start;
+
+  *logged_in= false;
+  if (thread_attach(thd, &stack_start))
+    return 1;
+
+  /* The pool creates no thread per connection, so no launch time */
+  if (!thd_setup_connection(thd, 0))
+  {
+    *logged_in= true;
+    if (thd_is_connection_alive(thd))
+    {
+      retval= 0;
+      /* Shown as "reading" in SHOW PROCESSLIST while idle in the pool */
+      thd_set_net_read_write(thd, 1);
+    }
+  }
+
+  thread_detach(thd);
+  return retval;
+}
+
+
+/**
+  Execute the commands pending on a connection.
+
+  Commands already buffered in the network layer (pipelined by the
+  client) are executed right away instead of going back through epoll.
+
+  @retval 0  Connection is still alive
+  @retval 1  Connection has to be closed
+*/
+
+int threadpool_process_request(THD *thd)
+{
+  int retval= 0;
+  char stack_start;
+
+  if (thread_attach(thd, &stack_start))
+    return 1;
+
+  for (;;)
+  {
+    if (!thd_is_connection_alive(thd))
+    {
+      retval= 1;
+      break;
+    }
+
+    mysql_audit_release(thd);
+    if (do_command(thd))
+    {
+      retval= 1;
+      break;
+    }
+
+    if (!thd_connection_has_data(thd))
+      break;
+  }
+
+  if (!retval)
+    thd_set_net_read_write(thd, 1);
+
+  thread_detach(thd);
+  return retval;
+}
+
+
+/**
+  Close a connection and free its THD.
+
+  Mirrors the tail of do_handle_one_connection() and
+  one_thread_per_connection_end(). A connection that never logged in was
+  not counted for its user nor admitted, so only the common tail runs.
+*/
+
+void threadpool_remove_connection(THD *thd, bool logged_in)
+{
+  char stack_start;
+
+  thread_attach(thd, &stack_start);
+  thd_set_net_read_write(thd, 0);
+
+  if (logged_in)
+  {
+    thd_update_net_stats(thd);
+    multi_tenancy_close_connection(thd);
+    end_connection(thd);
+  }
+
+  /* Killed only now so that end_connection() counts just real aborts */
+  thd_set_killed(thd);
+  close_connection(thd, 0);
+
+  thd_release_resources(thd);
+  remove_global_thread(thd);
+  dec_connection_count();
+  destroy_thd(thd);
+}
+
+
+/**
+  Whether the next request of a connection should go to the high
+  priority queue.
+*/
+
+bool threadpool_connection_in_transaction(THD *thd)
+{
+  switch (threadpool_high_prio_mode)
+  {
+  case TP_HIGH_PRIO_MODE_STATEMENTS:
+    return true;
+  case TP_HIGH_PRIO_MODE_NONE:
+    return false;
+  default:
+    return thd_is_transaction_active(thd);
+  }
+}
+
+
+/*
+  Login and command execution happen on pool threads, so there is
+  neither a per-connection thread to initialize nor one to end.
+*/
+
+static bool tp_init_new_connection_thread()
+{
+  return 0;
+}
+
+
+static bool tp_end_thread(THD *thd, bool cache_thread)
+{
+  return 0;
+}
+
+
+static scheduler_functions tp_scheduler_functions=
+{
+  0,                                    // max_threads
+  NULL,                                 // init
+  tp_init_new_connection_thread,        // init_new_connection_thread
+  tp_add_connection,                    // add_connection
+  tp_wait_begin,                        // thd_wait_begin
+  tp_wait_end,                          // thd_wait_end
+  tp_post_kill_notification,            // post_kill_notification
+  tp_end_thread,                        // end_thread
+  tp_end                                // end
+};
+
+
+static int threadpool_plugin_init(void *p)
+{
+  DBUG_ENTER("threadpool_plugin_init");
+
+  if (!threadpool_size)
+    threadpool_size= MY_MIN(my_getncpus(), MAX_THREAD_GROUPS);
+
+  if (tp_init())
+  {
+    sql_print_error("Thread pool: failed to initialize %u thread groups",
+                    threadpool_size);
+    DBUG_RETURN(1);
+  }
+
+  tp_scheduler_functions.max_threads= threadpool_max_threads;
+  if (my_thread_scheduler_set(&tp_scheduler_functions))
+  {
+    tp_end();
+    DBUG_RETURN(1);
+  }
+  DBUG_RETURN(0);
+}
+
+
+static int threadpool_plugin_deinit(void *p)
+{
+  DBUG_ENTER("threadpool_plugin_deinit");
+  my_thread_scheduler_reset();
+  tp_end();
+  DBUG_RETURN(0);
+}
+
+
+static MYSQL_SYSVAR_UINT(size, threadpool_size,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of thread groups in the pool. Each group has its own epoll "
+  "descriptor and normally runs one active thread. 0 (default) uses the "
+  "number of CPUs.",
+  NULL, NULL, 0, 0, MAX_THREAD_GROUPS, 1);
+
+static MYSQL_SYSVAR_UINT(stall_limit, threadpool_stall_limit,
+  PLUGIN_VAR_RQCMDARG,
+  "Time in milliseconds after which a thread group that made no progress "
+  "while requests are queued is considered stalled and gets an extra "
+  "worker thread. Also the resolution of wait_timeout enforcement.",
+  NULL, NULL, 500, 10, UINT_MAX, 1);
+
+static MYSQL_SYSVAR_UINT(max_threads, threadpool_max_threads,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Maximum number of worker threads in the pool.",
+  NULL, NULL, 100000, 1, 100000, 1);
+
+static MYSQL_SYSVAR_UINT(oversubscribe, threadpool_oversubscribe,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of additional threads per group that may execute requests "
+  "concurrently.",
+  NULL, NULL, 3, 1, 1000, 1);
+
+static MYSQL_SYSVAR_UINT(idle_timeout, threadpool_idle_timeout,
+  PLUGIN_VAR_RQCMDARG,
+  "Time in seconds after which an idle worker thread exits.",
+  NULL, NULL, 60, 1, UINT_MAX, 1);
+
+static MYSQL_SYSVAR_UINT(high_prio_tickets, threadpool_high_prio_tickets,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of times in a row a connection may be put into the high "
+  "priority queue before it has to wait in the normal queue. Prevents "
+  "long transactions from starving new ones.",
+  NULL, NULL, UINT_MAX, 0, UINT_MAX, 1);
+
+static const char *high_prio_mode_names[]=
+{
+  "transactions", "statements", "none", NullS
+};
+
+static TYPELIB high_prio_mode_typelib=
+{
+  array_elements(high_prio_mode_names) - 1, "",
+  high_prio_mode_names, NULL
+};
+
+static MYSQL_SYSVAR_ENUM(high_prio_mode, threadpool_high_prio_mode,
+  PLUGIN_VAR_RQCMDARG,
+  "Which requests go to the high priority queue: 'transactions' for "
+  "connections with an active transaction, 'statements' for all of "
+  "them, 'none' to use a single queue.",
+  NULL, NULL, TP_HIGH_PRIO_MODE_TRANSACTIONS, &high_prio_mode_typelib);
+
+static struct st_mysql_sys_var *threadpool_system_variables[]=
+{
+  MYSQL_SYSVAR(size),
+  MYSQL_SYSVAR(stall_limit),
+  MYSQL_SYSVAR(max_threads),
+  MYSQL_SYSVAR(oversubscribe),
+  MYSQL_SYSVAR(idle_timeout),
+  MYSQL_SYSVAR(high_prio_tickets),
+  MYSQL_SYSVAR(high_prio_mode),
+  NULL
+};
+
+
+static int show_idle_threads(MYSQL_THD thd, SHOW_VAR *var, char *buff)
+{
+  var->type= SHOW_INT;
+  var->value= buff;
+  *(int *) buff= tp_get_idle_thread_count();
+  return 0;
+}
+
+static SHOW_VAR threadpool_status_variables[]=
+{
+  {"Thread_pool_threads",
+   (char *) &tp_stats.num_worker_threads, SHOW_INT},
+  {"Thread_pool_idle_threads", (char *) &show_idle_threads, SHOW_FUNC},
+  {"Thread_pool_stalls", (char *) &tp_stats.stall_count, SHOW_LONGLONG},
+  {"Thread_pool_high_prio_dequeues",
+   (char *) &tp_stats.high_prio_dequeues, SHOW_LONGLONG},
+  {"Thread_pool_low_prio_dequeues",
+   (char *) &tp_stats.low_prio_dequeues, SHOW_LONGLONG},
+  {NullS, NullS, SHOW_LONG}
+};
+
+
+static struct st_mysql_daemon threadpool_plugin=
+{ MYSQL_DAEMON_INTERFACE_VERSION };
+
+mysql_declare_plugin(thread_pool)
+{
+  MYSQL_DAEMON_PLUGIN,
+  &threadpool_plugin,
+  "thread_pool",
+  "Facebook",
+  "Pool-of-threads connection scheduler",
+  PLUGIN_LICENSE_GPL,
+  threadpool_plugin_init,       /* Plugin Init */
+  threadpool_plugin_deinit,     /* Plugin Deinit */
+  0x0100 /* 1.0 */,
+  threadpool_status_variables,  /* status variables */
+  threadpool_system_variables,  /* system variables */
+  NULL,                         /* config options */
+  /* Connections cannot be moved between schedulers at runtime */
+  PLUGIN_OPT_NO_INSTALL | PLUGIN_OPT_NO_UNINSTALL,
+}
+mysql_declare_plugin_end;
@@ -0,0 +1,909 @@
+/* Copyright (c) 2016, Facebook, Inc. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  epoll based thread groups for the pool-of-threads scheduler.
+  See threadpool.h for an overview.
+*/
+
+#include "threadpool.h"
+#include <my_atomic.h>
+#include <mysql/plugin.h>
+#include "sql_plist.h"
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+struct thread_group_t;
+
+/* Per-connection scheduler state, stored as THD scheduler data */
+struct connection_t
+{
+  THD *thd;
+  thread_group_t *thread_group;
+  /* Link in the group's request queues */
+  connection_t *next_in_queue;
+  connection_t **prev_in_queue;
+  /* Link in the list of all connections of the group */
+  connection_t *next_in_group;
+  connection_t **prev_in_group;
+  /* Absolute time in microseconds when wait_timeout expires, 0 if busy */
+  volatile ulonglong abs_wait_timeout;
+  /* Remaining consecutive high priority dequeues */
+  uint tickets;
+  bool logged_in;
+  bool bound_to_poll_descriptor;
+};
+
+typedef I_P_List<connection_t,
+                 I_P_List_adapter<connection_t,
+                                  &connection_t::next_in_queue,
+                                  &connection_t::prev_in_queue>,
+                 I_P_List_null_counter,
+                 I_P_List_fast_push_back<connection_t> >
+  connection_queue_t;
+
+typedef I_P_List<connection_t,
+                 I_P_List_adapter<connection_t,
+                                  &connection_t::next_in_group,
+                                  &connection_t::prev_in_group> >
+  connection_list_t;
+
+struct worker_thread_t
+{
+  thread_group_t *thread_group;
+  worker_thread_t *next_in_list;
+  worker_thread_t **prev_in_list;
+  mysql_cond_t cond;
+  /* Set by the thread that removed us from the waiting list */
+  bool woken;
+};
+
+typedef I_P_List<worker_thread_t,
+                 I_P_List_adapter<worker_thread_t,
+                                  &worker_thread_t::next_in_list,
+                                  &worker_thread_t::prev_in_list> >
+  worker_list_t;
+
+struct thread_group_t
+{
+  mysql_mutex_t mutex;
+  /* Connections in a transaction, served before the normal queue */
+  connection_queue_t high_prio_queue;
+  connection_queue_t queue;
+  connection_list_t connections;
+  worker_list_t waiting_threads;
+  /* Thread currently blocked in epoll_wait(), if any */
+  worker_thread_t *listener;
+  int pollfd;
+  /* Written to on shutdown to wake up the listener */
+  int shutdown_pipe[2];
+  int thread_count;
+  /* Threads that are not waiting, listening or blocked in the server */
+  int active_thread_count;
+  int waiting_thread_count;
+  int connection_count;
+  /* Progress counters, reset by every stall check */
+  ulonglong io_event_count;
+  ulonglong queue_event_count;
+  ulonglong last_thread_creation_time;
+  bool stalled;
+  bool shutdown;
+} MY_ALIGNED(CPU_LEVEL1_DCACHE_LINESIZE);
+
+static thread_group_t *all_groups;
+static uint group_count;
+static volatile int32 next_group;
+
+static struct pool_timer_t
+{
+  mysql_mutex_t mutex;
+  mysql_cond_t cond;
+  pthread_t thread_id;
+  ulonglong next_timeout_check;
+  bool shutdown;
+} pool_timer;
+
+/* Maximum number of events fetched by one epoll_wait() call */
+#define MAX_EVENTS 16
+
+#ifdef HAVE_PSI_INTERFACE
+static PSI_mutex_key key_group_mutex;
+static PSI_mutex_key key_timer_mutex;
+
+static PSI_mutex_info all_threadpool_mutexes[]=
+{
+  { &key_group_mutex, "group_mutex", 0},
+  { &key_timer_mutex, "timer_mutex", PSI_FLAG_GLOBAL}
+};
+
+static PSI_cond_key key_worker_cond;
+static PSI_cond_key key_timer_cond;
+
+static PSI_cond_info all_threadpool_conds[]=
+{
+  { &key_worker_cond, "worker_cond", 0},
+  { &key_timer_cond, "timer_cond", PSI_FLAG_GLOBAL}
+};
+
+static PSI_thread_key key_worker_thread;
+static PSI_thread_key key_timer_thread;
+
+static PSI_thread_info all_threadpool_threads[]=
+{
+  { &key_worker_thread, "worker_thread", 0},
+  { &key_timer_thread, "timer_thread", PSI_FLAG_GLOBAL}
+};
+
+static void init_threadpool_psi_keys(void)
+{
+  const char* category= "threadpool";
+  int count;
+
+  count= array_elements(all_threadpool_mutexes);
+  mysql_mutex_register(category, all_threadpool_mutexes, count);
+
+  count= array_elements(all_threadpool_conds);
+  mysql_cond_register(category, all_threadpool_conds, count);
+
+  count= array_elements(all_threadpool_threads);
+  mysql_thread_register(category, all_threadpool_threads, count);
+}
+#endif /* HAVE_PSI_INTERFACE */
+
+
+/**
+  Register the connection with the group's epoll descriptor, or re-arm
+  it.  EPOLLONESHOT guarantees that only one thread gets an event for a
+  given connection until it is re-armed here.
+*/
+
+static int start_io(connection_t *connection)
+{
+  struct epoll_event ev;
+  int op= connection->bound_to_poll_descriptor ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+
+  ev.events= EPOLLIN | EPOLLONESHOT;
+  ev.data.ptr= connection;
+  if (epoll_ctl(connection->thread_group->pollfd, op,
+                thd_get_fd(connection->thd), &ev))
+    return 1;
+  connection->bound_to_poll_descriptor= true;
+  return 0;
+}
+
+
+/**
+  Time in microseconds that has to pass since the last thread creation
+  before the group may create another worker. Throttling avoids thread
+  explosions when many requests block at the same time.
+*/
+
+static ulonglong thread_creation_throttle(thread_group_t *group)
+{
+  if (group->thread_count < 4)
+    return 0;
+  if (group->thread_count < 8)
+    return 50 * 1000;
+  if (group->thread_count < 16)
+    return 100 * 1000;
+  return 200 * 1000;
+}
+
+
+static void *worker_main(void *param);
+
+/**
+  Start a new worker thread in the group.
+
+  @note Must be called with the group mutex held.
+*/
+
+static int create_worker(thread_group_t *group)
+{
+  pthread_t thread_id;
+  int err;
+
+  mysql_mutex_assert_owner(&group->mutex);
+
+  if ((uint) my_atomic_load32(&tp_stats.num_worker_threads) >=
+      threadpool_max_threads)
+    return 1;
+
+  err= mysql_thread_create(key_worker_thread, &thread_id,
+                           get_connection_attrib(), worker_main, group);
+  if (err)
+  {
+    sql_print_error("Thread pool: can't create worker thread (errno= %d)",
+                    err);
+    return err;
+  }
+
+  group->thread_count++;
+  group->active_thread_count++;
+  group->last_thread_creation_time= my_micro_time();
+  my_atomic_add32(&tp_stats.num_worker_threads, 1);
+  return 0;
+}
+
+
+/**
+  Wake up one idle worker.
+
+  @retval 0  A worker was woken up
+  @retval 1  No worker was waiting
+*/
+
+static int wake_thread(thread_group_t *group)
+{
+  worker_thread_t *thread= group->waiting_threads.pop_front();
+
+  mysql_mutex_assert_owner(&group->mutex);
+  if (!thread)
+    return 1;
+
+  group->waiting_thread_count--;
+  thread->woken= true;
+  mysql_cond_signal(&thread->cond);
+  return 0;
+}
+
+
+/**
+  Make sure somebody will handle the group's pending work: wake up an
+  idle worker or, if there is none, create a new one subject to
+  throttling.
+*/
+
+static int wake_or_create_thread(thread_group_t *group)
+{
+  mysql_mutex_assert_owner(&group->mutex);
+
+  if (group->shutdown)
+    return 0;
+
+  if (!wake_thread(group))
+    return 0;
+
+  /* More threads than connections would only sit idle */
+  if (group->thread_count > group->connection_count)
+    return 1;
+
+  if (group->active_thread_count == 0 ||
+      my_micro_time() - group->last_thread_creation_time >=
+      thread_creation_throttle(group))
+    return create_worker(group);
+
+  return 1;
+}
+
+
+/** Queue a connection that has a pending request. */
+
+static void queue_put(thread_group_t *group, connection_t *connection)
+{
+  mysql_mutex_assert_owner(&group->mutex);
+
+  if (connection->logged_in && connection->tickets > 0 &&
+      threadpool_connection_in_transaction(connection->thd))
+  {
+    connection->tickets--;
+    group->high_prio_queue.push_back(connection);
+  }
+  else
+  {
+    connection->tickets= threadpool_high_prio_tickets;
+    group->queue.push_back(connection);
+  }
+}
+
+
+/** Dequeue the next request, high priority queue first. */
+
+static connection_t *queue_get(thread_group_t *group)
+{
+  connection_t *connection;
+
+  mysql_mutex_assert_owner(&group->mutex);
+
+  if ((connection= group->high_prio_queue.pop_front()))
+    my_atomic_add64(&tp_stats.high_prio_dequeues, 1);
+  else if ((connection= group->queue.pop_front()))
+    my_atomic_add64(&tp_stats.low_prio_dequeues, 1);
+  else
+    return NULL;
+
+  group->queue_event_count++;
+  return connection;
+}
+
+
+static bool queue_is_empty(thread_group_t *group)
+{
+  return group->high_prio_queue.is_empty() && group->queue.is_empty();
+}
+
+
+/**
+  A group is oversubscribed if enough threads already execute requests.
+  A stalled group is allowed to go over the limit.
+*/
+
+static bool too_many_threads(thread_group_t *group)
+{
+  return (group->active_thread_count >= (int) (1 + threadpool_oversubscribe)
+          && !group->stalled);
+}
+
+
+/**
+  Wait for network events as the group's listener.
+
+  Events are put into the queues.  If nobody else is active in the group
+  the listener keeps one event for itself and stops listening; the
+  next thread looking for work becomes the new listener.
+
+  @return connection to handle, or NULL on shutdown
+*/
+
+static connection_t *listener(worker_thread_t *current_thread,
+                              thread_group_t *group)
+{
+  connection_t *retval= NULL;
+
+  for (;;)
+  {
+    struct epoll_event ev[MAX_EVENTS];
+    int cnt;
+
+    if (group->shutdown)
+      break;
+
+    cnt= epoll_wait(group->pollfd, ev, MAX_EVENTS, -1);
+    if (cnt <= 0)
+      continue;
+
+    mysql_mutex_lock(&group->mutex);
+
+    if (group->shutdown)
+    {
+      mysql_mutex_unlock(&group->mutex);
+      break;
+    }
+
+    group->io_event_count+= cnt;
+
+    bool listener_picks_event= queue_is_empty(group) &&
+                               group->active_thread_count == 0;
+
+    for (int i= 0; i < cnt; i++)
+    {
+      connection_t *connection= (connection_t *) ev[i].data.ptr;
+      /* NULL is the shutdown pipe */
+      if (connection)
+        queue_put(group, connection);
+    }
+
+    if (listener_picks_event && (retval= queue_get(group)))
+    {
+      group->listener= NULL;
+      mysql_mutex_unlock(&group->mutex);
+      break;
+    }
+
+    if (!queue_is_empty(group) && group->active_thread_count == 0)
+      wake_or_create_thread(group);
+
+    mysql_mutex_unlock(&group->mutex);
+  }
+  return retval;
+}
+
+
+/**
+  Find the next request for a worker: dequeue one, become the listener
+  or wait for work until thread_pool_idle_timeout expires.
+
+  @return connection to handle, or NULL if the thread should exit
+*/
+
+static connection_t *get_event(worker_thread_t *current_thread,
+                               thread_group_t *group)
+{
+  connection_t *connection= NULL;
+
+  mysql_mutex_lock(&group->mutex);
+
+  for (;;)
+  {
+    if (group->shutdown)
+      break;
+
+    if (!too_many_threads(group) && (connection= queue_get(group)))
+      break;
+
+    if (!group->listener)
+    {
+      group->listener= current_thread;
+      group->active_thread_count--;
+      mysql_mutex_unlock(&group->mutex);
+
+      connection= listener(current_thread, group);
+
+      mysql_mutex_lock(&group->mutex);
+      group->active_thread_count++;
+      group->listener= NULL;
+      break;
+    }
+
+    struct timespec ts;
+    set_timespec(ts, threadpool_idle_timeout);
+
+    current_thread->woken= false;
+    group->active_thread_count--;
+    group->waiting_thread_count++;
+    group->waiting_threads.push_front(current_thread);
+
+    int err= mysql_cond_timedwait(&current_thread->cond, &group->mutex, &ts);
+
+    group->active_thread_count++;
+    if (!current_thread->woken)
+    {
+      /* Nobody removed us from the list; time out or spurious wakeup */
+      group->waiting_threads.remove(current_thread);
+      group->waiting_thread_count--;
+      if (err == ETIMEDOUT || err == ETIME)
+        break;
+    }
+  }
+
+  group->stalled= false;
+  mysql_mutex_unlock(&group->mutex);
+  return connection;
+}
+
+
+/**
+  Close the connection and release its scheduler state.
+*/
+
+static void connection_abort(connection_t *connection)
+{
+  thread_group_t *group= connection->thread_group;
+
+  mysql_mutex_lock(&group->mutex);
+  group->connection_count--;
+  group->connections.remove(connection);
+  mysql_mutex_unlock(&group->mutex);
+
+  threadpool_remove_connection(connection->thd, connection->logged_in);
+  my_free(connection);
+}
+
+
+static void set_wait_timeout(connection_t *connection)
+{
+  connection->abs_wait_timeout= my_micro_time() +
+    1000000ULL * thd_get_net_wait_timeout(connection->thd);
+}
+
+
+/**
+  Log in a new connection or execute its pending commands, then wait
+  for the next request through epoll.
+*/
+
+static void handle_event(connection_t *connection)
+{
+  int err;
+
+  connection->abs_wait_timeout= 0;
+
+  if (!connection->logged_in)
+    err= threadpool_add_connection(connection->thd, &connection->logged_in);
+  else
+    err= threadpool_process_request(connection->thd);
+
+  if (!err)
+  {
+    set_wait_timeout(connection);
+    err= start_io(connection);
+  }
+
+  if (err)
+    connection_abort(connection);
+}
+
+
+static void *worker_main(void *param)
+{
+  worker_thread_t this_thread;
+  thread_group_t *group= (thread_group_t *) param;
+
+  my_thread_init();
+
+  mysql_cond_init(key_worker_cond, &this_thread.cond, NULL);
+  this_thread.thread_group= group;
+  this_thread.woken= false;
+
+  for (;;)
+  {
+    connection_t *connection= get_event(&this_thread, group);
+    if (!connection)
+      break;
+    handle_event(connection);
+  }
+
+  mysql_mutex_lock(&group->mutex);
+  group->active_thread_count--;
+  group->thread_count--;
+  mysql_mutex_unlock(&group->mutex);
+  my_atomic_add32(&tp_stats.num_worker_threads, -1);
+
+  mysql_cond_destroy(&this_thread.cond);
+  my_thread_end();
+  return NULL;
+}
+
+
+/**
+  Called by the timer for every group each thread_pool_stall_limit
+  milliseconds.
+*/
+
+static void check_stall(thread_group_t *group)
+{
+  mysql_mutex_lock(&group->mutex);
+
+  /*
+    Nobody listened and no events came in since the last check, e.g.
+    because the former listener is executing a long query.
+  */
+  if (!group->listener && !group->io_event_count &&
+      group->connection_count > 0)
+    wake_or_create_thread(group);
+  group->io_event_count= 0;
+
+  /*
+    Requests are queued but none was dequeued since the last check: all
+    active threads run long statements or wait without telling us.
+  */
+  if (!queue_is_empty(group) && !group->queue_event_count)
+  {
+    group->stalled= true;
+    my_atomic_add64(&tp_stats.stall_count, 1);
+    wake_or_create_thread(group);
+  }
+  group->queue_event_count= 0;
+
+  mysql_mutex_unlock(&group->mutex);
+}
+
+
+/**
+  Kill idle connections whose wait_timeout has expired.  Shutting down
+  the socket produces an epoll event, and the worker that picks it up
+  closes the connection.
+*/
+
+static void timeout_check(ulonglong now)
+{
+  for (uint i= 0; i < group_count; i++)
+  {
+    thread_group_t *group= &all_groups[i];
+    connection_t *connection;
+
+    mysql_mutex_lock(&group->mutex);
+    I_P_List_iterator<connection_t, connection_list_t> it(group->connections);
+    while ((connection= it++))
+    {
+      ulonglong timeout= connection->abs_wait_timeout;
+      if (timeout && timeout <= now)
+      {
+        connection->abs_wait_timeout= 0;
+        thd_set_killed(connection->thd);
+        shutdown(thd_get_fd(connection->thd), SHUT_RDWR);
+      }
+    }
+    mysql_mutex_unlock(&group->mutex);
+  }
+}
+
+
+static void *timer_thread(void *param)
+{
+  my_thread_init();
+
+  mysql_mutex_lock(&pool_timer.mutex);
+  while (!pool_timer.shutdown)
+  {
+    struct timespec ts;
+    set_timespec_nsec(ts, threadpool_stall_limit * 1000000ULL);
+    int err= mysql_cond_timedwait(&pool_timer.cond, &pool_timer.mutex, &ts);
+
+    if (pool_timer.shutdown || (err != ETIMEDOUT && err != ETIME))
+      continue;
+
+    for (uint i= 0; i < group_count; i++)
+      check_stall(&all_groups[i]);
+
+    /* wait_timeout has second resolution, no need to scan more often */
+    ulonglong now= my_micro_time();
+    if (now >= pool_timer.next_timeout_check)
+    {
+      timeout_check(now);
+      pool_timer.next_timeout_check= now + 1000000ULL;
+    }
+  }
+  mysql_mutex_unlock(&pool_timer.mutex);
+
+  my_thread_end();
+  return NULL;
+}
+
+
+static int thread_group_init(thread_group_t *group)
+{
+  struct epoll_event ev;
+
+  mysql_mutex_init(key_group_mutex, &group->mutex, NULL);
+  group->high_prio_queue.empty();
+  group->queue.empty();
+  group->connections.empty();
+  group->waiting_threads.empty();
+  group->listener= NULL;
+  group->thread_count= 0;
+  group->active_thread_count= 0;
+  group->waiting_thread_count= 0;
+  group->connection_count= 0;
+  group->io_event_count= 0;
+  group->queue_event_count= 0;
+  group->last_thread_creation_time= 0;
+  group->stalled= false;
+  group->shutdown= false;
+  group->shutdown_pipe[0]= group->shutdown_pipe[1]= -1;
+
+  if ((group->pollfd= epoll_create(1)) < 0)
+    return 1;
+
+  if (pipe(group->shutdown_pipe))
+    return 1;
+
+  ev.events= EPOLLIN;
+  ev.data.ptr= NULL;
+  if (epoll_ctl(group->pollfd, EPOLL_CTL_ADD, group->shutdown_pipe[0], &ev))
+    return 1;
+
+  return 0;
+}
+
+
+static void thread_group_close(thread_group_t *group)
+{
+  if (group->pollfd >= 0)
+    close(group->pollfd);
+  if (group->shutdown_pipe[0] >= 0)
+    close(group->shutdown_pipe[0]);
+  if (group->shutdown_pipe[1] >= 0)
+    close(group->shutdown_pipe[1]);
+  mysql_mutex_destroy(&group->mutex);
+}
+
+
+/**
+  Stop all workers of a group and wait until they have exited.
+  Connections are already closed by the server at this point.
+*/
+
+static void thread_group_shutdown(thread_group_t *group)
+{
+  char c= 0;
+
+  mysql_mutex_lock(&group->mutex);
+  group->shutdown= true;
+  while (!wake_thread(group))
+  {}
+  if (write(group->shutdown_pipe[1], &c, 1) < 0)
+    sql_print_error("Thread pool: failed to wake up listener");
+  mysql_mutex_unlock(&group->mutex);
+
+  for (;;)
+  {
+    mysql_mutex_lock(&group->mutex);
+    int thread_count= group->thread_count;
+    mysql_mutex_unlock(&group->mutex);
+    if (!thread_count)
+      break;
+    my_sleep(10000);
+  }
+}
+
+
+bool tp_init()
+{
+  DBUG_ENTER("tp_init");
+
+#ifdef HAVE_PSI_INTERFACE
+  init_threadpool_psi_keys();
+#endif
+
+  group_count= threadpool_size;
+  all_groups= (thread_group_t *)
+    my_malloc(sizeof(thread_group_t) * group_count, MYF(MY_WME | MY_ZEROFILL));
+  if (!all_groups)
+    DBUG_RETURN(true);
+
+  for (uint i= 0; i < group_count; i++)
+  {
+    if (thread_group_init(&all_groups[i]))
+    {
+      sql_print_error("Thread pool: can't create epoll descriptor "
+                      "(errno= %d)", errno);
+      for (uint j= 0; j <= i; j++)
+        thread_group_close(&all_groups[j]);
+      my_free(all_groups);
+      all_groups= NULL;
+      DBUG_RETURN(true);
+    }
+  }
+
+  mysql_mutex_init(key_timer_mutex, &pool_timer.mutex, NULL);
+  mysql_cond_init(key_timer_cond, &pool_timer.cond, NULL);
+  pool_timer.shutdown= false;
+  pool_timer.next_timeout_check= 0;
+  if (mysql_thread_create(key_timer_thread, &pool_timer.thread_id, NULL,
+                          timer_thread, NULL))
+  {
+    sql_print_error("Thread pool: can't create timer thread");
+    mysql_mutex_destroy(&pool_timer.mutex);
+    mysql_cond_destroy(&pool_timer.cond);
+    for (uint i= 0; i < group_count; i++)
+      thread_group_close(&all_groups[i]);
+    my_free(all_groups);
+    all_groups= NULL;
+    DBUG_RETURN(true);
+  }
+
+  DBUG_RETURN(false);
+}
+
+
+void tp_end()
+{
+  DBUG_ENTER("tp_end");
+
+  if (!all_groups)
+    DBUG_VOID_RETURN;
+
+  mysql_mutex_lock(&pool_timer.mutex);
+  pool_timer.shutdown= true;
+  mysql_cond_signal(&pool_timer.cond);
+  mysql_mutex_unlock(&pool_timer.mutex);
+  pthread_join(pool_timer.thread_id, NULL);
+  mysql_mutex_destroy(&pool_timer.mutex);
+  mysql_cond_destroy(&pool_timer.cond);
+
+  for (uint i= 0; i < group_count; i++)
+  {
+    thread_group_shutdown(&all_groups[i]);
+    thread_group_close(&all_groups[i]);
+  }
+  my_free(all_groups);
+  all_groups= NULL;
+
+  DBUG_VOID_RETURN;
+}
+
+
+/**
+  Scheduler callback for a newly accepted connection.  Login is queued
+  like any other request, so the acceptor thread never blocks on it.
+*/
+
+void tp_add_connection(THD *thd)
+{
+  char stack_start;
+  connection_t *connection= (connection_t *)
+    my_malloc(sizeof(connection_t), MYF(MY_ZEROFILL));
+
+  thd_lock_thread_count(thd);
+  thd_new_connection_setup(thd, &stack_start);
+
+  if (!connection)
+  {
+    /* Same cleanup as a failed login */
+    close_connection(thd, ER_OUT_OF_RESOURCES);
+    thd_release_resources(thd);
+    remove_global_thread(thd);
+    dec_connection_count();
+    destroy_thd(thd);
+    return;
+  }
+
+  thread_group_t *group=
+    &all_groups[(uint) my_atomic_add32(&next_group, 1) % group_count];
+
+  connection->thd= thd;
+  connection->thread_group= group;
+  connection->tickets= threadpool_high_prio_tickets;
+  thd_set_scheduler_data(thd, connection);
+
+  mysql_mutex_lock(&group->mutex);
+  group->connection_count++;
+  group->connections.push_front(connection);
+  queue_put(group, connection);
+  if (group->active_thread_count == 0)
+    wake_or_create_thread(group);
+  mysql_mutex_unlock(&group->mutex);
+}
+
+
+/**
+  The thread executing this connection's request is about to block.
+  If it was the last active thread of its group, make sure another one
+  picks up queued work.
+*/
+
+void tp_wait_begin(THD *thd, int wait_type)
+{
+  connection_t *connection;
+
+  if (!thd || !(connection= (connection_t *) thd_get_scheduler_data(thd)))
+    return;
+
+  thread_group_t *group= connection->thread_group;
+  mysql_mutex_lock(&group->mutex);
+  group->active_thread_count--;
+  if (group->active_thread_count == 0 &&
+      (!queue_is_empty(group) || !group->listener))
+    wake_or_create_thread(group);
+  mysql_mutex_unlock(&group->mutex);
+}
+
+
+void tp_wait_end(THD *thd)
+{
+  connection_t *connection;
+
+  if (!thd || !(connection= (connection_t *) thd_get_scheduler_data(thd)))
+    return;
+
+  thread_group_t *group= connection->thread_group;
+  mysql_mutex_lock(&group->mutex);
+  group->active_thread_count++;
+  mysql_mutex_unlock(&group->mutex);
+}
+
+
+/**
+  Wake up an idle connection that was killed so that a worker notices
+  and closes it.
+*/
+
+void tp_post_kill_notification(THD *thd)
+{
+  if (thd == thd_get_current_thd() || !thd_get_scheduler_data(thd))
+    return;
+  shutdown(thd_get_fd(thd), SHUT_RD);
+}
+
+
+int tp_get_idle_thread_count()
+{
+  int sum= 0;
+  for (uint i= 0; all_groups && i < group_count; i++)
+    sum+= all_groups[i].waiting_thread_count;
+  return sum;
+}
@@ -0,0 +1,167 @@
+#!/usr/bin/perl
+# Copyright (c) 2016, Facebook, Inc. All rights reserved.
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Library General Public
+# License as published by the Free Software Foundation; version 2
+# of the License.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Library General Public License for more details.
+#
+# You should have received a copy of the GNU Library General Public
+# License along with this library; if not, write to the Free
+# Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+# MA 02110-1301, USA
+#
+# Compare MyRocks select bypass against the regular optimizer for the
+# query shapes the bypass handles: point lookups with <=>, BETWEEN and
+# IN ranges, IS NULL prefixes, ORDER BY ... LIMIT scans without WHERE
+# and filters checked on the secondary key.
+#
+# Run with --create-options=ENGINE=RocksDB
+#
+##################### Standard benchmark inits ##############################
+
+use Cwd;
+use DBI;
+use Getopt::Long;
+use Benchmark;
+
+$opt_loop_count=100000;
+$opt_medium_loop_count=10000;
+$opt_groups=100;
+
+$pwd = cwd(); $pwd = "." if ($pwd eq '');
+require "$pwd/bench-init.pl" || die "Can't read Configuration file: $!\n";
+
+if (!defined($opt_create_options) || $opt_create_options !~ /engine=rocksdb/i)
+{
+  die "This benchmark needs --create-options=ENGINE=RocksDB\n";
+}
+
+if ($opt_small_test)
+{
+  $opt_loop_count/=10;
+  $opt_medium_loop_count/=10;
+  $opt_groups/=10;
+}
+
+print "Testing the speed of select bypass queries\n";
+print "The test-table has $opt_loop_count rows and every query is run $opt_medium_loop_count times.\n\n";
+
+####
+####  Connect and start timeing
+####
+
+$dbh = $server->connect();
+$start_time=new Benchmark;
+
+####
+#### Create needed tables
+####
+
+goto select_test if ($opt_skip_create);
+
+print "Creating table\n";
+$dbh->do("drop table bench1" . $server->{'drop_attr'});
+
+do_many($dbh,$server->create("bench1",
+			     ["id integer(11) NOT NULL",
+			      "grp integer(11)",
+			      "seq integer(11) NOT NULL",
+			      "val integer(11) NOT NULL",
+			      "data char(40) NOT NULL"],
+			     ["primary key (id)",
+			      "key grp_seq (grp,seq)"]));
+
+####
+#### Insert $opt_loop_count records with
+#### id:	0 -> count
+#### grp:	NULL for every 10th row, otherwise 0 -> $opt_groups
+#### seq:	position within the group
+####
+
+print "Inserting $opt_loop_count rows\n";
+
+$loop_time=new Benchmark;
+for ($id=0 ; $id < $opt_loop_count ; $id++)
+{
+  $grp= ($id % 10 == 0) ? "NULL" : $id % $opt_groups;
+  $seq= int($id / $opt_groups);
+  do_query($dbh,"insert into bench1 values ($id,$grp,$seq,$id*3,'row $id')");
+}
+
+$end_time=new Benchmark;
+print "Time to insert ($opt_loop_count): " .
+    timestr(timediff($end_time, $loop_time),"all") . "\n\n";
+
+####
+#### Run every query shape with and without bypass
+####
+
+select_test:
+
+$last_grp= $opt_groups - 1;
+$mid_seq= int($opt_loop_count / $opt_groups / 2);
+
+@queries=
+  (["point_null_safe_eq",
+    sub { "select %s id,val from bench1 where id <=> " .
+	    int(rand($opt_loop_count)) }],
+   ["pk_between",
+    sub { my $id= int(rand($opt_loop_count - 10));
+	  "select %s id,val from bench1 where id between $id and " .
+	    ($id + 9) . " order by id" }],
+   ["sk_is_null_prefix",
+    sub { "select %s id,grp,seq from bench1 force index (grp_seq) " .
+	    "where grp is null and seq >= " . int(rand($mid_seq)) .
+	    " order by grp,seq limit 10" }],
+   ["sk_in_list",
+    sub { "select %s id,grp,seq from bench1 force index (grp_seq) " .
+	    "where grp in (1,$last_grp) and seq = " . int(rand($mid_seq)) }],
+   ["order_by_desc_limit_offset",
+    sub { "select %s id,val from bench1 order by id desc limit " .
+	    int(rand(100)) . ",10" }],
+   ["sk_filter_before_pk_lookup",
+    sub { "select %s id,grp,seq,data from bench1 force index (grp_seq) " .
+	    "where grp >= $last_grp and seq = " . int(rand($mid_seq)) .
+	    " order by grp,seq" }]);
+
+foreach $query (@queries)
+{
+  my ($name, $gen)= @$query;
+  foreach $hint ("/*+ bypass */", "/*+ no_bypass */")
+  {
+    srand(17);
+    $loop_time=new Benchmark;
+    $rows=$estimated=$count=0;
+    for ($i=0 ; $i < $opt_medium_loop_count ; $i++)
+    {
+      $count++;
+      $rows+=fetch_all_rows($dbh,sprintf(&$gen(),$hint));
+      $end_time=new Benchmark;
+      last if ($estimated=predict_query_time($loop_time,$end_time,\$count,
+					     $i+1,$opt_medium_loop_count));
+    }
+    print_time($estimated);
+    print " for ${name}_" . ($hint =~ /no_bypass/ ? "regular" : "bypass") .
+      " ($count:$rows): " .
+      timestr(timediff($end_time, $loop_time),"all") . "\n";
+  }
+}
+
+####
+#### End of benchmark
+####
+
+if (!$opt_skip_delete)
+{
+  do_query($dbh,"drop table bench1" . $server->{'drop_attr'});
+}
+
+$dbh->disconnect;				# close connection
+
+end_benchmark($start_time);
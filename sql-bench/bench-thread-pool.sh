@@ -0,0 +1,160 @@
+#!/usr/bin/perl
+# Copyright (c) 2016, Facebook, Inc. All rights reserved.
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Library General Public
+# License as published by the Free Software Foundation; version 2
+# of the License.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Library General Public License for more details.
+#
+# You should have received a copy of the GNU Library General Public
+# License along with this library; if not, write to the Free
+# Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+# MA 02110-1301, USA
+#
+# Measure connect and point query throughput with 1000, 10000 and
+# 50000 concurrent connections.  The connections are spread over
+# $clients forked processes, each of which runs its queries round-robin
+# over its own connections, so most connections are idle at any time.
+#
+# Run it once against a server started with
+#   --thread_handling=one-thread-per-connection
+# and once against a server started with
+#   --plugin-load=thread_pool=thread_pool.so
+# and compare the results.  The server needs max_connections and
+# open_files_limit above 50000.
+#
+##################### Standard benchmark inits ##############################
+
+use Cwd;
+use DBI;
+use Getopt::Long;
+use Benchmark;
+use Time::HiRes qw(time);
+
+$opt_loop_count=100000;
+$clients=100;
+@connection_counts=(1000, 10000, 50000);
+
+$pwd = cwd(); $pwd = "." if ($pwd eq '');
+require "$pwd/bench-init.pl" || die "Can't read Configuration file: $!\n";
+
+if ($opt_small_test)
+{
+  $opt_loop_count/=10;
+  @connection_counts= map { $_ / 10 } @connection_counts;
+}
+
+####
+####  Connect and start timeing
+####
+
+$dbh = $server->connect();
+$start_time=new Benchmark;
+
+($thread_handling)=
+  $dbh->selectrow_array("select \@\@global.thread_handling");
+print "Testing the speed of many concurrent connections\n";
+print "thread_handling is $thread_handling, $clients clients run " .
+  "$opt_loop_count queries per connection count.\n\n";
+
+####
+#### Create needed tables
+####
+
+goto select_test if ($opt_skip_create);
+
+print "Creating table\n";
+$dbh->do("drop table bench1" . $server->{'drop_attr'});
+
+do_many($dbh,$server->create("bench1",
+			     ["id integer(11) NOT NULL",
+			      "val integer(11) NOT NULL"],
+			     ["primary key (id)"]));
+
+for ($id=0 ; $id < 1000 ; $id++)
+{
+  do_query($dbh,"insert into bench1 values ($id,$id*3)");
+}
+
+####
+#### Every client opens its share of connections, then runs its queries
+#### round-robin over them.  It reports both phases through a pipe.
+####
+
+select_test:
+
+foreach $connections (@connection_counts)
+{
+  my $per_client= int($connections / $clients);
+  my $queries= int($opt_loop_count / $clients);
+  my (@pids, @pipes);
+
+  for ($c=0 ; $c < $clients ; $c++)
+  {
+    my ($reader, $writer);
+    pipe($reader, $writer) || die "Can't create pipe: $!\n";
+    my $pid= fork();
+    die "Can't fork: $!\n" if (!defined($pid));
+    if (!$pid)
+    {
+      close($reader);
+      $dbh->{InactiveDestroy}= 1;		# Parent still uses it
+      my @handles;
+      my $begin= time();
+      for ($i=0 ; $i < $per_client ; $i++)
+      {
+	push(@handles, $server->connect());
+      }
+      my $connected= time();
+      srand($c);
+      for ($i=0 ; $i < $queries ; $i++)
+      {
+	$handles[$i % $per_client]->selectrow_array(
+	  "select val from bench1 where id=" . int(rand(1000)));
+      }
+      my $done= time();
+      printf $writer ("%f %f\n", $connected - $begin, $done - $connected);
+      close($writer);
+      $_->disconnect foreach (@handles);
+      exit(0);
+    }
+    close($writer);
+    push(@pids, $pid);
+    push(@pipes, $reader);
+  }
+
+  my ($connect_time, $query_time)= (0, 0);
+  foreach $reader (@pipes)
+  {
+    my ($connect, $query)= split(' ', scalar(<$reader>));
+    $connect_time= $connect if ($connect > $connect_time);
+    $query_time= $query if ($query > $query_time);
+    close($reader);
+  }
+  waitpid($_, 0) foreach (@pids);
+
+  printf("Time to open %d connections: %.2f secs\n",
+	 $per_client * $clients, $connect_time);
+  printf("Time for %d point queries over %d connections: %.2f secs " .
+	 "(%.0f queries/sec)\n\n", $queries * $clients,
+	 $per_client * $clients, $query_time,
+	 $query_time ? $queries * $clients / $query_time : 0);
+}
+
+####
+#### End of benchmark
+####
+
+if (!$opt_skip_delete)
+{
+  do_query($dbh,"drop table bench1" . $server->{'drop_attr'});
+}
+
+$dbh->disconnect;				# close connection
+
+end_benchmark($start_time);
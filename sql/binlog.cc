@@ -31,6 +31,7 @@
 #include "sql_show.h"
 #include "sql_parse.h"
 #include "rpl_mi.h"
+#include "my_murmur3.h"
 #include <list>
 #include <chrono>
 #include <sstream>
@@ -88,6 +89,7 @@ static int limit_unsafe_warning_count= 0;
 
 static handlerton *binlog_hton;
 bool opt_binlog_order_commits= true;
+ulong opt_binlog_group_commit_sync_max_delay= 0;
 bool opt_gtid_precommit= false;
 
 const char *log_bin_index= 0;
@@ -98,6 +100,8 @@ int opt_histogram_step_size_binlog_group_commit = 1;
 latency_histogram histogram_binlog_fsync;
 latency_histogram histogram_raft_trx_wait;
 counter_histogram histogram_binlog_group_commit;
+counter_histogram histogram_binlog_stage_queue[Stage_manager::STAGE_COUNTER];
+latency_histogram histogram_binlog_stage_wait[Stage_manager::STAGE_COUNTER];
 
 extern my_bool opt_core_file;
 
@@ -448,6 +452,62 @@ public:
     return flags.flush_error;
   }
 
+  /**
+    Add the hash of a unique key of a row written to this cache to its
+    write set, see binlog_transaction_dependency_tracking.
+  */
+  void add_to_write_set(ulonglong hash)
+  {
+    if (flags.write_set_unsafe)
+      return;
+    /* Such a write set would be dropped from the history anyway */
+    if (write_set.size() >= binlog_transaction_dependency_history_size)
+    {
+      set_write_set_unsafe();
+      return;
+    }
+    write_set.push_back(hash);
+  }
+
+  /**
+    Mark that the write set misses some of the conflicts of this cache, the
+    transaction then depends on all the previous ones.
+  */
+  void set_write_set_unsafe()
+  {
+    flags.write_set_unsafe= true;
+    write_set.clear();
+  }
+
+  bool is_write_set_unsafe() const
+  {
+    return flags.write_set_unsafe;
+  }
+
+  const std::vector<ulonglong>& get_write_set() const
+  {
+    return write_set;
+  }
+
+  bool has_dependency_placeholder() const
+  {
+    return flags.dependency_placeholder;
+  }
+
+  /**
+    If the first event was written to the cache, which reserves the
+    dependency placeholder or not.
+  */
+  bool has_written_events() const
+  {
+    return my_b_tell(&cache_log) != 0;
+  }
+
+  void clear_dependency_placeholder()
+  {
+    flags.dependency_placeholder= false;
+  }
+
   bool has_xid() const {
     // There should only be an XID event if we are transactional
     DBUG_ASSERT((flags.transactional && flags.with_xid) || !flags.with_xid);
@@ -493,6 +553,9 @@ public:
     flags.immediate= false;
     flags.finalized= false;
     flags.flush_error= false;
+    flags.write_set_unsafe= false;
+    flags.dependency_placeholder= false;
+    write_set.clear();
     /*
       The truncate function calls reinit_io_cache that calls my_b_flush_io_cache
       which may increase disk_writes. This breaks the disk_writes use by the
@@ -622,6 +685,18 @@ protected:
       I/O cache to file.
      */
     bool flush_error:1;
+
+    /*
+      This indicates that the write set does not capture all the conflicts
+      of the cached events, e.g. because some of them are statements.
+     */
+    bool write_set_unsafe:1;
+
+    /*
+      This indicates that a metadata event for the dependency interval was
+      reserved after the Gtid event, to be filled in at flush time.
+     */
+    bool dependency_placeholder:1;
   } flags;
 
 private:
@@ -631,6 +706,11 @@ private:
    */
   Rows_log_event *m_pending;
 
+  /*
+    Hashes of the unique keys of the rows written to this cache.
+   */
+  std::vector<ulonglong> write_set;
+
   /**
     This function computes binlog cache and disk usage.
   */
@@ -1023,6 +1103,13 @@ static int binlog_init(void *p)
   latency_histogram_init(&histogram_raft_trx_wait, "125us");
   counter_histogram_init(&histogram_binlog_group_commit,
                          opt_histogram_step_size_binlog_group_commit);
+  for (uint i= 0; i < Stage_manager::STAGE_COUNTER; i++)
+  {
+    counter_histogram_init(&histogram_binlog_stage_queue[i],
+                           opt_histogram_step_size_binlog_group_commit);
+    latency_histogram_init(&histogram_binlog_stage_wait[i],
+                           histogram_step_size_binlog_fsync);
+  }
   return 0;
 }
 
@@ -1146,11 +1233,33 @@ int binlog_cache_data::write_event(THD *thd,
         if (metadata_ev.write(&cache_log))
           DBUG_RETURN(1);
       }
+
+      /* Reserve a metadata event for the dependency interval of this trx,
+       * it is assigned in binlog order during ordered commit. Trxs applied
+       * by a slave keep the gtid of the master and are written without
+       * one. */
+      if (binlog_transaction_dependency_tracking !=
+          DEPENDENCY_TRACKING_NONE &&
+          thd->variables.gtid_next.type == AUTOMATIC_GROUP &&
+          !thd->rli_slave && !thd->rli_fake)
+      {
+        Metadata_log_event metadata_ev(thd, is_trx_cache());
+        metadata_ev.set_dependency_interval(0, 0);
+        if (metadata_ev.write(&cache_log))
+          DBUG_RETURN(1);
+        flags.dependency_placeholder= true;
+      }
     }
   }
 
   if (ev != NULL)
   {
+    /* Statements can conflict with any row, they have no write set */
+    if ((ev->get_type_code() == QUERY_EVENT &&
+         !static_cast<Query_log_event*>(ev)->is_trans_keyword()) ||
+        ev->get_type_code() == EXECUTE_LOAD_QUERY_EVENT)
+      set_write_set_unsafe();
+
     // case: write meta data event before the real event
     // see @opt_binlog_trx_meta_data
     if (write_meta_data_event)
@@ -1321,6 +1430,33 @@ static int hlc_before_write_cache(THD* thd, binlog_cache_data* cache_data)
   return result;
 }
 
+/**
+ * Assign the dependency interval of the trx during ordered commit and write
+ * it over the placeholder reserved after the Gtid event
+ *
+ * @param thd - the THD in group commit
+ * @cache_data - The cache that needs to be updated with the interval
+ *
+ * @return zero on success, non-zero on failure
+ */
+static int dependency_before_write_cache(THD* thd,
+                                         binlog_cache_data* cache_data)
+{
+  if (!cache_data->has_dependency_placeholder())
+    return 0;
+
+  int64_t last_committed, sequence_number;
+  mysql_bin_log.get_dependency_interval(thd, cache_data->get_write_set(),
+                                        cache_data->is_write_set_unsafe(),
+                                        &last_committed, &sequence_number);
+
+  Metadata_log_event metadata_ev(thd, cache_data->is_trx_cache());
+  metadata_ev.set_dependency_interval(last_committed, sequence_number);
+  cache_data->clear_dependency_placeholder();
+
+  return metadata_ev.write(&cache_data->cache_log);
+}
+
 
 /**
 
@@ -1388,6 +1524,10 @@ gtid_before_write_cache(THD* thd, binlog_cache_data* cache_data)
       /* Update commit time HLC timestamp for this trx */
       hlc_before_write_cache(thd, cache_data);
 
+      /* Assign the dependency interval of this trx */
+      if (dependency_before_write_cache(thd, cache_data))
+        goto err;
+
       cache_data->reset_write_pos(saved_position, using_file);
     }
 
@@ -1526,6 +1666,13 @@ binlog_cache_data::flush(THD *thd, my_off_t *bytes_written, bool *wrote_xid,
   {
     my_off_t bytes_in_cache= my_b_tell(&cache_log);
     DBUG_PRINT("debug", ("bytes_in_cache: %llu", bytes_in_cache));
+    /*
+      A trx written without dependency interval orders all the later ones,
+      as its conflicts are not known.
+    */
+    if (!has_dependency_placeholder())
+      mysql_bin_log.reset_dependency_history();
+
     /*
       The cache is always reset since subsequent rollbacks of the
       transactions might trigger attempts to write to the binary log
@@ -1781,9 +1928,14 @@ Stage_manager::Mutex_queue::append(THD *first)
     moderately short. If they are not, we need to track the end of
     the queue as well.
   */
+  uint count= 1;
   while (first->next_to_commit)
+  {
     first= first->next_to_commit;
+    count++;
+  }
   m_last= &first->next_to_commit;
+  m_size.fetch_add(count, std::memory_order_relaxed);
   DBUG_PRINT("info", ("m_first: 0x%llx, &m_first: 0x%llx, m_last: 0x%llx",
                         (ulonglong) m_first, (ulonglong) &m_first,
                         (ulonglong) m_last));
@@ -1811,6 +1963,10 @@ Stage_manager::enroll_for(StageID stage, THD *thd, mysql_mutex_t *leave_mutex,
 
   bool leader= m_queue[stage].append(thd);
 
+  /* Wake up the sync stage leader waiting for its group to grow */
+  if (stage == SYNC_STAGE && !leader)
+    mysql_cond_signal(&m_cond_sync_enrolled);
+
   DBUG_EXECUTE_IF("become_group_leader",
                   {
                     if (stage == FLUSH_STAGE)
@@ -1875,7 +2031,7 @@ Stage_manager::enroll_for(StageID stage, THD *thd, mysql_mutex_t *leave_mutex,
 }
 
 
-THD *Stage_manager::Mutex_queue::fetch_and_empty()
+THD *Stage_manager::Mutex_queue::fetch_and_empty(uint *size_var)
 {
   DBUG_ENTER("Stage_manager::Mutex_queue::fetch_and_empty");
   lock();
@@ -1885,6 +2041,7 @@ THD *Stage_manager::Mutex_queue::fetch_and_empty()
   THD *result= m_first;
   m_first= NULL;
   m_last= &m_first;
+  *size_var= m_size.exchange(0, std::memory_order_relaxed);
   DBUG_PRINT("info", ("m_first: 0x%llx, &m_first: 0x%llx, m_last: 0x%llx",
                        (ulonglong) m_first, (ulonglong) &m_first,
                        (ulonglong) m_last));
@@ -1903,6 +2060,28 @@ THD *Stage_manager::Mutex_queue::fetch_and_empty()
   DBUG_RETURN(result);
 }
 
+THD *Stage_manager::fetch_queue_for(StageID stage, uint *size_var)
+{
+  DBUG_PRINT("debug", ("Fetching queue for stage %d", stage));
+  uint size;
+  THD *queue= m_queue[stage].fetch_and_empty(&size);
+  if (size && stage != FLUSH_STAGE)
+    counter_histogram_increment(&histogram_binlog_stage_queue[stage], size);
+  if (size_var)
+    *size_var= size;
+  return queue;
+}
+
+void Stage_manager::wait_for_sync_enrollment(uint size,
+                                             const struct timespec *abstime)
+{
+  Mutex_queue &queue= m_queue[SYNC_STAGE];
+  queue.lock();
+  if (queue.get_size() <= size)
+    mysql_cond_timedwait(&m_cond_sync_enrolled, &queue.m_lock, abstime);
+  queue.unlock();
+}
+
 #ifndef DBUG_OFF
 void Stage_manager::clear_preempt_status(THD *head)
 {
@@ -2273,6 +2452,94 @@ bool HybridLogicalClock::DatabaseEntry::wait_for_hlc(THD *thd,
   return false;
 }
 
+void Writeset_dependency_tracker::get_interval(
+    THD *thd, const std::vector<ulonglong>& write_set, bool unsafe,
+    int64_t *last_committed, int64_t *sequence_number) {
+  mysql_mutex_assert_owner(mysql_bin_log.get_log_lock());
+
+  const int64_t sequence = ++sequence_;
+  int64_t parent = history_start_;
+  const bool exceeds_capacity =
+      history_.size() + write_set.size() >
+      binlog_transaction_dependency_history_size;
+
+  if (unsafe) {
+    parent = sequence - 1;
+  } else {
+    for (const ulonglong hash : write_set) {
+      auto it = history_.find(hash);
+      if (it != history_.end()) {
+        parent = std::max(parent, it->second);
+        it->second = sequence;
+      } else if (!exceeds_capacity) {
+        history_.emplace(hash, sequence);
+      }
+    }
+  }
+
+  if (binlog_transaction_dependency_tracking ==
+      DEPENDENCY_TRACKING_WRITESET_SESSION)
+    parent = std::max(parent, thd->last_dependency_sequence);
+
+  // The trxs after this one must conflict with it if its write set did not
+  // make it to the history
+  if (unsafe || exceeds_capacity) {
+    history_.clear();
+    history_start_ = sequence;
+  }
+
+  thd->last_dependency_sequence = sequence;
+  *last_committed = std::max<int64_t>(parent - file_base_, 0);
+  *sequence_number = sequence - file_base_;
+}
+
+void Writeset_dependency_tracker::reset() {
+  mysql_mutex_assert_owner(mysql_bin_log.get_log_lock());
+
+  if (history_start_ != sequence_ || !history_.empty()) {
+    history_.clear();
+    history_start_ = sequence_;
+  }
+}
+
+/* Weight of the newest sample in the moving averages of the pacer */
+static const double PACER_SAMPLE_WEIGHT = 0.125;
+
+void Group_commit_pacer::record_group(ulonglong now, uint count) {
+  if (last_fetch_ && now > last_fetch_ && count) {
+    /* Everyone in the group arrived since the previous group was taken */
+    const double gap = (double) (now - last_fetch_) / count;
+    if (arrival_usecs_ > 0)
+      arrival_usecs_ += (gap - arrival_usecs_) * PACER_SAMPLE_WEIGHT;
+    else
+      arrival_usecs_ = gap;
+  }
+  last_fetch_ = now;
+}
+
+void Group_commit_pacer::record_fsync(ulonglong usecs) {
+  if (fsync_usecs_ > 0)
+    fsync_usecs_ += ((double) usecs - fsync_usecs_) * PACER_SAMPLE_WEIGHT;
+  else
+    fsync_usecs_ = usecs;
+}
+
+ulonglong Group_commit_pacer::get_delay(uint queued,
+                                        ulonglong max_delay) const {
+  if (!max_delay || fsync_usecs_ <= 0 || arrival_usecs_ <= 0)
+    return 0;
+
+  /*
+    fsync_usecs_ / arrival_usecs_ sessions arrive while one fsync runs.
+    Wait for the ones still missing, unless not even one more is expected:
+    then the wait only adds latency.
+  */
+  const double remaining = fsync_usecs_ - queued * arrival_usecs_;
+  if (remaining < arrival_usecs_)
+    return 0;
+  return std::min((ulonglong) remaining, max_delay);
+}
+
 /**
   Write a rollback record of the transaction to the binary log.
 
@@ -3807,7 +4074,7 @@ MYSQL_BIN_LOG::MYSQL_BIN_LOG(uint *sync_period)
   :bytes_written(0), file_id(1), open_count(1),
    sync_period_ptr(sync_period), sync_counter(0),
    m_prep_xids(0),
-   binlog_end_pos(0),
+   binlog_end_pos(0), flushed_end_pos(0),
    non_xid_trxs(0),
    is_relay_log(0), signal_cnt(0),
    checksum_alg_reset(BINLOG_CHECKSUM_ALG_UNDEF),
@@ -3822,6 +4089,7 @@ MYSQL_BIN_LOG::MYSQL_BIN_LOG(uint *sync_period)
     before main().
   */
   index_file_name[0] = 0;
+  flushed_file_name[0] = 0;
   engine_binlog_file[0] = 0;
   engine_binlog_max_gtid.clear();
   last_master_timestamp.store(0);
@@ -5045,6 +5313,10 @@ bool MYSQL_BIN_LOG::open_binlog(const char *log_name,
    * In Raft mode, to keep consistent sizes of raft log files, we write a dummy HLC
    * to relay logs.
    */
+  /* Dependency intervals are numbered from the start of each binlog file */
+  if (!is_relay_log)
+    dependency_tracker.rotate();
+
   if (enable_binlog_hlc && (!is_relay_log || raft_rotate_info))
   {
     uint64_t current_hlc= 0;
@@ -7627,7 +7899,9 @@ bool MYSQL_BIN_LOG::flush_and_sync(bool async, const bool force)
   if (flush_io_cache(&log_file))
     return 1;
 
+  mysql_mutex_lock(&LOCK_sync);
   std::pair<bool, bool> result= sync_binlog_file(force, async);
+  mysql_mutex_unlock(&LOCK_sync);
 
   return result.first;
 }
@@ -10204,11 +10478,15 @@ MYSQL_BIN_LOG::change_stage(THD *thd,
     the thread is the leader. After which, regardless of being the leader, it
     will release the leave_mutex.
   */
+  ulonglong start_time= my_timer_now();
   if (!stage_manager.enroll_for(stage, queue, leave_mutex, enter_mutex))
   {
     DBUG_ASSERT(!thd_get_cache_mngr(thd)->dbug_any_finalized());
     DBUG_RETURN(true);
   }
+  if (histogram_step_size_binlog_fsync)
+    latency_histogram_increment(&histogram_binlog_stage_wait[stage],
+                                my_timer_since(start_time), 1);
   DBUG_RETURN(false);
 }
 
@@ -10238,6 +10516,8 @@ MYSQL_BIN_LOG::flush_cache_to_file(my_off_t *end_pos_var)
 
 /**
   Call fsync() to sync the file to disk.
+
+  LOCK_sync serializes the callers, which count commits in sync_counter.
 */
 std::pair<bool, bool>
 MYSQL_BIN_LOG::sync_binlog_file(bool force, bool async)
@@ -10245,6 +10525,7 @@ MYSQL_BIN_LOG::sync_binlog_file(bool force, bool async)
   bool synced= false;
   ulonglong start_time, binlog_fsync_time;
   unsigned int sync_period= get_sync_period();
+  mysql_mutex_assert_owner(&LOCK_sync);
   if (force || (!async && (sync_period && ++sync_counter >= sync_period)))
   {
     sync_counter= 0;
@@ -10284,6 +10565,111 @@ MYSQL_BIN_LOG::sync_binlog_file(bool force, bool async)
 }
 
 
+/**
+  Record how far the flush stage wrote the binary log file, for the sync
+  stage to publish once it is on disk.
+*/
+void MYSQL_BIN_LOG::set_flushed_end_pos(my_off_t pos)
+{
+  mysql_mutex_assert_owner(&LOCK_log);
+  lock_binlog_end_pos();
+  strmake(flushed_file_name, log_file_name, sizeof(flushed_file_name) - 1);
+  flushed_end_pos= pos;
+  unlock_binlog_end_pos();
+}
+
+
+/**
+  Let the sync stage queue grow before the leader calls fsync.
+
+  The leader waits as long as the pacer expects more sessions to reach the
+  sync stage in time to share the fsync, and never longer than
+  binlog_group_commit_sync_max_delay. Flush groups keep being written and
+  queued meanwhile, as LOCK_log is free.
+*/
+void MYSQL_BIN_LOG::wait_for_sync_group(bool async)
+{
+  const uint sync_period= get_sync_period();
+  mysql_mutex_assert_owner(&LOCK_sync);
+
+  /* Waiting only pays off if this group is going to call fsync */
+  if (async || !opt_binlog_group_commit_sync_max_delay || !sync_period ||
+      sync_counter + 1 < sync_period)
+    return;
+
+  const ulonglong start= my_micro_time();
+  uint size;
+  ulonglong delay;
+  while ((delay= sync_pacer.get_delay(
+                   size= stage_manager.get_queue_size(
+                     Stage_manager::SYNC_STAGE),
+                   opt_binlog_group_commit_sync_max_delay)))
+  {
+    const ulonglong waited= my_micro_time() - start;
+    if (waited >= delay)
+      break;
+    /* Sleep until a session enrolls, as that changes the expected delay */
+    struct timespec abstime;
+    set_timespec_nsec(abstime, (delay - waited) * 1000ULL);
+    stage_manager.wait_for_sync_enrollment(size, &abstime);
+  }
+}
+
+
+/**
+  Sync the binary log file for the groups that entered the sync stage, and
+  make what they wrote visible to the dump threads.
+
+  This runs without LOCK_log, so the next groups may be writing the file
+  meanwhile. The position to publish is read before the fsync, so that it
+  only covers bytes already written. If the file was rotated since, closing
+  it has synced and published it already.
+
+  @retval 0 success
+  @retval 1 fsync failed
+*/
+int MYSQL_BIN_LOG::sync_flushed_groups(THD *thd, bool async)
+{
+  char file_name[FN_REFLEN];
+  my_off_t end_pos;
+  mysql_mutex_assert_owner(&LOCK_sync);
+  mysql_mutex_assert_not_owner(&LOCK_log);
+
+  lock_binlog_end_pos();
+  strmake(file_name, flushed_file_name, sizeof(file_name) - 1);
+  end_pos= flushed_end_pos;
+  bool pending= end_pos > binlog_end_pos &&
+                !strcmp(file_name, binlog_file_name);
+  unlock_binlog_end_pos();
+  if (!pending)
+    return 0;
+
+  DEBUG_SYNC(thd, "before_sync_binlog_file");
+  ulonglong start_time= my_timer_now();
+  std::pair<bool, bool> result= sync_binlog_file(false, async);
+  if (result.first)
+    return 1;
+  if (result.second)
+    sync_pacer.record_fsync(
+      my_timer_to_microseconds_ulonglong(my_timer_since(start_time)));
+
+  /*
+    Update the binlog end position only after binlog fsync. Doing so
+    guarantees that slave's don't up with some transactions
+    that haven't made it to the disk on master because of a os
+    crash or power failure just before binlog fsync.
+  */
+  lock_binlog_end_pos();
+  if (end_pos > binlog_end_pos && !strcmp(file_name, binlog_file_name))
+  {
+    binlog_end_pos= end_pos;
+    signal_update();
+  }
+  unlock_binlog_end_pos();
+  return 0;
+}
+
+
 /**
    Helper function executed when leaving @c ordered_commit.
 
@@ -10825,6 +11211,9 @@ int MYSQL_BIN_LOG::ordered_commit(THD *thd, bool all, bool skip_commit,
 
   THD *final_queue= NULL;
   mysql_mutex_t *leave_mutex_before_commit_stage= NULL;
+  mysql_mutex_t *leave_mutex_before_semisync_stage= &LOCK_log;
+  /* The raft plugin expects the binlog to be synced under LOCK_log */
+  const bool sync_under_log_lock= enable_raft_plugin;
   my_off_t flush_end_pos= 0;
   if (unlikely(!is_open()))
   {
@@ -10871,31 +11260,38 @@ int MYSQL_BIN_LOG::ordered_commit(THD *thd, bool all, bool skip_commit,
       flush_error= ER_ERROR_ON_WRITE;
     }
 
-    /*
-      Stage #2: Syncing binary log file to disk
-    */
-    if (total_bytes > 0)
+    if (sync_under_log_lock)
     {
-      DEBUG_SYNC(thd, "before_sync_binlog_file");
-      std::pair<bool, bool> result = sync_binlog_file(false, async);
-      flush_error = result.first;
-    }
+      /*
+        Stage #2: Syncing binary log file to disk
+      */
+      if (total_bytes > 0)
+      {
+        DEBUG_SYNC(thd, "before_sync_binlog_file");
+        mysql_mutex_lock(&LOCK_sync);
+        std::pair<bool, bool> result = sync_binlog_file(false, async);
+        mysql_mutex_unlock(&LOCK_sync);
+        flush_error = result.first;
+      }
 
-    /*
-      Update the last valid position after the after_flush hook has
-      executed. Doing so guarantees that the hook is executed before
-      the before/after_send_hooks on the dump thread, preventing race
-      conditions between the group_commit here and the dump threads.
-    */
-    /*
-      Update the binlog end position only after binlog fsync. Doing so
-      guarantees that slave's don't up with some transactions
-      that haven't made it to the disk on master because of a os
-      crash or power failure just before binlog fsync.
-    */
-    update_binlog_end_pos();
+      /*
+        Update the last valid position after the after_flush hook has
+        executed. Doing so guarantees that the hook is executed before
+        the before/after_send_hooks on the dump thread, preventing race
+        conditions between the group_commit here and the dump threads.
+      */
+      /*
+        Update the binlog end position only after binlog fsync. Doing so
+        guarantees that slave's don't up with some transactions
+        that haven't made it to the disk on master because of a os
+        crash or power failure just before binlog fsync.
+      */
+      update_binlog_end_pos();
 
-    DBUG_EXECUTE_IF("crash_commit_after_log", DBUG_SUICIDE(););
+      DBUG_EXECUTE_IF("crash_commit_after_log", DBUG_SUICIDE(););
+    }
+    else
+      set_flushed_end_pos(flush_end_pos);
   }
 
   /* simulate a write failure during commit - needed for unit test */
@@ -10913,9 +11309,36 @@ int MYSQL_BIN_LOG::ordered_commit(THD *thd, bool all, bool skip_commit,
     handle_binlog_flush_or_sync_error(thd, false /* need_lock_log */);
   }
 
+  /*
+    Stage #2: Syncing binary log file to disk
+
+    The leader hands LOCK_log over to the next flush group before calling
+    fsync, so that group writes the binary log while this one waits for
+    the disk, and is synced with the groups queued behind it next.
+  */
+  if (!sync_under_log_lock)
+  {
+    uint sync_count;
+    if (change_stage(thd, Stage_manager::SYNC_STAGE, final_queue,
+                     &LOCK_log, &LOCK_sync))
+    {
+      DBUG_PRINT("return", ("Thread ID: %u, commit_error: %d",
+                            thd->thread_id(), thd->commit_error));
+      DBUG_RETURN(finish_commit(thd, async));
+    }
+    wait_for_sync_group(async);
+    final_queue= stage_manager.fetch_queue_for(Stage_manager::SYNC_STAGE,
+                                               &sync_count);
+    sync_pacer.record_group(my_micro_time(), sync_count);
+    sync_error= sync_flushed_groups(thd, async);
+    leave_mutex_before_semisync_stage= &LOCK_sync;
+
+    DBUG_EXECUTE_IF("crash_commit_after_log", DBUG_SUICIDE(););
+  }
+
 commit_stage:
   if (change_stage(thd, Stage_manager::SEMISYNC_STAGE, final_queue,
-                   &LOCK_log, &LOCK_semisync))
+                   leave_mutex_before_semisync_stage, &LOCK_semisync))
   {
     DBUG_PRINT("return", ("Thread ID: %u, commit_error: %d",
                           thd->thread_id(), thd->commit_error));
@@ -13263,6 +13686,118 @@ CPP_UNNAMED_NS_START
 
 CPP_UNNAMED_NS_END
 
+/**
+  Add the hashes of the unique keys of a row image to the write set of the
+  cache the row is written to, see binlog_transaction_dependency_tracking.
+
+  Two row changes conflict if the rows have the same value of a unique
+  key, so hashing every unique key of the before and after images finds
+  all the conflicts between transactions. When a row cannot be identified
+  that way, the write set is marked unsafe instead.
+
+  @param thd        The session writing the row
+  @param table      The table of the row
+  @param is_trans   If the row is written to the transactional cache
+  @param record     The row image, in the format of table->record[0]
+  @param read_set   Columns present in the image, NULL if all are
+  @param write_set  More columns present in the image, or NULL
+*/
+static void add_row_to_write_set(THD *thd, TABLE *table, bool is_trans,
+                                 const uchar *record,
+                                 const MY_BITMAP *read_set,
+                                 const MY_BITMAP *write_set)
+{
+  binlog_cache_data *cache_data=
+    thd_get_cache_mngr(thd)->get_binlog_cache_data(is_trans);
+  if (cache_data->is_write_set_unsafe())
+    return;
+
+  if (!cache_data->has_dependency_placeholder())
+  {
+    /* Written without dependency interval, the write set is not used */
+    if (cache_data->has_written_events())
+      return;
+    /*
+      The placeholder is reserved with the first event. Should tracking be
+      enabled by then, the write set would miss this row.
+    */
+    if (binlog_transaction_dependency_tracking == DEPENDENCY_TRACKING_NONE)
+    {
+      cache_data->set_write_set_unsafe();
+      return;
+    }
+  }
+
+  /* Rows of a parent table also conflict with the rows referencing them */
+  if (table->file->referenced_by_foreign_key())
+  {
+    cache_data->set_write_set_unsafe();
+    return;
+  }
+
+  const my_ptrdiff_t offset= record - table->record[0];
+  uint32 table_hash= murmur3_32((const uchar*) table->s->db.str,
+                                table->s->db.length, 0);
+  table_hash= murmur3_32((const uchar*) table->s->table_name.str,
+                         table->s->table_name.length, table_hash);
+  bool identified= false;
+
+  for (uint i= 0; i < table->s->keys; i++)
+  {
+    const KEY *key= table->key_info + i;
+    if (!(key->flags & HA_NOSAME))
+      continue;
+
+    /* The hash of the key name, then the hash of every key part */
+    ulonglong buf[MAX_REF_PARTS + 1];
+    bool has_null= false;
+    buf[0]= murmur3_32((const uchar*) key->name, strlen(key->name),
+                       table_hash);
+
+    for (uint j= 0; j < key->user_defined_key_parts; j++)
+    {
+      const KEY_PART_INFO *key_part= key->key_part + j;
+      Field *field= key_part->field;
+
+      /* Rows with different values can conflict on a prefix, and the
+         values of the columns that were not read are not known */
+      if ((key_part->key_part_flag & (HA_PART_KEY_SEG | HA_BLOB_PART)) ||
+          (read_set && !bitmap_is_set(read_set, field->field_index) &&
+           !(write_set && bitmap_is_set(write_set, field->field_index))))
+      {
+        cache_data->set_write_set_unsafe();
+        return;
+      }
+
+      /* NULLs do not conflict with each other */
+      if (field->is_null_in_record(record))
+      {
+        has_null= true;
+        break;
+      }
+
+      /* Collation aware, e.g. 'a' and 'A ' conflict in a _ci column */
+      ulong nr1= 1, nr2= 4;
+      field->move_field_offset(offset);
+      field->hash(&nr1, &nr2);
+      field->move_field_offset(-offset);
+      buf[j + 1]= nr1;
+    }
+
+    if (has_null)
+      continue;
+
+    const size_t len= (key->user_defined_key_parts + 1) * sizeof(buf[0]);
+    cache_data->add_to_write_set(
+        (ulonglong) murmur3_32((const uchar*) buf, len, 0) << 32 |
+        murmur3_32((const uchar*) buf, len, 1));
+    identified= true;
+  }
+
+  if (!identified)
+    cache_data->set_write_set_unsafe();
+}
+
 int THD::binlog_write_row(TABLE* table, bool is_trans,
                           uchar const *record,
                           const uchar* extra_row_info)
@@ -13289,6 +13824,8 @@ int THD::binlog_write_row(TABLE* table, bool is_trans,
   if (unlikely(ev == 0))
     return HA_ERR_OUT_OF_MEM;
 
+  add_row_to_write_set(this, table, is_trans, record, NULL, NULL);
+
   return ev->add_row_data(row_data, len);
 }
 
@@ -13349,6 +13886,11 @@ int THD::binlog_update_row(TABLE* table, bool is_trans,
   if (unlikely(ev == 0))
     return HA_ERR_OUT_OF_MEM;
 
+  add_row_to_write_set(this, table, is_trans, before_record,
+                       old_read_set, NULL);
+  add_row_to_write_set(this, table, is_trans, after_record,
+                       old_read_set, old_write_set);
+
   error= ev->add_row_data(before_row, before_size) ||
          ev->add_row_data(after_row, after_size);
 
@@ -13401,6 +13943,8 @@ int THD::binlog_delete_row(TABLE* table, bool is_trans,
   if (unlikely(ev == 0))
     return HA_ERR_OUT_OF_MEM;
 
+  add_row_to_write_set(this, table, is_trans, record, old_read_set, NULL);
+
   error= ev->add_row_data(row_data, len);
 
   /* restore read/write set for the rest of execution */
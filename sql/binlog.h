@@ -23,6 +23,7 @@
 #include <atomic>
 #include <list>
 #include <unordered_map>
+#include <vector>
 
 extern ulong rpl_read_size;
 extern char *histogram_step_size_binlog_fsync;
@@ -69,7 +70,8 @@ public:
     friend class Stage_manager;
   public:
     Mutex_queue()
-      : m_first(NULL), m_last(&m_first), group_prepared_engine(NULL)
+      : m_first(NULL), m_last(&m_first), m_size(0),
+        group_prepared_engine(NULL)
     {
     }
 
@@ -93,6 +95,11 @@ public:
       return m_first == NULL;
     }
 
+    /** Number of sessions in the queue, read without the queue lock. */
+    uint get_size() const {
+      return m_size.load(std::memory_order_relaxed);
+    }
+
     /** Append a linked list of threads to the queue */
     bool append(THD *first);
 
@@ -100,8 +107,10 @@ public:
        Fetch the entire queue for a stage.
 
        This will fetch the entire queue in one go.
+
+       @param[out] size_var  Number of sessions fetched.
     */
-    THD *fetch_and_empty();
+    THD *fetch_and_empty(uint *size_var);
 
   private:
     void lock() { mysql_mutex_lock(&m_lock); }
@@ -121,6 +130,9 @@ public:
     */
     THD **m_last;
 
+    /** Number of sessions in the queue, updated under the queue lock. */
+    std::atomic<uint> m_size;
+
     /**
        Store the max prepared log for each engine that supports ha_flush_logs.
        We have to init group_prepared_engine after all plugins are inited.
@@ -168,6 +180,8 @@ public:
     /* reuse key_COND_done 'cos a new PSI object would be wasteful in DBUG_ON */
     mysql_cond_init(key_COND_done, &m_cond_preempt, NULL);
 #endif
+    /* reuse key_COND_done, as above */
+    mysql_cond_init(key_COND_done, &m_cond_sync_enrolled, NULL);
     m_queue[FLUSH_STAGE].init(
 #ifdef HAVE_PSI_INTERFACE
                               key_LOCK_flush_queue
@@ -194,6 +208,7 @@ public:
   {
     for (size_t i = 0 ; i < STAGE_COUNTER ; ++i)
       m_queue[i].deinit();
+    mysql_cond_destroy(&m_cond_sync_enrolled);
     mysql_cond_destroy(&m_cond_done);
     mysql_mutex_destroy(&m_lock_done);
   }
@@ -240,13 +255,23 @@ public:
   /**
     Fetch the entire queue and empty it.
 
+    @param[out] size_var  Number of sessions fetched, if not NULL.
+
     @return Pointer to the first session of the queue.
    */
-  THD *fetch_queue_for(StageID stage) {
-    DBUG_PRINT("debug", ("Fetching queue for stage %d", stage));
-    return m_queue[stage].fetch_and_empty();
+  THD *fetch_queue_for(StageID stage, uint *size_var= NULL);
+
+  /** Number of sessions waiting in the queue of a stage. */
+  uint get_queue_size(StageID stage) const {
+    return m_queue[stage].get_size();
   }
 
+  /**
+    Wait until more than size sessions are queued for the sync stage, or
+    until abstime. The wait may end early, so callers check again.
+   */
+  void wait_for_sync_enrollment(uint size, const struct timespec *abstime);
+
   void signal_done(THD *queue) {
     mysql_mutex_lock(&m_lock_done);
     for (THD *thd= queue ; thd ; thd = thd->next_to_commit)
@@ -270,6 +295,12 @@ private:
 
   /** Mutex used for the condition variable above */
   mysql_mutex_t m_lock_done;
+
+  /**
+    Condition variable signalled when sessions are appended to the sync
+    stage queue, used with the lock of that queue.
+  */
+  mysql_cond_t m_cond_sync_enrolled;
 #ifndef DBUG_OFF
   /** Flag is set by Leader when it starts waiting for follower's all-clear */
   bool leader_await_preempt_status;
@@ -279,6 +310,16 @@ private:
 #endif
 };
 
+/*
+  Number of sessions a stage leader processes in one go, and how long the
+  leader waited to enter its stage. The flush stage group size is counted
+  by histogram_binlog_group_commit.
+*/
+extern counter_histogram
+  histogram_binlog_stage_queue[Stage_manager::STAGE_COUNTER];
+extern latency_histogram
+  histogram_binlog_stage_wait[Stage_manager::STAGE_COUNTER];
+
 /**
  * A class abstracting a hybrid logical clock. Some important aspects of this
  * clock:
@@ -446,6 +487,106 @@ class HybridLogicalClock {
   mutable std::mutex database_map_lock_;
 };
 
+/* Values of binlog_transaction_dependency_tracking */
+enum enum_binlog_transaction_dependency_tracking
+{
+  DEPENDENCY_TRACKING_NONE= 0,
+  DEPENDENCY_TRACKING_WRITESET,
+  DEPENDENCY_TRACKING_WRITESET_SESSION
+};
+
+/**
+ * Assigns dependency intervals (last_committed, sequence_number) to the
+ * transactions written to the binlog, from the hashes of the unique keys of
+ * the rows they wrote (their write set). A transaction only conflicts with
+ * the transactions up to last_committed, so a slave can apply transactions
+ * whose intervals overlap in parallel, without looking at their rows.
+ *
+ * Sequence numbers are relative to the current binlog file: the first
+ * transaction of a file has sequence number 1, and last_committed 0 means
+ * no conflict in this file. All methods must be called with LOCK_log held.
+ */
+class Writeset_dependency_tracker {
+ public:
+  Writeset_dependency_tracker()
+    : sequence_(0), file_base_(0), history_start_(0) {}
+
+  /**
+   * Assign the interval of the next transaction and add its write set to
+   * the history.
+   *
+   * @param thd - session of the transaction
+   * @param write_set - hashes of the unique keys of the rows it wrote
+   * @param unsafe - the write set misses some of its conflicts
+   * @param [out] last_committed
+   * @param [out] sequence_number
+   */
+  void get_interval(THD *thd, const std::vector<ulonglong>& write_set,
+                    bool unsafe, int64_t *last_committed,
+                    int64_t *sequence_number);
+
+  /**
+   * Make the next transaction depend on all the previous ones. Called for
+   * the transactions written without an interval.
+   */
+  void reset();
+
+  /* Number the transactions of a new binlog file from 1 */
+  void rotate() { file_base_= sequence_; }
+
+ private:
+  /* Sequence number of the last transaction, counted from server start */
+  int64_t sequence_;
+  /* sequence_ when the current binlog file was opened */
+  int64_t file_base_;
+  /* Transactions conflict with all the ones up to this one */
+  int64_t history_start_;
+  /* Last transaction that wrote each hash after history_start_ */
+  std::unordered_map<ulonglong, int64_t> history_;
+};
+
+/**
+ * Sizes the groups of the binlog sync stage. It keeps moving averages of
+ * the fsync latency and of the time between two sessions reaching the sync
+ * stage, and from those tells the sync stage leader how long waiting for
+ * more sessions pays off before it calls fsync: as long as fewer sessions
+ * are queued than arrive during one fsync, the next fsync can cover them.
+ *
+ * Only the sync stage leader uses it, with LOCK_sync held.
+ */
+class Group_commit_pacer {
+ public:
+  Group_commit_pacer()
+    : fsync_usecs_(0), arrival_usecs_(0), last_fetch_(0) {}
+
+  /**
+   * Account for a sync stage group.
+   *
+   * @param now - time the leader fetched the group, in microseconds
+   * @param count - number of sessions in the group
+   */
+  void record_group(ulonglong now, uint count);
+
+  /* Account for an fsync that took usecs microseconds */
+  void record_fsync(ulonglong usecs);
+
+  /**
+   * @param queued - sessions waiting for the sync stage
+   * @param max_delay - upper bound of the wait, in microseconds
+   *
+   * @return microseconds to wait for more sessions, 0 to sync right away
+   */
+  ulonglong get_delay(uint queued, ulonglong max_delay) const;
+
+ private:
+  /* Moving average of the fsync latency */
+  double fsync_usecs_;
+  /* Moving average of the time between two sessions reaching the stage */
+  double arrival_usecs_;
+  /* When the previous group was fetched */
+  ulonglong last_fetch_;
+};
+
 class MYSQL_BIN_LOG: public TC_LOG, private MYSQL_LOG
 {
   friend class Dump_log;
@@ -543,6 +684,7 @@ public:
      sync_relay_log_period
   */
   uint *sync_period_ptr;
+  /* Commits since the last fsync, protected by LOCK_sync */
   uint sync_counter;
 
   my_atomic_rwlock_t m_prep_xids_lock;
@@ -557,6 +699,11 @@ public:
   // binlog_file_name is protected by LOCK_binlog_end_pos mutex where as
   // log_file_name is protected by LOCK_log mutex.
   char binlog_file_name[FN_REFLEN];
+  // Last position written to the binlog file by the flush stage. The sync
+  // stage reads it to know how far the file is on disk once it has synced,
+  // without taking LOCK_log. Protected by LOCK_binlog_end_pos.
+  char flushed_file_name[FN_REFLEN];
+  my_off_t flushed_end_pos;
 
   /**
     Increment the prepared XID counter.
@@ -906,6 +1053,17 @@ public:
 
   bool check_hlc_bound(THD *thd) { return hlc.check_hlc_bound(thd); }
 
+  /* Dependency interval of the next transaction written to the binlog */
+  void get_dependency_interval(THD *thd,
+                               const std::vector<ulonglong>& write_set,
+                               bool unsafe, int64_t *last_committed,
+                               int64_t *sequence_number) {
+    dependency_tracker.get_interval(thd, write_set, unsafe, last_committed,
+                                    sequence_number);
+  }
+
+  void reset_dependency_history() { dependency_tracker.reset(); }
+
   /*
    * @param raft_rotate_info
    *   Rotate related information passed in by listener callbacks.
@@ -926,6 +1084,13 @@ private:
   */
   HybridLogicalClock hlc;
 
+  /* Write set history of binlog_transaction_dependency_tracking, protected
+     by LOCK_log */
+  Writeset_dependency_tracker dependency_tracker;
+
+  /* Sizes the sync stage groups, protected by LOCK_sync */
+  Group_commit_pacer sync_pacer;
+
   /*
      This is set when we have registered log entities with raft plugin
      during ordered commit, after we have become master on step up.
@@ -941,6 +1106,9 @@ private:
   int flush_cache_to_file(my_off_t *flush_end_pos);
   int finish_commit(THD *thd, bool async);
   std::pair<bool, bool> sync_binlog_file(bool force, bool async);
+  void set_flushed_end_pos(my_off_t pos);
+  void wait_for_sync_group(bool async);
+  int sync_flushed_groups(THD *thd, bool async);
   void process_semisync_stage_queue(THD *queue_head);
   void process_commit_stage_queue(THD *thd, THD *queue, bool async);
   void set_commit_consensus_error(THD *queue_head);
@@ -1264,6 +1432,9 @@ public:
     mysql_mutex_lock(&LOCK_log);
     counter_histogram_init(&histogram_binlog_group_commit,
                            opt_histogram_step_size_binlog_group_commit);
+    for (uint i= 0; i < Stage_manager::STAGE_COUNTER; i++)
+      counter_histogram_init(&histogram_binlog_stage_queue[i],
+                             opt_histogram_step_size_binlog_group_commit);
     mysql_mutex_unlock(&LOCK_log);
   }
   static const int MAX_RETRIES_FOR_DELETE_RENAME_FAILURE = 5;
@@ -1456,6 +1627,7 @@ int gtid_empty_group_log_and_cleanup(THD *thd);
 extern const char *log_bin_index;
 extern const char *log_bin_basename;
 extern bool opt_binlog_order_commits;
+extern ulong opt_binlog_group_commit_sync_max_delay;
 extern bool opt_gtid_precommit;
 
 /**
@@ -1,5 +1,7 @@
 #include "column_statistics.h"
 
+#include <atomic>
+
 #include "sql_class.h"
 #include "sql_show.h" // schema_table_store_record
 
@@ -24,6 +26,22 @@ ST_FIELD_INFO column_statistics_fields_info[]=
 // Mapping from SQL_ID to column usage information.
 std::unordered_map<md5_key, std::set<ColumnUsageInfo> > col_statistics_map;
 
+// Incremented under LOCK_column_statistics whenever col_statistics_map is
+// cleared, so that sessions forget the SQL IDs they have seen collected.
+static std::atomic<ulonglong> col_statistics_version(1);
+
+// Number of SQL IDs a session buffers before merging them into
+// col_statistics_map.
+static const size_t COLUMN_USAGE_FLUSH_BATCH= 16;
+
+// Microseconds after which column usage buffered by a session is merged
+// into col_statistics_map at the end of its next statement, even if the
+// batch is not full.
+static const ulonglong COLUMN_USAGE_FLUSH_INTERVAL= 1000000;
+
+// Maximum number of collected SQL IDs a session remembers.
+static const size_t COLUMN_USAGE_KNOWN_MAX= 1024;
+
 // Operator definition for strict weak ordering. Should be a function of all
 // constituents of the struct.
 bool ColumnUsageInfo::operator<(const ColumnUsageInfo& other) const {
@@ -402,8 +420,10 @@ int parse_column_usage_info(THD *thd) {
 
   // Return early without doing anything if
   // 1. COLUMN_STATS switch is not ON
-  // 2. The SQL_ID was already processed
+  // 2. The execution is not sampled
+  // 3. The SQL_ID was already processed
   if (column_stats_control != SQL_INFO_CONTROL_ON ||
+      !sample_column_usage_info(thd) ||
       exists_column_usage_info(thd))
   {
     DBUG_RETURN(0);
@@ -476,10 +496,56 @@ int parse_column_usage_info(THD *thd) {
   DBUG_RETURN(0);
 }
 
+/*
+  sync_column_usage_version
+    Forget the SQL IDs and buffered column usage of the session if
+    col_statistics_map was cleared since they were recorded.
+*/
+static void sync_column_usage_version(THD *thd) {
+  const ulonglong version= col_statistics_version.load();
+  if (thd->column_usage_version != version) {
+    thd->column_usage_known.clear();
+    thd->column_usage_buffer.clear();
+    thd->column_usage_version= version;
+  }
+}
+
+/*
+  remember_column_usage_info
+    Remember that column usage of the SQL ID was collected, so that later
+    executions skip the parse tree walk without looking at
+    col_statistics_map.
+*/
+static bool remember_column_usage_info(THD *thd, const md5_key& sql_id) {
+  if (thd->column_usage_known.size() >= COLUMN_USAGE_KNOWN_MAX) {
+    thd->column_usage_known.clear();
+  }
+  return thd->column_usage_known.insert(sql_id).second;
+}
+
+bool sample_column_usage_info(THD *thd) {
+  const uint rate= column_stats_sample_rate;
+  return rate <= 1 || my_rnd(&thd->column_usage_rand) * rate < 1.0;
+}
+
 void populate_column_usage_info(THD *thd) {
   DBUG_ENTER("populate_column_usage_info");
   DBUG_ASSERT(thd);
 
+  // Take the column usage of the statement, later statements that are not
+  // sampled must not see it.
+  std::set<ColumnUsageInfo> cus;
+  cus.swap(thd->column_usage_info);
+
+  // Sessions that rarely see new SQL IDs, such as long lived pooled
+  // connections, must not hold a partial batch back indefinitely.
+  if (!thd->column_usage_buffer.empty() &&
+      thd->start_utime >= thd->column_usage_buffer_time +
+                          COLUMN_USAGE_FLUSH_INTERVAL)
+  {
+    flush_column_usage_info(thd);
+  }
+
   // If the transaction wasn't successful, return.
   // Column usage statistics are not updated in this case.
   if (thd->is_error() || (thd->variables.option_bits & OPTION_MASTER_SQL_ERROR))
@@ -491,19 +557,47 @@ void populate_column_usage_info(THD *thd) {
     - the column usage information is empty
     - SQL_ID is not set
   */
-  if (thd->column_usage_info.empty() || !thd->mt_key_is_set(THD::SQL_ID))
+  if (cus.empty() || !thd->mt_key_is_set(THD::SQL_ID))
+  {
+    DBUG_VOID_RETURN;
+  }
+
+  sync_column_usage_version(thd);
+  const md5_key& sql_id= thd->mt_key_value(THD::SQL_ID);
+  if (remember_column_usage_info(thd, sql_id))
+  {
+    if (thd->column_usage_buffer.empty())
+      thd->column_usage_buffer_time= thd->start_utime;
+    thd->column_usage_buffer.emplace_back(sql_id, std::move(cus));
+    // Without sampling new SQL IDs are rare enough to publish each at once.
+    if (column_stats_sample_rate <= 1 ||
+        thd->column_usage_buffer.size() >= COLUMN_USAGE_FLUSH_BATCH)
+      flush_column_usage_info(thd);
+  }
+  DBUG_VOID_RETURN;
+}
+
+void flush_column_usage_info(THD *thd) {
+  DBUG_ENTER("flush_column_usage_info");
+  DBUG_ASSERT(thd);
+
+  if (thd->column_usage_buffer.empty())
   {
     DBUG_VOID_RETURN;
   }
 
   mysql_rwlock_wrlock(&LOCK_column_statistics);
-  auto iter= col_statistics_map.find(thd->mt_key_value(THD::SQL_ID));
-  if (iter == col_statistics_map.end())
+  // Drop what was collected before col_statistics_map was last cleared.
+  if (thd->column_usage_version == col_statistics_version.load())
   {
-    col_statistics_map.insert(
-        std::make_pair(thd->mt_key_value(THD::SQL_ID), thd->column_usage_info));
+    for (auto& entry : thd->column_usage_buffer)
+    {
+      col_statistics_map.insert(std::move(entry));
+    }
   }
   mysql_rwlock_unlock(&LOCK_column_statistics);
+
+  thd->column_usage_buffer.clear();
   DBUG_VOID_RETURN;
 }
 
@@ -516,12 +610,22 @@ bool exists_column_usage_info(THD *thd) {
     DBUG_RETURN(true);
   }
 
+  sync_column_usage_version(thd);
+  const md5_key& sql_id= thd->mt_key_value(THD::SQL_ID);
+  if (thd->column_usage_known.count(sql_id)) {
+    DBUG_RETURN(true);
+  }
+
   mysql_rwlock_rdlock(&LOCK_column_statistics);
   bool exists =
-      (col_statistics_map.find(thd->mt_key_value(THD::SQL_ID)) ==
+      (col_statistics_map.find(sql_id) ==
           col_statistics_map.end()) ? false : true;
   mysql_rwlock_unlock(&LOCK_column_statistics);
 
+  if (exists) {
+    remember_column_usage_info(thd, sql_id);
+  }
+
   DBUG_RETURN(exists);
 }
 
@@ -530,6 +634,10 @@ int fill_column_statistics(THD *thd, TABLE_LIST *tables, Item *cond)
   DBUG_ENTER("fill_column_statistics");
   TABLE* table= tables->table;
 
+  // Make the statements of this session visible without waiting for a
+  // full batch.
+  flush_column_usage_info(thd);
+
   mysql_rwlock_rdlock(&LOCK_column_statistics);
   for (auto iter= col_statistics_map.cbegin();
       iter != col_statistics_map.cend(); ++iter)
@@ -579,5 +687,6 @@ void free_column_stats()
 {
   mysql_rwlock_wrlock(&LOCK_column_statistics);
   col_statistics_map.clear();
+  col_statistics_version++;
   mysql_rwlock_unlock(&LOCK_column_statistics);
 }
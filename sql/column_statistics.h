@@ -172,10 +172,22 @@ extern int parse_column_usage_info(THD *thd);
 */
 extern bool exists_column_usage_info(THD *thd);
 
+/*
+  sample_column_usage_info
+    Returns TRUE if column usage statistics should be collected for this
+    execution, one out of column_stats_sample_rate on average.
+  Input:
+    thd        in: THD
+*/
+extern bool sample_column_usage_info(THD *thd);
+
 /*
   populate_column_usage_info
     Populates column usage information into the temporary table data structures.
-    This information was derived in `parse_column_usage_info`.
+    This information was derived in `parse_column_usage_info`. It is buffered
+    in the session and merged into col_statistics_map in batches, at once
+    when column_stats_sample_rate is 1, and at the end of the first
+    statement a second after the batch was started.
   Input:
     thd        in: THD
     cus        in: std::set<ColumnUsageInfo>
@@ -186,6 +198,15 @@ extern bool exists_column_usage_info(THD *thd);
 */
 extern void populate_column_usage_info(THD *thd);
 
+/*
+  flush_column_usage_info
+    Merges the column usage information buffered by the session into
+    col_statistics_map.
+  Input:
+    thd        in: THD
+*/
+extern void flush_column_usage_info(THD *thd);
+
 /*
   fill_column_statistics
     Populates the temporary table by reading from the column usage map.
@@ -0,0 +1,275 @@
+/* Copyright (c) 2016, Facebook, Inc. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#ifndef DEPENDENCY_QUEUE_H
+#define DEPENDENCY_QUEUE_H
+
+#include <atomic>
+#include <functional>
+#include <new>
+#include <unordered_map>
+#include "my_global.h"
+#include "mysql/psi/mysql_thread.h"
+
+/**
+  @class Dependency_queue
+
+  Bounded lock-free multi-producer multi-consumer ring, used to hand
+  transactions from the coordinator to the dependency workers.
+
+  Every cell carries a sequence number. A cell at position pos can be
+  written when its sequence is pos and read when it is pos + 1, so
+  producers and consumers only race on their own position with a CAS and
+  never wait for each other. Callers block on their own condition
+  variables when the ring is empty or full.
+*/
+template <typename T>
+class Dependency_queue
+{
+public:
+  Dependency_queue()
+    : m_cells(nullptr), m_mask(0), m_enqueue_pos(0), m_dequeue_pos(0)
+  {}
+
+  ~Dependency_queue() { destroy(); }
+
+  /**
+    Make room for at least capacity elements. The ring must be empty and
+    unused while this runs.
+
+    @return true if out of memory
+  */
+  bool init(size_t capacity)
+  {
+    size_t size= 2;
+    while (size < capacity)
+      size<<= 1;
+
+    if (size != m_mask + 1)
+    {
+      destroy();
+      if (!(m_cells= new (std::nothrow) Cell[size]))
+        return true;
+      m_mask= size - 1;
+    }
+
+    for (size_t i= 0; i < size; i++)
+    {
+      m_cells[i].value= T();
+      m_cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+    m_enqueue_pos.store(0);
+    m_dequeue_pos.store(0);
+    return false;
+  }
+
+  void destroy()
+  {
+    delete[] m_cells;
+    m_cells= nullptr;
+    m_mask= 0;
+  }
+
+  /** @return false if the ring is full */
+  bool enqueue(const T &value)
+  {
+    size_t pos= m_enqueue_pos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      Cell *cell= &m_cells[pos & m_mask];
+      const size_t seq= cell->seq.load(std::memory_order_acquire);
+      const intptr diff= (intptr) seq - (intptr) pos;
+      if (diff == 0)
+      {
+        if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1))
+        {
+          cell->value= value;
+          cell->seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0)
+        return false;
+      else
+        pos= m_enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  /** @return false if the ring is empty */
+  bool dequeue(T *value)
+  {
+    if (unlikely(!m_cells))
+      return false;
+
+    size_t pos= m_dequeue_pos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      Cell *cell= &m_cells[pos & m_mask];
+      const size_t seq= cell->seq.load(std::memory_order_acquire);
+      const intptr diff= (intptr) seq - (intptr) (pos + 1);
+      if (diff == 0)
+      {
+        if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1))
+        {
+          *value= std::move(cell->value);
+          cell->value= T();
+          cell->seq.store(pos + m_mask + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0)
+        return false;
+      else
+        pos= m_dequeue_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  /** Number of elements, exact only when no one else uses the ring. */
+  size_t size() const
+  {
+    const size_t dequeued= m_dequeue_pos.load();
+    const size_t enqueued= m_enqueue_pos.load();
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  size_t capacity() const { return m_cells ? m_mask + 1 : 0; }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> seq;
+    T value;
+  };
+
+  Cell *m_cells;
+  size_t m_mask;
+  char m_pad1[CPU_LEVEL1_DCACHE_LINESIZE];
+  std::atomic<size_t> m_enqueue_pos;
+  char m_pad2[CPU_LEVEL1_DCACHE_LINESIZE];
+  std::atomic<size_t> m_dequeue_pos;
+  char m_pad3[CPU_LEVEL1_DCACHE_LINESIZE];
+};
+
+
+/**
+  @class Dependency_key_map
+
+  Hash map split in shards with a mutex each, so that lookups of keys of
+  unrelated rows do not serialize on one lock. A shard lock is never held
+  while user code runs: values are copied out, and callers must not take
+  another lock while they hold a shard.
+*/
+template <typename Key, typename Value, uint N_SHARDS= 64>
+class Dependency_key_map
+{
+public:
+  Dependency_key_map()
+  {
+    for (uint i= 0; i < N_SHARDS; i++)
+      mysql_mutex_init(0, &m_shards[i].mutex, MY_MUTEX_INIT_FAST);
+  }
+
+  ~Dependency_key_map()
+  {
+    for (uint i= 0; i < N_SHARDS; i++)
+      mysql_mutex_destroy(&m_shards[i].mutex);
+  }
+
+  /** @return true and copy the value of key to value if key is present */
+  bool find(const Key &key, Value *value)
+  {
+    Shard &shard= shard_of(key);
+    bool found= false;
+    mysql_mutex_lock(&shard.mutex);
+    const auto it= shard.map.find(key);
+    if (it != shard.map.end())
+    {
+      *value= it->second;
+      found= true;
+    }
+    mysql_mutex_unlock(&shard.mutex);
+    return found;
+  }
+
+  void set(const Key &key, const Value &value)
+  {
+    Shard &shard= shard_of(key);
+    Value replaced= value;
+    mysql_mutex_lock(&shard.mutex);
+    std::swap(shard.map[key], replaced);
+    mysql_mutex_unlock(&shard.mutex);
+    /* the old value goes away here, outside of the shard lock */
+  }
+
+  /** Erase key if pred is true for its value. */
+  template <typename Pred>
+  void erase_if(const Key &key, Pred pred)
+  {
+    Shard &shard= shard_of(key);
+    Value erased= Value();
+    mysql_mutex_lock(&shard.mutex);
+    const auto it= shard.map.find(key);
+    if (it != shard.map.end() && pred(it->second))
+    {
+      erased= std::move(it->second);
+      shard.map.erase(it);
+    }
+    mysql_mutex_unlock(&shard.mutex);
+  }
+
+  void clear()
+  {
+    for (uint i= 0; i < N_SHARDS; i++)
+    {
+      std::unordered_map<Key, Value> erased;
+      mysql_mutex_lock(&m_shards[i].mutex);
+      erased.swap(m_shards[i].map);
+      mysql_mutex_unlock(&m_shards[i].mutex);
+    }
+  }
+
+  bool empty()
+  {
+    for (uint i= 0; i < N_SHARDS; i++)
+    {
+      mysql_mutex_lock(&m_shards[i].mutex);
+      const bool shard_empty= m_shards[i].map.empty();
+      mysql_mutex_unlock(&m_shards[i].mutex);
+      if (!shard_empty)
+        return false;
+    }
+    return true;
+  }
+
+private:
+  struct MY_ALIGNED(CPU_LEVEL1_DCACHE_LINESIZE) Shard
+  {
+    mysql_mutex_t mutex;
+    std::unordered_map<Key, Value> map;
+  };
+
+  Shard &shard_of(const Key &key)
+  {
+    /* The low bits also pick the bucket in the shard, fold in high ones */
+    const size_t hash= std::hash<Key>()(key);
+    return m_shards[((hash >> 16) ^ hash) % N_SHARDS];
+  }
+
+  Shard m_shards[N_SHARDS];
+};
+
+#endif // DEPENDENCY_QUEUE_H
@@ -18,57 +18,57 @@ Dependency_slave_worker::get_begin_event(Commit_order_manager *co_mngr)
 {
   std::shared_ptr<Log_event_wrapper> ret;
 
-  mysql_mutex_lock(&c_rli->dep_lock);
+  // case: commits are ordered, so trxs have to be registered in the commit
+  // order manager in the order they were queued, we dequeue under the lock
+  if (co_mngr == NULL)
+    ret= c_rli->dequeue_dep();
 
-  PSI_stage_info old_stage;
-  info_thd->ENTER_COND(&c_rli->dep_empty_cond, &c_rli->dep_lock,
-                       &stage_slave_waiting_event_from_coordinator,
-                       &old_stage);
-
-  while (!info_thd->killed &&
-         running_status == RUNNING &&
-         c_rli->dep_queue.empty())
+  // case: queue is empty (or we need the lock), take the slow path
+  if (!ret)
   {
-    ++c_rli->begin_event_waits;
-    ++c_rli->num_workers_waiting;
-    const auto timeout_nsec= c_rli->mts_dependency_cond_wait_timeout * 1000000;
-    struct timespec abstime;
-    set_timespec_nsec(abstime, timeout_nsec);
-    mysql_cond_timedwait(&c_rli->dep_empty_cond, &c_rli->dep_lock, &abstime);
-    --c_rli->num_workers_waiting;
-  }
-
-  ret= c_rli->dequeue_dep();
+    mysql_mutex_lock(&c_rli->dep_lock);
 
-  // case: place ourselves in the commit order queue
-  if (ret && co_mngr != NULL)
-  {
-    DBUG_ASSERT(c_rli->mts_dependency_order_commits);
-    // case: if we need to order commits by DB we set current DB
-    if (c_rli->mts_dependency_order_commits == DEP_RPL_ORDER_DB)
-      set_current_db(ret->get_db());
-    co_mngr->register_trx(this);
-  }
+    PSI_stage_info old_stage;
+    info_thd->ENTER_COND(&c_rli->dep_empty_cond, &c_rli->dep_lock,
+                         &stage_slave_waiting_event_from_coordinator,
+                         &old_stage);
 
-  // case: signal if queue is now empty
-  if (c_rli->dep_queue.empty())
-    mysql_cond_signal(&c_rli->dep_empty_cond);
+    while (!info_thd->killed && running_status == RUNNING)
+    {
+      // NOTE: the coordinator enqueues before it checks the number of
+      // waiting workers and we register before we check the queue, so one of
+      // us sees the other
+      ++c_rli->num_workers_waiting;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      ret= c_rli->dequeue_dep();
+      if (ret)
+      {
+        --c_rli->num_workers_waiting;
+        break;
+      }
+      ++c_rli->begin_event_waits;
+      const auto timeout_nsec=
+        c_rli->mts_dependency_cond_wait_timeout * 1000000;
+      struct timespec abstime;
+      set_timespec_nsec(abstime, timeout_nsec);
+      mysql_cond_timedwait(&c_rli->dep_empty_cond, &c_rli->dep_lock,
+                           &abstime);
+      --c_rli->num_workers_waiting;
+    }
 
-  // admission control
-  if (unlikely(c_rli->dep_full))
-  {
-    DBUG_ASSERT(c_rli->dep_queue.size() > 0);
-    // case: signal if dep has space
-    if (c_rli->dep_queue.size() <
-        (c_rli->mts_dependency_size *
-         c_rli->mts_dependency_refill_threshold / 100))
+    // case: place ourselves in the commit order queue
+    if (ret && co_mngr != NULL)
     {
-      c_rli->dep_full= false;
-      mysql_cond_signal(&c_rli->dep_full_cond);
+      DBUG_ASSERT(c_rli->mts_dependency_order_commits);
+      // case: if we need to order commits by DB we set current DB
+      if (c_rli->mts_dependency_order_commits == DEP_RPL_ORDER_DB)
+        set_current_db(ret->get_db());
+      co_mngr->register_trx(this);
     }
+
+    info_thd->EXIT_COND(&old_stage);
   }
 
-  info_thd->EXIT_COND(&old_stage);
   return ret;
 }
 
@@ -140,15 +140,20 @@ bool Dependency_slave_worker::execute_group()
     commit_order_mngr->report_rollback(this);
   }
 
-  mysql_mutex_lock(&c_rli->dep_lock);
+  ulonglong in_flight= c_rli->num_in_flight_trx;
   if (likely(begin_event))
   {
-    DBUG_ASSERT(c_rli->num_in_flight_trx > 0);
-    --c_rli->num_in_flight_trx;
+    DBUG_ASSERT(in_flight > 0);
+    in_flight= --c_rli->num_in_flight_trx;
   }
-  if (c_rli->num_in_flight_trx <= 1)
+  // NOTE: the coordinator checks the counter under the lock before it waits,
+  // so taking the lock after the decrement is enough not to miss it
+  if (in_flight <= 1)
+  {
+    mysql_mutex_lock(&c_rli->dep_lock);
     mysql_cond_broadcast(&c_rli->dep_trx_all_done_cond);
-  mysql_mutex_unlock(&c_rli->dep_lock);
+    mysql_mutex_unlock(&c_rli->dep_lock);
+  }
 
   c_rli->cleanup_group(begin_event);
 
@@ -213,23 +218,7 @@ Dependency_slave_worker::finalize_event(std::shared_ptr<Log_event_wrapper> &ev)
    * 2) The "value" of the key-value pair is _not_ equal to this event. In this
    *    case, leave it be; the event corresponds to a later transaction.
    */
-  mysql_mutex_lock(&c_rli->dep_key_lookup_mutex);
-  if (likely(!c_rli->dep_key_lookup.empty()))
-  {
-    for (const auto& key : ev->keys)
-    {
-      const auto it= c_rli->dep_key_lookup.find(key);
-      DBUG_ASSERT(it != c_rli->dep_key_lookup.end());
-
-      /* Case 1. (Case 2 is implicitly handled by doing nothing.) */
-      if (it->second == ev)
-      {
-        c_rli->dep_key_lookup.erase(it);
-      }
-    }
-  }
-  ev->finalize();
-  mysql_mutex_unlock(&c_rli->dep_key_lookup_mutex);
+  ev->finalize(&c_rli->dep_key_lookup);
 }
 
 Dependency_slave_worker::Dependency_slave_worker(Relay_log_info *rli
@@ -574,9 +574,9 @@ Event_scheduler::execute_top(Event_queue_element_for_exec *event_name)
                                 &th, &connection_attrib, event_worker_thread,
                                 event_name)))
   {
-    mysql_mutex_lock(&LOCK_global_system_variables);
+    lock_global_system_variables();
     Events::opt_event_scheduler= Events::EVENTS_OFF;
-    mysql_mutex_unlock(&LOCK_global_system_variables);
+    unlock_global_system_variables();
 
     sql_print_error("Event_scheduler::execute_top: Can not create event worker"
                     " thread (errno=%d). Stopping event scheduler", res);
@@ -1054,7 +1054,7 @@ Events::dump_internal_status()
     opt_event_scheduler should only be accessed while
     holding LOCK_global_system_variables.
   */
-  mysql_mutex_lock(&LOCK_global_system_variables);
+  lock_global_system_variables();
   if (opt_event_scheduler == EVENTS_DISABLED)
     puts("The Event Scheduler is disabled");
   else
@@ -1063,7 +1063,7 @@ Events::dump_internal_status()
     event_queue->dump_internal_status();
   }
 
-  mysql_mutex_unlock(&LOCK_global_system_variables);
+  unlock_global_system_variables();
   DBUG_VOID_RETURN;
 }
 
@@ -39,6 +39,7 @@
 #include "opt_trace.h"
 #include "sql_optimizer.h"              // JOIN
 #include "sql_base.h"
+#include "sql_multi_tenancy.h"              // multi_tenancy_acquire_workers
 
 #include "blind_fwrite.h"
 
@@ -192,6 +193,36 @@ static my_bool filesort_open_cached_file(IO_CACHE *cache, const char* dir,
   return result;
 }
 
+/**
+  Sort the keys in the sort buffer, on up to filesort_max_threads threads
+  with at least FILESORT_MIN_KEYS_PER_THREAD keys each. The threads beyond
+  the query thread take running slots of the admission control entity of
+  the session for the time of the sort, and there are only as many of
+  them as there are free slots.
+
+  @param param    Sort parameters
+  @param fs_info  Sort buffer
+  @param count    Number of keys in the buffer
+*/
+static void sort_buffer_keys(Sort_param *param, Filesort_info *fs_info,
+                             uint count)
+{
+  THD *thd= current_thd;
+  const ulong wanted= min<ulong>(thd->variables.filesort_max_threads,
+                                 count / FILESORT_MIN_KEYS_PER_THREAD);
+
+  param->sort_threads= 1;
+  if (wanted > 1)
+    param->sort_threads+=
+      (uint) multi_tenancy_acquire_workers(thd, wanted - 1);
+
+  fs_info->sort_buffer(param, count);
+
+  if (param->sort_threads > 1)
+    multi_tenancy_release_workers(thd);
+}
+
+
 /**
   Sort a table.
   Creates a set of pointers that can be used to read the rows
@@ -965,7 +996,7 @@ write_keys(Sort_param *param, Filesort_info *fs_info, uint count,
   rec_length= param->rec_length;
   uchar **sort_keys= fs_info->get_sort_keys();
 
-  fs_info->sort_buffer(param, count);
+  sort_buffer_keys(param, fs_info, count);
 
   /*
     Pass fs_info to open to indicate that filesize is to be checked
@@ -1344,7 +1375,7 @@ static bool save_index(Sort_param *param, uint count, Filesort_info *table_sort)
   uchar *to;
   DBUG_ENTER("save_index");
 
-  table_sort->sort_buffer(param, count);
+  sort_buffer_keys(param, table_sort, count);
   res_length= param->res_length;
   offset= param->rec_length-res_length;
   if (!(to= table_sort->record_pointers= 
@@ -1643,6 +1674,66 @@ void reuse_freed_buff(QUEUE *queue, BUFFPEK *reuse, uint key_length)
 }
 
 
+/**
+  Put all room used by freed buffer to use in adjacent buffer.
+
+  As above, for merges with a Loser_tree. Exhausted buffers are the ones
+  without keys in memory.
+
+  @param[in] first      first buffer of the merge
+  @param[in] last       last buffer of the merge
+  @param[in] reuse      empty buffer
+  @param[in] key_length key length
+*/
+
+void reuse_freed_buff(BUFFPEK *first, BUFFPEK *last, BUFFPEK *reuse,
+                      uint key_length)
+{
+  uchar *reuse_end= reuse->base + reuse->max_keys * key_length;
+  for (BUFFPEK *bp= first; bp <= last; bp++)
+  {
+    if (bp == reuse || !bp->mem_count)
+      continue;
+    if (bp->base + bp->max_keys * key_length == reuse->base)
+    {
+      bp->max_keys+= reuse->max_keys;
+      return;
+    }
+    else if (bp->base == reuse_end)
+    {
+      bp->base= reuse->base;
+      bp->max_keys+= reuse->max_keys;
+      return;
+    }
+  }
+  DBUG_ASSERT(0);
+}
+
+
+namespace {
+
+/** Compare the current keys of two buffers of a merge. */
+class Buffpek_compare
+{
+public:
+  Buffpek_compare(BUFFPEK *first, qsort2_cmp cmp, void *cmp_arg)
+    : m_first(first), m_cmp(cmp), m_cmp_arg(cmp_arg)
+  {}
+
+  int operator()(uint a, uint b) const
+  {
+    return m_cmp(m_cmp_arg, &m_first[a].key, &m_first[b].key);
+  }
+
+private:
+  BUFFPEK *m_first;
+  qsort2_cmp m_cmp;
+  void *m_cmp_arg;
+};
+
+} // namespace
+
+
 /**
   Merge buffers to one buffer.
 
@@ -1674,7 +1765,6 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
   my_off_t to_start_filepos;
   uchar *strpos;
   BUFFPEK *buffpek;
-  QUEUE queue;
   qsort2_cmp cmp;
   void *first_cmp_arg;
   std::atomic<THD::killed_state> *killed= &current_thd->killed;
@@ -1711,9 +1801,8 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
     cmp= get_ptr_compare(sort_length);
     first_cmp_arg= (void*) &sort_length;
   }
-  if (init_queue(&queue, (uint) (Tb-Fb)+1, offsetof(BUFFPEK,key), 0,
-                 (queue_compare) cmp, first_cmp_arg))
-    DBUG_RETURN(1);                                /* purecov: inspected */
+  /* Picks the buffer with the smallest key, see Loser_tree. */
+  Loser_tree<Buffpek_compare> tree(Buffpek_compare(Fb, cmp, first_cmp_arg));
   for (buffpek= Fb ; buffpek <= Tb ; buffpek++)
   {
     buffpek->base= strpos;
@@ -1723,8 +1812,8 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
     if (error == -1)
       goto err;					/* purecov: inspected */
     buffpek->max_keys= buffpek->mem_count;	// If less data in buffers than expected
-    queue_insert(&queue, (uchar*) buffpek);
   }
+  tree.init((uint) (Tb-Fb)+1);
 
   if (param->unique_buff)
   {
@@ -1736,7 +1825,7 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
        This is safe as we know that there is always more than one element
        in each block to merge (This is guaranteed by the Unique:: algorithm
     */
-    buffpek= (BUFFPEK*) queue_top(&queue);
+    buffpek= Fb + tree.top();
     memcpy(param->unique_buff, buffpek->key, rec_length);
     if (my_b_write(to_file, (uchar*) buffpek->key, rec_length))
     {
@@ -1753,12 +1842,12 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
       error= 0;                                       /* purecov: inspected */
       goto end;                                       /* purecov: inspected */
     }
-    queue_replaced(&queue);                        // Top element has been used
+    tree.replace_top();                            // Top element has been used
   }
   else
     cmp= 0;                                        // Not unique
 
-  while (queue.elements > 1)
+  while (tree.active() > 1)
   {
     if (*killed)
     {
@@ -1766,7 +1855,7 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
     }
     for (;;)
     {
-      buffpek= (BUFFPEK*) queue_top(&queue);
+      buffpek= Fb + tree.top();
       if (cmp)                                        // Remove duplicates
       {
         if (!(*cmp)(first_cmp_arg, &(param->unique_buff),
@@ -1809,17 +1898,17 @@ int merge_buffers(Sort_param *param, IO_CACHE *from_file,
         if (!(error= (int) read_to_buffer(from_file,buffpek,
                                           rec_length)))
         {
-          (void) queue_remove(&queue,0);
-          reuse_freed_buff(&queue, buffpek, rec_length);
+          tree.remove_top();
+          reuse_freed_buff(Fb, Tb, buffpek, rec_length);
           break;                        /* One buffer have been removed */
         }
         else if (error == -1)
           goto err;                        /* purecov: inspected */
       }
-      queue_replaced(&queue);              /* Top element has been replaced */
+      tree.replace_top();                  /* Top element has been replaced */
     }
   }
-  buffpek= (BUFFPEK*) queue_top(&queue);
+  buffpek= Fb + tree.top();
   buffpek->base= sort_buffer;
   buffpek->max_keys= param->max_keys_per_buffer;
 
@@ -1883,7 +1972,6 @@ end:
   lastbuff->count= min(org_max_rows-max_rows, param->max_rows);
   lastbuff->file_pos= to_start_filepos;
 err:
-  delete_queue(&queue);
   DBUG_RETURN(error);
 } /* merge_buffers */
 
@@ -17,11 +17,46 @@
 #include "sql_const.h"
 #include "sql_sort.h"
 #include "table.h"
+#include "myisampack.h"                         // mi_uint8korr
 
 #include <algorithm>
 #include <functional>
 #include <vector>
 
+#ifdef HAVE_PSI_INTERFACE
+static PSI_thread_key key_thread_filesort_worker;
+static PSI_mutex_key key_LOCK_filesort_workers;
+static PSI_cond_key key_COND_filesort_work;
+static PSI_cond_key key_COND_filesort_work_done;
+
+static PSI_thread_info all_filesort_threads[]=
+{
+  { &key_thread_filesort_worker, "filesort_worker", 0}
+};
+
+static PSI_mutex_info all_filesort_mutexes[]=
+{
+  { &key_LOCK_filesort_workers, "LOCK_filesort_workers", PSI_FLAG_GLOBAL}
+};
+
+static PSI_cond_info all_filesort_conds[]=
+{
+  { &key_COND_filesort_work, "COND_filesort_work", PSI_FLAG_GLOBAL},
+  { &key_COND_filesort_work_done, "COND_filesort_work_done", PSI_FLAG_GLOBAL}
+};
+
+void init_filesort_psi_keys()
+{
+  mysql_thread_register("sql", all_filesort_threads,
+                        array_elements(all_filesort_threads));
+  mysql_mutex_register("sql", all_filesort_mutexes,
+                       array_elements(all_filesort_mutexes));
+  mysql_cond_register("sql", all_filesort_conds,
+                      array_elements(all_filesort_conds));
+}
+#endif /* HAVE_PSI_INTERFACE */
+
+
 namespace {
 /**
   A local helper function. See comments for get_merge_buffers_cost().
@@ -171,6 +206,40 @@ private:
   size_t m_size;
 };
 
+/**
+  Compare keys by their prefixes first, and only read the keys when the
+  prefixes are equal.
+*/
+class Prefixed_compare
+{
+public:
+  Prefixed_compare(size_t n)
+    : m_rest(n > SORT_PREFIX_LENGTH ? n - SORT_PREFIX_LENGTH : 0)
+  {}
+  bool operator()(const SORT_PREFIXED_PTR &s1,
+                  const SORT_PREFIXED_PTR &s2) const
+  {
+    if (s1.prefix != s2.prefix)
+      return s1.prefix < s2.prefix;
+    return m_rest > 0 &&
+           my_mem_compare(s1.ptr + SORT_PREFIX_LENGTH,
+                          s2.ptr + SORT_PREFIX_LENGTH, m_rest);
+  }
+private:
+  size_t m_rest;
+};
+
+inline ulonglong sort_key_prefix(const uchar *key, size_t sort_length)
+{
+  if (sort_length >= SORT_PREFIX_LENGTH)
+    return mi_uint8korr(key);
+  /* Shorter keys are padded with zeroes, which all keys have alike. */
+  ulonglong prefix= 0;
+  for (size_t i= 0; i < SORT_PREFIX_LENGTH; i++)
+    prefix= (prefix << 8) | (i < sort_length ? key[i] : 0);
+  return prefix;
+}
+
 template <typename type>
 size_t try_reserve(std::pair<type*, ptrdiff_t> *buf, ptrdiff_t size)
 {
@@ -183,21 +252,29 @@ size_t try_reserve(std::pair<type*, ptrdiff_t> *buf, ptrdiff_t size)
   return buf->second;
 }
 
-} // namespace
 
-void Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
+/*
+  Smallest total size of the keys that sort_keys() sorts by prefixes.
+  Smaller keys stay in the CPU caches, where copying the prefixes costs
+  more than the cache misses it saves.
+*/
+const size_t SORT_PREFIXED_MIN_BYTES= 1024 * 1024;
+
+/**
+  Sort keys on the calling thread. Sorts of 100 keys or more are stable.
+*/
+void sort_keys(uchar **keys, uint count, size_t sort_length)
 {
-  if (count <= 1)
-    return;
-  if (param->sort_length == 0)
+  if (count >= 100 &&
+      (size_t) count * sort_length >= SORT_PREFIXED_MIN_BYTES &&
+      !sort_prefixed_keys(keys, count, sort_length))
     return;
 
-  uchar **keys= get_sort_keys();
   std::pair<uchar**, ptrdiff_t> buffer;
-  if (radixsort_is_appliccable(count, param->sort_length) &&
+  if (radixsort_is_appliccable(count, sort_length) &&
       try_reserve(&buffer, count))
   {
-    radixsort_for_str_ptr(keys, count, param->sort_length, buffer.first);
+    radixsort_for_str_ptr(keys, count, sort_length, buffer.first);
     std::return_temporary_buffer(buffer.first);
     return;
   }
@@ -209,9 +286,464 @@ void Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
   */
   if (count < 100)
   {
-    size_t size= param->sort_length;
+    size_t size= sort_length;
     my_qsort2(keys, count, sizeof(uchar*), get_ptr_compare(size), &size);
     return;
   }
-  std::stable_sort(keys, keys + count, Mem_compare(param->sort_length));
+  std::stable_sort(keys, keys + count, Mem_compare(sort_length));
+}
+
+
+/** Work of a parallel sort, one call of run() per partition. */
+class Sort_task
+{
+public:
+  virtual ~Sort_task() {}
+  virtual void run(uint part)= 0;
+};
+
+
+/**
+  Threads that run the partitions of parallel sorts.
+
+  Threads are started when a sort finds fewer idle ones than it has
+  partitions to hand out, up to filesort_worker_threads, and wait for the
+  next sort when they are done. They exit after idle_timeout seconds
+  without work. Every sort also runs the partitions that no thread took
+  on its own thread, so it never waits for a thread to be free, and runs
+  all of them when the pool was not started, as in unit tests.
+*/
+class Filesort_workers
+{
+public:
+  Filesort_workers()
+    : m_inited(false), m_shutdown(false), m_threads(0), m_idle(0)
+  {}
+
+  void init()
+  {
+    mysql_mutex_init(key_LOCK_filesort_workers, &m_lock, MY_MUTEX_INIT_FAST);
+    mysql_cond_init(key_COND_filesort_work, &m_cond_work, NULL);
+    mysql_cond_init(key_COND_filesort_work_done, &m_cond_done, NULL);
+    pthread_attr_init(&m_attr);
+    pthread_attr_setdetachstate(&m_attr, PTHREAD_CREATE_DETACHED);
+    m_shutdown= false;
+    m_inited= true;
+  }
+
+  /** Stop the threads, which are idle as no sort is running any more. */
+  void end()
+  {
+    if (!m_inited)
+      return;
+    mysql_mutex_lock(&m_lock);
+    DBUG_ASSERT(m_batches.empty());
+    m_shutdown= true;
+    mysql_cond_broadcast(&m_cond_work);
+    while (m_threads)
+      mysql_cond_wait(&m_cond_done, &m_lock);
+    mysql_mutex_unlock(&m_lock);
+
+    m_inited= false;
+    pthread_attr_destroy(&m_attr);
+    mysql_cond_destroy(&m_cond_done);
+    mysql_cond_destroy(&m_cond_work);
+    mysql_mutex_destroy(&m_lock);
+  }
+
+  /** Call task->run() for partitions 0 to parts-1, and wait for them. */
+  void run(Sort_task *task, uint parts)
+  {
+    if (!m_inited)
+    {
+      for (uint part= 0; part < parts; part++)
+        task->run(part);
+      return;
+    }
+
+    Batch batch(task, parts);
+    mysql_mutex_lock(&m_lock);
+    for (uint idle= m_idle; idle < parts - 1; idle++)
+    {
+      if (!start_thread())
+        break;
+    }
+    m_batches.push_back(&batch);
+    mysql_cond_broadcast(&m_cond_work);
+
+    while (batch.next < batch.parts)
+    {
+      const uint part= claim(&batch);
+      mysql_mutex_unlock(&m_lock);
+      task->run(part);
+      mysql_mutex_lock(&m_lock);
+      batch.running--;
+    }
+    while (batch.running)
+      mysql_cond_wait(&m_cond_done, &m_lock);
+    mysql_mutex_unlock(&m_lock);
+  }
+
+private:
+  struct Batch
+  {
+    Batch(Sort_task *task_arg, uint parts_arg)
+      : task(task_arg), parts(parts_arg), next(0), running(0)
+    {}
+
+    Sort_task *task;
+    const uint parts;
+    /* Next partition to hand out */
+    uint next;
+    /* Partitions handed out and not done */
+    uint running;
+  };
+
+  /** Hand out the next partition of a batch. */
+  uint claim(Batch *batch)
+  {
+    mysql_mutex_assert_owner(&m_lock);
+    const uint part= batch->next++;
+    batch->running++;
+    if (batch->next == batch->parts)
+      m_batches.erase(std::find(m_batches.begin(), m_batches.end(), batch));
+    return part;
+  }
+
+  bool start_thread()
+  {
+    mysql_mutex_assert_owner(&m_lock);
+    if (m_threads >= filesort_worker_threads)
+      return false;
+    pthread_t thread;
+    if (mysql_thread_create(key_thread_filesort_worker, &thread, &m_attr,
+                            worker_main, this))
+      return false;
+    m_threads++;
+    m_idle++;
+    return true;
+  }
+
+  static void *worker_main(void *arg)
+  {
+    my_thread_init();
+    static_cast<Filesort_workers*>(arg)->work();
+    my_thread_end();
+    return NULL;
+  }
+
+  void work()
+  {
+    mysql_mutex_lock(&m_lock);
+    for (;;)
+    {
+      struct timespec abstime;
+      set_timespec(abstime, idle_timeout);
+      int error= 0;
+      while (!m_shutdown && m_batches.empty() && !error)
+        error= mysql_cond_timedwait(&m_cond_work, &m_lock, &abstime);
+      /* Also retire the threads beyond a lowered filesort_worker_threads */
+      if (m_shutdown || m_batches.empty() ||
+          m_threads > filesort_worker_threads)
+        break;
+
+      Batch *batch= m_batches.front();
+      const uint part= claim(batch);
+      m_idle--;
+      mysql_mutex_unlock(&m_lock);
+      batch->task->run(part);
+      mysql_mutex_lock(&m_lock);
+      m_idle++;
+      if (!--batch->running && batch->next == batch->parts)
+        mysql_cond_broadcast(&m_cond_done);
+    }
+    m_threads--;
+    m_idle--;
+    mysql_cond_broadcast(&m_cond_done);
+    mysql_mutex_unlock(&m_lock);
+  }
+
+  /* Seconds a thread waits for work before it exits */
+  static const uint idle_timeout= 60;
+
+  bool m_inited;
+  bool m_shutdown;
+  /* Started threads, and the ones of them waiting for work */
+  uint m_threads;
+  uint m_idle;
+  /* Sorts with partitions left to hand out, oldest first */
+  std::vector<Batch*> m_batches;
+  pthread_attr_t m_attr;
+  mysql_mutex_t m_lock;
+  /* Signalled when partitions are queued, or at shutdown */
+  mysql_cond_t m_cond_work;
+  /* Signalled when the last partition of a batch is done, or a thread ends */
+  mysql_cond_t m_cond_done;
+};
+
+Filesort_workers filesort_workers;
+
+
+/**
+  Sort of the keys of a filesort buffer by several threads.
+
+  The keys are split in one partition per thread, and every thread sorts
+  its partition as sort_keys() does. Then the output is split in as many
+  segments, by splitter keys picked from a sample of all partitions so
+  that skewed input still gives every thread a similar share. Every
+  thread merges the part of each partition that goes to its segment with
+  a Loser_tree into a scratch array, which is copied back at the end.
+
+  Keys are ordered by their bytes, then by their position in the sorted
+  partitions. The partition sorts are stable, so this is the input order
+  for equal keys, and the result is the one of a single stable sort.
+*/
+class Parallel_sort
+{
+public:
+  Parallel_sort(uchar **keys, uint count, size_t sort_length, uint parts)
+    : m_keys(keys), m_sorted(NULL), m_count(count),
+      m_sort_length(sort_length), m_parts(parts),
+      m_bounds(parts * (parts + 1)), m_offsets(parts + 1)
+  {}
+
+  /** @return true if out of memory, and nothing was sorted */
+  bool run()
+  {
+    if (!(m_sorted= (uchar**) my_malloc(m_count * sizeof(uchar*), MYF(0))))
+      return true;
+
+    run_threads(&Parallel_sort::sort_partition);
+    split_output();
+    run_threads(&Parallel_sort::merge_segment);
+    memcpy(m_keys, m_sorted, m_count * sizeof(uchar*));
+
+    my_free(m_sorted);
+    return false;
+  }
+
+private:
+  typedef void (Parallel_sort::*Task)(uint part);
+
+  class Member_task : public Sort_task
+  {
+  public:
+    Member_task(Parallel_sort *sort, Task task)
+      : m_sort(sort), m_task(task)
+    {}
+
+    virtual void run(uint part) { (m_sort->*m_task)(part); }
+
+  private:
+    Parallel_sort *m_sort;
+    Task m_task;
+  };
+
+  /** Compare the heads of the runs merged into a segment. */
+  class Run_compare
+  {
+  public:
+    Run_compare(uchar **keys, const uint *pos, size_t sort_length)
+      : m_keys(keys), m_pos(pos), m_sort_length(sort_length)
+    {}
+
+    int operator()(uint a, uint b) const
+    {
+      return memcmp(m_keys[m_pos[a]], m_keys[m_pos[b]], m_sort_length);
+    }
+
+  private:
+    uchar **m_keys;
+    const uint *m_pos;
+    size_t m_sort_length;
+  };
+
+  /** Run task for every partition on the filesort worker threads. */
+  void run_threads(Task task)
+  {
+    Member_task member_task(this, task);
+    filesort_workers.run(&member_task, m_parts);
+  }
+
+  uint partition_start(uint part) const
+  {
+    return (uint) ((ulonglong) m_count * part / m_parts);
+  }
+
+  /** Start of segment in partition part. */
+  uint &bound(uint part, uint segment)
+  {
+    return m_bounds[part * (m_parts + 1) + segment];
+  }
+
+  /** @return true if the key at position a goes before the one at b */
+  bool less(uint a, uint b) const
+  {
+    const int res= memcmp(m_keys[a], m_keys[b], m_sort_length);
+    return res < 0 || (res == 0 && a < b);
+  }
+
+  void sort_partition(uint part)
+  {
+    const uint start= partition_start(part);
+    sort_keys(m_keys + start, partition_start(part + 1) - start,
+              m_sort_length);
+  }
+
+  /** Pick the splitters, and find the segments in every partition. */
+  void split_output()
+  {
+    const uint samples_per_part= 8 * m_parts;
+    std::vector<uint> samples;
+    samples.reserve(m_parts * samples_per_part);
+    for (uint part= 0; part < m_parts; part++)
+    {
+      const uint start= partition_start(part);
+      const uint length= partition_start(part + 1) - start;
+      for (uint i= 0; i < samples_per_part; i++)
+        samples.push_back(start +
+                          (uint) ((ulonglong) length * i / samples_per_part));
+    }
+    std::sort(samples.begin(), samples.end(),
+              [this](uint a, uint b) { return less(a, b); });
+
+    for (uint part= 0; part < m_parts; part++)
+    {
+      bound(part, 0)= partition_start(part);
+      bound(part, m_parts)= partition_start(part + 1);
+      for (uint segment= 1; segment < m_parts; segment++)
+      {
+        const uint splitter= samples[samples.size() * segment / m_parts];
+        /* Binary search for the first key not before the splitter. */
+        uint lo= bound(part, segment - 1), hi= bound(part, m_parts);
+        while (lo < hi)
+        {
+          const uint mid= lo + (hi - lo) / 2;
+          if (less(mid, splitter))
+            lo= mid + 1;
+          else
+            hi= mid;
+        }
+        bound(part, segment)= lo;
+      }
+    }
+
+    m_offsets[0]= 0;
+    for (uint segment= 0; segment < m_parts; segment++)
+    {
+      uint length= 0;
+      for (uint part= 0; part < m_parts; part++)
+        length+= bound(part, segment + 1) - bound(part, segment);
+      m_offsets[segment + 1]= m_offsets[segment] + length;
+    }
+    DBUG_ASSERT(m_offsets[m_parts] == m_count);
+  }
+
+  void merge_segment(uint segment)
+  {
+    std::vector<uint> pos, end;
+    for (uint part= 0; part < m_parts; part++)
+    {
+      if (bound(part, segment) < bound(part, segment + 1))
+      {
+        pos.push_back(bound(part, segment));
+        end.push_back(bound(part, segment + 1));
+      }
+    }
+    if (pos.empty())
+      return;
+
+    uchar **to= m_sorted + m_offsets[segment];
+    Loser_tree<Run_compare> tree(Run_compare(m_keys, &pos[0],
+                                             m_sort_length));
+    tree.init((uint) pos.size());
+    while (tree.active() > 1)
+    {
+      const uint run= tree.top();
+      *to++= m_keys[pos[run]++];
+      if (pos[run] == end[run])
+        tree.remove_top();
+      else
+        tree.replace_top();
+    }
+    const uint run= tree.top();
+    memcpy(to, m_keys + pos[run], (end[run] - pos[run]) * sizeof(uchar*));
+  }
+
+  uchar **m_keys;
+  uchar **m_sorted;
+  const uint m_count;
+  const size_t m_sort_length;
+  const uint m_parts;
+  /* Bounds of the segments in every partition, see bound(). */
+  std::vector<uint> m_bounds;
+  /* Start of every segment in the output. */
+  std::vector<uint> m_offsets;
+};
+
+} // namespace
+
+
+void filesort_workers_init()
+{
+  filesort_workers.init();
+}
+
+
+void filesort_workers_end()
+{
+  filesort_workers.end();
+}
+
+
+bool sort_prefixed_keys(uchar **keys, uint count, size_t sort_length)
+{
+  SORT_PREFIXED_PTR *entries=
+    (SORT_PREFIXED_PTR*) my_malloc(count * sizeof(SORT_PREFIXED_PTR), MYF(0));
+  if (!entries)
+    return true;
+
+  /* The records are laid out in the order of the pointers at this point. */
+  for (uint i= 0; i < count; i++)
+  {
+    entries[i].prefix= sort_key_prefix(keys[i], sort_length);
+    entries[i].ptr= keys[i];
+  }
+
+  std::pair<SORT_PREFIXED_PTR*, ptrdiff_t> buffer;
+  if (radixsort_is_appliccable(count, sort_length) &&
+      try_reserve(&buffer, count))
+  {
+    radixsort_for_prefixed_str_ptr(entries, count, sort_length,
+                                   buffer.first);
+    std::return_temporary_buffer(buffer.first);
+  }
+  else
+    std::stable_sort(entries, entries + count,
+                     Prefixed_compare(sort_length));
+
+  for (uint i= 0; i < count; i++)
+    keys[i]= entries[i].ptr;
+  my_free(entries);
+  return false;
+}
+
+
+void Filesort_buffer::sort_buffer(const Sort_param *param, uint count)
+{
+  if (count <= 1)
+    return;
+  if (param->sort_length == 0)
+    return;
+
+  uchar **keys= get_sort_keys();
+  const uint threads= std::min(param->sort_threads,
+                               count / FILESORT_MIN_KEYS_PER_THREAD);
+  if (threads > 1)
+  {
+    Parallel_sort sort(keys, count, param->sort_length, threads);
+    if (!sort.run())
+      return;
+  }
+  sort_keys(keys, count, param->sort_length);
 }
@@ -20,7 +20,9 @@
 #include "my_base.h"
 #include "sql_array.h"
 
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 class Sort_param;
 /*
@@ -47,6 +49,134 @@ double get_merge_many_buffs_cost_fast(ha_rows num_rows,
                                       uint    elem_size);
 
 
+/**
+  Sort count pointers to keys of sort_length bytes in memcmp() order, and
+  keep equal keys in the order they come in.
+
+  The pointers are copied to an array of SORT_PREFIXED_PTR, that also
+  holds the first SORT_PREFIX_LENGTH bytes of every key. Most comparisons
+  are decided by the prefixes, and need not read the keys, which are
+  scattered over a sort buffer that is usually much larger than the CPU
+  caches.
+
+  @return true if out of memory, and the keys are not sorted
+*/
+bool sort_prefixed_keys(uchar **keys, uint count, size_t sort_length);
+
+
+#ifdef HAVE_PSI_INTERFACE
+/** Register the instruments of the threads of parallel sorts. */
+void init_filesort_psi_keys();
+#endif
+
+/** Start and stop the pool of threads that run parallel sorts. */
+void filesort_workers_init();
+void filesort_workers_end();
+
+
+/**
+  Fewest keys a thread of a parallel sort gets, see Sort_param::sort_threads.
+  Below that, handing the partitions to threads and merging them costs
+  more than sorting them on one thread.
+*/
+static const uint FILESORT_MIN_KEYS_PER_THREAD= 16384;
+
+
+/**
+  Tournament tree of losers, for k-way merges.
+
+  Merges sources numbered 0 to k-1. Compare is called with two source
+  numbers and returns <0, 0 or >0 as memcmp() does for the current heads
+  of the two sources. Equal heads are taken from the lower numbered source
+  first, so merging sorted runs of consecutive input is stable.
+
+  Every internal node keeps the loser of the match played there, and the
+  winner of the tournament is at the root. Replacing the head of the
+  winner replays only the matches on the path from its leaf to the root:
+  log2(k) comparisons, against about twice as many for a binary heap.
+*/
+template <typename Compare>
+class Loser_tree
+{
+public:
+  explicit Loser_tree(const Compare &compare)
+    : m_compare(compare), m_sources(0), m_active(0)
+  {}
+
+  /** Start a merge of sources 0 to sources-1, all of them non-empty. */
+  void init(uint sources)
+  {
+    m_sources= sources;
+    m_active= sources;
+    m_exhausted.assign(sources, false);
+    m_nodes.assign(std::max(sources, 1U), 0);
+    if (sources <= 1)
+      return;
+
+    /* Leaves are nodes sources to 2*sources-1 of a heap shaped tree. */
+    std::vector<uint> winners(2 * sources);
+    for (uint i= 0; i < sources; i++)
+      winners[sources + i]= i;
+    for (uint node= sources - 1; node > 0; node--)
+    {
+      const uint left= winners[2 * node];
+      const uint right= winners[2 * node + 1];
+      const bool left_wins= beats(left, right);
+      winners[node]= left_wins ? left : right;
+      m_nodes[node]= left_wins ? right : left;
+    }
+    m_nodes[0]= winners[1];
+  }
+
+  /** The source with the smallest head. */
+  uint top() const { return m_nodes[0]; }
+
+  /** Number of sources that are not exhausted. */
+  uint active() const { return m_active; }
+
+  /** The head of top() was consumed, and the source has a new one. */
+  void replace_top() { replay(); }
+
+  /** The head of top() was consumed, and the source is exhausted. */
+  void remove_top()
+  {
+    DBUG_ASSERT(m_active > 0);
+    m_exhausted[top()]= true;
+    m_active--;
+    replay();
+  }
+
+private:
+  bool beats(uint a, uint b) const
+  {
+    if (m_exhausted[a])
+      return false;
+    if (m_exhausted[b])
+      return true;
+    const int res= m_compare(a, b);
+    return res < 0 || (res == 0 && a < b);
+  }
+
+  void replay()
+  {
+    uint winner= m_nodes[0];
+    for (uint node= (m_sources + winner) / 2; node > 0; node/= 2)
+    {
+      if (beats(m_nodes[node], winner))
+        std::swap(m_nodes[node], winner);
+    }
+    m_nodes[0]= winner;
+  }
+
+  Compare m_compare;
+  uint m_sources;
+  uint m_active;
+  /* m_nodes[0] is the winner, the others the losers of internal nodes. */
+  std::vector<uint> m_nodes;
+  std::vector<bool> m_exhausted;
+};
+
+
 /**
   A wrapper class around the buffer used by filesort().
   The buffer is a contiguous chunk of memory,
@@ -66,7 +196,10 @@ public:
     m_idx_array(), m_record_length(0), m_start_of_data(NULL)
   {}
 
-  /** Sort me... */
+  /**
+    Sort me... With param->sort_threads > 1 the keys are split in as many
+    partitions, sorted and then merged by that many threads.
+  */
   void sort_buffer(const Sort_param *param, uint count);
 
   /// Initializes a record pointer.
@@ -46,6 +46,7 @@
 #include "sql_db.h"      // init_thd_db_read_only
                          // is_thd_db_read_only_by_name
 #include "sql_connect.h"
+#include "my_murmur3.h"
 
 #ifdef WITH_PARTITION_STORAGE_ENGINE
 #include "ha_partition.h"
@@ -3188,6 +3189,23 @@ int handler::ha_rnd_pos(uchar *buf, uchar *pos)
   This is particularly used in conjunction with multi read ranges.
 */
 
+/**
+  Count a key looked up by the current statement in its distinct keys
+  sketch, see sql_distinct_stats_control.
+*/
+static void record_distinct_key(TABLE *table, uint index, const uchar *key,
+                                key_part_map keypart_map)
+{
+  if (sql_distinct_stats_control != SQL_INFO_CONTROL_ON ||
+      !table->in_use || table->s->tmp_table != NO_TMP_TABLE)
+    return;
+
+  uint key_len= calculate_key_len(table, index, key, keypart_map);
+  record_sql_distinct_key(table->in_use,
+                          murmur3_32(key, key_len,
+                                     table->s->distinct_key_seed + index));
+}
+
 int handler::ha_index_read_map(uchar *buf, const uchar *key,
                                key_part_map keypart_map,
                                enum ha_rkey_function find_flag)
@@ -3204,6 +3222,8 @@ int handler::ha_index_read_map(uchar *buf, const uchar *key,
     DBUG_RETURN(HA_ERR_LOCK_DEADLOCK);
   }
 
+  record_distinct_key(table, active_index, key, keypart_map);
+
   MYSQL_TABLE_IO_WAIT(m_psi, PSI_TABLE_FETCH_ROW, active_index, 0,
     { result= index_read_map(buf, key, keypart_map, find_flag); })
   DBUG_RETURN(result);
@@ -3250,6 +3270,8 @@ int handler::ha_index_read_idx_map(uchar *buf, uint index, const uchar *key,
     return HA_ERR_LOCK_DEADLOCK;
   }
 
+  record_distinct_key(table, index, key, keypart_map);
+
   MYSQL_TABLE_IO_WAIT(m_psi, PSI_TABLE_FETCH_ROW, index, 0,
     { result= index_read_idx_map(buf, index, key, keypart_map, find_flag); })
   return result;
@@ -5707,12 +5729,12 @@ int ha_init_key_cache(const char *name, KEY_CACHE *key_cache)
 
   if (!key_cache->key_cache_inited)
   {
-    mysql_mutex_lock(&LOCK_global_system_variables);
+    lock_global_system_variables();
     size_t tmp_buff_size= (size_t) key_cache->param_buff_size;
     uint tmp_block_size= (uint) key_cache->param_block_size;
     uint division_limit= key_cache->param_division_limit;
     uint age_threshold=  key_cache->param_age_threshold;
-    mysql_mutex_unlock(&LOCK_global_system_variables);
+    unlock_global_system_variables();
     DBUG_RETURN(!init_key_cache(key_cache,
 				tmp_block_size,
 				tmp_buff_size,
@@ -5731,12 +5753,12 @@ int ha_resize_key_cache(KEY_CACHE *key_cache)
 
   if (key_cache->key_cache_inited)
   {
-    mysql_mutex_lock(&LOCK_global_system_variables);
+    lock_global_system_variables();
     size_t tmp_buff_size= (size_t) key_cache->param_buff_size;
     long tmp_block_size= (long) key_cache->param_block_size;
     uint division_limit= key_cache->param_division_limit;
     uint age_threshold=  key_cache->param_age_threshold;
-    mysql_mutex_unlock(&LOCK_global_system_variables);
+    unlock_global_system_variables();
     DBUG_RETURN(!resize_key_cache(key_cache, tmp_block_size,
 				  tmp_buff_size,
 				  division_limit, age_threshold));
@@ -5752,10 +5774,10 @@ int ha_change_key_cache_param(KEY_CACHE *key_cache)
 {
   if (key_cache->key_cache_inited)
   {
-    mysql_mutex_lock(&LOCK_global_system_variables);
+    lock_global_system_variables();
     uint division_limit= key_cache->param_division_limit;
     uint age_threshold=  key_cache->param_age_threshold;
-    mysql_mutex_unlock(&LOCK_global_system_variables);
+    unlock_global_system_variables();
     change_key_cache_param(key_cache, division_limit, age_threshold);
   }
   return 0;
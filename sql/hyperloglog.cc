@@ -43,54 +43,65 @@ double get_harmonic_mean_constant(uint data_size) {
 }
 
 void hyperloglog_init(struct hyperloglog* hll) {
-  hll->data_size_log2 = default_data_size_log2;
+  hyperloglog_init_size(hll, default_data_size_log2);
+}
+
+my_bool hyperloglog_init_size(struct hyperloglog* hll, uchar data_size_log2) {
+  hll->data_size_log2 = data_size_log2;
   hll->data_size = 1 << hll->data_size_log2;
   hll->max_bit_position = 32 - hll->data_size_log2 + 1;
   hll->data = (uint*)my_malloc(
     hll->data_size * hll->max_bit_position * sizeof(uint),
-    MYF(MY_WME));
-  memset(hll->data, 0, hll->data_size * hll->max_bit_position * sizeof(uint));
+    MYF(MY_WME | MY_ZEROFILL));
+  return hll->data == NULL;
 }
 
 void hyperloglog_reset(struct hyperloglog* hll) {
   memset(hll->data, 0, hll->data_size * hll->max_bit_position * sizeof(uint));
 }
 
-ulonglong hyperloglog_query(struct hyperloglog* hll, uint since_time) {
-  double harmonic_mean_constant = get_harmonic_mean_constant(hll->data_size);
+void hyperloglog_get_registers(
+  struct hyperloglog* hll,
+  uint since_time,
+  uchar* registers) {
+  uint i, j;
+
+  // We need the maximum phi-value seen since since_time for every bucket.
+  // Going through the phi-values in increasing order, the last one seen
+  // since since_time wins. The inner loop is branch free over contiguous
+  // memory so that it compiles to SIMD compares and blends.
+  memset(registers, 0, hll->data_size);
+  for (j = 0; j < hll->max_bit_position; j++) {
+    const uint* row = hll->data + j * hll->data_size;
+    const uchar phi = (uchar)(j + 1);
+    for (i = 0; i < hll->data_size; i++) {
+      registers[i] = row[i] > since_time ? phi : registers[i];
+    }
+  }
+}
+
+ulonglong hyperloglog_registers_count(const uchar* registers, uint data_size) {
+  double harmonic_mean_constant = get_harmonic_mean_constant(data_size);
   double query_sum = 0.0;
   uint count_zero_elements = 0;
-  uint i,j;
+  uint i;
   double cardinality_estimate = 0.0;
 
-  for (i = 0; i < hll->data_size; i++) {
-    uchar max_valid_index = 32;
-    // We need the maximum index seen since since_time.
-    // As data[i][j] stores the last time when an index of j was seen,
-    // We just need to find the largest j, for which data[i][j] is
-    // larger than since_time.
-    for (j = hll->max_bit_position; j >= 1; j--) {
-      if (hll->data[i * hll->max_bit_position + j - 1] > since_time) {
-    max_valid_index = j;
-    break;
-      }
-    }
-    if (max_valid_index == 32) {
+  for (i = 0; i < data_size; i++) {
+    if (registers[i] == 0) {
       count_zero_elements++;
-      query_sum += 1.0;
-    } else {
-      query_sum += 1.0 / ((uint) 1 << max_valid_index);
     }
+    query_sum += 1.0 / ((uint) 1 << registers[i]);
   }
 
   cardinality_estimate =
-    harmonic_mean_constant * hll->data_size * hll->data_size / query_sum;
+    harmonic_mean_constant * data_size * data_size / query_sum;
 
-  if (cardinality_estimate <= 2.5 * hll->data_size) {
+  if (cardinality_estimate <= 2.5 * data_size) {
     // small range correction
     if (count_zero_elements != 0)
-      cardinality_estimate = log((double)hll->data_size / count_zero_elements)
-        * hll->data_size;
+      cardinality_estimate = log((double)data_size / count_zero_elements)
+        * data_size;
   } else if (cardinality_estimate > long_range_adjustment_constant32 / 30.0) {
     // Adjust for hash collisions that occur when nearing 2^32 uniques
     cardinality_estimate = -long_range_adjustment_constant32 *
@@ -99,14 +110,47 @@ ulonglong hyperloglog_query(struct hyperloglog* hll, uint since_time) {
   return (ulonglong)(cardinality_estimate + 0.5);
 }
 
+ulonglong hyperloglog_query(struct hyperloglog* hll, uint since_time) {
+  uchar* registers = (uchar*) my_alloca(hll->data_size);
+  ulonglong count;
+
+  hyperloglog_get_registers(hll, since_time, registers);
+  count = hyperloglog_registers_count(registers, hll->data_size);
+  my_afree(registers);
+  return count;
+}
+
 void hyperloglog_insert(
   struct hyperloglog* hll,
   uint hash,
   uint current_time) {
-    uint index = hash & (hll->data_size-1);
+  uint index = hash & (hll->data_size-1);
   uint first_set_bit =
     find_first_set_bit_after_index(hash, hll->data_size_log2);
-  hll->data[index * hll->max_bit_position + first_set_bit] = current_time;
+  hll->data[first_set_bit * hll->data_size + index] = current_time;
+}
+
+void hyperloglog_registers_insert(
+  uchar* registers,
+  uchar data_size_log2,
+  uint hash) {
+  uint index = hash & ((1U << data_size_log2) - 1);
+  uchar phi = find_first_set_bit_after_index(hash, data_size_log2) + 1;
+  if (registers[index] < phi)
+    registers[index] = phi;
+}
+
+void hyperloglog_insert_registers(
+  struct hyperloglog* hll,
+  const uchar* registers,
+  uint current_time) {
+  uint i;
+  // Only the largest phi-value of a bucket matters for any query window
+  // that includes current_time.
+  for (i = 0; i < hll->data_size; i++) {
+    if (registers[i])
+      hll->data[(registers[i] - 1) * hll->data_size + i] = current_time;
+  }
 }
 
 void hyperloglog_destroy(struct hyperloglog* hll) {
@@ -21,12 +21,18 @@ C_MODE_START
  *
  * Look at Figure 3 for overview of algorithm implementation
  * Link as of 6/18/2012: algo.inria.fr/flajolet/Publications/FlFuGaMe07.pdf
+ *
+ * A query first reduces the timestamps to plain hyperloglog registers
+ * (the largest phi-value seen since the given time, per bucket), which
+ * can also be built directly with hyperloglog_registers_insert() and
+ * merged in with hyperloglog_insert_registers().
  */
 
 struct hyperloglog {
   /*
-   * data[i * max_bit_position + j] stores the timestamp when a phi-value of
-   * j was obtained for bucket number i.
+   * data[j * data_size + i] stores the timestamp when a phi-value of
+   * j + 1 was obtained for bucket number i. Keeping the buckets of a
+   * phi-value contiguous lets the compiler vectorize the register loops.
    */
   uint* data;
 
@@ -47,6 +53,9 @@ struct hyperloglog {
 // Initialize the hyperloglog data structure with desired data_size_log2 value
 void hyperloglog_init(struct hyperloglog* hll);
 
+// Initialize with 2 ^ data_size_log2 buckets, returns TRUE if out of memory
+my_bool hyperloglog_init_size(struct hyperloglog* hll, uchar data_size_log2);
+
 // Clears the data array, so that all counts are reset
 void hyperloglog_reset(struct hyperloglog* hll);
 
@@ -59,6 +68,27 @@ void hyperloglog_insert(
 // Get count of distinct elements inserted since since_time
 ulonglong hyperloglog_query(struct hyperloglog* hll, uint since_time);
 
+// Insert the value hash into plain registers of 2 ^ data_size_log2 buckets
+void hyperloglog_registers_insert(
+  uchar* registers,
+  uchar data_size_log2,
+  uint hash);
+
+// Insert all values counted in registers, at time current_time
+void hyperloglog_insert_registers(
+  struct hyperloglog* hll,
+  const uchar* registers,
+  uint current_time);
+
+// Store the registers of the values inserted since since_time
+void hyperloglog_get_registers(
+  struct hyperloglog* hll,
+  uint since_time,
+  uchar* registers);
+
+// Get count of distinct elements from registers of data_size buckets
+ulonglong hyperloglog_registers_count(const uchar* registers, uint data_size);
+
 // Destroy structure and free memory
 void hyperloglog_destroy(struct hyperloglog* hll);
 
@@ -5770,27 +5770,29 @@ void Item_func_get_system_var::fix_length_and_dec()
       break;
     case SHOW_CHAR:
     case SHOW_CHAR_PTR:
-      mysql_mutex_lock(&LOCK_global_system_variables);
-      cptr= var->show_type() == SHOW_CHAR ? 
-        (char*) var->value_ptr(current_thd, var_type, &component) :
-        *(char**) var->value_ptr(current_thd, var_type, &component);
-      if (cptr)
-        max_length= system_charset_info->cset->numchars(system_charset_info,
-                                                        cptr,
-                                                        cptr + strlen(cptr));
-      mysql_mutex_unlock(&LOCK_global_system_variables);
-      collation.set(system_charset_info, DERIVATION_SYSCONST);
-      max_length*= system_charset_info->mbmaxlen;
-      decimals=NOT_FIXED_DEC;
+      {
+        const uint shard= rdlock_global_system_variables();
+        cptr= var->show_type() == SHOW_CHAR ?
+          (char*) var->value_ptr(current_thd, var_type, &component) :
+          *(char**) var->value_ptr(current_thd, var_type, &component);
+        if (cptr)
+          max_length= system_charset_info->cset->numchars(system_charset_info,
+                                                          cptr,
+                                                          cptr + strlen(cptr));
+        rdunlock_global_system_variables(shard);
+        collation.set(system_charset_info, DERIVATION_SYSCONST);
+        max_length*= system_charset_info->mbmaxlen;
+        decimals=NOT_FIXED_DEC;
+      }
       break;
     case SHOW_LEX_STRING:
       {
-        mysql_mutex_lock(&LOCK_global_system_variables);
+        const uint shard= rdlock_global_system_variables();
         LEX_STRING *ls= ((LEX_STRING*)var->value_ptr(current_thd, var_type, &component));
         max_length= system_charset_info->cset->numchars(system_charset_info,
                                                         ls->str,
                                                         ls->str + ls->length);
-        mysql_mutex_unlock(&LOCK_global_system_variables);
+        rdunlock_global_system_variables(shard);
         collation.set(system_charset_info, DERIVATION_SYSCONST);
         max_length*= system_charset_info->mbmaxlen;
         decimals=NOT_FIXED_DEC;
@@ -5886,9 +5888,9 @@ enum_field_types Item_func_get_system_var::field_type() const
 #define get_sys_var_safe(type) \
 do { \
   type value; \
-  mysql_mutex_lock(&LOCK_global_system_variables); \
+  const uint shard= rdlock_global_system_variables(); \
   value= *(type*) var->value_ptr(thd, var_type, &component); \
-  mysql_mutex_unlock(&LOCK_global_system_variables); \
+  rdunlock_global_system_variables(shard); \
   cache_present |= GET_SYS_VAR_CACHE_LONG; \
   used_query_id= thd->query_id; \
   cached_llval= null_value ? 0 : (longlong) value; \
@@ -6015,7 +6017,7 @@ String* Item_func_get_system_var::val_str(String* str)
     case SHOW_CHAR_PTR:
     case SHOW_LEX_STRING:
     {
-      mysql_mutex_lock(&LOCK_global_system_variables);
+      const uint shard= rdlock_global_system_variables();
       char *cptr= var->show_type() == SHOW_CHAR ? 
         (char*) var->value_ptr(thd, var_type, &component) :
         *(char**) var->value_ptr(thd, var_type, &component);
@@ -6035,7 +6037,7 @@ String* Item_func_get_system_var::val_str(String* str)
         null_value= TRUE;
         str= NULL;
       }
-      mysql_mutex_unlock(&LOCK_global_system_variables);
+      rdunlock_global_system_variables(shard);
       break;
     }
 
@@ -6110,9 +6112,11 @@ double Item_func_get_system_var::val_real()
       cached_null_value= null_value;
       return cached_dval;
     case SHOW_DOUBLE:
-      mysql_mutex_lock(&LOCK_global_system_variables);
-      cached_dval= *(double*) var->value_ptr(thd, var_type, &component);
-      mysql_mutex_unlock(&LOCK_global_system_variables);
+      {
+        const uint shard= rdlock_global_system_variables();
+        cached_dval= *(double*) var->value_ptr(thd, var_type, &component);
+        rdunlock_global_system_variables(shard);
+      }
       used_query_id= thd->query_id;
       cached_null_value= null_value;
       if (null_value)
@@ -6123,7 +6127,7 @@ double Item_func_get_system_var::val_real()
     case SHOW_LEX_STRING:
     case SHOW_CHAR_PTR:
       {
-        mysql_mutex_lock(&LOCK_global_system_variables);
+        const uint shard= rdlock_global_system_variables();
         char *cptr= var->show_type() == SHOW_CHAR ? 
           (char*) var->value_ptr(thd, var_type, &component) :
           *(char**) var->value_ptr(thd, var_type, &component);
@@ -6136,7 +6140,7 @@ double Item_func_get_system_var::val_real()
           null_value= TRUE;
           cached_dval= 0;
         }
-        mysql_mutex_unlock(&LOCK_global_system_variables);
+        rdunlock_global_system_variables(shard);
         used_query_id= thd->query_id;
         cached_null_value= null_value;
         cache_present|= GET_SYS_VAR_CACHE_DOUBLE;
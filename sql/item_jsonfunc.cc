@@ -65,7 +65,7 @@ static void process_fb_json_audit_flag(uint flag, const char *msg) {
  */
 static void check_binary_collation(String *pstr) {
   if (pstr->charset() == &my_charset_bin) {
-    statistic_increment(json_func_binary_count, &LOCK_status);
+    json_func_binary_count.inc();
   }
 }
 
@@ -278,7 +278,7 @@ bool Item_func_json_valid::val_bool()
     int res = parser.parse(json->c_ptr_safe());
     if (!res && parser.getErrorCode() ==
         fbson::FbsonErrType::E_INVALID_DOCU_COMPAT) {
-      statistic_increment(json_valid_count, &LOCK_status);
+      json_valid_count.inc();
       process_fb_json_audit_flag(AUDIT_FB_JSON_VALID_FLAG,
                                  "JSON_VALID called");
     }
@@ -345,7 +345,7 @@ json_extract_helper(Item **args,
     // audit warning.
     if (i == 1 && audit_func) {
       if (pstr && pstr->length() > 0 && *pstr->c_ptr_safe() == '$') {
-        statistic_increment(json_extract_count, &LOCK_status);
+        json_extract_count.inc();
         process_fb_json_audit_flag(AUDIT_FB_JSON_EXTRACT_FLAG,
                                    "JSON_EXTRACT called");
       }
@@ -691,7 +691,7 @@ bool Item_func_json_contains::val_bool()
   null_value = 0;
   String buffer;
   String *pstr = nullptr;
-  statistic_increment(json_contains_count, &LOCK_status);
+  json_contains_count.inc();
   process_fb_json_audit_flag(AUDIT_FB_JSON_CONTAINS_FLAG,
                              "JSON_CONTAINS called");
 
@@ -3346,33 +3346,9 @@ bool Log_event::schedule_dep(Relay_log_info *rli)
   if (!rli->trx_queued &&
       (rli->dep_sync_group || !rli->current_begin_event->get_db().empty()))
   {
-    mysql_mutex_lock(&rli->dep_lock);
-
-    // wait if queue has reached full capacity
-    while (unlikely(rli->dep_full))
-    {
-      const auto timeout_nsec= rli->mts_dependency_cond_wait_timeout * 1000000;
-      struct timespec abstime;
-      set_timespec_nsec(abstime, timeout_nsec);
-      mysql_cond_timedwait(&rli->dep_full_cond, &rli->dep_lock, &abstime);
-    }
-
+    // NOTE: this waits if queue has reached full capacity
     rli->enqueue_dep(rli->current_begin_event);
-
-    // case: workers are waiting on empty queue, let's signal
-    if (likely(rli->num_workers_waiting > 0))
-    {
-      DBUG_ASSERT(rli->num_workers_waiting <= rli->opt_slave_parallel_workers);
-      mysql_cond_signal(&rli->dep_empty_cond);
-    }
-
-    // admission control in dep queue
-    rli->dep_full= rli->dep_queue.size() >= rli->mts_dependency_size;
-
-    ++rli->num_in_flight_trx;
     rli->trx_queued= true;
-
-    mysql_mutex_unlock(&rli->dep_lock);
   }
 
   DBUG_ASSERT(ev->is_begin_event || rli->prev_event);
@@ -3486,16 +3462,8 @@ Log_event::handle_terminal_dep_event(Relay_log_info *rli,
     auto to_add=
       rli->mts_dependency_replication == DEP_RPL_TABLE && rli->prev_event ?
       rli->prev_event : ev;
-    mysql_mutex_lock(&rli->dep_key_lookup_mutex);
-    if (!to_add->finalized())
-    {
-      for (const auto& key : rli->keys_accessed_by_group)
-      {
-        rli->dep_key_lookup[key]= to_add;
-        to_add->keys.insert(key);
-      }
-    }
-    mysql_mutex_unlock(&rli->dep_key_lookup_mutex);
+    to_add->publish_keys(to_add, rli->keys_accessed_by_group,
+                         &rli->dep_key_lookup);
 
     // update rli state
     rli->table_map_events.clear();
@@ -12684,17 +12652,15 @@ void Rows_log_event::prepare_dep(Relay_log_info *rli,
     rli->keys_accessed_by_group.insert(m_keylist.begin(), m_keylist.end());
   }
 
-  mysql_mutex_lock(&rli->dep_key_lookup_mutex);
   /* Handle dependencies. */
   for (const auto& k : m_keylist)
   {
-    auto last_key_event= rli->dep_key_lookup.find(k);
-    if (last_key_event != rli->dep_key_lookup.end())
+    std::shared_ptr<Log_event_wrapper> last_key_event;
+    if (rli->dep_key_lookup.find(k, &last_key_event))
     {
-      last_key_event->second->add_dependent(ev);
+      last_key_event->add_dependent(ev);
     }
   }
-  mysql_mutex_unlock(&rli->dep_key_lookup_mutex);
 
   DBUG_VOID_RETURN;
 }
@@ -16563,6 +16529,27 @@ void Metadata_log_event::set_raft_rotate_tag
     (ENCODED_TYPE_SIZE + ENCODED_LENGTH_SIZE + ENCODED_RAFT_ROTATE_TAG_SIZE);
 }
 
+void Metadata_log_event::set_dependency_interval(int64_t last_committed,
+                                                 int64_t sequence_number)
+{
+  last_committed_= last_committed;
+  sequence_number_= sequence_number;
+  set_exist(Metadata_log_event_types::DEPENDENCY_INTERVAL_TYPE);
+  // Update the size of the event when it gets serialized into the stream.
+  size_ += (ENCODED_TYPE_SIZE + ENCODED_LENGTH_SIZE +
+            ENCODED_DEPENDENCY_INTERVAL_SIZE);
+}
+
+int64_t Metadata_log_event::get_last_committed() const
+{
+  return last_committed_;
+}
+
+int64_t Metadata_log_event::get_sequence_number() const
+{
+  return sequence_number_;
+}
+
 Metadata_log_event::RAFT_ROTATE_EVENT_TAG
 Metadata_log_event::get_rotate_tag() const
 {
@@ -16623,6 +16610,7 @@ uint Metadata_log_event::read_type(
   std::string generic_str;
   int64_t prev_term= -1, prev_index= -1;
   RAFT_ROTATE_EVENT_TAG raft_rotate_tag= RRET_NOT_ROTATE;
+  int64_t last_committed= -1, sequence_number= -1;
 
   switch (type)
   {
@@ -16658,6 +16646,13 @@ uint Metadata_log_event::read_type(
       raft_rotate_tag= (RAFT_ROTATE_EVENT_TAG)uint2korr(buffer + ENCODED_LENGTH_SIZE);
       set_raft_rotate_tag(raft_rotate_tag);
       break;
+    case MLET::DEPENDENCY_INTERVAL_TYPE:
+      DBUG_ASSERT(value_length == ENCODED_DEPENDENCY_INTERVAL_SIZE);
+      last_committed= uint8korr(buffer + ENCODED_LENGTH_SIZE);
+      sequence_number= uint8korr(buffer + ENCODED_LENGTH_SIZE
+                                 + sizeof(last_committed_));
+      set_dependency_interval(last_committed, sequence_number);
+      break;
     default:
       // This is a event which we do not know about. Just skip this
       size_ += (ENCODED_TYPE_SIZE + ENCODED_LENGTH_SIZE + value_length);
@@ -16696,6 +16691,9 @@ bool Metadata_log_event::write_data_body(IO_CACHE *file)
   if (write_rotate_tag(file))
     DBUG_RETURN(1);
 
+  if (write_dependency_interval(file))
+    DBUG_RETURN(1);
+
   DBUG_RETURN(0);
 }
 
@@ -16860,6 +16858,36 @@ bool Metadata_log_event::write_rotate_tag(IO_CACHE* file)
   DBUG_RETURN(ret);
 }
 
+bool Metadata_log_event::write_dependency_interval(IO_CACHE* file)
+{
+  DBUG_ENTER("Metadata_log_event::write_dependency_interval");
+
+  if (!does_exist(Metadata_log_event_types::DEPENDENCY_INTERVAL_TYPE))
+    DBUG_RETURN(0); /* No need to write dependency interval */
+
+  char buffer[ENCODED_DEPENDENCY_INTERVAL_SIZE];
+  char* ptr_buffer= buffer;
+
+  if (write_type_and_length(
+        file,
+        Metadata_log_event_types::DEPENDENCY_INTERVAL_TYPE,
+        ENCODED_DEPENDENCY_INTERVAL_SIZE))
+  {
+    DBUG_RETURN(1);
+  }
+
+  int8store(ptr_buffer, last_committed_);
+  ptr_buffer+= sizeof(last_committed_);
+
+  int8store(ptr_buffer, sequence_number_);
+  ptr_buffer+= sizeof(sequence_number_);
+
+  DBUG_ASSERT(ptr_buffer == (buffer + sizeof(buffer)));
+
+  bool ret= wrapper_my_b_safe_write(file, (uchar *) buffer, sizeof(buffer));
+  DBUG_RETURN(ret);
+}
+
 bool Metadata_log_event::write_type_and_length(
     IO_CACHE* file, Metadata_log_event_types type, uint32_t length)
 {
@@ -16948,6 +16976,14 @@ int Metadata_log_event::pack_info(Protocol *protocol)
     buffer.append("Rotate Event Tag: " + get_rotate_tag_string());
     field_added= true;
   }
+  if (does_exist(Metadata_log_event_types::DEPENDENCY_INTERVAL_TYPE))
+  {
+    if (field_added)
+      buffer.append(" ");
+    buffer.append("Last committed: " + std::to_string(last_committed_) +
+          " Sequence number: " + std::to_string(sequence_number_));
+    field_added= true;
+  }
   if (buffer.length() > 0)
     protocol->store(buffer.c_str(), buffer.length(), &my_charset_bin);
 
@@ -16984,6 +17020,10 @@ Metadata_log_event::print(FILE *file, PRINT_EVENT_INFO *print_event_info)
     if (does_exist(Metadata_log_event_types::RAFT_ROTATE_TAG_TYPE))
       buffer.append(
           "\tRotate Event Tag: " + get_rotate_tag_string());
+    if (does_exist(Metadata_log_event_types::DEPENDENCY_INTERVAL_TYPE))
+      buffer.append(
+          "\tLast committed: " + std::to_string(last_committed_) +
+          ", Sequence number: " + std::to_string(sequence_number_));
 
     print_header(head, print_event_info, FALSE);
     my_b_printf(head, "%s\n", buffer.c_str());
@@ -5532,6 +5532,31 @@ public:
    */
   void set_raft_rotate_tag(RAFT_ROTATE_EVENT_TAG t);
 
+  /**
+   * Set the dependency interval of the transaction and update internal state
+   * needed later to write this to stream
+   *
+   * @param last_committed - Sequence number of the last transaction this one
+   *                         conflicts with, 0 if none in this binlog
+   * @param sequence_number - Sequence number of this transaction
+   */
+  void set_dependency_interval(int64_t last_committed,
+                               int64_t sequence_number);
+
+  /**
+   * Get last_committed of the dependency interval
+   *
+   * @return last_committed if present. -1 otherwise
+   */
+  int64_t get_last_committed() const;
+
+  /**
+   * Get sequence_number of the dependency interval
+   *
+   * @return sequence_number if present. -1 otherwise
+   */
+  int64_t get_sequence_number() const;
+
   /**
    * The spec for different 'types' supported by this event
    */
@@ -5554,6 +5579,9 @@ public:
     RAFT_PREV_OPID_TYPE= 4,
     /* Raft Rotate Event Tag Type */
     RAFT_ROTATE_TAG_TYPE = 5,
+    /* Write set based dependency interval (last committed, sequence number)
+     * of the transaction, see binlog_transaction_dependency_tracking */
+    DEPENDENCY_INTERVAL_TYPE= 6,
     METADATA_EVENT_TYPE_MAX,
   };
 
@@ -5635,6 +5663,15 @@ private:
    */
   bool write_rotate_tag(IO_CACHE* file);
 
+  /**
+   * Write the dependency interval to file
+   *
+   * @param file - file to write into
+   *
+   * @returns - 0 on success, 1 on false
+   */
+  bool write_dependency_interval(IO_CACHE* file);
+
   /**
    * Write type and length to file
    *
@@ -5687,6 +5724,14 @@ private:
   // will write as uint16_t
   static const uint32_t ENCODED_RAFT_ROTATE_TAG_SIZE= sizeof(uint16_t);
 
+  /* Dependency interval of the transaction. Transactions whose intervals
+   * overlap did not touch the same rows and can be applied in parallel.
+   * The type corresponding to this is DEPENDENCY_INTERVAL_TYPE */
+  int64_t last_committed_= -1;
+  int64_t sequence_number_= -1;
+  static const uint32_t ENCODED_DEPENDENCY_INTERVAL_SIZE=
+    sizeof(last_committed_) + sizeof(sequence_number_);
+
   /* Total size of this event when encoded into the stream */
   uint32_t size_= 0;
 
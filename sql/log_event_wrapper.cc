@@ -13,6 +13,26 @@ void Log_event_wrapper::put_next(std::shared_ptr<Log_event_wrapper> &ev)
   mysql_mutex_unlock(&mutex);
 }
 
+void Log_event_wrapper::publish_keys(
+    const std::shared_ptr<Log_event_wrapper> &self,
+    const std::unordered_set<Dependency_key> &group_keys,
+    Dependency_key_lookup *lookup)
+{
+  DBUG_ASSERT(self.get() == this);
+  // NOTE: we hold our mutex while the keys are published so that a worker
+  // cannot finalize us half way, see @finalize()
+  mysql_mutex_lock(&mutex);
+  if (!is_finalized)
+  {
+    for (const auto& key : group_keys)
+    {
+      lookup->set(key, self);
+      keys.insert(key);
+    }
+  }
+  mysql_mutex_unlock(&mutex);
+}
+
 bool Log_event_wrapper::wait(Slave_worker *worker)
 {
   DBUG_ASSERT(worker);
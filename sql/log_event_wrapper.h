@@ -2,6 +2,13 @@
 #define LOG_EVENT_WRAPPER_H
 
 #include "log_event.h"
+#include "dependency_queue.h"
+
+class Log_event_wrapper;
+
+/* Key -> last event of the last trx that touched the key */
+typedef Dependency_key_map<Dependency_key, std::shared_ptr<Log_event_wrapper>>
+        Dependency_key_lookup;
 
 int slave_worker_exec_job(Slave_worker *worker, Relay_log_info *rli);
 
@@ -30,12 +37,12 @@ class Log_event_wrapper
 
   std::string db;
 
+  // keys this event is published under in the key lookup, protected by mutex
+  std::unordered_set<Dependency_key> keys;
+
 public:
   std::shared_ptr<Log_event_wrapper> next_ev;
 
-  // keys touched by this event, it should not be empty for rows event
-  std::unordered_set<Dependency_key> keys;
-
   // has this event been assigned to a worker queue?
   std::atomic_bool is_appended_to_queue{false};
   // is this the first event of a group?
@@ -79,9 +86,14 @@ public:
   void add_dependent(std::shared_ptr<Log_event_wrapper> &ev)
   {
     mysql_mutex_lock(&mutex);
-    DBUG_ASSERT(!is_finalized && ev.get() != this && ev->raw_ev && raw_ev);
-    dependents.push_back(ev);
-    ev->incr_dependency();
+    DBUG_ASSERT(ev.get() != this && ev->raw_ev);
+    // case: we were finalized after the key lookup returned us, so the
+    // dependency is already satisfied
+    if (likely(!is_finalized))
+    {
+      dependents.push_back(ev);
+      ev->incr_dependency();
+    }
     mysql_mutex_unlock(&mutex);
   }
 
@@ -102,11 +114,22 @@ public:
 
   bool wait(Slave_worker *worker);
 
-  void finalize()
+  void publish_keys(const std::shared_ptr<Log_event_wrapper> &self,
+                    const std::unordered_set<Dependency_key> &group_keys,
+                    Dependency_key_lookup *lookup);
+
+  void finalize(Dependency_key_lookup *lookup)
   {
     mysql_mutex_lock(&mutex);
     if (likely(!is_finalized))
     {
+      // remove the keys that still point to us from the lookup, they belong
+      // to later trxs otherwise
+      for (const auto& key : keys)
+      {
+        lookup->erase_if(key, [this](const std::shared_ptr<Log_event_wrapper>
+                                     &ev) { return ev.get() == this; });
+      }
       for (auto& dep : dependents)
       {
         // case: If the dependent still exists we decrement its dependencies, if
@@ -29,11 +29,14 @@
 #ifdef HAVE_PSI_INTERFACE
 static PSI_mutex_key key_MDL_map_mutex;
 static PSI_mutex_key key_MDL_wait_LOCK_wait_status;
+static PSI_mutex_key key_MDL_context_LOCK_cache_owners;
 
 static PSI_mutex_info all_mdl_mutexes[]=
 {
   { &key_MDL_map_mutex, "MDL_map::mutex", 0},
-  { &key_MDL_wait_LOCK_wait_status, "MDL_wait::LOCK_wait_status", 0}
+  { &key_MDL_wait_LOCK_wait_status, "MDL_wait::LOCK_wait_status", 0},
+  { &key_MDL_context_LOCK_cache_owners, "MDL_context::LOCK_cache_owners",
+    PSI_FLAG_GLOBAL}
 };
 
 static PSI_rwlock_key key_MDL_lock_rwlock;
@@ -140,12 +143,15 @@ public:
   ~MDL_map_partition();
   inline MDL_lock *find_or_insert(const MDL_key *mdl_key,
                                   my_hash_value_type hash_value);
+  inline MDL_lock *find_and_pin(const MDL_key *mdl_key,
+                                my_hash_value_type hash_value);
   inline void remove(MDL_lock *lock);
   my_hash_value_type get_key_hash(const MDL_key *mdl_key) const
   {
     return my_calc_hash(&m_locks, mdl_key->ptr(), mdl_key->length());
   }
 private:
+  MDL_lock *insert(const MDL_key *mdl_key);
   bool move_from_hash_to_lock_mutex(MDL_lock *lock);
   /** A partition of all acquired locks in the server. */
   HASH m_locks;
@@ -189,8 +195,14 @@ class MDL_map
 public:
   void init();
   void destroy();
-  MDL_lock *find_or_insert(const MDL_key *key);
+  MDL_lock *find_or_insert(const MDL_key *key,
+                           my_hash_value_type hash_value);
+  MDL_lock *find_and_pin(const MDL_key *key, my_hash_value_type hash_value);
   void remove(MDL_lock *lock);
+  my_hash_value_type get_key_hash(const MDL_key *key) const
+  {
+    return m_partitions.at(0)->get_key_hash(key);
+  }
 private:
   /** Array of partitions where the locks are actually stored. */
   Dynamic_array<MDL_map_partition *> m_partitions;
@@ -361,6 +373,32 @@ class MDL_lock
 {
 public:
   typedef unsigned short bitmap_t;
+  /**
+    Type of m_fast_path_state. The low 60 bits hold three 20 bit counters
+    of tickets granted on the fast path, see fast_path_counter(). The top
+    bit is the HAS_OBTRUSIVE flag.
+  */
+  typedef ulonglong fast_path_state_t;
+
+  /**
+    Set in m_fast_path_state while obtrusive locks are granted or waited
+    for, or while a context which holds m_rwlock checks if it can grant
+    one. No locks are granted on the fast path while it is set.
+  */
+  static const fast_path_state_t HAS_OBTRUSIVE= 1ULL << 63;
+  /** Mask of all fast path counters in m_fast_path_state. */
+  static const fast_path_state_t FAST_PATH_COUNTERS= (1ULL << 60) - 1;
+
+  /** Increment of the n-th fast path counter. */
+  static fast_path_state_t fast_path_counter(uint n)
+  {
+    return 1ULL << (20 * n);
+  }
+  /** Mask of the n-th fast path counter. */
+  static fast_path_state_t fast_path_counter_mask(uint n)
+  {
+    return ((1ULL << 20) - 1) << (20 * n);
+  }
 
   class Ticket_list
   {
@@ -433,9 +471,41 @@ public:
     return (m_granted.is_empty() && m_waiting.is_empty());
   }
 
+  /**
+    Check that there are no tickets for the lock, neither in the lists
+    nor on the fast path, and that no context caches it, so that it can
+    be removed from MDL_map.
+  */
+  bool is_unused() const
+  {
+    return (is_empty() && !(m_fast_path_state & FAST_PATH_COUNTERS) &&
+            !m_pins);
+  }
+
   virtual const bitmap_t *incompatible_granted_types_bitmap() const = 0;
   virtual const bitmap_t *incompatible_waiting_types_bitmap() const = 0;
 
+  /**
+    Increment of m_fast_path_state for a lock of the given type on the
+    key, 0 for obtrusive lock types which are never granted on the fast
+    path.
+  */
+  static inline fast_path_state_t
+  unobtrusive_lock_increment(const MDL_key *key, enum_mdl_type type);
+  fast_path_state_t unobtrusive_lock_increment(enum_mdl_type type) const
+  {
+    return unobtrusive_lock_increment(&key, type);
+  }
+
+  /** Bitmap of types of tickets granted on the fast path. */
+  virtual bitmap_t fast_path_granted_bitmap() const = 0;
+  /** Bitmap of lock types which are never granted on the fast path. */
+  virtual bitmap_t obtrusive_types_bitmap() const = 0;
+
+  void update_obtrusive_flag();
+  void release_fast_path_ticket(enum_mdl_type type);
+  void unpin();
+
   bool has_pending_conflicting_lock(enum_mdl_type type);
 
   bool can_grant_lock(enum_mdl_type type, MDL_context *requstor_ctx,
@@ -470,11 +540,28 @@ public:
   */
   ulong m_hog_lock_count;
 
+  /**
+    Counters of tickets granted on the fast path, i.e. without m_rwlock
+    and without adding them to m_granted, and the HAS_OBTRUSIVE flag.
+    The counters are changed by atomic operations only, the flag only
+    by contexts holding m_rwlock.
+  */
+  std::atomic<fast_path_state_t> m_fast_path_state;
+
+  /**
+    Number of MDL_context lock caches holding the object. Pinned objects
+    are not removed from MDL_map. The counter becomes non-zero only under
+    MDL_map_partition::m_mutex and zero only under m_rwlock.
+  */
+  std::atomic<uint> m_pins;
+
 public:
 
   MDL_lock(const MDL_key *key_arg, MDL_map_partition *map_part)
   : key(key_arg),
     m_hog_lock_count(0),
+    m_fast_path_state(0),
+    m_pins(0),
     m_ref_usage(0),
     m_ref_release(0),
     m_is_destroyed(FALSE),
@@ -576,9 +663,22 @@ public:
     return 0;
   }
 
+  virtual bitmap_t fast_path_granted_bitmap() const
+  {
+    return ((m_fast_path_state & FAST_PATH_COUNTERS) ?
+            MDL_BIT(MDL_INTENTION_EXCLUSIVE) : 0);
+  }
+  virtual bitmap_t obtrusive_types_bitmap() const
+  {
+    return MDL_BIT(MDL_SHARED) | MDL_BIT(MDL_EXCLUSIVE);
+  }
+
 private:
   static const bitmap_t m_granted_incompatible[MDL_TYPE_END];
   static const bitmap_t m_waiting_incompatible[MDL_TYPE_END];
+
+public:
+  static const fast_path_state_t m_unobtrusive_lock_increment[MDL_TYPE_END];
 };
 
 
@@ -604,6 +704,8 @@ public:
     key.mdl_key_init(new_key);
     /* m_granted and m_waiting should be already in the empty/initial state. */
     DBUG_ASSERT(is_empty());
+    /* It can't have fast path tickets or be cached by contexts either. */
+    DBUG_ASSERT(! m_fast_path_state && ! m_pins);
     /* Object should not be marked as destroyed. */
     DBUG_ASSERT(! m_is_destroyed);
     /*
@@ -640,10 +742,38 @@ public:
             MDL_BIT(MDL_EXCLUSIVE));
   }
 
+  /*
+    S and SH share a counter as they conflict with the same lock types.
+    SR and SW have a counter each.
+  */
+  virtual bitmap_t fast_path_granted_bitmap() const
+  {
+    fast_path_state_t state= m_fast_path_state;
+    bitmap_t result= 0;
+
+    if (state & fast_path_counter_mask(0))
+      result|= MDL_BIT(MDL_SHARED);
+    if (state & fast_path_counter_mask(1))
+      result|= MDL_BIT(MDL_SHARED_READ);
+    if (state & fast_path_counter_mask(2))
+      result|= MDL_BIT(MDL_SHARED_WRITE);
+    return result;
+  }
+  virtual bitmap_t obtrusive_types_bitmap() const
+  {
+    return (MDL_BIT(MDL_SHARED_UPGRADABLE) |
+            MDL_BIT(MDL_SHARED_NO_WRITE) |
+            MDL_BIT(MDL_SHARED_NO_READ_WRITE) |
+            MDL_BIT(MDL_EXCLUSIVE));
+  }
+
 private:
   static const bitmap_t m_granted_incompatible[MDL_TYPE_END];
   static const bitmap_t m_waiting_incompatible[MDL_TYPE_END];
 
+public:
+  static const fast_path_state_t m_unobtrusive_lock_increment[MDL_TYPE_END];
+
 public:
   /** Members for linking the object into the list of unused objects. */
   MDL_object_lock *next_in_cache, **prev_in_cache;
@@ -666,6 +796,21 @@ static MDL_map mdl_locks;
 */
 ulong mdl_locks_cache_size;
 
+/**
+  Contexts which cache MDL_lock objects and so can own tickets granted
+  on the fast path. Such tickets are not in MDL_lock::m_granted, this
+  list is how contexts which wait for an obtrusive lock find their owners
+  to notify or kill them.
+*/
+typedef I_P_List<MDL_context,
+                 I_P_List_adapter<MDL_context,
+                                  &MDL_context::next_in_cache_owners,
+                                  &MDL_context::prev_in_cache_owners> >
+        MDL_context_list;
+static MDL_context_list mdl_cache_owners;
+/** Protects mdl_cache_owners. */
+static mysql_mutex_t LOCK_mdl_cache_owners;
+
 
 extern "C"
 {
@@ -700,6 +845,8 @@ void mdl_init()
   init_mdl_psi_keys();
 #endif
 
+  mysql_mutex_init(key_MDL_context_LOCK_cache_owners,
+                   &LOCK_mdl_cache_owners, MY_MUTEX_INIT_FAST);
   mdl_locks.init();
 }
 
@@ -717,6 +864,8 @@ void mdl_destroy()
   {
     mdl_initialized= FALSE;
     mdl_locks.destroy();
+    DBUG_ASSERT(mdl_cache_owners.is_empty());
+    mysql_mutex_destroy(&LOCK_mdl_cache_owners);
   }
 }
 
@@ -813,7 +962,8 @@ MDL_map_partition::~MDL_map_partition()
   @retval NULL     - Failure (OOM).
 */
 
-MDL_lock* MDL_map::find_or_insert(const MDL_key *mdl_key)
+MDL_lock* MDL_map::find_or_insert(const MDL_key *mdl_key,
+                                  my_hash_value_type hash_value)
 {
   MDL_lock *lock;
 
@@ -839,7 +989,6 @@ MDL_lock* MDL_map::find_or_insert(const MDL_key *mdl_key)
     return lock;
   }
 
-  my_hash_value_type hash_value= m_partitions.at(0)->get_key_hash(mdl_key);
   uint part_id= hash_value % mdl_locks_hash_partitions;
   MDL_map_partition *part= m_partitions.at(part_id);
 
@@ -847,6 +996,36 @@ MDL_lock* MDL_map::find_or_insert(const MDL_key *mdl_key)
 }
 
 
+/**
+  Find MDL_lock object corresponding to the key, create it if it does
+  not exist, and pin it so that it stays in the map until it is unpinned
+  with MDL_lock::unpin().
+
+  @retval non-NULL - Success. Pinned MDL_lock instance for the key,
+                     MDL_lock::m_rwlock is not locked.
+  @retval NULL     - Failure (OOM).
+*/
+
+MDL_lock* MDL_map::find_and_pin(const MDL_key *mdl_key,
+                                my_hash_value_type hash_value)
+{
+  if (mdl_key->mdl_namespace() == MDL_key::GLOBAL ||
+      mdl_key->mdl_namespace() == MDL_key::COMMIT)
+  {
+    /* Pre-allocated objects are never removed, the pins only count. */
+    MDL_lock *lock= (mdl_key->mdl_namespace() == MDL_key::GLOBAL) ?
+                    m_global_lock : m_commit_lock;
+    lock->m_pins++;
+    return lock;
+  }
+
+  uint part_id= hash_value % mdl_locks_hash_partitions;
+  MDL_map_partition *part= m_partitions.at(part_id);
+
+  return part->find_and_pin(mdl_key, hash_value);
+}
+
+
 /**
   Find MDL_lock object corresponding to the key and hash value in
   MDL_map partition, create it if it does not exist.
@@ -863,61 +1042,111 @@ MDL_lock* MDL_map_partition::find_or_insert(const MDL_key *mdl_key,
 
 retry:
   mysql_mutex_lock(&m_mutex);
-  if (!(lock= (MDL_lock*) my_hash_search_using_hash_value(&m_locks,
-                                                          hash_value,
-                                                          mdl_key->ptr(),
-                                                          mdl_key->length())))
+  lock= (MDL_lock*) my_hash_search_using_hash_value(&m_locks, hash_value,
+                                                    mdl_key->ptr(),
+                                                    mdl_key->length());
+  if (!lock && !(lock= insert(mdl_key)))
+  {
+    mysql_mutex_unlock(&m_mutex);
+    return NULL;
+  }
+
+  if (move_from_hash_to_lock_mutex(lock))
+    goto retry;
+
+  return lock;
+}
+
+
+/**
+  Find MDL_lock object corresponding to the key and hash value in
+  MDL_map partition, create it if it does not exist, and pin it.
+
+  @retval non-NULL - Success. Pinned MDL_lock instance for the key.
+  @retval NULL     - Failure (OOM).
+*/
+
+MDL_lock* MDL_map_partition::find_and_pin(const MDL_key *mdl_key,
+                                          my_hash_value_type hash_value)
+{
+  MDL_lock *lock;
+
+  mysql_mutex_lock(&m_mutex);
+  lock= (MDL_lock*) my_hash_search_using_hash_value(&m_locks, hash_value,
+                                                    mdl_key->ptr(),
+                                                    mdl_key->length());
+  if (!lock && !(lock= insert(mdl_key)))
   {
-    MDL_object_lock *unused_lock= NULL;
+    mysql_mutex_unlock(&m_mutex);
+    return NULL;
+  }
+  /*
+    remove() checks the pins under m_mutex as well, so the object can't
+    be moved out of the hash once we have pinned it.
+  */
+  lock->m_pins++;
+  mysql_mutex_unlock(&m_mutex);
+  return lock;
+}
+
+
+/**
+  Create a new MDL_lock object for the key, or re-use an unused one,
+  and insert it into the partition. Must be called under m_mutex.
+
+  @retval non-NULL - Success. New MDL_lock instance for the key.
+  @retval NULL     - Failure (OOM).
+*/
+
+MDL_lock* MDL_map_partition::insert(const MDL_key *mdl_key)
+{
+  MDL_object_lock *unused_lock= NULL;
+  MDL_lock *lock;
+
+  mysql_mutex_assert_owner(&m_mutex);
 
+  /*
+    No lock object found so we need to create a new one
+    or reuse an existing unused object.
+  */
+  if (mdl_key->mdl_namespace() != MDL_key::SCHEMA &&
+      m_unused_locks_cache.elements())
+  {
     /*
-      No lock object found so we need to create a new one
-      or reuse an existing unused object.
+      We need a MDL_object_lock type of object and the unused objects
+      cache has some. Get the first object from the cache and set a new
+      key for it.
     */
-    if (mdl_key->mdl_namespace() != MDL_key::SCHEMA &&
-        m_unused_locks_cache.elements())
+    DBUG_ASSERT(mdl_key->mdl_namespace() != MDL_key::GLOBAL &&
+                mdl_key->mdl_namespace() != MDL_key::COMMIT);
+
+    unused_lock= m_unused_locks_cache.pop_front();
+    unused_lock->reset(mdl_key);
+
+    lock= unused_lock;
+  }
+  else
+  {
+    lock= MDL_lock::create(mdl_key, this);
+  }
+
+  if (!lock || my_hash_insert(&m_locks, (uchar*)lock))
+  {
+    if (unused_lock)
     {
       /*
-        We need a MDL_object_lock type of object and the unused objects
-        cache has some. Get the first object from the cache and set a new
-        key for it.
+        Note that we can't easily destroy an object from cache here as it
+        still might be referenced by other threads. So we simply put it
+        back into the cache.
       */
-      DBUG_ASSERT(mdl_key->mdl_namespace() != MDL_key::GLOBAL &&
-                  mdl_key->mdl_namespace() != MDL_key::COMMIT);
-
-      unused_lock= m_unused_locks_cache.pop_front();
-      unused_lock->reset(mdl_key);
-
-      lock= unused_lock;
+      m_unused_locks_cache.push_front(unused_lock);
     }
     else
     {
-      lock= MDL_lock::create(mdl_key, this);
-    }
-
-    if (!lock || my_hash_insert(&m_locks, (uchar*)lock))
-    {
-      if (unused_lock)
-      {
-        /*
-          Note that we can't easily destroy an object from cache here as it
-          still might be referenced by other threads. So we simply put it
-          back into the cache.
-        */
-        m_unused_locks_cache.push_front(unused_lock);
-      }
-      else
-      {
-        MDL_lock::destroy(lock);
-      }
-      mysql_mutex_unlock(&m_mutex);
-      return NULL;
+      MDL_lock::destroy(lock);
     }
+    return NULL;
   }
-
-  if (move_from_hash_to_lock_mutex(lock))
-    goto retry;
-
   return lock;
 }
 
@@ -1027,6 +1256,16 @@ void MDL_map::remove(MDL_lock *lock)
 void MDL_map_partition::remove(MDL_lock *lock)
 {
   mysql_mutex_lock(&m_mutex);
+  if (lock->m_pins)
+  {
+    /*
+      The object was unused when the caller checked it, but a context has
+      pinned it since, while we held only MDL_lock::m_rwlock. Keep it.
+    */
+    mysql_mutex_unlock(&m_mutex);
+    mysql_prlock_unlock(&lock->m_rwlock);
+    return;
+  }
   my_hash_delete(&m_locks, (uchar*) lock);
   /*
     To let threads holding references to the MDL_lock object know that it was
@@ -1099,9 +1338,17 @@ MDL_context::MDL_context()
   :
   m_owner(NULL),
   m_needs_thr_lock_abort(FALSE),
-  m_waiting_for(NULL)
+  m_waiting_for(NULL),
+  m_lock_cache_hand(0),
+  m_is_cache_owner(FALSE)
 {
   mysql_prlock_init(key_MDL_context_LOCK_waiting_for, &m_LOCK_waiting_for);
+  for (uint i= 0; i < MDL_CONTEXT_LOCK_CACHE_SIZE; i++)
+  {
+    m_lock_cache[i].m_lock= NULL;
+    m_lock_cache[i].m_hash_value= 0;
+    m_lock_cache[i].m_fast_path_tickets= 0;
+  }
 }
 
 
@@ -1123,10 +1370,122 @@ void MDL_context::destroy()
   DBUG_ASSERT(m_tickets[MDL_TRANSACTION].is_empty());
   DBUG_ASSERT(m_tickets[MDL_EXPLICIT].is_empty());
 
+  release_lock_cache();
   mysql_prlock_destroy(&m_LOCK_waiting_for);
 }
 
 
+/**
+  Check if the context owns tickets granted on the fast path for the
+  lock. Called by other contexts under LOCK_mdl_cache_owners.
+*/
+
+bool MDL_context::has_fast_path_tickets(const MDL_lock *lock) const
+{
+  for (uint i= 0; i < MDL_CONTEXT_LOCK_CACHE_SIZE; i++)
+  {
+    if (m_lock_cache[i].m_lock == lock &&
+        m_lock_cache[i].m_fast_path_tickets)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
+/** Find the lock cache entry of a cached MDL_lock object. */
+
+MDL_lock_cache_entry *MDL_context::find_cache_entry(const MDL_lock *lock)
+{
+  for (uint i= 0; i < MDL_CONTEXT_LOCK_CACHE_SIZE; i++)
+  {
+    if (m_lock_cache[i].m_lock == lock)
+      return &m_lock_cache[i];
+  }
+  return NULL;
+}
+
+
+/**
+  Find the lock cache entry for the key. If there is none, pin the
+  MDL_lock object for the key and cache it in place of an entry without
+  fast path tickets, picked clockwise from the last evicted one.
+
+  @retval non-NULL - Entry with a pinned MDL_lock object for the key.
+  @retval NULL     - All entries have fast path tickets, or out of memory.
+*/
+
+MDL_lock_cache_entry *
+MDL_context::get_cached_lock(const MDL_key *key, uint32 hash_value)
+{
+  MDL_lock_cache_entry *entry;
+  MDL_lock *lock;
+  uint i;
+
+  for (i= 0; i < MDL_CONTEXT_LOCK_CACHE_SIZE; i++)
+  {
+    entry= &m_lock_cache[i];
+    lock= entry->m_lock;
+    if (lock && entry->m_hash_value == hash_value && lock->key.is_equal(key))
+      return entry;
+  }
+
+  for (i= 0; i < MDL_CONTEXT_LOCK_CACHE_SIZE; i++)
+  {
+    entry= &m_lock_cache[m_lock_cache_hand];
+    m_lock_cache_hand= (m_lock_cache_hand + 1) % MDL_CONTEXT_LOCK_CACHE_SIZE;
+    if (!entry->m_fast_path_tickets)
+      break;
+  }
+
+  if (i == MDL_CONTEXT_LOCK_CACHE_SIZE ||
+      !(lock= mdl_locks.find_and_pin(key, hash_value)))
+    return NULL;
+
+  if (!m_is_cache_owner)
+  {
+    mysql_mutex_lock(&LOCK_mdl_cache_owners);
+    mdl_cache_owners.push_front(this);
+    mysql_mutex_unlock(&LOCK_mdl_cache_owners);
+    m_is_cache_owner= TRUE;
+  }
+
+  MDL_lock *evicted= entry->m_lock;
+  entry->m_lock= lock;
+  entry->m_hash_value= hash_value;
+  if (evicted)
+    evicted->unpin();
+  return entry;
+}
+
+
+/**
+  Unpin all cached MDL_lock objects and leave the list of cache owners.
+  The context must not own any tickets.
+*/
+
+void MDL_context::release_lock_cache()
+{
+  if (m_is_cache_owner)
+  {
+    mysql_mutex_lock(&LOCK_mdl_cache_owners);
+    mdl_cache_owners.remove(this);
+    mysql_mutex_unlock(&LOCK_mdl_cache_owners);
+    m_is_cache_owner= FALSE;
+  }
+
+  for (uint i= 0; i < MDL_CONTEXT_LOCK_CACHE_SIZE; i++)
+  {
+    MDL_lock *lock= m_lock_cache[i].m_lock;
+    DBUG_ASSERT(! m_lock_cache[i].m_fast_path_tickets);
+    if (lock)
+    {
+      m_lock_cache[i].m_lock= NULL;
+      lock->unpin();
+    }
+  }
+}
+
+
 /**
   Initialize a lock request.
 
@@ -1207,6 +1566,27 @@ void MDL_lock::destroy(MDL_lock *lock)
 }
 
 
+/**
+  @note Chooses the table of increments by object namespace, the same
+        way as MDL_lock::create(), so it can be used before the MDL_lock
+        object for the key is known.
+*/
+
+inline MDL_lock::fast_path_state_t
+MDL_lock::unobtrusive_lock_increment(const MDL_key *key, enum_mdl_type type)
+{
+  switch (key->mdl_namespace())
+  {
+    case MDL_key::GLOBAL:
+    case MDL_key::SCHEMA:
+    case MDL_key::COMMIT:
+      return MDL_scoped_lock::m_unobtrusive_lock_increment[type];
+    default:
+      return MDL_object_lock::m_unobtrusive_lock_increment[type];
+  }
+}
+
+
 /**
   Auxiliary functions needed for creation/destruction of MDL_ticket
   objects.
@@ -1636,6 +2016,18 @@ const MDL_lock::bitmap_t MDL_scoped_lock::m_waiting_incompatible[MDL_TYPE_END] =
 };
 
 
+/**
+  Increments of MDL_lock::m_fast_path_state for scoped locks. Only IX,
+  which every statement changing data takes, is granted on the fast path.
+*/
+
+const MDL_lock::fast_path_state_t
+MDL_scoped_lock::m_unobtrusive_lock_increment[MDL_TYPE_END] =
+{
+  MDL_lock::fast_path_counter(0), 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+
 /**
   Compatibility (or rather "incompatibility") matrices for per-object
   metadata lock. Arrays of bitmaps which elements specify which granted/
@@ -1730,6 +2122,28 @@ MDL_object_lock::m_waiting_incompatible[MDL_TYPE_END] =
 };
 
 
+/**
+  Increments of MDL_lock::m_fast_path_state for per-object locks.
+  S, SH, SR and SW, which DML statements take, are granted on the fast
+  path. They are compatible with each other, so a request for one of them
+  can only conflict with the obtrusive types SU, SNW, SNRW and X.
+*/
+
+const MDL_lock::fast_path_state_t
+MDL_object_lock::m_unobtrusive_lock_increment[MDL_TYPE_END] =
+{
+  0,
+  MDL_lock::fast_path_counter(0),
+  MDL_lock::fast_path_counter(0),
+  MDL_lock::fast_path_counter(1),
+  MDL_lock::fast_path_counter(2),
+  0,
+  0,
+  0,
+  0
+};
+
+
 /**
   Check if request for the metadata lock can be satisfied given its
   current state.
@@ -1764,7 +2178,14 @@ MDL_lock::can_grant_lock(enum_mdl_type type_arg,
   */
   if (ignore_lock_priority || !(m_waiting.bitmap() & waiting_incompat_map))
   {
-    if (! (m_granted.bitmap() & granted_incompat_map))
+    /*
+      Tickets granted on the fast path belong to other contexts, as a
+      context moves its own ones to m_granted before it requests an
+      obtrusive lock, and unobtrusive locks are compatible.
+    */
+    if (fast_path_granted_bitmap() & granted_incompat_map)
+      can_grant= FALSE;
+    else if (! (m_granted.bitmap() & granted_incompat_map))
       can_grant= TRUE;
     else
     {
@@ -1792,7 +2213,8 @@ void MDL_lock::remove_ticket(Ticket_list MDL_lock::*list, MDL_ticket *ticket)
 {
   mysql_prlock_wrlock(&m_rwlock);
   (this->*list).remove_ticket(ticket);
-  if (is_empty())
+  update_obtrusive_flag();
+  if (is_unused())
     mdl_locks.remove(this);
   else
   {
@@ -1816,6 +2238,73 @@ void MDL_lock::remove_ticket(Ticket_list MDL_lock::*list, MDL_ticket *ticket)
 }
 
 
+/**
+  Set or clear HAS_OBTRUSIVE depending on whether obtrusive locks are
+  granted or waited for. Must be called under m_rwlock after any change
+  of m_granted or m_waiting.
+*/
+
+void MDL_lock::update_obtrusive_flag()
+{
+  bool has_obtrusive= ((m_granted.bitmap() | m_waiting.bitmap()) &
+                       obtrusive_types_bitmap());
+
+  if (has_obtrusive == MY_TEST(m_fast_path_state & HAS_OBTRUSIVE))
+    return;
+  if (has_obtrusive)
+    m_fast_path_state.fetch_or(HAS_OBTRUSIVE);
+  else
+    m_fast_path_state.fetch_and(~HAS_OBTRUSIVE);
+}
+
+
+/**
+  Release a ticket granted on the fast path. If obtrusive locks are
+  around, do it under m_rwlock and wake up the waiters which might have
+  been blocked by it.
+*/
+
+void MDL_lock::release_fast_path_ticket(enum_mdl_type type)
+{
+  fast_path_state_t increment= unobtrusive_lock_increment(type);
+  fast_path_state_t state= m_fast_path_state;
+
+  while (!(state & HAS_OBTRUSIVE))
+  {
+    if (m_fast_path_state.compare_exchange_weak(state, state - increment))
+      return;
+  }
+
+  mysql_prlock_wrlock(&m_rwlock);
+  m_fast_path_state-= increment;
+  reschedule_waiters();
+  mysql_prlock_unlock(&m_rwlock);
+}
+
+
+/**
+  Drop a pin taken by MDL_map::find_and_pin(), and remove the object
+  from MDL_map if it is not used any more.
+*/
+
+void MDL_lock::unpin()
+{
+  uint pins= m_pins;
+
+  while (pins > 1)
+  {
+    if (m_pins.compare_exchange_weak(pins, pins - 1))
+      return;
+  }
+
+  mysql_prlock_wrlock(&m_rwlock);
+  if (m_pins-- == 1 && is_unused())
+    mdl_locks.remove(this);
+  else
+    mysql_prlock_unlock(&m_rwlock);
+}
+
+
 /**
   Check if we have any pending locks which conflict with existing
   shared lock.
@@ -1963,7 +2452,8 @@ MDL_context::try_acquire_lock(MDL_request *mdl_request)
       We can't get here if we allocated a new lock object so there
       is no need to release it.
     */
-    DBUG_ASSERT(! ticket->m_lock->is_empty());
+    DBUG_ASSERT(! ticket->m_lock->is_unused());
+    ticket->m_lock->update_obtrusive_flag();
     mysql_prlock_unlock(&ticket->m_lock->m_rwlock);
     MDL_ticket::destroy(ticket);
   }
@@ -1995,6 +2485,8 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
   MDL_lock *lock;
   MDL_key *key= &mdl_request->key;
   MDL_ticket *ticket;
+  MDL_lock_cache_entry *entry;
+  MDL_lock::fast_path_state_t increment;
   enum_mdl_duration found_duration;
 
   DBUG_ASSERT(mdl_request->type != MDL_EXCLUSIVE ||
@@ -2049,8 +2541,50 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
                                    )))
     return TRUE;
 
+  /*
+    can_grant_lock() can't tell our own tickets granted on the fast path
+    from tickets of other contexts, move them to MDL_lock::m_granted
+    before requesting a lock which might conflict with them.
+  */
+  increment= MDL_lock::unobtrusive_lock_increment(key, mdl_request->type);
+  if (!increment)
+    materialize_fast_path_locks();
+
+  my_hash_value_type hash_value= mdl_locks.get_key_hash(key);
+
+  if ((entry= get_cached_lock(key, hash_value)))
+  {
+    lock= entry->m_lock;
+
+    if (increment)
+    {
+      /*
+        Count the ticket in the entry first, so that contexts which set
+        HAS_OBTRUSIVE and then look for owners of fast path tickets can't
+        miss it.
+      */
+      entry->m_fast_path_tickets++;
+      MDL_lock::fast_path_state_t state= lock->m_fast_path_state;
+      while (!(state & MDL_lock::HAS_OBTRUSIVE))
+      {
+        if (lock->m_fast_path_state.compare_exchange_weak(state,
+                                                          state + increment))
+        {
+          ticket->m_lock= lock;
+          ticket->m_is_fast_path= true;
+          m_tickets[mdl_request->duration].push_front(ticket);
+          mdl_request->ticket= ticket;
+          return FALSE;
+        }
+      }
+      entry->m_fast_path_tickets--;
+    }
+
+    /* The object is pinned, there is no need to look it up in MDL_map. */
+    mysql_prlock_wrlock(&lock->m_rwlock);
+  }
   /* The below call implicitly locks MDL_lock::m_rwlock on success. */
-  if (!(lock= mdl_locks.find_or_insert(key)))
+  else if (!(lock= mdl_locks.find_or_insert(key, hash_value)))
   {
     MDL_ticket::destroy(ticket);
     return TRUE;
@@ -2058,6 +2592,13 @@ MDL_context::try_acquire_lock_impl(MDL_request *mdl_request,
 
   ticket->m_lock= lock;
 
+  /*
+    Stop granting locks on the fast path before checking the counters,
+    see update_obtrusive_flag() for when it is resumed.
+  */
+  if (!increment)
+    lock->m_fast_path_state|= MDL_lock::HAS_OBTRUSIVE;
+
   if (lock->can_grant_lock(mdl_request->type, this, false))
   {
     lock->m_granted.add_ticket(ticket);
@@ -2122,6 +2663,39 @@ MDL_context::clone_ticket(MDL_request *mdl_request)
 }
 
 
+/**
+  Call func for each context other than ctx which owns tickets granted
+  on the fast path for the lock, until func returns TRUE.
+
+  @retval TRUE   func returned TRUE for some context.
+  @retval FALSE  Otherwise.
+*/
+
+template <typename Func>
+static bool visit_fast_path_owners(const MDL_lock *lock, MDL_context *ctx,
+                                   Func func)
+{
+  MDL_context *owner;
+  bool result= FALSE;
+
+  if (!(lock->m_fast_path_state & MDL_lock::FAST_PATH_COUNTERS))
+    return FALSE;
+
+  mysql_mutex_lock(&LOCK_mdl_cache_owners);
+  MDL_context_list::Iterator it(mdl_cache_owners);
+  while ((owner= it++))
+  {
+    if (owner != ctx && owner->has_fast_path_tickets(lock) && func(owner))
+    {
+      result= TRUE;
+      break;
+    }
+  }
+  mysql_mutex_unlock(&LOCK_mdl_cache_owners);
+  return result;
+}
+
+
 /**
   Notify threads holding a shared metadata locks on object which
   conflict with a pending X, SNW or SNRW lock.
@@ -2153,6 +2727,15 @@ void MDL_object_lock::notify_conflicting_locks(MDL_context *ctx)
                            conflicting_ctx->get_needs_thr_lock_abort());
     }
   }
+
+  /* Tickets granted on the fast path are all weaker than SU. */
+  visit_fast_path_owners(this, ctx, [ctx](MDL_context *conflicting_ctx)
+  {
+    ctx->get_owner()->
+      notify_shared_lock(conflicting_ctx->get_owner(),
+                         conflicting_ctx->get_needs_thr_lock_abort());
+    return FALSE;
+  });
 }
 
 /**
@@ -2186,6 +2769,18 @@ bool MDL_lock::kill_conflicting_locks(MDL_context *ctx,
         slave_high_priority_ddl_killed_connections++;
     }
   }
+
+  /* Tickets granted on the fast path are all weaker than SU. */
+  if (kill_lower_than > MDL_SHARED_WRITE &&
+      visit_fast_path_owners(this, ctx, [ctx, thd](MDL_context *owner)
+      {
+        if (!ctx->get_owner()->kill_shared_locks(owner->get_owner()))
+          return true;
+        if (thd->slave_thread)
+          slave_high_priority_ddl_killed_connections++;
+        return false;
+      }))
+    return false;
   return true;
 }
 
@@ -2228,6 +2823,15 @@ void MDL_scoped_lock::notify_conflicting_locks(MDL_context *ctx)
                            conflicting_ctx->get_needs_thr_lock_abort());
     }
   }
+
+  /* IX is the only type granted on the fast path. */
+  visit_fast_path_owners(this, ctx, [ctx](MDL_context *conflicting_ctx)
+  {
+    ctx->get_owner()->
+      notify_shared_lock(conflicting_ctx->get_owner(),
+                         conflicting_ctx->get_needs_thr_lock_abort());
+    return FALSE;
+  });
 }
 
 
@@ -2579,6 +3183,9 @@ MDL_context::upgrade_shared_lock_nsec(MDL_ticket *mdl_ticket,
   if (acquire_lock_nsec(&mdl_xlock_request, lock_wait_timeout_nsec))
     DBUG_RETURN(TRUE);
 
+  /* Acquiring an obtrusive lock has moved it off the fast path. */
+  DBUG_ASSERT(! mdl_ticket->m_is_fast_path);
+
   is_new_ticket= ! has_lock(mdl_svp, mdl_xlock_request.ticket);
 
   /* Merge the acquired and the original lock. @todo: move to a method. */
@@ -2906,7 +3513,16 @@ void MDL_context::release_lock(enum_mdl_duration duration, MDL_ticket *ticket)
 
   mysql_mutex_assert_not_owner(&LOCK_open);
 
-  lock->remove_ticket(&MDL_lock::m_granted, ticket);
+  if (ticket->m_is_fast_path)
+  {
+    MDL_lock_cache_entry *entry= find_cache_entry(lock);
+    /* Entries with fast path tickets are never evicted. */
+    DBUG_ASSERT(entry && entry->m_fast_path_tickets);
+    lock->release_fast_path_ticket(ticket->get_type());
+    entry->m_fast_path_tickets--;
+  }
+  else
+    lock->remove_ticket(&MDL_lock::m_granted, ticket);
 
   m_tickets[duration].remove(ticket);
   MDL_ticket::destroy(ticket);
@@ -2930,6 +3546,38 @@ void MDL_context::release_lock(MDL_ticket *ticket)
 }
 
 
+/**
+  Move the tickets of the context granted on the fast path to
+  MDL_lock::m_granted of their locks, where the deadlock detector and
+  contexts requesting obtrusive locks see them.
+*/
+
+void MDL_context::materialize_fast_path_locks()
+{
+  for (int i= 0; i < MDL_DURATION_END; i++)
+  {
+    Ticket_iterator it(m_tickets[i]);
+    MDL_ticket *ticket;
+
+    while ((ticket= it++))
+    {
+      if (! ticket->m_is_fast_path)
+        continue;
+
+      MDL_lock *lock= ticket->m_lock;
+      mysql_prlock_wrlock(&lock->m_rwlock);
+      lock->m_fast_path_state-=
+        lock->unobtrusive_lock_increment(ticket->get_type());
+      lock->m_granted.add_ticket(ticket);
+      mysql_prlock_unlock(&lock->m_rwlock);
+
+      ticket->m_is_fast_path= false;
+      find_cache_entry(lock)->m_fast_path_tickets--;
+    }
+  }
+}
+
+
 /**
   Release all locks associated with the context. If the sentinel
   is not NULL, do not release locks stored in the list after and
@@ -3021,6 +3669,7 @@ void MDL_ticket::downgrade_lock(enum_mdl_type type)
   m_lock->m_granted.remove_ticket(this);
   m_type= type;
   m_lock->m_granted.add_ticket(this);
+  m_lock->update_obtrusive_flag();
   m_lock->reschedule_waiters();
   mysql_prlock_unlock(&m_lock->m_rwlock);
 }
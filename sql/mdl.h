@@ -31,6 +31,7 @@
 #include "thr_lock.h"
 
 #include <algorithm>
+#include <atomic>
 #include <unordered_set>
 #include <string>
 
@@ -622,7 +623,8 @@ private:
      m_duration(duration_arg),
 #endif
      m_ctx(ctx_arg),
-     m_lock(NULL)
+     m_lock(NULL),
+     m_is_fast_path(false)
   {}
 
   static MDL_ticket *create(MDL_context *ctx_arg, enum_mdl_type type_arg
@@ -651,6 +653,13 @@ private:
   */
   MDL_lock *m_lock;
 
+  /**
+    TRUE if the ticket was granted on the fast path, i.e. it is counted in
+    MDL_lock::m_fast_path_state instead of being in MDL_lock::m_granted.
+    Context private.
+  */
+  bool m_is_fast_path;
+
 private:
   MDL_ticket(const MDL_ticket &);               /* not implemented */
   MDL_ticket &operator=(const MDL_ticket &);    /* not implemented */
@@ -731,6 +740,28 @@ typedef I_P_List<MDL_request, I_P_List_adapter<MDL_request,
 
 typedef std::unordered_set<std::string> MDL_DB_Name_List;
 
+
+/** Number of MDL_lock objects each MDL_context keeps pinned. */
+static const uint MDL_CONTEXT_LOCK_CACHE_SIZE= 32;
+
+/**
+  An entry of the cache of MDL_lock objects of an MDL_context.
+
+  A cached MDL_lock object is pinned: it stays in MDL_map and keeps its
+  key until the entry is evicted, so that the context can acquire locks
+  on it without looking it up in MDL_map. Other contexts only read
+  m_lock and m_fast_path_tickets, to find owners of fast path tickets.
+*/
+
+struct MDL_lock_cache_entry
+{
+  std::atomic<MDL_lock*> m_lock;
+  /** Hash value of the key of m_lock. Context private. */
+  uint32 m_hash_value;
+  /** Number of fast path tickets of the context on m_lock. */
+  std::atomic<uint> m_fast_path_tickets;
+};
+
 /**
   Context of the owner of metadata locks. I.e. each server
   connection has such a context.
@@ -824,12 +855,20 @@ public:
   }
 
   void get_locked_object_db_names(MDL_DB_Name_List &list);
+
+  bool has_fast_path_tickets(const MDL_lock *lock) const;
 public:
   /**
     If our request for a lock is scheduled, or aborted by the deadlock
     detector, the result is recorded in this class.
   */
   MDL_wait m_wait;
+  /**
+    Pointers for participating in the list of contexts which have
+    cached locks, and thus can own fast path tickets.
+  */
+  MDL_context *next_in_cache_owners;
+  MDL_context **prev_in_cache_owners;
 private:
   /**
     Lists of all MDL tickets acquired by this connection.
@@ -914,6 +953,17 @@ private:
     readily available to the wait-for graph iterator.
    */
   MDL_wait_for_subgraph *m_waiting_for;
+  /**
+    MDL_lock objects recently used by this context, kept across
+    statements. Unobtrusive locks on these objects are acquired on the
+    fast path: by an atomic increment of MDL_lock::m_fast_path_state,
+    without MDL_map_partition::m_mutex and MDL_lock::m_rwlock.
+  */
+  MDL_lock_cache_entry m_lock_cache[MDL_CONTEXT_LOCK_CACHE_SIZE];
+  /** Next entry of m_lock_cache to consider for eviction. */
+  uint m_lock_cache_hand;
+  /** TRUE if the context is in the list of cache owners. */
+  bool m_is_cache_owner;
 private:
   THD *get_thd() const { return m_owner->get_thd(); }
   MDL_ticket *find_ticket(MDL_request *mdl_req,
@@ -922,6 +972,11 @@ private:
   void release_lock(enum_mdl_duration duration, MDL_ticket *ticket);
   bool try_acquire_lock_impl(MDL_request *mdl_request,
                              MDL_ticket **out_ticket);
+  MDL_lock_cache_entry *get_cached_lock(const MDL_key *key,
+                                        uint32 hash_value);
+  MDL_lock_cache_entry *find_cache_entry(const MDL_lock *lock);
+  void release_lock_cache();
+  void materialize_fast_path_locks();
 
 public:
   void find_deadlock();
@@ -931,6 +986,11 @@ public:
   /** Inform the deadlock detector there is an edge in the wait-for graph. */
   void will_wait_for(MDL_wait_for_subgraph *waiting_for_arg)
   {
+    /*
+      Tickets granted on the fast path are invisible to the deadlock
+      detector, so a context must not wait while it owns any.
+    */
+    materialize_fast_path_locks();
     mysql_prlock_wrlock(&m_LOCK_waiting_for);
     m_waiting_for=  waiting_for_arg;
     mysql_prlock_unlock(&m_LOCK_waiting_for);
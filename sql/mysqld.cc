@@ -500,6 +500,8 @@ ulong slave_tx_isolation;
 bool enable_blind_replace= 0;
 bool enable_binlog_hlc= 0;
 bool maintain_database_hlc= 0;
+ulong binlog_transaction_dependency_tracking= 0;
+ulong binlog_transaction_dependency_history_size= 25000;
 ulong wait_for_hlc_timeout_ms = 0;
 ulong wait_for_hlc_sleep_threshold_ms = 0;
 double wait_for_hlc_sleep_scaling_factor = 0.75;
@@ -512,6 +514,7 @@ longlong max_digest_sample_age;
 ulonglong max_tmp_disk_usage;
 ulonglong tmp_table_disk_usage_period_peak = 0;
 ulonglong filesort_disk_usage_period_peak = 0;
+ulong filesort_worker_threads;
 bool enable_raft_plugin= 0;
 bool recover_raft_log= 0;
 bool disable_raft_log_repointing= 0;
@@ -668,6 +671,16 @@ SHOW_VAR
 ulonglong
   histogram_binlog_group_commit_values[NUMBER_OF_COUNTER_HISTOGRAM_BINS];
 
+/* status variables for the binlog group commit stages */
+SHOW_VAR latency_histogram_binlog_stage_wait
+  [Stage_manager::STAGE_COUNTER][NUMBER_OF_HISTOGRAM_BINS + 1];
+ulonglong histogram_binlog_stage_wait_values
+  [Stage_manager::STAGE_COUNTER][NUMBER_OF_HISTOGRAM_BINS];
+SHOW_VAR histogram_binlog_stage_queue_var
+  [Stage_manager::STAGE_COUNTER][NUMBER_OF_COUNTER_HISTOGRAM_BINS + 1];
+ulonglong histogram_binlog_stage_queue_values
+  [Stage_manager::STAGE_COUNTER][NUMBER_OF_COUNTER_HISTOGRAM_BINS];
+
 uint net_compression_level = 6;
 /* 0 is means default for zstd/lz4. */
 long zstd_net_compression_level = ZSTD_CLEVEL_DEFAULT;
@@ -720,10 +733,14 @@ Regex_list_handler *admin_users_list_regex;
 ulong sql_stats_control;
 /* Controls collecting column statistics for every SQL statement */
 ulong column_stats_control;
+/* Collect column statistics for one out of this many executions */
+uint column_stats_sample_rate;
 /* Controls collecting execution plans for every SQL statement */
 ulong sql_plans_control;
 /* Controls collecting MySQL findings (aka SQL conditions) */
 ulong sql_findings_control;
+/* Controls collecting distinct value statistics for every SQL statement */
+ulong sql_distinct_stats_control;
 /* Controls collecting execution plans for slow queries */
 my_bool sql_plans_capture_slow_query;
 /* Controls the frequency of sql plans capture */
@@ -873,6 +890,7 @@ ulong opt_max_running_queries, opt_max_waiting_queries;
 ulong opt_max_db_connections;
 my_bool opt_admission_control_by_trx= 0;
 char *admission_control_weights;
+ulong admission_control_latency_target= 0;
 extern AC *db_ac;
 ulong rpl_stop_slave_timeout= LONG_TIMEOUT;
 my_bool rpl_slave_flow_control = 1;
@@ -1101,11 +1119,14 @@ ulong acl_fast_lookup_miss= 0;
     PRIVILEGES is issued */
 my_bool acl_fast_lookup_enabled= FALSE;
 
-/* Number of times fb style json functions are called */
-ulonglong json_extract_count = 0;
-ulonglong json_contains_count = 0;
-ulonglong json_valid_count = 0;
-ulonglong json_func_binary_count = 0;
+/*
+  Number of times fb style json functions are called. These are bumped
+  for every call, so they are sharded per CPU.
+*/
+ShardedCounter json_extract_count;
+ShardedCounter json_contains_count;
+ShardedCounter json_valid_count;
+ShardedCounter json_func_binary_count;
 
 /* Whether sql_stats_snapshot is enabled. If a session exists with
    sql_stats_snapshot set to ON this status var is ON, otherwise it's OFF. */
@@ -1128,6 +1149,14 @@ Rpl_filter* binlog_filter;
 struct system_variables global_system_variables;
 struct system_variables max_system_variables;
 struct system_status_var global_status_var;
+/*
+  Status of threads that have ended. A thread adds its status to the
+  shard of the CPU it runs on, so that disconnects do not serialize on a
+  single lock; calc_sum_of_all_status() adds the shards to
+  global_status_var.
+*/
+ShardedMutex LOCK_status_sharded;
+struct system_status_var status_var_shards[MAX_CPU_SHARDS];
 
 MY_TMPDIR mysql_tmpdir_list;
 MY_BITMAP temp_pool;
@@ -1159,10 +1188,10 @@ mysql_mutex_t LOCK_thread_count, LOCK_thd_remove;
 mysql_mutex_t LOCK_global_sql_stats;
 /* Lock to protect global_sql_plans map structure */
 mysql_mutex_t LOCK_global_sql_plans;
-/* Lock to protect global_active_sql map structure */
-mysql_mutex_t LOCK_global_active_sql;
 /* Lock to protect global_sql_findings map structure */
 mysql_mutex_t LOCK_global_sql_findings;
+/* Lock to protect global_sql_distinct_stats map structure */
+mysql_mutex_t LOCK_global_sql_distinct_stats;
 /* Lock to protect sql_stats_snapshot */
 mysql_rwlock_t LOCK_sql_stats_snapshot;
 /* Lock to protect global_write_statistics map structure */
@@ -1195,6 +1224,13 @@ mysql_mutex_t
   LOCK_user_conn, LOCK_slave_list, LOCK_active_mi,
   LOCK_connection_count, LOCK_error_messages;
 mysql_mutex_t LOCK_sql_rand;
+/*
+  Readers of global_system_variables that only read values share-lock
+  one shard, see rdlock_global_system_variables(). Everybody else goes
+  through lock_global_system_variables(), which takes the mutex and all
+  shards.
+*/
+ShardedRWLock LOCK_global_system_variables_sharded;
 
 /**
   The below lock protects access to two global server variables:
@@ -2357,13 +2393,13 @@ static void __cdecl kill_server(int sig_ptr)
     thd->store_globals();
 
     sql_print_information("Setting read_only=1 during shutdown");
-    mysql_mutex_lock(&LOCK_global_system_variables);
+    lock_global_system_variables();
     read_only= super_read_only= true;
     if (fix_read_only(nullptr, thd, OPT_GLOBAL))
       sql_print_error("Setting read_only=1 failed during shutdown");
     else
       sql_print_information("Successfully set read_only=1 during shutdown");
-    mysql_mutex_unlock(&LOCK_global_system_variables);
+    unlock_global_system_variables();
 
     DBUG_EXECUTE_IF("after_shutdown_read_only", {
       const char act[]= "now signal signal.reached wait_for signal.done";
@@ -2567,6 +2603,11 @@ void clean_up(bool print_message)
   free_latency_histogram_sysvars(latency_histogram_binlog_fsync);
   free_latency_histogram_sysvars(latency_histogram_raft_trx_wait);
   free_counter_histogram_sysvars(histogram_binlog_group_commit_var);
+  for (uint i= 0; i < Stage_manager::STAGE_COUNTER; i++)
+  {
+    free_latency_histogram_sysvars(latency_histogram_binlog_stage_wait[i]);
+    free_counter_histogram_sysvars(histogram_binlog_stage_queue_var[i]);
+  }
 
   /*
     make sure that handlers finish up
@@ -2615,6 +2656,7 @@ void clean_up(bool print_message)
   xid_cache_free();
   table_def_free();
   mdl_destroy();
+  filesort_workers_end();
   key_caches.delete_elements(free_key_cache);
   multi_keycache_free();
   free_status_vars();
@@ -2646,6 +2688,7 @@ void clean_up(bool print_message)
   free_global_sql_plans();
   free_global_active_sql();
   free_global_sql_findings();
+  free_global_sql_distinct_stats();
   free_global_write_statistics();
   free_global_write_throttling_rules();
   free_global_tx_size_histogram();
@@ -2772,6 +2815,8 @@ static void clean_up_mutexes()
     }
   }
 #endif
+  LOCK_status_sharded.destroy();
+  LOCK_global_system_variables_sharded.destroy();
   mysql_mutex_destroy(&LOCK_log_throttle_qni);
   mysql_mutex_destroy(&LOCK_log_throttle_legacy);
   mysql_mutex_destroy(&LOCK_log_throttle_ddl);
@@ -2788,8 +2833,8 @@ static void clean_up_mutexes()
   mysql_mutex_destroy(&LOCK_global_table_stats);
   mysql_mutex_destroy(&LOCK_global_sql_stats);
   mysql_mutex_destroy(&LOCK_global_sql_plans);
-  mysql_mutex_destroy(&LOCK_global_active_sql);
   mysql_mutex_destroy(&LOCK_global_sql_findings);
+  mysql_mutex_destroy(&LOCK_global_sql_distinct_stats);
   mysql_rwlock_destroy(&LOCK_sql_stats_snapshot);
   mysql_mutex_destroy(&LOCK_global_write_statistics);
   mysql_mutex_destroy(&LOCK_global_write_throttling_rules);
@@ -5786,10 +5831,10 @@ static int init_thread_environment()
                    &LOCK_global_sql_stats, MY_MUTEX_INIT_ERRCHK);
   mysql_mutex_init(key_LOCK_global_sql_plans,
                    &LOCK_global_sql_plans, MY_MUTEX_INIT_ERRCHK);
-  mysql_mutex_init(key_LOCK_global_active_sql,
-                   &LOCK_global_active_sql, MY_MUTEX_INIT_ERRCHK);
   mysql_mutex_init(key_LOCK_global_sql_findings,
                    &LOCK_global_sql_findings, MY_MUTEX_INIT_ERRCHK);
+  mysql_mutex_init(key_LOCK_global_sql_distinct_stats,
+                   &LOCK_global_sql_distinct_stats, MY_MUTEX_INIT_ERRCHK);
   mysql_rwlock_init(key_rwlock_sql_stats_snapshot, &LOCK_sql_stats_snapshot);
   mysql_mutex_init(key_LOCK_global_write_statistics,
                    &LOCK_global_write_statistics, MY_MUTEX_INIT_ERRCHK);
@@ -6234,6 +6279,7 @@ static int init_server_components()
   randominit(&sql_rand,(ulong) server_start_time,(ulong) server_start_time/2);
   setup_fpu();
   init_thr_lock();
+  filesort_workers_init();
 #ifdef HAVE_REPLICATION
   init_slave_list();
   init_compressed_event_cache();
@@ -6488,6 +6534,7 @@ a file name for --log-bin-index option", opt_binlog_index_name);
   init_global_db_stats();
   init_global_error_stats();
   init_global_sql_stats();
+  init_global_active_sql();
   reset_write_stat_histogram();
 
   /* call ha_init_key_cache() on all key caches to init them */
@@ -7907,6 +7954,7 @@ int mysqld_main(int argc, char **argv)
   db_ac->update_max_running_queries(opt_max_running_queries);
   db_ac->update_max_waiting_queries(opt_max_waiting_queries);
   db_ac->update_queue_weights(admission_control_weights);
+  db_ac->update_latency_target(admission_control_latency_target);
   db_ac->update_max_connections(opt_max_db_connections);
   if (init_server_components())
     unireg_abort(1);
@@ -10377,9 +10425,7 @@ static int show_slave_dependency_in_queue(THD *thd, SHOW_VAR *var, char *buff)
   {
     var->type= SHOW_LONGLONG;
     var->value= buff;
-    mysql_mutex_lock(&active_mi->rli->dep_lock);
     *((ulonglong *)buff)= active_mi->rli->dep_queue.size();
-    mysql_mutex_unlock(&active_mi->rli->dep_lock);
   }
   else
     var->type= SHOW_UNDEF;
@@ -10392,9 +10438,7 @@ static int show_slave_dependency_in_flight(THD *thd, SHOW_VAR *var, char *buff)
   {
     var->type= SHOW_LONGLONG;
     var->value= buff;
-    mysql_mutex_lock(&active_mi->rli->dep_lock);
     *((ulonglong *)buff)= (ulonglong) active_mi->rli->num_in_flight_trx;
-    mysql_mutex_unlock(&active_mi->rli->dep_lock);
   }
   else
     var->type= SHOW_UNDEF;
@@ -10590,6 +10634,35 @@ static int show_open_tables(THD *thd, SHOW_VAR *var, char *buff)
   return 0;
 }
 
+static int show_sharded_counter(SHOW_VAR *var, char *buff,
+                                const ShardedCounter &counter)
+{
+  var->type= SHOW_LONGLONG;
+  var->value= buff;
+  *((ulonglong *)buff)= counter.sum();
+  return 0;
+}
+
+static int show_json_contains_count(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_sharded_counter(var, buff, json_contains_count);
+}
+
+static int show_json_extract_count(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_sharded_counter(var, buff, json_extract_count);
+}
+
+static int show_json_valid_count(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_sharded_counter(var, buff, json_valid_count);
+}
+
+static int show_json_func_binary_count(THD *thd, SHOW_VAR *var, char *buff)
+{
+  return show_sharded_counter(var, buff, json_func_binary_count);
+}
+
 static int show_prepared_stmt_count(THD *thd, SHOW_VAR *var, char *buff)
 {
   var->type= SHOW_LONG;
@@ -10656,6 +10729,90 @@ static int show_histogram_binlog_group_commit(THD *thd, SHOW_VAR* var,
   var->value = (char*) &histogram_binlog_group_commit_var;
   return 0;
 }
+
+/* How long the leader of a binlog group commit stage waited to enter it */
+static int show_latency_histogram_binlog_stage_wait(
+  SHOW_VAR *var, Stage_manager::StageID stage)
+{
+  for (size_t i = 0; i < NUMBER_OF_HISTOGRAM_BINS; ++i)
+    histogram_binlog_stage_wait_values[stage][i] =
+      latency_histogram_get_count(&histogram_binlog_stage_wait[stage], i);
+
+  prepare_latency_histogram_vars(&histogram_binlog_stage_wait[stage],
+                                 latency_histogram_binlog_stage_wait[stage],
+                                 histogram_binlog_stage_wait_values[stage]);
+  var->type= SHOW_ARRAY;
+  var->value = (char*) latency_histogram_binlog_stage_wait[stage];
+  return 0;
+}
+
+/* Number of sessions a binlog group commit stage leader processed */
+static int show_histogram_binlog_stage_queue(SHOW_VAR *var,
+                                             Stage_manager::StageID stage)
+{
+  for (int i = 0; i < NUMBER_OF_COUNTER_HISTOGRAM_BINS; ++i)
+    histogram_binlog_stage_queue_values[stage][i] =
+      (histogram_binlog_stage_queue[stage].count_per_bin)[i];
+
+  prepare_counter_histogram_vars(&histogram_binlog_stage_queue[stage],
+                                 histogram_binlog_stage_queue_var[stage],
+                                 histogram_binlog_stage_queue_values[stage]);
+  var->type = SHOW_ARRAY;
+  var->value = (char*) histogram_binlog_stage_queue_var[stage];
+  return 0;
+}
+
+static int show_latency_histogram_binlog_flush_stage_wait(THD *thd,
+                                                          SHOW_VAR *var,
+                                                          char *buff)
+{
+  return show_latency_histogram_binlog_stage_wait(var,
+                                                  Stage_manager::FLUSH_STAGE);
+}
+
+static int show_latency_histogram_binlog_sync_stage_wait(THD *thd,
+                                                         SHOW_VAR *var,
+                                                         char *buff)
+{
+  return show_latency_histogram_binlog_stage_wait(var,
+                                                  Stage_manager::SYNC_STAGE);
+}
+
+static int show_latency_histogram_binlog_semisync_stage_wait(THD *thd,
+                                                             SHOW_VAR *var,
+                                                             char *buff)
+{
+  return show_latency_histogram_binlog_stage_wait(
+    var, Stage_manager::SEMISYNC_STAGE);
+}
+
+static int show_latency_histogram_binlog_commit_stage_wait(THD *thd,
+                                                           SHOW_VAR *var,
+                                                           char *buff)
+{
+  return show_latency_histogram_binlog_stage_wait(var,
+                                                  Stage_manager::COMMIT_STAGE);
+}
+
+static int show_histogram_binlog_sync_stage_queue(THD *thd, SHOW_VAR *var,
+                                                  char *buff)
+{
+  return show_histogram_binlog_stage_queue(var, Stage_manager::SYNC_STAGE);
+}
+
+static int show_histogram_binlog_semisync_stage_queue(THD *thd,
+                                                      SHOW_VAR *var,
+                                                      char *buff)
+{
+  return show_histogram_binlog_stage_queue(var,
+                                           Stage_manager::SEMISYNC_STAGE);
+}
+
+static int show_histogram_binlog_commit_stage_queue(THD *thd, SHOW_VAR *var,
+                                                    char *buff)
+{
+  return show_histogram_binlog_stage_queue(var, Stage_manager::COMMIT_STAGE);
+}
 #if defined(HAVE_OPENSSL) && !defined(EMBEDDED_LIBRARY)
 /* Functions relying on CTX */
 static int show_ssl_ctx_sess_accept(THD *thd, SHOW_VAR *var, char *buff)
@@ -11199,6 +11356,9 @@ SHOW_VAR status_vars[]= {
   {"Handler_discover",         (char*) offsetof(STATUS_VAR, ha_discover_count), SHOW_LONGLONG_STATUS},
   {"Handler_external_lock",    (char*) offsetof(STATUS_VAR, ha_external_lock_count), SHOW_LONGLONG_STATUS},
   {"Handler_mrr_init",         (char*) offsetof(STATUS_VAR, ha_multi_range_read_init_count),  SHOW_LONGLONG_STATUS},
+  {"Handler_mrr_multiget_batches", (char*) offsetof(STATUS_VAR, ha_mrr_multiget_batch_count), SHOW_LONGLONG_STATUS},
+  {"Handler_mrr_multiget_keys", (char*) offsetof(STATUS_VAR, ha_mrr_multiget_key_count), SHOW_LONGLONG_STATUS},
+  {"Handler_mrr_multiget_overlapped", (char*) offsetof(STATUS_VAR, ha_mrr_multiget_overlapped_count), SHOW_LONGLONG_STATUS},
   {"Handler_prepare",          (char*) offsetof(STATUS_VAR, ha_prepare_count),  SHOW_LONGLONG_STATUS},
   {"Handler_read_first",       (char*) offsetof(STATUS_VAR, ha_read_first_count), SHOW_LONGLONG_STATUS},
   {"Handler_read_key",         (char*) offsetof(STATUS_VAR, ha_read_key_count), SHOW_LONGLONG_STATUS},
@@ -11225,10 +11385,10 @@ SHOW_VAR status_vars[]= {
   {"Jemalloc_tcache_bytes",    (char*) &show_jemalloc_tcache_bytes,     SHOW_FUNC},
 #endif
 #endif
-  {"Json_contains_count",      (char*) &json_contains_count,            SHOW_LONGLONG},
-  {"Json_extract_count",       (char*) &json_extract_count,             SHOW_LONGLONG},
-  {"Json_valid_count",         (char*) &json_valid_count,               SHOW_LONGLONG},
-  {"Json_func_binary_count",   (char*) &json_func_binary_count,         SHOW_LONGLONG},
+  {"Json_contains_count",      (char*) &show_json_contains_count,       SHOW_FUNC},
+  {"Json_extract_count",       (char*) &show_json_extract_count,        SHOW_FUNC},
+  {"Json_valid_count",         (char*) &show_json_valid_count,          SHOW_FUNC},
+  {"Json_func_binary_count",   (char*) &show_json_func_binary_count,    SHOW_FUNC},
   {"Key_blocks_not_flushed",   (char*) offsetof(KEY_CACHE, global_blocks_changed), SHOW_KEY_CACHE_LONG},
   {"Key_blocks_unused",        (char*) offsetof(KEY_CACHE, blocks_unused), SHOW_KEY_CACHE_LONG},
   {"Key_blocks_used",          (char*) offsetof(KEY_CACHE, blocks_used), SHOW_KEY_CACHE_LONG},
@@ -11242,6 +11402,20 @@ SHOW_VAR status_vars[]= {
    (char*) &show_latency_histogram_binlog_fsync, SHOW_FUNC},
   {"histogram_binlog_group_commit",
    (char*) &show_histogram_binlog_group_commit, SHOW_FUNC},
+  {"Latency_histogram_binlog_flush_stage_wait",
+   (char*) &show_latency_histogram_binlog_flush_stage_wait, SHOW_FUNC},
+  {"Latency_histogram_binlog_sync_stage_wait",
+   (char*) &show_latency_histogram_binlog_sync_stage_wait, SHOW_FUNC},
+  {"Latency_histogram_binlog_semisync_stage_wait",
+   (char*) &show_latency_histogram_binlog_semisync_stage_wait, SHOW_FUNC},
+  {"Latency_histogram_binlog_commit_stage_wait",
+   (char*) &show_latency_histogram_binlog_commit_stage_wait, SHOW_FUNC},
+  {"histogram_binlog_sync_stage_queue",
+   (char*) &show_histogram_binlog_sync_stage_queue, SHOW_FUNC},
+  {"histogram_binlog_semisync_stage_queue",
+   (char*) &show_histogram_binlog_semisync_stage_queue, SHOW_FUNC},
+  {"histogram_binlog_commit_stage_queue",
+   (char*) &show_histogram_binlog_commit_stage_queue, SHOW_FUNC},
   {"Max_used_connections",     (char*) &max_used_connections,  SHOW_LONG},
   {"Max_statement_time_exceeded",   (char*) offsetof(STATUS_VAR, max_statement_time_exceeded), SHOW_LONG_STATUS},
   {"Max_statement_time_set",        (char*) offsetof(STATUS_VAR, max_statement_time_set), SHOW_LONG_STATUS},
@@ -11596,6 +11770,59 @@ static void init_sharding_variables()
 #else
   global_thread_list= new std::set<THD*>;
 #endif
+  LOCK_status_sharded.init(
+#ifdef HAVE_PSI_INTERFACE
+    key_LOCK_status_sharded,
+#endif
+    cpu_shard_count());
+  LOCK_global_system_variables_sharded.init(
+#ifdef HAVE_PSI_INTERFACE
+    key_rwlock_LOCK_global_system_variables_sharded,
+#endif
+    cpu_shard_count());
+}
+
+
+/**
+  Lock global_system_variables for modification, or for a read that has
+  to be consistent with LOCK_global_system_variables owners.
+
+  Takes LOCK_global_system_variables and then every shard of
+  LOCK_global_system_variables_sharded, which waits out the readers
+  that only copy the values.
+*/
+void lock_global_system_variables()
+{
+  mysql_mutex_lock(&LOCK_global_system_variables);
+  LOCK_global_system_variables_sharded.wrlock();
+}
+
+
+void unlock_global_system_variables()
+{
+  LOCK_global_system_variables_sharded.wrunlock();
+  mysql_mutex_unlock(&LOCK_global_system_variables);
+}
+
+
+/**
+  Lock global_system_variables for reading values only.
+
+  Takes the reader shard of the current CPU, so readers do not contend
+  with each other. Writers exclude them through
+  lock_global_system_variables().
+
+  @return the shard to pass to rdunlock_global_system_variables()
+*/
+uint rdlock_global_system_variables()
+{
+  return LOCK_global_system_variables_sharded.rdlock();
+}
+
+
+void rdunlock_global_system_variables(uint shard)
+{
+  LOCK_global_system_variables_sharded.rdunlock(shard);
 }
 
 /**
@@ -13282,7 +13509,7 @@ PSI_mutex_key
   key_LOCK_prepared_stmt_count,
   key_LOCK_sql_slave_skip_counter,
   key_LOCK_slave_net_timeout,
-  key_LOCK_server_started, key_LOCK_status,
+  key_LOCK_server_started, key_LOCK_status, key_LOCK_status_sharded,
   key_LOCK_system_variables_hash, key_LOCK_table_share, key_LOCK_thd_data,
   key_LOCK_thd_db_read_only_hash,
   key_LOCK_db_metadata, key_LOCK_thd_audit_data,
@@ -13301,8 +13528,8 @@ PSI_mutex_key
   key_LOCK_global_table_stats,
   key_LOCK_global_sql_stats,
   key_LOCK_global_sql_plans,
-  key_LOCK_global_active_sql,
   key_LOCK_global_sql_findings,
+  key_LOCK_global_sql_distinct_stats,
   key_LOCK_global_write_statistics,
   key_LOCK_global_write_throttling_rules,
   key_LOCK_global_write_throttling_log,
@@ -13401,6 +13628,7 @@ static PSI_mutex_info all_server_mutexes[]=
   { &key_LOCK_slave_net_timeout, "LOCK_slave_net_timeout", PSI_FLAG_GLOBAL},
   { &key_LOCK_server_started, "LOCK_server_started", PSI_FLAG_GLOBAL},
   { &key_LOCK_status, "LOCK_status", PSI_FLAG_GLOBAL},
+  { &key_LOCK_status_sharded, "LOCK_status_sharded", 0},
   { &key_LOCK_system_variables_hash, "LOCK_system_variables_hash", PSI_FLAG_GLOBAL},
   { &key_LOCK_table_share, "LOCK_table_share", PSI_FLAG_GLOBAL},
   { &key_LOCK_thd_data, "THD::LOCK_thd_data", 0},
@@ -13437,8 +13665,8 @@ static PSI_mutex_info all_server_mutexes[]=
   { &key_LOCK_global_table_stats, "LOCK_global_table_stats", PSI_FLAG_GLOBAL},
   { &key_LOCK_global_sql_stats, "LOCK_global_sql_stats", PSI_FLAG_GLOBAL},
   { &key_LOCK_global_sql_plans, "LOCK_global_sql_plans", PSI_FLAG_GLOBAL},
-  { &key_LOCK_global_active_sql, "LOCK_global_active_sql", PSI_FLAG_GLOBAL},
   { &key_LOCK_global_sql_findings, "LOCK_global_sql_findings", PSI_FLAG_GLOBAL},
+  { &key_LOCK_global_sql_distinct_stats, "LOCK_global_sql_distinct_stats", PSI_FLAG_GLOBAL},
   { &key_LOCK_global_write_statistics, "LOCK_global_write_statistics", PSI_FLAG_GLOBAL},
   { &key_LOCK_global_write_throttling_rules, "LOCK_global_write_throttling_rules", PSI_FLAG_GLOBAL},
   { &key_LOCK_global_write_throttling_log, "LOCK_global_write_throttling_log", PSI_FLAG_GLOBAL},
@@ -13468,7 +13696,8 @@ PSI_rwlock_key key_rwlock_LOCK_column_statistics, key_rwlock_LOCK_grant,
   key_rwlock_LOCK_legacy_user_name_pattern,
   key_rwlock_LOCK_admin_users_list_regex,
   key_rwlock_NAME_ID_MAP_LOCK_name_id_map,
-  key_rwlock_sql_stats_snapshot;
+  key_rwlock_sql_stats_snapshot,
+  key_rwlock_LOCK_global_system_variables_sharded;
 
 PSI_rwlock_key key_rwlock_Trans_delegate_lock;
 PSI_rwlock_key key_rwlock_Binlog_storage_delegate_lock;
@@ -13500,6 +13729,7 @@ static PSI_rwlock_info all_server_rwlocks[]=
   { &key_rwlock_LOCK_admin_users_list_regex, "LOCK_admin_users_list_regex", PSI_FLAG_GLOBAL},
   { &key_rwlock_NAME_ID_MAP_LOCK_name_id_map, "NAME_ID_MAP::LOCK_name_id_map", 0},
   { &key_rwlock_LOCK_system_variables_hash, "LOCK_system_variables_hash", PSI_FLAG_GLOBAL},
+  { &key_rwlock_LOCK_global_system_variables_sharded, "LOCK_global_system_variables_sharded", 0},
   { &key_rwlock_query_cache_query_lock, "Query_cache_query::lock", 0},
   { &key_rwlock_global_sid_lock, "gtid_commit_rollback", PSI_FLAG_GLOBAL},
   { &key_rwlock_Trans_delegate_lock, "Trans_delegate::lock", PSI_FLAG_GLOBAL},
@@ -13944,6 +14174,7 @@ void init_server_psi_keys(void)
 
   count= array_elements(all_server_threads);
   mysql_thread_register(category, all_server_threads, count);
+  init_filesort_psi_keys();
 
   count= array_elements(all_server_files);
   mysql_file_register(category, all_server_files, count);
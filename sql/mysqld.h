@@ -41,6 +41,7 @@
 #include <sys/un.h>
 #include "atomic_stat.h"
 #include "my_io_perf.h"
+#include "shardedlocks.h"                  /* ShardedMutex */
 
 class THD;
 struct handlerton;
@@ -447,6 +448,8 @@ extern my_bool recv_skip_ibuf_operations;
 extern bool enable_blind_replace;
 extern bool enable_binlog_hlc;
 extern bool maintain_database_hlc;
+extern ulong binlog_transaction_dependency_tracking;
+extern ulong binlog_transaction_dependency_history_size;
 extern ulong wait_for_hlc_timeout_ms;
 extern ulong wait_for_hlc_sleep_threshold_ms;
 extern double wait_for_hlc_sleep_scaling_factor;
@@ -972,6 +975,7 @@ extern ulong opt_max_running_queries, opt_max_waiting_queries;
 extern ulong opt_max_db_connections;
 extern my_bool opt_admission_control_by_trx;
 extern char *admission_control_weights;
+extern ulong admission_control_latency_target;
 extern my_bool opt_slave_allow_batching;
 extern my_bool allow_slave_start;
 extern char *enable_jemalloc_hpp;
@@ -1138,7 +1142,8 @@ extern char *admin_users_list;
   - sql_stats_control,
   - sql_plans_control,
   - column_stats_control,
-  - sql_findings_control
+  - sql_findings_control,
+  - sql_distinct_stats_control
   Values
   - OFF_HARD: stop the collection and all data in the corresponding
               in-memory structures is evicted
@@ -1165,6 +1170,7 @@ extern uint max_sql_text_storage_size;
 
 /* Global variable to control collecting column statistics */
 extern ulong column_stats_control;
+extern uint column_stats_sample_rate;
 
 /* Global variable to control collecting sql plans for every SQL statement */
 extern ulong sql_plans_control;
@@ -1172,6 +1178,12 @@ extern ulong sql_plans_control;
 /* Controls collecting MySQL findings (aka SQL conditions) */
 extern ulong sql_findings_control;
 
+/* Controls collecting distinct users, hosts and keys per SQL statement */
+extern ulong sql_distinct_stats_control;
+/* Size of the sketches of distinct values, 2^6 buckets: 13% std error */
+const uint SQL_DISTINCT_STATS_LOG2 = 6;
+const uint SQL_DISTINCT_STATS_BUCKETS = 1 << SQL_DISTINCT_STATS_LOG2;
+
 /* sql_id_is_needed
      Returns TRUE if SQL_ID is needed
  */
@@ -1179,7 +1191,9 @@ inline bool sql_id_is_needed()
 {
   bool needed = (sql_stats_control    == SQL_INFO_CONTROL_ON ||
                  column_stats_control == SQL_INFO_CONTROL_ON ||
-                 sql_findings_control == SQL_INFO_CONTROL_ON ? true : false);
+                 sql_findings_control == SQL_INFO_CONTROL_ON ||
+                 sql_distinct_stats_control == SQL_INFO_CONTROL_ON ?
+                 true : false);
   return needed;
 }
 
@@ -1277,6 +1291,8 @@ extern const char *in_left_expr_name, *in_additional_cond, *in_having_cond;
 extern SHOW_VAR status_vars[];
 extern struct system_variables max_system_variables;
 extern struct system_status_var global_status_var;
+extern ShardedMutex LOCK_status_sharded;
+extern struct system_status_var status_var_shards[];
 extern struct rand_struct sql_rand;
 extern const char *opt_date_time_formats[];
 extern handlerton *partition_hton;
@@ -1348,10 +1364,10 @@ extern my_atomic_rwlock_t write_query_running_lock;
 extern ulonglong tmp_table_rpl_max_file_size;
 extern ulong slave_tx_isolation;
 extern ulonglong object_stats_misses;
-extern ulonglong json_contains_count;
-extern ulonglong json_extract_count;
-extern ulonglong json_valid_count;
-extern ulonglong json_func_binary_count;
+extern ShardedCounter json_contains_count;
+extern ShardedCounter json_extract_count;
+extern ShardedCounter json_valid_count;
+extern ShardedCounter json_func_binary_count;
 
 /* Global tmp disk usage max and check. */
 extern ulonglong max_tmp_disk_usage;
@@ -1362,6 +1378,9 @@ bool is_tmp_disk_usage_over_max();
 extern ulonglong tmp_table_disk_usage_period_peak;
 extern ulonglong filesort_disk_usage_period_peak;
 
+/* Cap on the filesort worker threads shared by all parallel sorts. */
+extern ulong filesort_worker_threads;
+
 /** The size of the host_cache. */
 extern uint host_cache_size;
 void init_sql_statement_names();
@@ -1417,7 +1436,7 @@ extern PSI_mutex_key
   key_LOCK_prepared_stmt_count,
   key_LOCK_sql_slave_skip_counter,
   key_LOCK_slave_net_timeout,
-  key_LOCK_server_started, key_LOCK_status,
+  key_LOCK_server_started, key_LOCK_status, key_LOCK_status_sharded,
   key_LOCK_table_share, key_LOCK_thd_data,
   key_LOCK_thd_db_read_only_hash,
   key_LOCK_db_metadata, key_LOCK_thd_audit_data,
@@ -1436,8 +1455,8 @@ extern PSI_mutex_key
   key_LOCK_global_table_stats,
   key_LOCK_global_sql_stats,
   key_LOCK_global_sql_plans,
-  key_LOCK_global_active_sql,
   key_LOCK_global_sql_findings,
+  key_LOCK_global_sql_distinct_stats,
   key_LOCK_global_write_statistics,
   key_LOCK_global_write_throttling_rules,
   key_LOCK_global_write_throttling_log,
@@ -1483,6 +1502,7 @@ extern PSI_rwlock_key key_rwlock_LOCK_column_statistics, key_rwlock_LOCK_grant,
   key_rwlock_NAME_ID_MAP_LOCK_name_id_map,
   key_rwlock_hash_filo,
   key_rwlock_sql_stats_snapshot,
+  key_rwlock_LOCK_global_system_variables_sharded,
   key_rwlock_LOCK_ac;
 
 #ifdef HAVE_MMAP
@@ -1741,6 +1761,11 @@ extern mysql_mutex_t
        LOCK_prepared_stmt_count, LOCK_error_messages, LOCK_connection_count,
        LOCK_sql_slave_skip_counter, LOCK_slave_net_timeout,
        LOCK_log_throttle_sbr_unsafe, LOCK_replication_lag_auto_throttling;
+extern ShardedRWLock LOCK_global_system_variables_sharded;
+void lock_global_system_variables();
+void unlock_global_system_variables();
+uint rdlock_global_system_variables();
+void rdunlock_global_system_variables(uint shard);
 
 #ifdef HAVE_OPENSSL
 extern char* des_key_file;
@@ -28,6 +28,10 @@
 
 #if defined(HAVE_REPLICATION) && !defined(MYSQL_CLIENT)
 #include "log_event_wrapper.h"
+#include "dependency_queue.h"
+
+/* Largest dependency queue we allocate, whatever mts_dependency_size is */
+#define DEP_QUEUE_MAX_CAPACITY (1024 * 1024)
 #endif // HAVE_REPLICATION and !MYSQL_CLIENT
 
 #include <atomic>
@@ -1156,14 +1160,15 @@ public:
   ulong mts_dependency_order_commits= 0;
   ulonglong mts_dependency_cond_wait_timeout= 0;
 
-  std::deque<std::shared_ptr<Log_event_wrapper>> dep_queue;
+  // Trxs waiting for a worker, lock-free, see @enqueue_dep and @dequeue_dep
+  Dependency_queue<std::shared_ptr<Log_event_wrapper>> dep_queue;
+  // Only used to sleep and wake up on the conditions below, and to register
+  // trxs in the commit order manager in queue order
   mysql_mutex_t dep_lock;
 
   /* Mapping from key to penultimate (for multi event trx)/end event of the
      last trx that updated that table */
-  std::unordered_map<Dependency_key, std::shared_ptr<Log_event_wrapper>>
-                                            dep_key_lookup;
-  mysql_mutex_t dep_key_lookup_mutex;
+  Dependency_key_lookup dep_key_lookup;
 
   /* Set of keys accessed by the group */
   std::unordered_set<Dependency_key> keys_accessed_by_group;
@@ -1176,11 +1181,11 @@ public:
 
   // Mutex-condition pair to notify when queue is/is not full
   mysql_cond_t dep_full_cond;
-  bool dep_full= false;
+  std::atomic<bool> dep_full{false};
 
   // Mutex-condition pair to notify when queue is/is not empty
   mysql_cond_t dep_empty_cond;
-  ulonglong num_workers_waiting= 0;
+  std::atomic<ulonglong> num_workers_waiting{0};
 
   std::shared_ptr<Log_event_wrapper> prev_event;
   std::unordered_map<ulonglong, Table_map_log_event *> table_map_events;
@@ -1192,7 +1197,7 @@ public:
   std::atomic<bool> dependency_worker_error{false};
 
   mysql_cond_t dep_trx_all_done_cond;
-  ulonglong num_in_flight_trx= 0;
+  std::atomic<ulonglong> num_in_flight_trx{0};
   ulonglong num_events_in_current_group= 0;
 
   // Statistics
@@ -1212,20 +1217,77 @@ public:
       ++num_syncs;
   }
 
-  bool enqueue_dep(
-      const std::shared_ptr<Log_event_wrapper> &begin_event)
+  /* Number of trxs the queue may hold before the coordinator waits */
+  size_t dep_queue_limit() const
   {
-    mysql_mutex_assert_owner(&dep_lock);
-    dep_queue.push_back(begin_event);
-    return true;
+    const ulonglong limit= std::max(mts_dependency_size, 1ULL);
+    return (size_t) std::min(limit, (ulonglong) DEP_QUEUE_MAX_CAPACITY);
   }
 
+  /* Number of trxs the queue has to go down to before it is refilled */
+  size_t dep_queue_refill_level() const
+  {
+    return (size_t) (dep_queue_limit() * mts_dependency_refill_threshold /
+                     100);
+  }
+
+  /**
+    Queue a trx for the workers. Only the coordinator calls this, it waits
+    for room first if the queue is full.
+  */
+  void enqueue_dep(const std::shared_ptr<Log_event_wrapper> &begin_event)
+  {
+    if (unlikely(dep_queue.size() >= dep_queue_limit()))
+    {
+      mysql_mutex_lock(&dep_lock);
+      dep_full= true;
+      // NOTE: the workers dequeue before they check @dep_full and we set it
+      // before we check the size, so one of us sees the other
+      while (dep_full && dep_queue.size() >= dep_queue_refill_level())
+      {
+        const auto timeout_nsec= mts_dependency_cond_wait_timeout * 1000000;
+        struct timespec abstime;
+        set_timespec_nsec(abstime, timeout_nsec);
+        mysql_cond_timedwait(&dep_full_cond, &dep_lock, &abstime);
+      }
+      dep_full= false;
+      mysql_mutex_unlock(&dep_lock);
+    }
+
+    // the workers only decrement this after they dequeue the trx
+    ++num_in_flight_trx;
+    while (unlikely(!dep_queue.enqueue(begin_event)))
+      my_sleep(1);
+
+    // case: workers are waiting on empty queue, let's signal
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (unlikely(num_workers_waiting > 0))
+    {
+      DBUG_ASSERT(num_workers_waiting <= opt_slave_parallel_workers);
+      mysql_mutex_lock(&dep_lock);
+      mysql_cond_signal(&dep_empty_cond);
+      mysql_mutex_unlock(&dep_lock);
+    }
+  }
+
+  /**
+    Take the next trx off the queue, or nullptr if it is empty. Signals the
+    coordinator if it waits for the queue to drain.
+  */
   std::shared_ptr<Log_event_wrapper> dequeue_dep()
   {
-    mysql_mutex_assert_owner(&dep_lock);
-    if (dep_queue.empty()) { return nullptr; }
-    auto ret= dep_queue.front();
-    dep_queue.pop_front();
+    std::shared_ptr<Log_event_wrapper> ret;
+    if (!dep_queue.dequeue(&ret))
+      return nullptr;
+
+    // admission control
+    if (unlikely(dep_full) &&
+        dep_queue.size() < dep_queue_refill_level())
+    {
+      mysql_mutex_lock(&dep_lock);
+      mysql_cond_signal(&dep_full_cond);
+      mysql_mutex_unlock(&dep_lock);
+    }
     return ret;
   }
 
@@ -1250,16 +1312,29 @@ public:
     }
   }
 
-  void clear_dep(bool need_dep_lock= true)
+  /**
+    Drop all queued trxs and the dependency state.
+
+    @return true if the trx the coordinator was queueing was still in the
+            queue, false if a worker had already taken it or there was none
+  */
+  bool clear_dep(bool need_dep_lock= true)
   {
+    bool dropped_current= false;
+
     if (need_dep_lock)
       mysql_mutex_lock(&dep_lock);
 
-    DBUG_ASSERT(num_in_flight_trx >= dep_queue.size());
-    num_in_flight_trx -= dep_queue.size();
-    for (const auto& begin_event : dep_queue)
+    std::shared_ptr<Log_event_wrapper> begin_event;
+    while (dep_queue.dequeue(&begin_event))
+    {
+      DBUG_ASSERT(num_in_flight_trx > 0);
+      --num_in_flight_trx;
+      if (begin_event == current_begin_event)
+        dropped_current= true;
       cleanup_group(begin_event);
-    dep_queue.clear();
+    }
+    begin_event.reset();
 
     prev_event.reset();
     current_begin_event.reset();
@@ -1274,9 +1349,7 @@ public:
 
     dep_full= false;
 
-    mysql_mutex_lock(&dep_key_lookup_mutex);
     dep_key_lookup.clear();
-    mysql_mutex_unlock(&dep_key_lookup_mutex);
 
     trx_queued= false;
     num_events_in_current_group= 0;
@@ -1285,6 +1358,8 @@ public:
 
     if (need_dep_lock)
       mysql_mutex_unlock(&dep_lock);
+
+    return dropped_current;
   }
 #endif // HAVE_REPLICATION and !MYSQL_CLIENT
 };
@@ -6780,6 +6780,14 @@ int slave_start_workers(Relay_log_info *rli, ulong n, bool *mts_inited)
     goto err;
   }
 
+  if (rli->mts_dependency_replication &&
+      rli->dep_queue.init(rli->dep_queue_limit()))
+  {
+    sql_print_error("Failed to allocate the dependency queue");
+    error= 1;
+    goto err;
+  }
+
   for (i= 0; i < n; i++)
   {
     if ((error= slave_start_single_worker(rli, i)))
@@ -6850,11 +6858,11 @@ void slave_stop_workers(Relay_log_info *rli, bool *mts_inited)
     {
       // the partial check is slightly complicated in this case because we only
       // care about partial trx that has been pulled by a worker, since the
-      // queue is going to be emptied next anyway, we make this check by
-      // checking of the queue is empty
-      partial= rli->dep_queue.empty() && rli->trx_queued;
+      // queue is going to be emptied next anyway. Workers take trxs off the
+      // queue without the lock, so we only know once the queue is drained
+      const bool trx_queued= rli->trx_queued;
       // let's cleanup, we can clear the queue in this case
-      rli->clear_dep(false);
+      partial= !rli->clear_dep(false) && trx_queued;
     }
     mysql_mutex_unlock(&rli->dep_lock);
 
@@ -41,7 +41,38 @@
                                                 // unlock_global_read_lock
 
 static HASH system_variable_hash;
-static PolyLock_mutex PLock_global_system_variables(&LOCK_global_system_variables);
+/*
+  Reader shard this thread holds through PLock_global_system_variables, or
+  UINT_MAX if it holds the write lock.
+*/
+static thread_local uint global_system_variables_shard= UINT_MAX;
+
+/**
+  Guard for global system variables. Readers take one reader shard, see
+  rdlock_global_system_variables(), and writers the mutex and all shards.
+*/
+class PolyLock_global_system_variables: public PolyLock
+{
+public:
+  void rdlock()
+  {
+    global_system_variables_shard= rdlock_global_system_variables();
+  }
+  void wrlock() { lock_global_system_variables(); }
+  void unlock()
+  {
+    const uint shard= global_system_variables_shard;
+    if (shard == UINT_MAX)
+      unlock_global_system_variables();
+    else
+    {
+      global_system_variables_shard= UINT_MAX;
+      rdunlock_global_system_variables(shard);
+    }
+  }
+};
+
+static PolyLock_global_system_variables PLock_global_system_variables;
 
 /**
   Return variable name and length for hashing of variables.
@@ -257,7 +288,10 @@ uchar *sys_var::value_ptr(THD *thd, enum_var_type type, LEX_STRING *base)
 {
   if (type == OPT_GLOBAL || scope() == GLOBAL)
   {
-    mysql_mutex_assert_owner(&LOCK_global_system_variables);
+    /*
+      The caller holds lock_global_system_variables() or a reader shard,
+      see rdlock_global_system_variables().
+    */
     AutoRLock lock(guard);
     return global_value_ptr(thd, base);
   }
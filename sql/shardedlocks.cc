@@ -1,12 +1,11 @@
 #include "my_global.h"
+#include "my_sys.h"
 #include "global_threads.h"
+#include <algorithm>
 
-#ifdef SHARDED_LOCKING
-// currently this is global, but we
-// can make it per lock type if lock sharding
-// as a strategy takes off.
-my_bool gl_lock_sharding= 0;
-uint num_sharded_locks= 4;
+#ifdef HAVE_SCHED_GETCPU
+#include <sched.h>
+#endif
 
 // Thomas Wang integer hash function
 //http://web.archive.org/web/20071223173210
@@ -23,6 +22,13 @@ static uint32_t hash6432shift(uint64_t key)
   return (uint32_t) key;
 }
 
+#ifdef SHARDED_LOCKING
+// currently this is global, but we
+// can make it per lock type if lock sharding
+// as a strategy takes off.
+my_bool gl_lock_sharding= 0;
+uint num_sharded_locks= 4;
+
 static size_t get_mutex_shard(const THD *thd) {
   uint32_t hv = hash6432shift((uint64_t)thd);
   return hv % num_sharded_locks;
@@ -187,3 +193,109 @@ void mutex_unlock_shard(mysql_mutex_t *mtx,
     mysql_mutex_unlock(mtx);
 }
 #endif
+
+uint cpu_shard_count() {
+#ifdef SHARDED_LOCKING
+  if (!gl_lock_sharding)
+    return 1;
+#endif
+  uint ncpus = my_getncpus();
+  return std::max(1U, std::min(ncpus, (uint) MAX_CPU_SHARDS));
+}
+
+uint current_cpu_shard() {
+#ifdef HAVE_SCHED_GETCPU
+  int cpu = sched_getcpu();
+  if (cpu >= 0)
+    return (uint) cpu;
+#endif
+  return hash6432shift((uint64_t) pthread_self());
+}
+
+void ShardedMutex::init(
+#ifdef HAVE_PSI_INTERFACE
+                        PSI_mutex_key key,
+#endif
+                        uint size) {
+  DBUG_ASSERT(size > 0 && size <= MAX_CPU_SHARDS);
+  m_size = size;
+  for (uint i = 0; i < m_size; i++)
+    mysql_mutex_init(key, &m_shards[i].mutex, MY_MUTEX_INIT_FAST);
+}
+
+void ShardedMutex::destroy() {
+  for (uint i = 0; i < m_size; i++)
+    mysql_mutex_destroy(&m_shards[i].mutex);
+  m_size = 0;
+}
+
+uint ShardedMutex::lock() {
+  uint shard = current_cpu_shard() % m_size;
+  mysql_mutex_lock(&m_shards[shard].mutex);
+  return shard;
+}
+
+void ShardedMutex::unlock(uint shard) {
+  DBUG_ASSERT(shard < m_size);
+  mysql_mutex_unlock(&m_shards[shard].mutex);
+}
+
+void ShardedMutex::lock_all() {
+  for (uint i = 0; i < m_size; i++)
+    mysql_mutex_lock(&m_shards[i].mutex);
+}
+
+void ShardedMutex::unlock_all() {
+  for (uint i = m_size; i > 0; i--)
+    mysql_mutex_unlock(&m_shards[i - 1].mutex);
+}
+
+void ShardedRWLock::init(
+#ifdef HAVE_PSI_INTERFACE
+                         PSI_rwlock_key key,
+#endif
+                         uint size) {
+  DBUG_ASSERT(size > 0 && size <= MAX_CPU_SHARDS);
+  m_size = size;
+  for (uint i = 0; i < m_size; i++)
+    mysql_rwlock_init(key, &m_shards[i].lock);
+}
+
+void ShardedRWLock::destroy() {
+  for (uint i = 0; i < m_size; i++)
+    mysql_rwlock_destroy(&m_shards[i].lock);
+  m_size = 0;
+}
+
+uint ShardedRWLock::rdlock() {
+  uint shard = current_cpu_shard() % m_size;
+  mysql_rwlock_rdlock(&m_shards[shard].lock);
+  return shard;
+}
+
+void ShardedRWLock::rdunlock(uint shard) {
+  DBUG_ASSERT(shard < m_size);
+  mysql_rwlock_unlock(&m_shards[shard].lock);
+}
+
+void ShardedRWLock::wrlock() {
+  for (uint i = 0; i < m_size; i++)
+    mysql_rwlock_wrlock(&m_shards[i].lock);
+}
+
+void ShardedRWLock::wrunlock() {
+  for (uint i = m_size; i > 0; i--)
+    mysql_rwlock_unlock(&m_shards[i - 1].lock);
+}
+
+ulonglong ShardedCounter::sum() const {
+  ulonglong total = 0;
+  for (uint i = 0; i < MAX_CPU_SHARDS; i++)
+    total += m_shards[i].value.load(std::memory_order_relaxed);
+  return total;
+}
+
+void ShardedCounter::reset() {
+  for (uint i = 0; i < MAX_CPU_SHARDS; i++)
+    m_shards[i].value.store(0, std::memory_order_relaxed);
+}
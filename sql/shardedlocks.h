@@ -23,7 +23,9 @@ Created 10/05/2016 Anirban Rahut
 
 #include <cstdint>
 #include <cstddef>
+#include <atomic>
 #include "my_pthread.h"
+#include "mysql/psi/mysql_thread.h"
 
 #ifdef SHARDED_LOCKING
 class THD;
@@ -68,4 +70,122 @@ void mutex_unlock_shard(mysql_mutex_t *mtx,
 #define mutex_unlock_shard(arg1, arg2) mysql_mutex_unlock(arg1)
 #endif
 
+/*
+  Per-CPU sharded mutex, rwlock and counter.
+
+  Each shard sits on its own cache line. A thread works on the shard of
+  the CPU it runs on, so threads on different CPUs touch different lines
+  and only threads that share a CPU contend with each other. Operations
+  that need a consistent view of the whole object take all shards, in
+  index order. Such operations should be rare.
+
+  A thread can migrate to another CPU while it holds a shard. For that
+  reason lock() and rdlock() return the index of the shard they took,
+  and the caller passes it back to unlock().
+*/
+
+/** Upper bound for the number of shards of the classes below. */
+#define MAX_CPU_SHARDS 64
+
+/**
+  Number of shards to use for per-CPU locks: the number of CPUs, capped
+  at MAX_CPU_SHARDS, or 1 if gl_lock_sharding is OFF.
+*/
+uint cpu_shard_count();
+
+/**
+  Index of the CPU the calling thread runs on. Falls back to a hash of
+  the thread id if the CPU cannot be determined. The result is not
+  reduced to any shard count.
+*/
+uint current_cpu_shard();
+
+class ShardedMutex {
+ public:
+  ShardedMutex() : m_size(0) {}
+
+  void init(
+#ifdef HAVE_PSI_INTERFACE
+            PSI_mutex_key key,
+#endif
+            uint size);
+  void destroy();
+
+  /** Lock the shard of the current CPU and return its index. */
+  uint lock();
+  void unlock(uint shard);
+
+  void lock_all();
+  void unlock_all();
+
+  uint size() const { return m_size; }
+
+ private:
+  struct MY_ALIGNED(CPU_LEVEL1_DCACHE_LINESIZE) Shard {
+    mysql_mutex_t mutex;
+  };
+
+  Shard m_shards[MAX_CPU_SHARDS];
+  uint m_size;
+};
+
+/**
+  Reader-writer lock for data that is read far more often than written.
+  Readers share-lock one shard; writers exclusively lock all of them.
+*/
+class ShardedRWLock {
+ public:
+  ShardedRWLock() : m_size(0) {}
+
+  void init(
+#ifdef HAVE_PSI_INTERFACE
+            PSI_rwlock_key key,
+#endif
+            uint size);
+  void destroy();
+
+  /** Share-lock the shard of the current CPU and return its index. */
+  uint rdlock();
+  void rdunlock(uint shard);
+
+  void wrlock();
+  void wrunlock();
+
+  uint size() const { return m_size; }
+
+ private:
+  struct MY_ALIGNED(CPU_LEVEL1_DCACHE_LINESIZE) Shard {
+    mysql_rwlock_t lock;
+  };
+
+  Shard m_shards[MAX_CPU_SHARDS];
+  uint m_size;
+};
+
+/**
+  Statistics counter that threads on different CPUs can bump without
+  bouncing a cache line between them. Always uses MAX_CPU_SHARDS shards
+  and needs no initialization, so it can replace a plain global counter.
+  sum() is not atomic with respect to concurrent add() calls, which is
+  fine for status variables.
+*/
+class ShardedCounter {
+ public:
+  void add(ulonglong n) {
+    m_shards[current_cpu_shard() % MAX_CPU_SHARDS].value.fetch_add(
+      n, std::memory_order_relaxed);
+  }
+  void inc() { add(1); }
+
+  ulonglong sum() const;
+  void reset();
+
+ private:
+  struct MY_ALIGNED(CPU_LEVEL1_DCACHE_LINESIZE) Shard {
+    std::atomic<ulonglong> value;
+  };
+
+  Shard m_shards[MAX_CPU_SHARDS];
+};
+
 #endif
@@ -1373,12 +1373,12 @@ static my_bool acl_load(THD *thd, TABLE_LIST *tables)
     DBUG_PRINT("info",("user table fields: %d, password length: %d",
   		     table->s->fields, password_length));
 
-    mysql_mutex_lock(&LOCK_global_system_variables);
+    lock_global_system_variables();
     if (password_length < SCRAMBLED_PASSWORD_CHAR_LENGTH)
     { 
       if (opt_secure_auth)
       {
-        mysql_mutex_unlock(&LOCK_global_system_variables);
+        unlock_global_system_variables();
         sql_print_error("Fatal error: mysql.user table is in old format, "
                         "but server started with --secure-auth option.");
         goto end;
@@ -1386,12 +1386,12 @@ static my_bool acl_load(THD *thd, TABLE_LIST *tables)
       mysql_user_table_is_in_short_password_format= true;
       if (global_system_variables.old_passwords)
       {
-        mysql_mutex_unlock(&LOCK_global_system_variables);
+        unlock_global_system_variables();
       }
       else
       {
         global_system_variables.old_passwords= 1;
-        mysql_mutex_unlock(&LOCK_global_system_variables);
+        unlock_global_system_variables();
         sql_print_warning("mysql.user table is not updated to new password format; "
                           "Disabling new password usage until "
                           "mysql_fix_privilege_tables is run");
@@ -1401,7 +1401,7 @@ static my_bool acl_load(THD *thd, TABLE_LIST *tables)
     else
     {
       mysql_user_table_is_in_short_password_format= false;
-      mysql_mutex_unlock(&LOCK_global_system_variables);
+      unlock_global_system_variables();
     }
   } /* End legacy password integrity checks ----------------------------------*/
   
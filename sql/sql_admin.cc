@@ -1018,14 +1018,14 @@ bool mysql_assign_to_keycache(THD* thd, TABLE_LIST* tables,
   DBUG_ENTER("mysql_assign_to_keycache");
 
   check_opt.init();
-  mysql_mutex_lock(&LOCK_global_system_variables);
+  lock_global_system_variables();
   if (!(key_cache= get_key_cache(key_cache_name)))
   {
-    mysql_mutex_unlock(&LOCK_global_system_variables);
+    unlock_global_system_variables();
     my_error(ER_UNKNOWN_KEY_CACHE, MYF(0), key_cache_name->str);
     DBUG_RETURN(TRUE);
   }
-  mysql_mutex_unlock(&LOCK_global_system_variables);
+  unlock_global_system_variables();
   if (!key_cache->key_cache_inited)
   {
     my_error(ER_UNKNOWN_KEY_CACHE, MYF(0), key_cache_name->str);
@@ -1523,7 +1523,8 @@ void close_thread_table(THD *thd, TABLE **table_ptr, bool update_stats)
   if (table->file != NULL)
     table->file->unbind_psi();
 
-  Table_cache *tc= table_cache_manager.get_cache(thd);
+  /* The thread might run on another CPU than when it opened the table. */
+  Table_cache *tc= table_cache_manager.get_cache(table);
 
   tc->lock();
 
@@ -2668,7 +2669,7 @@ void return_table_to_cache(THD *thd, TABLE_LIST *table_list)
     if (table->file != NULL)
       table->file->unbind_psi();
 
-    tc= table_cache_manager.get_cache(thd);
+    tc= table_cache_manager.get_cache(table);
     tc->lock();
 
     /* Deal with cache invalidation */
@@ -2698,10 +2699,12 @@ void return_table_to_cache(THD *thd, TABLE_LIST *table_list)
 
 /*
  * This function basically copies functionality from open_table() to
- * create a table from a share.
+ * create a table from a share. The new table is added to tc, which the
+ * caller has locked.
  */
 static TABLE*
-init_table_from_share(THD *thd, TABLE_SHARE *share, TABLE_LIST *table_list)
+init_table_from_share(THD *thd, Table_cache *tc, TABLE_SHARE *share,
+                      TABLE_LIST *table_list)
 {
   DBUG_ENTER("init_table_from_share");
 
@@ -2733,14 +2736,10 @@ init_table_from_share(THD *thd, TABLE_SHARE *share, TABLE_LIST *table_list)
     my_free(table);
     goto err;
   }
+  /* Add new TABLE object to table cache for this connection. */
+  if (tc->add_used_table(thd, table, false))
   {
-    /* Add new TABLE object to table cache for this connection. */
-    Table_cache *tc= table_cache_manager.get_cache(thd);
-
-    if (tc->add_used_table(thd, table, false))
-    {
-      goto err;
-    }
+    goto err;
   }
 
   table->mdl_ticket= table_list->mdl_request.ticket;
@@ -2814,7 +2813,8 @@ bool get_table_from_cache(THD *thd, TABLE_LIST *table_list)
     /* We have a share ref! Try to init the table from the share */
     if (share)
     {
-      if ((table= init_table_from_share(thd, share, table_list)) == NULL)
+      if ((table= init_table_from_share(thd, tc, share,
+                                         table_list)) == NULL)
       {
         release_table_share(share);
       }
@@ -384,8 +384,9 @@ bool toggle_sql_stats_snapshot(THD *thd);
 void flush_sql_statistics(THD *thd);
 
 /* For active sql */
-extern mysql_mutex_t LOCK_global_active_sql;
+void init_global_active_sql(void);
 void free_global_active_sql(void);
+void release_active_sql_pins(THD *thd);
 bool register_active_sql(THD *thd, char *query_text, uint query_length);
 void remove_active_sql(THD *thd);
 
@@ -413,6 +414,14 @@ int  fill_sql_findings(THD *thd, TABLE_LIST *tables, Item *cond);
 void free_global_sql_findings(void);
 void store_sql_findings(THD *thd, char *query_text);
 
+/* For information_schema.sql_distinct_statistics */
+extern ST_FIELD_INFO sql_distinct_stats_fields_info[];
+extern mysql_mutex_t LOCK_global_sql_distinct_stats;
+int  fill_sql_distinct_stats(THD *thd, TABLE_LIST *tables, Item *cond);
+void free_global_sql_distinct_stats(void);
+void record_sql_distinct_key(THD *thd, uint32 key_hash);
+void store_sql_distinct_stats(THD *thd);
+
 /* For information_schema.write_statistics */
 extern ST_FIELD_INFO write_statistics_fields_info[];
 extern mysql_mutex_t LOCK_global_write_statistics;
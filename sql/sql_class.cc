@@ -35,6 +35,7 @@
                                               // acl_getroot_no_password
 #include "sql_base.h"                         // close_temporary_tables
 #include "sql_handler.h"                      // mysql_ha_cleanup
+#include "column_statistics.h"          // flush_column_usage_info
 #include "rpl_rli.h"
 #include "rpl_filter.h"
 #include "rpl_record.h"
@@ -337,9 +338,9 @@ void thd_set_thread_stack(THD *thd, const char *stack_start)
 
   @param thd                       THD object
 */
-void thd_lock_thread_count(THD *)
+void thd_lock_thread_count(THD *thd)
 {
-  mysql_mutex_lock(&LOCK_thread_count);
+  mutex_lock_shard(SHARDED(&LOCK_thread_count), thd);
 }
 
 /**
@@ -348,10 +349,10 @@ void thd_lock_thread_count(THD *)
 
   @param thd                       THD object
 */
-void thd_unlock_thread_count(THD *)
+void thd_unlock_thread_count(THD *thd)
 {
   mysql_cond_broadcast(&COND_thread_count);
-  mysql_mutex_unlock(&LOCK_thread_count);
+  mutex_unlock_shard(SHARDED(&LOCK_thread_count), thd);
 }
 
 /**
@@ -1156,6 +1157,8 @@ THD::THD(bool enable_plugins)
   should_write_gtid = TRUE;
   tmp= sql_rnd_with_mutex();
   randominit(&rand, tmp + (ulong) &rand, tmp + (ulong) ::global_query_id);
+  randominit(&column_usage_rand, tmp + (ulong) &column_usage_rand,
+             tmp + (ulong) this);
   substitute_null_with_insert_id = FALSE;
   thr_lock_info_init(&lock_info); /* safety: will be reset after start */
 
@@ -1521,7 +1524,12 @@ extern "C"   THD *_current_thd_noinline(void)
 
 void THD::init(void)
 {
-  mysql_mutex_lock(&LOCK_global_system_variables);
+  /*
+    Copying the globals only needs them to stay unchanged, so take one
+    reader shard rather than the mutex: connects and COM_RESET_CONNECTION
+    then do not serialize on each other.
+  */
+  uint shard= rdlock_global_system_variables();
   plugin_thdvar_init(this, m_enable_plugins);
   /*
     variables= global_system_variables above has reset
@@ -1534,7 +1542,7 @@ void THD::init(void)
    based on per-connection capabilities
    */
   fix_capability_based_variables();
-  mysql_mutex_unlock(&LOCK_global_system_variables);
+  rdunlock_global_system_variables(shard);
   server_status= SERVER_STATUS_AUTOCOMMIT;
   if (variables.sql_mode & MODE_NO_BACKSLASH_ESCAPES)
     server_status|= SERVER_STATUS_NO_BACKSLASH_ESCAPES;
@@ -1682,10 +1690,10 @@ void THD::cleanup_connection(void)
   cleanup_done= 0;
 
   /* Aggregate to global status now that cleanup is done. */
-  mysql_mutex_lock(&LOCK_status);
-  add_to_status(&global_status_var, &status_var);
+  uint shard= LOCK_status_sharded.lock();
+  add_to_status(&status_var_shards[shard], &status_var);
   set_status_var_init();
-  mysql_mutex_unlock(&LOCK_status);
+  LOCK_status_sharded.unlock(shard);
 
   propagate_pending_global_disk_usage();
 
@@ -1872,6 +1880,8 @@ void THD::release_resources()
     cleanup();
 
   mdl_context.destroy();
+  release_active_sql_pins(this);
+  flush_column_usage_info(this);
   ha_close_connection(this);
   mysql_audit_release(this);
   if (m_enable_plugins)
@@ -1885,10 +1895,10 @@ void THD::release_resources()
 #endif
 
   /* Aggregate to global status now that operations above are done. */
-  mysql_mutex_lock(&LOCK_status);
-  add_to_status(&global_status_var, &status_var);
+  uint shard= LOCK_status_sharded.lock();
+  add_to_status(&status_var_shards[shard], &status_var);
   set_status_var_init();
-  mysql_mutex_unlock(&LOCK_status);
+  LOCK_status_sharded.unlock(shard);
 
   propagate_pending_global_disk_usage();
 
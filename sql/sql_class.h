@@ -21,6 +21,7 @@
 
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include <deque>
 #include <memory>
@@ -708,6 +709,7 @@ typedef struct system_variables
   ulong slow_log_if_rows_examined_exceed;
   ulong div_precincrement;
   ulong sortbuff_size;
+  ulong filesort_max_threads;
   ulong max_sp_recursion_depth;
   ulong default_week_format;
   ulong max_seeks_for_key;
@@ -866,6 +868,8 @@ typedef struct system_variables
   my_bool sql_stats_snapshot;
   my_bool sql_stats_auto_snapshot;
 
+  uint sql_distinct_stats_window;
+
   my_bool reset_period_status_vars;
 
   my_bool write_throttle_tag_only;
@@ -902,6 +906,14 @@ typedef struct system_status_var
     BatchedKeyAccess.
   */
   ulonglong ha_multi_range_read_init_count;
+  /*
+    Batches of primary key lookups issued by MultiGet-based MRR, the number
+    of keys in them and how many were fetched while the previous batch was
+    still being returned.
+  */
+  ulonglong ha_mrr_multiget_batch_count;
+  ulonglong ha_mrr_multiget_key_count;
+  ulonglong ha_mrr_multiget_overlapped_count;
   ulonglong ha_rollback_count;
   ulonglong ha_update_count;
   ulonglong ha_write_count;
@@ -2470,10 +2482,41 @@ public:
   /* Next HLC value */
   uint64_t hlc_time_ns_next= 0;
   bool should_update_hlc= false;
+  /* Sequence number of the last transaction of this session, counted from
+     server start, for binlog_transaction_dependency_tracking */
+  int64_t last_dependency_sequence= 0;
   std::unordered_set<std::string> databases;
 
   /* Column usage statistics for the SQL statements */
   std::set<ColumnUsageInfo> column_usage_info;
+  /* Column usage collected by this session, not yet in col_statistics_map */
+  std::vector<std::pair<md5_key, std::set<ColumnUsageInfo> > >
+    column_usage_buffer;
+  /* start_utime of the statement that buffered the oldest entry above */
+  ulonglong column_usage_buffer_time= 0;
+  /* SQL IDs known to be in col_statistics_map or column_usage_buffer */
+  std::unordered_set<md5_key> column_usage_known;
+  /* Value of col_statistics_version that column_usage_known is valid for */
+  ulonglong column_usage_version= 0;
+  /* Used to sample statements, see column_stats_sample_rate */
+  struct rand_struct column_usage_rand;
+
+  /*
+    Hyperloglog registers of the index lookup keys of the current statement,
+    see sql_distinct_stats_control
+  */
+  uchar distinct_key_registers[SQL_DISTINCT_STATS_BUCKETS];
+  bool distinct_keys_recorded= false;
+
+  /* Forget the index lookup keys recorded for the current statement */
+  void reset_distinct_keys()
+  {
+    if (distinct_keys_recorded)
+    {
+      memset(distinct_key_registers, 0, sizeof(distinct_key_registers));
+      distinct_keys_recorded= false;
+    }
+  }
 
   void reset_for_next_command();
   /*
@@ -3760,6 +3803,9 @@ public:
   md5_key          mt_key_val[MT_KEY_MAX] = {};
   std::atomic_bool mt_key_val_set[MT_KEY_MAX];
 
+  /* Pins for the lock-free registry of active statements (SQL_HASH) */
+  LF_PINS *active_sql_pins = nullptr;
+
   /* SQL_ID and SQL_PLAN may be accessed by another thread executing
      SHOW PROCESSLIST or a SQL reading from I_S.PROCESSLIST
   */
@@ -1346,6 +1346,42 @@ bool thd_prepare_connection(THD *thd)
   return FALSE;
 }
 
+/**
+  Log in a new connection and set up its session, recording the time it
+  took in the connection create histogram of the user.
+
+  @param thd          Connection to log in
+  @param launch_time  Microseconds spent creating the thread for it
+
+  @retval FALSE  Connection is logged in
+  @retval TRUE   Login failed
+*/
+
+bool thd_setup_connection(THD *thd, ulong launch_time)
+{
+  USER_STATS *us= thd_get_user_stats(thd);
+  ulonglong start_time= my_timer_now();
+  bool rc= thd_prepare_connection(thd);
+  ulonglong connection_create_time= my_timer_since(start_time) +
+                                    microseconds_to_my_timer(launch_time);
+  latency_histogram_increment(&us->histogram_connection_create,
+                              connection_create_time, 1);
+  if (rc)
+    return rc;
+
+  /*
+    Set per user session variables for this user.
+    Ignore the return value of the function but errors will logged.
+  */
+  per_user_session_variables.set_thd(thd);
+
+  // set correct thread priority
+  thd->set_thread_priority();
+
+  thd->set_dscp_on_socket();
+  return FALSE;
+}
+
 bool thd_is_connection_alive(THD *thd)
 {
   NET *net= thd->get_net();
@@ -1383,10 +1419,8 @@ void set_conn_timeout_err(THD *thd, char *msg_buf)
 
 void do_handle_one_connection(THD *thd_arg)
 {
-  ulonglong start_time, connection_create_time;
   ulong launch_time= 0;
   THD *thd= thd_arg;
-  USER_STATS *us= thd_get_user_stats(thd);
 
   thd->thr_create_utime= my_micro_time();
 
@@ -1431,31 +1465,12 @@ void do_handle_one_connection(THD *thd_arg)
 
   for (;;)
   {
-	bool rc;
-
     NET *net= thd->get_net();
     mysql_socket_set_thread_owner(net->vio->mysql_socket);
 
-    start_time = my_timer_now();
-    rc= thd_prepare_connection(thd);
-    connection_create_time = my_timer_since(start_time) +
-                             microseconds_to_my_timer(launch_time);
-    latency_histogram_increment(&us->histogram_connection_create,
-                                connection_create_time, 1);
-    if (rc)
+    if (thd_setup_connection(thd, launch_time))
       goto end_thread;
 
-    /*
-      Set per user session variables for this user.
-      Ignore the return value of the function but errors will logged.
-    */
-    per_user_session_variables.set_thd(thd);
-
-    // set correct thread priority
-    thd->set_thread_priority();
-
-    thd->set_dscp_on_socket();
-
     conn_timeout = thd->variables.net_wait_timeout_seconds;
     set_conn_timeout_err(thd, timeout_error_msg_buf);
 
@@ -40,6 +40,7 @@ void release_user_connection(THD *thd);
 bool thd_init_client_charset(THD *thd, uint cs_number);
 bool setup_connection_thread_globals(THD *thd);
 bool thd_prepare_connection(THD *thd);
+bool thd_setup_connection(THD *thd, ulong launch_time);
 bool thd_is_connection_alive(THD *thd);
 void thd_update_net_stats(THD* thd);
 
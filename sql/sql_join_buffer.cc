@@ -1833,7 +1833,6 @@ finish:
 
 enum_nested_loop_state JOIN_CACHE_BNL::join_matching_records(bool skip_last)
 {
-  uint cnt;
   int error;
   READ_RECORD *info;
   enum_nested_loop_state rc= NESTED_LOOP_OK;
@@ -1889,24 +1888,9 @@ enum_nested_loop_state JOIN_CACHE_BNL::join_matching_records(bool skip_last)
         return NESTED_LOOP_ERROR;
       if (consider_record)
       {
-        /* Prepare to read records from the join buffer */
-        reset_cache(false);
-
-        /* Read each record from the join buffer and look for matches */
-        for (cnt= records - MY_TEST(skip_last) ; cnt; cnt--)
-        { 
-          /* 
-            If only the first match is needed and it has been already found for
-            the next record read from the join buffer then the record is skipped.
-          */
-          if (!check_only_first_match || !skip_record_if_match())
-          {
-            get_record();
-            rc= generate_full_extensions(get_curr_rec());
-            if (rc != NESTED_LOOP_OK)
-              return rc;
-          }
-        }
+        rc= join_buffered_records(skip_last);
+        if (rc != NESTED_LOOP_OK)
+          return rc;
       }
     }
   } while (!(error= info->read_record(info)));
@@ -1916,6 +1900,49 @@ enum_nested_loop_state JOIN_CACHE_BNL::join_matching_records(bool skip_last)
   return rc;
 }
 
+
+/*
+  Extend the records from the join buffer by the current row of join_tab
+
+  SYNOPSIS
+    join_buffered_records()
+      skip_last    do not look for matches for the last partial join record
+
+  DESCRIPTION
+    The function reads all records from the join buffer and generates
+    all full extensions for those of them that match the row of the
+    join_tab table that has been just read.
+
+  RETURN
+    return one of enum_nested_loop_state.
+*/
+
+enum_nested_loop_state JOIN_CACHE_BNL::join_buffered_records(bool skip_last)
+{
+  uint cnt;
+  enum_nested_loop_state rc;
+
+  /* Prepare to read records from the join buffer */
+  reset_cache(false);
+
+  /* Read each record from the join buffer and look for matches */
+  for (cnt= records - MY_TEST(skip_last) ; cnt; cnt--)
+  {
+    /*
+      If only the first match is needed and it has been already found for
+      the next record read from the join buffer then the record is skipped.
+    */
+    if (!check_only_first_match || !skip_record_if_match())
+    {
+      get_record();
+      rc= generate_full_extensions(get_curr_rec());
+      if (rc != NESTED_LOOP_OK)
+        return rc;
+    }
+  }
+  return NESTED_LOOP_OK;
+}
+
      
 /*
   Set match flag for a record in join buffer if it has not been set yet    
@@ -3408,6 +3435,556 @@ bool JOIN_CACHE_BKA_UNIQUE::check_match(uchar *rec_ptr)
 }
 
 
+/*
+  Check whether equal values of two fields always get equal hashes
+
+  SYNOPSIS
+    hashable_fields()
+      field   the column of the joined table
+      arg     the column of a previous table it is compared with
+
+  DESCRIPTION
+    The function checks whether an equality between the fields compares
+    their values in a way that JOIN_CACHE_HASH::hash_key() hashes equal
+    values to the same hash. This holds when both fields are temporal
+    fields of the same type, or when neither is temporal, they have the
+    same result type and, for strings, the same collation. Enumerations,
+    sets, geometries and documents are never hashed.
+
+  RETURN
+    TRUE    if the records can be hashed by the equality
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_HASH::hashable_fields(const Field *field, const Field *arg)
+{
+  const Field *fields[]= { field, arg };
+  for (uint i= 0; i < array_elements(fields); i++)
+  {
+    switch (fields[i]->real_type()) {
+    case MYSQL_TYPE_ENUM:
+    case MYSQL_TYPE_SET:
+    case MYSQL_TYPE_GEOMETRY:
+    case MYSQL_TYPE_DOCUMENT:
+      return FALSE;
+    default:
+      break;
+    }
+  }
+
+  if (field->is_temporal() || arg->is_temporal())
+    return field->type() == arg->type();
+
+  if (field->result_type() != arg->result_type())
+    return FALSE;
+
+  return field->result_type() != STRING_RESULT ||
+         field->charset() == arg->charset();
+}
+
+
+/*
+  Check whether the records joined with a table can be hashed by an equality
+
+  SYNOPSIS
+    is_hash_key()
+      tab      the joined table
+      field    the column compared on one side of the equality
+      arg      the column compared on the other side
+
+  RETURN
+    TRUE    if field is a column of tab, arg a column of another table and
+            the columns are hashable
+    FALSE   otherwise
+*/
+
+static bool is_hash_key(const JOIN_TAB *tab, const Item_field *field,
+                        const Item_field *arg)
+{
+  return field->field->table == tab->table &&
+         !(arg->used_tables() & tab->table->map) &&
+         JOIN_CACHE_HASH::hashable_fields(field->field, arg->field);
+}
+
+
+/*
+  Collect the equalities the records joined with a table can be hashed by
+
+  SYNOPSIS
+    find_hash_keys()
+      tab      the joined table
+      cond     the condition to look for equalities in
+      fields   OUT: the columns of tab compared in the equalities
+      args     OUT: the columns of the previous tables they are compared with
+      parts    the number of equalities found so far
+
+  DESCRIPTION
+    The function looks for conjuncts of cond of the form
+    tab.column = t.column where t is a previous table and the columns are
+    hashable, see JOIN_CACHE_HASH::hashable_fields(). It also looks into
+    the ON condition of the outer join for which tab is an inner table
+    since this condition is switched on while the matches are searched
+    in the join buffer. At most MAX_REF_PARTS equalities are collected.
+
+  RETURN
+    the number of equalities found
+*/
+
+static uint find_hash_keys(JOIN_TAB *tab, Item *cond,
+                           Field **fields, Field **args, uint parts)
+{
+  if (parts == MAX_REF_PARTS)
+    return parts;
+
+  if (cond->type() == Item::COND_ITEM)
+  {
+    if (((Item_cond*) cond)->functype() != Item_func::COND_AND_FUNC)
+      return parts;
+    List_iterator<Item> li(*((Item_cond*) cond)->argument_list());
+    Item *item;
+    while ((item= li++))
+      parts= find_hash_keys(tab, item, fields, args, parts);
+    return parts;
+  }
+
+  if (cond->type() != Item::FUNC_ITEM)
+    return parts;
+
+  Item_func *func= (Item_func*) cond;
+  if (func->functype() == Item_func::TRIG_COND_FUNC)
+  {
+    if (tab->first_inner &&
+        ((Item_func_trig_cond*) func)->get_trig_var() ==
+        &tab->first_inner->not_null_compl)
+      return find_hash_keys(tab, func->arguments()[0], fields, args, parts);
+    return parts;
+  }
+
+  if (func->functype() != Item_func::EQ_FUNC)
+    return parts;
+
+  Item **items= func->arguments();
+  if (items[0]->type() != Item::FIELD_ITEM ||
+      items[1]->type() != Item::FIELD_ITEM)
+    return parts;
+
+  for (uint i= 0; i < 2; i++)
+  {
+    Item_field *field= (Item_field*) items[i];
+    Item_field *arg= (Item_field*) items[1 - i];
+    if (is_hash_key(tab, field, arg))
+    {
+      fields[parts]= field->field;
+      args[parts]= arg->field;
+      return parts + 1;
+    }
+  }
+  return parts;
+}
+
+
+/*
+  Find the equalities the records joined with a table can be hashed by
+
+  SYNOPSIS
+    find_keys()
+      tab      the joined table
+      fields   OUT: the columns of tab compared in the equalities
+      args     OUT: the columns of the previous tables they are compared with
+
+  DESCRIPTION
+    The function looks for equalities between columns of tab and columns
+    of the previous tables in the condition attached to tab. The arrays
+    fields and args must have room for MAX_REF_PARTS elements.
+
+  RETURN
+    the number of equalities found, 0 if a hash join cannot be used
+*/
+
+uint JOIN_CACHE_HASH::find_keys(JOIN_TAB *tab, Field **fields, Field **args)
+{
+  if (!tab->select || !tab->select->cond)
+    return 0;
+  return find_hash_keys(tab, tab->select->cond, fields, args, 0);
+}
+
+
+/*
+  Check whether find_keys() will find an equality for a table
+
+  SYNOPSIS
+    keys_possible()
+      join             the join being planned
+      tab              the table to be joined
+      remaining_tables the tables that are not in the partial plan yet
+
+  DESCRIPTION
+    The function is called by the planner before any condition is attached
+    to tab. The equalities of the attached condition are then built from
+    the multiple equalities of the WHERE condition, or of the ON condition
+    for the inner tables of outer joins, see substitute_for_best_equal_field().
+    Every column of tab in a multiple equality without a constant is
+    compared there with the column of the first table in the join order.
+    The partial plan does not give that order yet, so the function requires
+    the test of find_keys() to pass for the columns of all tables of the
+    partial plan.
+
+  RETURN
+    TRUE    if a hash join can be used for tab after the partial plan
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_HASH::keys_possible(const JOIN *join, const JOIN_TAB *tab,
+                                    table_map remaining_tables)
+{
+  COND_EQUAL *cond_equal= (tab->on_expr_ref && *tab->on_expr_ref) ?
+                          tab->cond_equal : join->cond_equal;
+  if (!cond_equal)
+    return FALSE;
+
+  List_iterator_fast<Item_equal> it(cond_equal->current_level);
+  Item_equal *item_equal;
+  while ((item_equal= it++))
+  {
+    if (item_equal->get_const())
+      continue;
+
+    Item_equal_iterator fields(*item_equal);
+    Item_field *item;
+    Item_field *field= NULL;
+    while ((item= fields++) && !field)
+    {
+      if (item->field->table == tab->table)
+        field= item;
+    }
+    if (!field)
+      continue;
+
+    bool found= FALSE, hashable= TRUE;
+    fields.rewind();
+    while ((item= fields++) && hashable)
+    {
+      const table_map map= item->field->table->map;
+      if (map == tab->table->map || (map & remaining_tables))
+        continue;
+      found= TRUE;
+      hashable= is_hash_key(tab, field, item);
+    }
+    if (found && hashable)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
+/*
+  Initialize a hash join cache
+
+  SYNOPSIS
+    init()
+
+  DESCRIPTION
+    The function initializes the cache structure. It supposed to be called
+    right after a constructor for the JOIN_CACHE_HASH.
+    Additionally to what JOIN_CACHE_BNL::init() does the function finds
+    the equalities the records are hashed by, estimates the number of hash
+    table entries and initializes the hash table at the end of the buffer.
+
+  RETURN
+    0   initialization with buffer allocations has been succeeded
+    1   otherwise
+*/
+
+int JOIN_CACHE_HASH::init()
+{
+  Field *fields[MAX_REF_PARTS];
+  Field *args[MAX_REF_PARTS];
+  DBUG_ENTER("JOIN_CACHE_HASH::init");
+
+  hash_table= NULL;
+  if (!(key_parts= find_keys(join_tab, fields, args)))
+    DBUG_RETURN(1);
+
+  const size_t keys_size= key_parts * sizeof(Field*);
+  if (!(key_fields= (Field**) sql_memdup(fields, keys_size)) ||
+      !(key_args= (Field**) sql_memdup(args, keys_size)))
+    DBUG_RETURN(1);
+
+  if (JOIN_CACHE_BNL::init())
+    DBUG_RETURN(1);
+
+  /* Take into account the hash value and the reference to the next record */
+  pack_length+= HASH_VALUE_LENGTH + get_size_of_rec_offset();
+  pack_length_with_blob_ptrs+= HASH_VALUE_LENGTH + get_size_of_rec_offset();
+
+  uint n= buff_size / (pack_length + get_size_of_rec_offset());
+  hash_entries= max(1U, (uint) (n / 0.7));
+  hash_table= buff + (buff_size - hash_entries * get_size_of_rec_offset());
+
+  /* The buffer must have room for the hash table and at least one record */
+  if (rem_space() < pack_length_with_blob_ptrs)
+    DBUG_RETURN(1);
+
+  reset_cache(true);
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Reset the JOIN_CACHE_HASH buffer for reading/writing
+
+  SYNOPSIS
+    reset_cache()
+      for_writing  if it's TRUE the function reset the buffer for writing
+
+  DESCRIPTION
+    Additionally to what the default implementation does this function
+    empties the hash table at the end of the buffer when the buffer is
+    reset for writing.
+
+  RETURN
+    none
+*/
+
+void JOIN_CACHE_HASH::reset_cache(bool for_writing)
+{
+  this->JOIN_CACHE::reset_cache(for_writing);
+  if (for_writing && hash_table)
+    memset(hash_table, 0, hash_entries * get_size_of_rec_offset());
+}
+
+
+/*
+  Hash the values of the key fields
+
+  SYNOPSIS
+    hash_key()
+      fields   the fields whose values are hashed
+      nr       OUT: the hash value
+
+  DESCRIPTION
+    The function hashes the current values of key_parts fields so that
+    values that the equality of the join condition finds equal get equal
+    hashes: strings are hashed by their collation, temporal values by
+    their packed representation and other values by the numbers they
+    are compared as.
+
+  RETURN
+    TRUE    if the value of one of the fields is NULL
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_HASH::hash_key(Field **fields, ulong *nr)
+{
+  ulong nr2= 4;
+  *nr= 1;
+  for (Field **field_ptr= fields; field_ptr < fields + key_parts; field_ptr++)
+  {
+    Field *field= *field_ptr;
+    uchar value[8];
+
+    if (field->is_null())
+      return TRUE;
+
+    if (field->is_temporal())
+      int8store(value, field->val_temporal_by_field_type());
+    else
+    {
+      switch (field->result_type()) {
+      case STRING_RESULT:
+      {
+        char buff[MAX_FIELD_WIDTH];
+        String tmp(buff, sizeof(buff), field->charset());
+        String *str= field->val_str(&tmp);
+        const CHARSET_INFO *cs= field->charset();
+        cs->coll->hash_sort(cs, (const uchar*) str->ptr(), str->length(),
+                            nr, &nr2);
+        continue;
+      }
+      case REAL_RESULT:
+      {
+        double real= field->val_real();
+        /* 0.0 and -0.0 are equal */
+        if (real == 0.0)
+          real= 0.0;
+        float8store(value, real);
+        break;
+      }
+      case DECIMAL_RESULT:
+      {
+        /* Equal decimals of different scales convert to the same double */
+        my_decimal decimal;
+        double real;
+        my_decimal2double(E_DEC_FATAL_ERROR, field->val_decimal(&decimal),
+                          &real);
+        if (real == 0.0)
+          real= 0.0;
+        float8store(value, real);
+        break;
+      }
+      default:
+        int8store(value, field->val_int());
+        break;
+      }
+    }
+    my_charset_bin.coll->hash_sort(&my_charset_bin, value, sizeof(value),
+                                   nr, &nr2);
+  }
+  return FALSE;
+}
+
+
+/*
+  Add a record into the JOIN_CACHE_HASH buffer
+
+  SYNOPSIS
+    put_record_in_cache()
+
+  DESCRIPTION
+    This implementation of the virtual function put_record writes the next
+    matching record into the join buffer of the JOIN_CACHE_HASH class.
+    Additionally to what the default implementation does this function
+    hashes the key of the record, that is still in the record buffers,
+    and adds the record to the head of the chain of its hash entry.
+
+  RETURN
+    TRUE    if it has been decided that it should be the last record
+            in the join buffer,
+    FALSE   otherwise
+*/
+
+bool JOIN_CACHE_HASH::put_record_in_cache()
+{
+  ulong nr;
+  uchar *link_ptr= pos + HASH_VALUE_LENGTH;
+  pos= link_ptr + get_size_of_rec_offset();
+
+  // Write record to join buffer
+  bool is_full= JOIN_CACHE::put_record_in_cache();
+
+  if (hash_key(key_args, &nr))
+  {
+    /*
+      A NULL key cannot give a match, so the record is not linked into
+      any chain. It stays in the buffer for null complementing.
+    */
+    int4store(link_ptr - HASH_VALUE_LENGTH, 0);
+    store_offset(get_size_of_rec_offset(), link_ptr, 0);
+    return is_full;
+  }
+
+  uchar *entry= get_hash_entry(nr);
+  int4store(link_ptr - HASH_VALUE_LENGTH, (uint32) nr);
+  memcpy(link_ptr, entry, get_size_of_rec_offset());
+  store_offset(get_size_of_rec_offset(), entry, (ulong) (link_ptr - buff));
+  return is_full;
+}
+
+
+/*
+  Read the next record from the JOIN_CACHE_HASH buffer
+
+  SYNOPSIS
+    get_record()
+
+  DESCRIPTION
+    Additionally to what the default implementation of the virtual
+    function get_record does this implementation skips the hash value
+    and the link to the next record in the chain.
+
+  RETURN
+    TRUE  - there are no more records to read from the join buffer
+    FALSE - otherwise
+*/
+
+bool JOIN_CACHE_HASH::get_record()
+{
+  pos+= HASH_VALUE_LENGTH + get_size_of_rec_offset();
+  return this->JOIN_CACHE::get_record();
+}
+
+
+/*
+  Skip record from the JOIN_CACHE_HASH join buffer if its match flag is on
+
+  SYNOPSIS
+    skip_record_if_match()
+
+  DESCRIPTION
+    This implementation of the virtual function skip_record_if_match does
+    the same as the default implementation does, but it takes into account
+    the hash value and the link to the next record in the chain.
+
+  RETURN
+    TRUE  - the match flag is on and the record has been skipped
+    FALSE - the match flag is off
+*/
+
+bool JOIN_CACHE_HASH::skip_record_if_match()
+{
+  uchar *save_pos= pos;
+  pos+= HASH_VALUE_LENGTH + get_size_of_rec_offset();
+  if (!this->JOIN_CACHE::skip_record_if_match())
+  {
+    pos= save_pos;
+    return FALSE;
+  }
+  return TRUE;
+}
+
+
+/*
+  Extend the records of the hash chain matching the current row of join_tab
+
+  SYNOPSIS
+    join_buffered_records()
+      skip_last    do not look for matches for the last partial join record
+
+  DESCRIPTION
+    The function hashes the key columns of the row of join_tab that has
+    been just read and generates all full extensions only for the records
+    from the chain of this hash value whose own hash is the same.
+    The remaining records of the buffer cannot match the row since the
+    attached condition requires the keys to be equal.
+
+  RETURN
+    return one of enum_nested_loop_state.
+*/
+
+enum_nested_loop_state JOIN_CACHE_HASH::join_buffered_records(bool skip_last)
+{
+  ulong nr;
+  enum_nested_loop_state rc;
+  const uint ref_size= get_size_of_rec_offset();
+
+  /* A NULL key of the row cannot match any record */
+  if (hash_key(key_fields, &nr))
+    return NESTED_LOOP_OK;
+
+  for (ulong ref= get_offset(ref_size, get_hash_entry(nr));
+       ref;
+       ref= get_offset(ref_size, buff + ref))
+  {
+    uchar *link_ptr= buff + ref;
+    uchar *rec_ptr= get_rec_by_link(link_ptr);
+
+    if (uint4korr(link_ptr - HASH_VALUE_LENGTH) != (uint32) nr ||
+        (skip_last && rec_ptr == last_rec_pos))
+      continue;
+
+    /* Skip the record if only its first match is needed and it is found */
+    if (check_only_first_match && get_match_flag_by_pos(rec_ptr))
+      continue;
+
+    get_record_by_pos(rec_ptr);
+    rc= generate_full_extensions(rec_ptr);
+    if (rc != NESTED_LOOP_OK)
+      return rc;
+  }
+  return NESTED_LOOP_OK;
+}
+
+
 /****************************************************************************
  * Join cache module end
  ****************************************************************************/
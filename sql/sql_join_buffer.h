@@ -512,11 +512,12 @@ public:
   }
 
   /** Bits describing cache's type @sa setup_join_buffering() */
-  enum {ALG_NONE= 0, ALG_BNL= 1, ALG_BKA= 2, ALG_BKA_UNIQUE= 4};
+  enum {ALG_NONE= 0, ALG_BNL= 1, ALG_BKA= 2, ALG_BKA_UNIQUE= 4, ALG_HASH= 8};
 
   friend class JOIN_CACHE_BNL;
   friend class JOIN_CACHE_BKA;
   friend class JOIN_CACHE_BKA_UNIQUE;
+  friend class JOIN_CACHE_HASH;
 };
 
 class JOIN_CACHE_BNL :public JOIN_CACHE
@@ -527,6 +528,9 @@ protected:
   /* Using BNL find matches from the next table for records from join buffer */
   enum_nested_loop_state join_matching_records(bool skip_last);
 
+  /* Extend the records from join buffer by the current row of join_tab */
+  virtual enum_nested_loop_state join_buffered_records(bool skip_last);
+
 public:
   JOIN_CACHE_BNL(JOIN *j, JOIN_TAB *tab, JOIN_CACHE *prev)
     : JOIN_CACHE(j, tab, prev)
@@ -890,4 +894,125 @@ public:
 };
 
 
+/*
+  The class JOIN_CACHE_HASH supports the variant of the BNL join algorithm
+  for equi-joins over columns that have no usable index. While records are
+  put into the join buffer they are linked into chains of a hash table
+  keyed by the values of the columns of the previous tables that the
+  condition attached to join_tab compares with columns of join_tab. Every
+  row read from join_tab then only probes the chain for the hash of its
+  own key columns instead of being checked against all buffered records.
+  The whole attached condition is still checked for the records found in
+  the chain, so hash collisions are harmless.
+
+  Every record in the buffer is prepended with the hash value of its key
+  and a reference to the next record in its chain. The array of the hash
+  entries with the heads of the chains is placed at the very end of the
+  join buffer:
+
+  buff
+  V
+  +----------------------------------------------------------------------+
+  | |hash|[*]record_1 |hash|[*]record_2| ...            |[*]|[*]| ... |[*]|
+  +----------------------------------------------------------------------+
+                                                        ^
+                                                        hash_table
+
+  Records whose key has a NULL value cannot match and are not linked to
+  any chain, but they stay in the buffer for null complementing.
+  When the join buffer is full the records are joined and the buffer is
+  refilled as with BNL, so join_buffer_size limits the memory used.
+*/
+
+class JOIN_CACHE_HASH :public JOIN_CACHE_BNL
+{
+
+private:
+
+  /* Size of the hash value stored in front of each record */
+  static const uint HASH_VALUE_LENGTH= 4;
+
+  /* Number of the equalities the records are hashed by */
+  uint key_parts;
+  /* Columns of join_tab compared in the equalities */
+  Field **key_fields;
+  /* Columns of the previous tables compared in the equalities */
+  Field **key_args;
+
+  /* The beginning of the hash table in the join buffer */
+  uchar *hash_table;
+  /* Number of hash entries in the hash table */
+  uint hash_entries;
+
+  /* Hash the values of the fields, return TRUE if one of them is NULL */
+  bool hash_key(Field **fields, ulong *nr);
+
+  /* Get the position of the hash entry for the hash value nr */
+  uchar *get_hash_entry(ulong nr)
+  {
+    return hash_table + (nr % hash_entries) * get_size_of_rec_offset();
+  }
+
+  /* Get the position of the record fields for a chain reference */
+  uchar *get_rec_by_link(uchar *link_ptr)
+  {
+    return link_ptr + get_size_of_rec_offset() +
+           (with_length ? get_size_of_rec_length() : 0) +
+           (prev_cache ? prev_cache->get_size_of_rec_offset() : 0);
+  }
+
+protected:
+
+  /*
+    Calculate how much space in the buffer would not be occupied by
+    records and the hash table.
+  */
+  ulong rem_space()
+  {
+    uchar *occupied= end_pos + aux_buff_size;
+    return hash_table > occupied ? hash_table - occupied : 0UL;
+  }
+
+  /* Skip record from JOIN_CACHE_HASH buffer if its match flag is on */
+  bool skip_record_if_match();
+
+  /* Probe the hash table with the key of the current row of join_tab */
+  enum_nested_loop_state join_buffered_records(bool skip_last);
+
+  /* Add a record into the JOIN_CACHE_HASH buffer */
+  bool put_record_in_cache();
+
+public:
+
+  JOIN_CACHE_HASH(JOIN *j, JOIN_TAB *tab, JOIN_CACHE *prev)
+    : JOIN_CACHE_BNL(j, tab, prev), hash_table(NULL)
+  {}
+
+  /* Initialize the hash join cache */
+  int init();
+
+  /* Reset the JOIN_CACHE_HASH buffer for reading/writing */
+  void reset_cache(bool for_writing);
+
+  /* Read the next record from the JOIN_CACHE_HASH buffer */
+  bool get_record();
+
+  /*
+    Find the equalities of the condition attached to tab that the records
+    joined with tab can be hashed by.
+  */
+  static uint find_keys(JOIN_TAB *tab, Field **fields, Field **args);
+
+  /*
+    Check whether find_keys() will find an equality for tab when tab is
+    joined after the tables not in remaining_tables. Used by the planner.
+  */
+  static bool keys_possible(const JOIN *join, const JOIN_TAB *tab,
+                            table_map remaining_tables);
+
+  /* Check whether equal values of the fields always get equal hashes */
+  static bool hashable_fields(const Field *field, const Field *arg);
+};
+
+
 #endif /* SQL_JOIN_CACHE_INCLUDED */
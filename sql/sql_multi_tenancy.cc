@@ -302,6 +302,41 @@ int multi_tenancy_exit_query(THD *thd)
 }
 
 
+/**
+ * Take running slots for the worker threads of a query
+ *
+ * Queries admitted by admission control get up to wanted slots of their
+ * entity that are free, without waiting for any. Other queries are not
+ * limited and get all of them.
+ *
+ * @param thd THD structure
+ * @param wanted Number of worker threads the query would like to run
+ *
+ * @return number of workers the query may run, to be released with
+ *         multi_tenancy_release_workers()
+ */
+ulong multi_tenancy_acquire_workers(THD *thd, ulong wanted)
+{
+  if (!thd->is_in_ac)
+    return wanted;
+  return db_ac->acquire_workers(thd, wanted);
+}
+
+
+/**
+ * Release the running slots taken by multi_tenancy_acquire_workers()
+ *
+ * The query may have left admission control in between, e.g. to yield.
+ *
+ * @param thd THD structure
+ */
+void multi_tenancy_release_workers(THD *thd)
+{
+  if (thd->ac_node && thd->ac_node->workers)
+    db_ac->release_workers(thd);
+}
+
+
 /*
  * Get the resource counter of database or user from multi-tenancy plugin
  *
@@ -493,6 +528,56 @@ void multi_tenancy_show_resource_counters(
 
 AC *db_ac; // admission control object
 
+// Virtual time charged to a queue of weight 1 for admitting a query.
+static const ulonglong AC_WFQ_SCALE = 1000000;
+// How often the running limit of an entity is tuned to the latency
+// target, and how many queries it takes at least to do it.
+static const ulonglong AC_TUNE_WINDOW_US = 1000000;
+static const ulonglong AC_TUNE_MIN_SAMPLES = 100;
+
+/*
+ * @param us duration in microseconds
+ *
+ * @return the bucket counting us.
+ */
+uint Ac_histogram::bucket(ulonglong us) {
+  uint i = 0;
+  for (ulonglong high = AC_HISTOGRAM_BASE_US;
+       us >= high && i + 1 < AC_HISTOGRAM_BUCKETS; high <<= 1)
+    i++;
+  return i;
+}
+
+ulonglong Ac_histogram::count() const {
+  ulonglong res = 0;
+  for (uint i = 0; i < AC_HISTOGRAM_BUCKETS; i++)
+    res += get(i);
+  return res;
+}
+
+/*
+ * @param q quantile between 0 and 1
+ *
+ * @return the duration below which q of the counted durations fall,
+ *         interpolated linearly within its bucket.
+ */
+ulonglong Ac_histogram::quantile(double q) const {
+  double rank = q * count();
+  ulonglong below = 0;
+  for (uint i = 0; i < AC_HISTOGRAM_BUCKETS; i++) {
+    ulonglong n = get(i);
+    if (n && below + n >= rank) {
+      if (i + 1 == AC_HISTOGRAM_BUCKETS)
+        return bucket_low(i);
+      double fraction = (rank - below) / n;
+      return bucket_low(i) + (ulonglong)
+        (fraction * (bucket_high(i) - bucket_low(i)));
+    }
+    below += n;
+  }
+  return 0;
+}
+
 /*
  * A wrapper around std::stoul that catches any exceptions to return an error
  * code instead. On success, val is populated with the output.
@@ -601,9 +686,11 @@ void AC::close_connection(THD *thd) {
  *
  * Applies admission control checks for the entity. Outline of
  * the steps in this function:
- * 1. Error out if we crossed the max waiting limit.
- * 2. Put the thd in a queue.
- * 3. If we crossed the max running limit then wait for signal from threads
+ * 1. If nobody is waiting and we are below the running limit, take a slot
+ *    without locking anything.
+ * 2. Error out if we crossed the max waiting limit.
+ * 3. Put the thd in a queue.
+ * 4. If we crossed the max running limit then wait for signal from threads
  *    that completed their query execution.
  *
  * Note current implementation assumes the admission control entity is
@@ -620,89 +707,99 @@ Ac_result AC::admission_control_enter(THD *thd,
   Ac_result res = Ac_result::AC_ADMITTED;
   const char* prev_proc_info = thd->proc_info;
   THD_STAGE_INFO(thd, stage_admission_control_enter);
-  // Unlock this before waiting.
-  mysql_rwlock_rdlock(&LOCK_ac);
-  if (max_running_queries) {
-    auto ac_info = thd->ac_node->ac_info;
-    thd->ac_node->queue = get_queue(thd);
-    mysql_mutex_lock(&ac_info->lock);
-
-    if (ac_info->running_queries < max_running_queries) {
-      // We are below the max running limit.
-      ++ac_info->running_queries;
-      ++ac_info->queues[thd->ac_node->queue].running_queries;
-      DBUG_ASSERT(!thd->ac_node->running);
-      thd->ac_node->running = true;
-    }
-    else if (max_waiting_queries &&
-             ac_info->waiting_queries >= max_waiting_queries) {
-      ++ac_info->queues[thd->ac_node->queue].aborted_queries;
-      ++ac_info->aborted_queries;
-      ++total_aborted_queries;
-      // We reached max waiting limit. Error out
-      res = Ac_result::AC_ABORTED;
-    }
-    else {
-      bool timeout;
-      enqueue(thd, ac_info, mode);
-      /**
-        Inserting or deleting in std::map will not invalidate existing
-        iterators except of course if the current iterator is erased. If the
-        db corresponding to this iterator is getting dropped, these waiting
-        queries are given signal to abort before the iterator
-        is erased. See AC::remove().
-        So, we don't need LOCK_ac here. The motivation to unlock the read lock
-        is that waiting queries here shouldn't block other operations
-        modifying ac_map or max_running_queries/max_waiting_queries.
-      */
-      while (true) {
-        mysql_rwlock_unlock(&LOCK_ac);
-        timeout = wait_for_signal(thd, thd->ac_node, ac_info, mode);
-        // Retake locks in correct lock order.
-        mysql_rwlock_rdlock(&LOCK_ac);
-        mysql_mutex_lock(&ac_info->lock);
-        // Break out if query has timed out, was killed, or has started running.
-        // KILLs will also signal our condition variable (see THD::enter_cond
-        // for how a cv is installed and THD::awake for how it is signaled).
-        if (timeout || thd->killed || thd->ac_node->running)
-          break;
-      }
-
-      // If a query has been successfully admitted, then it has already
-      // been dequeued by a different thread, with updated counters.
-      //
-      // The only reason it might be still queued is during error conditions.
-      if (thd->ac_node->queued) {
-        DBUG_ASSERT(timeout || thd->killed);
-        dequeue(thd, ac_info);
-      }
+  /**
+    LOCK_ac is not needed here. The limits are atomics, and thd holds a
+    reference to its ac_info, which stays valid even if the entity is
+    removed from ac_map. A removed entity releases its waiting queries
+    first, see AC::remove().
+  */
+  auto ac_info = thd->ac_node->ac_info;
+  ulong limit = get_running_limit(*ac_info);
+  if (limit) {
+    auto &ac_node = thd->ac_node;
+    ac_node->queue = get_queue(thd);
+
+    if (ac_info->waiting_queries == 0 && ac_info->try_acquire(limit)) {
+      // Fast path, we are below the max running limit and nobody waits
+      // ahead of us. A query exiting concurrently may miss our slot check
+      // only if it saw no waiters, and queued queries re-check for free
+      // slots after enqueueing, so no wakeup is lost.
+      ++ac_info->queues[ac_node->queue].running_queries;
+      DBUG_ASSERT(!ac_node->running);
+      ac_node->running = true;
+      ac_info->fast_admissions.inc();
+    } else {
+      mysql_mutex_lock(&ac_info->lock);
+
+      if (max_waiting_queries &&
+          ac_info->waiting_queries >= max_waiting_queries) {
+        ++ac_info->queues[ac_node->queue].aborted_queries;
+        ++ac_info->aborted_queries;
+        ++total_aborted_queries;
+        // We reached max waiting limit. Error out
+        res = Ac_result::AC_ABORTED;
+      } else {
+        bool timeout = false;
+        ulonglong wait_start = my_micro_time();
+        enqueue(thd, ac_info, mode);
+        // Slots released between the fast path check and enqueue() were
+        // not handed to anyone, so admit queries for them now. This may
+        // pick a query from another queue instead of this one.
+        dispatch(ac_info);
+
+        // Break out if query has timed out, was killed, or has started
+        // running. KILLs will also signal our condition variable (see
+        // THD::enter_cond for how a cv is installed and THD::awake for how
+        // it is signaled).
+        while (!ac_node->running && !timeout && !thd->killed) {
+          // Releases ac_info->lock.
+          timeout = wait_for_signal(thd, ac_node, ac_info, mode);
+          mysql_mutex_lock(&ac_info->lock);
+        }
 
-      if (timeout || thd->killed) {
-        // It's possible that we've gotten an error after this thread was
-        // passed admission control. If so, reset the running counters.
-        if (thd->ac_node->running) {
-          DBUG_ASSERT(ac_info->running_queries > 0);
-          --ac_info->running_queries;
-          DBUG_ASSERT(ac_info->queues[thd->ac_node->queue].running_queries > 0);
-          --ac_info->queues[thd->ac_node->queue].running_queries;
-          thd->ac_node->running = false;
+        // If a query has been successfully admitted, then it has already
+        // been dequeued by a different thread, with updated counters.
+        //
+        // The only reason it might be still queued is during error
+        // conditions.
+        if (ac_node->queued) {
+          DBUG_ASSERT(timeout || thd->killed);
+          dequeue(thd, ac_info);
         }
 
-        if (timeout) {
-          ++total_timeout_queries;
-          ++ac_info->queues[thd->ac_node->queue].timeout_queries;
-          ++ac_info->timeout_queries;
-          res = Ac_result::AC_TIMEOUT;
-        } else {
-          res = Ac_result::AC_KILLED;
+        if (timeout || thd->killed) {
+          // It's possible that we've gotten an error after this thread was
+          // passed admission control. If so, give the slot to the next
+          // waiting query.
+          if (ac_node->running) {
+            DBUG_ASSERT(ac_info->queues[ac_node->queue].running_queries > 0);
+            --ac_info->queues[ac_node->queue].running_queries;
+            ac_node->running = false;
+            DBUG_ASSERT(ac_info->running_queries > 0);
+            --ac_info->running_queries;
+            dispatch(ac_info);
+          }
+
+          if (timeout) {
+            ++total_timeout_queries;
+            ++ac_info->queues[ac_node->queue].timeout_queries;
+            ++ac_info->timeout_queries;
+            res = Ac_result::AC_TIMEOUT;
+          } else {
+            res = Ac_result::AC_KILLED;
+          }
         }
+
+        ac_info->wait_histogram.add(my_micro_time() - wait_start);
       }
+
+      mysql_mutex_unlock(&ac_info->lock);
     }
 
-    mysql_mutex_unlock(&ac_info->lock);
+    if (ac_node->running)
+      ac_node->admit_time = latency_target ? my_micro_time() : 0;
   }
 
-  mysql_rwlock_unlock(&LOCK_ac);
   thd->proc_info = prev_proc_info;
   return res;
 }
@@ -754,10 +851,70 @@ bool AC::wait_for_signal(THD *thd, std::shared_ptr<st_ac_node> &ac_node,
   return res == ETIMEDOUT;
 }
 
+/**
+  @param thd THD structure
+  @param wanted Number of slots wanted
+
+  Takes up to wanted free running slots of the entity of thd for the
+  worker threads of its query. They are charged to the queue of the query
+  and, unlike admissions, never wait: a query that gets none runs on its
+  own thread.
+
+  @return number of slots taken
+*/
+ulong AC::acquire_workers(THD *thd, ulong wanted) {
+  auto &ac_node = thd->ac_node;
+  if (!ac_node->running)
+    return 0;
+
+  auto &ac_info = ac_node->ac_info;
+  // Waiting queries go first.
+  if (ac_info->waiting_queries > 0)
+    return 0;
+
+  ulong limit = get_running_limit(*ac_info);
+  ulong taken = 0;
+  while (taken < wanted && ac_info->try_acquire(limit))
+    ++taken;
+  if (taken) {
+    DBUG_ASSERT(!ac_node->workers);
+    ac_node->workers = taken;
+    ac_node->workers_queue = ac_node->queue;
+    ac_info->queues[ac_node->queue].running_queries += taken;
+  }
+  return taken;
+}
+
+/**
+  @param thd THD structure
+
+  Releases the worker slots of thd, and hands them to waiting queries if
+  there are some.
+*/
+void AC::release_workers(THD *thd) {
+  auto &ac_node = thd->ac_node;
+  auto ac_info = ac_node->ac_info;
+  ulong count = ac_node->workers;
+  auto &queue = ac_info->queues[ac_node->workers_queue];
+
+  ac_node->workers = 0;
+  DBUG_ASSERT(queue.running_queries >= count);
+  queue.running_queries -= count;
+  DBUG_ASSERT(ac_info->running_queries >= count);
+  ac_info->running_queries -= count;
+
+  if (ac_info->waiting_queries > 0) {
+    mysql_mutex_lock(&ac_info->lock);
+    dispatch(ac_info);
+    mysql_mutex_unlock(&ac_info->lock);
+  }
+}
+
 /**
   @param thd THD structure
 
-  Signals one waiting thread. Pops out the first THD in the queue.
+  Releases the running slot of thd, and hands it to a waiting query if
+  there is one.
 */
 void AC::admission_control_exit(THD* thd) {
   // AC::admission_control_enter admits query when max_running_queries is 0.
@@ -768,64 +925,125 @@ void AC::admission_control_exit(THD* thd) {
   const char* prev_proc_info = thd->proc_info;
   THD_STAGE_INFO(thd, stage_admission_control_exit);
 
-  auto ac_info = thd->ac_node->ac_info;
-  mysql_rwlock_rdlock(&LOCK_ac);
-  mysql_mutex_lock(&ac_info->lock);
+  auto &ac_node = thd->ac_node;
+  auto ac_info = ac_node->ac_info;
+  bool tune = false;
+
+  if (latency_target && ac_node->admit_time) {
+    ulonglong now = my_micro_time();
+    ac_info->run_histogram.add(now - ac_node->admit_time);
+    // One of the exiting queries retunes the limit once per window.
+    ulonglong start = ac_info->window_start;
+    tune = now - start >= AC_TUNE_WINDOW_US &&
+           ac_info->window_start.compare_exchange_strong(start, now);
+  }
+  ac_node->admit_time = 0;
 
+  DBUG_ASSERT(ac_info->queues[ac_node->queue].running_queries > 0);
+  --ac_info->queues[ac_node->queue].running_queries;
+  ac_node->running = false;
   DBUG_ASSERT(ac_info->running_queries > 0);
   --ac_info->running_queries;
-  DBUG_ASSERT(ac_info->queues[thd->ac_node->queue].running_queries > 0);
-  --ac_info->queues[thd->ac_node->queue].running_queries;
-  thd->ac_node->running = false;
-
-  // Assert that max_running_queries == 0 implies no waiting queries.
-  DBUG_ASSERT(max_running_queries != 0 || ac_info->waiting_queries == 0);
-
-  // We determine here which queue to pick from. For every queue, we
-  // calculate a score based on the number of running queries, and its
-  // weight. Inituitively, the weight determines how much of the running
-  // pool a queue is allowed to occupy. For example, if queue A has weight 3
-  // and queue B has weight 7, the we expect 30% of the pool to have queries
-  // running from A.
-  //
-  // We calculate a score for all queues that have waiting queries, and pick
-  // the queue with the minimum score. In case of ties, we arbitrarily pick
-  // the first encountered queue.
-  if (ac_info->waiting_queries > 0 && ac_info->running_queries < max_running_queries) {
-    double min_score = std::numeric_limits<double>::max();
-    ulong min_queue = 0;
-#ifndef DBUG_OFF
-    ulong running_queries_sum = 0;
-    ulong waiting_queries_sum = 0;
-#endif
 
-    for (ulong i = 0; i < MAX_AC_QUEUES; i++) {
-      const auto& queue = ac_info->queues[i];
-#ifndef DBUG_OFF
-      running_queries_sum += queue.running_queries;
-      waiting_queries_sum += queue.waiting_queries();
-#endif
-      // Skip queues that don't have waiting queries.
-      if (queue.waiting_queries() == 0) continue;
-
-      double score = queue.running_queries / (weights[i] ? weights[i] : 1);
-
-      if (score < min_score) {
-        min_queue = i;
-        min_score = score;
-      }
+  // Nobody can be admitted if nobody waits, and a query that enqueues
+  // itself after this check sees the slot released above, so the lock is
+  // only needed to hand the slot over.
+  if (tune || ac_info->waiting_queries > 0) {
+    mysql_mutex_lock(&ac_info->lock);
+    if (tune)
+      tune_limit(ac_info.get());
+    dispatch(ac_info);
+    mysql_mutex_unlock(&ac_info->lock);
+  }
+
+  thd->proc_info = prev_proc_info;
+}
+
+/*
+ * @param ac_info AC info
+ *
+ * Weighted fair queuing across the queues of an entity. Every queue has a
+ * virtual finish time which advances by 1/weight for each query admitted
+ * from it, and the waiting queue that would finish first goes next. A
+ * queue that was idle restarts from the entity's virtual clock, so it
+ * cannot bank credit while it had nothing to run. For example, if queue A
+ * has weight 3 and queue B has weight 7, then while both have waiting
+ * queries 30% of the admissions go to A. Ties go to the lower queue.
+ *
+ * @return the queue to admit from, it must have waiting queries.
+ */
+ulong AC::pick_queue(const Ac_info &ac_info) const {
+  ulonglong min_finish = ULONGLONG_MAX;
+  ulong min_queue = 0;
+
+  for (ulong i = 0; i < MAX_AC_QUEUES; i++) {
+    const auto &queue = ac_info.queues[i];
+    // Skip queues that don't have waiting queries.
+    if (queue.waiting_queries() == 0) continue;
+
+    ulong weight = weights[i];
+    ulonglong finish = std::max(queue.vtime, ac_info.vclock) +
+                       AC_WFQ_SCALE / (weight ? weight : 1);
+    if (finish < min_finish) {
+      min_queue = i;
+      min_finish = finish;
     }
+  }
+
+  DBUG_ASSERT(min_finish != ULONGLONG_MAX);
+  return min_queue;
+}
+
+/*
+ * @param ac_info AC info
+ *
+ * Admits waiting queries in weighted fair order while the entity is below
+ * its running limit. A limit of 0 admits all of them.
+ */
+void AC::dispatch(const std::shared_ptr<Ac_info> &ac_info) {
+  mysql_mutex_assert_owner(&ac_info->lock);
 
-    DBUG_ASSERT(ac_info->waiting_queries == waiting_queries_sum);
-    DBUG_ASSERT(ac_info->running_queries == running_queries_sum);
+  ulong limit = get_running_limit(*ac_info);
+  while (ac_info->waiting_queries > 0) {
+    if (!limit)
+      ++ac_info->running_queries;
+    else if (!ac_info->try_acquire(limit))
+      break;
 
-    auto& candidate = ac_info->queues[min_queue].queue.front();
+    auto &candidate = ac_info->queues[pick_queue(*ac_info)].queue.front();
     dequeue_and_run(candidate->thd, ac_info);
   }
+}
 
-  mysql_mutex_unlock(&ac_info->lock);
-  mysql_rwlock_unlock(&LOCK_ac);
-  thd->proc_info = prev_proc_info;
+/*
+ * @param ac_info AC info
+ *
+ * Adjusts the running limit of the entity from the p99 run time of the
+ * queries that left admission control during the last window. The limit
+ * is cut by a quarter while the p99 is above the latency target, and
+ * raised again in small steps while the p99 is below it and queries are
+ * waiting. It stays between 1 and max_running_queries.
+ */
+void AC::tune_limit(Ac_info *ac_info) {
+  mysql_mutex_assert_owner(&ac_info->lock);
+
+  auto &histogram = ac_info->run_histogram;
+  ulong max = max_running_queries;
+  ulonglong target = latency_target;
+  // Keep collecting if the window had too few queries to tell.
+  if (!max || !target || histogram.count() < AC_TUNE_MIN_SAMPLES)
+    return;
+
+  ulonglong p99 = histogram.quantile(0.99);
+  histogram.reset();
+
+  ulong limit = get_running_limit(*ac_info);
+  if (p99 > target) {
+    limit -= std::min(limit - 1, std::max(1UL, limit / 4));
+  } else if (ac_info->waiting_queries > 0) {
+    limit = std::min(max, limit + std::max(1UL, limit / 8));
+  }
+  ac_info->tuned_limit = limit;
 }
 
 /*
@@ -872,15 +1090,22 @@ void AC::dequeue(THD *thd, std::shared_ptr<Ac_info> ac_info) {
  * @param ac_info AC info
  *
  * Dequeues thd from its queue. Sets its state to running, and signals
- * that thread to start running.
+ * that thread to start running. The caller has already accounted for it
+ * in ac_info->running_queries.
  */
 void AC::dequeue_and_run(THD *thd, std::shared_ptr<Ac_info> ac_info) {
   mysql_mutex_assert_owner(&ac_info->lock);
 
   dequeue(thd, ac_info);
 
-  ++ac_info->running_queries;
-  ++ac_info->queues[thd->ac_node->queue].running_queries;
+  // Charge the queue for weighted fair queuing, see AC::pick_queue().
+  auto &queue = ac_info->queues[thd->ac_node->queue];
+  ulong weight = weights[thd->ac_node->queue];
+  ulonglong start = std::max(queue.vtime, ac_info->vclock);
+  ac_info->vclock = start;
+  queue.vtime = start + AC_WFQ_SCALE / (weight ? weight : 1);
+
+  ++queue.running_queries;
   DBUG_ASSERT(!thd->ac_node->running);
   thd->ac_node->running = true;
 
@@ -897,7 +1122,9 @@ void AC::dequeue_and_run(THD *thd, std::shared_ptr<Ac_info> ac_info) {
  */
 int AC::update_queue_weights(char *s) {
   auto v = split_into_vector(s ? s : "", ',');
-  auto tmp = weights;
+  std::array<ulong, MAX_AC_QUEUES> tmp;
+  for (ulong i = 0; i < MAX_AC_QUEUES; i++)
+    tmp[i] = weights[i];
 
   if (v.size() > MAX_AC_QUEUES) {
     return -1;
@@ -912,7 +1139,8 @@ int AC::update_queue_weights(char *s) {
     }
   }
   mysql_rwlock_wrlock(&LOCK_ac);
-  weights = tmp;
+  for (ulong i = 0; i < MAX_AC_QUEUES; i++)
+    weights[i] = tmp[i];
   mysql_rwlock_unlock(&LOCK_ac);
 
   return 0;
@@ -933,6 +1161,7 @@ void AC::remove(const char* entity) {
     mysql_mutex_lock(&ac_info->lock);
     for (auto &q : ac_info->queues) {
       while (q.waiting_queries() > 0) {
+        ++ac_info->running_queries;
         dequeue_and_run(q.queue.front()->thd, ac_info);
       }
     }
@@ -1051,7 +1280,7 @@ int fill_ac_queue(THD *thd, TABLE_LIST *tables, Item *) {
       const auto& q = ac_info->queues[i];
 
       auto waiting = q.waiting_queries();
-      auto running = q.running_queries;
+      ulong running = q.running_queries;
       auto timeout = q.timeout_queries;
       auto aborted = q.aborted_queries;
       // Skip queues with no waiting/running queries.
@@ -1163,3 +1392,85 @@ int fill_ac_entities(THD *thd, TABLE_LIST *tables, Item *) {
 
   DBUG_RETURN(result);
 }
+
+ST_FIELD_INFO admission_control_wait_histogram_fields_info[]=
+{
+  {"SCHEMA_NAME", NAME_LEN, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE},
+  {"BUCKET_NUMBER", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"BUCKET_WAIT_LOW_US", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"BUCKET_WAIT_HIGH_US", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"COUNT_BUCKET", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"COUNT_BUCKET_AND_LOWER", 21, MYSQL_TYPE_LONGLONG, 0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"BUCKET_QUANTILE", MAX_DOUBLE_STR_LENGTH, MYSQL_TYPE_DOUBLE, 0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE}
+};
+
+/**
+ * @brief Populate admission_control_wait_histogram table.
+ * @param thd THD
+ * @param tables contains the TABLE struct to populate
+ * @retval 0 on success
+ * @retval 1 on failure
+ */
+int fill_ac_wait_histogram(THD *thd, TABLE_LIST *tables, Item *) {
+  DBUG_ENTER("fill_ac_wait_histogram");
+  TABLE* table= tables->table;
+  int result = 0;
+
+  mysql_rwlock_rdlock(&db_ac->LOCK_ac);
+  for (const auto& pair : db_ac->ac_map) {
+    const std::string& db = pair.first;
+    const auto& histogram = pair.second->wait_histogram;
+
+    // Take a snapshot so that the quantiles add up while queries keep
+    // updating the buckets.
+    std::array<ulonglong, AC_HISTOGRAM_BUCKETS> counts;
+    ulonglong total = 0;
+    for (uint i = 0; i < AC_HISTOGRAM_BUCKETS; i++)
+      counts[i] = histogram.get(i);
+    counts[Ac_histogram::bucket(0)] += pair.second->fast_admissions.sum();
+    for (uint i = 0; i < AC_HISTOGRAM_BUCKETS; i++)
+      total += counts[i];
+
+    ulonglong below = 0;
+    for (uint i = 0; i < AC_HISTOGRAM_BUCKETS && !result; i++) {
+      // Skip empty buckets.
+      if (counts[i] == 0)
+        continue;
+      below += counts[i];
+
+      int f = 0;
+
+      // SCHEMA_NAME
+      table->field[f++]->store(db.c_str(), db.size(), system_charset_info);
+
+      // BUCKET_NUMBER
+      table->field[f++]->store((ulonglong) i, TRUE);
+
+      // BUCKET_WAIT_LOW_US
+      table->field[f++]->store(Ac_histogram::bucket_low(i), TRUE);
+
+      // BUCKET_WAIT_HIGH_US
+      table->field[f++]->store(Ac_histogram::bucket_high(i), TRUE);
+
+      // COUNT_BUCKET
+      table->field[f++]->store(counts[i], TRUE);
+
+      // COUNT_BUCKET_AND_LOWER
+      table->field[f++]->store(below, TRUE);
+
+      // BUCKET_QUANTILE
+      table->field[f++]->store((double) below / total);
+
+      if (schema_table_store_record(thd, table))
+        result = 1;
+    }
+
+    if (result)
+      break;
+  }
+
+  mysql_rwlock_unlock(&db_ac->LOCK_ac);
+
+  DBUG_RETURN(result);
+}
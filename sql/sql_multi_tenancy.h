@@ -22,7 +22,9 @@
 
 #include <mysql/plugin_multi_tenancy.h>
 #include "sql_class.h"
+#include "shardedlocks.h"
 
+#include <atomic>
 #include <list>
 
 /*
@@ -59,6 +61,8 @@ extern int multi_tenancy_add_connection(THD *, const char *);
 extern int multi_tenancy_close_connection(THD *);
 extern int multi_tenancy_admit_query(THD *, enum_admission_control_request_mode mode = AC_REQUEST_QUERY);
 extern int multi_tenancy_exit_query(THD *);
+extern ulong multi_tenancy_acquire_workers(THD *, ulong wanted);
+extern void multi_tenancy_release_workers(THD *);
 extern std::string multi_tenancy_get_entity_counter(
     THD *thd, MT_RESOURCE_TYPE type, const MT_RESOURCE_ATTRS *,
     const char *entity_name, int *limit, int *count);
@@ -71,6 +75,9 @@ int fill_ac_queue(THD *thd, TABLE_LIST *tables, Item *cond);
 extern ST_FIELD_INFO admission_control_entities_fields_info[];
 int fill_ac_entities(THD *thd, TABLE_LIST *tables, Item *cond);
 
+extern ST_FIELD_INFO admission_control_wait_histogram_fields_info[];
+int fill_ac_wait_histogram(THD *thd, TABLE_LIST *tables, Item *cond);
+
 /**
   Per-thread information used in admission control.
 */
@@ -82,17 +89,27 @@ struct st_ac_node {
   std::list<std::shared_ptr<st_ac_node>>::iterator pos;
   // The queue that this node belongs to.
   long queue;
+  // Running slots taken for worker threads by AC::acquire_workers(), and
+  // the queue they are charged to.
+  ulong workers;
+  long workers_queue;
   // The THD owning this node.
   THD *thd;
   // The ac_info this node belongs to.
   std::shared_ptr<Ac_info> ac_info;
+  // When the running query was admitted, in microseconds. Only tracked
+  // while admission_control_latency_target is set, 0 otherwise.
+  ulonglong admit_time;
   st_ac_node(THD *thd_arg) {
     mysql_mutex_init(key_LOCK_ac_node, &lock, MY_MUTEX_INIT_FAST);
     mysql_cond_init(key_COND_ac_node, &cond, NULL);
     running = false;
     queued = false;
     queue = 0;
+    workers = 0;
+    workers_queue = 0;
     thd = thd_arg;
+    admit_time = 0;
   }
 
   ~st_ac_node () {
@@ -102,6 +119,47 @@ struct st_ac_node {
 };
 
 const ulong MAX_AC_QUEUES = 10;
+
+const uint AC_HISTOGRAM_BUCKETS = 24;
+const ulonglong AC_HISTOGRAM_BASE_US = 16;
+
+/**
+  Log2 histogram of durations in microseconds. Bucket 0 counts durations
+  below AC_HISTOGRAM_BASE_US, bucket i > 0 durations in
+  [AC_HISTOGRAM_BASE_US << (i - 1), AC_HISTOGRAM_BASE_US << i), and the
+  last bucket also everything above. Buckets are updated without locks.
+*/
+class Ac_histogram {
+  std::array<std::atomic<ulonglong>, AC_HISTOGRAM_BUCKETS> buckets;
+
+public:
+  Ac_histogram() {
+    reset();
+  }
+
+  static uint bucket(ulonglong us);
+  static ulonglong bucket_low(uint i) {
+    return i ? AC_HISTOGRAM_BASE_US << (i - 1) : 0;
+  }
+  static ulonglong bucket_high(uint i) {
+    return i + 1 < AC_HISTOGRAM_BUCKETS ? AC_HISTOGRAM_BASE_US << i
+                                        : ULONGLONG_MAX;
+  }
+
+  void add(ulonglong us) {
+    buckets[bucket(us)].fetch_add(1, std::memory_order_relaxed);
+  }
+  ulonglong get(uint i) const {
+    return buckets[i].load(std::memory_order_relaxed);
+  }
+  void reset() {
+    for (auto &b : buckets)
+      b.store(0, std::memory_order_relaxed);
+  }
+  ulonglong count() const;
+  ulonglong quantile(double q) const;
+};
+
 /**
   Represents a queue, and its associated stats.
 */
@@ -111,8 +169,12 @@ struct Ac_queue {
   inline size_t waiting_queries() const {
     return queue.size();
   }
-  // Track number of running queries.
-  unsigned long running_queries = 0;
+  // Track number of running queries. Updated without Ac_info::lock when
+  // queries leave admission control.
+  std::atomic<unsigned long> running_queries{0};
+  // Virtual finish time of the last query admitted from this queue, see
+  // AC::pick_queue().
+  ulonglong vtime = 0;
   // Track number of rejected queries.
   unsigned long aborted_queries = 0;
   // Track number of timed out queries.
@@ -130,6 +192,8 @@ class Ac_info {
   friend class AC;
   friend int fill_ac_queue(THD *thd, TABLE_LIST *tables, Item *cond);
   friend int fill_ac_entities(THD *thd, TABLE_LIST *tables, Item *cond);
+  friend int fill_ac_wait_histogram(THD *thd, TABLE_LIST *tables,
+                                    Item *cond);
 
   // Queues
   std::array<Ac_queue, MAX_AC_QUEUES> queues{};
@@ -137,10 +201,12 @@ class Ac_info {
   // Entity name used as key in ac_info map.
   std::string entity;
 
-  // Count for waiting queries in queues for this Ac_info.
-  unsigned long waiting_queries = 0;
-  // Count for running queries in queues for this Ac_info.
-  unsigned long running_queries = 0;
+  // Count for waiting queries in queues for this Ac_info. Only changed
+  // under lock, but read without it on the admission fast path.
+  std::atomic<unsigned long> waiting_queries{0};
+  // Count for running queries in queues for this Ac_info. Slots are taken
+  // with try_acquire() and released without lock.
+  std::atomic<unsigned long> running_queries{0};
   // Count for rejected queries in queues for this Ac_info.
   unsigned long aborted_queries = 0;
   // Count for timed out queries in queues for this Ac_info.
@@ -151,11 +217,41 @@ class Ac_info {
   // Stats for rejected connections.
   ulonglong rejected_connections = 0;
 
+  // Limit on running queries picked by AC::tune_limit() from the observed
+  // latency, 0 if max_running_queries applies as is.
+  std::atomic<unsigned long> tuned_limit{0};
+  // Virtual time of the weighted fair queuing across queues.
+  ulonglong vclock = 0;
+
+  // Time queries spent waiting in the queues for admission.
+  Ac_histogram wait_histogram;
+  // Queries admitted on the fast path, which belong to the zero wait
+  // bucket of wait_histogram. Counted per CPU so that admissions do not
+  // all write one cache line.
+  ShardedCounter fast_admissions;
+  // Run time of the queries that left admission control since
+  // window_start, input of AC::tune_limit().
+  Ac_histogram run_histogram;
+  std::atomic<ulonglong> window_start{0};
+
   // Protects Ac_info.
   mysql_mutex_t lock;
+
+  /**
+    Take a running slot if fewer than limit queries are running.
+  */
+  bool try_acquire(unsigned long limit) {
+    unsigned long running = running_queries;
+    while (running < limit) {
+      if (running_queries.compare_exchange_weak(running, running + 1))
+        return true;
+    }
+    return false;
+  }
 public:
   Ac_info(const std::string &_entity) : entity(_entity) {
     mysql_mutex_init(key_LOCK_ac_info, &lock, MY_MUTEX_INIT_FAST);
+    fast_admissions.reset();
   }
   ~Ac_info() {
     mysql_mutex_destroy(&lock);
@@ -183,15 +279,22 @@ enum class Ac_result {
 class AC {
   friend int fill_ac_queue(THD *thd, TABLE_LIST *tables, Item *cond);
   friend int fill_ac_entities(THD *thd, TABLE_LIST *tables, Item *cond);
+  friend int fill_ac_wait_histogram(THD *thd, TABLE_LIST *tables,
+                                    Item *cond);
 
   // This map is protected by the rwlock LOCK_ac.
   std::unordered_map<std::string, std::shared_ptr<Ac_info>> ac_map;
-  // Variables to track global limits
-  ulong max_running_queries;
-  ulong max_waiting_queries;
+  // Variables to track global limits. The query limits and weights are
+  // written under LOCK_ac but read without it when admitting queries.
+  std::atomic<ulong> max_running_queries;
+  std::atomic<ulong> max_waiting_queries;
   ulong max_connections;
 
-  std::array<unsigned long, MAX_AC_QUEUES> weights{};
+  std::array<std::atomic<ulong>, MAX_AC_QUEUES> weights{};
+
+  // Target p99 run time of queries in microseconds, 0 if the running
+  // limit of entities is not tuned.
+  std::atomic<ulonglong> latency_target;
   /**
     Protects the above variables.
 
@@ -209,6 +312,7 @@ public:
     max_running_queries = 0;
     max_waiting_queries = 0;
     max_connections = 0;
+    latency_target = 0;
     total_aborted_queries = 0;
     total_timeout_queries = 0;
     total_rejected_connections = 0;
@@ -241,33 +345,34 @@ public:
   void update_max_running_queries(ulong val) {
     // lock to protect against erasing map iterators.
     mysql_rwlock_wrlock(&LOCK_ac);
-    ulong old_val = max_running_queries;
     max_running_queries = val;
-    // Signal any waiting threads which are below the new limit. Note 0 is a
-    // special case where every waiting thread needs to be signalled.
+    // Admit waiting queries which are below the new limit, and start the
+    // latency tuning over from it. Note 0 is a special case where every
+    // waiting query is admitted.
     //
     // We don't kill any queries if the max is lowered, so it's possible for
     // the number of running queries temporarily exceed the new max.
-    if (val > old_val || !val) {
-      for (auto &it: ac_map) {
-        auto &ac_info = it.second;
-        mysql_mutex_lock(&ac_info->lock);
-
-        size_t signaled = 0;
-        // If we're not signaling all threads, we should dequeue according to
-        // score for fairness, but we're not for simplicity. This might be
-        // fine since update_max_running_queries should be a relatively rare
-        // operation, so we're still fair in steady state.
-        for (auto &q : ac_info->queues) {
-          while (q.waiting_queries() > 0) {
-            dequeue_and_run(q.queue.front()->thd, ac_info);
-            if (val && ++signaled >= val - old_val) {
-              break;
-            }
-          }
-        }
-        mysql_mutex_unlock(&ac_info->lock);
-      }
+    for (auto &it: ac_map) {
+      auto &ac_info = it.second;
+      mysql_mutex_lock(&ac_info->lock);
+      ac_info->tuned_limit = 0;
+      dispatch(ac_info);
+      mysql_mutex_unlock(&ac_info->lock);
+    }
+    mysql_rwlock_unlock(&LOCK_ac);
+  }
+
+  void update_latency_target(ulong val) {
+    mysql_rwlock_wrlock(&LOCK_ac);
+    latency_target = (ulonglong) val * 1000;
+    // Limits tuned for the old target are meaningless for the new one.
+    for (auto &it: ac_map) {
+      auto &ac_info = it.second;
+      mysql_mutex_lock(&ac_info->lock);
+      ac_info->tuned_limit = 0;
+      ac_info->run_histogram.reset();
+      dispatch(ac_info);
+      mysql_mutex_unlock(&ac_info->lock);
     }
     mysql_rwlock_unlock(&LOCK_ac);
   }
@@ -284,27 +389,36 @@ public:
     mysql_rwlock_unlock(&LOCK_ac);
   }
 
-  inline ulong get_max_running_queries() {
-    mysql_rwlock_rdlock(&LOCK_ac);
-    ulong res = max_running_queries;
-    mysql_rwlock_unlock(&LOCK_ac);
-    return res;
+  inline ulong get_max_running_queries() const {
+    return max_running_queries;
   }
 
-  inline ulong get_max_waiting_queries() {
-    mysql_rwlock_rdlock(&LOCK_ac);
-    ulong res = max_waiting_queries;
-    mysql_rwlock_unlock(&LOCK_ac);
-    return res;
+  inline ulong get_max_waiting_queries() const {
+    return max_waiting_queries;
+  }
+
+  /**
+    The running limit of an entity: max_running_queries, or less if the
+    latency tuning lowered it.
+  */
+  inline ulong get_running_limit(const Ac_info &ac_info) const {
+    ulong limit = max_running_queries;
+    ulong tuned = ac_info.tuned_limit;
+    return tuned && tuned < limit ? tuned : limit;
   }
 
   Ac_result admission_control_enter(THD *, enum_admission_control_request_mode);
   void admission_control_exit(THD*);
+  ulong acquire_workers(THD *, ulong wanted);
+  void release_workers(THD *);
   bool wait_for_signal(THD *, std::shared_ptr<st_ac_node> &,
                        std::shared_ptr<Ac_info> ac_info, enum_admission_control_request_mode);
   static void enqueue(THD *thd, std::shared_ptr<Ac_info> ac_info, enum_admission_control_request_mode);
   static void dequeue(THD *thd, std::shared_ptr<Ac_info> ac_info);
-  static void dequeue_and_run(THD *thd, std::shared_ptr<Ac_info> ac_info);
+  void dequeue_and_run(THD *thd, std::shared_ptr<Ac_info> ac_info);
+  ulong pick_queue(const Ac_info &ac_info) const;
+  void dispatch(const std::shared_ptr<Ac_info> &ac_info);
+  void tune_limit(Ac_info *ac_info);
 
   Ac_result add_connection(THD *, const char *);
   void close_connection(THD*);
@@ -322,12 +436,7 @@ public:
     ulonglong res= 0;
     mysql_rwlock_rdlock(&LOCK_ac);
     for (const auto &it : ac_map)
-    {
-      auto &ac_info = it.second;
-      mysql_mutex_lock(&ac_info->lock);
-      res += ac_info->running_queries;
-      mysql_mutex_unlock(&ac_info->lock);
-    }
+      res += it.second->running_queries;
     mysql_rwlock_unlock(&LOCK_ac);
     return res;
   }
@@ -335,12 +444,7 @@ public:
     ulonglong res= 0;
     mysql_rwlock_rdlock(&LOCK_ac);
     for (const auto &it : ac_map)
-    {
-      auto &ac_info = it.second;
-      mysql_mutex_lock(&ac_info->lock);
-      res += ac_info->waiting_queries;
-      mysql_mutex_unlock(&ac_info->lock);
-    }
+      res += it.second->waiting_queries;
     mysql_rwlock_unlock(&LOCK_ac);
     return res;
   }
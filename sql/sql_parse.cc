@@ -1577,6 +1577,8 @@ static void update_sql_stats(THD *thd, SHARED_SQL_STATS *cumulative_sql_stats, c
   if (sql_findings_control == SQL_INFO_CONTROL_ON)
     store_sql_findings(thd, sub_query);
 
+  store_sql_distinct_stats(thd);
+
   /* check if should we include warnings in the response attributes */
   if (thd->variables.response_attrs_contain_warnings_bytes > 0 &&
       !thd->is_error() && /* there is no error generated */
@@ -3997,11 +3999,11 @@ mysql_execute_command(THD *thd,
       restore status variables, as we don't want 'show status' to cause
       changes
     */
-    mysql_mutex_lock(&LOCK_status);
-    add_diff_to_status(&global_status_var, &thd->status_var,
+    uint shard= LOCK_status_sharded.lock();
+    add_diff_to_status(&status_var_shards[shard], &thd->status_var,
                        &old_status_var);
     thd->set_status_var(old_status_var);
-    mysql_mutex_unlock(&LOCK_status);
+    LOCK_status_sharded.unlock(shard);
     break;
   }
   case SQLCOM_SHOW_EVENTS:
@@ -7905,6 +7907,11 @@ void THD::reset_for_next_command()
   thd->set_examined_row_count(0);
   thd->set_accessed_rows_and_keys(0);
   thd->reset_stmt_stats();
+  /*
+    Only COM_QUERY adds the keys to the sketch of its SQL ID, do not charge
+    it with those of prepared statements, routines or the slave applier.
+  */
+  thd->reset_distinct_keys();
   thd->reset_current_stmt_binlog_format_row();
   thd->binlog_unsafe_warning_flags= 0;
   thd->audited_event_for_command = false;
@@ -29,6 +29,7 @@
 #include "opt_range.h"
 #include "opt_trace.h"
 #include "sql_executor.h"
+#include "sql_join_buffer.h"                    // JOIN_CACHE_HASH
 #include "merge_sort.h"
 #include <my_bit.h>
 
@@ -965,6 +966,9 @@ void Optimize_table_order::best_access_path(
     if (s->table->quick_condition_rows != s->found_records)
       rnd_records= s->table->quick_condition_rows;
 
+    /* Cost of evaluating the condition for the rows joined by the scan */
+    double compare_cost= record_count * ROW_EVALUATE_COST * rnd_records;
+
     /*
       Range optimizer never proposes a RANGE if it isn't better
       than FULL: so if RANGE is present, it's always preferred to FULL.
@@ -1016,9 +1020,10 @@ void Optimize_table_order::best_access_path(
           It would be more exact to round the result of the division with
           floor(), but that takes 5% of time in a 20-table query plan search.
         */
-        tmp*= (1.0 + ((double) cache_record_length(join,idx) *
-                      record_count /
-                      (double) thd->variables.join_buff_size));
+        const double scans= 1.0 + ((double) cache_record_length(join,idx) *
+                                   record_count /
+                                   (double) thd->variables.join_buff_size);
+        tmp*= scans;
         /* 
             We don't make full cartesian product between rows in the scanned
            table and existing records because we skip all rows from the
@@ -1027,18 +1032,37 @@ void Optimize_table_order::best_access_path(
            take into account cost to read and skip these records.
         */
         tmp+= (s->records - rnd_records) * ROW_EVALUATE_COST;
+
+        if (thd->optimizer_switch_flag(OPTIMIZER_SWITCH_HASH_JOIN) &&
+            JOIN_CACHE_HASH::keys_possible(join, s, remaining_tables))
+        {
+          trace_access_scan.add("using_hash_join", true);
+          /*
+            Every buffered record is hashed once and every row read from
+            the table probes the hash table, after which the condition is
+            only evaluated for the buffered records with an equal key.
+            Lacking statistics on the columns assume as many of them per
+            probe as for a ref access on a key with unknown distribution.
+            The join returns as many rows as block nested loop, so only
+            the cost of the comparisons changes.
+          */
+          compare_cost= (record_count + scans * rnd_records +
+                         rnd_records *
+                         min(record_count,
+                             scans * MATCHING_ROWS_IN_OTHER_TABLE)) *
+                        ROW_EVALUATE_COST;
+        }
       }
     }
 
-    const double scan_cost=
-      tmp + (record_count * ROW_EVALUATE_COST * rnd_records);
+    const double scan_cost= tmp + compare_cost;
 
     trace_access_scan.add("rows", rows2double(rnd_records)).
       add("cost", scan_cost);
     /*
       We estimate the cost of evaluating WHERE clause for found records
-      as record_count * rnd_records * ROW_EVALUATE_COST. This cost plus
-      tmp give us total cost of using TABLE SCAN
+      as record_count * rnd_records * ROW_EVALUATE_COST, or less with a
+      hash join. This cost plus tmp give us total cost of using TABLE SCAN
     */
     if (best == DBL_MAX ||
         (scan_cost < best + (record_count * ROW_EVALUATE_COST * records)))
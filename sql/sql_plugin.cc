@@ -2784,10 +2784,12 @@ static uchar *intern_sys_var_ptr(THD* thd, int offset, bool global_lock)
                  global_variables_dynamic_size,
                  MYF(MY_WME | MY_FAE | MY_ALLOW_ZERO_PTR));
 
+    /*
+      Without global_lock the caller holds lock_global_system_variables()
+      or a reader shard, see rdlock_global_system_variables().
+    */
     if (global_lock)
-      mysql_mutex_lock(&LOCK_global_system_variables);
-
-    mysql_mutex_assert_owner(&LOCK_global_system_variables);
+      lock_global_system_variables();
 
     memcpy(thd->variables.dynamic_variables_ptr +
              thd->variables.dynamic_variables_size,
@@ -2828,7 +2830,7 @@ static uchar *intern_sys_var_ptr(THD* thd, int offset, bool global_lock)
     }
 
     if (global_lock)
-      mysql_mutex_unlock(&LOCK_global_system_variables);
+      unlock_global_system_variables();
 
     thd->variables.dynamic_variables_version=
            global_system_variables.dynamic_variables_version;
@@ -3276,11 +3278,11 @@ bool sys_var_pluginvar::session_update(THD *thd, set_var *var)
   DBUG_ASSERT(plugin_var->flags & PLUGIN_VAR_THDLOCAL);
   DBUG_ASSERT(thd == current_thd);
 
-  mysql_mutex_lock(&LOCK_global_system_variables);
+  lock_global_system_variables();
   void *tgt= real_value_ptr(thd, var->type);
   const void *src= var->value ? (void*)&var->save_result
                               : (void*)real_value_ptr(thd, OPT_GLOBAL);
-  mysql_mutex_unlock(&LOCK_global_system_variables);
+  unlock_global_system_variables();
 
   if ((plugin_var->flags & PLUGIN_VAR_TYPEMASK) == PLUGIN_VAR_STR &&
       plugin_var->flags & PLUGIN_VAR_MEMALLOC)
@@ -1277,7 +1277,11 @@ static uint join_buffer_alg(const THD *thd)
   uint alg= JOIN_CACHE::ALG_NONE;
 
   if (thd->optimizer_switch_flag(OPTIMIZER_SWITCH_BNL))
+  {
     alg|= JOIN_CACHE::ALG_BNL;
+    if (thd->optimizer_switch_flag(OPTIMIZER_SWITCH_HASH_JOIN))
+      alg|= JOIN_CACHE::ALG_HASH;
+  }
 
   if (thd->optimizer_switch_flag(OPTIMIZER_SWITCH_BKA))
   {
@@ -2373,7 +2377,10 @@ void revise_cache_usage(JOIN_TAB *join_tab)
     If block_nested_loop is turned on, and if all other criteria for using
     join buffering is fulfilled (see below), then join buffer is used
     for any join operation (inner join, outer join, semi-join) with 'JT_ALL'
-    access method.  In that case, a JOIN_CACHE_BNL object is always employed.
+    access method.  In that case, a JOIN_CACHE_BNL object is employed, or,
+    if hash_join is on as well and the condition attached to the table has
+    equalities between its columns and columns of the previous tables that
+    the records can be hashed by, a JOIN_CACHE_HASH object.
 
     If an index is used to access rows of the joined table and batched_key_access
     is on, then a JOIN_CACHE_BKA object is employed. (Unless debug flag,
@@ -2428,6 +2435,8 @@ static bool setup_join_buffering(JOIN_TAB *tab, JOIN *join,
   JOIN_CACHE *prev_cache;
   const bool bnl_on= join->thd->optimizer_switch_flag(OPTIMIZER_SWITCH_BNL);
   const bool bka_on= join->thd->optimizer_switch_flag(OPTIMIZER_SWITCH_BKA);
+  const bool hash_on=
+    join->thd->optimizer_switch_flag(OPTIMIZER_SWITCH_HASH_JOIN);
   const uint tableno= tab - join->join_tab;
   const uint tab_sj_strategy= tab->get_sj_strategy();
   bool use_bka_unique= false;
@@ -2556,6 +2565,31 @@ static bool setup_join_buffering(JOIN_TAB *tab, JOIN *join,
       goto no_join_cache;
     }
 
+    if (hash_on)
+    {
+      Field *fields[MAX_REF_PARTS];
+      Field *args[MAX_REF_PARTS];
+      if (JOIN_CACHE_HASH::find_keys(tab, fields, args))
+      {
+        if ((options & SELECT_DESCRIBE) ||
+            ((tab->op= new JOIN_CACHE_HASH(join, tab, prev_cache)) &&
+             !tab->op->init()))
+        {
+          *icp_other_tables_ok= FALSE;
+          DBUG_ASSERT(might_do_join_buffering(join_buffer_alg(join->thd),
+                                              tab));
+          tab->use_join_cache= JOIN_CACHE::ALG_HASH;
+          return false;
+        }
+        /* The buffer is too small for the hash table, try BNL */
+        if (tab->op)
+        {
+          tab->op->free();
+          tab->op= NULL;
+        }
+      }
+    }
+
     if ((options & SELECT_DESCRIBE) ||
         ((tab->op= new JOIN_CACHE_BNL(join, tab, prev_cache)) &&
          !tab->op->init()))
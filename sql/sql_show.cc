@@ -4381,7 +4381,13 @@ static bool show_status_array(THD *thd, const char *wild,
         char *value=var->value;
         const char *pos, *end;                  // We assign a lot of const's
 
-        mysql_mutex_lock(&LOCK_global_system_variables);
+        /* System variables are only read, status functions may need more */
+        const bool sys_var_read= show_type == SHOW_SYS;
+        uint shard= 0;
+        if (sys_var_read)
+          shard= rdlock_global_system_variables();
+        else
+          lock_global_system_variables();
 
         if (show_type == SHOW_SYS)
         {
@@ -4504,7 +4510,10 @@ static bool show_status_array(THD *thd, const char *wild,
         thd->count_cuted_fields= CHECK_FIELD_IGNORE;
         table->field[1]->set_notnull();
 
-        mysql_mutex_unlock(&LOCK_global_system_variables);
+        if (sys_var_read)
+          rdunlock_global_system_variables(shard);
+        else
+          unlock_global_system_variables();
 
         // store the record to thd
         if (schema_table_store_record(thd, table))
@@ -4531,8 +4540,15 @@ void calc_sum_of_all_status(STATUS_VAR *to)
 
   Thread_iterator it= global_thread_list_begin();
   Thread_iterator end= global_thread_list_end();
-  /* Get global values as base */
+  /*
+    Get global values and the status of ended threads as base. The status
+    shards stay locked until all threads are summed, so that a thread
+    ending meanwhile is counted exactly once.
+  */
+  LOCK_status_sharded.lock_all();
   *to= global_status_var;
+  for (uint i= 0; i < LOCK_status_sharded.size(); i++)
+    add_to_status(to, &status_var_shards[i]);
 
   /* Add to this status from existing threads */
   for (; it != end; ++it)
@@ -4545,6 +4561,7 @@ void calc_sum_of_all_status(STATUS_VAR *to)
   }
 #endif
 
+  LOCK_status_sharded.unlock_all();
   mutex_unlock_all_shards(SHARDED(&LOCK_thread_count));
   DBUG_VOID_RETURN;
 }
@@ -10488,8 +10505,12 @@ ST_SCHEMA_TABLE schema_tables[]=
    fill_ac_entities, NULL, NULL, -1, -1, false, 0},
   {"ADMISSION_CONTROL_QUEUE", admission_control_queue_fields_info, create_schema_table,
    fill_ac_queue, NULL, NULL, -1, -1, false, 0},
+  {"ADMISSION_CONTROL_WAIT_HISTOGRAM", admission_control_wait_histogram_fields_info,
+   create_schema_table, fill_ac_wait_histogram, NULL, NULL, -1, -1, false, 0},
   {"SQL_FINDINGS", sql_findings_fields_info, create_schema_table,
    fill_sql_findings, NULL, NULL, -1, -1, false, 0},
+  {"SQL_DISTINCT_STATISTICS", sql_distinct_stats_fields_info,
+   create_schema_table, fill_sql_distinct_stats, NULL, NULL, -1, -1, false, 0},
   {"THREAD_PRIORITIES", thread_priorities_fields_info, create_schema_table,
    fill_thread_priorities, NULL, NULL, -1, -1, false, 0},
   {"TRANSACTION_SIZE_HISTOGRAM", tx_size_histogram_fields_info, create_schema_table,
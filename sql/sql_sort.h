@@ -79,6 +79,7 @@ public:
   uint addon_length;          // Length of added packed fields.
   uint res_length;            // Length of records in final sorted file/buffer.
   uint max_keys_per_buffer;   // Max keys / buffer.
+  uint sort_threads;          // Threads sorting a buffer, 0 or 1 if serial.
   ha_rows max_rows;           // Select limit, or HA_POS_ERROR if unlimited.
   ha_rows examined_rows;      // Number of examined rows.
   TABLE *sort_form;           // For quicker make_sortkey.
@@ -112,5 +113,7 @@ int merge_buffers(Sort_param *param,IO_CACHE *from_file,
                   BUFFPEK *lastbuff,BUFFPEK *Fb,
                   BUFFPEK *Tb,int flag);
 void reuse_freed_buff(QUEUE *queue, BUFFPEK *reuse, uint key_length);
+void reuse_freed_buff(BUFFPEK *first, BUFFPEK *last, BUFFPEK *reuse,
+                      uint key_length);
 
 #endif /* SQL_SORT_INCLUDED */
@@ -10,9 +10,30 @@
 #include "rpl_master.h"                         // get_current_replication_lag
 #include <mysql/plugin_rim.h>
 #include <handler.h>
+#include "lf.h"
+#include "my_atomic.h"
+#include "my_murmur3.h"
+#include "hyperloglog.h"
+#include <algorithm>
 
-/* Global map to track the number of active identical sql statements */
-static std::unordered_map<md5_key, uint> global_active_sql;
+/*
+  Statements currently executing, keyed by the hash of their text, default
+  database and query cache flags.
+
+  Registration happens on every SELECT when duplicate execution capping is
+  enabled, so the registry is an LF_HASH: lookups and count updates are
+  lock-free and deleted elements are reclaimed through the pins (hazard
+  pointers) of the allocator only once no thread can still see them.
+*/
+struct Active_sql
+{
+  md5_key key;
+  /* Number of executing statements, 0 while the element is being deleted */
+  int32 volatile count;
+};
+
+static LF_HASH global_active_sql;
+static bool global_active_sql_inited= false;
 
 static bool mt_lock(mysql_mutex_t *mutex)
 {
@@ -53,51 +74,69 @@ static void mt_unlock(bool acquired, mysql_mutex_t *mutex)
 /***********************************************************************
  Begin - Functions to support capping the number of duplicate executions
 ************************************************************************/
+/*
+  init_global_active_sql
+    Initializes global_active_sql
+*/
+void init_global_active_sql(void)
+{
+  lf_hash_init(&global_active_sql, sizeof(Active_sql), LF_HASH_UNIQUE,
+               offsetof(Active_sql, key), MD5_HASH_SIZE, NULL,
+               &my_charset_bin);
+  global_active_sql_inited= true;
+}
+
 /*
   free_global_active_sql
-    Frees global_active_sql
+    Frees global_active_sql, called at shutdown once all THDs are gone
 */
 void free_global_active_sql(void)
 {
-  bool lock_acquired = mt_lock(&LOCK_global_active_sql);
-
-  global_active_sql.clear();
-
-  mt_unlock(lock_acquired, &LOCK_global_active_sql);
+  if (global_active_sql_inited)
+  {
+    lf_hash_destroy(&global_active_sql);
+    global_active_sql_inited= false;
+  }
 }
 
 /*
-  skip_quote
-  Skips over quoted strings
-  It handles both single and double quotes by calling
-  it twice by passing the quote character as argument
-  first time single quote and second as double quote.
-  Skipping happens by changing the offset of the next
-  comment search (position of the second quote+1).
-  It handles both cases when the string includes the
-  begining of a comment or not
+  get_active_sql_pins
+    Returns the pins of the THD for global_active_sql, allocating them on
+    first use. Returns NULL if they cannot be allocated.
 */
-static bool skip_quote(
-    std::string& query_str,
-    size_t      *offset,
-    size_t       c_start_pos,
-    const char  *quote)
+static LF_PINS *get_active_sql_pins(THD *thd)
 {
-  size_t quote_pos = query_str.find(quote, *offset);
+  if (unlikely(thd->active_sql_pins == NULL))
+  {
+    if (!global_active_sql_inited)
+      return NULL;
+    thd->active_sql_pins= lf_hash_get_pins(&global_active_sql);
+  }
+  return thd->active_sql_pins;
+}
 
-  if (quote_pos != std::string::npos &&
-      quote_pos < c_start_pos)
+/*
+  release_active_sql_pins
+    Returns the pins of the THD to the allocator, called when the THD
+    releases its resources
+*/
+void release_active_sql_pins(THD *thd)
+{
+  if (thd->active_sql_pins)
   {
-    quote_pos = query_str.find(quote, quote_pos+1);
-    *offset   = quote_pos+1;
-    return true;
+    lf_hash_put_pins(thd->active_sql_pins);
+    thd->active_sql_pins= NULL;
   }
-  return false;
 }
 
 /*
-  strip_query_comment
-    Return the query text without comments
+  strip_query_comments
+    Copy the query text without comments into to, return the new length.
+    to must have room for length bytes.
+
+    Comment starts are ignored when they are inside a single or double
+    quoted string; doubled quotes need no special handling as they just
+    end and restart the string.
 
   Examples (where begin comment is /+ and end comment is +/)
    IN: /+C1+/ select '''Q2''', '''/+''', """+/""" /+C2+/ from dual /+C3+/
@@ -105,31 +144,50 @@ static bool skip_quote(
    IN: /+C1+/ select 'Q2', '/+', "+/" /+C2+/ from dual /+C3+/
    OUT:  select 'Q2', '/+', "+/"  from dual
 */
-static void strip_query_comments(std::string& query_str)
+static size_t strip_query_comments(const char *query, size_t length,
+                                   char *to)
 {
-  const uint comment_size = 2;
-  size_t offset = 0;
+  static const char c_begin[]= "/*";
+  static const char c_end[]= "*/";
+  static const char quotes[]= "'\"";
+  const uint comment_size= 2;
+  const char *end= query + length;
+  const char *copied= query;    // text before this is already in to
+  const char *pos= query;       // where to look for the next comment
+  char *out= to;
+
   while (true)
   {
-    size_t c_start_pos = query_str.find("/*", offset);
-
-    if (c_start_pos == std::string::npos)
+    const char *c_start= std::search(pos, end, c_begin,
+                                     c_begin + comment_size);
+    if (c_start == end)
       break;
 
     // so far we found a start of a comment; next we
     // check if it is enclosed in a string i.e either
     // single or double quoted
-    if (skip_quote(query_str, &offset, c_start_pos, "'"))
-      continue;
-
-    if (skip_quote(query_str, &offset, c_start_pos, "\""))
+    const char *quote= std::find_first_of(pos, c_start, quotes, quotes + 2);
+    if (quote != c_start)
+    {
+      const char *quote_end= std::find(quote + 1, end, *quote);
+      if (quote_end == end)
+        break;
+      pos= quote_end + 1;
       continue;
+    }
 
-    size_t c_stop_pos = query_str.find("*/", c_start_pos);
-    DBUG_ASSERT(c_stop_pos != std::string::npos);
+    const char *c_stop= std::search(c_start + comment_size, end, c_end,
+                                    c_end + comment_size);
+    DBUG_ASSERT(c_stop != end);
 
-    query_str.erase(c_start_pos, c_stop_pos + comment_size - c_start_pos);
+    memcpy(out, copied, c_start - copied);
+    out+= c_start - copied;
+    copied= pos= (c_stop == end) ? end : c_stop + comment_size;
   }
+
+  memcpy(out, copied, end - copied);
+  out+= end - copied;
+  return out - to;
 }
 
 /*
@@ -161,93 +219,130 @@ bool register_active_sql(THD *thd, char *query_text,
       thd->in_active_multi_stmt_transaction())
     return false;
 
-  /* prepare a string with a size large enough to store the sql text,
-     database, and some flags (that affect query similarity).
-  */
-  std::string query_str;
-  query_str.reserve(query_length+thd->db_length+QUERY_CACHE_FLAGS_SIZE+1);
+  LF_PINS *pins= get_active_sql_pins(thd);
+  if (unlikely(pins == NULL))
+    return false;
 
-  /* load the sql text */
-  query_str.append(query_text, query_length);
+  /* prepare a buffer in the statement arena large enough to store the
+     sql text, database, and some flags (that affect query similarity).
+  */
+  char *key_buf= (char *) thd->alloc(query_length + thd->db_length +
+                                     QUERY_CACHE_FLAGS_SIZE);
+  if (key_buf == NULL)
+    return false;
 
-  /* strip the query comments (everywhere in the text) */
-  strip_query_comments(query_str);
+  /* load the sql text, stripping the query comments (everywhere in it) */
+  size_t key_length= strip_query_comments(query_text, query_length, key_buf);
 
   /* load the database name */
-  query_str.append((const char*) thd->db, thd->db_length);
+  memcpy(key_buf + key_length, thd->db, thd->db_length);
+  key_length+= thd->db_length;
 
   /* load the flags */
   Query_cache_query_flags flags = get_query_cache_flags(thd, false);
-  query_str.append((const char*) &flags, QUERY_CACHE_FLAGS_SIZE);
+  memcpy(key_buf + key_length, &flags, QUERY_CACHE_FLAGS_SIZE);
+  key_length+= QUERY_CACHE_FLAGS_SIZE;
 
   /* compute MD5 from the key value (query, db, flags) */
-  md5_key sql_hash;
-  compute_md5_hash((char*)sql_hash.data(), query_str.c_str(), query_str.length());
-
-  // so far did not exceed the max number of dups
-  bool rejected = false;
+  Active_sql new_entry;
+  compute_md5_hash((char*) new_entry.key.data(), key_buf, key_length);
+  new_entry.count= 1;
 
-  bool lock_acquired = mt_lock(&LOCK_global_active_sql);
-  auto iter = global_active_sql.find(sql_hash);
-  if (iter == global_active_sql.end())
-  {
-    global_active_sql.emplace(sql_hash, 1); // its first occurrence
-  }
-  else
+  int32 count;
+  while (true)
   {
-    if (iter->second+1 > max_dup_exe)       // one too many
+    Active_sql *entry= (Active_sql *)
+      lf_hash_search(&global_active_sql, pins, new_entry.key.data(),
+                     MD5_HASH_SIZE);
+    if (entry == MY_ERRPTR)
+      return false;                    // out of memory, do not track it
+
+    if (entry == NULL)
     {
-      if (control == CONTROL_LEVEL_ERROR)   // reject it
+      int res= lf_hash_insert(&global_active_sql, pins, &new_entry);
+      if (res == 0)
       {
-        rejected = true;
-        my_error(ER_DUPLICATE_STATEMENT_EXECUTION, MYF(0));
-      }
-      else // control is NOTE or WARN => report note / warning
-      {
-        push_warning_printf(thd,
-                            (control == CONTROL_LEVEL_NOTE) ?
-                             Sql_condition::WARN_LEVEL_NOTE :
-                             Sql_condition::WARN_LEVEL_WARN,
-                            ER_DUPLICATE_STATEMENT_EXECUTION,
-                            ER(ER_DUPLICATE_STATEMENT_EXECUTION));
+        count= 1;                      // its first occurrence
+        break;
       }
+      if (res < 0)
+        return false;
+      continue;                        // raced with another insert
+    }
+
+    count= my_atomic_load32(&entry->count);
+    if (count == 0)
+    {
+      /* the last execution is deleting it, wait for the delete */
+      lf_hash_search_unpin(pins);
+      continue;
+    }
+
+    /* one too many, do not count an execution that will be rejected */
+    if (count + 1ULL > max_dup_exe && control == CONTROL_LEVEL_ERROR)
+    {
+      lf_hash_search_unpin(pins);
+      my_error(ER_DUPLICATE_STATEMENT_EXECUTION, MYF(0));
+      return true;
+    }
+
+    bool added= my_atomic_cas32(&entry->count, &count, count + 1);
+    lf_hash_search_unpin(pins);
+    if (added)
+    {
+      count++;                         // increment the number of duplicates
+      break;
     }
-    if (!rejected)
-      iter->second++;    // increment the number of duplicates
   }
 
-  if (!rejected)
+  if ((ulong) count > max_dup_exe)     // control is NOTE or WARN
   {
-    // remember the sql_hash
-    thd->mt_key_set(THD::SQL_HASH, sql_hash.data());
-    DBUG_ASSERT(thd->mt_key_is_set(THD::SQL_HASH));
+    push_warning_printf(thd,
+                        (control == CONTROL_LEVEL_NOTE) ?
+                         Sql_condition::WARN_LEVEL_NOTE :
+                         Sql_condition::WARN_LEVEL_WARN,
+                        ER_DUPLICATE_STATEMENT_EXECUTION,
+                        ER(ER_DUPLICATE_STATEMENT_EXECUTION));
   }
 
-  mt_unlock(lock_acquired, &LOCK_global_active_sql);
-  return rejected;
+  // remember the sql_hash
+  thd->mt_key_set(THD::SQL_HASH, new_entry.key.data());
+  DBUG_ASSERT(thd->mt_key_is_set(THD::SQL_HASH));
+  return false;
 }
 
 /*
   remove_active_sql
     Remove an active SQL, called at end of the execution
+
+  The execution that brings the count to 0 deletes the element; registering
+  executions never revive a count of 0 but retry until it is gone.
 */
 void remove_active_sql(THD *thd)
 {
   if (!thd->mt_key_is_set(THD::SQL_HASH))
     return;
 
-  bool lock_acquired = mt_lock(&LOCK_global_active_sql);
+  const uchar *key= thd->mt_key_value(THD::SQL_HASH).data();
 
-  auto iter = global_active_sql.find(thd->mt_key_value(THD::SQL_HASH));
-  if (iter != global_active_sql.end())
-  {
-    if (iter->second == 1)
-      global_active_sql.erase(iter);
-    else
-      iter->second--;
-  }
+  /* a later statement of the same packet may not register itself */
+  thd->mt_key_clear(THD::SQL_HASH);
 
-  mt_unlock(lock_acquired, &LOCK_global_active_sql);
+  LF_PINS *pins= get_active_sql_pins(thd);
+  if (unlikely(pins == NULL))
+    return;
+
+  Active_sql *entry= (Active_sql *)
+    lf_hash_search(&global_active_sql, pins, key, MD5_HASH_SIZE);
+  if (entry == NULL || entry == MY_ERRPTR)
+    return;
+
+  int32 count= my_atomic_add32(&entry->count, -1);
+  lf_hash_search_unpin(pins);
+  DBUG_ASSERT(count > 0);
+
+  if (count == 1)
+    lf_hash_delete(&global_active_sql, pins, key, MD5_HASH_SIZE);
 }
 
 /*********************************************************************
@@ -387,6 +482,44 @@ ST_FIELD_INFO sql_findings_fields_info[]=
 /* Global SQL findings map to track findings for all SQL statements */
 std::unordered_map<md5_key, SQL_FINDING_VEC> global_sql_findings_map;
 
+/*
+  SQL_DISTINCT_STATISTICS
+
+  Associates a SQL ID with the approximate number of distinct users, hosts
+  and index lookup keys seen for it within the last
+  sql_distinct_stats_window seconds.
+*/
+ST_FIELD_INFO sql_distinct_stats_fields_info[]=
+{
+  {"SQL_ID", MD5_BUFF_LENGTH, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE},
+  {"DISTINCT_USERS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG,
+      0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"DISTINCT_HOSTS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG,
+      0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"DISTINCT_KEYS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG,
+      0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"LAST_UPDATED", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG,
+      0, MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE}
+};
+
+/*
+  Windowed hyperloglog sketches of a SQL ID. All sketches have
+  SQL_DISTINCT_STATS_BUCKETS buckets, so their size is fixed.
+*/
+struct SQL_DISTINCT_STATS
+{
+  hyperloglog_t users;
+  hyperloglog_t hosts;
+  hyperloglog_t keys;
+  uint last_updated;
+};
+
+/* Global map of the distinct value sketches of all SQL statements */
+static std::unordered_map<md5_key, SQL_DISTINCT_STATS*>
+  global_sql_distinct_stats_map;
+
 
 /*
   WRITE_STATISTICS
@@ -1627,6 +1760,7 @@ ulonglong current_max_sql_stats_size= 0;
 
 extern ulonglong sql_plans_size;
 ulonglong sql_findings_size = 0;
+ulonglong sql_distinct_stats_size = 0;
 
 /*
   max_sql_text_storage_size is the maximum size of the sql text's underlying
@@ -2131,8 +2265,8 @@ void free_global_sql_stats(bool limits_updated)
 */
 bool is_sql_stats_collection_above_limit() {
   return sql_stats_count >= max_sql_stats_count ||
-         sql_stats_size + sql_plans_size + sql_findings_size >=
-           max_sql_stats_size;
+         sql_stats_size + sql_plans_size + sql_findings_size +
+         sql_distinct_stats_size >= max_sql_stats_size;
 }
 
 /***********************************************************************
@@ -2265,6 +2399,192 @@ void store_sql_findings(THD *thd, char *query_text)
                 End - Functions to support SQL findings
 ************************************************************************/
 
+/***********************************************************************
+          Begin - Functions to support SQL distinct value statistics
+************************************************************************/
+static void free_sql_distinct_stats(SQL_DISTINCT_STATS *stats)
+{
+  hyperloglog_destroy(&stats->users);
+  hyperloglog_destroy(&stats->hosts);
+  hyperloglog_destroy(&stats->keys);
+  my_free(stats);
+}
+
+/*
+  alloc_sql_distinct_stats
+    Allocate the sketches of a SQL ID, returns NULL if out of memory
+*/
+static SQL_DISTINCT_STATS *alloc_sql_distinct_stats()
+{
+  SQL_DISTINCT_STATS *stats= (SQL_DISTINCT_STATS*)
+    my_malloc(sizeof(SQL_DISTINCT_STATS), MYF(MY_WME | MY_ZEROFILL));
+  if (!stats)
+    return nullptr;
+
+  if (hyperloglog_init_size(&stats->users, SQL_DISTINCT_STATS_LOG2) ||
+      hyperloglog_init_size(&stats->hosts, SQL_DISTINCT_STATS_LOG2) ||
+      hyperloglog_init_size(&stats->keys, SQL_DISTINCT_STATS_LOG2))
+  {
+    /* my_free() ignores the NULL data of the sketches not allocated */
+    free_sql_distinct_stats(stats);
+    return nullptr;
+  }
+  return stats;
+}
+
+/*
+  sql_distinct_stats_entry_size
+    Memory used by the sketches of one SQL ID
+*/
+static ulonglong sql_distinct_stats_entry_size()
+{
+  const uint bit_positions= 32 - SQL_DISTINCT_STATS_LOG2 + 1;
+  return MD5_HASH_SIZE + sizeof(SQL_DISTINCT_STATS) +
+         3 * SQL_DISTINCT_STATS_BUCKETS * bit_positions * sizeof(uint);
+}
+
+/*
+  free_global_sql_distinct_stats
+    Frees global_sql_distinct_stats_map
+*/
+void free_global_sql_distinct_stats(void)
+{
+  bool lock_acquired = mt_lock(&LOCK_global_sql_distinct_stats);
+
+  for (auto& stats_iter : global_sql_distinct_stats_map)
+    free_sql_distinct_stats(stats_iter.second);
+
+  global_sql_distinct_stats_map.clear();
+  sql_distinct_stats_size = 0;
+
+  mt_unlock(lock_acquired, &LOCK_global_sql_distinct_stats);
+}
+
+/*
+  record_sql_distinct_key
+    Count the hash of an index lookup key of the current statement. The
+    key is added to the sketch of the statement when it ends.
+*/
+void record_sql_distinct_key(THD *thd, uint32 key_hash)
+{
+  hyperloglog_registers_insert(thd->distinct_key_registers,
+                               SQL_DISTINCT_STATS_LOG2, key_hash);
+  thd->distinct_keys_recorded= true;
+}
+
+/*
+  store_sql_distinct_stats
+    Add the user, host and index lookup keys of the SQL statement that just
+    ended to the sketches of its SQL ID. Sketches are created until the
+    SQL stats limits are reached.
+
+  Input:
+    thd         in:  - THD
+*/
+void store_sql_distinct_stats(THD *thd)
+{
+  if (sql_distinct_stats_control == SQL_INFO_CONTROL_ON &&
+      thd->mt_key_is_set(THD::SQL_ID))
+  {
+    const char *user= thd->get_user_name();
+    const char *host= thd->main_security_ctx.host_or_ip;
+    if (!host)
+      host= "";
+    const uint32 user_hash= murmur3_32((const uchar*) user, strlen(user), 0);
+    const uint32 host_hash= murmur3_32((const uchar*) host, strlen(host), 0);
+    const uint now= (uint) my_time(0);
+
+    bool lock_acquired = mt_lock(&LOCK_global_sql_distinct_stats);
+
+    SQL_DISTINCT_STATS *stats= nullptr;
+    auto stats_iter=
+      global_sql_distinct_stats_map.find(thd->mt_key_value(THD::SQL_ID));
+    if (stats_iter != global_sql_distinct_stats_map.end())
+      stats= stats_iter->second;
+    else if (!is_sql_stats_collection_above_limit() &&
+             (stats= alloc_sql_distinct_stats()))
+    {
+      global_sql_distinct_stats_map.emplace(thd->mt_key_value(THD::SQL_ID),
+                                            stats);
+      sql_distinct_stats_size += sql_distinct_stats_entry_size();
+    }
+
+    if (stats)
+    {
+      hyperloglog_insert(&stats->users, user_hash, now);
+      hyperloglog_insert(&stats->hosts, host_hash, now);
+      if (thd->distinct_keys_recorded)
+        hyperloglog_insert_registers(&stats->keys,
+                                     thd->distinct_key_registers, now);
+      stats->last_updated= now;
+    }
+
+    mt_unlock(lock_acquired, &LOCK_global_sql_distinct_stats);
+  }
+
+  thd->reset_distinct_keys();
+}
+
+int fill_sql_distinct_stats(THD *thd, TABLE_LIST *tables, Item *cond)
+{
+  DBUG_ENTER("fill_sql_distinct_stats");
+  TABLE* table= tables->table;
+
+  int result = 0;
+  if (mt_tables_access_control && check_global_access(thd, PROCESS_ACL))
+    result = -1;
+
+  /* A window of 0 covers everything collected so far */
+  const uint window= thd->variables.sql_distinct_stats_window;
+  const uint now= (uint) my_time(0);
+  const uint since= (window && window < now) ? now - window : 0;
+  uchar registers[SQL_DISTINCT_STATS_BUCKETS];
+
+  bool lock_acquired = mt_lock(&LOCK_global_sql_distinct_stats);
+
+  for (auto stats_iter= global_sql_distinct_stats_map.cbegin();
+       !result && stats_iter != global_sql_distinct_stats_map.cend();
+       ++stats_iter)
+  {
+    SQL_DISTINCT_STATS *stats= stats_iter->second;
+    if (stats->last_updated <= since)
+      continue;
+
+    int f= 0;
+    restore_record(table, s->default_values);
+
+    /* SQL ID */
+    char sql_id_hex_string[MD5_BUFF_LENGTH];
+    array_to_hex(sql_id_hex_string, stats_iter->first.data(),
+                 stats_iter->first.size());
+    table->field[f++]->store(sql_id_hex_string, MD5_BUFF_LENGTH,
+                             system_charset_info);
+
+    /* DISTINCT_USERS, DISTINCT_HOSTS, DISTINCT_KEYS */
+    hyperloglog_t *sketches[]= { &stats->users, &stats->hosts, &stats->keys };
+    for (hyperloglog_t *sketch : sketches)
+    {
+      hyperloglog_get_registers(sketch, since, registers);
+      table->field[f++]->store(
+        hyperloglog_registers_count(registers, SQL_DISTINCT_STATS_BUCKETS),
+        TRUE);
+    }
+
+    /* LAST_UPDATED */
+    table->field[f++]->store(stats->last_updated, TRUE);
+
+    if (schema_table_store_record(thd, table))
+      result = -1;
+  }
+  mt_unlock(lock_acquired, &LOCK_global_sql_distinct_stats);
+
+  DBUG_RETURN(result);
+}
+
+/***********************************************************************
+          End - Functions to support SQL distinct value statistics
+************************************************************************/
+
 /*
   update_sql_stats_after_statement
     Updates the SQL stats after every SQL statement.
@@ -8718,9 +8718,9 @@ bool mysql_alter_table(THD *thd,char *new_db, char *new_name,
     current format.
   */
 
-  mysql_mutex_lock(&LOCK_global_system_variables);
+  lock_global_system_variables();
   bool check_temporal_upgrade= !avoid_temporal_upgrade;
-  mysql_mutex_unlock(&LOCK_global_system_variables);
+  unlock_global_system_variables();
 
   if (check_temporal_upgrade)
   {
@@ -115,7 +115,7 @@ static bool update_buffer_size(THD *thd, KEY_CACHE *key_cache,
         and clear the old key cache.
       */
       key_cache->in_init= 1;
-      mysql_mutex_unlock(&LOCK_global_system_variables);
+      unlock_global_system_variables();
       key_cache->param_buff_size= 0;
       ha_resize_key_cache(key_cache);
       ha_change_key_cache(key_cache, dflt_key_cache);
@@ -123,7 +123,7 @@ static bool update_buffer_size(THD *thd, KEY_CACHE *key_cache,
         We don't delete the key cache as some running threads my still be in
         the key cache code with a pointer to the deleted (empty) key cache
       */
-      mysql_mutex_lock(&LOCK_global_system_variables);
+      lock_global_system_variables();
       key_cache->in_init= 0;
     }
     return error;
@@ -133,14 +133,14 @@ static bool update_buffer_size(THD *thd, KEY_CACHE *key_cache,
 
   /* If key cache didn't exist initialize it, else resize it */
   key_cache->in_init= 1;
-  mysql_mutex_unlock(&LOCK_global_system_variables);
+  unlock_global_system_variables();
 
   if (!key_cache->key_cache_inited)
     error= ha_init_key_cache(0, key_cache);
   else
     error= ha_resize_key_cache(key_cache);
 
-  mysql_mutex_lock(&LOCK_global_system_variables);
+  lock_global_system_variables();
   key_cache->in_init= 0;
 
   return error;
@@ -155,10 +155,10 @@ static bool update_keycache_param(THD *thd, KEY_CACHE *key_cache,
   keycache_var(key_cache, offset)= new_value;
 
   key_cache->in_init= 1;
-  mysql_mutex_unlock(&LOCK_global_system_variables);
+  unlock_global_system_variables();
   error= ha_resize_key_cache(key_cache);
 
-  mysql_mutex_lock(&LOCK_global_system_variables);
+  lock_global_system_variables();
   key_cache->in_init= 0;
 
   return error;
@@ -1126,6 +1126,17 @@ static Sys_var_mybool Sys_binlog_order_commits(
        GLOBAL_VAR(opt_binlog_order_commits),
        CMD_LINE(OPT_ARG), DEFAULT(TRUE));
 
+static Sys_var_ulong Sys_binlog_group_commit_sync_max_delay(
+       "binlog_group_commit_sync_max_delay",
+       "Upper bound in microseconds on how long the leader of the binlog "
+       "sync stage waits for more transactions to share its fsync. The wait "
+       "is sized from the recent fsync latency and commit arrival rate, and "
+       "skipped when no more commits are expected during an fsync. "
+       "0 disables the wait.",
+       GLOBAL_VAR(opt_binlog_group_commit_sync_max_delay),
+       CMD_LINE(REQUIRED_ARG), VALID_RANGE(0, 1000000), DEFAULT(0),
+       BLOCK_SIZE(1));
+
 #ifdef HAVE_REPLICATION
 static Sys_var_mybool Sys_reset_seconds_behind_master(
        "reset_seconds_behind_master",
@@ -1592,7 +1603,7 @@ static bool event_scheduler_update(sys_var *self, THD *thd, enum_var_type type)
 {
   int err_no= 0;
   uint opt_event_scheduler_value= Events::opt_event_scheduler;
-  mysql_mutex_unlock(&LOCK_global_system_variables);
+  unlock_global_system_variables();
   /*
     Events::start() is heavyweight. In particular it creates a new THD,
     which takes LOCK_global_system_variables internally.
@@ -1612,7 +1623,7 @@ static bool event_scheduler_update(sys_var *self, THD *thd, enum_var_type type)
   bool ret= opt_event_scheduler_value == Events::EVENTS_ON
             ? Events::start(&err_no)
             : Events::stop();
-  mysql_mutex_lock(&LOCK_global_system_variables);
+  lock_global_system_variables();
   if (ret)
   {
     Events::opt_event_scheduler= Events::EVENTS_OFF;
@@ -2778,7 +2789,7 @@ static const char *optimizer_switch_names[]=
   "subquery_materialization_cost_based",
 #endif
   "use_index_extensions", "skip_scan", "skip_scan_cost_based",
-  "multi_range_groupby", "group_by_limit",
+  "multi_range_groupby", "group_by_limit", "hash_join",
   "default", NullS
 };
 /** propagates changes to @@engine_condition_pushdown */
@@ -2802,7 +2813,7 @@ static Sys_var_flagset Sys_optimizer_switch(
        " subquery_materialization_cost_based"
 #endif
        ", block_nested_loop, batched_key_access, use_index_extensions"
-       ", skip_scan, skip_scan_cost_based, multi_range_groupby"
+       ", skip_scan, skip_scan_cost_based, multi_range_groupby, hash_join"
        "} and val is one of {on, off, default}",
        SESSION_VAR(optimizer_switch), CMD_LINE(REQUIRED_ARG),
        optimizer_switch_names, DEFAULT(OPTIMIZER_SWITCH_DEFAULT),
@@ -3036,7 +3047,7 @@ bool fix_read_only(sys_var *self, THD *thd, enum_var_type type)
 
   super_read_only= opt_super_readonly;
   read_only= opt_readonly;
-  mysql_mutex_unlock(&LOCK_global_system_variables);
+  unlock_global_system_variables();
 
   if (legacy_global_read_lock_mode &&
       thd->global_read_lock.lock_global_read_lock(thd)) {
@@ -3055,7 +3066,7 @@ bool fix_read_only(sys_var *self, THD *thd, enum_var_type type)
   /* Release the lock */
   thd->global_read_lock.unlock_global_read_lock(thd);
  end_with_mutex_unlock:
-  mysql_mutex_lock(&LOCK_global_system_variables);
+  lock_global_system_variables();
  end:
   super_read_only= opt_super_readonly;
   read_only= opt_readonly;
@@ -3627,6 +3638,24 @@ static Sys_var_charptr Sys_admission_control_weights(
        NO_MUTEX_GUARD, NOT_IN_BINLOG,
        ON_CHECK(check_admission_control_weights));
 
+static bool update_admission_control_latency_target(sys_var *self, THD *thd,
+                                                   enum_var_type type) {
+  db_ac->update_latency_target(admission_control_latency_target);
+  return false;
+}
+
+static Sys_var_ulong Sys_admission_control_latency_target(
+       "admission_control_latency_target",
+       "Target p99 run time in milliseconds of the queries admitted for a "
+       "database. If set, the running limit of each database is lowered "
+       "below max_running_queries while its p99 is above the target, and "
+       "raised back while it is below. If this value is 0, no such tuning "
+       "is done.",
+       GLOBAL_VAR(admission_control_latency_target), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 3600000), DEFAULT(0), BLOCK_SIZE(1),
+       NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
+       ON_UPDATE(update_admission_control_latency_target));
+
 const char *admission_control_wait_events_names[]=
        {"SLEEP", "ROW_LOCK", "USER_LOCK", "NET_IO", "YIELD", "META_DATA_LOCK", "COMMIT", 0};
 static Sys_var_set Sys_admission_control_wait_events(
@@ -3802,6 +3831,24 @@ static Sys_var_ulong Sys_sort_buffer(
        VALID_RANGE(MIN_SORT_MEMORY, ULONG_MAX), DEFAULT(DEFAULT_SORT_MEMORY),
        BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_filesort_max_threads(
+       "filesort_max_threads",
+       "Maximum number of threads that sort a buffer of a filesort. Sorts "
+       "get one thread per 16384 keys of the buffer, and the threads "
+       "beyond the first one take running slots of the admission control "
+       "entity of the query when there are free ones. 1 sorts on the "
+       "query thread only",
+       SESSION_VAR(filesort_max_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 64), DEFAULT(1), BLOCK_SIZE(1));
+
+static Sys_var_ulong Sys_filesort_worker_threads(
+       "filesort_worker_threads",
+       "Maximum number of worker threads shared by all parallel filesorts. "
+       "When all of them are busy, sorts run their remaining partitions on "
+       "the query thread. Workers idle for a minute exit",
+       GLOBAL_VAR(filesort_worker_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 4096), DEFAULT(64), BLOCK_SIZE(1));
+
 void sql_mode_deprecation_warnings(sql_mode_t sql_mode)
 {
   /**
@@ -5016,12 +5063,12 @@ static bool fix_log(char** logname, const char* default_logname,
       return true;
   }
   logger.lock_exclusive();
-  mysql_mutex_unlock(&LOCK_global_system_variables);
+  unlock_global_system_variables();
   bool error= false;
   if (enabled)
     error= reopen(*logname);
   logger.unlock();
-  mysql_mutex_lock(&LOCK_global_system_variables);
+  lock_global_system_variables();
   return error;
 }
 static bool reopen_general_log(char* name)
@@ -5173,7 +5220,7 @@ static bool fix_log_state(sys_var *self, THD *thd, enum_var_type type)
 
   *newvalptr= oldval; // [de]activate_log_handler works that way (sigh)
 
-  mysql_mutex_unlock(&LOCK_global_system_variables);
+  unlock_global_system_variables();
   if (!newval)
   {
     logger.deactivate_log_handler(thd, log_type);
@@ -5181,7 +5228,7 @@ static bool fix_log_state(sys_var *self, THD *thd, enum_var_type type)
   }
   else
     res= logger.activate_log_handler(thd, log_type);
-  mysql_mutex_lock(&LOCK_global_system_variables);
+  lock_global_system_variables();
   return res;
 }
 
@@ -5339,7 +5386,7 @@ static bool fix_slave_net_timeout(sys_var *self, THD *thd, enum_var_type type)
     locks back again at the end of this function.
    */
   mysql_mutex_unlock(&LOCK_slave_net_timeout);
-  mysql_mutex_unlock(&LOCK_global_system_variables);
+  unlock_global_system_variables();
   mysql_mutex_lock(&LOCK_active_mi);
   DBUG_PRINT("info", ("slave_net_timeout=%u mi->heartbeat_period=%.3f",
                      slave_net_timeout,
@@ -5349,7 +5396,7 @@ static bool fix_slave_net_timeout(sys_var *self, THD *thd, enum_var_type type)
                         ER_SLAVE_HEARTBEAT_VALUE_OUT_OF_RANGE_MAX,
                         ER(ER_SLAVE_HEARTBEAT_VALUE_OUT_OF_RANGE_MAX));
   mysql_mutex_unlock(&LOCK_active_mi);
-  mysql_mutex_lock(&LOCK_global_system_variables);
+  lock_global_system_variables();
   mysql_mutex_lock(&LOCK_slave_net_timeout);
   return false;
 }
@@ -5394,7 +5441,7 @@ static bool fix_slave_skip_counter(sys_var *self, THD *thd, enum_var_type type)
     fix_slave_net_timeout function above
    */
   mysql_mutex_unlock(&LOCK_sql_slave_skip_counter);
-  mysql_mutex_unlock(&LOCK_global_system_variables);
+  unlock_global_system_variables();
   mysql_mutex_lock(&LOCK_active_mi);
   if (active_mi != NULL)
   {
@@ -5413,7 +5460,7 @@ static bool fix_slave_skip_counter(sys_var *self, THD *thd, enum_var_type type)
     mysql_mutex_unlock(&active_mi->rli->run_lock);
   }
   mysql_mutex_unlock(&LOCK_active_mi);
-  mysql_mutex_lock(&LOCK_global_system_variables);
+  lock_global_system_variables();
   mysql_mutex_lock(&LOCK_sql_slave_skip_counter);
   return 0;
 }
@@ -6728,6 +6775,45 @@ static Sys_var_mybool Sys_enable_binlog_hlc(
        CMD_LINE(OPT_ARG), DEFAULT(FALSE),
        NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(check_enable_binlog_hlc));
 
+static bool check_binlog_transaction_dependency_tracking(sys_var *self,
+                                                         THD *thd,
+                                                         set_var *var)
+{
+  if (gtid_mode != GTID_MODE_ON &&
+      var->save_result.ulonglong_value != DEPENDENCY_TRACKING_NONE)
+    return true; // Needs gtid mode to write the dependency interval
+
+  return false;
+}
+
+static const char *binlog_transaction_dependency_tracking_names[]=
+       {"NONE", "WRITESET", "WRITESET_SESSION", NullS};
+
+static Sys_var_enum Sys_binlog_transaction_dependency_tracking(
+       "binlog_transaction_dependency_tracking",
+       "Write the dependency interval (last committed, sequence number) of "
+       "every transaction to the binlog in a Metadata log event, so that "
+       "slaves can apply transactions in parallel. 'WRITESET' makes a "
+       "transaction depend on the last transactions that wrote rows with "
+       "the same unique key values, 'WRITESET_SESSION' also on the previous "
+       "transaction of the same session. 'NONE' disables it. Requires "
+       "gtid_mode=ON.",
+       GLOBAL_VAR(binlog_transaction_dependency_tracking),
+       CMD_LINE(REQUIRED_ARG),
+       binlog_transaction_dependency_tracking_names,
+       DEFAULT(DEPENDENCY_TRACKING_NONE), NO_MUTEX_GUARD, NOT_IN_BINLOG,
+       ON_CHECK(check_binlog_transaction_dependency_tracking));
+
+static Sys_var_ulong Sys_binlog_transaction_dependency_history_size(
+       "binlog_transaction_dependency_history_size",
+       "Maximum number of row hashes kept to compute the dependency "
+       "intervals of binlog_transaction_dependency_tracking. When it is "
+       "full the history is cleared and the next transactions depend on "
+       "all the previous ones.",
+       GLOBAL_VAR(binlog_transaction_dependency_history_size),
+       CMD_LINE(REQUIRED_ARG), VALID_RANGE(1, 1000000), DEFAULT(25000),
+       BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG);
+
 static bool check_maintain_database_hlc(sys_var *self, THD *thd, set_var *var)
 {
   uint64_t new_maintain_db_hlc= var->save_result.ulonglong_value;
@@ -7009,6 +7095,15 @@ static Sys_var_enum Sys_column_stats_control(
         NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(nullptr),
         ON_UPDATE(set_column_stats_control));
 
+static Sys_var_uint Sys_column_stats_sample_rate(
+       "column_stats_sample_rate",
+       "Collect column statistics for a SQL ID that has none yet on one "
+       "out of this many executions of it, chosen at random. "
+       "1 (default) collects them on the first execution.",
+       GLOBAL_VAR(column_stats_sample_rate),
+       CMD_LINE(REQUIRED_ARG), VALID_RANGE(1, UINT_MAX),
+       DEFAULT(1), BLOCK_SIZE(1));
+
 static Sys_var_mybool Sys_use_cached_table_stats_ptr(
        "use_cached_table_stats_ptr",
        "Controls the use of the cached table_stats ptr in the handler object",
@@ -7340,6 +7435,40 @@ static Sys_var_enum Sys_sql_findings_control(
        NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(nullptr),
        ON_UPDATE(set_sql_findings_control));
 
+static bool set_sql_distinct_stats_control(sys_var *, THD *,
+                                           enum_var_type type)
+{
+  if (sql_distinct_stats_control == SQL_INFO_CONTROL_OFF_HARD) {
+    free_global_sql_distinct_stats();
+  }
+
+  return false; // success
+}
+
+static Sys_var_enum Sys_sql_distinct_stats_control(
+       "sql_distinct_stats_control",
+       "Provides a control to estimate the number of distinct users, hosts "
+       "and index lookup keys of every SQL statement. This data is exposed "
+       "through the SQL_DISTINCT_STATISTICS table. "
+       "It accepts the following values: "
+       "OFF_HARD: Default value. Stop collecting the statistics and flush "
+       "all distinct statistics related data from memory. "
+       "OFF_SOFT: Stop collecting the statistics, but retain any data "
+       "collected so far. "
+       "ON: Collect the distinct statistics.",
+       GLOBAL_VAR(sql_distinct_stats_control),
+       CMD_LINE(REQUIRED_ARG),
+       sql_info_control_values, DEFAULT(SQL_INFO_CONTROL_OFF_HARD),
+       NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(nullptr),
+       ON_UPDATE(set_sql_distinct_stats_control));
+
+static Sys_var_uint Sys_sql_distinct_stats_window(
+       "sql_distinct_stats_window",
+       "Number of seconds of history the SQL_DISTINCT_STATISTICS table "
+       "counts distinct values over. 0 counts all values collected so far.",
+       SESSION_VAR(sql_distinct_stats_window), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, UINT_MAX), DEFAULT(3600), BLOCK_SIZE(1));
+
 static const char *audit_fb_json_functions_names[] = {
        "audit_fb_json_contains",
        "audit_fb_json_extract",
@@ -7546,17 +7675,6 @@ static Sys_var_mybool Sys_show_query_digest(
        SESSION_VAR(show_query_digest),
        CMD_LINE(OPT_ARG), DEFAULT(FALSE));
 
-/*
-** sql_maximum_duplicate_executions
-*/
-static bool set_sql_max_dup_exe(sys_var *, THD *, enum_var_type type)
-{
-  if (sql_maximum_duplicate_executions == 0)
-    free_global_active_sql();
-
-  return false; // success
-}
-
 static Sys_var_uint Sys_sql_maximum_duplicate_executions(
        "sql_maximum_duplicate_executions",
        "Used by MySQL to limit the number of duplicate SQL statements "
@@ -7564,7 +7682,7 @@ static Sys_var_uint Sys_sql_maximum_duplicate_executions(
        GLOBAL_VAR(sql_maximum_duplicate_executions),
        CMD_LINE(REQUIRED_ARG), VALID_RANGE(0, UINT_MAX),
        DEFAULT(0), BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG,
-       ON_CHECK(nullptr), ON_UPDATE(set_sql_max_dup_exe));
+       ON_CHECK(nullptr), ON_UPDATE(nullptr));
 
 static Sys_var_enum Sys_sql_duplicate_executions_control(
        "sql_duplicate_executions_control",
@@ -34,6 +34,7 @@
 #include "sql_derived.h"
 #include <m_ctype.h>
 #include "my_md5.h"
+#include "my_murmur3.h"
 #include "my_bit.h"
 #include "sql_select.h"
 #include "mdl.h"                 // MDL_wait_for_graph_visitor
@@ -355,6 +356,7 @@ TABLE_SHARE *alloc_table_share(TABLE_LIST *table_list, const char *key,
     memset(share, 0, sizeof(*share));
 
     share->set_table_cache_key(key_buff, key, key_length);
+    share->distinct_key_seed= murmur3_32((const uchar*) key, key_length, 0);
 
     share->path.str= path_buff;
     share->path.length= path_length;
@@ -736,6 +736,8 @@ struct TABLE_SHARE
     To ensure this one can use set_table_cache() methods.
   */
   LEX_STRING table_cache_key;
+  /* Hash of table_cache_key, see record_distinct_key() in handler.cc */
+  uint32 distinct_key_seed;
   LEX_STRING db;                        /* Pointer to db */
   LEX_STRING table_name;                /* Table name (for open) */
   LEX_STRING path;                	/* Path to .frm file (from datadir) */
@@ -1126,6 +1128,11 @@ private:
   friend class Table_cache_element;
 
 public:
+  /**
+    Index of the Table_cache instance which holds this TABLE object. It is
+    not necessarily the instance of the CPU the owner thread runs on now.
+  */
+  uint cache_index;
 
   THD	*in_use;                        /* Which thread uses this */
   Field **field;			/* Pointer to fields */
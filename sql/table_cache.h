@@ -19,6 +19,7 @@
 #include "my_global.h"
 #include "sql_class.h"
 #include "sql_base.h"
+#include "shardedlocks.h"
 
 /**
   Cache for open TABLE objects.
@@ -27,15 +28,21 @@
   go to a central table definition cache to get a TABLE object and
   therefore don't need to lock LOCK_open mutex.
   Instead they only need to go to one Table_cache instance (the
-  specific instance is determined by thread id) and only lock the
-  mutex protecting this cache.
+  specific instance is determined by the CPU the thread runs on) and
+  only lock the mutex protecting this cache.
   DDL statements that need to remove all TABLE objects from all caches
   need to lock mutexes for all Table_cache instances, but they are rare.
 
-  This significantly increases scalability in some scenarios.
+  This significantly increases scalability in some scenarios. As threads
+  running on the same CPU share an instance, its mutex and the TABLE
+  objects it hands out rarely leave the cache of that CPU, even when
+  many connections open the same hot table.
+
+  Instances are cache line aligned, so that the lock and m_table_count
+  of one instance never share a line with those of its neighbour.
 */
 
-class Table_cache
+class MY_ALIGNED(CPU_LEVEL1_DCACHE_LINESIZE) Table_cache
 {
 private:
   /**
@@ -153,10 +160,30 @@ public:
   bool init();
   void destroy();
 
-  /** Get instance of table cache to be used by particular connection. */
-  Table_cache* get_cache(THD *thd)
+  /**
+    Get instance of table cache to be used by particular connection to
+    open tables, the instance of the CPU it runs on.
+  */
+  Table_cache* get_cache(THD *thd MY_ATTRIBUTE((unused)))
+  {
+    return &m_table_cache[current_cpu_shard() % table_cache_instances];
+  }
+
+  /**
+    Get instance of table cache which holds the TABLE object. The thread
+    which uses it might have moved to another CPU since it opened it.
+  */
+  Table_cache* get_cache(const TABLE *table)
+  {
+    DBUG_ASSERT(table->cache_index < table_cache_instances);
+    return &m_table_cache[table->cache_index];
+  }
+
+  /** Get table cache instance by its index in container. */
+  Table_cache* get_cache(uint index)
   {
-    return &m_table_cache[thd->thread_id() % table_cache_instances];
+    DBUG_ASSERT(index < table_cache_instances);
+    return &m_table_cache[index];
   }
 
   /** Get index for the table cache in container. */
@@ -393,6 +420,7 @@ bool Table_cache::add_used_table(THD *thd, TABLE *table, bool acquire_lock)
 
   /* Add table to the used tables list */
   el->used_tables.push_front(table);
+  table->cache_index= table_cache_manager.cache_index(this);
 
   m_table_count++;
 
@@ -415,6 +443,7 @@ void Table_cache::remove_table(TABLE *table)
     table->s->cache_element[table_cache_manager.cache_index(this)];
 
   assert_owner();
+  DBUG_ASSERT(table->cache_index == table_cache_manager.cache_index(this));
 
   if (table->in_use)
   {
@@ -531,6 +560,7 @@ void Table_cache::release_table(THD *thd, TABLE *table)
 
   assert_owner();
 
+  DBUG_ASSERT(table->cache_index == table_cache_manager.cache_index(this));
   DBUG_ASSERT(table->in_use);
   DBUG_ASSERT(table->file);
 
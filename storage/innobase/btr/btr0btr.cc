@@ -2038,7 +2038,7 @@ btr_page_reorganize(
 	dict_index_t*	index,	/*!< in: the index tree of the page */
 	mtr_t*		mtr)	/*!< in/out: mini-transaction */
 {
-	return(btr_page_reorganize_low(false, page_zip_compression_flags,
+	return(btr_page_reorganize_low(false, page_zip_compression_flags(index),
 				       cursor, index, mtr));
 }
 #endif /* !UNIV_HOTBACKUP */
@@ -2076,7 +2076,7 @@ btr_parse_page_reorganize(
 		ut_a((((int) compression_flags) & (0xF)) <= 9);
 		++ptr;
 	} else {
-		compression_flags = page_zip_compression_flags;
+		compression_flags = page_zip_compression_flags(index);
 	}
 
 	if (block != NULL) {
@@ -5102,7 +5102,8 @@ btr_can_merge_with_page(
 		/* We have to reorganize mpage */
 
 		if (!btr_page_reorganize_block(
-			    false, page_zip_level, mblock, index, mtr)) {
+			    false, page_zip_compression_flags(index),
+			    mblock, index, mtr)) {
 
 			goto error;
 		}
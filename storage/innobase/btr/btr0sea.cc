@@ -44,7 +44,7 @@ Created 2/17/1996 Heikki Tuuri
 #include "ha0ha.h"
 
 /** Flag: has the search system been enabled?
-Protected by btr_search_latch. */
+Protected by all of btr_search_latches. */
 UNIV_INTERN char		btr_search_enabled	= TRUE;
 
 /** A dummy variable to fool the compiler */
@@ -57,20 +57,24 @@ UNIV_INTERN ulint		btr_search_n_succ	= 0;
 UNIV_INTERN ulint		btr_search_n_hash_fail	= 0;
 #endif /* UNIV_SEARCH_PERF_STAT */
 
+/** Number of adaptive hash index partitions */
+UNIV_INTERN ulong		btr_ahi_parts		= 8;
+
 /** padding to prevent other memory update
 hotspots from residing on the same memory
-cache line as btr_search_latch */
+cache line as btr_search_latches */
 UNIV_INTERN byte		btr_sea_pad1[64];
 
-/** The latch protecting the adaptive search system: this latch protects the
-(1) positions of records on those pages where a hash index has been built.
+/** The latches protecting the adaptive search system partitions: the latch
+of a partition protects the (1) positions of records on those pages where a
+hash index of the partition has been built.
 NOTE: It does not protect values of non-ordering fields within a record from
 being updated in-place! We can use fact (1) to perform unique searches to
 indexes. */
 
-/* We will allocate the latch from dynamic memory to get it to the
+/* We will allocate the latches from dynamic memory to get them to the
 same DRAM page as other hotspot semaphores */
-UNIV_INTERN rw_lock_t*		btr_search_latch_temp;
+UNIV_INTERN rw_lock_t**		btr_search_latches;
 
 /** padding to prevent other memory update hotspots from residing on
 the same memory cache line */
@@ -122,18 +126,21 @@ allocate a new node to the hash table, it will succeed. However, the check
 will not guarantee success. */
 static
 void
-btr_search_check_free_space_in_heap(void)
-/*=====================================*/
+btr_search_check_free_space_in_heap(
+/*================================*/
+	const dict_index_t*	index)	/*!< in: index whose hash index
+					partition will be modified */
 {
 	hash_table_t*	table;
 	mem_heap_t*	heap;
+	rw_lock_t*	latch = btr_get_search_latch(index);
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(latch, RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(latch, RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	table = btr_search_sys->hash_index;
+	table = btr_get_search_table(index);
 
 	heap = table->heap;
 
@@ -144,7 +151,7 @@ btr_search_check_free_space_in_heap(void)
 	if (heap->free_block == NULL) {
 		buf_block_t*	block = buf_block_alloc(NULL);
 
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(latch);
 
 		if (btr_search_enabled
 		    && heap->free_block == NULL) {
@@ -153,7 +160,7 @@ btr_search_check_free_space_in_heap(void)
 			buf_block_free(block);
 		}
 
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 	}
 }
 
@@ -165,23 +172,37 @@ btr_search_sys_create(
 /*==================*/
 	ulint	hash_size)	/*!< in: hash index hash table size */
 {
-	/* We allocate the search latch from dynamic memory:
+	ulint	i;
+
+	ut_a(btr_ahi_parts > 0 && btr_ahi_parts <= BTR_AHI_PARTS_MAX);
+
+	/* We allocate the search latches from dynamic memory:
 	see above at the global variable definition */
 
-	btr_search_latch_temp = (rw_lock_t*) mem_alloc(sizeof(rw_lock_t));
+	btr_search_latches = (rw_lock_t**)
+		mem_alloc(btr_ahi_parts * sizeof(rw_lock_t*));
 
-	rw_lock_create(btr_search_latch_key, &btr_search_latch,
-		       SYNC_SEARCH_SYS);
+	for (i = 0; i < btr_ahi_parts; i++) {
+		btr_search_latches[i] = (rw_lock_t*)
+			mem_alloc(sizeof(rw_lock_t));
+
+		rw_lock_create(btr_search_latch_key, btr_search_latches[i],
+			       SYNC_SEARCH_SYS);
+	}
 
 	btr_search_sys = (btr_search_sys_t*)
 		mem_alloc(sizeof(btr_search_sys_t));
 
-	btr_search_sys->hash_index = ha_create(hash_size, 0,
-					MEM_HEAP_FOR_BTR_SEARCH, 0);
+	btr_search_sys->parts = new btr_search_part_t[btr_ahi_parts];
+
+	for (i = 0; i < btr_ahi_parts; i++) {
+		btr_search_sys->parts[i].hash_index = ha_create(
+			hash_size / btr_ahi_parts + 1, 0,
+			MEM_HEAP_FOR_BTR_SEARCH, 0);
 #if defined UNIV_AHI_DEBUG || defined UNIV_DEBUG
-	btr_search_sys->hash_index->adaptive = TRUE;
+		btr_search_sys->parts[i].hash_index->adaptive = TRUE;
 #endif /* UNIV_AHI_DEBUG || UNIV_DEBUG */
-
+	}
 }
 
 /**
@@ -192,10 +213,10 @@ void
 btr_search_sys_resize(
 	ulint	hash_size)
 {
-	rw_lock_x_lock(&btr_search_latch);
+	btr_search_x_lock_all();
 
 	if (btr_search_enabled) {
-		rw_lock_x_unlock(&btr_search_latch);
+		btr_search_x_unlock_all();
 		ib_logf(IB_LOG_LEVEL_ERROR,
 			"btr_search_sys_resize is failed because"
 			" hash index hash table is not empty.");
@@ -203,13 +224,21 @@ btr_search_sys_resize(
 		return;
 	}
 
-	mem_heap_free(btr_search_sys->hash_index->heap);
-	hash_table_free(btr_search_sys->hash_index);
+	for (ulint i = 0; i < btr_ahi_parts; i++) {
+		btr_search_part_t*	part = &btr_search_sys->parts[i];
+
+		mem_heap_free(part->hash_index->heap);
+		hash_table_free(part->hash_index);
 
-	btr_search_sys->hash_index = ha_create(
-		hash_size, 0, MEM_HEAP_FOR_BTR_SEARCH, 0);
+		part->hash_index = ha_create(
+			hash_size / btr_ahi_parts + 1, 0,
+			MEM_HEAP_FOR_BTR_SEARCH, 0);
+#if defined UNIV_AHI_DEBUG || defined UNIV_DEBUG
+		part->hash_index->adaptive = TRUE;
+#endif /* UNIV_AHI_DEBUG || UNIV_DEBUG */
+	}
 
-	rw_lock_x_unlock(&btr_search_latch);
+	btr_search_x_unlock_all();
 }
 
 /*****************************************************************//**
@@ -219,15 +248,84 @@ void
 btr_search_sys_free(void)
 /*=====================*/
 {
-	rw_lock_free(&btr_search_latch);
-	mem_free(btr_search_latch_temp);
-	btr_search_latch_temp = NULL;
-	mem_heap_free(btr_search_sys->hash_index->heap);
-	hash_table_free(btr_search_sys->hash_index);
+	for (ulint i = 0; i < btr_ahi_parts; i++) {
+		rw_lock_free(btr_search_latches[i]);
+		mem_free(btr_search_latches[i]);
+
+		mem_heap_free(btr_search_sys->parts[i].hash_index->heap);
+		hash_table_free(btr_search_sys->parts[i].hash_index);
+	}
+
+	mem_free(btr_search_latches);
+	btr_search_latches = NULL;
+	delete[] btr_search_sys->parts;
 	mem_free(btr_search_sys);
 	btr_search_sys = NULL;
 }
 
+/********************************************************************//**
+X-latches the latches of all adaptive hash index partitions. */
+UNIV_INTERN
+void
+btr_search_x_lock_all(void)
+/*=======================*/
+{
+	for (ulint i = 0; i < btr_ahi_parts; i++) {
+		rw_lock_x_lock(btr_search_latches[i]);
+	}
+}
+
+/********************************************************************//**
+Releases the x-latches of all adaptive hash index partitions. */
+UNIV_INTERN
+void
+btr_search_x_unlock_all(void)
+/*=========================*/
+{
+	for (ulint i = btr_ahi_parts; i--; ) {
+		rw_lock_x_unlock(btr_search_latches[i]);
+	}
+}
+
+#ifdef UNIV_SYNC_DEBUG
+/********************************************************************//**
+Checks if the thread owns the latch of any adaptive hash index partition
+in the given mode.
+@return	TRUE if it owns one */
+UNIV_INTERN
+ibool
+btr_search_own_any(
+/*===============*/
+	ulint	lock_type)	/*!< in: RW_LOCK_SHARED or RW_LOCK_EX */
+{
+	for (ulint i = 0; i < btr_ahi_parts; i++) {
+		if (rw_lock_own(btr_search_latches[i], lock_type)) {
+			return(TRUE);
+		}
+	}
+
+	return(FALSE);
+}
+
+/********************************************************************//**
+Checks if the thread owns the latches of all adaptive hash index
+partitions in exclusive mode.
+@return	TRUE if it owns all of them */
+UNIV_INTERN
+ibool
+btr_search_own_all_x(void)
+/*======================*/
+{
+	for (ulint i = 0; i < btr_ahi_parts; i++) {
+		if (!rw_lock_own(btr_search_latches[i], RW_LOCK_EX)) {
+			return(FALSE);
+		}
+	}
+
+	return(TRUE);
+}
+#endif /* UNIV_SYNC_DEBUG */
+
 /********************************************************************//**
 Set index->ref_count = 0 on all indexes of a table. */
 static
@@ -240,7 +338,7 @@ btr_search_disable_ref_count(
 
 	ut_ad(mutex_own(&dict_sys->mutex));
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(btr_search_own_all_x());
 #endif /* UNIV_SYNC_DEBUG */
 
 	for (index = dict_table_get_first_index(table); index;
@@ -260,11 +358,11 @@ btr_search_disable(void)
 	dict_table_t*	table;
 
 	mutex_enter(&dict_sys->mutex);
-	rw_lock_x_lock(&btr_search_latch);
+	btr_search_x_lock_all();
 
 	if (!btr_search_enabled) {
 		mutex_exit(&dict_sys->mutex);
-		rw_lock_x_unlock(&btr_search_latch);
+		btr_search_x_unlock_all();
 		return;
 	}
 
@@ -290,10 +388,14 @@ btr_search_disable(void)
 	buf_pool_clear_hash_index();
 
 	/* Clear the adaptive hash index. */
-	hash_table_clear(btr_search_sys->hash_index);
-	mem_heap_empty(btr_search_sys->hash_index->heap);
+	for (ulint i = 0; i < btr_ahi_parts; i++) {
+		hash_table_t*	table = btr_search_sys->parts[i].hash_index;
 
-	rw_lock_x_unlock(&btr_search_latch);
+		hash_table_clear(table);
+		mem_heap_empty(table->heap);
+	}
+
+	btr_search_x_unlock_all();
 }
 
 /********************************************************************//**
@@ -310,11 +412,11 @@ btr_search_enable(void)
 	}
 	buf_pool_mutex_exit_all();
 
-	rw_lock_x_lock(&btr_search_latch);
+	btr_search_x_lock_all();
 
 	btr_search_enabled = TRUE;
 
-	rw_lock_x_unlock(&btr_search_latch);
+	btr_search_x_unlock_all();
 }
 
 /*****************************************************************//**
@@ -359,27 +461,29 @@ btr_search_info_create(
 }
 
 /*****************************************************************//**
-Returns the value of ref_count. The value is protected by
-btr_search_latch.
+Returns the value of ref_count. The value is protected by the
+search latch of the index.
 @return	ref_count value. */
 UNIV_INTERN
 ulint
 btr_search_info_get_ref_count(
 /*==========================*/
-	btr_search_t*   info)	/*!< in: search info. */
+	btr_search_t*		info,	/*!< in: search info. */
+	const dict_index_t*	index)	/*!< in: index of info */
 {
-	ulint ret;
+	ulint		ret;
+	rw_lock_t*	latch = btr_get_search_latch(index);
 
 	ut_ad(info);
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(latch, RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(latch, RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	rw_lock_s_lock(&btr_search_latch);
+	rw_lock_s_lock(latch);
 	ret = info->ref_count;
-	rw_lock_s_unlock(&btr_search_latch);
+	rw_lock_s_unlock(latch);
 
 	return(ret);
 }
@@ -399,13 +503,13 @@ btr_search_info_update_hash(
 	ulint		n_unique;
 	int		cmp;
 
+	index = cursor->index;
+
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(btr_get_search_latch(index), RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(btr_get_search_latch(index), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	index = cursor->index;
-
 	if (dict_index_is_ibuf(index)) {
 		/* So many deletes are performed on an insert buffer tree
 		that we do not consider a hash index useful on it: */
@@ -519,8 +623,10 @@ btr_search_update_block_hash_info(
 				/*!< in: cursor */
 {
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	rw_lock_t*	latch = btr_get_search_latch(cursor->index);
+
+	ut_ad(!rw_lock_own(latch, RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(latch, RW_LOCK_EX));
 	ut_ad(rw_lock_own(&block->lock, RW_LOCK_SHARED)
 	      || rw_lock_own(&block->lock, RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
@@ -604,7 +710,7 @@ btr_search_update_hash_ref(
 
 	ut_ad(cursor->flag == BTR_CUR_HASH_FAIL);
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(rw_lock_own(btr_get_search_latch(cursor->index), RW_LOCK_EX));
 	ut_ad(rw_lock_own(&(block->lock), RW_LOCK_SHARED)
 	      || rw_lock_own(&(block->lock), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
@@ -645,10 +751,10 @@ btr_search_update_hash_ref(
 			mem_heap_free(heap);
 		}
 #ifdef UNIV_SYNC_DEBUG
-		ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+		ut_ad(rw_lock_own(btr_get_search_latch(index), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-		ha_insert_for_fold(btr_search_sys->hash_index, fold,
+		ha_insert_for_fold(btr_get_search_table(index), fold,
 				   block, rec);
 
 		MONITOR_INC(MONITOR_ADAPTIVE_HASH_ROW_ADDED);
@@ -668,10 +774,11 @@ btr_search_info_update_slow(
 	ibool		build_index;
 	ulint*		params;
 	ulint*		params2;
+	rw_lock_t*	latch = btr_get_search_latch(cursor->index);
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(latch, RW_LOCK_SHARED));
+	ut_ad(!rw_lock_own(latch, RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
 	block = btr_cur_get_block(cursor);
@@ -687,7 +794,7 @@ btr_search_info_update_slow(
 
 	if (build_index || (cursor->flag == BTR_CUR_HASH_FAIL)) {
 
-		btr_search_check_free_space_in_heap();
+		btr_search_check_free_space_in_heap(cursor->index);
 	}
 
 	if (cursor->flag == BTR_CUR_HASH_FAIL) {
@@ -697,11 +804,11 @@ btr_search_info_update_slow(
 		btr_search_n_hash_fail++;
 #endif /* UNIV_SEARCH_PERF_STAT */
 
-		rw_lock_x_lock(&btr_search_latch);
+		rw_lock_x_lock(latch);
 
 		btr_search_update_hash_ref(info, block, cursor);
 
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 	}
 
 	if (build_index) {
@@ -744,8 +851,8 @@ btr_search_check_guess(
 	btr_cur_t*	cursor,	/*!< in: guessed cursor position */
 	ibool		can_only_compare_to_cursor_rec,
 				/*!< in: if we do not have a latch on the page
-				of cursor, but only a latch on
-				btr_search_latch, then ONLY the columns
+				of cursor, but only the search latch
+				of the index, then ONLY the columns
 				of the record UNDER the cursor are
 				protected, not the next or previous record
 				in the chain: we cannot look at the next or
@@ -900,8 +1007,9 @@ btr_search_guess_on_hash(
 					to protect the record! */
 	btr_cur_t*	cursor,		/*!< out: tree cursor */
 	ulint		has_search_latch,/*!< in: latch mode the caller
-					currently has on btr_search_latch:
-					RW_S_LATCH, RW_X_LATCH, or 0 */
+					currently has on the search latch
+					of index: RW_S_LATCH, RW_X_LATCH,
+					or 0 */
 	mtr_t*		mtr)		/*!< in: mtr */
 {
 	buf_pool_t*	buf_pool;
@@ -909,6 +1017,8 @@ btr_search_guess_on_hash(
 	const rec_t*	rec;
 	ulint		fold;
 	index_id_t	index_id;
+	rw_lock_t*	latch;
+	btr_search_part_t*	part;
 #ifdef notdefined
 	btr_cur_t	cursor2;
 	btr_pcur_t	pcur;
@@ -945,18 +1055,21 @@ btr_search_guess_on_hash(
 	cursor->fold = fold;
 	cursor->flag = BTR_CUR_HASH;
 
+	part = &btr_search_sys->parts[btr_search_get_part_no(index)];
+	latch = btr_get_search_latch(index);
+
 	if (UNIV_LIKELY(!has_search_latch)) {
-		rw_lock_s_lock(&btr_search_latch);
+		rw_lock_s_lock(latch);
 
 		if (UNIV_UNLIKELY(!btr_search_enabled)) {
 			goto failure_unlock;
 		}
 	}
 
-	ut_ad(rw_lock_get_writer(&btr_search_latch) != RW_LOCK_EX);
-	ut_ad(rw_lock_get_reader_count(&btr_search_latch) > 0);
+	ut_ad(rw_lock_get_writer(latch) != RW_LOCK_EX);
+	ut_ad(rw_lock_get_reader_count(latch) > 0);
 
-	rec = (rec_t*) ha_search_and_get_data(btr_search_sys->hash_index, fold);
+	rec = (rec_t*) ha_search_and_get_data(part->hash_index, fold);
 
 	if (UNIV_UNLIKELY(!rec)) {
 		goto failure_unlock;
@@ -974,7 +1087,7 @@ btr_search_guess_on_hash(
 			goto failure_unlock;
 		}
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 
 		buf_block_dbg_add_level(block, SYNC_TREE_NODE_FROM_HASH);
 	}
@@ -996,8 +1109,8 @@ btr_search_guess_on_hash(
 
 	/* Check the validity of the guess within the page */
 
-	/* If we only have the latch on btr_search_latch, not on the
-	page, it only protects the columns of the record the cursor
+	/* If we only have the search latch of the index, not a latch on
+	the page, it only protects the columns of the record the cursor
 	is positioned on. We cannot look at the next of the previous
 	record to determine if our guess for the cursor position is
 	right. */
@@ -1055,6 +1168,8 @@ btr_search_guess_on_hash(
 #ifdef UNIV_SEARCH_PERF_STAT
 	btr_search_n_succ++;
 #endif
+	part->n_hits.inc();
+
 	if (UNIV_LIKELY(!has_search_latch)
 	    && buf_page_peek_if_too_old(&block->page)) {
 
@@ -1071,10 +1186,11 @@ btr_search_guess_on_hash(
 	/*-------------------------------------------*/
 failure_unlock:
 	if (UNIV_LIKELY(!has_search_latch)) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 	}
 failure:
 	cursor->flag = BTR_CUR_HASH_FAIL;
+	part->n_misses.inc();
 
 #ifdef UNIV_SEARCH_PERF_STAT
 	info->n_hash_fail++;
@@ -1119,30 +1235,39 @@ btr_search_drop_page_hash_index(
 	const dict_index_t*	index;
 	ulint*			offsets;
 	btr_search_t*		info;
+	rw_lock_t*		latch;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_SHARED));
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!btr_search_own_any(RW_LOCK_SHARED));
+	ut_ad(!btr_search_own_any(RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
+retry:
 	/* Do a dirty check on block->index, return if the block is
 	not in the adaptive hash index. This is to avoid acquiring
-	shared btr_search_latch for performance consideration. */
-	if (!block->index) {
+	a shared search latch for performance consideration. The
+	index of a hashed block cannot change while we hold a latch
+	or a buffer fix on it, so a non-NULL value tells us which
+	partition latch to take. */
+	index = block->index;
+
+	if (!index) {
 		return;
 	}
 
-retry:
-	rw_lock_s_lock(&btr_search_latch);
-	index = block->index;
+	latch = btr_get_search_latch(index);
+
+	rw_lock_s_lock(latch);
 
-	if (UNIV_LIKELY(!index)) {
+	if (UNIV_UNLIKELY(!block->index)) {
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 
 		return;
 	}
 
+	ut_a(block->index == index);
+
 	ut_a(!dict_index_is_ibuf(index));
 #ifdef UNIV_DEBUG
 	switch (dict_index_get_online_status(index)) {
@@ -1165,7 +1290,7 @@ retry:
 	}
 #endif /* UNIV_DEBUG */
 
-	table = btr_search_sys->hash_index;
+	table = btr_get_search_table(index);
 
 #ifdef UNIV_SYNC_DEBUG
 	ut_ad(rw_lock_own(&(block->lock), RW_LOCK_SHARED)
@@ -1178,10 +1303,10 @@ retry:
 	n_bytes = block->curr_n_bytes;
 
 	/* NOTE: The fields of block must not be accessed after
-	releasing btr_search_latch, as the index page might only
+	releasing the search latch, as the index page might only
 	be s-latched! */
 
-	rw_lock_s_unlock(&btr_search_latch);
+	rw_lock_s_unlock(latch);
 
 	ut_a(n_fields + n_bytes > 0);
 
@@ -1232,7 +1357,7 @@ next_rec:
 		mem_heap_free(heap);
 	}
 
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(latch);
 
 	if (UNIV_UNLIKELY(!block->index)) {
 		/* Someone else has meanwhile dropped the hash index */
@@ -1248,7 +1373,7 @@ next_rec:
 		/* Someone else has meanwhile built a new hash index on the
 		page, with different parameters */
 
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 
 		mem_free(folds);
 		goto retry;
@@ -1279,14 +1404,14 @@ cleanup:
 			"InnoDB: the hash index to a page of %s,"
 			" still %lu hash nodes remain.\n",
 			index->name, (ulong) block->n_pointers);
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 
 		ut_ad(btr_search_validate());
 	} else {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 	}
 #else /* UNIV_AHI_DEBUG || UNIV_DEBUG */
-	rw_lock_x_unlock(&btr_search_latch);
+	rw_lock_x_unlock(latch);
 #endif /* UNIV_AHI_DEBUG || UNIV_DEBUG */
 
 	mem_free(folds);
@@ -1359,36 +1484,39 @@ btr_search_build_page_hash_index(
 	mem_heap_t*	heap		= NULL;
 	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
 	ulint*		offsets		= offsets_;
+	rw_lock_t*	latch;
 	rec_offs_init(offsets_);
 
 	ut_ad(index);
 	ut_a(!dict_index_is_ibuf(index));
 
+	latch = btr_get_search_latch(index);
+
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(!rw_lock_own(latch, RW_LOCK_EX));
 	ut_ad(rw_lock_own(&(block->lock), RW_LOCK_SHARED)
 	      || rw_lock_own(&(block->lock), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	rw_lock_s_lock(&btr_search_latch);
+	rw_lock_s_lock(latch);
 
 	if (!btr_search_enabled) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 		return;
 	}
 
-	table = btr_search_sys->hash_index;
+	table = btr_get_search_table(index);
 	page = buf_block_get_frame(block);
 
 	if (block->index && ((block->curr_n_fields != n_fields)
 			     || (block->curr_n_bytes != n_bytes)
 			     || (block->curr_left_side != left_side))) {
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 
 		btr_search_drop_page_hash_index(block);
 	} else {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 	}
 
 	n_recs = page_get_n_recs(page);
@@ -1482,9 +1610,9 @@ btr_search_build_page_hash_index(
 		fold = next_fold;
 	}
 
-	btr_search_check_free_space_in_heap();
+	btr_search_check_free_space_in_heap(index);
 
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(latch);
 
 	if (UNIV_UNLIKELY(!btr_search_enabled)) {
 		goto exit_func;
@@ -1520,7 +1648,7 @@ btr_search_build_page_hash_index(
 	MONITOR_INC(MONITOR_ADAPTIVE_HASH_PAGE_ADDED);
 	MONITOR_INC_VALUE(MONITOR_ADAPTIVE_HASH_ROW_ADDED, n_cached);
 exit_func:
-	rw_lock_x_unlock(&btr_search_latch);
+	rw_lock_x_unlock(latch);
 
 	mem_free(folds);
 	mem_free(recs);
@@ -1546,16 +1674,17 @@ btr_search_move_or_delete_hash_entries(
 					from this page */
 	dict_index_t*	index)		/*!< in: record descriptor */
 {
-	ulint	n_fields;
-	ulint	n_bytes;
-	ibool	left_side;
+	ulint		n_fields;
+	ulint		n_bytes;
+	ibool		left_side;
+	rw_lock_t*	latch = btr_get_search_latch(index);
 
 #ifdef UNIV_SYNC_DEBUG
 	ut_ad(rw_lock_own(&(block->lock), RW_LOCK_EX));
 	ut_ad(rw_lock_own(&(new_block->lock), RW_LOCK_EX));
 #endif /* UNIV_SYNC_DEBUG */
 
-	rw_lock_s_lock(&btr_search_latch);
+	rw_lock_s_lock(latch);
 
 	ut_a(!new_block->index || new_block->index == index);
 	ut_a(!block->index || block->index == index);
@@ -1564,7 +1693,7 @@ btr_search_move_or_delete_hash_entries(
 
 	if (new_block->index) {
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 
 		btr_search_drop_page_hash_index(block);
 
@@ -1581,7 +1710,7 @@ btr_search_move_or_delete_hash_entries(
 		new_block->n_bytes = block->curr_n_bytes;
 		new_block->left_side = left_side;
 
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(latch);
 
 		ut_a(n_fields + n_bytes > 0);
 
@@ -1593,7 +1722,7 @@ btr_search_move_or_delete_hash_entries(
 		return;
 	}
 
-	rw_lock_s_unlock(&btr_search_latch);
+	rw_lock_s_unlock(latch);
 }
 
 /********************************************************************//**
@@ -1611,6 +1740,7 @@ btr_search_update_hash_on_delete(
 	const rec_t*	rec;
 	ulint		fold;
 	dict_index_t*	index;
+	rw_lock_t*	latch;
 	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
 	mem_heap_t*	heap		= NULL;
 	rec_offs_init(offsets_);
@@ -1632,7 +1762,8 @@ btr_search_update_hash_on_delete(
 	ut_a(block->curr_n_fields + block->curr_n_bytes > 0);
 	ut_a(!dict_index_is_ibuf(index));
 
-	table = btr_search_sys->hash_index;
+	latch = btr_get_search_latch(index);
+	table = btr_get_search_table(index);
 
 	rec = btr_cur_get_rec(cursor);
 
@@ -1643,7 +1774,7 @@ btr_search_update_hash_on_delete(
 		mem_heap_free(heap);
 	}
 
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(latch);
 
 	if (block->index) {
 		ut_a(block->index == index);
@@ -1656,7 +1787,7 @@ btr_search_update_hash_on_delete(
 		}
 	}
 
-	rw_lock_x_unlock(&btr_search_latch);
+	rw_lock_x_unlock(latch);
 }
 
 /********************************************************************//**
@@ -1674,6 +1805,7 @@ btr_search_update_hash_node_on_insert(
 	buf_block_t*	block;
 	dict_index_t*	index;
 	rec_t*		rec;
+	rw_lock_t*	latch;
 
 	rec = btr_cur_get_rec(cursor);
 
@@ -1693,7 +1825,9 @@ btr_search_update_hash_node_on_insert(
 	ut_a(cursor->index == index);
 	ut_a(!dict_index_is_ibuf(index));
 
-	rw_lock_x_lock(&btr_search_latch);
+	latch = btr_get_search_latch(index);
+
+	rw_lock_x_lock(latch);
 
 	if (!block->index) {
 
@@ -1707,7 +1841,7 @@ btr_search_update_hash_node_on_insert(
 	    && (cursor->n_bytes == block->curr_n_bytes)
 	    && !block->curr_left_side) {
 
-		table = btr_search_sys->hash_index;
+		table = btr_get_search_table(index);
 
 		if (ha_search_and_update_if_found(
 			table, cursor->fold, rec, block,
@@ -1716,9 +1850,9 @@ btr_search_update_hash_node_on_insert(
 		}
 
 func_exit:
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 	} else {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 
 		btr_search_update_hash_on_insert(cursor);
 	}
@@ -1748,6 +1882,7 @@ btr_search_update_hash_on_insert(
 	ulint		n_bytes;
 	ibool		left_side;
 	ibool		locked		= FALSE;
+	rw_lock_t*	latch;
 	mem_heap_t*	heap		= NULL;
 	ulint		offsets_[REC_OFFS_NORMAL_SIZE];
 	ulint*		offsets		= offsets_;
@@ -1766,9 +1901,10 @@ btr_search_update_hash_on_insert(
 		return;
 	}
 
-	btr_search_check_free_space_in_heap();
+	btr_search_check_free_space_in_heap(index);
 
-	table = btr_search_sys->hash_index;
+	latch = btr_get_search_latch(index);
+	table = btr_get_search_table(index);
 
 	rec = btr_cur_get_rec(cursor);
 
@@ -1800,7 +1936,7 @@ btr_search_update_hash_on_insert(
 	} else {
 		if (left_side) {
 
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(latch);
 
 			locked = TRUE;
 
@@ -1818,7 +1954,7 @@ btr_search_update_hash_on_insert(
 
 		if (!locked) {
 
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(latch);
 
 			locked = TRUE;
 
@@ -1840,7 +1976,7 @@ check_next_rec:
 		if (!left_side) {
 
 			if (!locked) {
-				rw_lock_x_lock(&btr_search_latch);
+				rw_lock_x_lock(latch);
 
 				locked = TRUE;
 
@@ -1859,7 +1995,7 @@ check_next_rec:
 
 		if (!locked) {
 
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(latch);
 
 			locked = TRUE;
 
@@ -1886,19 +2022,22 @@ function_exit:
 		mem_heap_free(heap);
 	}
 	if (locked) {
-		rw_lock_x_unlock(&btr_search_latch);
+		rw_lock_x_unlock(latch);
 	}
 }
 
 #if defined UNIV_AHI_DEBUG || defined UNIV_DEBUG
 /********************************************************************//**
-Validates the search system.
+Validates one partition of the search system.
 @return	TRUE if ok */
-UNIV_INTERN
+static
 ibool
-btr_search_validate(void)
+btr_search_validate_part(
 /*=====================*/
+	ulint	part_no)	/*!< in: partition number */
 {
+	hash_table_t*	table	= btr_search_sys->parts[part_no].hash_index;
+	rw_lock_t*	latch	= btr_search_latches[part_no];
 	ha_node_t*	node;
 	ulint		n_page_dumps	= 0;
 	ibool		ok		= TRUE;
@@ -1909,29 +2048,29 @@ btr_search_validate(void)
 	ulint*		offsets		= offsets_;
 
 	/* How many cells to check before temporarily releasing
-	btr_search_latch. */
+	the search latch. */
 	ulint		chunk_size = 10000;
 
 	rec_offs_init(offsets_);
 
-	rw_lock_x_lock(&btr_search_latch);
+	rw_lock_x_lock(latch);
 	buf_pool_mutex_enter_all();
 
-	cell_count = hash_get_n_cells(btr_search_sys->hash_index);
+	cell_count = hash_get_n_cells(table);
 
 	for (i = 0; i < cell_count; i++) {
-		/* We release btr_search_latch every once in a while to
+		/* We release the search latch every once in a while to
 		give other queries a chance to run. */
 		if ((i != 0) && ((i % chunk_size) == 0)) {
 			buf_pool_mutex_exit_all();
-			rw_lock_x_unlock(&btr_search_latch);
+			rw_lock_x_unlock(latch);
 			os_thread_yield();
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(latch);
 			buf_pool_mutex_enter_all();
 		}
 
 		node = (ha_node_t*)
-			hash_get_nth_cell(btr_search_sys->hash_index, i)->node;
+			hash_get_nth_cell(table, i)->node;
 
 		for (; node != NULL; node = node->next) {
 			const buf_block_t*	block
@@ -1969,13 +2108,14 @@ btr_search_validate(void)
 				After that, it invokes
 				btr_search_drop_page_hash_index() to
 				remove the block from
-				btr_search_sys->hash_index. */
+				the search system partition. */
 
 				ut_a(buf_block_get_state(block)
 				     == BUF_BLOCK_REMOVE_HASH);
 			}
 
 			ut_a(!dict_index_is_ibuf(block->index));
+			ut_a(btr_search_get_part_no(block->index) == part_no);
 
 			page_index_id = btr_page_get_index_id(block->frame);
 
@@ -2036,27 +2176,46 @@ btr_search_validate(void)
 	for (i = 0; i < cell_count; i += chunk_size) {
 		ulint end_index = ut_min(i + chunk_size - 1, cell_count - 1);
 
-		/* We release btr_search_latch every once in a while to
+		/* We release the search latch every once in a while to
 		give other queries a chance to run. */
 		if (i != 0) {
 			buf_pool_mutex_exit_all();
-			rw_lock_x_unlock(&btr_search_latch);
+			rw_lock_x_unlock(latch);
 			os_thread_yield();
-			rw_lock_x_lock(&btr_search_latch);
+			rw_lock_x_lock(latch);
 			buf_pool_mutex_enter_all();
 		}
 
-		if (!ha_validate(btr_search_sys->hash_index, i, end_index)) {
+		if (!ha_validate(table, i, end_index)) {
 			ok = FALSE;
 		}
 	}
 
 	buf_pool_mutex_exit_all();
-	rw_lock_x_unlock(&btr_search_latch);
+	rw_lock_x_unlock(latch);
 	if (UNIV_LIKELY_NULL(heap)) {
 		mem_heap_free(heap);
 	}
 
 	return(ok);
 }
+
+/********************************************************************//**
+Validates the search system.
+@return	TRUE if ok */
+UNIV_INTERN
+ibool
+btr_search_validate(void)
+/*=====================*/
+{
+	ibool	ok = TRUE;
+
+	for (ulint i = 0; i < btr_ahi_parts; i++) {
+		if (!btr_search_validate_part(i)) {
+			ok = FALSE;
+		}
+	}
+
+	return(ok);
+}
 #endif /* defined UNIV_AHI_DEBUG || defined UNIV_DEBUG */
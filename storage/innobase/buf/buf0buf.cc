@@ -1567,6 +1567,8 @@ buf_pool_init_instance(
 	for (i = BUF_FLUSH_LRU; i < BUF_FLUSH_N_TYPES; i++) {
 		buf_pool->no_flush[i] = os_event_create();
 		buf_pool->n_flushed[i] = 0;
+		buf_pool->n_flush_batches[i] = 0;
+		buf_pool->flush_batch_usec[i] = 0;
 	}
 
 	buf_pool->watch = (buf_page_t*) mem_zalloc(
@@ -2464,12 +2466,15 @@ buf_pool_resize()
 
 	buf_resize_status("Disabling adaptive hash index.");
 
-	rw_lock_s_lock(&btr_search_latch);
+	/* btr_search_enabled is only changed while holding the latches
+	of all adaptive hash index partitions in x-mode, so any one of
+	them protects the read */
+	rw_lock_s_lock(btr_search_latches[0]);
 	if (btr_search_enabled) {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(btr_search_latches[0]);
 		btr_search_disabled = true;
 	} else {
-		rw_lock_s_unlock(&btr_search_latch);
+		rw_lock_s_unlock(btr_search_latches[0]);
 	}
 
 	btr_search_disable();
@@ -3164,7 +3169,7 @@ buf_pool_clear_hash_index(void)
 	ulint	p;
 
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(rw_lock_own(&btr_search_latch, RW_LOCK_EX));
+	ut_ad(btr_search_own_all_x());
 #endif /* UNIV_SYNC_DEBUG */
 	ut_ad(!buf_pool_forbidden);
 	ut_ad(!btr_search_enabled);
@@ -3182,7 +3187,8 @@ buf_pool_clear_hash_index(void)
 				dict_index_t*	index	= block->index;
 
 				/* We can set block->index = NULL
-				when we have an x-latch on btr_search_latch;
+				when we have x-latches on all
+				btr_search_latches;
 				see the comment in buf0buf.h */
 
 				if (!index) {
@@ -31,7 +31,9 @@ Created April 08, 2011 Vasil Dimov
 #include "buf0buf.h" /* buf_pool_mutex_enter(), srv_buf_pool_instances */
 #include "buf0dump.h"
 #include "db0err.h"
+#include "buf0rea.h" /* buf_read_page_async() */
 #include "dict0dict.h" /* dict_operation_lock */
+#include "mach0data.h" /* mach_write_compressed() */
 #include "os0file.h" /* OS_FILE_MAX_PATH */
 #include "os0sync.h" /* os_event* */
 #include "os0thread.h" /* os_thread_* */
@@ -39,6 +41,7 @@ Created April 08, 2011 Vasil Dimov
 #include "srv0start.h" /* srv_shutdown_state */
 #include "sync0rw.h" /* rw_lock_s_lock() */
 #include "ut0byte.h" /* ut_ull_create() */
+#include "ut0crc32.h" /* ut_crc32() */
 #include "ut0sort.h" /* UT_SORT_FUNCTION_BODY */
 
 enum status_severity {
@@ -68,6 +71,52 @@ typedef ib_uint64_t	buf_dump_t;
 #define BUF_DUMP_SPACE(a)		((ulint) ((a) >> 32))
 #define BUF_DUMP_PAGE(a)		((ulint) ((a) & 0xFFFFFFFFUL))
 
+/* The pages of a dump are divided into priority classes, which are loaded
+in order. The pages of the young sublist of the LRU, which have been
+accessed again after innodb_old_blocks_time, make up the first half of the
+classes and the pages of the old sublist the second half, each by their
+position in the sublist. A text dump has no classes, but it lists the
+pages in LRU order, so the classes are taken from the position in the
+file. */
+#define BUF_DUMP_N_CLASSES		16
+
+/* A compact dump starts with the magic below, while a text dump starts
+with a digit. It is followed by sections of pages, one per class and
+buffer pool instance:
+class		the class, mach_write_compressed()
+n_pages		number of pages, mach_write_compressed()
+pages		the pages, sorted on space_no,page_no. The first page of
+		each tablespace is written as a 0, the space id and the
+		page number, the others as the difference to the previous
+		page number, all mach_write_compressed().
+checksum	4 bytes, ut_crc32() of the pages
+The dump ends with a class of BUF_DUMP_N_CLASSES. Loaded pages are
+mostly consecutive, so most of them take a single byte. */
+static const char	buf_dump_magic[] = "IBBPDMP1";
+#define BUF_DUMP_MAGIC_LEN		8
+
+/* Maximum size of a page in a compact dump */
+#define BUF_DUMP_MAX_ENTRY_SIZE		15
+
+/* Pages that a load thread reads at a time. A batch is sorted on
+space_no,page_no, so the simulated AIO handler threads can merge the
+reads of consecutive pages before they are woken up. */
+#define BUF_LOAD_BATCH			64
+
+/* State of a buffer pool load, shared by the load threads */
+struct buf_load_t {
+	const buf_dump_t*	dump;		/*!< the pages to read, in
+						load order */
+	ulint			n_pages;	/*!< number of pages in dump */
+	ulint			next;		/*!< next page to read,
+						updated with atomics */
+	ulint			n_threads;	/*!< number of load threads
+						running, updated with
+						atomics */
+	os_event_t		finished;	/*!< set by the last load
+						thread to finish */
+};
+
 /*****************************************************************//**
 Wakes up the buffer pool dump/load thread and instructs it to start
 a dump. This function is called by MySQL code via buffer_pool_dump_now()
@@ -186,6 +235,107 @@ get_buf_dump_dir()
 	return(dump_dir);
 }
 
+/*****************************************************************//**
+Compare two buffer pool dump entries, used to sort the dump on
+space_no,page_no before loading in order to increase the chance for
+sequential IO.
+@return -1/0/1 if entry 1 is smaller/equal/bigger than entry 2 */
+static
+lint
+buf_dump_cmp(
+/*=========*/
+	const buf_dump_t	d1,	/*!< in: buffer pool dump entry 1 */
+	const buf_dump_t	d2)	/*!< in: buffer pool dump entry 2 */
+{
+	if (d1 < d2) {
+		return(-1);
+	} else if (d1 == d2) {
+		return(0);
+	} else {
+		return(1);
+	}
+}
+
+/*****************************************************************//**
+Sort a buffer pool dump on space_no, page_no. */
+static
+void
+buf_dump_sort(
+/*==========*/
+	buf_dump_t*	dump,	/*!< in/out: buffer pool dump to sort */
+	buf_dump_t*	tmp,	/*!< in/out: temp storage */
+	ulint		low,	/*!< in: lowest index (inclusive) */
+	ulint		high)	/*!< in: highest index (non-inclusive) */
+{
+	UT_SORT_FUNCTION_BODY(buf_dump_sort, dump, tmp, low, high,
+			      buf_dump_cmp);
+}
+
+/*****************************************************************//**
+Returns the position of the first page of a priority class in the dump of
+a buffer pool instance, see BUF_DUMP_N_CLASSES.
+@return position in the dump */
+static
+ulint
+buf_dump_class_start(
+/*=================*/
+	ulint	cls,	/*!< in: class, up to BUF_DUMP_N_CLASSES */
+	ulint	n_young,/*!< in: pages of the young sublist in the dump */
+	ulint	n_old)	/*!< in: pages of the old sublist in the dump */
+{
+	const ulint	half = BUF_DUMP_N_CLASSES / 2;
+
+	if (cls <= half) {
+		return(cls * n_young / half);
+	}
+
+	return(n_young + (cls - half) * n_old / half);
+}
+
+/*****************************************************************//**
+Writes a section of a compact buffer pool dump, see buf_dump_magic.
+@return true on success, false if writing failed */
+static
+bool
+buf_dump_write_section(
+/*===================*/
+	FILE*			f,	/*!< in/out: dump file */
+	ulint			cls,	/*!< in: class of the pages */
+	const buf_dump_t*	dump,	/*!< in: pages, sorted */
+	ulint			n_pages,/*!< in: number of pages */
+	byte*			buf)	/*!< out: buffer of n_pages
+					* BUF_DUMP_MAX_ENTRY_SIZE + 14 bytes */
+{
+	byte*	ptr = buf;
+	byte*	pages;
+	ulint	space_id = ULINT_UNDEFINED;
+	ulint	page_no = 0;
+
+	ptr += mach_write_compressed(ptr, cls);
+	ptr += mach_write_compressed(ptr, n_pages);
+	pages = ptr;
+
+	for (ulint i = 0; i < n_pages; i++) {
+		if (BUF_DUMP_SPACE(dump[i]) != space_id) {
+			space_id = BUF_DUMP_SPACE(dump[i]);
+			page_no = BUF_DUMP_PAGE(dump[i]);
+			ptr += mach_write_compressed(ptr, 0);
+			ptr += mach_write_compressed(ptr, space_id);
+			ptr += mach_write_compressed(ptr, page_no);
+		} else {
+			ut_ad(BUF_DUMP_PAGE(dump[i]) > page_no);
+			ptr += mach_write_compressed(
+				ptr, BUF_DUMP_PAGE(dump[i]) - page_no);
+			page_no = BUF_DUMP_PAGE(dump[i]);
+		}
+	}
+
+	mach_write_to_4(ptr, ut_crc32(pages, ptr - pages));
+	ptr += 4;
+
+	return(fwrite(buf, 1, ptr - buf, f) == (size_t) (ptr - buf));
+}
+
 /*****************************************************************//**
 Perform a buffer pool dump into the file specified by
 innodb_buffer_pool_filename. If any errors occur then the value of
@@ -207,6 +357,8 @@ buf_dump(
 	FILE*	f;
 	ulint	i;
 	int	ret;
+	/* the format can not change in the middle of a dump */
+	const bool	compact = srv_buf_dump_compact;
 
 	ut_snprintf(full_filename, sizeof(full_filename),
 		    "%s%c%s", get_buf_dump_dir(), SRV_PATH_SEPARATOR,
@@ -218,7 +370,7 @@ buf_dump(
 	buf_dump_status(STATUS_NOTICE, "Dumping buffer pool(s) to %s",
 			full_filename);
 
-	f = fopen(tmp_filename, "w");
+	f = fopen(tmp_filename, compact ? "wb" : "w");
 	if (f == NULL) {
 		buf_dump_status(STATUS_ERR,
 				"Cannot open '%s' for writing: %s",
@@ -227,12 +379,26 @@ buf_dump(
 	}
 	/* else */
 
+	if (compact
+	    && fwrite(buf_dump_magic, 1, BUF_DUMP_MAGIC_LEN, f)
+	    != BUF_DUMP_MAGIC_LEN) {
+		fclose(f);
+		buf_dump_status(STATUS_ERR,
+				"Cannot write to '%s': %s",
+				tmp_filename, strerror(errno));
+		/* leave tmp_filename to exist */
+		return;
+	}
+
 	/* walk through each buffer pool */
 	for (i = 0; i < srv_buf_pool_instances && !SHOULD_QUIT(); i++) {
 		buf_pool_t*		buf_pool;
 		const buf_page_t*	bpage;
 		buf_dump_t*		dump;
+		buf_dump_t*		dump_tmp;
+		byte*			buf;
 		ulint			n_pages;
+		ulint			n_young;
 		ulint			j;
 
 		buf_pool = buf_pool_from_array(i);
@@ -249,6 +415,10 @@ buf_dump(
 			continue;
 		}
 
+		/* The old sublist is at the tail of the LRU */
+		n_young = buf_pool->LRU_old != NULL
+			? n_pages - buf_pool->LRU_old_len : n_pages;
+
 		if (srv_buf_pool_dump_pct != 100) {
 			ut_ad(srv_buf_pool_dump_pct < 100);
 
@@ -259,6 +429,8 @@ buf_dump(
 			}
 		}
 
+		n_young = ut_min(n_young, n_pages);
+
 		dump = static_cast<buf_dump_t*>(
 			ut_malloc(n_pages * sizeof(*dump))) ;
 
@@ -287,11 +459,75 @@ buf_dump(
 
 		buf_pool_mutex_exit(buf_pool);
 
-		for (j = 0; j < n_pages && !SHOULD_QUIT(); j++) {
-			ret = fprintf(f, ULINTPF "," ULINTPF "\n",
-				      BUF_DUMP_SPACE(dump[j]),
-				      BUF_DUMP_PAGE(dump[j]));
-			if (ret < 0) {
+		if (!compact) {
+			for (j = 0; j < n_pages && !SHOULD_QUIT(); j++) {
+				ret = fprintf(f, ULINTPF "," ULINTPF "\n",
+					      BUF_DUMP_SPACE(dump[j]),
+					      BUF_DUMP_PAGE(dump[j]));
+				if (ret < 0) {
+					ut_free(dump);
+					fclose(f);
+					buf_dump_status(
+						STATUS_ERR,
+						"Cannot write to '%s': %s",
+						tmp_filename,
+						strerror(errno));
+					/* leave tmp_filename to exist */
+					return;
+				}
+
+				if (j % 128 == 0) {
+					buf_dump_status(
+						STATUS_INFO,
+						"Dumping buffer pool "
+						ULINTPF "/" ULINTPF ", "
+						"page " ULINTPF "/" ULINTPF,
+						i + 1, srv_buf_pool_instances,
+						j + 1, n_pages);
+				}
+			}
+
+			ut_free(dump);
+			continue;
+		}
+
+		dump_tmp = static_cast<buf_dump_t*>(
+			ut_malloc(n_pages * sizeof(*dump_tmp)));
+		buf = static_cast<byte*>(
+			ut_malloc(n_pages * BUF_DUMP_MAX_ENTRY_SIZE + 14));
+
+		if (dump_tmp == NULL || buf == NULL) {
+			ut_free(dump_tmp);
+			ut_free(buf);
+			ut_free(dump);
+			fclose(f);
+			buf_dump_status(STATUS_ERR,
+					"Cannot allocate " ULINTPF " bytes: %s",
+					(ulint) (n_pages * (sizeof(*dump_tmp)
+						 + BUF_DUMP_MAX_ENTRY_SIZE)),
+					strerror(errno));
+			/* leave tmp_filename to exist */
+			return;
+		}
+
+		for (ulint cls = 0;
+		     cls < BUF_DUMP_N_CLASSES && !SHOULD_QUIT();
+		     cls++) {
+			ulint	start = buf_dump_class_start(
+				cls, n_young, n_pages - n_young);
+			ulint	end = buf_dump_class_start(
+				cls + 1, n_young, n_pages - n_young);
+
+			if (start == end) {
+				continue;
+			}
+
+			buf_dump_sort(dump, dump_tmp, start, end);
+
+			if (!buf_dump_write_section(f, cls, dump + start,
+						    end - start, buf)) {
+				ut_free(dump_tmp);
+				ut_free(buf);
 				ut_free(dump);
 				fclose(f);
 				buf_dump_status(STATUS_ERR,
@@ -301,20 +537,34 @@ buf_dump(
 				return;
 			}
 
-			if (j % 128 == 0) {
-				buf_dump_status(
-					STATUS_INFO,
+			buf_dump_status(STATUS_INFO,
 					"Dumping buffer pool "
 					ULINTPF "/" ULINTPF ", "
 					"page " ULINTPF "/" ULINTPF,
 					i + 1, srv_buf_pool_instances,
-					j + 1, n_pages);
-			}
+					end, n_pages);
 		}
 
+		ut_free(dump_tmp);
+		ut_free(buf);
 		ut_free(dump);
 	}
 
+	if (compact) {
+		byte	end_marker[5];
+		ulint	len = mach_write_compressed(end_marker,
+						    BUF_DUMP_N_CLASSES);
+
+		if (fwrite(end_marker, 1, len, f) != len) {
+			fclose(f);
+			buf_dump_status(STATUS_ERR,
+					"Cannot write to '%s': %s",
+					tmp_filename, strerror(errno));
+			/* leave tmp_filename to exist */
+			return;
+		}
+	}
+
 	ret = fclose(f);
 	if (ret != 0) {
 		buf_dump_status(STATUS_ERR,
@@ -354,57 +604,21 @@ buf_dump(
 }
 
 /*****************************************************************//**
-Compare two buffer pool dump entries, used to sort the dump on
-space_no,page_no before loading in order to increase the chance for
-sequential IO.
-@return -1/0/1 if entry 1 is smaller/equal/bigger than entry 2 */
+Reads the pages of a text buffer pool dump, which lists them in LRU order
+as space_no,page_no lines. If any errors occur then the value of
+innodb_buffer_pool_load_status will be set accordingly.
+@return true on success, false on error */
 static
-lint
-buf_dump_cmp(
-/*=========*/
-	const buf_dump_t	d1,	/*!< in: buffer pool dump entry 1 */
-	const buf_dump_t	d2)	/*!< in: buffer pool dump entry 2 */
+bool
+buf_load_read_text(
+/*===============*/
+	FILE*		f,		/*!< in/out: dump file */
+	const char*	full_filename,	/*!< in: name of the dump file */
+	buf_dump_t**	dump_out,	/*!< out: pages, in LRU order, to
+					be freed with ut_free() */
+	ulint*		dump_n_out)	/*!< out: number of pages */
 {
-	if (d1 < d2) {
-		return(-1);
-	} else if (d1 == d2) {
-		return(0);
-	} else {
-		return(1);
-	}
-}
-
-/*****************************************************************//**
-Sort a buffer pool dump on space_no, page_no. */
-static
-void
-buf_dump_sort(
-/*==========*/
-	buf_dump_t*	dump,	/*!< in/out: buffer pool dump to sort */
-	buf_dump_t*	tmp,	/*!< in/out: temp storage */
-	ulint		low,	/*!< in: lowest index (inclusive) */
-	ulint		high)	/*!< in: highest index (non-inclusive) */
-{
-	UT_SORT_FUNCTION_BODY(buf_dump_sort, dump, tmp, low, high,
-			      buf_dump_cmp);
-}
-
-/*****************************************************************//**
-Perform a buffer pool load from the file specified by
-innodb_buffer_pool_filename. If any errors occur then the value of
-innodb_buffer_pool_load_status will be set accordingly, see buf_load_status().
-The dump filename can be specified by (relative to srv_data_home):
-SET GLOBAL innodb_buffer_pool_filename='filename'; */
-static
-void
-buf_load()
-/*======*/
-{
-	char		full_filename[OS_FILE_MAX_PATH];
-	char		now[32];
-	FILE*		f;
 	buf_dump_t*	dump;
-	buf_dump_t*	dump_tmp;
 	ulint		dump_n;
 	ulint		total_buffer_pools_pages;
 	ulint		i;
@@ -412,25 +626,6 @@ buf_load()
 	ulint		page_no;
 	int		fscanf_ret;
 
-	/* Ignore any leftovers from before */
-	buf_load_abort_flag = FALSE;
-
-	ut_snprintf(full_filename, sizeof(full_filename),
-		    "%s%c%s", get_buf_dump_dir(), SRV_PATH_SEPARATOR,
-		    srv_buf_dump_filename);
-
-	buf_load_status(STATUS_NOTICE,
-			"Loading buffer pool(s) from %s", full_filename);
-
-	f = fopen(full_filename, "r");
-	if (f == NULL) {
-		buf_load_status(STATUS_ERR,
-				"Cannot open '%s' for reading: %s",
-				full_filename, strerror(errno));
-		return;
-	}
-	/* else */
-
 	/* First scan the file to estimate how many entries are in it.
 	This file is tiny (approx 500KB per 1GB buffer pool), reading it
 	two times is fine. */
@@ -448,11 +643,10 @@ buf_load()
 		} else {
 			what = "parsing";
 		}
-		fclose(f);
 		buf_load_status(STATUS_ERR, "Error %s '%s', "
 				"unable to load buffer pool (stage 1)",
 				what, full_filename);
-		return;
+		return(false);
 	}
 
 	/* If dump is larger than the buffer pool(s), then we ignore the
@@ -467,25 +661,11 @@ buf_load()
 	dump = static_cast<buf_dump_t*>(ut_malloc(dump_n * sizeof(*dump)));
 
 	if (dump == NULL) {
-		fclose(f);
 		buf_load_status(STATUS_ERR,
 				"Cannot allocate " ULINTPF " bytes: %s",
 				(ulint) (dump_n * sizeof(*dump)),
 				strerror(errno));
-		return;
-	}
-
-	dump_tmp = static_cast<buf_dump_t*>(
-		ut_malloc(dump_n * sizeof(*dump_tmp)));
-
-	if (dump_tmp == NULL) {
-		ut_free(dump);
-		fclose(f);
-		buf_load_status(STATUS_ERR,
-				"Cannot allocate " ULINTPF " bytes: %s",
-				(ulint) (dump_n * sizeof(*dump_tmp)),
-				strerror(errno));
-		return;
+		return(false);
 	}
 
 	rewind(f);
@@ -501,19 +681,15 @@ buf_load()
 			/* else */
 
 			ut_free(dump);
-			ut_free(dump_tmp);
-			fclose(f);
 			buf_load_status(STATUS_ERR,
 					"Error parsing '%s', unable "
 					"to load buffer pool (stage 2)",
 					full_filename);
-			return;
+			return(false);
 		}
 
 		if (space_id > ULINT32_MASK || page_no > ULINT32_MASK) {
 			ut_free(dump);
-			ut_free(dump_tmp);
-			fclose(f);
 			buf_load_status(STATUS_ERR,
 					"Error parsing '%s': bogus "
 					"space,page " ULINTPF "," ULINTPF
@@ -522,7 +698,7 @@ buf_load()
 					full_filename,
 					space_id, page_no,
 					i);
-			return;
+			return(false);
 		}
 
 		dump[i] = BUF_DUMP_CREATE(space_id, page_no);
@@ -531,10 +707,329 @@ buf_load()
 	/* Set dump_n to the actual number of initialized elements,
 	i could be smaller than dump_n here if the file got truncated after
 	we read it the first time. */
-	dump_n = i;
+	*dump_out = dump;
+	*dump_n_out = i;
+
+	return(true);
+}
+
+/*****************************************************************//**
+Parses the sections of a compact buffer pool dump, see buf_dump_magic.
+@return true on success, false if the dump is corrupted */
+static
+bool
+buf_load_parse_compact(
+/*===================*/
+	byte*		ptr,		/*!< in: sections of the dump */
+	byte*		end_ptr,	/*!< in: end of the dump */
+	ulint*		class_n,	/*!< in/out: number of pages of
+					each class, incremented */
+	buf_dump_t*	dump,		/*!< out: pages, or NULL to only
+					count them */
+	ulint*		class_pos)	/*!< in/out: where to store the next
+					page of each class in dump, or NULL */
+{
+	for (;;) {
+		ulint	cls;
+		ulint	n_pages;
+		ulint	space_id = ULINT_UNDEFINED;
+		ulint	page_no = 0;
+		byte*	pages;
+
+		ptr = mach_parse_compressed(ptr, end_ptr, &cls);
+
+		if (ptr == NULL || cls > BUF_DUMP_N_CLASSES) {
+			return(false);
+		} else if (cls == BUF_DUMP_N_CLASSES) {
+			/* the end marker must end the file */
+			return(ptr == end_ptr);
+		}
+
+		ptr = mach_parse_compressed(ptr, end_ptr, &n_pages);
+
+		if (ptr == NULL) {
+			return(false);
+		}
+
+		pages = ptr;
+
+		for (ulint i = 0; i < n_pages; i++) {
+			ulint	delta;
+
+			ptr = mach_parse_compressed(ptr, end_ptr, &delta);
+
+			if (ptr == NULL) {
+				return(false);
+			} else if (delta == 0) {
+				/* the first page of a tablespace */
+				ptr = mach_parse_compressed(
+					ptr, end_ptr, &space_id);
+				if (ptr == NULL) {
+					return(false);
+				}
+				ptr = mach_parse_compressed(
+					ptr, end_ptr, &page_no);
+				if (ptr == NULL) {
+					return(false);
+				}
+			} else if (space_id == ULINT_UNDEFINED
+				   || page_no + delta > ULINT32_MASK) {
+				return(false);
+			} else {
+				page_no += delta;
+			}
+
+			if (dump != NULL) {
+				dump[class_pos[cls]++] = BUF_DUMP_CREATE(
+					space_id, page_no);
+			}
+		}
+
+		if (end_ptr - ptr < 4
+		    || mach_read_from_4(ptr) != ut_crc32(pages, ptr - pages)) {
+			return(false);
+		}
+
+		ptr += 4;
+		class_n[cls] += n_pages;
+	}
+}
+
+/*****************************************************************//**
+Reads the pages of a compact buffer pool dump, whose magic has been read
+already. If any errors occur then the value of
+innodb_buffer_pool_load_status will be set accordingly.
+@return true on success, false on error */
+static
+bool
+buf_load_read_compact(
+/*==================*/
+	FILE*		f,		/*!< in/out: dump file */
+	const char*	full_filename,	/*!< in: name of the dump file */
+	buf_dump_t**	dump_out,	/*!< out: pages, by class, to be
+					freed with ut_free() */
+	ulint*		dump_n_out,	/*!< out: number of pages */
+	ulint*		class_start)	/*!< out: position of the first
+					page of each class in dump, and
+					dump_n_out at the end */
+{
+	ulint		class_n[BUF_DUMP_N_CLASSES];
+	ulint		class_pos[BUF_DUMP_N_CLASSES];
+	buf_dump_t*	dump;
+	ulint		dump_n;
+	ulint		total_buffer_pools_pages;
+	byte*		buf;
+	long		size;
+
+	if (fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) < 0
+	    || fseek(f, BUF_DUMP_MAGIC_LEN, SEEK_SET) != 0) {
+		buf_load_status(STATUS_ERR, "Error reading '%s', "
+				"unable to load buffer pool: %s",
+				full_filename, strerror(errno));
+		return(false);
+	}
+
+	size -= BUF_DUMP_MAGIC_LEN;
+
+	buf = static_cast<byte*>(ut_malloc(size));
+
+	if (buf == NULL) {
+		buf_load_status(STATUS_ERR,
+				"Cannot allocate " ULINTPF " bytes: %s",
+				(ulint) size, strerror(errno));
+		return(false);
+	}
+
+	if (fread(buf, 1, size, f) != (size_t) size) {
+		ut_free(buf);
+		buf_load_status(STATUS_ERR, "Error reading '%s', "
+				"unable to load buffer pool", full_filename);
+		return(false);
+	}
+
+	memset(class_n, 0, sizeof(class_n));
+
+	if (!buf_load_parse_compact(buf, buf + size, class_n, NULL, NULL)) {
+		ut_free(buf);
+		buf_load_status(STATUS_ERR,
+				"Error parsing '%s', unable "
+				"to load buffer pool (corrupted)",
+				full_filename);
+		return(false);
+	}
+
+	dump_n = 0;
+	for (ulint cls = 0; cls < BUF_DUMP_N_CLASSES; cls++) {
+		class_pos[cls] = class_start[cls] = dump_n;
+		dump_n += class_n[cls];
+	}
+
+	dump = static_cast<buf_dump_t*>(ut_malloc(dump_n * sizeof(*dump)));
+
+	if (dump == NULL) {
+		ut_free(buf);
+		buf_load_status(STATUS_ERR,
+				"Cannot allocate " ULINTPF " bytes: %s",
+				(ulint) (dump_n * sizeof(*dump)),
+				strerror(errno));
+		return(false);
+	}
+
+	memset(class_n, 0, sizeof(class_n));
+
+	ut_a(buf_load_parse_compact(buf, buf + size, class_n, dump,
+				    class_pos));
+
+	ut_free(buf);
+
+	/* If dump is larger than the buffer pool(s), then we ignore the
+	coldest pages. This could happen if a dump is made, then buffer
+	pool is shrunk and then load it attempted. */
+	total_buffer_pools_pages = buf_pool_get_n_pages()
+		* srv_buf_pool_instances;
+	if (dump_n > total_buffer_pools_pages) {
+		dump_n = total_buffer_pools_pages;
+	}
+
+	for (ulint cls = 0; cls < BUF_DUMP_N_CLASSES; cls++) {
+		class_start[cls] = ut_min(class_start[cls], dump_n);
+	}
+
+	class_start[BUF_DUMP_N_CLASSES] = dump_n;
+	*dump_out = dump;
+	*dump_n_out = dump_n;
+
+	return(true);
+}
+
+/*****************************************************************//**
+Issues asynchronous reads for the next batch of pages of a buffer pool
+load.
+@return false if there are no more pages to read or the load should stop */
+static
+bool
+buf_load_batch(
+/*===========*/
+	buf_load_t*	load)	/*!< in/out: buffer pool load */
+{
+	ulint	begin;
+	ulint	end;
+
+	if (buf_load_abort_flag || SHUTTING_DOWN()) {
+		return(false);
+	}
+
+	end = os_atomic_increment_ulint(&load->next, BUF_LOAD_BATCH);
+	begin = end - BUF_LOAD_BATCH;
+
+	if (begin >= load->n_pages) {
+		return(false);
+	}
+
+	end = ut_min(end, load->n_pages);
+
+	for (ulint i = begin; i < end; i++) {
+		buf_read_page_async(BUF_DUMP_SPACE(load->dump[i]),
+				    BUF_DUMP_PAGE(load->dump[i]));
+	}
+
+	os_aio_simulated_wake_handler_threads();
+
+	return(true);
+}
+
+/*****************************************************************//**
+A buffer pool load thread. It reads batches of pages along with the
+buffer pool dump/load thread, until all the pages of the load have been
+read. There are innodb_buffer_pool_load_threads - 1 of these threads for
+each load.
+@return a dummy parameter */
+extern "C"
+os_thread_ret_t
+DECLARE_THREAD(buf_load_thread)(
+/*============================*/
+	void*	arg)	/*!< in/out: buf_load_t of the load */
+{
+	buf_load_t*	load = static_cast<buf_load_t*>(arg);
+
+	while (buf_load_batch(load)) {}
+
+	if (os_atomic_decrement_ulint(&load->n_threads, 1) == 0) {
+		os_event_set(load->finished);
+	}
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/*****************************************************************//**
+Perform a buffer pool load from the file specified by
+innodb_buffer_pool_filename. If any errors occur then the value of
+innodb_buffer_pool_load_status will be set accordingly, see buf_load_status().
+The hottest pages are read first, see BUF_DUMP_N_CLASSES, and the pages
+are read by innodb_buffer_pool_load_threads threads.
+The dump filename can be specified by (relative to srv_data_home):
+SET GLOBAL innodb_buffer_pool_filename='filename'; */
+static
+void
+buf_load()
+/*======*/
+{
+	char		full_filename[OS_FILE_MAX_PATH];
+	char		magic[BUF_DUMP_MAGIC_LEN];
+	char		now[32];
+	FILE*		f;
+	buf_dump_t*	dump;
+	buf_dump_t*	dump_tmp;
+	ulint		dump_n;
+	ulint		class_start[BUF_DUMP_N_CLASSES + 1];
+	buf_load_t	load;
+	bool		success;
+
+	/* Ignore any leftovers from before */
+	buf_load_abort_flag = FALSE;
+
+	ut_snprintf(full_filename, sizeof(full_filename),
+		    "%s%c%s", get_buf_dump_dir(), SRV_PATH_SEPARATOR,
+		    srv_buf_dump_filename);
+
+	buf_load_status(STATUS_NOTICE,
+			"Loading buffer pool(s) from %s", full_filename);
+
+	f = fopen(full_filename, "rb");
+	if (f == NULL) {
+		buf_load_status(STATUS_ERR,
+				"Cannot open '%s' for reading: %s",
+				full_filename, strerror(errno));
+		return;
+	}
+	/* else */
+
+	if (fread(magic, 1, sizeof(magic), f) == sizeof(magic)
+	    && memcmp(magic, buf_dump_magic, sizeof(magic)) == 0) {
+		success = buf_load_read_compact(f, full_filename, &dump,
+						&dump_n, class_start);
+	} else {
+		rewind(f);
+		success = buf_load_read_text(f, full_filename, &dump,
+					     &dump_n);
+
+		/* The pages are in LRU order */
+		for (ulint cls = 0; success && cls <= BUF_DUMP_N_CLASSES;
+		     cls++) {
+			class_start[cls] = cls * dump_n / BUF_DUMP_N_CLASSES;
+		}
+	}
 
 	fclose(f);
 
+	if (!success) {
+		return;
+	}
+
 	if (dump_n == 0) {
 		ut_free(dump);
 		ut_sprintf_timestamp(now);
@@ -544,39 +1039,61 @@ buf_load()
 		return;
 	}
 
-	if (!SHUTTING_DOWN()) {
-		buf_dump_sort(dump, dump_tmp, 0, dump_n);
+	dump_tmp = static_cast<buf_dump_t*>(
+		ut_malloc(dump_n * sizeof(*dump_tmp)));
+
+	if (dump_tmp == NULL) {
+		ut_free(dump);
+		buf_load_status(STATUS_ERR,
+				"Cannot allocate " ULINTPF " bytes: %s",
+				(ulint) (dump_n * sizeof(*dump_tmp)),
+				strerror(errno));
+		return;
+	}
+
+	/* Sort each class on space_no,page_no, in order to increase the
+	chance for sequential IO. */
+	for (ulint cls = 0; cls < BUF_DUMP_N_CLASSES && !SHUTTING_DOWN();
+	     cls++) {
+		if (class_start[cls] < class_start[cls + 1]) {
+			buf_dump_sort(dump, dump_tmp, class_start[cls],
+				      class_start[cls + 1]);
+		}
 	}
 
 	ut_free(dump_tmp);
 
-	for (i = 0; i < dump_n && !SHUTTING_DOWN(); i++) {
+	load.dump = dump;
+	load.n_pages = dump_n;
+	load.next = 0;
+	load.n_threads = ut_max(srv_buf_load_threads, 1UL);
+	load.finished = os_event_create();
 
-		buf_read_page_async(BUF_DUMP_SPACE(dump[i]),
-				    BUF_DUMP_PAGE(dump[i]));
-
-		if (i % 64 == 63) {
-			os_aio_simulated_wake_handler_threads();
-		}
+	for (ulint i = 1; i < load.n_threads; i++) {
+		os_thread_create(buf_load_thread, &load, NULL);
+	}
 
-		if (i % 128 == 0) {
-			buf_load_status(STATUS_INFO,
-					"Loaded " ULINTPF "/" ULINTPF " pages",
-					i + 1, dump_n);
-		}
+	while (buf_load_batch(&load)) {
+		buf_load_status(STATUS_INFO,
+				"Loaded " ULINTPF "/" ULINTPF " pages",
+				ut_min(load.next, dump_n), dump_n);
+	}
 
-		if (buf_load_abort_flag) {
-			buf_load_abort_flag = FALSE;
-			ut_free(dump);
-			buf_load_status(
-				STATUS_NOTICE,
-				"Buffer pool(s) load aborted on request");
-			return;
-		}
+	if (os_atomic_decrement_ulint(&load.n_threads, 1) > 0) {
+		os_event_wait(load.finished);
 	}
 
+	os_event_free(load.finished);
 	ut_free(dump);
 
+	if (buf_load_abort_flag) {
+		buf_load_abort_flag = FALSE;
+		buf_load_status(
+			STATUS_NOTICE,
+			"Buffer pool(s) load aborted on request");
+		return;
+	}
+
 	ut_sprintf_timestamp(now);
 
 	buf_load_status(STATUS_NOTICE,
@@ -620,9 +1137,20 @@ DECLARE_THREAD(buf_dump_thread)(
 	}
 
 	while (!SHUTTING_DOWN()) {
+		ulong	interval = srv_buf_dump_interval;
+
 		buf_pool_resizable_dump = true;
 
-		os_event_wait(srv_buf_dump_event);
+		if (interval == 0) {
+			os_event_wait(srv_buf_dump_event);
+		} else if (os_event_wait_time(srv_buf_dump_event,
+					      interval * 1000000)
+			   == OS_SYNC_TIME_EXCEEDED
+			   && !SHUTTING_DOWN()) {
+			/* Take a dump every innodb_buffer_pool_dump_interval
+			seconds */
+			buf_dump_should_start = TRUE;
+		}
 
 		if (buf_pool_resizing) {
 			os_event_wait(buf_pool_resized_event);
@@ -64,11 +64,73 @@ UNIV_INTERN ibool buf_lru_manager_is_active = FALSE;
 #ifdef UNIV_PFS_THREAD
 UNIV_INTERN mysql_pfs_key_t buf_page_cleaner_thread_key;
 UNIV_INTERN mysql_pfs_key_t buf_lru_manager_thread_key;
+UNIV_INTERN mysql_pfs_key_t buf_page_cleaner_worker_thread_key;
 #endif /* UNIV_PFS_THREAD */
 
+#ifdef UNIV_PFS_MUTEX
+UNIV_INTERN mysql_pfs_key_t page_cleaner_mutex_key;
+#endif /* UNIV_PFS_MUTEX */
+
 /** Event to synchronise with the flushing. */
  os_event_t	buf_lru_event;
 
+/** State of a buffer pool instance in a parallel flush request */
+enum page_cleaner_state_t {
+	PAGE_CLEANER_STATE_NONE = 0,	/*!< no batch requested */
+	PAGE_CLEANER_STATE_REQUESTED,	/*!< batch requested, not started */
+	PAGE_CLEANER_STATE_FLUSHING,	/*!< batch running */
+	PAGE_CLEANER_STATE_FINISHED	/*!< batch done */
+};
+
+/** Batch requested on one buffer pool instance */
+struct page_cleaner_slot_t {
+	page_cleaner_state_t	state;	/*!< protected by
+					page_cleaner->mutex */
+	ulint		min_n;		/*!< in: wished number of pages to
+					flush in a flush list batch */
+	lsn_t		lsn_limit;	/*!< in: flush list batch limit */
+	lsn_t		redo_age;	/*!< redo log held back by the
+					oldest dirty page of the instance
+					when the batch was requested */
+	bool		success;	/*!< out: false if another batch of
+					the same type was running */
+	ulint		n_flushed;	/*!< out: number of pages flushed */
+	ulint		n_evicted;	/*!< out: number of pages evicted
+					by an LRU batch */
+};
+
+/** Batches of one flush type requested on all buffer pool instances.
+The fields other than the slots are protected by page_cleaner->mutex. */
+struct page_cleaner_request_t {
+	page_cleaner_slot_t*	slots;	/*!< one slot per buffer pool
+					instance */
+	ulint		n_requested;	/*!< number of slots in the
+					REQUESTED state */
+	ulint		n_flushing;	/*!< number of slots in the
+					FLUSHING state */
+	ulint		next_slot;	/*!< the next slot to start */
+	os_event_t	finished;	/*!< set when all the batches of
+					the request are done */
+};
+
+/** Page cleaner coordination. The page_cleaner thread requests flush
+list batches and the lru_manager thread LRU batches, each on all the
+buffer pool instances at once. The requesting thread and the page
+cleaner workers then run the batches, one instance each at a time.
+Because the requesting thread takes part, a request completes even
+when there are no workers. */
+struct page_cleaner_t {
+	ib_mutex_t	mutex;		/*!< mutex protecting the
+					requests */
+	os_event_t	is_requested;	/*!< set when a request is
+					posted, and at shutdown */
+	page_cleaner_request_t	requests[BUF_FLUSH_N_TYPES];
+					/*!< the BUF_FLUSH_LRU and
+					BUF_FLUSH_LIST requests */
+};
+
+static page_cleaner_t*	page_cleaner = NULL;
+
 /** If LRU list of a buf_pool is less than this size then LRU eviction
 should not happen. This is because when we do LRU flushing we also put
 the blocks on free list. If LRU list is very small then we can end up
@@ -1676,8 +1738,10 @@ buf_flush_batch(
 					min_n), otherwise ignored */
 {
 	std::pair<ulint, ulint>	res;
+	ullint			start_time = ut_time_us(NULL);
 
 	ut_ad(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST);
+	ut_ad(buf_pool->init_flush[flush_type]);
 #ifdef UNIV_SYNC_DEBUG
 	ut_ad((flush_type != BUF_FLUSH_LIST)
 	      || sync_thread_levels_empty_except_dict());
@@ -1701,6 +1765,10 @@ buf_flush_batch(
 
 	buf_pool_mutex_exit(buf_pool);
 
+	buf_pool->n_flush_batches[flush_type]++;
+	buf_pool->flush_batch_usec[flush_type] +=
+		ut_time_us(NULL) - start_time;
+
 #ifdef UNIV_DEBUG
 	if (buf_debug_prints && res.first > 0) {
 		fprintf(stderr, flush_type == BUF_FLUSH_LRU
@@ -1875,6 +1943,54 @@ buf_flush_do_batch(
 	return(true);
 }
 
+/*******************************************************************//**
+Flushes dirty blocks from the end of the flush list of a buffer pool
+instance.
+NOTE: The calling thread is not allowed to own any latches on pages!
+@return false if another flush list batch was already running in the
+instance */
+static
+bool
+buf_flush_list_one(
+/*===============*/
+	buf_pool_t*	buf_pool,	/*!< in/out: buffer pool instance */
+	ulint		min_n,		/*!< in: wished minimum mumber of blocks
+					flushed (it is not guaranteed that the
+					actual number is that big, though) */
+	lsn_t		lsn_limit,	/*!< in: all blocks whose
+					oldest_modification is smaller than
+					this should be flushed (if their
+					number does not exceed min_n) */
+	ulint*		n_processed)	/*!< out: the number of pages
+					which were processed */
+{
+	std::pair<ulint, ulint>	res;
+
+	*n_processed = 0;
+
+	if (!buf_flush_start(buf_pool, BUF_FLUSH_LIST)) {
+		return(false);
+	}
+
+	res = buf_flush_batch(buf_pool, BUF_FLUSH_LIST, min_n, lsn_limit);
+
+	buf_flush_end(buf_pool, BUF_FLUSH_LIST);
+
+	buf_flush_common(BUF_FLUSH_LIST, res.first);
+
+	*n_processed = res.first;
+
+	if (res.first) {
+		MONITOR_INC_VALUE_CUMULATIVE(
+			MONITOR_FLUSH_BATCH_TOTAL_PAGE,
+			MONITOR_FLUSH_BATCH_COUNT,
+			MONITOR_FLUSH_BATCH_PAGES,
+			res.first);
+	}
+
+	return(true);
+}
+
 /*******************************************************************//**
 This utility flushes dirty blocks from the end of the flush list of
 all buffer pool instances.
@@ -1917,12 +2033,10 @@ buf_flush_list(
 
 	/* Flush to lsn_limit in all buffer pool instances */
 	for (i = 0; i < srv_buf_pool_instances; i++) {
-		buf_pool_t*		buf_pool;
-		std::pair<ulint, ulint>	res;
-
-		buf_pool = buf_pool_from_array(i);
+		ulint	n_flushed;
 
-		if (!buf_flush_start(buf_pool, BUF_FLUSH_LIST)) {
+		if (!buf_flush_list_one(buf_pool_from_array(i),
+					min_n, lsn_limit, &n_flushed)) {
 			/* We have two choices here. If lsn_limit was
 			specified then skipping an instance of buffer
 			pool means we cannot guarantee that all pages
@@ -1938,23 +2052,8 @@ buf_flush_list(
 			continue;
 		}
 
-		res = buf_flush_batch(
-			buf_pool, BUF_FLUSH_LIST, min_n, lsn_limit);
-
-		buf_flush_end(buf_pool, BUF_FLUSH_LIST);
-
-		buf_flush_common(BUF_FLUSH_LIST, res.first);
-
 		if (n_processed) {
-			*n_processed += res.first;
-		}
-
-		if (res.first) {
-			MONITOR_INC_VALUE_CUMULATIVE(
-				MONITOR_FLUSH_BATCH_TOTAL_PAGE,
-				MONITOR_FLUSH_BATCH_COUNT,
-				MONITOR_FLUSH_BATCH_PAGES,
-				res.first);
+			*n_processed += n_flushed;
 		}
 	}
 
@@ -2111,6 +2210,70 @@ buf_flush_LRU_lists(void)
 	return(n_flushed);
 }
 
+/*********************************************************************//**
+Clears up tail of the LRU list of a buffer pool instance:
+* Put replaceable pages at the tail of LRU to the free list
+* Flush dirty pages at the tail of LRU to the disk
+The depth to which we scan the buffer pool is controlled by dynamic
+config parameter innodb_LRU_scan_depth.
+@return false if an LRU batch was already running in the instance */
+static
+bool
+buf_flush_LRU_tail_one(
+/*===================*/
+	buf_pool_t*	buf_pool,	/*!< in/out: buffer pool instance */
+	ulint*		n_flushed,	/*!< out: pages flushed */
+	ulint*		n_evicted)	/*!< out: pages evicted */
+{
+	std::pair<ulint, ulint>	res;
+	ulint			scan_depth;
+
+	*n_flushed = *n_evicted = 0;
+
+	/* srv_LRU_scan_depth can be arbitrarily large value.
+	We cap it with current LRU size. */
+	buf_pool_mutex_enter(buf_pool);
+	scan_depth = UT_LIST_GET_LEN(buf_pool->LRU);
+	buf_pool_mutex_exit(buf_pool);
+
+	scan_depth = ut_min(srv_LRU_scan_depth, scan_depth);
+
+	/* Currently page_cleaner is the only thread
+	that can trigger an LRU flush. It is possible
+	that a batch triggered during last iteration is
+	still running, */
+	if (!buf_flush_start(buf_pool, BUF_FLUSH_LRU)) {
+		return(false);
+	}
+
+	res = buf_flush_batch(buf_pool, BUF_FLUSH_LRU, scan_depth, 0);
+
+	buf_flush_end(buf_pool, BUF_FLUSH_LRU);
+
+	buf_flush_common(BUF_FLUSH_LRU, res.first);
+
+	if (res.first) {
+		MONITOR_INC_VALUE_CUMULATIVE(
+			MONITOR_LRU_BATCH_FLUSH_TOTAL_PAGE,
+			MONITOR_LRU_BATCH_FLUSH_COUNT,
+			MONITOR_LRU_BATCH_FLUSH_PAGES,
+			res.first);
+	}
+
+	if (res.second) {
+		MONITOR_INC_VALUE_CUMULATIVE(
+			MONITOR_LRU_BATCH_EVICT_TOTAL_PAGE,
+			MONITOR_LRU_BATCH_EVICT_COUNT,
+			MONITOR_LRU_BATCH_EVICT_PAGES,
+			res.second);
+	}
+
+	*n_flushed = res.first;
+	*n_evicted = res.second;
+
+	return(true);
+}
+
 /*********************************************************************//**
 Clears up tail of the LRU lists:
 * Put replaceable pages at the tail of LRU to the free list
@@ -2126,50 +2289,13 @@ buf_flush_LRU_tail(void)
 	ulint	total_processed = 0;
 
 	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		ulint	n_flushed;
+		ulint	n_evicted;
 
-		buf_pool_t*	buf_pool = buf_pool_from_array(i);
-		std::pair<ulint, ulint>	res;
-		ulint	scan_depth;
-
-		/* srv_LRU_scan_depth can be arbitrarily large value.
-		We cap it with current LRU size. */
-		buf_pool_mutex_enter(buf_pool);
-		scan_depth = UT_LIST_GET_LEN(buf_pool->LRU);
-		buf_pool_mutex_exit(buf_pool);
-
-		scan_depth = ut_min(srv_LRU_scan_depth, scan_depth);
-
-		/* Currently page_cleaner is the only thread
-		that can trigger an LRU flush. It is possible
-		that a batch triggered during last iteration is
-		still running, */
-		if (!buf_flush_start(buf_pool, BUF_FLUSH_LRU)) {
-			continue;
-		}
-
-		res = buf_flush_batch(buf_pool, BUF_FLUSH_LRU, scan_depth, 0);
+		buf_flush_LRU_tail_one(buf_pool_from_array(i),
+				       &n_flushed, &n_evicted);
 
-		buf_flush_end(buf_pool, BUF_FLUSH_LRU);
-
-		buf_flush_common(BUF_FLUSH_LRU, res.first);
-
-		if (res.first) {
-			MONITOR_INC_VALUE_CUMULATIVE(
-				MONITOR_LRU_BATCH_FLUSH_TOTAL_PAGE,
-				MONITOR_LRU_BATCH_FLUSH_COUNT,
-				MONITOR_LRU_BATCH_FLUSH_PAGES,
-				res.first);
-		}
-
-		if (res.second) {
-			MONITOR_INC_VALUE_CUMULATIVE(
-				MONITOR_LRU_BATCH_EVICT_TOTAL_PAGE,
-				MONITOR_LRU_BATCH_EVICT_COUNT,
-				MONITOR_LRU_BATCH_EVICT_PAGES,
-				res.second);
-		}
-
-		total_processed += (res.first + res.second);
+		total_processed += n_flushed + n_evicted;
 	}
 
 	return(total_processed);
@@ -2200,6 +2326,238 @@ buf_flush_wait_LRU_batch_end(void)
 	}
 }
 
+/*******************************************************************//**
+Gets the oldest modification of the dirty pages in a buffer pool
+instance.
+@return oldest modification, or 0 if the flush list is empty */
+UNIV_INTERN
+lsn_t
+buf_flush_get_oldest_modification(
+/*==============================*/
+	buf_pool_t*	buf_pool)	/*!< in: buffer pool instance */
+{
+	buf_page_t*	bpage;
+	lsn_t		oldest = 0;
+
+	buf_flush_list_mutex_enter(buf_pool);
+
+	bpage = UT_LIST_GET_LAST(buf_pool->flush_list);
+
+	if (bpage != NULL) {
+		ut_ad(bpage->in_flush_list);
+		oldest = bpage->oldest_modification;
+	}
+
+	buf_flush_list_mutex_exit(buf_pool);
+
+	return(oldest);
+}
+
+/*********************************************************************//**
+Starts a batch of a pending parallel flush request, runs it and records
+its result.
+@return true if a batch was run, false if there was none to start */
+static
+bool
+page_cleaner_do_slot(
+/*=================*/
+	buf_flush_t	type)	/*!< in: BUF_FLUSH_LRU or BUF_FLUSH_LIST,
+				or BUF_FLUSH_N_TYPES for any */
+{
+	page_cleaner_request_t*	request = NULL;
+	page_cleaner_slot_t*	slot;
+	ulint			i;
+
+	mutex_enter(&page_cleaner->mutex);
+
+	/* LRU batches come first: they refill the free lists that
+	foreground threads may be waiting for. */
+	if ((type == BUF_FLUSH_LRU || type == BUF_FLUSH_N_TYPES)
+	    && page_cleaner->requests[BUF_FLUSH_LRU].n_requested > 0) {
+		request = &page_cleaner->requests[BUF_FLUSH_LRU];
+		type = BUF_FLUSH_LRU;
+	} else if ((type == BUF_FLUSH_LIST || type == BUF_FLUSH_N_TYPES)
+		   && page_cleaner->requests[BUF_FLUSH_LIST].n_requested
+		   > 0) {
+		request = &page_cleaner->requests[BUF_FLUSH_LIST];
+		type = BUF_FLUSH_LIST;
+	}
+
+	if (request == NULL) {
+		mutex_exit(&page_cleaner->mutex);
+		return(false);
+	}
+
+	i = request->next_slot++;
+	ut_a(i < srv_buf_pool_instances);
+
+	slot = &request->slots[i];
+	ut_ad(slot->state == PAGE_CLEANER_STATE_REQUESTED);
+	slot->state = PAGE_CLEANER_STATE_FLUSHING;
+	request->n_requested--;
+	request->n_flushing++;
+
+	mutex_exit(&page_cleaner->mutex);
+
+	if (type == BUF_FLUSH_LRU) {
+		slot->success = buf_flush_LRU_tail_one(
+			buf_pool_from_array(i),
+			&slot->n_flushed, &slot->n_evicted);
+	} else if (slot->min_n > 0) {
+		slot->n_evicted = 0;
+		slot->success = buf_flush_list_one(
+			buf_pool_from_array(i),
+			slot->min_n, slot->lsn_limit, &slot->n_flushed);
+	} else {
+		/* Nothing to flush in this instance */
+		slot->success = true;
+		slot->n_flushed = slot->n_evicted = 0;
+	}
+
+	mutex_enter(&page_cleaner->mutex);
+
+	slot->state = PAGE_CLEANER_STATE_FINISHED;
+	request->n_flushing--;
+
+	if (request->n_requested == 0 && request->n_flushing == 0) {
+		os_event_set(request->finished);
+	}
+
+	mutex_exit(&page_cleaner->mutex);
+
+	return(true);
+}
+
+/*********************************************************************//**
+Shares out a flush list batch of n_pages between the buffer pool
+instances. Each instance gets a share proportional to the redo log its
+oldest dirty page holds back from lsn_limit, so that the instances
+holding back the checkpoint the most are flushed first. */
+static
+void
+page_cleaner_distribute_flush_list(
+/*===============================*/
+	page_cleaner_slot_t*	slots,		/*!< out: the slots */
+	ulint			n_pages,	/*!< in: pages to flush,
+						or ULINT_MAX for all */
+	lsn_t			lsn_limit)	/*!< in: flush limit */
+{
+	lsn_t	age_limit = lsn_limit;
+	double	total_age = 0;
+	ulint	i;
+
+	if (lsn_limit == LSN_MAX) {
+		age_limit = log_get_lsn();
+	}
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		lsn_t	oldest = buf_flush_get_oldest_modification(
+			buf_pool_from_array(i));
+
+		slots[i].lsn_limit = lsn_limit;
+		slots[i].redo_age = 0;
+
+		if (oldest == 0 || oldest >= lsn_limit) {
+			/* Nothing to flush in this instance */
+			slots[i].min_n = 0;
+			continue;
+		}
+
+		/* Every instance with pages to flush gets some of the
+		batch, even when it holds back little redo. */
+		slots[i].redo_age = oldest < age_limit
+			? age_limit - oldest : 1;
+		slots[i].min_n = n_pages;
+		total_age += (double) slots[i].redo_age;
+	}
+
+	if (n_pages == ULINT_MAX || total_age == 0) {
+		return;
+	}
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		if (slots[i].redo_age > 0) {
+			slots[i].min_n = (ulint) ceil(
+				n_pages * (slots[i].redo_age / total_age));
+		}
+	}
+}
+
+/*********************************************************************//**
+Runs a batch of the given type on all the buffer pool instances, in
+parallel with the page cleaner workers, and waits for it to end.
+@return true if no instance was already running a batch of the type */
+static
+bool
+page_cleaner_flush_parallel(
+/*========================*/
+	buf_flush_t	type,		/*!< in: BUF_FLUSH_LRU or
+					BUF_FLUSH_LIST */
+	ulint		n_pages,	/*!< in: for BUF_FLUSH_LIST, the
+					pages to flush in all instances */
+	lsn_t		lsn_limit,	/*!< in: for BUF_FLUSH_LIST, the
+					flush limit */
+	ulint*		n_flushed,	/*!< out: pages flushed */
+	ulint*		n_evicted)	/*!< out: pages evicted, or NULL */
+{
+	page_cleaner_request_t*	request = &page_cleaner->requests[type];
+	bool			success = true;
+	ulint			i;
+
+	ut_ad(type == BUF_FLUSH_LRU || type == BUF_FLUSH_LIST);
+
+	/* The slots are not visible to the workers until n_requested
+	is set below. */
+	if (type == BUF_FLUSH_LIST) {
+		page_cleaner_distribute_flush_list(
+			request->slots, n_pages, lsn_limit);
+	}
+
+	mutex_enter(&page_cleaner->mutex);
+
+	ut_ad(request->n_requested == 0);
+	ut_ad(request->n_flushing == 0);
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		request->slots[i].state = PAGE_CLEANER_STATE_REQUESTED;
+	}
+
+	request->next_slot = 0;
+	request->n_requested = srv_buf_pool_instances;
+	os_event_reset(request->finished);
+	os_event_set(page_cleaner->is_requested);
+
+	mutex_exit(&page_cleaner->mutex);
+
+	while (page_cleaner_do_slot(type)) {}
+
+	os_event_wait(request->finished);
+
+	*n_flushed = 0;
+	if (n_evicted != NULL) {
+		*n_evicted = 0;
+	}
+
+	mutex_enter(&page_cleaner->mutex);
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		page_cleaner_slot_t*	slot = &request->slots[i];
+
+		ut_ad(slot->state == PAGE_CLEANER_STATE_FINISHED);
+		slot->state = PAGE_CLEANER_STATE_NONE;
+
+		success = success && slot->success;
+		*n_flushed += slot->n_flushed;
+		if (n_evicted != NULL) {
+			*n_evicted += slot->n_evicted;
+		}
+	}
+
+	mutex_exit(&page_cleaner->mutex);
+
+	return(success);
+}
+
 /*********************************************************************//**
 Flush a batch of dirty pages from the flush list
 @return number of pages flushed, 0 if no page is flushed or if another
@@ -2215,7 +2573,8 @@ page_cleaner_do_flush_batch(
 {
 	ulint n_flushed;
 
-	buf_flush_list(n_to_flush, lsn_limit, &n_flushed);
+	page_cleaner_flush_parallel(BUF_FLUSH_LIST, n_to_flush, lsn_limit,
+				    &n_flushed, NULL);
 
 	return(n_flushed);
 }
@@ -2717,7 +3076,11 @@ DECLARE_THREAD(buf_flush_lru_manager_thread)(
 
 		next_loop_time = ut_time_ms() + lru_sleep_time;
 
-		buf_flush_LRU_tail();
+		ulint	n_flushed;
+		ulint	n_evicted;
+
+		page_cleaner_flush_parallel(BUF_FLUSH_LRU, 0, 0,
+					    &n_flushed, &n_evicted);
 	}
 
 	buf_lru_manager_is_active = false;
@@ -2730,6 +3093,119 @@ DECLARE_THREAD(buf_flush_lru_manager_thread)(
 	OS_THREAD_DUMMY_RETURN;
 }
 
+/******************************************************************//**
+Creates the page cleaner coordination structure. Must be called before
+the page_cleaner, lru_manager and page cleaner worker threads are
+created. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_init(void)
+/*=============================*/
+{
+	ut_ad(page_cleaner == NULL);
+
+	page_cleaner = static_cast<page_cleaner_t*>(
+		mem_zalloc(sizeof(*page_cleaner)));
+
+	mutex_create(page_cleaner_mutex_key, &page_cleaner->mutex,
+		     SYNC_ANY_LATCH);
+
+	page_cleaner->is_requested = os_event_create();
+
+	for (ulint i = 0; i < BUF_FLUSH_N_TYPES; i++) {
+		page_cleaner_request_t*	request = &page_cleaner->requests[i];
+
+		if (i != BUF_FLUSH_LRU && i != BUF_FLUSH_LIST) {
+			continue;
+		}
+
+		request->slots = static_cast<page_cleaner_slot_t*>(
+			mem_zalloc(srv_buf_pool_instances
+				   * sizeof(*request->slots)));
+		request->finished = os_event_create();
+	}
+}
+
+/******************************************************************//**
+Wakes up the page cleaner workers, so that they notice shutdown. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_wakeup_workers(void)
+/*=======================================*/
+{
+	if (page_cleaner != NULL) {
+		os_event_set(page_cleaner->is_requested);
+	}
+}
+
+/******************************************************************//**
+Frees the page cleaner coordination structure, after all the page
+cleaner threads have exited. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_close(void)
+/*==============================*/
+{
+	if (page_cleaner == NULL) {
+		return;
+	}
+
+	for (ulint i = 0; i < BUF_FLUSH_N_TYPES; i++) {
+		page_cleaner_request_t*	request = &page_cleaner->requests[i];
+
+		if (request->slots != NULL) {
+			mem_free(request->slots);
+			os_event_free(request->finished);
+		}
+	}
+
+	os_event_free(page_cleaner->is_requested);
+	mutex_free(&page_cleaner->mutex);
+
+	mem_free(page_cleaner);
+	page_cleaner = NULL;
+}
+
+/******************************************************************//**
+page cleaner worker thread. It runs the batches that the page_cleaner
+and lru_manager threads request on the buffer pool instances, so that
+several instances are flushed at the same time. There are
+innodb_page_cleaners - 1 of these threads.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_flush_page_cleaner_worker)(
+/*==========================================*/
+	void*	arg MY_ATTRIBUTE((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(buf_page_cleaner_worker_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+#ifdef UNIV_DEBUG_THREAD_CREATION
+	fprintf(stderr, "InnoDB: page_cleaner worker thread running, id %lu\n",
+		os_thread_pf(os_thread_get_curr_id()));
+#endif /* UNIV_DEBUG_THREAD_CREATION */
+
+	while (srv_shutdown_state != SRV_SHUTDOWN_EXIT_THREADS) {
+		ib_int64_t	sig_count;
+
+		sig_count = os_event_reset(page_cleaner->is_requested);
+
+		while (page_cleaner_do_slot(BUF_FLUSH_N_TYPES)) {}
+
+		os_event_wait_low(page_cleaner->is_requested, sig_count);
+	}
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 
 /** Functor to validate the flush list. */
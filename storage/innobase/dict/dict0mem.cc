@@ -102,6 +102,7 @@ dict_mem_table_create(
 	table->is_system_db = dict_mem_table_is_system(table->name);
 	table->space = (unsigned int) space;
 	table->n_cols = (unsigned int) (n_cols + DATA_N_SYS_COLS);
+	table->zip_algorithm = ULINT_UNDEFINED;
 
 	table->cols = static_cast<dict_col_t*>(
 		mem_heap_alloc(heap,
@@ -284,6 +284,24 @@ static TYPELIB innodb_default_row_format_typelib = {
     array_elements(innodb_default_row_format_names) - 1,
     "innodb_default_row_format_typelib", innodb_default_row_format_names, NULL};
 
+/** Possible values for system variable "innodb_compression_algorithm".
+The order must match page_zip_algorithm_t. */
+static const char* innodb_compression_algorithm_names[] = {
+	"zlib",
+	"lz4",
+	"zstd",
+	NullS
+};
+
+/** Used to define an enumerate type of the system variable
+innodb_compression_algorithm. */
+static TYPELIB innodb_compression_algorithm_typelib = {
+	array_elements(innodb_compression_algorithm_names) - 1,
+	"innodb_compression_algorithm_typelib",
+	innodb_compression_algorithm_names,
+	NULL
+};
+
 /* The following counter is used to convey information to InnoDB
 about server activity: in case of normal DML ops it is not
 sensible to call srv_active_wake_master_thread after each
@@ -350,6 +368,7 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&file_format_max_mutex_key, "file_format_max_mutex", 0},
 	{&fil_system_mutex_key, "fil_system_mutex", 0},
 	{&flush_list_mutex_key, "flush_list_mutex", 0},
+	{&page_cleaner_mutex_key, "page_cleaner_mutex", 0},
 	{&fts_bg_threads_mutex_key, "fts_bg_threads_mutex", 0},
 	{&fts_delete_mutex_key, "fts_delete_mutex", 0},
 	{&fts_optimize_mutex_key, "fts_optimize_mutex", 0},
@@ -392,7 +411,7 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&buf_dblwr_mutex_key, "buf_dblwr_mutex", 0},
 	{&trx_undo_mutex_key, "trx_undo_mutex", 0},
 	{&srv_sys_mutex_key, "srv_sys_mutex", 0},
-	{&lock_sys_mutex_key, "lock_mutex", 0},
+	{&lock_sys_rec_shard_mutex_key, "lock_rec_shard_mutex", 0},
 	{&lock_sys_wait_mutex_key, "lock_wait_mutex", 0},
 	{&trx_mutex_key, "trx_mutex", 0},
 	{&srv_sys_tasks_mutex_key, "srv_threads_mutex", 0},
@@ -438,7 +457,8 @@ static PSI_rwlock_info all_innodb_rwlocks[] = {
 	{&index_tree_rw_lock_key, "index_tree_rw_lock", 0},
 	{&index_online_log_key, "index_online_log", 0},
 	{&dict_table_stats_key, "dict_table_stats", 0},
-	{&hash_table_rw_lock_key, "hash_table_locks", 0}
+	{&hash_table_rw_lock_key, "hash_table_locks", 0},
+	{&lock_sys_latch_key, "lock_sys_latch", 0}
 };
 # endif /* UNIV_PFS_RWLOCK */
 
@@ -456,6 +476,7 @@ static PSI_thread_info	all_innodb_threads[] = {
 	{&srv_purge_thread_key, "srv_purge_thread", 0},
 	{&buf_page_cleaner_thread_key, "page_cleaner_thread", 0},
 	{&buf_lru_manager_thread_key, "lru_manager_thread", 0},
+	{&buf_page_cleaner_worker_thread_key, "page_cleaner_worker_thread", 0},
 	{&recv_writer_thread_key, "recv_writer_thread", 0},
 	{&srv_slowrm_thread_key, "srv_slowrm_thread", 0}
 };
@@ -3122,6 +3143,49 @@ trx_is_started(
 	return(trx->state != TRX_STATE_NOT_STARTED);
 }
 
+/*********************************************************************//**
+Look for a COMPRESSION_ALGORITHM=<name> hint in a table comment. The
+server parses but does not store the COMPRESSION table option, so the
+comment is used to pick the page compression algorithm of a table.
+@return page_zip_algorithm_t, or ULINT_UNDEFINED if there is no hint */
+static
+ulint
+innobase_zip_algorithm_from_comment(
+/*================================*/
+	const LEX_STRING&	comment)	/*!< in: table comment */
+{
+	static const char	hint[] = "COMPRESSION_ALGORITHM=";
+	const ulint		hint_len = sizeof(hint) - 1;
+
+	for (ulint i = 0; i + hint_len <= comment.length; i++) {
+		if (strncasecmp(comment.str + i, hint, hint_len) != 0) {
+			continue;
+		}
+
+		const char*	value = comment.str + i + hint_len;
+		ulint		value_len = comment.length - i - hint_len;
+
+		for (ulint a = 0;
+		     innodb_compression_algorithm_names[a] != NullS;
+		     a++) {
+			const char*	name
+				= innodb_compression_algorithm_names[a];
+			ulint		len = strlen(name);
+
+			if (len <= value_len
+			    && strncasecmp(value, name, len) == 0
+			    && (len == value_len
+				|| !isalnum((uchar) value[len]))) {
+				return(a);
+			}
+		}
+
+		break;
+	}
+
+	return(ULINT_UNDEFINED);
+}
+
 /*********************************************************************//**
 Copy table flags from MySQL's HA_CREATE_INFO into an InnoDB table object.
 Those flags are stored in .frm file and end up in the MySQL table object,
@@ -3156,6 +3220,9 @@ innobase_copy_frm_flags_from_create_info(
 		create_info->stats_auto_recalc == HA_STATS_AUTO_RECALC_OFF);
 
 	innodb_table->stats_sample_pages = create_info->stats_sample_pages;
+
+	innodb_table->zip_algorithm = innobase_zip_algorithm_from_comment(
+		create_info->comment);
 }
 
 /*********************************************************************//**
@@ -3192,6 +3259,9 @@ innobase_copy_frm_flags_from_table_share(
 		table_share->stats_auto_recalc == HA_STATS_AUTO_RECALC_OFF);
 
 	innodb_table->stats_sample_pages = table_share->stats_sample_pages;
+
+	innodb_table->zip_algorithm = innobase_zip_algorithm_from_comment(
+		table_share->comment);
 }
 
 /*********************************************************************//**
@@ -5822,7 +5892,7 @@ ha_innobase::open(
 	thd = ha_thd();
 
 	/* Under some cases MySQL seems to call this function while
-	holding btr_search_latch. This breaks the latching order as
+	holding an adaptive hash index latch. This breaks the latching order as
 	we acquire dict_sys->mutex below and leads to a deadlock. */
 	if (thd != NULL) {
 		innobase_release_temporary_latches(ht, thd);
@@ -17713,6 +17783,32 @@ buffer_pool_load_now(
 	}
 }
 
+/****************************************************************//**
+Update the system variable innodb_buffer_pool_dump_interval, and wake up
+the buffer pool dump/load thread to start waiting for the new interval.
+This function is registered as a callback with MySQL. */
+static
+void
+innodb_buffer_pool_dump_interval_update(
+/*====================================*/
+	THD*				thd	/*!< in: thread handle */
+					MY_ATTRIBUTE((unused)),
+	struct st_mysql_sys_var*	var	/*!< in: pointer to system
+						variable */
+					MY_ATTRIBUTE((unused)),
+	void*				var_ptr	/*!< out: where the formal
+						string goes */
+					MY_ATTRIBUTE((unused)),
+	const void*			save)	/*!< in: immediate result from
+						check function */
+{
+	srv_buf_dump_interval = *static_cast<const ulong*>(save);
+
+	if (!srv_read_only_mode) {
+		os_event_set(srv_buf_dump_event);
+	}
+}
+
 /****************************************************************//**
 Abort a load of the buffer pool if innodb_buffer_pool_load_abort
 is set to ON. This function is registered as a callback with MySQL. */
@@ -18109,6 +18205,13 @@ static MYSQL_SYSVAR_BOOL(adaptive_hash_index, btr_search_enabled,
   "Disable with --skip-innodb-adaptive-hash-index.",
   NULL, innodb_adaptive_hash_index_update, TRUE);
 
+static MYSQL_SYSVAR_ULONG(adaptive_hash_index_parts, btr_ahi_parts,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of partitions of the InnoDB adaptive hash index. Every "
+  "partition has its own latch and memory heap, and an index is "
+  "assigned to a partition by its index id (8 by default).",
+  NULL, NULL, 8, 1, BTR_AHI_PARTS_MAX, 0);
+
 static MYSQL_SYSVAR_ULONG(replication_delay, srv_replication_delay,
   PLUGIN_VAR_RQCMDARG,
   "Replication thread delay (ms) on the slave server if "
@@ -18121,6 +18224,14 @@ static MYSQL_SYSVAR_UINT(compression_level, page_zip_level,
   ", 1 is fastest, 9 is best compression and default is 6.",
   NULL, NULL, DEFAULT_COMPRESSION_LEVEL, 0, 9, 0);
 
+static MYSQL_SYSVAR_ENUM(compression_algorithm, page_zip_algorithm,
+  PLUGIN_VAR_RQCMDARG,
+  "Algorithm used to compress the pages of compressed tables that do not "
+  "name one with a COMPRESSION_ALGORITHM=zlib|lz4|zstd table comment. "
+  "Pages compressed with any of them can always be read back.",
+  NULL, NULL, PAGE_ZIP_ALGORITHM_ZLIB,
+  &innodb_compression_algorithm_typelib);
+
 static MYSQL_SYSVAR_BOOL(zlib_wrap, page_zip_zlib_wrap,
   PLUGIN_VAR_OPCMDARG,
   "When this parameter is OFF, innodb tells zlib to not compute adler32 values "
@@ -18294,6 +18405,24 @@ static MYSQL_SYSVAR_ULONG(buffer_pool_dump_pct, srv_buf_pool_dump_pct,
   "Dump only the hottest N% of each buffer pool, defaults to 100",
   NULL, NULL, 100, 1, 100, 0);
 
+static MYSQL_SYSVAR_BOOL(buffer_pool_dump_compact, srv_buf_dump_compact,
+  PLUGIN_VAR_OPCMDARG,
+  "Write the buffer pool dump in a compact binary format that records "
+  "how hot each page is, instead of a space_id,page_no line per page. "
+  "Both formats can be loaded.",
+  NULL, NULL, TRUE);
+
+static MYSQL_SYSVAR_ULONG(buffer_pool_dump_interval, srv_buf_dump_interval,
+  PLUGIN_VAR_RQCMDARG,
+  "Dump the buffer pool every N seconds, 0 (the default) to only dump it "
+  "on request and at shutdown",
+  NULL, innodb_buffer_pool_dump_interval_update, 0, 0, 86400, 0);
+
+static MYSQL_SYSVAR_ULONG(buffer_pool_load_threads, srv_buf_load_threads,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of threads that read the pages of a buffer pool load",
+  NULL, NULL, 4, 1, 64, 0);
+
 #ifdef UNIV_DEBUG
 static MYSQL_SYSVAR_STR(buffer_pool_evict, srv_buffer_pool_evict,
   PLUGIN_VAR_RQCMDARG,
@@ -18927,6 +19056,12 @@ static MYSQL_SYSVAR_BOOL(page_cleaner_adaptive_sleep, srv_pc_adaptive_sleep,
   "Enable adaptive sleep time calculation for page cleaner thread",
   NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_ULONG(page_cleaners, srv_n_page_cleaners,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of threads flushing buffer pool instances in parallel. "
+  "Capped at innodb_buffer_pool_instances.",
+  NULL, NULL, 4, 1, MAX_BUFFER_POOLS, 0);
+
 static MYSQL_SYSVAR_ULONG(aio_old_usecs, srv_io_old_usecs,
   PLUGIN_VAR_RQCMDARG,
   "AIO requests are scheduled in file offset order until they are this old. ",
@@ -18987,6 +19122,9 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(buffer_pool_dump_at_shutdown),
   MYSQL_SYSVAR(dump_core_without_large_mem_buf),
   MYSQL_SYSVAR(buffer_pool_dump_pct),
+  MYSQL_SYSVAR(buffer_pool_dump_compact),
+  MYSQL_SYSVAR(buffer_pool_dump_interval),
+  MYSQL_SYSVAR(buffer_pool_load_threads),
   MYSQL_SYSVAR(evicted_pages_sampling_ratio),
   MYSQL_SYSVAR(buffer_pool_resizing_timeout),
   MYSQL_SYSVAR(histogram_step_size_async_read),
@@ -19018,6 +19156,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(commit_concurrency),
   MYSQL_SYSVAR(concurrency_tickets),
   MYSQL_SYSVAR(compression_level),
+  MYSQL_SYSVAR(compression_algorithm),
   MYSQL_SYSVAR(data_file_path),
   MYSQL_SYSVAR(data_home_dir),
   MYSQL_SYSVAR(deadlock_detect),
@@ -19092,6 +19231,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(stats_recalc_threshold),
   MYSQL_SYSVAR(stats_locked_reads),
   MYSQL_SYSVAR(adaptive_hash_index),
+  MYSQL_SYSVAR(adaptive_hash_index_parts),
   MYSQL_SYSVAR(stats_method),
   MYSQL_SYSVAR(replication_delay),
   MYSQL_SYSVAR(status_file),
@@ -19191,6 +19331,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(zlib_strategy),
   MYSQL_SYSVAR(lru_manager_max_sleep_time),
   MYSQL_SYSVAR(page_cleaner_adaptive_sleep),
+  MYSQL_SYSVAR(page_cleaners),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(allow_ibuf_merges),
 #endif /* UNIV_DEBUG */
@@ -19243,6 +19384,8 @@ i_s_innodb_sys_foreign_cols,
 i_s_innodb_sys_tablespaces,
 i_s_innodb_sys_datafiles,
 i_s_innodb_file_status,
+i_s_innodb_adaptive_hash_partitions,
+i_s_innodb_buffer_pool_flush_stats,
 i_s_innodb_sys_docstore
 
 mysql_declare_plugin_end;
@@ -36,12 +36,15 @@ Created July 18, 2007 Vasil Dimov
 #include <mysql/innodb_priv.h>
 
 #include "btr0pcur.h"
+#include "btr0sea.h"
 #include "btr0types.h"
 #include "dict0dict.h"
 #include "dict0load.h"
 #include "buf0buddy.h"
 #include "buf0buf.h"
+#include "buf0flu.h"
 #include "ibuf0ibuf.h"
+#include "log0log.h"
 #include "dict0mem.h"
 #include "dict0types.h"
 #include "ha_prototypes.h"
@@ -1077,6 +1080,436 @@ UNIV_INTERN struct st_mysql_plugin	i_s_innodb_file_status =
 	STRUCT_FLD(flags, 0UL),
 };
 
+/* Fields of the dynamic table
+information_schema.innodb_adaptive_hash_partitions. */
+static ST_FIELD_INFO i_s_ahi_partitions_fields_info[]=
+{
+#define IDX_AHI_PARTITION_ID	0
+	{STRUCT_FLD(field_name,		"PARTITION_ID"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_AHI_HASH_TABLE_SIZE	1
+	{STRUCT_FLD(field_name,		"HASH_TABLE_SIZE"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_AHI_HEAP_BUFFERS	2
+	{STRUCT_FLD(field_name,		"HEAP_BUFFERS"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_AHI_HITS		3
+	{STRUCT_FLD(field_name,		"HITS"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_AHI_MISSES		4
+	{STRUCT_FLD(field_name,		"MISSES"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_AHI_HIT_RATE	5
+	{STRUCT_FLD(field_name,		"HIT_RATE"),
+	 STRUCT_FLD(field_length,	0),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_FLOAT),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	0),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+	END_OF_ST_FIELD_INFO
+};
+
+/************************************************************************//**
+Populates the INNODB_ADAPTIVE_HASH_PARTITIONS information_schema table,
+one row per adaptive hash index partition.
+@return	0 on success */
+static
+int
+i_s_ahi_partitions_fill(
+/*====================*/
+	THD*		thd,	/*!< in: thread */
+	TABLE_LIST*	tables,	/*!< in/out: tables to fill */
+	Item*		cond)	/*!< in: condition (not used) */
+{
+	TABLE*	table = tables->table;
+	Field**	fields = table->field;
+
+	DBUG_ENTER("i_s_ahi_partitions_fill");
+
+	/* deny access to non-superusers */
+	if (check_global_access(thd, PROCESS_ACL)) {
+
+		DBUG_RETURN(0);
+	}
+
+	RETURN_IF_INNODB_NOT_STARTED(tables->schema_table_name);
+
+	for (ulint i = 0; i < btr_ahi_parts; i++) {
+		btr_search_part_t*	part = &btr_search_sys->parts[i];
+		ulint			n_cells;
+		ulint			n_bufs;
+		ulint			n_hits = part->n_hits;
+		ulint			n_misses = part->n_misses;
+
+		/* The hash table is replaced on a buffer pool resize,
+		and its heap grows under the partition latch. */
+		rw_lock_s_lock(btr_search_latches[i]);
+
+		n_cells = hash_get_n_cells(part->hash_index);
+		n_bufs = UT_LIST_GET_LEN(part->hash_index->heap->base) - 1;
+
+		if (part->hash_index->heap->free_block) {
+			n_bufs++;
+		}
+
+		rw_lock_s_unlock(btr_search_latches[i]);
+
+		OK(fields[IDX_AHI_PARTITION_ID]->store(i));
+		OK(fields[IDX_AHI_HASH_TABLE_SIZE]->store(n_cells));
+		OK(fields[IDX_AHI_HEAP_BUFFERS]->store(n_bufs));
+		OK(fields[IDX_AHI_HITS]->store(n_hits));
+		OK(fields[IDX_AHI_MISSES]->store(n_misses));
+		OK(fields[IDX_AHI_HIT_RATE]->store(
+			   n_hits + n_misses
+			   ? (double) n_hits / (n_hits + n_misses)
+			   : 0.0));
+
+		if (schema_table_store_record(thd, table)) {
+			DBUG_RETURN(1);
+		}
+	}
+
+	DBUG_RETURN(0);
+}
+
+/*******************************************************************//**
+Bind the dynamic table information_schema.innodb_adaptive_hash_partitions.
+@return	0 on success */
+static
+int
+i_s_ahi_partitions_init(
+/*====================*/
+	void*	p)	/*!< in/out: table schema object */
+{
+	DBUG_ENTER("i_s_ahi_partitions_init");
+	ST_SCHEMA_TABLE* schema = (ST_SCHEMA_TABLE*) p;
+
+	schema->fields_info = i_s_ahi_partitions_fields_info;
+	schema->fill_table = i_s_ahi_partitions_fill;
+
+	DBUG_RETURN(0);
+}
+
+UNIV_INTERN struct st_mysql_plugin	i_s_innodb_adaptive_hash_partitions =
+{
+	/* the plugin type (a MYSQL_XXX_PLUGIN value) */
+	/* int */
+	STRUCT_FLD(type, MYSQL_INFORMATION_SCHEMA_PLUGIN),
+
+	/* pointer to type-specific plugin descriptor */
+	/* void* */
+	STRUCT_FLD(info, &i_s_info),
+
+	/* plugin name */
+	/* const char* */
+	STRUCT_FLD(name, "INNODB_ADAPTIVE_HASH_PARTITIONS"),
+
+	/* plugin author (for SHOW PLUGINS) */
+	/* const char* */
+	STRUCT_FLD(author, plugin_author),
+
+	/* general descriptive text (for SHOW PLUGINS) */
+	/* const char* */
+	STRUCT_FLD(descr, "InnoDB adaptive hash index partition statistics"),
+
+	/* the plugin license (PLUGIN_LICENSE_XXX) */
+	/* int */
+	STRUCT_FLD(license, PLUGIN_LICENSE_GPL),
+
+	/* the function to invoke when plugin is loaded */
+	/* int (*)(void*); */
+	STRUCT_FLD(init, i_s_ahi_partitions_init),
+
+	/* the function to invoke when plugin is unloaded */
+	/* int (*)(void*); */
+	STRUCT_FLD(deinit, i_s_common_deinit),
+
+	/* plugin version (for SHOW PLUGINS) */
+	/* unsigned int */
+	STRUCT_FLD(version, INNODB_VERSION_SHORT),
+
+	/* struct st_mysql_show_var* */
+	STRUCT_FLD(status_vars, NULL),
+
+	/* struct st_mysql_sys_var** */
+	STRUCT_FLD(system_vars, NULL),
+
+	/* reserved for dependency checking */
+	/* void* */
+	STRUCT_FLD(__reserved1, NULL),
+
+	/* Plugin flags */
+	/* unsigned long */
+	STRUCT_FLD(flags, 0UL),
+};
+
+/* Fields of the dynamic table
+information_schema.innodb_buffer_pool_flush_stats. */
+static ST_FIELD_INFO i_s_flush_stats_fields_info[]=
+{
+#define IDX_FLUSH_STATS_POOL_ID	0
+	{STRUCT_FLD(field_name,		"POOL_ID"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_FLUSH_STATS_LIST_BATCHES	1
+	{STRUCT_FLD(field_name,		"FLUSH_LIST_BATCHES"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_FLUSH_STATS_LIST_PAGES	2
+	{STRUCT_FLD(field_name,		"FLUSH_LIST_PAGES"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_FLUSH_STATS_LIST_RATE	3
+	{STRUCT_FLD(field_name,		"FLUSH_LIST_PAGES_PER_SEC"),
+	 STRUCT_FLD(field_length,	0),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_FLOAT),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	0),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_FLUSH_STATS_LRU_BATCHES	4
+	{STRUCT_FLD(field_name,		"LRU_BATCHES"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_FLUSH_STATS_LRU_PAGES	5
+	{STRUCT_FLD(field_name,		"LRU_PAGES"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_FLUSH_STATS_LRU_RATE	6
+	{STRUCT_FLD(field_name,		"LRU_PAGES_PER_SEC"),
+	 STRUCT_FLD(field_length,	0),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_FLOAT),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	0),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+#define IDX_FLUSH_STATS_REDO_AGE	7
+	{STRUCT_FLD(field_name,		"REDO_AGE"),
+	 STRUCT_FLD(field_length,	MY_INT64_NUM_DECIMAL_DIGITS),
+	 STRUCT_FLD(field_type,		MYSQL_TYPE_LONGLONG),
+	 STRUCT_FLD(value,		0),
+	 STRUCT_FLD(field_flags,	MY_I_S_UNSIGNED),
+	 STRUCT_FLD(old_name,		""),
+	 STRUCT_FLD(open_method,	SKIP_OPEN_TABLE)},
+
+	END_OF_ST_FIELD_INFO
+};
+
+/************************************************************************//**
+Pages flushed per second of batch time.
+@return flush rate, 0 if no batch ran */
+static
+double
+i_s_flush_stats_rate(
+/*=================*/
+	ulint		n_pages,	/*!< in: pages flushed */
+	ib_uint64_t	usecs)		/*!< in: time spent in batches */
+{
+	return(usecs ? n_pages * 1000000.0 / usecs : 0.0);
+}
+
+/************************************************************************//**
+Populates the INNODB_BUFFER_POOL_FLUSH_STATS information_schema table,
+one row per buffer pool instance.
+@return	0 on success */
+static
+int
+i_s_flush_stats_fill(
+/*=================*/
+	THD*		thd,	/*!< in: thread */
+	TABLE_LIST*	tables,	/*!< in/out: tables to fill */
+	Item*		cond)	/*!< in: condition (not used) */
+{
+	TABLE*	table = tables->table;
+	Field**	fields = table->field;
+	lsn_t	lsn;
+
+	DBUG_ENTER("i_s_flush_stats_fill");
+
+	/* deny access to non-superusers */
+	if (check_global_access(thd, PROCESS_ACL)) {
+
+		DBUG_RETURN(0);
+	}
+
+	RETURN_IF_INNODB_NOT_STARTED(tables->schema_table_name);
+
+	lsn = log_get_lsn();
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+		ulint		list_batches;
+		ulint		list_pages;
+		ib_uint64_t	list_usec;
+		ulint		lru_batches;
+		ulint		lru_pages;
+		ib_uint64_t	lru_usec;
+		lsn_t		oldest;
+
+		buf_pool_mutex_enter(buf_pool);
+
+		list_batches = buf_pool->n_flush_batches[BUF_FLUSH_LIST];
+		list_pages = buf_pool->n_flushed[BUF_FLUSH_LIST];
+		list_usec = buf_pool->flush_batch_usec[BUF_FLUSH_LIST];
+		lru_batches = buf_pool->n_flush_batches[BUF_FLUSH_LRU];
+		lru_pages = buf_pool->n_flushed[BUF_FLUSH_LRU];
+		lru_usec = buf_pool->flush_batch_usec[BUF_FLUSH_LRU];
+
+		buf_pool_mutex_exit(buf_pool);
+
+		oldest = buf_flush_get_oldest_modification(buf_pool);
+
+		OK(fields[IDX_FLUSH_STATS_POOL_ID]->store(i));
+		OK(fields[IDX_FLUSH_STATS_LIST_BATCHES]->store(list_batches));
+		OK(fields[IDX_FLUSH_STATS_LIST_PAGES]->store(list_pages));
+		OK(fields[IDX_FLUSH_STATS_LIST_RATE]->store(
+			   i_s_flush_stats_rate(list_pages, list_usec)));
+		OK(fields[IDX_FLUSH_STATS_LRU_BATCHES]->store(lru_batches));
+		OK(fields[IDX_FLUSH_STATS_LRU_PAGES]->store(lru_pages));
+		OK(fields[IDX_FLUSH_STATS_LRU_RATE]->store(
+			   i_s_flush_stats_rate(lru_pages, lru_usec)));
+		OK(fields[IDX_FLUSH_STATS_REDO_AGE]->store(
+			   (longlong) (oldest && oldest < lsn
+				       ? lsn - oldest : 0), true));
+
+		if (schema_table_store_record(thd, table)) {
+			DBUG_RETURN(1);
+		}
+	}
+
+	DBUG_RETURN(0);
+}
+
+/*******************************************************************//**
+Bind the dynamic table information_schema.innodb_buffer_pool_flush_stats.
+@return	0 on success */
+static
+int
+i_s_flush_stats_init(
+/*=================*/
+	void*	p)	/*!< in/out: table schema object */
+{
+	DBUG_ENTER("i_s_flush_stats_init");
+	ST_SCHEMA_TABLE* schema = (ST_SCHEMA_TABLE*) p;
+
+	schema->fields_info = i_s_flush_stats_fields_info;
+	schema->fill_table = i_s_flush_stats_fill;
+
+	DBUG_RETURN(0);
+}
+
+UNIV_INTERN struct st_mysql_plugin	i_s_innodb_buffer_pool_flush_stats =
+{
+	/* the plugin type (a MYSQL_XXX_PLUGIN value) */
+	/* int */
+	STRUCT_FLD(type, MYSQL_INFORMATION_SCHEMA_PLUGIN),
+
+	/* pointer to type-specific plugin descriptor */
+	/* void* */
+	STRUCT_FLD(info, &i_s_info),
+
+	/* plugin name */
+	/* const char* */
+	STRUCT_FLD(name, "INNODB_BUFFER_POOL_FLUSH_STATS"),
+
+	/* plugin author (for SHOW PLUGINS) */
+	/* const char* */
+	STRUCT_FLD(author, plugin_author),
+
+	/* general descriptive text (for SHOW PLUGINS) */
+	/* const char* */
+	STRUCT_FLD(descr, "InnoDB buffer pool instance flush statistics"),
+
+	/* the plugin license (PLUGIN_LICENSE_XXX) */
+	/* int */
+	STRUCT_FLD(license, PLUGIN_LICENSE_GPL),
+
+	/* the function to invoke when plugin is loaded */
+	/* int (*)(void*); */
+	STRUCT_FLD(init, i_s_flush_stats_init),
+
+	/* the function to invoke when plugin is unloaded */
+	/* int (*)(void*); */
+	STRUCT_FLD(deinit, i_s_common_deinit),
+
+	/* plugin version (for SHOW PLUGINS) */
+	/* unsigned int */
+	STRUCT_FLD(version, INNODB_VERSION_SHORT),
+
+	/* struct st_mysql_show_var* */
+	STRUCT_FLD(status_vars, NULL),
+
+	/* struct st_mysql_sys_var** */
+	STRUCT_FLD(system_vars, NULL),
+
+	/* reserved for dependency checking */
+	/* void* */
+	STRUCT_FLD(__reserved1, NULL),
+
+	/* Plugin flags */
+	/* unsigned long */
+	STRUCT_FLD(flags, 0UL),
+};
+
 /* Fields of the dynamic table INFORMATION_SCHEMA.innodb_locks */
 static ST_FIELD_INFO	innodb_locks_fields_info[] =
 {
@@ -57,6 +57,8 @@ extern struct st_mysql_plugin	i_s_innodb_sys_foreign_cols;
 extern struct st_mysql_plugin	i_s_innodb_sys_tablespaces;
 extern struct st_mysql_plugin	i_s_innodb_sys_datafiles;
 extern struct st_mysql_plugin	i_s_innodb_file_status;
+extern struct st_mysql_plugin	i_s_innodb_adaptive_hash_partitions;
+extern struct st_mysql_plugin	i_s_innodb_buffer_pool_flush_stats;
 extern struct st_mysql_plugin	i_s_innodb_sys_docstore;
 
 #endif /* i_s_h */
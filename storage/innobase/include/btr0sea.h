@@ -33,6 +33,7 @@ Created 2/17/1996 Heikki Tuuri
 #include "btr0types.h"
 #include "mtr0mtr.h"
 #include "ha0ha.h"
+#include "ut0counter.h"
 
 /*****************************************************************//**
 Creates and initializes the adaptive search system at a database start. */
@@ -70,6 +71,66 @@ void
 btr_search_enable(void);
 /*====================*/
 
+/********************************************************************//**
+Returns the adaptive hash index partition of an index.
+@return	partition number, less than btr_ahi_parts */
+UNIV_INLINE
+ulint
+btr_search_get_part_no(
+/*===================*/
+	const dict_index_t*	index)	/*!< in: index */
+	MY_ATTRIBUTE((nonnull, pure));
+/********************************************************************//**
+Returns the latch protecting the adaptive hash index partition
+of an index.
+@return	search latch of the partition */
+UNIV_INLINE
+rw_lock_t*
+btr_get_search_latch(
+/*=================*/
+	const dict_index_t*	index)	/*!< in: index */
+	MY_ATTRIBUTE((nonnull, pure));
+/********************************************************************//**
+Returns the hash table of the adaptive hash index partition of an index.
+@return	hash table of the partition */
+UNIV_INLINE
+hash_table_t*
+btr_get_search_table(
+/*=================*/
+	const dict_index_t*	index)	/*!< in: index */
+	MY_ATTRIBUTE((nonnull, pure));
+/********************************************************************//**
+X-latches the latches of all adaptive hash index partitions. */
+UNIV_INTERN
+void
+btr_search_x_lock_all(void);
+/*========================*/
+/********************************************************************//**
+Releases the x-latches of all adaptive hash index partitions. */
+UNIV_INTERN
+void
+btr_search_x_unlock_all(void);
+/*==========================*/
+#ifdef UNIV_SYNC_DEBUG
+/********************************************************************//**
+Checks if the thread owns the latch of any adaptive hash index partition
+in the given mode.
+@return	TRUE if it owns one */
+UNIV_INTERN
+ibool
+btr_search_own_any(
+/*===============*/
+	ulint	lock_type);	/*!< in: RW_LOCK_SHARED or RW_LOCK_EX */
+/********************************************************************//**
+Checks if the thread owns the latches of all adaptive hash index
+partitions in exclusive mode.
+@return	TRUE if it owns all of them */
+UNIV_INTERN
+ibool
+btr_search_own_all_x(void);
+/*=======================*/
+#endif /* UNIV_SYNC_DEBUG */
+
 /********************************************************************//**
 Returns search info for an index.
 @return	search info; search mutex reserved */
@@ -88,14 +149,15 @@ btr_search_info_create(
 /*===================*/
 	mem_heap_t*	heap);	/*!< in: heap where created */
 /*****************************************************************//**
-Returns the value of ref_count. The value is protected by
-btr_search_latch.
+Returns the value of ref_count. The value is protected by the
+search latch of the index.
 @return	ref_count value. */
 UNIV_INTERN
 ulint
 btr_search_info_get_ref_count(
 /*==========================*/
-	btr_search_t*   info);	/*!< in: search info. */
+	btr_search_t*		info,	/*!< in: search info. */
+	const dict_index_t*	index);	/*!< in: index of info */
 /*********************************************************************//**
 Updates the search info. */
 UNIV_INLINE
@@ -121,8 +183,9 @@ btr_search_guess_on_hash(
 	ulint		latch_mode,	/*!< in: BTR_SEARCH_LEAF, ... */
 	btr_cur_t*	cursor,		/*!< out: tree cursor */
 	ulint		has_search_latch,/*!< in: latch mode the caller
-					currently has on btr_search_latch:
-					RW_S_LATCH, RW_X_LATCH, or 0 */
+					currently has on the search latch
+					of index: RW_S_LATCH, RW_X_LATCH,
+					or 0 */
 	mtr_t*		mtr);		/*!< in: mtr */
 /********************************************************************//**
 Moves or deletes hash entries for moved records. If new_page is already hashed,
@@ -205,8 +268,9 @@ struct btr_search_t{
 	ulint	ref_count;	/*!< Number of blocks in this index tree
 				that have search index built
 				i.e. block->index points to this index.
-				Protected by btr_search_latch except
-				when during initialization in
+				Protected by the search latch of
+				the index except when during
+				initialization in
 				btr_search_info_create(). */
 
 	/* @{ The following fields are not protected by any latch.
@@ -255,11 +319,24 @@ struct btr_search_t{
 #endif /* UNIV_DEBUG */
 };
 
+/** A partition of the adaptive hash index */
+struct btr_search_part_t{
+	hash_table_t*	hash_index;	/*!< the hash table of the partition,
+					mapping dtuple_fold values
+					to rec_t pointers on index pages;
+					it has its own memory heap */
+	ib_counter_t<ulint, IB_N_SLOTS>	n_hits;
+					/*!< number of successful lookups */
+	ib_counter_t<ulint, IB_N_SLOTS>	n_misses;
+					/*!< number of failed lookups */
+};
+
 /** The hash index system */
 struct btr_search_sys_t{
-	hash_table_t*	hash_index;	/*!< the adaptive hash index,
-					mapping dtuple_fold values
-					to rec_t pointers on index pages */
+	btr_search_part_t*	parts;	/*!< the btr_ahi_parts partitions of
+					the adaptive hash index; the
+					partition of an index is chosen by
+					its index id */
 };
 
 /** The adaptive hash index */
@@ -285,6 +362,9 @@ pattern */
 the hash index */
 #define BTR_SEARCH_ON_HASH_LIMIT	3
 
+/** Maximum value of btr_ahi_parts */
+#define BTR_AHI_PARTS_MAX		512
+
 /** We do this many searches before trying to keep the search latch
 over calls from MySQL. If we notice someone waiting for the latch, we
 again set this much timeout. This is to reduce contention. */
@@ -41,28 +41,30 @@ struct btr_search_t;
 
 #ifndef UNIV_HOTBACKUP
 
-/** @brief The latch protecting the adaptive search system
+/** Number of adaptive hash index partitions */
+extern ulong		btr_ahi_parts;
 
-This latch protects the
-(1) hash index;
-(2) columns of a record to which we have a pointer in the hash index;
+/** @brief The latches protecting the adaptive search system
+
+The adaptive hash index is partitioned by index id into btr_ahi_parts
+hash tables. The latch of a partition protects the
+(1) hash index partition;
+(2) columns of a record to which we have a pointer in the partition;
 
 but does NOT protect:
 
 (3) next record offset field in a record;
 (4) next or previous records on the same page.
 
-Bear in mind (3) and (4) when using the hash index.
+Bear in mind (3) and (4) when using the hash index. Use
+btr_get_search_latch() to find the latch of an index.
 */
-extern rw_lock_t*	btr_search_latch_temp;
+extern rw_lock_t**	btr_search_latches;
 
 #endif /* UNIV_HOTBACKUP */
 
-/** The latch protecting the adaptive search system */
-#define btr_search_latch	(*btr_search_latch_temp)
-
 /** Flag: has the search system been enabled?
-Protected by btr_search_latch. */
+Protected by all of btr_search_latches. */
 extern char	btr_search_enabled;
 
 #ifdef UNIV_BLOB_DEBUG
@@ -1834,7 +1834,7 @@ struct buf_block_t{
 
 	/** @name Hash search fields
 	These 5 fields may only be modified when we have
-	an x-latch on btr_search_latch AND
+	an x-latch on the search latch of the index AND
 	- we are holding an s-latch or x-latch on buf_block_t::lock or
 	- we know that buf_block_t::buf_fix_count == 0.
 
@@ -1842,7 +1842,8 @@ struct buf_block_t{
 	in the buffer pool in buf0buf.cc.
 
 	Another exception is that assigning block->index = NULL
-	is allowed whenever holding an x-latch on btr_search_latch. */
+	is allowed whenever holding an x-latch on the search latch
+	of block->index. */
 
 	/* @{ */
 
@@ -2232,6 +2233,15 @@ struct buf_pool_t{
 	ulint		n_flushed[BUF_FLUSH_N_TYPES];
 					/*!< this is the number of total
 					writes in the given flush type */
+	ulint		n_flush_batches[BUF_FLUSH_N_TYPES];
+					/*!< number of LRU and flush list
+					batches run on this instance */
+	ib_uint64_t	flush_batch_usec[BUF_FLUSH_N_TYPES];
+					/*!< time spent in the LRU and
+					flush list batches, in
+					microseconds; like n_flush_batches
+					it is written by the thread that
+					owns init_flush[] */
 	os_event_t	no_flush[BUF_FLUSH_N_TYPES];
 					/*!< this is in the set state
 					when there is no flush batch
@@ -210,7 +210,9 @@ buf_flush_ready_for_replace(
 				buf_page_in_file(bpage) and in the LRU list */
 /******************************************************************//**
 page_cleaner thread tasked with flushing dirty pages from the buffer
-pools. As of now we'll have only one instance of this thread.
+pools. As of now we'll have only one instance of this thread. It
+flushes the buffer pool instances in parallel with the page cleaner
+workers.
 @return a dummy parameter */
 extern "C" UNIV_INTERN
 os_thread_ret_t
@@ -218,6 +220,49 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 /*==========================================*/
 	void*	arg);		/*!< in: a dummy parameter required by
 				os_thread_create */
+/******************************************************************//**
+Page cleaner worker thread, innodb_page_cleaners - 1 of them. It runs
+the flush list batches requested by the page_cleaner thread and the LRU
+batches requested by the lru_manager thread, one buffer pool instance
+at a time, until shutdown.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_flush_page_cleaner_worker)(
+/*==========================================*/
+	void*	arg);		/*!< in: a dummy parameter required by
+				os_thread_create */
+/******************************************************************//**
+Creates the structure that hands buffer pool instances to the page
+cleaner workers. Must be called before the page cleaner, lru_manager
+and worker threads are created. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_init(void);
+/*=============================*/
+/******************************************************************//**
+Wakes up the page cleaner workers so that they notice the shutdown. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_wakeup_workers(void);
+/*=======================================*/
+/******************************************************************//**
+Frees the structure created by buf_flush_page_cleaner_init() after all
+the threads using it have exited. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_close(void);
+/*==============================*/
+/******************************************************************//**
+Returns the oldest modification of the dirty pages in a buffer pool
+instance.
+@return oldest_modification of the last page in the flush list, or 0 if
+the instance has no dirty pages */
+UNIV_INTERN
+lsn_t
+buf_flush_get_oldest_modification(
+/*==============================*/
+	buf_pool_t*	buf_pool);	/*!< in: buffer pool instance */
 
 /******************************************************************//**
 lru_manager thread tasked with performing LRU flushes and evictions to refill
@@ -977,6 +977,11 @@ struct dict_table_t{
 				temp\... */
 	char*		data_dir_path; /*!< NULL or the directory path
 				specified by DATA DIRECTORY */
+	ulint		zip_algorithm;
+				/*!< page_zip_algorithm_t from the
+				COMPRESSION_ALGORITHM table comment hint,
+				or ULINT_UNDEFINED to use
+				innodb_compression_algorithm */
 	unsigned	space:32;
 				/*!< space where the clustered index of the
 				table is placed */
@@ -1242,7 +1247,7 @@ struct dict_table_t{
 	const trx_t*	autoinc_trx;
 				/*!< The transaction that currently holds the
 				the AUTOINC lock on this table.
-				Protected by lock_sys->mutex. */
+				Protected by lock_sys->latch. */
 	fts_t*		fts;	/* FTS specific state variables */
 				/* @} */
 	/*----------------------*/
@@ -1258,7 +1263,8 @@ struct dict_table_t{
 				/*!< Count of the number of record locks on
 				this table. We use this to determine whether
 				we can evict the table from the dictionary
-				cache. It is protected by lock_sys->mutex. */
+				cache. It is protected by lock_sys->latch,
+				increments in s-mode are atomic. */
 	ulint		n_ref_count;
 				/*!< count of how many handles are opened
 				to this table; dropping of the table is
@@ -1270,7 +1276,7 @@ struct dict_table_t{
 				Protected by lock_sys::mutex */
 	UT_LIST_BASE_NODE_T(lock_t)
 			locks;	/*!< list of locks on the table; protected
-				by lock_sys->mutex */
+				by lock_sys->latch */
 #endif /* !UNIV_HOTBACKUP */
 
 #ifdef UNIV_DEBUG
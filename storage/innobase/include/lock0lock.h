@@ -668,7 +668,7 @@ lock_print_info_all_transactions(
 Return approximate number or record locks (bits set in the bitmap) for
 this transaction. Since delete-marked records may be removed, the
 record count will not be precise.
-The caller must be holding lock_sys->mutex. */
+The caller must be holding lock_sys->latch in x-mode. */
 UNIV_INTERN
 ulint
 lock_number_of_rows_locked(
@@ -940,12 +940,29 @@ struct lock_op_t{
 	enum lock_mode	mode;	/*!< lock mode */
 };
 
+/** Number of rec_hash shards, each with its own mutex. Must be a
+power of 2. */
+#define LOCK_REC_N_SHARDS	512
+
 /** The lock system struct */
 struct lock_sys_t{
-	ib_mutex_t	mutex;			/*!< Mutex protecting the
-						locks */
+	rw_lock_t	latch;			/*!< Global latch protecting
+						the locks. Table locks,
+						waiting requests, deadlock
+						detection and anything else
+						that looks at more than one
+						page take it in x-mode. The
+						record lock fast paths take
+						it in s-mode together with
+						the mutex of the rec_hash
+						shard of the page. */
 	hash_table_t*	rec_hash;		/*!< hash table of the record
 						locks */
+	ib_mutex_t*	rec_shards;		/*!< LOCK_REC_N_SHARDS mutexes,
+						rec_hash cell i is protected by
+						rec_shards[i % LOCK_REC_N_SHARDS]
+						when lock_sys->latch is only
+						s-latched */
 	ib_mutex_t	wait_mutex;		/*!< Mutex protecting the
 						next two fields */
 	srv_slot_t*	waiting_threads;	/*!< Array  of user threads
@@ -960,7 +977,7 @@ struct lock_sys_t{
 						/*!< TRUE if rollback of all
 						recovered transactions is
 						complete. Protected by
-						lock_sys->mutex */
+						lock_sys->latch */
 
 	ulint		n_lock_max_wait_time;	/*!< Max wait time */
 
@@ -976,20 +993,53 @@ struct lock_sys_t{
 /** The lock system */
 extern lock_sys_t*	lock_sys;
 
-/** Test if lock_sys->mutex can be acquired without waiting. */
-#define lock_mutex_enter_nowait() mutex_enter_nowait(&lock_sys->mutex)
+/** Try to x-latch lock_sys->latch without waiting.
+@return 0 on success, like mutex_enter_nowait() */
+#define lock_mutex_enter_nowait()			\
+	(!rw_lock_x_lock_nowait(&lock_sys->latch))
 
-/** Test if lock_sys->mutex is owned. */
-#define lock_mutex_own() mutex_own(&lock_sys->mutex)
+/** Test if lock_sys->latch is x-latched by the current thread. */
+#ifdef UNIV_SYNC_DEBUG
+# define lock_mutex_own() rw_lock_own(&lock_sys->latch, RW_LOCK_EX)
+#else
+# define lock_mutex_own()					\
+	(rw_lock_get_writer(&lock_sys->latch) == RW_LOCK_EX	\
+	 && lock_sys->latch.recursive				\
+	 && os_thread_eq(lock_sys->latch.writer_thread,	\
+			 os_thread_get_curr_id()))
+#endif /* UNIV_SYNC_DEBUG */
 
-/** Acquire the lock_sys->mutex. */
+/** Acquire lock_sys->latch in x-mode. */
 #define lock_mutex_enter() do {			\
-	mutex_enter(&lock_sys->mutex);		\
+	rw_lock_x_lock(&lock_sys->latch);	\
 } while (0)
 
-/** Release the lock_sys->mutex. */
+/** Release lock_sys->latch from x-mode. */
 #define lock_mutex_exit() do {			\
-	mutex_exit(&lock_sys->mutex);		\
+	rw_lock_x_unlock(&lock_sys->latch);	\
+} while (0)
+
+/*********************************************************************//**
+Gets the rec_hash shard mutex of a page.
+@return	shard mutex */
+UNIV_INLINE
+ib_mutex_t*
+lock_rec_get_shard(
+/*===============*/
+	ulint	hash_val);	/*!< in: lock_rec_hash() of the page */
+
+/** S-latch lock_sys->latch and acquire the rec_hash shard mutex of a
+page. Record locks of the page can then be read and created for the
+current transaction, without waiting or checking for deadlocks. */
+#define lock_rec_shard_enter(hash_val) do {		\
+	rw_lock_s_lock(&lock_sys->latch);		\
+	mutex_enter(lock_rec_get_shard(hash_val));	\
+} while (0)
+
+/** Release what lock_rec_shard_enter() acquired. */
+#define lock_rec_shard_exit(hash_val) do {		\
+	mutex_exit(lock_rec_get_shard(hash_val));	\
+	rw_lock_s_unlock(&lock_sys->latch);		\
 } while (0)
 
 /** Test if lock_sys->wait_mutex is owned. */
@@ -72,6 +72,20 @@ static const char ib_logfile_basename[] = "ib_logfile";
 /** Maximum number of log groups in log_group_t::checkpoint_buf */
 #define LOG_MAX_N_GROUPS	32
 
+/** Number of log buffer ranges that mini-transactions can be copying
+their log records into at the same time, see log_t::copy_slots */
+#define LOG_COPY_SLOTS		1024
+
+/** Number of events log_write_up_to waiters are spread over by the lsn
+they wait for, see log_t::flush_events */
+#define LOG_FLUSH_EVENTS	128
+
+/** A log buffer range reserved with log_reserve_for_copy */
+struct log_copy_t {
+	byte*	ptr;		/*!< where the next byte is copied to */
+	ulint	slot;		/*!< index in log_t::copy_slots */
+};
+
 /*******************************************************************//**
 Calculates where in log files we find a specified lsn.
 @return	log file number */
@@ -135,6 +149,36 @@ log_write_low(
 	byte*	str,		/*!< in: string */
 	ulint	str_len);	/*!< in: string length */
 /************************************************************//**
+Reserves space for a log record group of the given length in the log
+buffer, so that the records can be copied into it by log_write_reserved
+after the log mutex is released. Must be called between
+log_reserve_and_open and log_close. */
+UNIV_INTERN
+void
+log_reserve_for_copy(
+/*=================*/
+	ulint		len,	/*!< in: length of the log record group,
+				as passed to log_reserve_and_open */
+	log_copy_t*	copy);	/*!< out: the reserved range */
+/************************************************************//**
+Copies the string given to a range reserved by log_reserve_for_copy.
+The caller does not hold the log mutex. */
+UNIV_INTERN
+void
+log_write_reserved(
+/*===============*/
+	log_copy_t*	copy,	/*!< in/out: the reserved range */
+	const byte*	str,	/*!< in: string */
+	ulint		str_len);/*!< in: string length */
+/************************************************************//**
+Marks a range reserved by log_reserve_for_copy as completely copied, so
+that log_write_up_to can write it. */
+UNIV_INTERN
+void
+log_copy_complete(
+/*==============*/
+	const log_copy_t*	copy);	/*!< in: the reserved range */
+/************************************************************//**
 Closes the log.
 @return	lsn */
 UNIV_INTERN
@@ -792,6 +836,14 @@ struct log_group_t{
 			log_groups;	/*!< list of log groups */
 };
 
+/** A log buffer range that a mini-transaction copies its log records
+into without holding the log mutex */
+struct log_copy_slot_t {
+	lsn_t		start_lsn;	/*!< lsn of the start of the range */
+	volatile ibool	done;		/*!< TRUE when the range has been
+					copied */
+};
+
 /** Redo log buffer */
 struct log_t{
 	byte		pad[64];	/*!< padding to prevent other memory
@@ -850,6 +902,24 @@ struct log_t{
 					groups */
 	volatile bool	is_extending;	/*!< this is set to true during extend
 					the log buffer size */
+	log_copy_slot_t	copy_slots[LOG_COPY_SLOTS];
+					/*!< ring of the log buffer ranges
+					reserved by log_reserve_for_copy, in
+					lsn order; the data in the log buffer
+					is complete up to the start of the
+					first range not yet copied */
+	ib_uint64_t	n_copies_reserved;/*!< number of ranges reserved by
+					log_reserve_for_copy */
+	ib_uint64_t	n_copies_done;	/*!< number of ranges, in reservation
+					order, known to be completely copied;
+					this and n_copies_reserved are
+					protected by the log mutex */
+	byte*		write_buf_ptr;	/*!< unaligned write buffer */
+	byte*		write_buf;	/*!< the log blocks of a write are
+					copied here, so that the write can run
+					without the log mutex while
+					mini-transactions keep filling the
+					last block in the log buffer */
 	lsn_t		written_to_some_lsn;
 					/*!< first log sequence number not yet
 					written to any log group; for this to
@@ -897,25 +967,18 @@ struct log_t{
 	4.0.14, we separate the write of the log file and the actual fsync()
 	or other method to flush it to disk. The names below shhould really
 	be 'flush_or_write'! */
-	os_event_t	no_flush_event;	/*!< this event is in the reset state
-					when a flush or a write is running;
-					a thread should wait for this without
-					owning the log mutex, but NOTE that
-					to set or reset this event, the
-					thread MUST own the log mutex! */
 	ibool		one_flushed;	/*!< during a flush, this is
 					first FALSE and becomes TRUE
 					when one log group has been
 					written or flushed */
-	os_event_t	one_flushed_event;/*!< this event is reset when the
-					flush or write has not yet completed
-					for any log group; e.g., this means
-					that a transaction has been committed
-					when this is set; a thread should wait
-					for this without owning the log mutex,
-					but NOTE that to set or reset this
-					event, the thread MUST own the log
-					mutex! */
+	os_event_t	flush_events[LOG_FLUSH_EVENTS];
+					/*!< a thread waiting for a write or
+					flush up to an lsn waits for the event
+					of the log block of that lsn, see
+					log_flush_event(); when a write ends,
+					the events of the log blocks it wrote
+					are set. To reset or set these events
+					the thread MUST own the log mutex! */
 	ulint		n_log_ios;	/*!< number of log i/os initiated thus
 					far */
 	ulint		n_log_ios_old;	/*!< number of log i/o's at the
@@ -49,6 +49,23 @@ extern uint	page_zip_level;
 /* Default compression level. */
 #define DEFAULT_COMPRESSION_LEVEL	6
 
+/** Compression algorithms for compressed pages. Every page records the
+algorithm it was compressed with, so pages of a tablespace may use
+different algorithms. */
+enum page_zip_algorithm_t {
+	PAGE_ZIP_ALGORITHM_ZLIB = 0,	/*!< zlib deflate */
+	PAGE_ZIP_ALGORITHM_LZ4,		/*!< LZ4, for fast decompression */
+	PAGE_ZIP_ALGORITHM_ZSTD		/*!< Zstandard, for better ratio */
+};
+
+/** Largest zlib strategy (Z_FIXED) in the compression flags. The larger
+values of the strategy bits select the other algorithms. */
+#define PAGE_ZIP_STRATEGY_MAX		4
+
+/* Compression algorithm used for tables without a COMPRESSION_ALGORITHM
+table comment hint, a page_zip_algorithm_t. Settable by user. */
+extern ulong	page_zip_algorithm;
+
 /* Whether or not to log compressed page images to avoid possible
 compression algorithm changes in zlib. */
 extern my_bool	page_zip_log_pages;
@@ -507,7 +524,8 @@ page_zip_decode_compression_flags(
 	uchar  flags,
 	uint*  level,
 	uint*  no_wrap,
-	uint*  strategy);
+	uint*  strategy,
+	uint*  algorithm);
 
 /**********************************************************************//**
 Write the compression level and other compression options into the compression
@@ -518,13 +536,25 @@ page_zip_encode_compression_flags(
 /*=============================*/
 	uint  level,
 	uint  no_wrap,
-	uint  strategy);
+	uint  strategy,
+	uint  algorithm);
+
+/**********************************************************************//**
+Get the compression algorithm to use for the pages of a table.
+@return the COMPRESSION_ALGORITHM hint of the table, or
+innodb_compression_algorithm */
+UNIV_INTERN
+ulint
+page_zip_get_algorithm(
+/*===================*/
+	const dict_table_t*	table);	/*!< in: table */
 
-#define page_zip_compression_flags \
+#define page_zip_compression_flags(index) \
     page_zip_encode_compression_flags( \
     page_zip_level, \
     page_zip_zlib_wrap, \
-    page_zip_zlib_strategy)
+    page_zip_zlib_strategy, \
+    page_zip_get_algorithm((index)->table))
 
 /**********************************************************************//**
 Parses a log record of compressing an index page without the data.
@@ -66,6 +66,23 @@ read_view_remove(
 	bool		own_mutex);	/*!< in: true if caller owns the
 					trx_sys_t::mutex */
 /*********************************************************************//**
+Releases a reference to a shared snapshot of the active read-write
+transactions, and frees the snapshot when it was the last one. */
+UNIV_INLINE
+void
+read_view_ids_release(
+/*==================*/
+	read_view_ids_t*	ids);	/*!< in/out: snapshot */
+/*********************************************************************//**
+Drops the snapshot of the active read-write transactions shared by new
+read views. Must be called when a read-write transaction commits in memory
+or is removed from trx_sys->rw_trx_list, so that the next read view sees
+its changes. */
+UNIV_INTERN
+void
+read_view_ids_invalidate(void);
+/*===========================*/
+/*********************************************************************//**
 Closes a consistent read view for MySQL. This function is called at an SQL
 statement end if the trx isolation level is <= TRX_ISO_READ_COMMITTED. */
 UNIV_INTERN
@@ -156,10 +173,42 @@ struct read_view_t{
 	trx_id_t	creator_trx_id;
 				/*!< trx id of creating transaction, or
 				0 used in purge */
+	read_view_ids_t*
+			ids;	/*!< Shared snapshot that the limits and
+				trx_ids are taken from, or NULL if the view
+				owns a copy of them. A view sharing a
+				snapshot can list the creating transaction
+				in trx_ids or have low_limit_id <=
+				creator_trx_id: read_view_sees_trx_id()
+				checks the creator first. */
 	UT_LIST_NODE_T(read_view_t) view_list;
 				/*!< List of read views in trx_sys */
 };
 
+/** Snapshot of the active read-write transactions, shared by all the
+normal read views opened until the next read-write transaction commits.
+It is built by the first read view opened after trx_sys->view_ids was
+invalidated, so that consecutive consistent reads do not copy
+trx_sys->rw_trx_list while it does not change. Starting transactions do
+not invalidate it: their ids are >= low_limit_id. */
+
+struct read_view_ids_t{
+	ulint		ref_count;
+				/*!< Number of read views using the snapshot,
+				plus one while it is trx_sys->view_ids;
+				protected by trx_sys->mutex */
+	trx_id_t	low_limit_no;
+				/*!< read_view_t::low_limit_no */
+	trx_id_t	low_limit_id;
+				/*!< read_view_t::low_limit_id */
+	trx_id_t	up_limit_id;
+				/*!< read_view_t::up_limit_id */
+	ulint		n_trx_ids;
+				/*!< Number of cells in the trx_ids array */
+	trx_id_t*	trx_ids;/*!< Active read-write transaction ids, in
+				descending order */
+};
+
 /** Read view types @{ */
 #define VIEW_NORMAL		1	/*!< Normal consistent read view
 					where transaction does not see changes
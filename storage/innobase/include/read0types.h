@@ -27,6 +27,7 @@ Created 2/16/1997 Heikki Tuuri
 #define read0types_h
 
 struct read_view_t;
+struct read_view_ids_t;
 struct cursor_view_t;
 
 #endif
@@ -217,6 +217,15 @@ and/or load it during startup. */
 extern char		srv_buffer_pool_dump_at_shutdown;
 extern char		srv_buffer_pool_load_at_startup;
 
+/** Whether the buffer pool dump is written in the compact format */
+extern my_bool		srv_buf_dump_compact;
+
+/** Seconds between two buffer pool dumps, 0 to only dump on request */
+extern ulong		srv_buf_dump_interval;
+
+/** Number of threads that read the pages of a buffer pool load */
+extern ulong		srv_buf_load_threads;
+
 /* Whether to disable file system cache if it is defined */
 extern char		srv_disable_sort_file_cache;
 
@@ -655,6 +664,9 @@ extern ulint	srv_cleaner_max_lru_time;
 /* Enable adaptive sleep time calculation for page cleaner thread if enabled. */
 extern my_bool	srv_pc_adaptive_sleep;
 
+/** Number of threads flushing buffer pool instances in parallel */
+extern ulong	srv_n_page_cleaners;
+
 /*big_file_slow_removal speed*/
 extern ulong srv_slowrm_speed_mbps;
 
@@ -668,6 +680,7 @@ extern srv_stats_t	srv_stats;
 /* Keys to register InnoDB threads with performance schema */
 extern mysql_pfs_key_t	buf_page_cleaner_thread_key;
 extern mysql_pfs_key_t  buf_lru_manager_thread_key;
+extern mysql_pfs_key_t	buf_page_cleaner_worker_thread_key;
 extern mysql_pfs_key_t	trx_rollback_clean_thread_key;
 extern mysql_pfs_key_t	io_handler_thread_key;
 extern mysql_pfs_key_t	srv_lock_timeout_thread_key;
@@ -215,7 +215,7 @@ trx_read_trx_id(
 Looks for the trx instance with the given id in the rw trx_list.
 The caller must be holding trx_sys->mutex.
 @return	the trx handle or NULL if not found;
-the pointer must not be dereferenced unless lock_sys->mutex was
+the pointer must not be dereferenced unless lock_sys->latch was
 acquired before calling this function and is still being held */
 UNIV_INLINE
 trx_t*
@@ -235,9 +235,9 @@ trx_rw_min_trx_id(void);
 /****************************************************************//**
 Checks if a rw transaction with the given id is active. Caller must hold
 trx_sys->mutex in shared mode. If the caller is not holding
-lock_sys->mutex, the transaction may already have been committed.
+lock_sys->latch, the transaction may already have been committed.
 @return	transaction instance if active, or NULL;
-the pointer must not be dereferenced unless lock_sys->mutex was
+the pointer must not be dereferenced unless lock_sys->latch was
 acquired before calling this function and is still being held */
 UNIV_INLINE
 trx_t*
@@ -248,10 +248,10 @@ trx_rw_is_active_low(
 					that will be set if corrupt */
 /****************************************************************//**
 Checks if a rw transaction with the given id is active. If the caller is
-not holding lock_sys->mutex, the transaction may already have been
+not holding lock_sys->latch, the transaction may already have been
 committed.
 @return	transaction instance if active, or NULL;
-the pointer must not be dereferenced unless lock_sys->mutex was
+the pointer must not be dereferenced unless lock_sys->latch was
 acquired before calling this function and is still being held */
 UNIV_INLINE
 trx_t*
@@ -669,6 +669,11 @@ struct trx_sys_t{
 	UT_LIST_BASE_NODE_T(read_view_t) view_list;
 					/*!< List of read views sorted
 					on trx no, biggest first */
+	read_view_ids_t* view_ids;	/*!< Snapshot of rw_trx_list shared
+					by the read views opened since it
+					was taken, or NULL if a read-write
+					transaction was removed from
+					rw_trx_list since then */
 };
 
 /** When a trx id which is zero modulo this number (which must be a power of
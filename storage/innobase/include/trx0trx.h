@@ -260,7 +260,7 @@ This function is used to find one X/Open XA distributed transaction
 which is in the prepared state
 @return	trx or NULL; on match, the trx->xid will be invalidated;
 note that the trx may have been committed, unless the caller is
-holding lock_sys->mutex */
+holding lock_sys->latch */
 UNIV_INTERN
 trx_t *
 trx_get_trx_by_xid(
@@ -341,7 +341,7 @@ trx_print_low(
 
 /**********************************************************************//**
 Prints info about a transaction.
-The caller must hold lock_sys->mutex and trx_sys->mutex.
+The caller must hold lock_sys->latch and trx_sys->mutex.
 When possible, use trx_print() instead. */
 UNIV_INTERN
 void
@@ -355,7 +355,7 @@ trx_print_latched(
 
 /**********************************************************************//**
 Prints info about a transaction.
-Acquires and releases lock_sys->mutex and trx_sys->mutex. */
+Acquires and releases lock_sys->latch and trx_sys->mutex. */
 UNIV_INTERN
 void
 trx_print(
@@ -583,7 +583,7 @@ To query the state either of the mutexes is sufficient within the locking
 code and no mutex is required when the query thread is no longer waiting. */
 
 /** The locks and state of an active transaction. Protected by
-lock_sys->mutex, trx->mutex or both. */
+lock_sys->latch, trx->mutex or both. */
 struct trx_lock_t {
 	ulint		n_active_thrs;	/*!< number of active query threads */
 
@@ -595,10 +595,10 @@ struct trx_lock_t {
 					TRX_QUE_LOCK_WAIT, this points to
 					the lock request, otherwise this is
 					NULL; set to non-NULL when holding
-					both trx->mutex and lock_sys->mutex;
+					both trx->mutex and lock_sys->latch;
 					set to NULL when holding
-					lock_sys->mutex; readers should
-					hold lock_sys->mutex, except when
+					lock_sys->latch; readers should
+					hold lock_sys->latch, except when
 					they are holding trx->mutex and
 					wait_lock==NULL */
 	ib_uint64_t	deadlock_mark;	/*!< A mark field that is initialized
@@ -612,25 +612,32 @@ struct trx_lock_t {
 					resolution, it sets this to TRUE.
 					Protected by trx->mutex. */
 	time_t		wait_started;	/*!< lock wait started at this time,
-					protected only by lock_sys->mutex */
+					protected only by lock_sys->latch */
 
 	que_thr_t*	wait_thr;	/*!< query thread belonging to this
 					trx that is in QUE_THR_LOCK_WAIT
 					state. For threads suspended in a
 					lock wait, this is protected by
-					lock_sys->mutex. Otherwise, this may
+					lock_sys->latch. Otherwise, this may
 					only be modified by the thread that is
 					serving the running transaction. */
 
 	mem_heap_t*	lock_heap;	/*!< memory heap for trx_locks;
-					protected by lock_sys->mutex */
+					protected by lock_sys->latch in
+					x-mode, or in s-mode together with
+					a rec_hash shard mutex when the
+					thread serving the transaction
+					creates one of its own locks */
 
 	UT_LIST_BASE_NODE_T(lock_t)
 			trx_locks;	/*!< locks requested
 					by the transaction;
 					insertions are protected by trx->mutex
-					and lock_sys->mutex; removals are
-					protected by lock_sys->mutex */
+					and lock_sys->latch (x-mode, or
+					s-mode with the rec_hash shard of the
+					page of a granted record lock);
+					removals are protected by
+					lock_sys->latch in x-mode */
 
 	ib_vector_t*	table_locks;	/*!< All table locks requested by this
 					transaction, including AUTOINC locks */
@@ -786,7 +793,7 @@ transactions. The trx_sys->mutex prevents a race condition between it
 and lock_trx_release_locks() [invoked by trx_commit()].
 
 * trx_print_low() may access transactions not associated with the current
-thread. The caller must be holding trx_sys->mutex and lock_sys->mutex.
+thread. The caller must be holding trx_sys->mutex and lock_sys->latch.
 
 * When a transaction handle is in the trx_sys->mysql_trx_list or
 trx_sys->trx_list, some of its fields must not be modified without
@@ -795,7 +802,7 @@ holding trx_sys->mutex exclusively.
 * The locking code (in particular, lock_deadlock_recursive() and
 lock_rec_convert_impl_to_expl()) will access transactions associated
 to other connections. The locks of transactions are protected by
-lock_sys->mutex and sometimes by trx->mutex. */
+lock_sys->latch and sometimes by trx->mutex. */
 
 struct trx_t{
 	ulint		magic_n;
@@ -803,7 +810,7 @@ struct trx_t{
 	ib_mutex_t	mutex;		/*!< Mutex protecting the fields
 					state and lock
 					(except some fields of lock, which
-					are protected by lock_sys->mutex) */
+					are protected by lock_sys->latch) */
 
 	/** State of the trx from the point of view of concurrency control
 	and the valid state transitions.
@@ -851,7 +858,7 @@ struct trx_t{
 	ACTIVE->COMMITTED is possible when the transaction is in
 	ro_trx_list or rw_trx_list.
 
-	Transitions to COMMITTED are protected by both lock_sys->mutex
+	Transitions to COMMITTED are protected by both lock_sys->latch
 	and trx->mutex.
 
 	NOTE: Some of these state change constraints are an overkill,
@@ -865,7 +872,7 @@ struct trx_t{
 
 	trx_lock_t	lock;		/*!< Information about the transaction
 					locks and state. Protected by
-					trx->mutex or lock_sys->mutex
+					trx->mutex or lock_sys->latch
 					or both */
 	ulint		is_recovered;	/*!< 0=normal transaction,
 					1=recovered, must be rolled back,
@@ -936,6 +943,9 @@ struct trx_t{
 	ulint		has_search_latch;
 					/*!< TRUE if this trx has latched the
 					search system latch in S-mode */
+	rw_lock_t*	search_latch;	/*!< the adaptive hash index
+					partition latch this trx holds
+					when has_search_latch is set */
 	ulint		search_latch_timeout;
 					/*!< If we notice that someone is
 					waiting for our S-lock on the search
@@ -1119,7 +1129,7 @@ struct trx_t{
 					also in the lock list trx_locks. This
 					vector needs to be freed explicitly
 					when the trx instance is destroyed.
-					Protected by lock_sys->mutex. */
+					Protected by lock_sys->latch. */
 	/*------------------------------*/
 	ibool		read_only;	/*!< TRUE if transaction is flagged
 					as a READ-ONLY transaction.
@@ -1245,24 +1255,6 @@ struct commit_node_t{
 	mutex_exit(&t->mutex);			\
 } while (0)
 
-/** @brief The latch protecting the adaptive search system
-
-This latch protects the
-(1) hash index;
-(2) columns of a record to which we have a pointer in the hash index;
-
-but does NOT protect:
-
-(3) next record offset field in a record;
-(4) next or previous records on the same page.
-
-Bear in mind (3) and (4) when using the hash index.
-*/
-extern rw_lock_t*	btr_search_latch_temp;
-
-/** The latch protecting the adaptive search system */
-#define btr_search_latch	(*btr_search_latch_temp)
-
 #ifndef UNIV_NONINL
 #include "trx0trx.ic"
 #endif
@@ -40,6 +40,7 @@ Created 5/7/1996 Heikki Tuuri
 #include "dict0mem.h"
 #include "dict0boot.h"
 #include "trx0sys.h"
+#include "read0read.h"
 #include "pars0pars.h" /* pars_complete_graph_for_exec() */
 #include "que0que.h" /* que_node_get_parent() */
 #include "row0mysql.h" /* row_mysql_handle_errors() */
@@ -391,11 +392,16 @@ static const ulint	lock_types = UT_ARR_SIZE(lock_compatibility_matrix);
 
 #ifdef UNIV_PFS_MUTEX
 /* Key to register mutex with performance schema */
-UNIV_INTERN mysql_pfs_key_t	lock_sys_mutex_key;
+UNIV_INTERN mysql_pfs_key_t	lock_sys_rec_shard_mutex_key;
 /* Key to register mutex with performance schema */
 UNIV_INTERN mysql_pfs_key_t	lock_sys_wait_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
+#ifdef UNIV_PFS_RWLOCK
+/* Key to register rwlock with performance schema */
+UNIV_INTERN mysql_pfs_key_t	lock_sys_latch_key;
+#endif /* UNIV_PFS_RWLOCK */
+
 #ifdef UNIV_DEBUG
 UNIV_INTERN ibool	lock_print_waits	= FALSE;
 
@@ -614,7 +620,7 @@ lock_sys_create(
 
 	lock_sys->last_slot = lock_sys->waiting_threads;
 
-	mutex_create(lock_sys_mutex_key, &lock_sys->mutex, SYNC_LOCK_SYS);
+	rw_lock_create(lock_sys_latch_key, &lock_sys->latch, SYNC_LOCK_SYS);
 
 	mutex_create(lock_sys_wait_mutex_key,
 		     &lock_sys->wait_mutex, SYNC_LOCK_WAIT_SYS);
@@ -623,6 +629,14 @@ lock_sys_create(
 
 	lock_sys->rec_hash = hash_create(n_cells);
 
+	lock_sys->rec_shards = static_cast<ib_mutex_t*>(
+		mem_zalloc(LOCK_REC_N_SHARDS * sizeof(ib_mutex_t)));
+
+	for (ulint i = 0; i < LOCK_REC_N_SHARDS; i++) {
+		mutex_create(lock_sys_rec_shard_mutex_key,
+			     &lock_sys->rec_shards[i], SYNC_LOCK_REC_SHARD);
+	}
+
 	if (!srv_read_only_mode) {
 		lock_latest_err_file = os_file_create_tmpfile(NULL);
 		ut_a(lock_latest_err_file);
@@ -670,7 +684,13 @@ lock_sys_close(void)
 
 	hash_table_free(lock_sys->rec_hash);
 
-	mutex_free(&lock_sys->mutex);
+	for (ulint i = 0; i < LOCK_REC_N_SHARDS; i++) {
+		mutex_free(&lock_sys->rec_shards[i]);
+	}
+
+	mem_free(lock_sys->rec_shards);
+
+	rw_lock_free(&lock_sys->latch);
 	mutex_free(&lock_sys->wait_mutex);
 
 	mem_free(lock_stack);
@@ -680,6 +700,24 @@ lock_sys_close(void)
 	lock_stack = NULL;
 }
 
+#ifdef UNIV_DEBUG
+/*********************************************************************//**
+Checks that the current thread may access the record locks of a page:
+it holds lock_sys->latch in x-mode, or the rec_hash shard mutex of the
+page.
+@return	true if it may */
+static
+bool
+lock_rec_page_own(
+/*==============*/
+	ulint	space,	/*!< in: space */
+	ulint	page_no)/*!< in: page number */
+{
+	return(lock_mutex_own()
+	       || mutex_own(lock_rec_get_shard(lock_rec_hash(space, page_no))));
+}
+#endif /* UNIV_DEBUG */
+
 /*********************************************************************//**
 Gets the size of a lock struct.
 @return	size in bytes */
@@ -746,7 +784,7 @@ lock_get_src_table(
 	Other transactions could want to convert one of our implicit
 	record locks to an explicit one. For that, they would need our
 	trx mutex. Waiting locks can be removed while only holding
-	lock_sys->mutex, but this is a running transaction and cannot
+	lock_sys->latch, but this is a running transaction and cannot
 	thus be holding any waiting locks. */
 	trx_mutex_enter(trx);
 
@@ -1187,12 +1225,13 @@ lock_rec_get_next_on_page_const(
 	ulint	space;
 	ulint	page_no;
 
-	ut_ad(lock_mutex_own());
 	ut_ad(lock_get_type_low(lock) == LOCK_REC);
 
 	space = lock->un_member.rec_lock.space;
 	page_no = lock->un_member.rec_lock.page_no;
 
+	ut_ad(lock_rec_page_own(space, page_no));
+
 	for (;;) {
 		lock = static_cast<const lock_t*>(HASH_GET_NEXT(hash, lock));
 
@@ -1236,7 +1275,7 @@ lock_rec_get_first_on_page_addr(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_page_own(space, page_no));
 
 	for (lock = static_cast<lock_t*>(
 			HASH_GET_FIRST(lock_sys->rec_hash,
@@ -1265,10 +1304,15 @@ lock_rec_expl_exist_on_page(
 	ulint	page_no)/*!< in: page number */
 {
 	lock_t*	lock;
+	ulint	hash_val;
+
+	rw_lock_s_lock(&lock_sys->latch);
+	hash_val = lock_rec_hash(space, page_no);
+	mutex_enter(lock_rec_get_shard(hash_val));
 
-	lock_mutex_enter();
 	lock = lock_rec_get_first_on_page_addr(space, page_no);
-	lock_mutex_exit();
+
+	lock_rec_shard_exit(hash_val);
 
 	return(lock);
 }
@@ -1288,7 +1332,7 @@ lock_rec_get_first_on_page(
 	ulint	space	= buf_block_get_space(block);
 	ulint	page_no	= buf_block_get_page_no(block);
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_page_own(space, page_no));
 
 	hash = buf_block_get_lock_hash_val(block);
 
@@ -1317,7 +1361,8 @@ lock_rec_get_next(
 	ulint	heap_no,/*!< in: heap number of the record */
 	lock_t*	lock)	/*!< in: lock */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_page_own(lock->un_member.rec_lock.space,
+				lock->un_member.rec_lock.page_no));
 
 	do {
 		ut_ad(lock_get_type_low(lock) == LOCK_REC);
@@ -1352,7 +1397,8 @@ lock_rec_get_first(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_page_own(buf_block_get_space(block),
+				buf_block_get_page_no(block)));
 
 	for (lock = lock_rec_get_first_on_page(block); lock;
 	     lock = lock_rec_get_next_on_page(lock)) {
@@ -1773,7 +1819,7 @@ lock_rec_other_trx_holds_expl(
 Return approximate number or record locks (bits set in the bitmap) for
 this transaction. Since delete-marked records may be removed, the
 record count will not be precise.
-The caller must be holding lock_sys->mutex. */
+The caller must be holding lock_sys->latch. */
 UNIV_INTERN
 ulint
 lock_number_of_rows_locked(
@@ -1861,7 +1907,6 @@ lock_rec_create(
 	ulint		n_bytes;
 	const page_t*	page;
 
-	ut_ad(lock_mutex_own());
 	ut_ad(caller_owns_trx_mutex == trx_mutex_own(trx));
 	ut_ad(dict_index_is_clust(index) || !dict_index_is_online_ddl(index));
 
@@ -1873,6 +1918,11 @@ lock_rec_create(
 	page_no	= buf_block_get_page_no(block);
 	page = block->frame;
 
+	/* Granted locks can also be created by lock_rec_lock_fast()
+	holding only the rec_hash shard of the page. */
+	ut_ad(lock_rec_page_own(space, page_no));
+	ut_ad(!(type_mode & LOCK_WAIT) || lock_mutex_own());
+
 	btr_assert_not_corrupted(block, index);
 
 	/* If rec is the supremum record, then we reset the gap and
@@ -1909,7 +1959,7 @@ lock_rec_create(
 	/* Set the bit corresponding to rec */
 	lock_rec_set_nth_bit(lock, heap_no);
 
-	index->table->n_rec_locks++;
+	os_atomic_increment_ulint(&index->table->n_rec_locks, 1);
 
 	ut_ad(index->table->n_ref_count > 0 || !index->table->can_be_evicted);
 
@@ -1938,8 +1988,8 @@ lock_rec_create(
 		trx_mutex_exit(trx);
 	}
 
-	MONITOR_INC(MONITOR_RECLOCK_CREATED);
-	MONITOR_INC(MONITOR_NUM_RECLOCK);
+	MONITOR_ATOMIC_INC(MONITOR_RECLOCK_CREATED);
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK);
 
 	return(lock);
 }
@@ -2187,7 +2237,8 @@ there are no explicit locks on the page, or there is just one lock, owned
 by this transaction, and of the right type_mode. This is a low-level function
 which does NOT look at implicit locks! Checks lock compatibility within
 explicit locks. This function sets a normal next-key lock, or in the case of
-a page supremum record, a gap type lock.
+a page supremum record, a gap type lock. It never waits, so the caller only
+needs to hold the rec_hash shard of the page.
 @return whether the locking succeeded */
 UNIV_INLINE
 enum lock_rec_req_status
@@ -2210,7 +2261,8 @@ lock_rec_lock_fast(
 	trx_t*			trx;
 	enum lock_rec_req_status status = LOCK_REC_SUCCESS;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_page_own(buf_block_get_space(block),
+				buf_block_get_page_no(block)));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2355,7 +2407,9 @@ Tries to lock the specified record in the mode requested. If not immediately
 possible, enqueues a waiting lock request. This is a low-level function
 which does NOT look at implicit locks! Checks lock compatibility within
 explicit locks. This function sets a normal next-key lock, or in the case
-of a page supremum record, a gap type lock.
+of a page supremum record, a gap type lock. The caller must not hold
+lock_sys->latch: the fast path only takes the rec_hash shard of the page,
+and the slow path x-latches lock_sys->latch.
 @return	DB_SUCCESS, DB_SUCCESS_LOCKED_REC, DB_LOCK_WAIT, DB_DEADLOCK,
 or DB_QUE_THR_SUSPENDED */
 static
@@ -2379,7 +2433,11 @@ lock_rec_lock(
 	dict_index_t*		index,	/*!< in: index of record */
 	que_thr_t*		thr)	/*!< in: query thread */
 {
-	ut_ad(lock_mutex_own());
+	ulint			hash_val = buf_block_get_lock_hash_val(block);
+	enum lock_rec_req_status status;
+	dberr_t			err;
+
+	ut_ad(!lock_mutex_own());
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2393,14 +2451,23 @@ lock_rec_lock(
 
 	/* We try a simplified and faster subroutine for the most
 	common cases */
-	switch (lock_rec_lock_fast(impl, mode, block, heap_no, index, thr)) {
+	lock_rec_shard_enter(hash_val);
+	status = lock_rec_lock_fast(impl, mode, block, heap_no, index, thr);
+	lock_rec_shard_exit(hash_val);
+
+	switch (status) {
 	case LOCK_REC_SUCCESS:
 		return(DB_SUCCESS);
 	case LOCK_REC_SUCCESS_CREATED:
 		return(DB_SUCCESS_LOCKED_REC);
 	case LOCK_REC_FAIL:
-		return(lock_rec_lock_slow(impl, mode, x_mode, block,
-					  heap_no, index, thr));
+		/* The queue may have changed after we released the
+		shard, lock_rec_lock_slow() looks at it again. */
+		lock_mutex_enter();
+		err = lock_rec_lock_slow(impl, mode, x_mode, block,
+					 heap_no, index, thr);
+		lock_mutex_exit();
+		return(err);
 	}
 
 	ut_error;
@@ -2453,7 +2520,7 @@ lock_rec_has_to_wait_in_queue(
 
 /*************************************************************//**
 Grants a lock to a waiting lock request and releases the waiting transaction.
-The caller must hold lock_sys->mutex but not lock->trx->mutex. */
+The caller must hold lock_sys->latch but not lock->trx->mutex. */
 static
 void
 lock_grant(
@@ -3713,7 +3780,7 @@ lock_deadlock_lock_print(
 	}
 }
 
-/** Used in deadlock tracking. Protected by lock_sys->mutex. */
+/** Used in deadlock tracking. Protected by lock_sys->latch. */
 static ib_uint64_t	lock_mark_counter = 0;
 
 /** Check if the search is too deep. */
@@ -5034,7 +5101,7 @@ lock_remove_recovered_trx_record_locks(
 			continue;
 		}
 
-		/* Because we are holding the lock_sys->mutex,
+		/* Because we are holding the lock_sys->latch,
 		implicit locks cannot be converted to explicit ones
 		while we are scanning the explicit locks. */
 
@@ -5468,7 +5535,7 @@ lock_print_info_all_transactions(
 	}
 
 loop:
-	/* Since we temporarily release lock_sys->mutex and
+	/* Since we temporarily release lock_sys->latch and
 	trx_sys->mutex when reading a database page in below,
 	variable trx may be obsolete now and we must loop
 	through the trx list to get probably the same trx,
@@ -5704,7 +5771,7 @@ lock_table_queue_validate(
 		/* lock->trx->state cannot change from or to NOT_STARTED
 		while we are holding the trx_sys->mutex. It may change
 		from ACTIVE to PREPARED, but it may not change to
-		COMMITTED, because we are holding the lock_sys->mutex. */
+		COMMITTED, because we are holding the lock_sys->latch. */
 		ut_ad(trx_assert_started(lock->trx));
 
 		if (!lock_get_wait(lock)) {
@@ -5796,7 +5863,7 @@ lock_rec_queue_validate(
 
 		ut_ad(lock_mutex_own());
 		/* impl_trx cannot be committed until lock_mutex_exit()
-		because lock_trx_release_locks() acquires lock_sys->mutex */
+		because lock_trx_release_locks() acquires lock_sys->latch */
 
 		if (impl_trx != NULL
 		    && lock_rec_other_has_expl_req(LOCK_S, 0, LOCK_WAIT,
@@ -6131,6 +6198,7 @@ lock_rec_insert_check_and_lock(
 	lock_t*		lock;
 	dberr_t		err;
 	ulint		next_rec_heap_no;
+	ulint		hash_val;
 	ibool		inherit_in = *inherit;
 
 	ut_ad(block->frame == page_align(rec));
@@ -6146,11 +6214,13 @@ lock_rec_insert_check_and_lock(
 	trx = thr_get_trx(thr);
 	next_rec = page_rec_get_next_const(rec);
 	next_rec_heap_no = page_rec_get_heap_no(next_rec);
+	hash_val = buf_block_get_lock_hash_val(block);
 
-	lock_mutex_enter();
-	/* Because this code is invoked for a running transaction by
-	the thread that is serving the transaction, it is not necessary
-	to hold trx->mutex here. */
+	/* Looking for locks on the successor only needs the rec_hash
+	shard of the page. Because this code is invoked for a running
+	transaction by the thread that is serving the transaction, it is
+	not necessary to hold trx->mutex here. */
+	lock_rec_shard_enter(hash_val);
 
 	/* When inserting a record into an index, the table must be at
 	least IX-locked. When we are building an index, we would pass
@@ -6159,11 +6229,11 @@ lock_rec_insert_check_and_lock(
 
 	lock = lock_rec_get_first(block, next_rec_heap_no);
 
+	lock_rec_shard_exit(hash_val);
+
 	if (UNIV_LIKELY(lock == NULL)) {
 		/* We optimize CPU time usage in the simplest case */
 
-		lock_mutex_exit();
-
 		if (inherit_in && !dict_index_is_clust(index)) {
 			/* Update the page max trx id field */
 			page_update_max_trx_id(block,
@@ -6178,6 +6248,10 @@ lock_rec_insert_check_and_lock(
 
 	*inherit = TRUE;
 
+	/* The lock found above may be gone by now, the queue is looked
+	at again under the exclusive latch. */
+	lock_mutex_enter();
+
 	/* If another transaction has an explicit lock request which locks
 	the gap, waiting or granted, on the successor, the insert has to wait.
 
@@ -6284,7 +6358,10 @@ lock_rec_convert_impl_to_expl(
 						     trx_id, rec, block));
 	}
 
-	if (trx_id != 0) {
+	/* A transaction that has committed never becomes active again.
+	Check that first so that records last modified by committed
+	transactions do not need the exclusive lock_sys->latch. */
+	if (trx_id != 0 && trx_rw_is_active(trx_id, NULL) != NULL) {
 		trx_t*	impl_trx;
 		ulint	heap_no = page_rec_get_heap_no(rec);
 
@@ -6296,7 +6373,7 @@ lock_rec_convert_impl_to_expl(
 		impl_trx = trx_rw_is_active(trx_id, NULL);
 
 		/* impl_trx cannot be committed until lock_mutex_exit()
-		because lock_trx_release_locks() acquires lock_sys->mutex */
+		because lock_trx_release_locks() acquires lock_sys->latch */
 
 		if (impl_trx != NULL
 		    && !lock_rec_has_expl(LOCK_X | LOCK_REC_NOT_GAP, block,
@@ -6355,16 +6432,12 @@ lock_clust_rec_modify_check_and_lock(
 
 	lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 
-	lock_mutex_enter();
-
 	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 
 	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP, LOCK_X_REGULAR,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -6415,16 +6488,12 @@ lock_sec_rec_modify_check_and_lock(
 	index record, and this would not have been possible if another active
 	transaction had modified this secondary index record. */
 
-	lock_mutex_enter();
-
 	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 
 	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP, LOCK_X_REGULAR,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 #ifdef UNIV_DEBUG
 	{
@@ -6518,8 +6587,6 @@ lock_sec_rec_read_check_and_lock(
 		lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 	}
 
-	lock_mutex_enter();
-
 	ut_ad(mode != LOCK_X
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 	ut_ad(mode != LOCK_S
@@ -6528,9 +6595,7 @@ lock_sec_rec_read_check_and_lock(
 	err = lock_rec_lock(FALSE, mode | gap_mode, x_mode,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -6594,8 +6659,6 @@ lock_clust_rec_read_check_and_lock(
 		lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 	}
 
-	lock_mutex_enter();
-
 	ut_ad(mode != LOCK_X
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 	ut_ad(mode != LOCK_S
@@ -6604,9 +6667,7 @@ lock_clust_rec_read_check_and_lock(
 	err = lock_rec_lock(FALSE, mode | gap_mode, x_mode,
 			    block, heap_no, index, thr);
 
-	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
-
-	lock_mutex_exit();
+	MONITOR_ATOMIC_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -7049,8 +7110,16 @@ lock_trx_release_locks(
 	}
 
 	/* The transition of trx->state to TRX_STATE_COMMITTED_IN_MEMORY
-	is protected by both the lock_sys->mutex and the trx->mutex. */
+	is protected by both the lock_sys->latch and the trx->mutex. For a
+	read-write transaction it is also done under trx_sys->mutex, so that
+	no read view opened after it can share a snapshot of the active
+	transactions that still lists trx (see FACT D in read0read.cc). */
 	lock_mutex_enter();
+
+	if (!trx->read_only) {
+		mutex_enter(&trx_sys->mutex);
+	}
+
 	trx_mutex_enter(trx);
 
 	/* The following assignment makes the transaction committed in memory
@@ -7084,6 +7153,11 @@ lock_trx_release_locks(
 
 	trx->is_recovered = FALSE;
 
+	if (!trx->read_only) {
+		read_view_ids_invalidate();
+		mutex_exit(&trx_sys->mutex);
+	}
+
 	trx_mutex_exit(trx);
 
 	lock_release(trx);
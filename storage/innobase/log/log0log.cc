@@ -184,6 +184,122 @@ log_buf_pool_get_oldest_modification(void)
 	return(lsn);
 }
 
+/****************************************************************//**
+Advances log_sys->n_copies_done over the log buffer ranges that have been
+copied, in reservation order.
+@return	lsn up to which the data in the log buffer is complete */
+static
+lsn_t
+log_copies_ready_lsn(void)
+/*======================*/
+{
+	log_t*	log = log_sys;
+
+	ut_ad(mutex_own(&(log->mutex)));
+
+	while (log->n_copies_done < log->n_copies_reserved) {
+		log_copy_slot_t*	slot = &log->copy_slots[
+			log->n_copies_done % LOG_COPY_SLOTS];
+
+		if (!slot->done) {
+			return(slot->start_lsn);
+		}
+
+		os_rmb;
+		log->n_copies_done++;
+	}
+
+	return(log->lsn);
+}
+
+/****************************************************************//**
+Checks if no mini-transaction is copying into the log buffer.
+@return	true if all reserved ranges of the log buffer have been copied */
+static
+bool
+log_copies_all_done(void)
+/*=====================*/
+{
+	return(log_copies_ready_lsn() == log_sys->lsn);
+}
+
+/****************************************************************//**
+Moves the log blocks not yet written to the log files to the start of
+the log buffer. This is only possible when no write is running and no
+mini-transaction is copying into the log buffer.
+@return	true if space was freed in the log buffer */
+static
+bool
+log_buffer_compact(void)
+/*====================*/
+{
+	ulint	move_start;
+	ulint	move_end;
+
+	ut_ad(mutex_own(&(log_sys->mutex)));
+
+	if (log_sys->n_pending_writes != 0 || !log_copies_all_done()) {
+		return(false);
+	}
+
+	move_start = ut_calc_align_down(log_sys->buf_next_to_write,
+					OS_FILE_LOG_BLOCK_SIZE);
+	move_end = ut_calc_align(log_sys->buf_free, OS_FILE_LOG_BLOCK_SIZE);
+
+	if (move_start == 0) {
+		return(false);
+	}
+
+	ut_memmove(log_sys->buf, log_sys->buf + move_start,
+		   move_end - move_start);
+	log_sys->buf_free -= move_start;
+	log_sys->buf_next_to_write -= move_start;
+
+	return(true);
+}
+
+/****************************************************************//**
+Gets the event that a thread waiting for the log to be written or
+flushed up to an lsn waits for.
+@return	event set when a write of the log block of the lsn ends */
+static
+os_event_t
+log_flush_event(
+/*============*/
+	lsn_t	lsn)	/*!< in: lsn waited for */
+{
+	return(log_sys->flush_events[
+		       (lsn / OS_FILE_LOG_BLOCK_SIZE) % LOG_FLUSH_EVENTS]);
+}
+
+/****************************************************************//**
+Wakes up the threads waiting for the log to be written or flushed up to
+an lsn within a range that has just been written. */
+static
+void
+log_flush_set_events(
+/*=================*/
+	lsn_t	start_lsn,	/*!< in: start of the written range */
+	lsn_t	end_lsn)	/*!< in: end of the written range */
+{
+	lsn_t	block_no;
+	lsn_t	end_block_no;
+
+	ut_ad(mutex_own(&(log_sys->mutex)));
+
+	block_no = start_lsn / OS_FILE_LOG_BLOCK_SIZE;
+	end_block_no = end_lsn / OS_FILE_LOG_BLOCK_SIZE;
+
+	if (end_block_no - block_no >= LOG_FLUSH_EVENTS) {
+		end_block_no = block_no + LOG_FLUSH_EVENTS - 1;
+	}
+
+	for (; block_no <= end_block_no; block_no++) {
+		os_event_set(log_sys->flush_events[
+				     block_no % LOG_FLUSH_EVENTS]);
+	}
+}
+
 /** Extends the log buffer.
 @param[in] len	requested minimum size in bytes */
 static
@@ -216,11 +332,13 @@ log_buffer_extend(
 	log_sys->is_extending = true;
 
 	while (log_sys->n_pending_writes != 0
+	       || !log_copies_all_done()
 	       || ut_calc_align_down(log_sys->buf_free,
 				     OS_FILE_LOG_BLOCK_SIZE)
 		  != ut_calc_align_down(log_sys->buf_next_to_write,
 					OS_FILE_LOG_BLOCK_SIZE)) {
-		/* Buffer might have >1 blocks to write still. */
+		/* Buffer might have >1 blocks to write still, or
+		mini-transactions might still be copying into it. */
 		mutex_exit(&(log_sys->mutex));
 
 		log_buffer_flush_to_disk();
@@ -249,6 +367,13 @@ log_buffer_extend(
 			       srv_trx_log_write_block_size)));
 	log_sys->buf = static_cast<byte*>(
 		ut_align(log_sys->buf_ptr, OS_FILE_LOG_BLOCK_SIZE));
+	mem_free(log_sys->write_buf_ptr);
+	log_sys->write_buf_ptr = static_cast<byte*>(
+		mem_zalloc(LOG_BUFFER_SIZE +
+			   max((ulong)OS_FILE_LOG_BLOCK_SIZE,
+			       srv_trx_log_write_block_size)));
+	log_sys->write_buf = static_cast<byte*>(
+		ut_align(log_sys->write_buf_ptr, OS_FILE_LOG_BLOCK_SIZE));
 	log_sys->buf_size = LOG_BUFFER_SIZE;
 	log_sys->max_buf_free = log_sys->buf_size / LOG_BUF_FLUSH_RATIO
 		- LOG_BUF_FLUSH_MARGIN;
@@ -322,7 +447,9 @@ loop:
 
 	len_upper_limit = LOG_BUF_WRITE_MARGIN + (5 * len) / 4;
 
-	if (log->buf_free + len_upper_limit > log->buf_size) {
+	if (log->buf_free + len_upper_limit > log->buf_size
+	    && (!log_buffer_compact()
+		|| log->buf_free + len_upper_limit > log->buf_size)) {
 
 		mutex_exit(&(log->mutex));
 
@@ -368,13 +495,13 @@ loop:
 }
 
 /************************************************************//**
-Writes to the log the string given. It is assumed that the caller holds the
-log mutex. */
-UNIV_INTERN
+Advances the log past a string of the given length, formatting the headers
+of the log blocks that the string spans. It is assumed that the caller holds
+the log mutex. */
+static
 void
-log_write_low(
-/*==========*/
-	byte*	str,		/*!< in: string */
+log_reserve_low(
+/*============*/
 	ulint	str_len)	/*!< in: string length */
 {
 	log_t*	log	= log_sys;
@@ -402,10 +529,7 @@ part_loop:
 			- LOG_BLOCK_TRL_SIZE;
 	}
 
-	ut_memcpy(log->buf + log->buf_free, str, len);
-
 	str_len -= len;
-	str = str + len;
 
 	log_block = static_cast<byte*>(
 		ut_align_down(
@@ -435,10 +559,128 @@ part_loop:
 	if (str_len > 0) {
 		goto part_loop;
 	}
+}
+
+/************************************************************//**
+Copies a string to the log buffer, skipping the headers and trailers of the
+log blocks it spans, as laid out by log_reserve_low.
+@return	pointer past the last byte copied */
+static
+byte*
+log_copy_low(
+/*=========*/
+	byte*		ptr,	/*!< in: where to copy the string to */
+	const byte*	str,	/*!< in: string */
+	ulint		str_len)/*!< in: string length */
+{
+	for (;;) {
+		ulint	len = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE
+			- ut_align_offset(ptr, OS_FILE_LOG_BLOCK_SIZE);
+
+		if (str_len < len) {
+			ut_memcpy(ptr, str, str_len);
+
+			return(ptr + str_len);
+		}
+
+		/* The string fills the rest of this block */
+		ut_memcpy(ptr, str, len);
+
+		str_len -= len;
+		str += len;
+		ptr += len + LOG_BLOCK_TRL_SIZE + LOG_BLOCK_HDR_SIZE;
+
+		if (str_len == 0) {
+			return(ptr);
+		}
+	}
+}
+
+/************************************************************//**
+Writes to the log the string given. It is assumed that the caller holds the
+log mutex. */
+UNIV_INTERN
+void
+log_write_low(
+/*==========*/
+	byte*	str,		/*!< in: string */
+	ulint	str_len)	/*!< in: string length */
+{
+	byte*	ptr	= log_sys->buf + log_sys->buf_free;
+
+	log_reserve_low(str_len);
+	log_copy_low(ptr, str, str_len);
+
+	srv_stats.log_write_requests.inc();
+}
+
+/************************************************************//**
+Reserves space for a log record group of the given length in the log
+buffer, so that the records can be copied into it by log_write_reserved
+after the log mutex is released. Must be called between
+log_reserve_and_open and log_close. */
+UNIV_INTERN
+void
+log_reserve_for_copy(
+/*=================*/
+	ulint		len,	/*!< in: length of the log record group,
+				as passed to log_reserve_and_open */
+	log_copy_t*	copy)	/*!< out: the reserved range */
+{
+	log_t*			log	= log_sys;
+	log_copy_slot_t*	slot;
+
+	ut_ad(mutex_own(&(log->mutex)));
+
+	/* If every slot is in use, wait for the oldest copy to complete.
+	Copies do not need the log mutex, so we can keep it meanwhile. */
+	while (log->n_copies_reserved - log->n_copies_done
+	       == LOG_COPY_SLOTS
+	       && log_copies_ready_lsn() != log->lsn
+	       && log->n_copies_reserved - log->n_copies_done
+	       == LOG_COPY_SLOTS) {
+		os_thread_yield();
+	}
+
+	copy->slot = log->n_copies_reserved++ % LOG_COPY_SLOTS;
+	copy->ptr = log->buf + log->buf_free;
+
+	slot = &log->copy_slots[copy->slot];
+	slot->start_lsn = log->lsn;
+	slot->done = FALSE;
+
+	log_reserve_low(len);
+}
+
+/************************************************************//**
+Copies the string given to a range reserved by log_reserve_for_copy.
+The caller does not hold the log mutex. */
+UNIV_INTERN
+void
+log_write_reserved(
+/*===============*/
+	log_copy_t*	copy,	/*!< in/out: the reserved range */
+	const byte*	str,	/*!< in: string */
+	ulint		str_len)/*!< in: string length */
+{
+	copy->ptr = log_copy_low(copy->ptr, str, str_len);
 
 	srv_stats.log_write_requests.inc();
 }
 
+/************************************************************//**
+Marks a range reserved by log_reserve_for_copy as completely copied, so
+that log_write_up_to can write it. */
+UNIV_INTERN
+void
+log_copy_complete(
+/*==============*/
+	const log_copy_t*	copy)	/*!< in: the reserved range */
+{
+	os_wmb;
+	log_sys->copy_slots[copy->slot].done = TRUE;
+}
+
 /************************************************************//**
 Closes the log.
 @return	lsn */
@@ -901,9 +1143,21 @@ log_init(void)
 	log_sys->buf = static_cast<byte*>(
 		ut_align(log_sys->buf_ptr, OS_FILE_LOG_BLOCK_SIZE));
 
+	log_sys->write_buf_ptr = static_cast<byte*>(
+		mem_zalloc(LOG_BUFFER_SIZE +
+			   max((ulong)OS_FILE_LOG_BLOCK_SIZE,
+			       srv_trx_log_write_block_size)));
+
+	log_sys->write_buf = static_cast<byte*>(
+		ut_align(log_sys->write_buf_ptr, OS_FILE_LOG_BLOCK_SIZE));
+
 	log_sys->buf_size = LOG_BUFFER_SIZE;
 	log_sys->is_extending = false;
 
+	memset(log_sys->copy_slots, 0, sizeof(log_sys->copy_slots));
+	log_sys->n_copies_reserved = 0;
+	log_sys->n_copies_done = 0;
+
 	log_sys->max_buf_free = log_sys->buf_size / LOG_BUF_FLUSH_RATIO
 		- LOG_BUF_FLUSH_MARGIN;
 	log_sys->check_flush_or_checkpoint = TRUE;
@@ -941,13 +1195,9 @@ log_init(void)
 	log_sys->n_syncs = 0;
 	log_sys->n_checkpoints = 0;
 
-	log_sys->no_flush_event = os_event_create();
-
-	os_event_set(log_sys->no_flush_event);
-
-	log_sys->one_flushed_event = os_event_create();
-
-	os_event_set(log_sys->one_flushed_event);
+	for (ulint i = 0; i < LOG_FLUSH_EVENTS; i++) {
+		log_sys->flush_events[i] = os_event_create();
+	}
 
 	/*----------------------------*/
 
@@ -1106,8 +1356,9 @@ UNIV_INLINE
 void
 log_flush_do_unlocks(
 /*=================*/
-	ulint	code)	/*!< in: any ORed combination of LOG_UNLOCK_FLUSH_LOCK
+	ulint	code,	/*!< in: any ORed combination of LOG_UNLOCK_FLUSH_LOCK
 			and LOG_UNLOCK_NONE_FLUSHED_LOCK */
+	lsn_t	start_lsn)/*!< in: lsn the completed write started from */
 {
 	ut_ad(mutex_own(&(log_sys->mutex)));
 
@@ -1120,14 +1371,13 @@ log_flush_do_unlocks(
 	this function would erroneously signal the NEW flush as completed.
 	Thus, the changes in the state of these events are performed
 	atomically in conjunction with the changes in the state of
-	log_sys->n_pending_writes etc. */
+	log_sys->n_pending_writes etc.
 
-	if (code & LOG_UNLOCK_NONE_FLUSHED_LOCK) {
-		os_event_set(log_sys->one_flushed_event);
-	}
+	There is only one log group, so the write has completed for all
+	groups when it has completed for one. */
 
-	if (code & LOG_UNLOCK_FLUSH_LOCK) {
-		os_event_set(log_sys->no_flush_event);
+	if (code) {
+		log_flush_set_events(start_lsn, log_sys->write_lsn);
 	}
 }
 
@@ -1175,9 +1425,6 @@ ulint
 log_sys_check_flush_completion(void)
 /*================================*/
 {
-	ulint	move_start;
-	ulint	move_end;
-
 	ut_ad(mutex_own(&(log_sys->mutex)));
 
 	if (log_sys->n_pending_writes == 0) {
@@ -1187,19 +1434,11 @@ log_sys_check_flush_completion(void)
 
 		if (log_sys->write_end_offset > log_sys->max_buf_free / 2) {
 			/* Move the log buffer content to the start of the
-			buffer */
-
-			move_start = ut_calc_align_down(
-				log_sys->write_end_offset,
-				OS_FILE_LOG_BLOCK_SIZE);
-			move_end = ut_calc_align(log_sys->buf_free,
-						 OS_FILE_LOG_BLOCK_SIZE);
-
-			ut_memmove(log_sys->buf, log_sys->buf + move_start,
-				   move_end - move_start);
-			log_sys->buf_free -= move_start;
+			buffer, unless mini-transactions are still copying
+			into it; log_reserve_and_open retries if it runs
+			out of space meanwhile. */
 
-			log_sys->buf_next_to_write -= move_start;
+			log_buffer_compact();
 		}
 
 		return(LOG_UNLOCK_FLUSH_LOCK);
@@ -1217,6 +1456,7 @@ log_io_complete(
 	log_group_t*	group)	/*!< in: log group or a dummy pointer */
 {
 	ulint	unlock;
+	lsn_t	start_lsn;
 
 #ifdef UNIV_LOG_ARCHIVE
 	if ((byte*) group == &log_archive_io) {
@@ -1272,10 +1512,13 @@ log_io_complete(
 	log_sys->n_pending_writes--;
 	MONITOR_DEC(MONITOR_PENDING_LOG_WRITE);
 
+	start_lsn = ut_min(log_sys->written_to_all_lsn,
+			   log_sys->flushed_to_disk_lsn);
+
 	unlock = log_group_check_flush_completion(group);
 	unlock = unlock | log_sys_check_flush_completion();
 
-	log_flush_do_unlocks(unlock);
+	log_flush_do_unlocks(unlock, start_lsn);
 
 	mutex_exit(&(log_sys->mutex));
 }
@@ -1369,7 +1612,9 @@ log_group_write_buf(
 	lsn_t		next_offset;
 	ulint		i;
 
-	ut_ad(mutex_own(&(log_sys->mutex)));
+	/* log_write_up_to writes without the log mutex, but no other
+	write can run meanwhile */
+	ut_ad(mutex_own(&(log_sys->mutex)) || log_sys->n_pending_writes > 0);
 	ut_ad(!recv_no_log_write);
 	ut_a(len % OS_FILE_LOG_BLOCK_SIZE == 0);
 	ut_a(start_lsn % OS_FILE_LOG_BLOCK_SIZE == 0);
@@ -1479,7 +1724,12 @@ loop:
 This function is called, e.g., when a transaction wants to commit. It checks
 that the log has been written to the log file up to the last log entry written
 by the transaction. If there is a flush running, it waits and checks if the
-flush flushed enough. If not, starts a new flush. */
+flush flushed enough. If not, starts a new flush.
+
+The log mutex is not held while the log files are written and flushed, so
+mini-transactions can keep adding to the log buffer meanwhile. A thread
+waiting for a running write waits for the event of the log block of the lsn
+it needs, see log_flush_event(). */
 UNIV_INTERN
 void
 log_write_up_to(
@@ -1499,9 +1749,16 @@ log_write_up_to(
 	ulint		end_offset;
 	ulint		area_start;
 	ulint		area_end;
-#ifdef UNIV_DEBUG
-	ulint		loop_count	= 0;
-#endif /* UNIV_DEBUG */
+	ulint		area_len;
+	lsn_t		ready_lsn;
+	lsn_t		start_lsn;
+	lsn_t		write_start_lsn;
+	ulint		checkpoint_no;
+	byte*		last_block;
+	ulint		last_data_len;
+	ulint		last_first_rec_group;
+	os_event_t	event;
+	ib_int64_t	sig_count;
 	ulint		unlock;
 
 	ut_ad(!srv_read_only_mode);
@@ -1516,18 +1773,6 @@ log_write_up_to(
 	}
 
 loop:
-#ifdef UNIV_DEBUG
-	loop_count++;
-
-	ut_ad(loop_count < 5);
-
-# if 0
-	if (loop_count > 2) {
-		fprintf(stderr, "Log loop count %lu\n", loop_count);
-	}
-# endif
-#endif
-
 	mutex_enter(&(log_sys->mutex));
 	ut_ad(!recv_no_log_write);
 
@@ -1568,18 +1813,40 @@ loop:
 			goto do_waits;
 		}
 
-		mutex_exit(&(log_sys->mutex));
-
 		/* Wait for the write to complete and try to start a new
 		write */
 
-		os_event_wait(log_sys->no_flush_event);
+		event = log_flush_event(log_sys->write_lsn);
+		sig_count = os_event_reset(event);
+
+		mutex_exit(&(log_sys->mutex));
+
+		os_event_wait_low(event, sig_count);
+
+		goto loop;
+	}
+
+	ready_lsn = log_copies_ready_lsn();
+
+	if (ready_lsn < lsn && ready_lsn < log_sys->lsn) {
+		/* Mini-transactions are still copying log records that we
+		need to write. They do not wait for anything, so give them
+		some time and retry. */
+
+		mutex_exit(&(log_sys->mutex));
+
+		os_thread_yield();
 
 		goto loop;
 	}
 
+	/* The data in the log buffer is complete up to ready_lsn. The log
+	buffer offsets advance together with the lsn. */
+	end_offset = log_sys->buf_free
+		- (ulint) (log_sys->lsn - ready_lsn);
+
 	if (!flush_to_disk
-	    && log_sys->buf_free == log_sys->buf_next_to_write) {
+	    && end_offset == log_sys->buf_next_to_write) {
 		/* Nothing to write and no flush to disk requested */
 
 		mutex_exit(&(log_sys->mutex));
@@ -1592,7 +1859,7 @@ loop:
 		fprintf(stderr,
 			"Writing log from " LSN_PF " up to lsn " LSN_PF "\n",
 			log_sys->written_to_all_lsn,
-			log_sys->lsn);
+			ready_lsn);
 	}
 #endif /* UNIV_DEBUG */
 	log_sys->n_pending_writes++;
@@ -1602,59 +1869,72 @@ loop:
 	group->n_pending_writes++;	/*!< We assume here that we have only
 					one log group! */
 
-	os_event_reset(log_sys->no_flush_event);
-	os_event_reset(log_sys->one_flushed_event);
-
 	start_offset = log_sys->buf_next_to_write;
-	end_offset = log_sys->buf_free;
 
 	area_start = ut_calc_align_down(start_offset, OS_FILE_LOG_BLOCK_SIZE);
 	area_end = ut_calc_align(end_offset, OS_FILE_LOG_BLOCK_SIZE);
+	area_len = area_end - area_start;
 
-	ut_ad(area_end - area_start > 0);
+	ut_ad(area_len > 0);
 
-	log_sys->write_lsn = log_sys->lsn;
+	log_sys->write_lsn = ready_lsn;
+	log_sys->write_end_offset = end_offset;
 
 	if (flush_to_disk) {
-		log_sys->current_flush_lsn = log_sys->lsn;
+		log_sys->current_flush_lsn = ready_lsn;
 	}
 
 	log_sys->one_flushed = FALSE;
 
-	log_block_set_flush_bit(log_sys->buf + area_start, TRUE);
-	log_block_set_checkpoint_no(
-		log_sys->buf + area_end - OS_FILE_LOG_BLOCK_SIZE,
-		log_sys->next_checkpoint_no);
-
-	/* Copy the last, incompletely written, log block a log block length
-	up, so that when the flush operation writes from the log buffer, the
-	segment to write will not be changed by writers to the log */
+	write_start_lsn = ut_uint64_align_down(log_sys->written_to_all_lsn,
+					       OS_FILE_LOG_BLOCK_SIZE);
+	/* Threads waiting for a flush of log already written wait for
+	this write too */
+	start_lsn = ut_min(log_sys->written_to_all_lsn,
+			   log_sys->flushed_to_disk_lsn);
+	checkpoint_no = log_sys->next_checkpoint_no;
 
-	ut_memcpy(log_sys->buf + area_end,
-		  log_sys->buf + area_end - OS_FILE_LOG_BLOCK_SIZE,
-		  OS_FILE_LOG_BLOCK_SIZE);
+	/* Mini-transactions may still be copying into the last block past
+	end_offset, and log_close may update its header, so the header is
+	fixed in the copy to cover only the data we write. */
+	last_data_len = end_offset % OS_FILE_LOG_BLOCK_SIZE;
+	last_first_rec_group = log_block_get_first_rec_group(
+		log_sys->buf + area_end - OS_FILE_LOG_BLOCK_SIZE);
 
-	log_sys->buf_free += OS_FILE_LOG_BLOCK_SIZE;
-	log_sys->write_end_offset = log_sys->buf_free;
+	if (last_first_rec_group > last_data_len) {
+		/* The first log record group starting in this block has not
+		been copied yet */
+		last_first_rec_group = 0;
+	}
 
-	group = UT_LIST_GET_FIRST(log_sys->log_groups);
+	mutex_exit(&(log_sys->mutex));
 
-	/* Do the write to the log files */
+	/* Copy the blocks to write to the write buffer. The blocks before
+	the last one are complete and no longer change. */
 
-	while (group) {
-		log_group_write_buf(
-			group, log_sys->buf + area_start,
-			area_end - area_start,
-			ut_uint64_align_down(log_sys->written_to_all_lsn,
-					     OS_FILE_LOG_BLOCK_SIZE),
-			start_offset - area_start);
+	ut_memcpy(log_sys->write_buf, log_sys->buf + area_start, area_len);
 
-		log_group_set_fields(group, log_sys->write_lsn);
+	last_block = log_sys->write_buf + area_len - OS_FILE_LOG_BLOCK_SIZE;
 
-		group = UT_LIST_GET_NEXT(log_groups, group);
+	if (last_data_len != 0) {
+		log_block_set_data_len(last_block, last_data_len);
+		log_block_set_first_rec_group(last_block,
+					      last_first_rec_group);
 	}
 
-	mutex_exit(&(log_sys->mutex));
+	log_block_set_flush_bit(log_sys->write_buf, TRUE);
+	log_block_set_checkpoint_no(last_block, checkpoint_no);
+
+	/* Do the write to the log files */
+
+	for (group = UT_LIST_GET_FIRST(log_sys->log_groups);
+	     group;
+	     group = UT_LIST_GET_NEXT(log_groups, group)) {
+
+		log_group_write_buf(
+			group, log_sys->write_buf, area_len,
+			write_start_lsn, start_offset - area_start);
+	}
 
 	if (srv_unix_file_flush_method == SRV_UNIX_O_DSYNC ||
 	    srv_unix_file_flush_method == SRV_UNIX_ALL_O_DIRECT) {
@@ -1663,7 +1943,7 @@ loop:
 		log file at all: so we have also flushed to disk what
 		we have written */
 
-		log_sys->flushed_to_disk_lsn = log_sys->write_lsn;
+		log_sys->flushed_to_disk_lsn = ready_lsn;
 		log_sys->n_syncs++;
 		log_sys->log_sync_syncers[caller]++;
 
@@ -1672,13 +1952,20 @@ loop:
 		group = UT_LIST_GET_FIRST(log_sys->log_groups);
 
 		fil_flush(group->space_id, FLUSH_FROM_LOG_WRITE_UP_TO);
-		log_sys->flushed_to_disk_lsn = log_sys->write_lsn;
+		log_sys->flushed_to_disk_lsn = ready_lsn;
 		log_sys->n_syncs++;
 		log_sys->log_sync_syncers[caller]++;
 	}
 
 	mutex_enter(&(log_sys->mutex));
 
+	for (group = UT_LIST_GET_FIRST(log_sys->log_groups);
+	     group;
+	     group = UT_LIST_GET_NEXT(log_groups, group)) {
+
+		log_group_set_fields(group, ready_lsn);
+	}
+
 	group = UT_LIST_GET_FIRST(log_sys->log_groups);
 
 	ut_a(group->n_pending_writes == 1);
@@ -1691,29 +1978,32 @@ loop:
 	unlock = log_group_check_flush_completion(group);
 	unlock = unlock | log_sys_check_flush_completion();
 
-	log_flush_do_unlocks(unlock);
+	log_flush_do_unlocks(unlock, start_lsn);
 
 	mutex_exit(&(log_sys->mutex));
 
 	return;
 
 do_waits:
-	mutex_exit(&(log_sys->mutex));
+	if (wait == LOG_NO_WAIT) {
+		mutex_exit(&(log_sys->mutex));
 
-	switch (wait) {
-	case LOG_WAIT_ONE_GROUP:
-		os_event_wait(log_sys->one_flushed_event);
-		break;
-	case LOG_WAIT_ALL_GROUPS:
-		os_event_wait(log_sys->no_flush_event);
-		break;
-#ifdef UNIV_DEBUG
-	case LOG_NO_WAIT:
-		break;
-	default:
-		ut_error;
-#endif /* UNIV_DEBUG */
+		return;
 	}
+
+	ut_ad(wait == LOG_WAIT_ONE_GROUP || wait == LOG_WAIT_ALL_GROUPS);
+
+	/* The event may also be set by a write of another log block that
+	maps to the same event, so check again after the wait. */
+
+	event = log_flush_event(lsn);
+	sig_count = os_event_reset(event);
+
+	mutex_exit(&(log_sys->mutex));
+
+	os_event_wait_low(event, sig_count);
+
+	goto loop;
 }
 
 /****************************************************************//**
@@ -3832,12 +4122,16 @@ log_shutdown(void)
 	mem_free(log_sys->buf_ptr);
 	log_sys->buf_ptr = NULL;
 	log_sys->buf = NULL;
+	mem_free(log_sys->write_buf_ptr);
+	log_sys->write_buf_ptr = NULL;
+	log_sys->write_buf = NULL;
 	mem_free(log_sys->checkpoint_buf_ptr);
 	log_sys->checkpoint_buf_ptr = NULL;
 	log_sys->checkpoint_buf = NULL;
 
-	os_event_free(log_sys->no_flush_event);
-	os_event_free(log_sys->one_flushed_event);
+	for (ulint i = 0; i < LOG_FLUSH_EVENTS; i++) {
+		os_event_free(log_sys->flush_events[i]);
+	}
 
 	rw_lock_free(&log_sys->checkpoint_lock);
 
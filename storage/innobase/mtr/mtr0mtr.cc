@@ -240,6 +240,7 @@ mtr_log_reserve_and_write(
 	dyn_array_t*	mlog;
 	ulint		data_size;
 	byte*		first_data;
+	log_copy_t	copy;
 
 	ut_ad(!srv_read_only_mode);
 
@@ -275,19 +276,14 @@ mtr_log_reserve_and_write(
 
 	data_size = dyn_array_get_data_size(mlog);
 
-	/* Open the database log for log_write_low */
+	/* Open the database log and reserve space for the log records.
+	They are copied to the log buffer after the log mutex is released,
+	concurrently with other mini-transactions. */
 	mtr->start_lsn = log_reserve_and_open(data_size);
 
 	if (mtr->log_mode == MTR_LOG_ALL) {
 
-		for (dyn_block_t* block = mlog;
-		     block != 0;
-		     block = dyn_array_get_next_block(mlog, block)) {
-
-			log_write_low(
-				dyn_block_get_data(block),
-				dyn_block_get_used(block));
-		}
+		log_reserve_for_copy(data_size, &copy);
 
 	} else {
 		ut_ad(mtr->log_mode == MTR_LOG_NONE
@@ -298,6 +294,21 @@ mtr_log_reserve_and_write(
 	mtr->end_lsn = log_close();
 
 	mtr_add_dirtied_pages_to_flush_list(mtr);
+
+	if (mtr->log_mode == MTR_LOG_ALL) {
+
+		for (dyn_block_t* block = mlog;
+		     block != 0;
+		     block = dyn_array_get_next_block(mlog, block)) {
+
+			log_write_reserved(
+				&copy,
+				dyn_block_get_data(block),
+				dyn_block_get_used(block));
+		}
+
+		log_copy_complete(&copy);
+	}
 }
 #endif /* !UNIV_HOTBACKUP */
 
@@ -1244,7 +1244,8 @@ page_cur_insert_rec_zip(
 	    || reorg_before_insert) {
 		/* The values can change dynamically. */
 		bool	log_compressed	= page_zip_log_pages;
-		uchar	compression_flags	= page_zip_compression_flags;
+		uchar	compression_flags
+			= page_zip_compression_flags(index);
 #ifdef UNIV_DEBUG
 		rec_t*	cursor_rec	= page_cur_get_rec(cursor);
 #endif /* UNIV_DEBUG */
@@ -65,6 +65,10 @@ using namespace std;
 # define buf_LRU_stat_inc_unzip()			((void) 0)
 #endif /* !UNIV_HOTBACKUP */
 #include "blind_fwrite.h"
+#ifndef UNIV_INNOCHECKSUM
+#include <lz4.h>
+#include <zstd.h>
+#endif /* !UNIV_INNOCHECKSUM */
 
 #ifdef UNIV_INNOCHECKSUM
 #include "mach0data.h"
@@ -88,6 +92,10 @@ UNIV_INTERN mysql_pfs_key_t		page_zip_stat_per_index_mutex_key;
 /* Compression level to be used by zlib. Settable by user. */
 UNIV_INTERN uint	page_zip_level = DEFAULT_COMPRESSION_LEVEL;
 
+/* Compression algorithm used for tables without a COMPRESSION_ALGORITHM
+table comment hint. Settable by user. */
+UNIV_INTERN ulong	page_zip_algorithm = PAGE_ZIP_ALGORITHM_ZLIB;
+
 /* Whether or not to log compressed page images to avoid possible
 compression algorithm changes in zlib. */
 UNIV_INTERN my_bool	page_zip_log_pages = false;
@@ -776,6 +784,344 @@ page_zip_set_alloc(
 	strm->opaque = heap;
 }
 
+/**********************************************************************//**
+Get the compression algorithm to use for the pages of a table.
+@return the COMPRESSION_ALGORITHM hint of the table, or
+innodb_compression_algorithm */
+UNIV_INTERN
+ulint
+page_zip_get_algorithm(
+/*===================*/
+	const dict_table_t*	table)	/*!< in: table */
+{
+	ulint	algorithm = table->zip_algorithm;
+
+	return(algorithm == ULINT_UNDEFINED ? page_zip_algorithm : algorithm);
+}
+
+/* Pages compressed with an algorithm other than zlib start the
+compressed stream with a header, followed by the compressed data:
+PAGE_ZIP_CODEC_TAG		algorithm << 4 | PAGE_ZIP_CODEC_MAGIC
+PAGE_ZIP_CODEC_FIELDS_LEN	length of the index field information
+				at the start of the uncompressed stream
+PAGE_ZIP_CODEC_DATA_LEN		length of the uncompressed stream
+PAGE_ZIP_CODEC_ZIP_LEN		length of the compressed data
+The low bits of the first byte of a zlib stream are CM=8, and a raw
+deflate stream can not start with the reserved block type 3, so the
+magic tells these pages apart from the pages compressed with zlib. */
+/** Offset of the tag byte of the header */
+#define PAGE_ZIP_CODEC_TAG		0
+/** Offset of the 2-byte index field information length */
+#define PAGE_ZIP_CODEC_FIELDS_LEN	1
+/** Offset of the 2-byte uncompressed stream length */
+#define PAGE_ZIP_CODEC_DATA_LEN		3
+/** Offset of the 2-byte compressed data length */
+#define PAGE_ZIP_CODEC_ZIP_LEN		5
+/** Size of the header */
+#define PAGE_ZIP_CODEC_HEADER_SIZE	7
+/** Low 4 bits of the tag byte */
+#define PAGE_ZIP_CODEC_MAGIC		0x06
+
+/** A page compression stream. For zlib this is the z_stream. The other
+algorithms compress the whole page at once, so for them deflate() only
+collects its input, and the page is compressed when the stream is
+finished. Likewise the page is decompressed when the stream is
+initialized, and inflate() only copies the decompressed data out. */
+struct page_zip_stream_t : public z_stream {
+	ulint	algorithm;	/*!< page_zip_algorithm_t */
+	int	level;		/*!< compression level */
+	byte*	buf;		/*!< uncompressed stream, for the
+				algorithms other than zlib */
+	ulint	buf_size;	/*!< size of buf */
+	ulint	buf_len;	/*!< length of the uncompressed stream */
+	ulint	buf_pos;	/*!< position of inflate() in buf */
+	ulint	fields_len;	/*!< length of the index field
+				information at the start of buf */
+};
+
+/**********************************************************************//**
+Initialize a page compression stream, like deflateInit2().
+@return	Z_OK, or a zlib error code */
+static
+int
+page_zip_deflate_init(
+/*==================*/
+	page_zip_stream_t*	strm,		/*!< in/out: stream, with the
+						allocator set */
+	ulint			algorithm,	/*!< in: page_zip_algorithm_t */
+	int			level,		/*!< in: compression level */
+	int			window_bits,	/*!< in: zlib window bits */
+	int			strategy)	/*!< in: zlib strategy */
+{
+	strm->algorithm = algorithm;
+	strm->level = level;
+	strm->buf = NULL;
+	strm->buf_len = strm->buf_pos = strm->fields_len = 0;
+
+	if (algorithm == PAGE_ZIP_ALGORITHM_ZLIB) {
+		return(deflateInit2(strm, level, Z_DEFLATED, window_bits,
+				    MAX_MEM_LEVEL, strategy));
+	}
+
+	/* The stream holds the index field information and the records,
+	which are smaller than a page. */
+	strm->buf_size = 2 * UNIV_PAGE_SIZE;
+	strm->buf = static_cast<byte*>(
+		mem_heap_alloc(static_cast<mem_heap_t*>(strm->opaque),
+			       strm->buf_size));
+	strm->total_in = strm->total_out = 0;
+	strm->msg = NULL;
+
+	return(Z_OK);
+}
+
+/**********************************************************************//**
+Compress the collected stream with an algorithm other than zlib, and
+write it with its header to the output of the stream.
+@return	Z_STREAM_END, or Z_BUF_ERROR if it does not fit */
+static
+int
+page_zip_deflate_finish(
+/*====================*/
+	page_zip_stream_t*	strm)	/*!< in/out: stream */
+{
+	byte*	out = strm->next_out;
+	ulint	capacity;
+	ulint	zip_len = 0;
+
+	if (strm->avail_out <= PAGE_ZIP_CODEC_HEADER_SIZE) {
+		return(Z_BUF_ERROR);
+	}
+
+	capacity = strm->avail_out - PAGE_ZIP_CODEC_HEADER_SIZE;
+
+	switch (strm->algorithm) {
+	case PAGE_ZIP_ALGORITHM_LZ4:
+		{
+			int	n = LZ4_compress_default(
+				reinterpret_cast<const char*>(strm->buf),
+				reinterpret_cast<char*>(
+					out + PAGE_ZIP_CODEC_HEADER_SIZE),
+				static_cast<int>(strm->buf_len),
+				static_cast<int>(capacity));
+
+			zip_len = n > 0 ? n : 0;
+		}
+		break;
+	case PAGE_ZIP_ALGORITHM_ZSTD:
+		{
+			size_t	n = ZSTD_compress(
+				out + PAGE_ZIP_CODEC_HEADER_SIZE, capacity,
+				strm->buf, strm->buf_len, strm->level);
+
+			zip_len = ZSTD_isError(n) ? 0 : n;
+		}
+		break;
+	default:
+		ut_error;
+	}
+
+	if (zip_len == 0) {
+		/* The page does not fit in the output */
+		return(Z_BUF_ERROR);
+	}
+
+	mach_write_to_1(out + PAGE_ZIP_CODEC_TAG,
+			strm->algorithm << 4 | PAGE_ZIP_CODEC_MAGIC);
+	mach_write_to_2(out + PAGE_ZIP_CODEC_FIELDS_LEN, strm->fields_len);
+	mach_write_to_2(out + PAGE_ZIP_CODEC_DATA_LEN, strm->buf_len);
+	mach_write_to_2(out + PAGE_ZIP_CODEC_ZIP_LEN, zip_len);
+
+	zip_len += PAGE_ZIP_CODEC_HEADER_SIZE;
+	strm->next_out += zip_len;
+	strm->avail_out -= static_cast<uInt>(zip_len);
+	strm->total_out = zip_len;
+
+	return(Z_STREAM_END);
+}
+
+/**********************************************************************//**
+Compress data on a page compression stream, like deflate().
+@return	deflate() status: Z_OK, Z_STREAM_END, Z_BUF_ERROR, ... */
+static
+int
+page_zip_deflate(
+/*=============*/
+	page_zip_stream_t*	strm,	/*!< in/out: stream */
+	int			flush)	/*!< in: deflate() flushing method */
+{
+	if (strm->algorithm == PAGE_ZIP_ALGORITHM_ZLIB) {
+		return(deflate(strm, flush));
+	}
+
+	if (strm->avail_in > strm->buf_size - strm->buf_len) {
+		return(Z_BUF_ERROR);
+	}
+
+	memcpy(strm->buf + strm->buf_len, strm->next_in, strm->avail_in);
+	strm->buf_len += strm->avail_in;
+	strm->total_in += strm->avail_in;
+	strm->next_in += strm->avail_in;
+	strm->avail_in = 0;
+
+	switch (flush) {
+	case Z_FULL_FLUSH:
+		/* Only the index field information is flushed, so that
+		page_zip_decompress() can read it with Z_BLOCK. */
+		ut_ad(!strm->fields_len);
+		strm->fields_len = strm->buf_len;
+		break;
+	case Z_FINISH:
+		return(page_zip_deflate_finish(strm));
+	}
+
+	return(Z_OK);
+}
+
+/**********************************************************************//**
+Free a page compression stream, like deflateEnd().
+@return	Z_OK, or a zlib error code */
+static
+int
+page_zip_deflate_end(
+/*=================*/
+	page_zip_stream_t*	strm)	/*!< in/out: stream */
+{
+	/* buf is allocated from the heap of the stream */
+	return(strm->algorithm == PAGE_ZIP_ALGORITHM_ZLIB
+	       ? deflateEnd(strm) : Z_OK);
+}
+
+/**********************************************************************//**
+Decompress a page compressed with an algorithm other than zlib into the
+buffer of the stream, and skip the compressed data on the input.
+@return	TRUE on success, FALSE if the page is corrupted */
+static
+ibool
+page_zip_inflate_codec(
+/*===================*/
+	page_zip_stream_t*	strm)	/*!< in/out: stream */
+{
+	const byte*	in = strm->next_in;
+	ulint		fields_len;
+	ulint		data_len;
+	ulint		zip_len;
+	ibool		success;
+
+	if (strm->avail_in < PAGE_ZIP_CODEC_HEADER_SIZE) {
+		return(FALSE);
+	}
+
+	fields_len = mach_read_from_2(in + PAGE_ZIP_CODEC_FIELDS_LEN);
+	data_len = mach_read_from_2(in + PAGE_ZIP_CODEC_DATA_LEN);
+	zip_len = mach_read_from_2(in + PAGE_ZIP_CODEC_ZIP_LEN);
+
+	if (zip_len > strm->avail_in - PAGE_ZIP_CODEC_HEADER_SIZE
+	    || fields_len > data_len || data_len > 2 * UNIV_PAGE_SIZE) {
+		return(FALSE);
+	}
+
+	strm->buf_size = data_len;
+	strm->buf = static_cast<byte*>(
+		mem_heap_alloc(static_cast<mem_heap_t*>(strm->opaque),
+			       data_len + 1));
+
+	in += PAGE_ZIP_CODEC_HEADER_SIZE;
+
+	switch (strm->algorithm) {
+	case PAGE_ZIP_ALGORITHM_LZ4:
+		success = LZ4_decompress_safe(
+			reinterpret_cast<const char*>(in),
+			reinterpret_cast<char*>(strm->buf),
+			static_cast<int>(zip_len),
+			static_cast<int>(data_len))
+			== static_cast<int>(data_len);
+		break;
+	case PAGE_ZIP_ALGORITHM_ZSTD:
+		success = ZSTD_decompress(strm->buf, data_len, in, zip_len)
+			== data_len;
+		break;
+	default:
+		success = FALSE;
+	}
+
+	if (!success) {
+		return(FALSE);
+	}
+
+	strm->buf_len = data_len;
+	strm->buf_pos = 0;
+	strm->fields_len = fields_len;
+
+	zip_len += PAGE_ZIP_CODEC_HEADER_SIZE;
+	strm->next_in += zip_len;
+	strm->avail_in -= static_cast<uInt>(zip_len);
+	strm->total_in = zip_len;
+	strm->total_out = 0;
+
+	return(TRUE);
+}
+
+/**********************************************************************//**
+Decompress data from a page compression stream, like inflate().
+@return	inflate() status: Z_OK, Z_STREAM_END, Z_BUF_ERROR, ... */
+static
+int
+page_zip_inflate(
+/*=============*/
+	page_zip_stream_t*	strm,	/*!< in/out: stream */
+	int			flush)	/*!< in: inflate() flushing method */
+{
+	ulint	end;
+	ulint	n;
+
+	if (strm->algorithm == PAGE_ZIP_ALGORITHM_ZLIB) {
+		return(inflate(strm, flush));
+	}
+
+	/* The callers subtract the space of the uncompressed data from
+	avail_in, which would wrap around on a corrupted page. */
+	if (UNIV_UNLIKELY(strm->avail_in > UNIV_PAGE_SIZE)) {
+		strm->msg = const_cast<char*>("invalid compressed length");
+		return(Z_DATA_ERROR);
+	}
+
+	/* Like inflate() stops at the end of the block that deflate()
+	ended with Z_FULL_FLUSH, Z_BLOCK stops at the end of the index
+	field information. */
+	end = flush == Z_BLOCK && strm->buf_pos < strm->fields_len
+		? strm->fields_len : strm->buf_len;
+	n = ut_min(end - strm->buf_pos, (ulint) strm->avail_out);
+
+	memcpy(strm->next_out, strm->buf + strm->buf_pos, n);
+	strm->buf_pos += n;
+	strm->next_out += n;
+	strm->avail_out -= static_cast<uInt>(n);
+	strm->total_out += n;
+
+	if (flush == Z_BLOCK) {
+		return(Z_OK);
+	} else if (strm->buf_pos == strm->buf_len) {
+		return(Z_STREAM_END);
+	}
+
+	return(n ? Z_OK : Z_BUF_ERROR);
+}
+
+/**********************************************************************//**
+Free a page decompression stream, like inflateEnd().
+@return	Z_OK, or a zlib error code */
+static
+int
+page_zip_inflate_end(
+/*=================*/
+	page_zip_stream_t*	strm)	/*!< in/out: stream */
+{
+	/* buf is allocated from the heap of the stream */
+	return(strm->algorithm == PAGE_ZIP_ALGORITHM_ZLIB
+	       ? inflateEnd(strm) : Z_OK);
+}
+
 #if 0 || defined UNIV_DEBUG || defined UNIV_ZIP_DEBUG
 /** Symbol for enabling compression and decompression diagnostics */
 # define PAGE_ZIP_COMPRESS_DBG
@@ -798,9 +1144,9 @@ static
 int
 page_zip_compress_deflate(
 /*======================*/
-	FILE*		logfile,/*!< in: log file, or NULL */
-	z_streamp	strm,	/*!< in/out: compressed stream for deflate() */
-	int		flush)	/*!< in: deflate() flushing method */
+	FILE*			logfile,/*!< in: log file, or NULL */
+	page_zip_stream_t*	strm,	/*!< in/out: compressed stream */
+	int			flush)	/*!< in: deflate() flushing method */
 {
 	int	status;
 	if (UNIV_UNLIKELY(page_zip_compress_dbg)) {
@@ -809,21 +1155,21 @@ page_zip_compress_deflate(
 	if (UNIV_LIKELY_NULL(logfile)) {
 		blind_fwrite(strm->next_in, 1, strm->avail_in, logfile);
 	}
-	status = deflate(strm, flush);
+	status = page_zip_deflate(strm, flush);
 	if (UNIV_UNLIKELY(page_zip_compress_dbg)) {
 		fprintf(stderr, " -> %d\n", status);
 	}
 	return(status);
 }
 
-/* Redefine deflate(). */
-# undef deflate
-/** Debug wrapper for the zlib compression routine deflate().
+/* Redefine page_zip_deflate(). */
+/** Debug wrapper for the compression routine page_zip_deflate().
 Log the operation if page_zip_compress_dbg is set.
 @param strm	in/out: compressed stream
 @param flush	in: flushing method
 @return		deflate() status: Z_OK, Z_BUF_ERROR, ... */
-# define deflate(strm, flush) page_zip_compress_deflate(logfile, strm, flush)
+# define page_zip_deflate(strm, flush) \
+	page_zip_compress_deflate(logfile, strm, flush)
 /** Declaration of the logfile parameter */
 # define FILE_LOGFILE FILE* logfile,
 /** The logfile parameter */
@@ -843,7 +1189,7 @@ int
 page_zip_compress_node_ptrs(
 /*========================*/
 	FILE_LOGFILE
-	z_stream*	c_stream,	/*!< in/out: compressed page stream */
+	page_zip_stream_t*	c_stream,/*!< in/out: compressed page stream */
 	const rec_t**	recs,		/*!< in: dense page directory
 					sorted by address */
 	ulint		n_dense,	/*!< in: size of recs[] */
@@ -871,7 +1217,7 @@ page_zip_compress_node_ptrs(
 			rec - REC_N_NEW_EXTRA_BYTES - c_stream->next_in);
 
 		if (c_stream->avail_in) {
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 				break;
 			}
@@ -884,7 +1230,7 @@ page_zip_compress_node_ptrs(
 			rec_offs_data_size(offsets) - REC_NODE_PTR_SIZE);
 
 		if (c_stream->avail_in) {
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 				break;
 			}
@@ -909,7 +1255,7 @@ int
 page_zip_compress_sec(
 /*==================*/
 	FILE_LOGFILE
-	z_stream*	c_stream,	/*!< in/out: compressed page stream */
+	page_zip_stream_t*	c_stream,/*!< in/out: compressed page stream */
 	const rec_t**	recs,		/*!< in: dense page directory
 					sorted by address */
 	ulint		n_dense)	/*!< in: size of recs[] */
@@ -929,7 +1275,7 @@ page_zip_compress_sec(
 		if (UNIV_LIKELY(c_stream->avail_in)) {
 			UNIV_MEM_ASSERT_RW(c_stream->next_in,
 					   c_stream->avail_in);
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 				break;
 			}
@@ -955,7 +1301,7 @@ int
 page_zip_compress_clust_ext(
 /*========================*/
 	FILE_LOGFILE
-	z_stream*	c_stream,	/*!< in/out: compressed page stream */
+	page_zip_stream_t*	c_stream,/*!< in/out: compressed page stream */
 	const rec_t*	rec,		/*!< in: record */
 	const ulint*	offsets,	/*!< in: rec_get_offsets(rec) */
 	ulint		trx_id_col,	/*!< in: position of of DB_TRX_ID */
@@ -993,7 +1339,7 @@ page_zip_compress_clust_ext(
 				src - c_stream->next_in);
 
 			if (c_stream->avail_in) {
-				err = deflate(c_stream, Z_NO_FLUSH);
+				err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 				if (UNIV_UNLIKELY(err != Z_OK)) {
 
 					return(err);
@@ -1022,7 +1368,7 @@ page_zip_compress_clust_ext(
 			c_stream->avail_in = static_cast<uInt>(
 				src - c_stream->next_in);
 			if (UNIV_LIKELY(c_stream->avail_in)) {
-				err = deflate(c_stream, Z_NO_FLUSH);
+				err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 				if (UNIV_UNLIKELY(err != Z_OK)) {
 
 					return(err);
@@ -1082,7 +1428,7 @@ int
 page_zip_compress_clust(
 /*====================*/
 	FILE_LOGFILE
-	z_stream*	c_stream,	/*!< in/out: compressed page stream */
+	page_zip_stream_t*	c_stream,/*!< in/out: compressed page stream */
 	const rec_t**	recs,		/*!< in: dense page directory
 					sorted by address */
 	ulint		n_dense,	/*!< in: size of recs[] */
@@ -1120,7 +1466,7 @@ page_zip_compress_clust(
 			- c_stream->next_in);
 
 		if (c_stream->avail_in) {
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 
 				goto func_exit;
@@ -1168,7 +1514,7 @@ page_zip_compress_clust(
 				src - c_stream->next_in);
 
 			if (c_stream->avail_in) {
-				err = deflate(c_stream, Z_NO_FLUSH);
+				err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 				if (UNIV_UNLIKELY(err != Z_OK)) {
 
 					return(err);
@@ -1196,7 +1542,7 @@ page_zip_compress_clust(
 			rec + rec_offs_data_size(offsets) - c_stream->next_in);
 
 		if (c_stream->avail_in) {
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 
 				goto func_exit;
@@ -1228,7 +1574,7 @@ page_zip_compress(
 						         and other options */
 	mtr_t*		mtr)	/*!< in: mini-transaction, or NULL */
 {
-	z_stream	c_stream;
+	page_zip_stream_t	c_stream;
 	int		err;
 	ulint		n_fields;/* number of index fields needed */
 	byte*		fields;	/*!< index field information */
@@ -1249,9 +1595,10 @@ page_zip_compress(
 	uint level;
 	uint wrap;
 	uint strategy;
+	uint algorithm;
 	int window_bits;
 	page_zip_decode_compression_flags(compression_flags, &level,
-	                                  &wrap, &strategy);
+	                                  &wrap, &strategy, &algorithm);
 	window_bits = wrap ? UNIV_PAGE_SIZE_SHIFT
 	                   : - ((int) UNIV_PAGE_SIZE_SHIFT);
 	ulint space_id = page_get_space_id(page);
@@ -1387,9 +1734,9 @@ page_zip_compress(
 	/* Compress the data payload. */
 	page_zip_set_alloc(&c_stream, heap);
 
-	err = deflateInit2(&c_stream, static_cast<int>(level),
-			   Z_DEFLATED, window_bits,
-			   MAX_MEM_LEVEL, strategy);
+	err = page_zip_deflate_init(&c_stream, algorithm,
+				    static_cast<int>(level),
+				    window_bits, strategy);
 	ut_a(err == Z_OK);
 
 	c_stream.next_out = buf;
@@ -1434,7 +1781,7 @@ page_zip_compress(
 	}
 
 	UNIV_MEM_ASSERT_RW(c_stream.next_in, c_stream.avail_in);
-	err = deflate(&c_stream, Z_FULL_FLUSH);
+	err = page_zip_deflate(&c_stream, Z_FULL_FLUSH);
 	if (err != Z_OK) {
 		goto zlib_error;
 	}
@@ -1488,11 +1835,11 @@ page_zip_compress(
 	ut_a(c_stream.avail_in <= UNIV_PAGE_SIZE - PAGE_ZIP_START - PAGE_DIR);
 
 	UNIV_MEM_ASSERT_RW(c_stream.next_in, c_stream.avail_in);
-	err = deflate(&c_stream, Z_FINISH);
+	err = page_zip_deflate(&c_stream, Z_FINISH);
 
 	if (UNIV_UNLIKELY(err != Z_STREAM_END)) {
 zlib_error:
-		deflateEnd(&c_stream);
+		page_zip_deflate_end(&c_stream);
 		mem_heap_free(heap);
 err_exit:
 #ifdef PAGE_ZIP_COMPRESS_DBG
@@ -1540,7 +1887,7 @@ err_exit:
 		return(FALSE);
 	}
 
-	err = deflateEnd(&c_stream);
+	err = page_zip_deflate_end(&c_stream);
 	ut_a(err == Z_OK);
 
 	ut_ad(buf + c_stream.total_out == c_stream.next_out);
@@ -2299,7 +2646,7 @@ static
 ibool
 page_zip_decompress_heap_no(
 /*========================*/
-	z_stream*	d_stream,	/*!< in/out: compressed page stream */
+	page_zip_stream_t*	d_stream,/*!< in/out: compressed page stream */
 	rec_t*		rec,		/*!< in/out: record */
 	ulint&		heap_status)	/*!< in/out: heap_no and status bits */
 {
@@ -2325,7 +2672,7 @@ ibool
 page_zip_decompress_node_ptrs(
 /*==========================*/
 	page_zip_des_t*	page_zip,	/*!< in/out: compressed page */
-	z_stream*	d_stream,	/*!< in/out: compressed page stream */
+	page_zip_stream_t*	d_stream,/*!< in/out: compressed page stream */
 	rec_t**		recs,		/*!< in: dense page directory
 					sorted by address */
 	ulint		n_dense,	/*!< in: size of recs[] */
@@ -2351,7 +2698,7 @@ page_zip_decompress_node_ptrs(
 
 		ut_ad(d_stream->avail_out < UNIV_PAGE_SIZE
 		      - PAGE_ZIP_START - PAGE_DIR);
-		switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+		switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 		case Z_STREAM_END:
 			page_zip_decompress_heap_no(
 				d_stream, rec, heap_status);
@@ -2386,7 +2733,7 @@ page_zip_decompress_node_ptrs(
 		d_stream->avail_out =static_cast<uInt>(
 			rec_offs_data_size(offsets) - REC_NODE_PTR_SIZE);
 
-		switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+		switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 		case Z_STREAM_END:
 			goto zlib_done;
 		case Z_OK:
@@ -2425,12 +2772,13 @@ page_zip_decompress_node_ptrs(
 		goto zlib_error;
 	}
 
-	if (UNIV_UNLIKELY(inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
+	if (UNIV_UNLIKELY(page_zip_inflate(d_stream, Z_FINISH)
+			  != Z_STREAM_END)) {
 		page_zip_fail(("page_zip_decompress_node_ptrs:"
 			       " inflate(Z_FINISH)=%s\n",
 			       d_stream->msg));
 zlib_error:
-		inflateEnd(d_stream);
+		page_zip_inflate_end(d_stream);
 		return(FALSE);
 	}
 
@@ -2438,7 +2786,7 @@ zlib_error:
 	if the modification log is nonempty. */
 
 zlib_done:
-	if (UNIV_UNLIKELY(inflateEnd(d_stream) != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate_end(d_stream) != Z_OK)) {
 		ut_error;
 	}
 
@@ -2514,7 +2862,7 @@ ibool
 page_zip_decompress_sec(
 /*====================*/
 	page_zip_des_t*	page_zip,	/*!< in/out: compressed page */
-	z_stream*	d_stream,	/*!< in/out: compressed page stream */
+	page_zip_stream_t*	d_stream,/*!< in/out: compressed page stream */
 	rec_t**		recs,		/*!< in: dense page directory
 					sorted by address */
 	ulint		n_dense,	/*!< in: size of recs[] */
@@ -2539,7 +2887,7 @@ page_zip_decompress_sec(
 			rec - REC_N_NEW_EXTRA_BYTES - d_stream->next_out);
 
 		if (UNIV_LIKELY(d_stream->avail_out)) {
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 				page_zip_decompress_heap_no(
 					d_stream, rec, heap_status);
@@ -2579,12 +2927,13 @@ page_zip_decompress_sec(
 		goto zlib_error;
 	}
 
-	if (UNIV_UNLIKELY(inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
+	if (UNIV_UNLIKELY(page_zip_inflate(d_stream, Z_FINISH)
+			  != Z_STREAM_END)) {
 		page_zip_fail(("page_zip_decompress_sec:"
 			       " inflate(Z_FINISH)=%s\n",
 			       d_stream->msg));
 zlib_error:
-		inflateEnd(d_stream);
+		page_zip_inflate_end(d_stream);
 		return(FALSE);
 	}
 
@@ -2592,7 +2941,7 @@ zlib_error:
 	if the modification log is nonempty. */
 
 zlib_done:
-	if (UNIV_UNLIKELY(inflateEnd(d_stream) != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate_end(d_stream) != Z_OK)) {
 		ut_error;
 	}
 
@@ -2651,7 +3000,7 @@ static
 ibool
 page_zip_decompress_clust_ext(
 /*==========================*/
-	z_stream*	d_stream,	/*!< in/out: compressed page stream */
+	page_zip_stream_t*	d_stream,/*!< in/out: compressed page stream */
 	rec_t*		rec,		/*!< in/out: record */
 	const ulint*	offsets,	/*!< in: rec_get_offsets(rec) */
 	ulint		trx_id_col)	/*!< in: position of of DB_TRX_ID */
@@ -2685,7 +3034,7 @@ page_zip_decompress_clust_ext(
 			d_stream->avail_out = static_cast<uInt>(
 				dst - d_stream->next_out);
 
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 			case Z_OK:
 			case Z_BUF_ERROR:
@@ -2716,7 +3065,7 @@ page_zip_decompress_clust_ext(
 
 			d_stream->avail_out = static_cast<uInt>(
 				dst - d_stream->next_out);
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 			case Z_OK:
 			case Z_BUF_ERROR:
@@ -2762,7 +3111,7 @@ ibool
 page_zip_decompress_clust(
 /*======================*/
 	page_zip_des_t*	page_zip,	/*!< in/out: compressed page */
-	z_stream*	d_stream,	/*!< in/out: compressed page stream */
+	page_zip_stream_t*	d_stream,/*!< in/out: compressed page stream */
 	rec_t**		recs,		/*!< in: dense page directory
 					sorted by address */
 	ulint		n_dense,	/*!< in: size of recs[] */
@@ -2795,7 +3144,7 @@ page_zip_decompress_clust(
 
 		ut_ad(d_stream->avail_out < UNIV_PAGE_SIZE
 		      - PAGE_ZIP_START - PAGE_DIR);
-		err = inflate(d_stream, Z_SYNC_FLUSH);
+		err = page_zip_inflate(d_stream, Z_SYNC_FLUSH);
 		switch (err) {
 		case Z_STREAM_END:
 			page_zip_decompress_heap_no(
@@ -2852,7 +3201,7 @@ page_zip_decompress_clust(
 			d_stream->avail_out = static_cast<uInt>(
 				dst - d_stream->next_out);
 
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 			case Z_OK:
 			case Z_BUF_ERROR:
@@ -2882,7 +3231,7 @@ page_zip_decompress_clust(
 		d_stream->avail_out = static_cast<uInt>(
 			rec_get_end(rec, offsets) - d_stream->next_out);
 
-		switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+		switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 		case Z_STREAM_END:
 		case Z_OK:
 		case Z_BUF_ERROR:
@@ -2912,12 +3261,13 @@ page_zip_decompress_clust(
 		goto zlib_error;
 	}
 
-	if (UNIV_UNLIKELY(inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
+	if (UNIV_UNLIKELY(page_zip_inflate(d_stream, Z_FINISH)
+			  != Z_STREAM_END)) {
 		page_zip_fail(("page_zip_decompress_clust:"
 			       " inflate(Z_FINISH)=%s\n",
 			       d_stream->msg));
 zlib_error:
-		inflateEnd(d_stream);
+		page_zip_inflate_end(d_stream);
 		return(FALSE);
 	}
 
@@ -2925,7 +3275,7 @@ zlib_error:
 	if the modification log is nonempty. */
 
 zlib_done:
-	if (UNIV_UNLIKELY(inflateEnd(d_stream) != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate_end(d_stream) != Z_OK)) {
 		ut_error;
 	}
 
@@ -3061,17 +3411,30 @@ first try the positive window_bits then negative window_bits, because the
 surest way to determine if the stream has adler32 headers is to see if the
 stream begins with the zlib header together with the adler32 value of it.
 This adds a tiny bit of overhead for the pages that were compressed without
-adler32s. */
+adler32s. The pages compressed with other algorithms are recognized by
+their header, and are decompressed at once.
+@return TRUE on success, FALSE if the page is corrupted */
 static
-void
+ibool
 page_zip_init_d_stream(
-	z_stream* strm)
+	page_zip_stream_t* strm)
 {
 	/* Save initial stream position, in case a reset is required. */
 	Bytef* next_in = strm->next_in;
 	Bytef* next_out = strm->next_out;
 	ulint avail_in = strm->avail_in;
 	ulint avail_out = strm->avail_out;
+	byte tag = *next_in;
+
+	strm->buf = NULL;
+
+	if ((tag & 0xF) == PAGE_ZIP_CODEC_MAGIC) {
+		strm->algorithm = tag >> 4;
+
+		return(page_zip_inflate_codec(strm));
+	}
+
+	strm->algorithm = PAGE_ZIP_ALGORITHM_ZLIB;
 
 	/* initialization must always succeed regardless of the sign of
 	   window_bits */
@@ -3089,6 +3452,8 @@ page_zip_init_d_stream(
 		/* read the zlib header */
 		ut_a(inflate(strm, Z_BLOCK) == Z_OK);
 	}
+
+	return(TRUE);
 }
 
 /**********************************************************************//**
@@ -3109,7 +3474,7 @@ page_zip_decompress(
 				after page creation */
 	ulint space_id)
 {
-	z_stream	d_stream;
+	page_zip_stream_t	d_stream;
 	dict_index_t*	index	= NULL;
 	rec_t**		recs;	/*!< dense page directory, sorted by address */
 	ulint		n_dense;/* number of user records on the page */
@@ -3207,9 +3572,14 @@ zlib_error:
 	d_stream.next_out = page + PAGE_ZIP_START;
 	d_stream.avail_out = UNIV_PAGE_SIZE - PAGE_ZIP_START;
 
-	page_zip_init_d_stream(&d_stream);
+	if (UNIV_UNLIKELY(!page_zip_init_d_stream(&d_stream))) {
+
+		page_zip_fail(("page_zip_decompress:"
+			       " 1 invalid page header\n"));
+		goto zlib_error;
+	}
 
-	if (UNIV_UNLIKELY(inflate(&d_stream, Z_BLOCK) != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate(&d_stream, Z_BLOCK) != Z_OK)) {
 
 		page_zip_fail(("page_zip_decompress:"
 			       " 2 inflate(Z_BLOCK)=%s\n", d_stream.msg));
@@ -4806,7 +5176,7 @@ page_zip_reorganize(
 	mtr_set_log_mode(mtr, log_mode);
 
 	if (!page_zip_compress(page_zip, page, index,
-			       page_zip_compression_flags, mtr)) {
+			       page_zip_compression_flags(index), mtr)) {
 
 #ifndef UNIV_HOTBACKUP
 		buf_block_free(temp_block);
@@ -172,6 +172,30 @@ In which order will the views be opened? Should it matter? If no, why?
 
 The order does not matter. No new transactions can be created and no running
 transaction can commit or rollback (or free views).
+
+-------------------------------------------------------------------------------
+FACT D: A normal read view may share the snapshot trx_sys->view_ids taken
+-------
+before it was opened, as long as no read-write transaction has committed in
+memory since then.
+
+PROOF: A view opened now would differ from the snapshot only in the
+transactions started or committed after the snapshot was taken. Started
+transactions got trx ids >= low_limit_id of the snapshot, so they are not
+seen by either view. lock_trx_release_locks() calls
+read_view_ids_invalidate() in the same trx_sys->mutex critical section
+that sets a read-write transaction TRX_STATE_COMMITTED_IN_MEMORY, before it
+releases the locks of the transaction. A shared snapshot therefore never
+lists a transaction that a new view must see, and no one can wait for the
+locks of a committed transaction and then read its changes through a view
+that misses them. Snapshots taken after that skip the committed transactions
+still in rw_trx_list, as CreateView does for every view. The creating
+transaction itself may be listed in the snapshot, or have an id >=
+low_limit_id; that is why read_view_sees_trx_id() checks creator_trx_id
+first for normal views.
+Purge does not remove undo logs needed by such a view either: all
+transactions committed after low_limit_no are still in rw_trx_list, and
+every view opened by purge is bounded by their trx->no. Q. E. D.
 */
 
 /*********************************************************************//**
@@ -192,6 +216,7 @@ read_view_create_low(
 
 	view->n_trx_ids = n;
 	view->trx_ids = (trx_id_t*) &view[1];
+	view->ids = NULL;
 
 	return(view);
 }
@@ -226,15 +251,21 @@ read_view_clone(
 		mem_heap_alloc(heap, (sz * 2) + sizeof(trx_id_t)));
 
 	/* Only the contents of the old view are important, the new view
-	will be created from this and so we don't copy that across. */
+	will be created from this and so we don't copy that across. The
+	trx_ids of the old view may be in a shared snapshot. */
 
-	memcpy(clone, view, sz);
+	memcpy(clone, view, sizeof(*view));
 
 	clone->trx_ids = (trx_id_t*) &clone[1];
+	clone->ids = NULL;
+
+	memcpy(clone->trx_ids, view->trx_ids,
+	       view->n_trx_ids * sizeof(*view->trx_ids));
 
 	new_view = (read_view_t*) &clone->trx_ids[clone->n_trx_ids];
 	new_view->trx_ids = (trx_id_t*) &new_view[1];
 	new_view->n_trx_ids = clone->n_trx_ids + 1;
+	new_view->ids = NULL;
 
 	ut_a(new_view->n_trx_ids == view->n_trx_ids + 1);
 
@@ -320,6 +351,112 @@ struct	CreateView {
 	ulint		m_n_trx;
 };
 
+/*********************************************************************//**
+Takes a snapshot of the active read-write transactions to be shared by
+read views. The snapshot is referenced once by trx_sys->view_ids.
+@return	own: snapshot */
+static
+read_view_ids_t*
+read_view_ids_create(void)
+/*======================*/
+{
+	read_view_ids_t*	ids;
+	read_view_t		view;
+	ulint			n_trx = UT_LIST_GET_LEN(trx_sys->rw_trx_list);
+
+	ut_ad(mutex_own(&trx_sys->mutex));
+
+	ids = static_cast<read_view_ids_t*>(
+		ut_malloc(sizeof(*ids) + n_trx * sizeof(*ids->trx_ids)));
+
+	/* Fill the array of the snapshot through a view that excludes
+	no creator. */
+
+	view.n_trx_ids = n_trx;
+	view.trx_ids = (trx_id_t*) &ids[1];
+	view.creator_trx_id = 0;
+	view.low_limit_no = trx_sys->max_trx_id;
+
+	ut_list_map(trx_sys->rw_trx_list, &trx_t::trx_list, CreateView(&view));
+
+	ids->ref_count = 1;
+	ids->low_limit_no = view.low_limit_no;
+	ids->low_limit_id = trx_sys->max_trx_id;
+	ids->n_trx_ids = view.n_trx_ids;
+	ids->trx_ids = view.trx_ids;
+
+	if (ids->n_trx_ids > 0) {
+		/* The last active transaction has the smallest id: */
+		ids->up_limit_id = ids->trx_ids[ids->n_trx_ids - 1];
+	} else {
+		ids->up_limit_id = ids->low_limit_id;
+	}
+
+	return(ids);
+}
+
+/*********************************************************************//**
+Drops the snapshot of the active read-write transactions shared by new
+read views. Must be called when a read-write transaction commits in memory
+or is removed from trx_sys->rw_trx_list, so that the next read view sees
+its changes. */
+UNIV_INTERN
+void
+read_view_ids_invalidate(void)
+/*==========================*/
+{
+	ut_ad(mutex_own(&trx_sys->mutex));
+
+	if (trx_sys->view_ids != NULL) {
+		read_view_ids_release(trx_sys->view_ids);
+		trx_sys->view_ids = NULL;
+	}
+}
+
+/*********************************************************************//**
+Opens a normal read view that references the shared snapshot of the active
+read-write transactions instead of copying trx_sys->rw_trx_list. The
+snapshot is taken only if no read view has been opened since the last
+read-write transaction commit (see FACT D).
+@return	own: read view struct */
+static
+read_view_t*
+read_view_open_shared(
+/*==================*/
+	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
+					transaction */
+	mem_heap_t*	heap)		/*!< in: memory heap from which
+					allocated */
+{
+	read_view_t*		view;
+	read_view_ids_t*	ids;
+
+	ut_ad(mutex_own(&trx_sys->mutex));
+
+	if (trx_sys->view_ids == NULL) {
+		trx_sys->view_ids = read_view_ids_create();
+	}
+
+	ids = trx_sys->view_ids;
+	++ids->ref_count;
+
+	view = static_cast<read_view_t*>(mem_heap_alloc(heap, sizeof(*view)));
+
+	view->type = VIEW_NORMAL;
+	view->undo_no = 0;
+	view->creator_trx_id = cr_trx_id;
+	view->low_limit_no = ids->low_limit_no;
+	view->low_limit_id = ids->low_limit_id;
+	view->up_limit_id = ids->up_limit_id;
+	view->n_trx_ids = ids->n_trx_ids;
+	view->trx_ids = ids->trx_ids;
+	view->ids = ids;
+
+	read_view_add(view);
+
+	return(view);
+}
+
 /*********************************************************************//**
 Opens a read view where exactly the transactions serialized before this
 point in time are seen in the view.
@@ -338,6 +475,10 @@ read_view_open_now_low(
 
 	ut_ad(mutex_own(&trx_sys->mutex));
 
+	if (cr_trx_id > 0) {
+		return(read_view_open_shared(cr_trx_id, heap));
+	}
+
 	view = read_view_create_low(n_trx, heap);
 
 	view->undo_no = 0;
@@ -361,9 +502,6 @@ read_view_open_now_low(
 	}
 
 	/* Purge views are not added to the view list. */
-	if (cr_trx_id > 0) {
-		read_view_add(view);
-	}
 
 	return(view);
 }
@@ -409,7 +547,6 @@ read_view_purge_open(
 	read_view_t*	view;
 	read_view_t*	oldest_view;
 	trx_id_t	creator_trx_id;
-	ulint		insert_done	= 0;
 
 	mutex_enter(&trx_sys->mutex);
 
@@ -438,26 +575,30 @@ read_view_purge_open(
 	view = (read_view_t*) &oldest_view->trx_ids[oldest_view->n_trx_ids];
 
 	/* Add the creator transaction id in the trx_ids array in the
-	correct slot. */
+	correct slot. A view sharing a snapshot may list its creator
+	already, or not see it at all through low_limit_id. */
 
-	for (i = 0; i < oldest_view->n_trx_ids; ++i) {
-		trx_id_t	id;
+	if (creator_trx_id >= oldest_view->low_limit_id) {
+		creator_trx_id = 0;
+	}
+
+	view->n_trx_ids = 0;
 
-		id = oldest_view->trx_ids[i - insert_done];
+	for (i = 0; i < oldest_view->n_trx_ids; ++i) {
+		trx_id_t	id = oldest_view->trx_ids[i];
 
-		if (insert_done == 0 && creator_trx_id > id) {
-			id = creator_trx_id;
-			insert_done = 1;
+		if (creator_trx_id > id) {
+			view->trx_ids[view->n_trx_ids++] = creator_trx_id;
+			creator_trx_id = 0;
+		} else if (creator_trx_id == id) {
+			creator_trx_id = 0;
 		}
 
-		view->trx_ids[i] = id;
+		view->trx_ids[view->n_trx_ids++] = id;
 	}
 
-	if (insert_done == 0) {
-		view->trx_ids[i] = creator_trx_id;
-	} else {
-		ut_a(i > 0);
-		view->trx_ids[i] = oldest_view->trx_ids[i - 1];
+	if (creator_trx_id > 0) {
+		view->trx_ids[view->n_trx_ids++] = creator_trx_id;
 	}
 
 	view->creator_trx_id = 0;
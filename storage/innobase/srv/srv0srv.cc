@@ -343,6 +343,11 @@ UNIV_INTERN my_bool	srv_pc_adaptive_sleep;
 cleaner thread */
 UNIV_INTERN ulint	srv_cleaner_max_lru_time = 1000;
 
+/** Number of threads flushing buffer pool instances in parallel: the
+page_cleaner and lru_manager threads and srv_n_page_cleaners - 1 page
+cleaner workers that serve both */
+UNIV_INTERN ulong	srv_n_page_cleaners = 4;
+
 UNIV_INTERN srv_stats_t	srv_stats;
 
 /* structure to pass status variables to MySQL */
@@ -777,6 +782,15 @@ and/or load it during startup. */
 UNIV_INTERN char	srv_buffer_pool_dump_at_shutdown = FALSE;
 UNIV_INTERN char	srv_buffer_pool_load_at_startup = FALSE;
 
+/** Whether the buffer pool dump is written in the compact format */
+UNIV_INTERN my_bool	srv_buf_dump_compact = TRUE;
+
+/** Seconds between two buffer pool dumps, 0 to only dump on request */
+UNIV_INTERN ulong	srv_buf_dump_interval = 0;
+
+/** Number of threads that read the pages of a buffer pool load */
+UNIV_INTERN ulong	srv_buf_load_threads = 4;
+
 /** Slot index in the srv_sys->sys_threads array for the purge thread. */
 static const ulint	SRV_PURGE_SLOT	= 1;
 
@@ -1444,7 +1458,10 @@ srv_printf_innodb_monitor(
 		      "-------------------------------------\n", file);
 		ibuf_print(file);
 
-		ha_print_info(file, btr_search_sys->hash_index);
+		for (ulint i = 0; i < btr_ahi_parts; i++) {
+			ha_print_info(file,
+				      btr_search_sys->parts[i].hash_index);
+		}
 
 		fprintf(file,
 			"%.2f hash searches/s, %.2f non-hash searches/s\n",
@@ -2307,7 +2324,7 @@ loop:
 		if (srv_print_innodb_monitor) {
 			/* Reset mutex_skipped counter everytime
 			srv_print_innodb_monitor changes. This is to
-			ensure we will not be blocked by lock_sys->mutex
+			ensure we will not be blocked by lock_sys->latch
 			for short duration information printing,
 			such as requested by sync_array_print_long_waits() */
 			if (!last_srv_print_monitor) {
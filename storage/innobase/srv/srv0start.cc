@@ -1891,6 +1891,8 @@ innobase_start_or_create_for_mysql(void)
 			    + 1 /* fts_optimize_thread */
 			    + 1 /* recv_writer_thread */
 			    + 1 /* buf_flush_page_cleaner_thread */
+			    + 1 /* buf_flush_lru_manager_thread */
+			    + srv_n_page_cleaners /* page cleaner workers */
 			    + 1 /* trx_rollback_or_clean_all_recovered */
 			    + 128 /* added as margin, for use of
 				  InnoDB Memcached etc. */
@@ -1908,6 +1910,11 @@ innobase_start_or_create_for_mysql(void)
 		srv_buf_pool_instances = 1;
 	}
 
+	/* A page cleaner flushes one buffer pool instance at a time. */
+	if (srv_n_page_cleaners > srv_buf_pool_instances) {
+		srv_n_page_cleaners = srv_buf_pool_instances;
+	}
+
 	/* each buffer pool instance contains at least one chunk unit */
 	if (srv_buf_pool_chunk_unit > 0) {
 		srv_buf_pool_size
@@ -2853,7 +2860,17 @@ files_checked:
 		purge_sys->state = PURGE_STATE_DISABLED;
 	}
 
+	buf_flush_page_cleaner_init();
+
 	if (!srv_read_only_mode) {
+		/* The page_cleaner and lru_manager threads flush instances
+		themselves too, so we need one worker less than cleaners.
+		In read-only mode the lru_manager runs its batches alone. */
+		for (i = 1; i < srv_n_page_cleaners; ++i) {
+			os_thread_create(buf_flush_page_cleaner_worker,
+					 NULL, NULL);
+		}
+
 		os_thread_create(buf_flush_page_cleaner_thread, NULL, NULL);
 	}
 
@@ -3141,6 +3158,10 @@ innobase_shutdown_for_mysql(void)
 		logs_empty_and_mark_files_at_shutdown() and should have
 		already quit or is quitting right now. */
 
+		/* g. Exit the page cleaner workers */
+
+		buf_flush_page_cleaner_wakeup_workers();
+
 		os_mutex_enter(os_sync_mutex);
 
 		if (os_thread_count == 0) {
@@ -3204,6 +3225,7 @@ innobase_shutdown_for_mysql(void)
 	}
 
 	buf_pool_free_resized_event();
+	buf_flush_page_cleaner_close();
 
 	/* This must be disabled before closing the buffer pool
 	and closing the data dictionary.  */
@@ -1261,10 +1261,15 @@ trx_sys_close(void)
 		view = UT_LIST_GET_NEXT(view_list, prev_view);
 
 		/* Views are allocated from the trx_sys->global_read_view_heap.
-		So, we simply remove the element here. */
-		UT_LIST_REMOVE(view_list, trx_sys->view_list, prev_view);
+		So, we simply remove the element here, which also releases
+		the snapshot that it shares. */
+		read_view_remove(prev_view, false);
 	}
 
+	mutex_enter(&trx_sys->mutex);
+	read_view_ids_invalidate();
+	mutex_exit(&trx_sys->mutex);
+
 #ifdef XTRABACKUP
 	if (!srv_apply_log_only) {
 #endif /* XTRABACKUP */
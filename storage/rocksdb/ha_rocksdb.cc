@@ -33,6 +33,7 @@
 /* C++ standard header files */
 #include <inttypes.h>
 #include <algorithm>
+#include <deque>
 #include <limits>
 #include <map>
 #include <queue>
@@ -277,6 +278,14 @@ static Rdb_index_stats_thread rdb_is_thread;
 static Rdb_manual_compaction_thread rdb_mc_thread;
 
 static Rdb_drop_index_thread rdb_drop_idx_thread;
+
+/*
+  Threads that run the MultiGet calls of pipelined MRR scans, see
+  @@rocksdb_mrr_pipeline_threads. Fetches are spread round-robin.
+*/
+static std::vector<std::unique_ptr<Rdb_task_thread>>
+    rdb_mrr_fetch_threads;
+static std::atomic<uint> rdb_mrr_fetch_next_thread(0);
 // List of table names (using regex) that are exceptions to the strict
 // collation check requirement.
 Regex_list_handler *rdb_collation_exceptions;
@@ -751,6 +760,8 @@ static uint32_t rocksdb_select_bypass_rejected_query_history_size = 0;
 static uint32_t rocksdb_select_bypass_debug_row_delay = 0;
 static unsigned long long  // NOLINT(runtime/int)
     rocksdb_select_bypass_multiget_min = 0;
+static uint32_t rocksdb_mrr_pipeline_threads = 0;
+static uint32_t rocksdb_bulk_load_threads = 0;
 static my_bool rocksdb_skip_locks_if_skip_unique_check = FALSE;
 static my_bool rocksdb_alter_column_default_inplace = FALSE;
 std::atomic<uint64_t> rocksdb_row_lock_deadlocks(0);
@@ -1100,11 +1111,14 @@ const size_t RDB_DEFAULT_MERGE_COMBINE_READ_SIZE = 1024 * 1024 * 1024;
 const size_t RDB_MIN_MERGE_COMBINE_READ_SIZE = 100;
 const size_t RDB_DEFAULT_MERGE_TMP_FILE_REMOVAL_DELAY = 0;
 const size_t RDB_MIN_MERGE_TMP_FILE_REMOVAL_DELAY = 0;
+const uint RDB_MAX_MERGE_THREADS = 64;
 const int64 RDB_DEFAULT_BLOCK_CACHE_SIZE = 512 * 1024 * 1024;
 const int64 RDB_MIN_BLOCK_CACHE_SIZE = 1024;
 const int RDB_MAX_CHECKSUMS_PCT = 100;
 const ulong RDB_DEADLOCK_DETECT_DEPTH = 50;
 const ulong ROCKSDB_MAX_MRR_BATCH_SIZE = 1000;
+const uint ROCKSDB_MAX_MRR_PIPELINE_THREADS = 64;
+const uint ROCKSDB_MAX_BULK_LOAD_THREADS = 64;
 const uint ROCKSDB_MAX_BOTTOM_PRI_BACKGROUND_COMPACTIONS = 64;
 
 // TODO: 0 means don't wait at all, and we don't support it yet?
@@ -1326,6 +1340,16 @@ static MYSQL_THDVAR_ULONG(bulk_load_size, PLUGIN_VAR_RQCMDARG,
                           /*min*/ 1,
                           /*max*/ RDB_MAX_BULK_LOAD_SIZE, 0);
 
+static MYSQL_SYSVAR_UINT(
+    bulk_load_threads, rocksdb_bulk_load_threads,
+    PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+    "Number of threads that build and compress the SST files of bulk loads "
+    "while the loading thread encodes the next rows. 0 builds them on the "
+    "loading thread. Each load then buffers up to this many plus two SST "
+    "files of target_file_size_base bytes in memory",
+    nullptr, nullptr, 0, /* min */ 0,
+    /* max */ ROCKSDB_MAX_BULK_LOAD_THREADS, 0);
+
 static MYSQL_THDVAR_ULONGLONG(
     merge_buf_size, PLUGIN_VAR_RQCMDARG,
     "Size to allocate for merge sort buffers written out to disk "
@@ -1357,6 +1381,14 @@ static MYSQL_THDVAR_ULONGLONG(
     /* min (0ms) */ RDB_MIN_MERGE_TMP_FILE_REMOVAL_DELAY,
     /* max */ SIZE_T_MAX, 1);
 
+static MYSQL_THDVAR_UINT(
+    merge_threads, PLUGIN_VAR_RQCMDARG,
+    "Number of threads that sort, merge and write the keys of a secondary "
+    "index during inplace index creation. Each thread handles its own key "
+    "range with its own merge_buf_size sort buffer.",
+    nullptr, nullptr, /* default */ 1, /* min */ 1,
+    /* max */ RDB_MAX_MERGE_THREADS, 0);
+
 static MYSQL_THDVAR_INT(
     manual_compaction_threads, PLUGIN_VAR_RQCMDARG,
     "How many rocksdb threads to run for manual compactions", nullptr, nullptr,
@@ -2381,6 +2413,21 @@ static MYSQL_THDVAR_LONG(mrr_batch_size, PLUGIN_VAR_RQCMDARG,
                          nullptr, nullptr, /* default */ 100, /* min */ 0,
                          /* max */ ROCKSDB_MAX_MRR_BATCH_SIZE, 0);
 
+static MYSQL_THDVAR_BOOL(
+    mrr_cost_based, PLUGIN_VAR_RQCMDARG,
+    "Use MultiGet-MRR with optimizer_switch mrr_cost_based=on for scans that "
+    "are expected to do more than one primary key lookup. Without it, "
+    "MultiGet-MRR needs mrr_cost_based=off",
+    nullptr, nullptr, FALSE);
+
+static MYSQL_SYSVAR_UINT(
+    mrr_pipeline_threads, rocksdb_mrr_pipeline_threads,
+    PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+    "Number of threads that fetch the next MultiGet batch of an MRR scan "
+    "while the rows of the current one are returned. 0 disables pipelining",
+    nullptr, nullptr, 0, /* min */ 0,
+    /* max */ ROCKSDB_MAX_MRR_PIPELINE_THREADS, 0);
+
 static MYSQL_SYSVAR_BOOL(skip_locks_if_skip_unique_check,
                          rocksdb_skip_locks_if_skip_unique_check,
                          PLUGIN_VAR_RQCMDARG,
@@ -2416,6 +2463,7 @@ static struct st_mysql_sys_var *rocksdb_system_variables[] = {
     MYSQL_SYSVAR(read_free_rpl_tables),
     MYSQL_SYSVAR(read_free_rpl),
     MYSQL_SYSVAR(bulk_load_size),
+    MYSQL_SYSVAR(bulk_load_threads),
     MYSQL_SYSVAR(merge_buf_size),
     MYSQL_SYSVAR(enable_bulk_load_api),
     MYSQL_SYSVAR(enable_pipelined_write),
@@ -2423,6 +2471,7 @@ static struct st_mysql_sys_var *rocksdb_system_variables[] = {
     MYSQL_SYSVAR(tmpdir),
     MYSQL_SYSVAR(merge_combine_read_size),
     MYSQL_SYSVAR(merge_tmp_file_removal_delay_ms),
+    MYSQL_SYSVAR(merge_threads),
     MYSQL_SYSVAR(skip_bloom_filter_on_read),
 
     MYSQL_SYSVAR(create_if_missing),
@@ -2580,6 +2629,8 @@ static struct st_mysql_sys_var *rocksdb_system_variables[] = {
     MYSQL_SYSVAR(select_bypass_debug_row_delay),
     MYSQL_SYSVAR(select_bypass_multiget_min),
     MYSQL_SYSVAR(mrr_batch_size),
+    MYSQL_SYSVAR(mrr_cost_based),
+    MYSQL_SYSVAR(mrr_pipeline_threads),
     MYSQL_SYSVAR(skip_locks_if_skip_unique_check),
     MYSQL_SYSVAR(alter_column_default_inplace),
     nullptr};
@@ -6141,6 +6192,34 @@ static int rocksdb_init_func(void *const p) {
     DBUG_RETURN(HA_EXIT_FAILURE);
   }
 
+  for (uint i = 0; i < rocksdb_mrr_pipeline_threads; i++) {
+    std::unique_ptr<Rdb_task_thread> thread(new Rdb_task_thread());
+#ifdef HAVE_PSI_INTERFACE
+    thread->init(rdb_signal_mrr_fetch_psi_mutex_key,
+                 rdb_signal_mrr_fetch_psi_cond_key);
+    err = thread->create_thread(MRR_FETCH_THREAD_NAME,
+                                rdb_mrr_fetch_psi_thread_key);
+#else
+    thread->init();
+    err = thread->create_thread(MRR_FETCH_THREAD_NAME);
+#endif
+    if (err != 0) {
+      // NO_LINT_DEBUG
+      sql_print_error("RocksDB: Couldn't start an MRR fetch thread: (errno=%d)",
+                      err);
+      DBUG_RETURN(HA_EXIT_FAILURE);
+    }
+    rdb_mrr_fetch_threads.push_back(std::move(thread));
+  }
+
+  err = Rdb_sst_info::start_writer_threads(rocksdb_bulk_load_threads);
+  if (err != 0) {
+    // NO_LINT_DEBUG
+    sql_print_error("RocksDB: Couldn't start an SST writer thread: (errno=%d)",
+                    err);
+    DBUG_RETURN(HA_EXIT_FAILURE);
+  }
+
   rdb_set_collation_exception_list(rocksdb_strict_collation_exceptions);
 
   if (rocksdb_pause_background_work) {
@@ -6236,6 +6315,11 @@ static int rocksdb_done_func(void *const p) {
   // signal the manual compaction thread to stop
   rdb_mc_thread.signal(true);
 
+  // signal the MRR fetch threads to stop
+  for (const auto &thread : rdb_mrr_fetch_threads) {
+    thread->signal(true);
+  }
+
   // Wait for the background thread to finish.
   auto err = rdb_bg_thread.join();
   if (err != 0) {
@@ -6270,6 +6354,20 @@ static int rocksdb_done_func(void *const p) {
         "RocksDB: Couldn't stop the manual compaction thread: (errno=%d)", err);
   }
 
+  // Wait for the MRR fetch threads to finish.
+  for (const auto &thread : rdb_mrr_fetch_threads) {
+    err = thread->join();
+    if (err != 0) {
+      // NO_LINT_DEBUG
+      sql_print_error("RocksDB: Couldn't stop an MRR fetch thread: (errno=%d)",
+                      err);
+    }
+  }
+  rdb_mrr_fetch_threads.clear();
+
+  // Bulk loads are finished by now, nothing is queued for the SST writers
+  Rdb_sst_info::stop_writer_threads();
+
   if (rdb_open_tables.count()) {
     // Looks like we are getting unloaded and yet we have some open tables
     // left behind.
@@ -6728,7 +6826,8 @@ ha_rocksdb::ha_rocksdb(my_core::handlerton *const hton,
       m_insert_with_update(false),
       m_dup_key_found(false),
       mrr_rowid_reader(nullptr),
-      mrr_n_elements(0),
+      mrr_cur(&mrr_batches[0]),
+      mrr_pipelined(false),
       mrr_enabled_keyread(false),
       mrr_used_cpk(false),
       m_in_rpl_delete_rows(false),
@@ -13708,7 +13807,25 @@ int ha_rocksdb::inplace_populate_sk(
   const ulonglong rdb_merge_tmp_file_removal_delay =
       THDVAR(ha_thd(), merge_tmp_file_removal_delay_ms);
 
+  const uint rdb_merge_threads = THDVAR(ha_thd(), merge_threads);
+
   for (const auto &index : indexes) {
+    if (rdb_merge_threads > 1) {
+      std::vector<std::string> splitters;
+      if ((res = inplace_sk_splitters(new_table_arg, *index,
+                                      rdb_merge_threads, &splitters))) {
+        DBUG_RETURN(res);
+      }
+
+      if (!splitters.empty()) {
+        if ((res = inplace_populate_sk_parallel(new_table_arg, *index,
+                                                splitters))) {
+          DBUG_RETURN(res);
+        }
+        continue;
+      }
+    }
+
     bool is_unique_index =
         new_table_arg->key_info[index->get_keyno()].flags & HA_NOSAME;
 
@@ -13845,6 +13962,482 @@ int ha_rocksdb::inplace_populate_sk(
   DBUG_RETURN(res);
 }
 
+/*
+  Number of primary key rows sampled per key range when choosing the ranges
+  of a parallel secondary index build.
+*/
+static const uint RDB_SK_SPLIT_SAMPLES_PER_PART = 32;
+
+/*
+  Packed keys are handed from the scanning thread to the worker owning their
+  key range in blocks of this size.
+*/
+static const size_t RDB_SK_BUILD_BLOCK_SIZE = 1024 * 1024;
+
+/*
+  Number of blocks a worker may have queued before the scanning thread waits
+  for it. Bounds the memory held by blocks in flight.
+*/
+static const size_t RDB_SK_BUILD_MAX_PENDING_BLOCKS = 4;
+
+/*
+  One key range of a secondary index built by inplace_populate_sk_parallel().
+
+  The scanning thread appends packed keys to m_block and queues full blocks
+  on m_thread, which sorts them into m_merge. Once the scan is done the same
+  thread merges the range and writes it into m_sst_info. Apart from m_block
+  and m_pending, members are only used by the worker until its last future
+  is ready.
+*/
+struct Rdb_sk_build_part {
+  Rdb_index_merge m_merge;
+  std::shared_ptr<Rdb_sst_info> m_sst_info;
+  Rdb_task_thread m_thread;
+  bool m_thread_started = false;
+
+  std::string m_block;
+  std::deque<std::future<void>> m_pending;
+
+  /* First error of the worker, no more work is done after it is set */
+  std::atomic<int> m_rc;
+
+  /* Copy of the entry that failed the unique check, for the error message */
+  std::string m_dup_key;
+  std::string m_dup_val;
+
+  Rdb_sk_build_part(const char *const tmpfile_path,
+                    const ulonglong merge_buf_size,
+                    const ulonglong merge_combine_read_size,
+                    const ulonglong merge_tmp_file_removal_delay,
+                    rocksdb::ColumnFamilyHandle *cf)
+      : m_merge(tmpfile_path, merge_buf_size, merge_combine_read_size,
+                merge_tmp_file_removal_delay, cf),
+        m_rc(HA_EXIT_SUCCESS) {}
+
+  void set_error(int rc) {
+    int expected = HA_EXIT_SUCCESS;
+    m_rc.compare_exchange_strong(expected, rc);
+  }
+};
+
+static void rdb_sk_build_store(std::string *const block,
+                               const rocksdb::Slice &key,
+                               const rocksdb::Slice &val) {
+  const uint64 key_len = key.size();
+  const uint64 val_len = val.size();
+
+  block->append(reinterpret_cast<const char *>(&key_len), sizeof(key_len));
+  block->append(key.data(), key.size());
+  block->append(reinterpret_cast<const char *>(&val_len), sizeof(val_len));
+  block->append(val.data(), val.size());
+}
+
+static rocksdb::Slice rdb_sk_build_read(const char **const ptr) {
+  uint64 len;
+  memcpy(&len, *ptr, sizeof(len));
+  const rocksdb::Slice slice(*ptr + sizeof(len), len);
+  *ptr += sizeof(len) + len;
+  return slice;
+}
+
+/*
+  Worker side of a block queued by inplace_populate_sk_parallel(): add its
+  keys to the sort buffer of the range.
+*/
+static void rdb_sk_build_add_block(Rdb_sk_build_part *const part,
+                                   const std::string &block) {
+  const char *ptr = block.data();
+  const char *const end = ptr + block.size();
+
+  while (ptr < end && part->m_rc == HA_EXIT_SUCCESS) {
+    const rocksdb::Slice key = rdb_sk_build_read(&ptr);
+    const rocksdb::Slice val = rdb_sk_build_read(&ptr);
+
+    const int rc = part->m_merge.add(key, val);
+    if (rc != HA_EXIT_SUCCESS) {
+      part->set_error(rc);
+    }
+  }
+}
+
+/*
+  Choose the key ranges for a parallel build of secondary index kd.
+
+  The boundary keys of the SST files of the primary key are spread over the
+  whole table, so the rows stored there are a cheap sample of the new index.
+  The sampled index keys are sorted and cut into n_parts groups of the same
+  size; the first key of every group but the first one is a splitter.  For
+  unique indexes the splitters only keep the user defined key parts, so that
+  all entries that could be duplicates of each other end up in one range.
+
+  splitters is left empty when the sample has fewer than n_parts distinct
+  keys, e.g. when the table is still in the memtable. The index is then built
+  on this thread only.
+*/
+int ha_rocksdb::inplace_sk_splitters(
+    TABLE *const new_table_arg, const Rdb_key_def &kd, const uint n_parts,
+    std::vector<std::string> *const splitters) {
+  DBUG_ENTER_FUNC();
+  DBUG_ASSERT(n_parts > 1);
+
+  splitters->clear();
+
+  const bool is_unique_index =
+      new_table_arg->key_info[kd.get_keyno()].flags & HA_NOSAME;
+  const bool hidden_pk_exists = has_hidden_pk(table);
+  rocksdb::ColumnFamilyHandle *const pk_cf = m_pk_descr->get_cf();
+  const std::string pk_cf_name = pk_cf->GetName();
+
+  std::vector<rocksdb::LiveFileMetaData> metadata;
+  rdb->GetLiveFilesMetaData(&metadata);
+
+  std::vector<std::string> pk_keys;
+  for (const auto &file : metadata) {
+    if (file.column_family_name != pk_cf_name) {
+      continue;
+    }
+    if (m_pk_descr->covers_key(file.smallestkey)) {
+      pk_keys.push_back(file.smallestkey);
+    }
+    if (m_pk_descr->covers_key(file.largestkey)) {
+      pk_keys.push_back(file.largestkey);
+    }
+  }
+
+  if (pk_keys.size() < n_parts) {
+    DBUG_RETURN(HA_EXIT_SUCCESS);
+  }
+
+  Rdb_transaction *const tx = get_or_create_tx(table->in_use);
+  tx->acquire_snapshot(true);
+
+  const size_t max_samples = n_parts * RDB_SK_SPLIT_SAMPLES_PER_PART;
+  const size_t step = std::max<size_t>(1, pk_keys.size() / max_samples);
+  std::vector<std::string> samples;
+
+  for (size_t i = 0; i < pk_keys.size(); i += step) {
+    const rocksdb::Slice pk_key(pk_keys[i]);
+    const rocksdb::Status s = tx->get(pk_cf, pk_key, &m_retrieved_record);
+    if (s.IsNotFound()) {
+      continue;
+    }
+    if (!s.ok()) {
+      DBUG_RETURN(tx->set_status_error(table->in_use, s, *m_pk_descr,
+                                       m_tbl_def, m_table_handler));
+    }
+
+    m_last_rowkey.copy(pk_key.data(), pk_key.size(), &my_charset_bin);
+    int res = convert_record_from_storage_format(&pk_key, table->record[0]);
+
+    longlong hidden_pk_id = 0;
+    if (!res && hidden_pk_exists) {
+      res = read_hidden_pk_id_from_rowkey(&hidden_pk_id);
+    }
+    if (res) {
+      DBUG_RETURN(res);
+    }
+
+    uint size = kd.pack_record(new_table_arg, m_pack_buffer, table->record[0],
+                               m_sk_packed_tuple, &m_sk_tails, false,
+                               hidden_pk_id, 0, nullptr, m_ttl_bytes);
+    const uchar *key = m_sk_packed_tuple;
+
+    if (is_unique_index) {
+      uint n_null_fields = 0;
+      size = kd.get_memcmp_sk_parts(
+          new_table_arg,
+          rocksdb::Slice(reinterpret_cast<const char *>(key), size),
+          m_dup_sk_packed_tuple, &n_null_fields);
+      key = m_dup_sk_packed_tuple;
+    }
+
+    samples.emplace_back(reinterpret_cast<const char *>(key), size);
+  }
+
+  const rocksdb::Comparator *const sk_comp = kd.get_cf()->GetComparator();
+  std::sort(samples.begin(), samples.end(),
+            [sk_comp](const std::string &a, const std::string &b) {
+              return sk_comp->Compare(a, b) < 0;
+            });
+  samples.erase(std::unique(samples.begin(), samples.end(),
+                            [sk_comp](const std::string &a,
+                                      const std::string &b) {
+                              return sk_comp->Compare(a, b) == 0;
+                            }),
+                samples.end());
+
+  if (samples.size() < n_parts) {
+    DBUG_RETURN(HA_EXIT_SUCCESS);
+  }
+
+  for (uint i = 1; i < n_parts; i++) {
+    splitters->push_back(samples[i * samples.size() / n_parts]);
+  }
+
+  DBUG_RETURN(HA_EXIT_SUCCESS);
+}
+
+/*
+  Build secondary index kd with one worker thread per key range, the ranges
+  being cut by splitters (see inplace_sk_splitters()).
+
+  The primary key is still scanned and the new keys packed on this thread,
+  as packing goes through the fields of the shared TABLE. Each packed key is
+  routed to the worker that owns its range, which sorts the keys of its
+  range with its own Rdb_index_merge and, once the scan is done, merges them
+  and writes its own SST files. The ranges do not overlap and neither do
+  the SST files, so they are all ingested by finish_bulk_load() without any
+  compaction.
+*/
+int ha_rocksdb::inplace_populate_sk_parallel(
+    TABLE *const new_table_arg, const Rdb_key_def &kd,
+    const std::vector<std::string> &splitters) {
+  DBUG_ENTER_FUNC();
+
+  int res = HA_EXIT_SUCCESS;
+  THD *const thd = ha_thd();
+  Rdb_transaction *const tx = get_or_create_tx(table->in_use);
+  const bool hidden_pk_exists = has_hidden_pk(table);
+  const bool is_unique_index =
+      new_table_arg->key_info[kd.get_keyno()].flags & HA_NOSAME;
+  const rocksdb::Comparator *const sk_comp = kd.get_cf()->GetComparator();
+
+  std::vector<std::unique_ptr<Rdb_sk_build_part>> parts;
+
+  /*
+    Whatever happens, stop the workers before the ranges go away. Workers
+    run what they already have queued, so make them skip it on errors.
+  */
+  Ensure_cleanup stop_workers([&parts, &res]() {
+    for (const auto &part : parts) {
+      if (part->m_thread_started) {
+        if (res != HA_EXIT_SUCCESS) {
+          part->set_error(res);
+        }
+        part->m_thread.signal(true);
+        part->m_thread.join();
+      }
+    }
+  });
+
+  for (size_t i = 0; i <= splitters.size(); i++) {
+    parts.emplace_back(new Rdb_sk_build_part(
+        tx->get_rocksdb_tmpdir(), THDVAR(thd, merge_buf_size),
+        THDVAR(thd, merge_combine_read_size),
+        THDVAR(thd, merge_tmp_file_removal_delay_ms), kd.get_cf()));
+    Rdb_sk_build_part *const part = parts.back().get();
+
+    if ((res = part->m_merge.init())) {
+      DBUG_RETURN(res);
+    }
+
+    part->m_sst_info = std::make_shared<Rdb_sst_info>(
+        rdb, m_table_handler->m_table_name, kd.get_name(), kd.get_cf(),
+        *rocksdb_db_options, THDVAR(thd, trace_sst_api));
+    if ((res = tx->start_bulk_load(this, part->m_sst_info))) {
+      DBUG_RETURN(res);
+    }
+
+#ifdef HAVE_PSI_INTERFACE
+    part->m_thread.init(rdb_signal_index_merge_psi_mutex_key,
+                        rdb_signal_index_merge_psi_cond_key);
+    const int err = part->m_thread.create_thread(
+        INDEX_MERGE_THREAD_NAME, rdb_index_merge_psi_thread_key);
+#else
+    part->m_thread.init();
+    const int err = part->m_thread.create_thread(INDEX_MERGE_THREAD_NAME);
+#endif
+    if (err != 0) {
+      part->m_thread.uninit();
+      // NO_LINT_DEBUG
+      sql_print_error("RocksDB: Couldn't start an index merge thread: "
+                      "(errno=%d)",
+                      err);
+      res = HA_EXIT_FAILURE;
+      DBUG_RETURN(res);
+    }
+    part->m_thread_started = true;
+  }
+
+  /* Queue the staged keys of a range, waiting if its worker is behind */
+  const auto queue_block = [](Rdb_sk_build_part *const part) {
+    if (part->m_pending.size() >= RDB_SK_BUILD_MAX_PENDING_BLOCKS) {
+      part->m_pending.front().get();
+      part->m_pending.pop_front();
+    }
+
+    const auto block = std::make_shared<std::string>();
+    block->swap(part->m_block);
+    part->m_pending.push_back(part->m_thread.submit(
+        [part, block]() { rdb_sk_build_add_block(part, *block); }));
+
+    return part->m_rc.load();
+  };
+
+  /*
+    Note: We pass in the currently existing table + tbl_def object here,
+    as the pk index position may have changed in the case of hidden primary
+    keys.
+  */
+  const uint pk = pk_index(table, m_tbl_def);
+  if ((res = ha_index_init(pk, true))) {
+    DBUG_RETURN(res);
+  }
+
+  /* Scan each record in the primary key in order */
+  for (res = index_first(table->record[0]); res == 0;
+       res = index_next(table->record[0])) {
+    longlong hidden_pk_id = 0;
+    if (hidden_pk_exists &&
+        (res = read_hidden_pk_id_from_rowkey(&hidden_pk_id))) {
+      // NO_LINT_DEBUG
+      sql_print_error("Error retrieving hidden pk id.");
+      ha_index_end();
+      DBUG_RETURN(res);
+    }
+
+    /* Create new secondary index entry */
+    const int new_packed_size = kd.pack_record(
+        new_table_arg, m_pack_buffer, table->record[0], m_sk_packed_tuple,
+        &m_sk_tails, should_store_row_debug_checksums(), hidden_pk_id, 0,
+        nullptr, m_ttl_bytes);
+
+    const rocksdb::Slice key = rocksdb::Slice(
+        reinterpret_cast<const char *>(m_sk_packed_tuple), new_packed_size);
+    const rocksdb::Slice val =
+        rocksdb::Slice(reinterpret_cast<const char *>(m_sk_tails.ptr()),
+                       m_sk_tails.get_current_pos());
+
+    /* Range i holds the keys in [splitters[i - 1], splitters[i]) */
+    const auto it = std::upper_bound(
+        splitters.begin(), splitters.end(), key,
+        [sk_comp](const rocksdb::Slice &k, const std::string &splitter) {
+          return sk_comp->Compare(k, splitter) < 0;
+        });
+    Rdb_sk_build_part *const part = parts[it - splitters.begin()].get();
+
+    rdb_sk_build_store(&part->m_block, key, val);
+    if (part->m_block.size() >= RDB_SK_BUILD_BLOCK_SIZE &&
+        (res = queue_block(part))) {
+      ha_index_end();
+      DBUG_RETURN(res);
+    }
+  }
+
+  if (res != HA_ERR_END_OF_FILE) {
+    // NO_LINT_DEBUG
+    sql_print_error("Error retrieving index entry from primary key.");
+    ha_index_end();
+    DBUG_RETURN(res);
+  }
+  res = HA_EXIT_SUCCESS;
+
+  ha_index_end();
+
+  for (const auto &part_ptr : parts) {
+    Rdb_sk_build_part *const part = part_ptr.get();
+    if (!part->m_block.empty()) {
+      queue_block(part);
+    }
+
+    /*
+      Perform an n-way merge of the sorted buffers of this range, then write
+      the results to RocksDB via SSTFileWriter API.
+    */
+    part->m_pending.push_back(part->m_thread.submit([this, part, thd,
+                                                     new_table_arg, &kd,
+                                                     is_unique_index]() {
+      if (part->m_rc != HA_EXIT_SUCCESS) {
+        return;
+      }
+
+      std::unique_ptr<uchar[]> dup_sk_buf(
+          new uchar[kd.max_storage_fmt_length()]);
+      std::unique_ptr<uchar[]> dup_sk_buf_old(
+          new uchar[kd.max_storage_fmt_length()]);
+      struct unique_sk_buf_info sk_info;
+      sk_info.dup_sk_buf = dup_sk_buf.get();
+      sk_info.dup_sk_buf_old = dup_sk_buf_old.get();
+
+      rocksdb::Slice merge_key;
+      rocksdb::Slice merge_val;
+      int rc;
+
+      while ((rc = part->m_merge.next(&merge_key, &merge_val)) == 0) {
+        if (thd->killed) {
+          rc = HA_ERR_QUERY_INTERRUPTED;
+          break;
+        }
+
+        /* Perform uniqueness check if needed */
+        if (is_unique_index &&
+            check_duplicate_sk(new_table_arg, kd, &merge_key, &sk_info)) {
+          part->m_dup_key.assign(merge_key.data(), merge_key.size());
+          part->m_dup_val.assign(merge_val.data(), merge_val.size());
+          rc = ER_DUP_ENTRY;
+          break;
+        }
+
+        if ((rc = part->m_sst_info->put(merge_key, merge_val))) {
+          break;
+        }
+      }
+
+      /* rc == -1 means that we are finished */
+      if (rc > 0) {
+        part->set_error(rc);
+      }
+    }));
+  }
+
+  for (const auto &part : parts) {
+    for (auto &pending : part->m_pending) {
+      pending.get();
+    }
+    part->m_pending.clear();
+  }
+
+  for (const auto &part : parts) {
+    if (!part->m_dup_key.empty()) {
+      /*
+        Duplicate entry found when trying to create unique secondary key.
+        We need to unpack the record into new_table_arg->record[0] as it
+        is used inside print_keydup_error so that the error message shows
+        the duplicate record.
+      */
+      const rocksdb::Slice dup_key(part->m_dup_key);
+      const rocksdb::Slice dup_val(part->m_dup_val);
+      if (kd.unpack_record(new_table_arg, new_table_arg->record[0], &dup_key,
+                           &dup_val,
+                           m_converter->get_verify_row_debug_checksums())) {
+        /* Should never reach here */
+        DBUG_ASSERT(0);
+      }
+
+      print_keydup_error(new_table_arg,
+                         &new_table_arg->key_info[kd.get_keyno()], MYF(0),
+                         thd);
+      res = ER_DUP_ENTRY;
+      DBUG_RETURN(res);
+    }
+
+    if ((res = part->m_rc)) {
+      // NO_LINT_DEBUG
+      sql_print_error("Error while bulk loading keys in external merge sort.");
+      DBUG_RETURN(res);
+    }
+  }
+
+  bool is_critical_error;
+  res = tx->finish_bulk_load(&is_critical_error);
+  if (res && is_critical_error) {
+    // NO_LINT_DEBUG
+    sql_print_error("Error finishing bulk load.");
+  }
+
+  DBUG_RETURN(res);
+}
+
 /**
   Commit or rollback the changes made during prepare_inplace_alter_table()
   and inplace_alter_table() inside the storage engine.
@@ -16167,6 +16760,23 @@ void rdb_tx_multi_get(Rdb_transaction *tx,
  * Multi-Range-Read implementation based on RocksDB's MultiGet() call
  ***************************************************************************/
 
+/*
+  Whether MultiGet-MRR may be used for a scan that is expected to return
+  @rows rows.
+
+  optimizer_switch='mrr=on,mrr_cost_based=off' always allows it. With
+  mrr_cost_based=on it is allowed if @@rocksdb_mrr_cost_based is set and more
+  than one primary key lookup is expected, a single lookup gains nothing from
+  batching. The cost reported to the optimizer is left as computed for the
+  default implementation, so enabling it does not change plan choices.
+*/
+static bool rdb_mrr_enabled(THD *thd, ha_rows rows) {
+  if (!thd->optimizer_switch_flag(OPTIMIZER_SWITCH_MRR)) return false;
+  if (!thd->optimizer_switch_flag(OPTIMIZER_SWITCH_MRR_COST_BASED))
+    return true;
+  return THDVAR(thd, mrr_cost_based) && rows > 1;
+}
+
 /*
   Check if MultiGet-MRR can be used to scan given list of ranges.
 
@@ -16188,12 +16798,6 @@ ha_rows ha_rocksdb::multi_range_read_info_const(uint keyno, RANGE_SEQ_IF *seq,
   ha_rows res;
   THD *thd = table->in_use;
 
-  // We allow MultiGet-MRR only with these settings:
-  //   optimizer_switch='mrr=on,mrr_cost_based=off'
-  // mrr_cost_based is not supported
-  bool mrr_enabled =
-      thd->optimizer_switch_flag(OPTIMIZER_SWITCH_MRR) &&
-      !thd->optimizer_switch_flag(OPTIMIZER_SWITCH_MRR_COST_BASED);
   uint def_bufsz = *bufsz;
   res = handler::multi_range_read_info_const(keyno, seq, seq_init_param,
                                              n_ranges, &def_bufsz, flags, cost);
@@ -16202,14 +16806,16 @@ ha_rows ha_rocksdb::multi_range_read_info_const(uint keyno, RANGE_SEQ_IF *seq,
 
   // Use the default MRR implementation if @@optimizer_switch value tells us
   // to, or if the query needs to do a locking read.
-  if (!mrr_enabled || m_lock_rows != RDB_LOCK_NONE) return res;
+  if (!rdb_mrr_enabled(thd, res) || m_lock_rows != RDB_LOCK_NONE) return res;
 
   // How many buffer required to store all requried keys
   uint calculated_buf = mrr_get_length_per_rec() * res * 10 + 1;
-  // How many buffer required to store maximum number of keys per MRR
+  // How many buffer required to store maximum number of keys per MRR. A
+  // pipelined scan keeps two batches in the buffer.
   ssize_t elements_limit = THDVAR(thd, mrr_batch_size);
+  const uint n_batches = rdb_mrr_fetch_threads.empty() ? 1 : 2;
   uint mrr_batch_size_buff =
-      mrr_get_length_per_rec() * elements_limit * 1.1 + 1;
+      mrr_get_length_per_rec() * elements_limit * n_batches * 1.1 + 1;
   // The final bufsz value should be minimum among these three values:
   // 1. The passed in bufsz: contains maximum available buff size --- by
   // default, its value is specify by session variable read_rnd_buff_size,
@@ -16261,9 +16867,7 @@ ha_rows ha_rocksdb::multi_range_read_info(uint keyno, uint n_ranges, uint keys,
                                           Cost_estimate *cost) {
   ha_rows res;
   THD *thd = table->in_use;
-  bool mrr_enabled =
-      thd->optimizer_switch_flag(OPTIMIZER_SWITCH_MRR) &&
-      !thd->optimizer_switch_flag(OPTIMIZER_SWITCH_MRR_COST_BASED);
+  bool mrr_enabled = rdb_mrr_enabled(thd, keys);
 
   res =
       handler::multi_range_read_info(keyno, n_ranges, keys, bufsz, flags, cost);
@@ -16406,14 +17010,31 @@ int ha_rocksdb::multi_range_read_init(RANGE_SEQ_IF *seq, void *seq_init_param,
 
   // Ok, using a non-default MRR implementation, MultiGet-MRR
 
+  // BKA calls this for every refill of its join buffer without ending the
+  // index scan, and passes the same buffer again. Finish the previous scan
+  // first, a fetch for it may still be writing to the buffer.
+  if (mrr_rowid_reader) mrr_free();
+
   mrr_uses_default_impl = false;
-  mrr_n_elements = 0;  // nothing to cleanup, yet.
   mrr_enabled_keyread = false;
   mrr_rowid_reader = nullptr;
 
   mrr_funcs = *seq;
   mrr_buf = *buf;
 
+  // A pipelined scan splits the buffer in two halves, one for each batch
+  const size_t buf_size = buf->buffer_end - buf->buffer;
+  mrr_pipelined = mrr_can_pipeline(table->in_use) &&
+                  buf_size / 2 >= 2 * mrr_get_length_per_rec();
+  mrr_batches[0].buffer = (char *)buf->buffer;
+  mrr_batches[0].buffer_end = mrr_pipelined
+                                  ? mrr_batches[0].buffer + buf_size / 2
+                                  : (char *)buf->buffer_end;
+  mrr_batches[1].buffer = mrr_batches[0].buffer_end;
+  mrr_batches[1].buffer_end = (char *)buf->buffer_end;
+  mrr_cur = &mrr_batches[0];
+  mrr_read_index = 0;
+
   bool is_mrr_assoc = !MY_TEST(mode & HA_MRR_NO_ASSOCIATION);
   if (is_mrr_assoc)
     status_var_increment(
@@ -16433,7 +17054,10 @@ int ha_rocksdb::multi_range_read_init(RANGE_SEQ_IF *seq, void *seq_init_param,
     mrr_rowid_reader = reader;
   }
 
-  res = mrr_fill_buffer();
+  res = mrr_fill_batch(mrr_cur, false);
+
+  // Start fetching the second batch right away
+  if (!res && mrr_pipelined) res = mrr_fill_batch(mrr_next_batch(), true);
 
   // note: here, we must NOT return HA_ERR_END_OF_FILE even if we know there
   // are no matches. We should return 0 here and return HA_ERR_END_OF_FILE
@@ -16459,6 +17083,18 @@ template <typename T> void align_ptr(char **p) {
   }
 }
 
+/*
+  Whether the MultiGet of the next batch may run on a fetch thread while the
+  current batch is being returned. The fetch reads through the transaction
+  concurrently with this thread, which is only safe as long as nothing writes
+  to the transaction meanwhile, so this is limited to plain SELECTs.
+*/
+bool ha_rocksdb::mrr_can_pipeline(THD *thd) const {
+  return !rdb_mrr_fetch_threads.empty() &&
+         my_core::thd_sql_command(thd) == SQLCOM_SELECT &&
+         !thd->lex->uses_stored_routines();
+}
+
 /*
   We've got a buffer in mrr_buf, and in order to call RocksDB's MultiGet, we
   need to use this space to construct several arrays of the same size N:
@@ -16487,12 +17123,18 @@ template <typename T> void align_ptr(char **p) {
   Note that the buffer may be much larger than necessary. For range scans,
   @@rnd_buffer_size=256K is passed, even if there will be only a few lookup
   values.
-*/
 
-int ha_rocksdb::mrr_fill_buffer() {
+  The arrays are built in the part of the buffer that belongs to @batch. With
+  @async, the MultiGet call is handed to a fetch thread and
+  mrr_wait_batch() has to be called before the results are used. The rowids
+  are always collected by this thread, as that uses the handler's own scan.
+  Note that RocksDB perf context counters of a MultiGet that runs on a fetch
+  thread are not attributed to the query.
+*/
 
-  mrr_free_rows();
-  mrr_read_index = 0;
+int ha_rocksdb::mrr_fill_batch(Mrr_batch *const batch, const bool async) {
+  DBUG_ASSERT(batch->n_elements == 0);
+  DBUG_ASSERT(!batch->pending.valid());
 
   // This should agree with the code in mrr_get_length_per_rec():
   ssize_t element_size = sizeof(rocksdb::Slice) + sizeof(rocksdb::Status) +
@@ -16501,7 +17143,7 @@ int ha_rocksdb::mrr_fill_buffer() {
                          m_pk_descr->max_storage_fmt_length();
 
   // The buffer has space for this many elements:
-  ssize_t n_elements = (mrr_buf.buffer_end - mrr_buf.buffer) / element_size;
+  ssize_t n_elements = (batch->buffer_end - batch->buffer) / element_size;
 
   THD *thd = table->in_use;
   ssize_t elements_limit = THDVAR(thd, mrr_batch_size);
@@ -16514,25 +17156,25 @@ int ha_rocksdb::mrr_fill_buffer() {
     return HA_ERR_INTERNAL_ERROR;
   }
 
-  char *buf = (char *)mrr_buf.buffer;
+  char *buf = batch->buffer;
 
   align_ptr<rocksdb::Slice>(&buf);
-  mrr_keys = (rocksdb::Slice*)buf;
+  batch->keys = (rocksdb::Slice*)buf;
   buf += sizeof(rocksdb::Slice) * n_elements;
 
   align_ptr<rocksdb::Status>(&buf);
-  mrr_statuses = (rocksdb::Status*)buf;
+  batch->statuses = (rocksdb::Status*)buf;
   buf += sizeof(rocksdb::Status) * n_elements;
 
   align_ptr<rocksdb::PinnableSlice>(&buf);
-  mrr_values = (rocksdb::PinnableSlice*)buf;
+  batch->values = (rocksdb::PinnableSlice*)buf;
   buf += sizeof(rocksdb::PinnableSlice) * n_elements;
 
   align_ptr<char*>(&buf);
-  mrr_range_ptrs = (char **)buf;
+  batch->range_ptrs = (char **)buf;
   buf += sizeof(char *) * n_elements;
 
-  if (buf + m_pk_descr->max_storage_fmt_length() >= (char*)mrr_buf.buffer_end) {
+  if (buf + m_pk_descr->max_storage_fmt_length() >= batch->buffer_end) {
     // a VERY unlikely scenario:  we were given a really small buffer,
     // (probably for just one rowid), and also we had to use some bytes for
     // alignment. As a result, there's no buffer space left to hold even one
@@ -16543,7 +17185,6 @@ int ha_rocksdb::mrr_fill_buffer() {
 
   ssize_t elem = 0;
 
-  mrr_n_elements = elem;
   int key_size;
   char *range_ptr;
   int err;
@@ -16552,17 +17193,17 @@ int ha_rocksdb::mrr_fill_buffer() {
     DEBUG_SYNC(table->in_use, "rocksdb.mrr_fill_buffer.loop");
     if (table->in_use->killed) return HA_ERR_QUERY_INTERRUPTED;
 
-    new (&mrr_keys[elem]) rocksdb::Slice(buf, key_size);
-    new (&mrr_statuses[elem]) rocksdb::Status;
-    new (&mrr_values[elem]) rocksdb::PinnableSlice;
-    mrr_range_ptrs[elem] = range_ptr;
+    new (&batch->keys[elem]) rocksdb::Slice(buf, key_size);
+    new (&batch->statuses[elem]) rocksdb::Status;
+    new (&batch->values[elem]) rocksdb::PinnableSlice;
+    batch->range_ptrs[elem] = range_ptr;
     buf += key_size;
 
     elem++;
-    mrr_n_elements= elem;
+    batch->n_elements= elem;
 
     if ((elem == n_elements) || (buf + m_pk_descr->max_storage_fmt_length() >=
-                                 (char*)mrr_buf.buffer_end)) {
+                                 batch->buffer_end)) {
       // No more buffer space
       break;
     }
@@ -16570,19 +17211,39 @@ int ha_rocksdb::mrr_fill_buffer() {
 
   if (err && err != HA_ERR_END_OF_FILE) return err;
 
-  if (mrr_n_elements == 0) return HA_ERR_END_OF_FILE;  // nothing to scan
+  if (batch->n_elements == 0) return HA_ERR_END_OF_FILE;  // nothing to scan
 
   Rdb_transaction *const tx = get_or_create_tx(table->in_use);
+  rocksdb::ColumnFamilyHandle *const cf = m_pk_descr->get_cf();
+  const bool sorted_input = active_index == table->s->primary_key;
 
   if (active_index == table->s->primary_key)
-    stats.rows_requested += mrr_n_elements;
-
-  tx->multi_get(m_pk_descr->get_cf(), mrr_n_elements, mrr_keys, mrr_values,
-                mrr_statuses, active_index == table->s->primary_key);
+    stats.rows_requested += batch->n_elements;
+
+  thd->status_var.ha_mrr_multiget_batch_count++;
+  thd->status_var.ha_mrr_multiget_key_count += batch->n_elements;
+
+  if (async) {
+    thd->status_var.ha_mrr_multiget_overlapped_count++;
+    const uint n = rdb_mrr_fetch_next_thread++ % rdb_mrr_fetch_threads.size();
+    batch->pending = rdb_mrr_fetch_threads[n]->submit(
+        [tx, cf, batch, sorted_input]() {
+          tx->multi_get(cf, batch->n_elements, batch->keys, batch->values,
+                        batch->statuses, sorted_input);
+        });
+  } else {
+    tx->multi_get(cf, batch->n_elements, batch->keys, batch->values,
+                  batch->statuses, sorted_input);
+  }
 
   return 0;
 }
 
+// Wait until the MultiGet of a pipelined batch has completed
+void ha_rocksdb::mrr_wait_batch(Mrr_batch *const batch) {
+  if (batch->pending.valid()) batch->pending.get();
+}
+
 void ha_rocksdb::mrr_free() {
   // Free everything
   if (mrr_enabled_keyread) {
@@ -16594,11 +17255,18 @@ void ha_rocksdb::mrr_free() {
   mrr_rowid_reader = nullptr;
 }
 
-void ha_rocksdb::mrr_free_rows() {
-  for (ssize_t i = 0; i < mrr_n_elements; i++) {
-    mrr_values[i].~PinnableSlice();
-    mrr_statuses[i].~Status();
-    // no need to free mrr_keys
+/*
+  Free the rows of a batch, @n_returned of which have been returned to the
+  SQL layer.
+*/
+void ha_rocksdb::mrr_free_batch(Mrr_batch *const batch,
+                                const ssize_t n_returned) {
+  mrr_wait_batch(batch);
+
+  for (ssize_t i = 0; i < batch->n_elements; i++) {
+    batch->values[i].~PinnableSlice();
+    batch->statuses[i].~Status();
+    // no need to free keys
   }
 
   // There could be rows that MultiGet has returned but MyRocks hasn't
@@ -16606,13 +17274,19 @@ void ha_rocksdb::mrr_free_rows() {
   // Count them in in "rows_read" anyway. (This is only necessary when using
   // clustered PK. When using a secondary key, the index-only part of the scan
   // that collects the rowids has caused all counters to be incremented)
-  if (mrr_used_cpk && mrr_n_elements) {
-    stats.rows_read += mrr_n_elements - mrr_read_index;
+  if (mrr_used_cpk && batch->n_elements) {
+    stats.rows_read += batch->n_elements - n_returned;
   }
 
-  mrr_n_elements = 0;
+  batch->n_elements = 0;
   // We can't rely on the data from HANDLER_BUFFER once the scan is over, so:
-  mrr_values = nullptr;
+  batch->values = nullptr;
+}
+
+void ha_rocksdb::mrr_free_rows() {
+  mrr_free_batch(mrr_cur, mrr_read_index);
+  mrr_free_batch(mrr_next_batch(), 0);
+  mrr_read_index = 0;
 }
 
 int ha_rocksdb::multi_range_read_next(char **range_info) {
@@ -16629,33 +17303,52 @@ int ha_rocksdb::multi_range_read_next(char **range_info) {
     while (1) {
       if (table->in_use->killed) return HA_ERR_QUERY_INTERRUPTED;
 
-      if (mrr_read_index >= mrr_n_elements) {
-        if (mrr_rowid_reader->eof() || !mrr_n_elements) {
-          table->status = STATUS_NOT_FOUND;  // not sure if this is necessary?
-          mrr_free_rows();
-          return HA_ERR_END_OF_FILE;
-        }
+      if (mrr_read_index >= mrr_cur->n_elements) {
+        if (mrr_pipelined) {
+          // Switch to the batch that has been fetched meanwhile, and start
+          // fetching the one after it into the space of the current one.
+          Mrr_batch *const next = mrr_next_batch();
+          if (!next->n_elements) {
+            table->status = STATUS_NOT_FOUND;
+            mrr_free_rows();
+            return HA_ERR_END_OF_FILE;
+          }
+          mrr_wait_batch(next);
+          mrr_free_batch(mrr_cur, mrr_read_index);
+          mrr_cur = next;
+          mrr_read_index = 0;
 
-        if ((rc = mrr_fill_buffer())) {
-          if (rc == HA_ERR_END_OF_FILE) table->status = STATUS_NOT_FOUND;
-          return rc;
+          rc = mrr_fill_batch(mrr_next_batch(), true);
+          if (rc && rc != HA_ERR_END_OF_FILE) return rc;
+        } else {
+          if (mrr_rowid_reader->eof() || !mrr_cur->n_elements) {
+            table->status = STATUS_NOT_FOUND;  // not sure if this is necessary?
+            mrr_free_rows();
+            return HA_ERR_END_OF_FILE;
+          }
+
+          mrr_free_rows();
+          if ((rc = mrr_fill_batch(mrr_cur, false))) {
+            if (rc == HA_ERR_END_OF_FILE) table->status = STATUS_NOT_FOUND;
+            return rc;
+          }
         }
       }
       // If we found a status that has a row, leave the loop
-      if (mrr_statuses[mrr_read_index].ok()) break;
+      if (mrr_cur->statuses[mrr_read_index].ok()) break;
 
       // Skip the NotFound errors, return any other error to the SQL layer
-      if (!mrr_statuses[mrr_read_index].IsNotFound())
-        return rdb_error_to_mysql(mrr_statuses[mrr_read_index]);
+      if (!mrr_cur->statuses[mrr_read_index].IsNotFound())
+        return rdb_error_to_mysql(mrr_cur->statuses[mrr_read_index]);
 
       mrr_read_index++;
     }
     size_t cur_key = mrr_read_index++;
 
-    const rocksdb::Slice &rowkey = mrr_keys[cur_key];
+    const rocksdb::Slice &rowkey = mrr_cur->keys[cur_key];
 
     if (mrr_funcs.skip_record &&
-        mrr_funcs.skip_record(mrr_iter, mrr_range_ptrs[cur_key],
+        mrr_funcs.skip_record(mrr_iter, mrr_cur->range_ptrs[cur_key],
                               (uchar*)rowkey.data())) {
       rc = HA_ERR_END_OF_FILE;
       continue;
@@ -16664,10 +17357,11 @@ int ha_rocksdb::multi_range_read_next(char **range_info) {
     m_last_rowkey.copy((const char *)rowkey.data(), rowkey.size(),
                        &my_charset_bin);
 
-    *range_info = mrr_range_ptrs[cur_key];
+    *range_info = mrr_cur->range_ptrs[cur_key];
 
     m_retrieved_record.Reset();
-    m_retrieved_record.PinSlice(mrr_values[cur_key], &mrr_values[cur_key]);
+    m_retrieved_record.PinSlice(mrr_cur->values[cur_key],
+                                &mrr_cur->values[cur_key]);
 
     /* If we found the record, but it's expired, pretend we didn't find it.  */
     if (m_pk_descr->has_ttl() &&
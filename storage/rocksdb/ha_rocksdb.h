@@ -20,6 +20,7 @@
 #endif
 
 /* C++ standard header files */
+#include <future>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -686,20 +687,49 @@ class ha_rocksdb : public my_core::handler {
   friend class Mrr_pk_scan_rowid_source;
   friend class Mrr_sec_key_rowid_source;
 
-  // MRR parameters and output values
-  rocksdb::Slice *mrr_keys;
-  rocksdb::Status *mrr_statuses;
-  char **mrr_range_ptrs;
-  rocksdb::PinnableSlice *mrr_values;
+  /*
+    A batch of MultiGet lookups, laid out in (a part of) mrr_buf. See
+    mrr_fill_batch() for the layout.
+  */
+  struct Mrr_batch {
+    // MRR parameters and output values
+    rocksdb::Slice *keys = nullptr;
+    rocksdb::Status *statuses = nullptr;
+    char **range_ptrs = nullptr;
+    rocksdb::PinnableSlice *values = nullptr;
+
+    ssize_t n_elements = 0;  // Number of elements in the above arrays
+
+    // Part of mrr_buf this batch may use
+    char *buffer = nullptr;
+    char *buffer_end = nullptr;
+
+    // Valid while the MultiGet of a pipelined batch runs on a fetch thread
+    std::future<void> pending;
+  };
+
+  /*
+    A pipelined scan splits mrr_buf into two batches: while the rows of one
+    are returned, the lookups of the other one are in flight. Otherwise only
+    mrr_batches[0] is used.
+  */
+  Mrr_batch mrr_batches[2];
+  Mrr_batch *mrr_cur;  // The batch we are returning rows from
+  bool mrr_pipelined;
 
-  ssize_t mrr_n_elements;  // Number of elements in the above arrays
   ssize_t mrr_read_index;  // Number of the element we will return next
 
   // if true, MRR code has enabled keyread (and should disable it back)
   bool mrr_enabled_keyread;
   bool mrr_used_cpk;
 
-  int mrr_fill_buffer();
+  Mrr_batch *mrr_next_batch() {
+    return mrr_cur == &mrr_batches[0] ? &mrr_batches[1] : &mrr_batches[0];
+  }
+  bool mrr_can_pipeline(THD *thd) const;
+  int mrr_fill_batch(Mrr_batch *batch, bool async);
+  void mrr_wait_batch(Mrr_batch *batch);
+  void mrr_free_batch(Mrr_batch *batch, ssize_t n_returned);
   void mrr_free_rows();
   void mrr_free();
   uint mrr_get_length_per_rec();
@@ -884,6 +914,16 @@ class ha_rocksdb : public my_core::handler {
       const std::unordered_set<std::shared_ptr<Rdb_key_def>> &indexes)
       MY_ATTRIBUTE((__nonnull__, __warn_unused_result__));
 
+  int inplace_sk_splitters(TABLE *const new_table_arg, const Rdb_key_def &kd,
+                           const uint n_parts,
+                           std::vector<std::string> *const splitters)
+      MY_ATTRIBUTE((__nonnull__, __warn_unused_result__));
+
+  int inplace_populate_sk_parallel(TABLE *const new_table_arg,
+                                   const Rdb_key_def &kd,
+                                   const std::vector<std::string> &splitters)
+      MY_ATTRIBUTE((__nonnull__, __warn_unused_result__));
+
   int finalize_bulk_load(bool print_client_error = true)
       MY_ATTRIBUTE((__warn_unused_result__));
 
@@ -58,11 +58,12 @@ namespace myrocks {
 
 /* We only support simple equal / comparison functions */
 bool inline is_supported_item_func(Item_func::Functype type) {
-  // TODO(yzha) - Support EQUAL_FUNC <=>
   // TODO(yzha) - Convert into a lookup table
-  if (type != Item_func::EQ_FUNC && type != Item_func::IN_FUNC &&
+  if (type != Item_func::EQ_FUNC && type != Item_func::EQUAL_FUNC &&
+      type != Item_func::IN_FUNC && type != Item_func::BETWEEN &&
       type != Item_func::LT_FUNC && type != Item_func::LE_FUNC &&
-      type != Item_func::GE_FUNC && type != Item_func::GT_FUNC) {
+      type != Item_func::GE_FUNC && type != Item_func::GT_FUNC &&
+      type != Item_func::ISNULL_FUNC && type != Item_func::ISNOTNULL_FUNC) {
     return false;
   }
 
@@ -74,6 +75,8 @@ namespace {
 /*
   Represents single conditional expression in SELECT WHERE
   Example: id1 > 100
+  A BETWEEN is stored as a pair of >= and <= sharing the same cond_item,
+  and A <=> NULL is stored as A IS NULL (ISNULL_FUNC without val_item)
  */
 struct sql_cond {
   Item_func::Functype op_type;  // the operator, such as >
@@ -141,7 +144,7 @@ class select_parser {
     // @TODO - PROCEDURE
     // NOTE: These have side effects and their orders are important
     if (parse_index() || parse_items() || parse_order_by() || parse_where() ||
-        parse_limit()) {
+        check_order_by() || parse_limit()) {
       return true;
     }
 
@@ -208,6 +211,14 @@ class select_parser {
           str += "IN";
           break;
         }
+        case Item_func::ISNULL_FUNC: {
+          str += "IS NULL";
+          break;
+        }
+        case Item_func::ISNOTNULL_FUNC: {
+          str += "IS NOT NULL";
+          break;
+        }
         default:
           str += "?";
       }
@@ -229,7 +240,7 @@ class select_parser {
           }
         }
         str += ")";
-      } else {
+      } else if (cond.val_item != nullptr) {
         String storage;
         String *ret = cond.val_item->val_str(&storage);
         if (ret == nullptr) {
@@ -255,6 +266,7 @@ class select_parser {
   size_t get_cond_count() const { return m_cond_count; }
   uint64_t get_select_limit() const { return m_select_limit; }
   uint64_t get_offset_limit() const { return m_offset_limit; }
+  bool is_impossible_where() const { return m_is_impossible_where; }
   const char *get_error_msg() const { return m_error_msg; }
 
  private:
@@ -265,6 +277,10 @@ class select_parser {
 
   uint m_index;
   bool m_is_order_desc;
+  // First key part referenced in ORDER BY
+  uint m_order_key_part = 0;
+  // WHERE can never be true, such as A = NULL or NOT NULL column IS NULL
+  bool m_is_impossible_where = false;
   std::vector<Field *> m_field_list;
   sql_cond m_cond_list[MAX_NOSQL_COND_COUNT];
   uint m_cond_count = 0;
@@ -393,6 +409,7 @@ class select_parser {
           m_error_msg = "ORDER BY field doesn't belong to the index";
           return true;
         }
+        m_order_key_part = cur_index;
       } else {
         if (m_is_order_desc != (order->direction == st_order::ORDER_DESC)) {
           // Found a different order
@@ -428,19 +445,31 @@ class select_parser {
   bool inline parse_cond(Item_func *func) {
     auto type = func->functype();
     if (!is_supported_item_func(type)) {
-      m_error_msg = "Unsupported WHERE - needs to be >, >=, <, <=, =, IN";
+      m_error_msg =
+          "Unsupported WHERE - needs to be >, >=, <, <=, =, <=>, IN, "
+          "BETWEEN, IS [NOT] NULL";
       return true;
     }
 
     const auto args = func->arguments();
     Item_field *field_arg = nullptr;
     Item *op_arg = nullptr;
+    Item *op_arg2 = nullptr;
+
+    if (type == Item_func::IN_FUNC || type == Item_func::BETWEEN) {
+      // NOT IN and NOT BETWEEN share the functype with IN and BETWEEN
+      if (static_cast<Item_func_opt_neg *>(func)->negated) {
+        m_error_msg = "Unsupported WHERE - NOT IN/BETWEEN not supported";
+        return true;
+      }
 
-    if (type == Item_func::IN_FUNC) {
       // arg0 is always the field
+      if (args[0]->type() != Item::FIELD_ITEM) {
+        m_error_msg = "Unsupported WHERE - should only reference field";
+        return true;
+      }
       field_arg = static_cast<Item_field *>(args[0]);
-      auto in_func = static_cast<Item_func_in *>(func);
-      for (uint i = 1; i < in_func->argument_count(); ++i) {
+      for (uint i = 1; i < func->argument_count(); ++i) {
         if (!is_supported_op_arg(args[i])) {
           // Make sure the field has supported type
           // Where as for values we convert them to the correct type just
@@ -451,6 +480,18 @@ class select_parser {
           return true;
         }
       }
+
+      if (type == Item_func::BETWEEN) {
+        op_arg = args[1];
+        op_arg2 = args[2];
+      }
+    } else if (type == Item_func::ISNULL_FUNC ||
+               type == Item_func::ISNOTNULL_FUNC) {
+      if (args[0]->type() != Item::FIELD_ITEM) {
+        m_error_msg = "Unsupported WHERE - should only reference field";
+        return true;
+      }
+      field_arg = static_cast<Item_field *>(args[0]);
     } else {
       // Extract the field and operand, such as A > 0
       if (args[0]->type() == Item::FIELD_ITEM) {
@@ -484,16 +525,40 @@ class select_parser {
       return true;
     }
 
-    if (found->real_maybe_null()) {
-      m_error_msg = "NULL fields not supported";
-      return true;
+    // A <=> NULL is A IS NULL, and A <=> n is A = n otherwise
+    if (type == Item_func::EQUAL_FUNC) {
+      type = (op_arg->type() == Item::NULL_ITEM) ? Item_func::ISNULL_FUNC
+                                                 : Item_func::EQ_FUNC;
+    }
+
+    if (type == Item_func::ISNULL_FUNC || type == Item_func::ISNOTNULL_FUNC) {
+      if (type == Item_func::ISNULL_FUNC &&
+          (found->flags & AUTO_INCREMENT_FLAG) &&
+          (m_thd->variables.option_bits & OPTION_AUTO_IS_NULL)) {
+        // auto_increment IS NULL means LAST_INSERT_ID() in this mode
+        m_error_msg = "IS NULL on auto_increment with sql_auto_is_null";
+        return true;
+      }
+
+      if (!found->real_maybe_null()) {
+        // NOT NULL column: IS NULL is never true, IS NOT NULL always is
+        if (type == Item_func::ISNULL_FUNC) {
+          m_is_impossible_where = true;
+        }
+        return false;
+      }
+    } else if ((op_arg != nullptr && op_arg->type() == Item::NULL_ITEM) ||
+               (op_arg2 != nullptr && op_arg2->type() == Item::NULL_ITEM)) {
+      // Comparing with NULL yields NULL, which is never true
+      m_is_impossible_where = true;
+      return false;
     }
 
     // TAO-specific optimizations to remove redundant time >= 0 and time <=
     // UINT32_MAX. Once TAO removes those unnecessary WHERE we can take
     // these out
-    if (found->flags & UNSIGNED_FLAG && found->type() == MYSQL_TYPE_LONG) {
-      DBUG_ASSERT(op_arg != nullptr);
+    if (found->flags & UNSIGNED_FLAG && found->type() == MYSQL_TYPE_LONG &&
+        op_arg2 == nullptr) {
       if (type == Item_func::GE_FUNC && op_arg->val_int() == 0) {
         // unsigned A >= 0 - we can skip this one
         return false;
@@ -510,7 +575,8 @@ class select_parser {
     // expression later
     field_arg->set_field(m_thd, found);
 
-    if (m_cond_count >= MAX_NOSQL_COND_COUNT) {
+    if (m_cond_count + (type == Item_func::BETWEEN ? 2 : 1) >
+        MAX_NOSQL_COND_COUNT) {
       m_error_msg = "Too many WHERE expressions";
       return true;
     }
@@ -519,9 +585,17 @@ class select_parser {
       // In the case of IN func, we use the actual Item_func_in as it contain
       // the list of items
       m_cond_list[m_cond_count++] = {type, found, func, nullptr};
+    } else if (type == Item_func::BETWEEN) {
+      // A BETWEEN x AND y is A >= x AND A <= y. Both halves point to the
+      // BETWEEN item so that either one used as filter checks the whole range
+      m_cond_list[m_cond_count++] = {Item_func::GE_FUNC, found, func, op_arg};
+      m_cond_list[m_cond_count++] = {Item_func::LE_FUNC, found, func, op_arg2};
     } else {
-      DBUG_ASSERT(op_arg != nullptr);
-      m_cond_list[m_cond_count++] = {type, found, func, op_arg};
+      DBUG_ASSERT(op_arg != nullptr || type == Item_func::ISNULL_FUNC ||
+                  type == Item_func::ISNOTNULL_FUNC);
+      m_cond_list[m_cond_count++] = {type, found, func,
+                                     type == Item_func::ISNULL_FUNC ? nullptr
+                                                                    : op_arg};
     }
 
     return false;
@@ -529,12 +603,16 @@ class select_parser {
 
   const char *where_err_msg =
       "Unsupported WHERE: should be expr [(AND expr)*] where expr only "
-      "contains >, >=, <, <=, =, IN";
+      "contains >, >=, <, <=, =, <=>, IN, BETWEEN, IS [NOT] NULL";
 
   bool parse_where() {
     if (m_select_lex->where == nullptr) {
-      m_error_msg = where_err_msg;
-      return true;
+      // A full index scan is only acceptable when bounded by LIMIT
+      if (!m_select_lex->explicit_limit) {
+        m_error_msg = where_err_msg;
+        return true;
+      }
+      return false;
     }
 
     // We only allow pure conjunctive where clauses such as A=1 AND B=2
@@ -572,6 +650,41 @@ class select_parser {
     return false;
   }
 
+  bool inline is_eq_cond(uint key_part_no) {
+    Field *field = m_table->key_info[m_index].key_part[key_part_no].field;
+    for (uint i = 0; i < m_cond_count; ++i) {
+      const sql_cond &cond = m_cond_list[i];
+      if (cond.field != field) {
+        continue;
+      }
+      if (cond.op_type == Item_func::EQ_FUNC ||
+          cond.op_type == Item_func::ISNULL_FUNC ||
+          (cond.op_type == Item_func::IN_FUNC &&
+           static_cast<Item_func *>(cond.cond_item)->argument_count() ==
+               2)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Rows come back in index order, which is only the ORDER BY order if all
+  // key parts before the first ORDER BY field are fixed to a single value
+  bool check_order_by() {
+    if (m_is_impossible_where) {
+      return false;
+    }
+
+    for (uint i = 0; i < m_order_key_part; ++i) {
+      if (!is_eq_cond(i)) {
+        m_error_msg = "ORDER BY needs equality on all preceding key parts";
+        return true;
+      }
+    }
+
+    return false;
+  }
+
   bool parse_limit() {
     // NOTE: We can't rely on explicit_limit as execute_sqlcom_select may
     // assign one using the global parameters
@@ -730,10 +843,10 @@ class select_exec {
   bool run_query();
   bool run_range_query(txn_wrapper *txn);
   bool unpack_for_sk(txn_wrapper *txn, const rocksdb::Slice &rkey,
-                     const rocksdb::Slice &rvalue);
+                     const rocksdb::Slice &rvalue, bool *sk_match);
   bool unpack_for_pk(const rocksdb::Slice &rkey, const rocksdb::Slice &rvalue);
-  bool eval_cond();
-  int eval_and_send();
+  bool eval_cond(uint filter_count);
+  int eval_and_send(bool sk_match = true);
   bool run_pk_point_query(txn_wrapper *txn);
   bool run_sk_point_query(txn_wrapper *txn);
   bool pack_index_tuple(uint key_part_no, Rdb_string_writer *writer,
@@ -776,6 +889,10 @@ class select_exec {
   uint m_filter_list[MAX_NOSQL_COND_COUNT];
   uint m_filter_count = 0;
 
+  // Number of filters at the start of m_filter_list that only reference
+  // columns in the secondary index and can be checked before PK lookup
+  uint m_sk_filter_count = 0;
+
   // All key index tuples we packed during scanning the WHERE clause
   std::vector<key_index_tuple_writer> m_key_index_tuples;
 
@@ -863,8 +980,15 @@ class select_exec {
 
 bool select_exec::pack_index_tuple(uint key_part_no, Rdb_string_writer *writer,
                                    const Field *field, Item *item) {
-  // Don't support keys that may be NULL
-  DBUG_ASSERT(!field->real_maybe_null());
+  if (field->real_maybe_null()) {
+    // Same NULL marker as Rdb_key_def::pack_field: NULL (no item) is a
+    // single 0 byte, any value is prefixed with 1
+    if (item == nullptr) {
+      writer->write_uint8(0);
+      return false;
+    }
+    writer->write_uint8(1);
+  }
 
   switch (field->type()) {
     case MYSQL_TYPE_LONGLONG: {
@@ -1029,8 +1153,9 @@ bool INLINE_ATTR select_exec::scan_where() {
       // The current key_part in the index has a corresponding match in
       // WHERE clause. Pack the current value in WHERE into the key
       const sql_cond &cond = where_list[index_pair.first];
-      if (cond.op_type == Item_func::EQ_FUNC) {
-        // This is = operator - just keep packing the key
+      if (cond.op_type == Item_func::EQ_FUNC ||
+          cond.op_type == Item_func::ISNULL_FUNC) {
+        // This is = operator (or IS NULL) - just keep packing the key
         if (pack_cond(key_part_no, cond)) {
           return true;
         }
@@ -1067,6 +1192,10 @@ bool INLINE_ATTR select_exec::scan_where() {
         for (uint i = 0; i < prev_size; ++i) {
           DBUG_ASSERT(m_key_index_tuples[i].end.is_empty());
           for (uint j = 1; j < in_elem_count; ++j) {
+            if (args[j]->type() == Item::NULL_ITEM) {
+              // NULL never matches anything in IN list
+              continue;
+            }
             new_writers.emplace_back(m_key_index_tuples[i]);
             if (pack_index_tuple(key_part_no,
                                  &new_writers[new_writers.size() - 1].start,
@@ -1083,6 +1212,9 @@ bool INLINE_ATTR select_exec::scan_where() {
         // Anything we haven't processed here become filters
         where_list_processed[index_pair.first] = true;
         continue;
+      } else if (cond.op_type == Item_func::ISNOTNULL_FUNC) {
+        // Not a key range - IS NOT NULL and the rest become filters
+        break;
       }
 
       // Process >, >=, <, <=
@@ -1159,7 +1291,14 @@ bool INLINE_ATTR select_exec::scan_where() {
 
       start_key_count = end_key_count = prefix_key_count;
 
-      if (end_id >= 0) {
+      // NULLs sort before any value, so a range on a nullable key part that
+      // has no lower bound would include them. Use the not-NULL marker as the
+      // lower bound instead - that is the end key in descending order
+      bool null_bound =
+          key_part.field->real_maybe_null() &&
+          (m_parser.is_order_desc() ? end_id < 0 : start_id < 0);
+
+      if (end_id >= 0 || (null_bound && m_parser.is_order_desc())) {
         // end key should start from prefix of start key, which is
         // the current value of start key before appending the condition
         for (auto &entry : m_key_index_tuples) {
@@ -1168,6 +1307,20 @@ bool INLINE_ATTR select_exec::scan_where() {
           }
         }
       }
+      if (null_bound) {
+        for (auto &entry : m_key_index_tuples) {
+          if (m_parser.is_order_desc()) {
+            entry.end.write_uint8(1);
+          } else {
+            entry.start.write_uint8(1);
+          }
+        }
+        if (m_parser.is_order_desc()) {
+          m_end_inclusive = true;
+        } else {
+          m_start_inclusive = true;
+        }
+      }
       if (start_id >= 0) {
         // Mark the where condition as processed so that they don't go into
         // filters - there is no point evaluating them since we already
@@ -1308,6 +1461,15 @@ void INLINE_ATTR select_exec::scan_value() {
 
   if (!m_keyread_only && !m_index_is_pk) {
     m_key_def->get_lookup_bitmap(m_table, &m_lookup_bitmap);
+
+    // Move filters on columns the SK can unpack to the front so that they
+    // can be checked before paying for the PK lookup
+    auto where_list = m_parser.get_cond_list();
+    auto sk_filter_end = std::stable_partition(
+        m_filter_list, m_filter_list + m_filter_count, [&](uint i) {
+          return index_cover_bitmap[where_list[i].field->field_index];
+        });
+    m_sk_filter_count = sk_filter_end - m_filter_list;
   }
 
   m_converter->setup_field_decoders(m_table->read_set, m_index,
@@ -1347,13 +1509,18 @@ bool INLINE_ATTR select_exec::run() {
   m_pk_def = m_tbl_def->m_key_descr_arr[m_table_share->primary_key];
   m_converter.reset(new Rdb_converter(m_thd, m_tbl_def, m_table));
 
-  // Scans WHERE and build the key and filter list
-  if (scan_where()) {
-    return true;
-  }
+  // Nothing can match an impossible WHERE - just send an empty result
+  bool is_impossible_where = m_parser.is_impossible_where();
+
+  if (!is_impossible_where) {
+    // Scans WHERE and build the key and filter list
+    if (scan_where()) {
+      return true;
+    }
 
-  // Scan the value and devise a strategy to unpack the values
-  scan_value();
+    // Scan the value and devise a strategy to unpack the values
+    scan_value();
+  }
 
   // Prepare to send
   if (m_protocol->send_result_set_metadata(
@@ -1362,7 +1529,7 @@ bool INLINE_ATTR select_exec::run() {
     return true;
   }
 
-  if (m_select_limit == 0) {
+  if (m_select_limit == 0 || is_impossible_where) {
     return false;
   }
 
@@ -1558,11 +1725,12 @@ bool INLINE_ATTR select_exec::run_sk_point_query(txn_wrapper *txn) {
       continue;
     }
 
-    if (unpack_for_sk(txn, rkey_slice, m_scan_it->value())) {
+    bool sk_match = true;
+    if (unpack_for_sk(txn, rkey_slice, m_scan_it->value(), &sk_match)) {
       return true;
     }
 
-    int ret = eval_and_send();
+    int ret = eval_and_send(sk_match);
     if (ret > 0) {
       return true;
     } else if (ret < 0) {
@@ -1575,14 +1743,14 @@ bool INLINE_ATTR select_exec::run_sk_point_query(txn_wrapper *txn) {
 }
 
 /*
-  Evaluate the condition using item->val_int, assuming item pointing
-  to record[0] and is already unpacked.
+  Evaluate the first filter_count filters using item->val_int, assuming item
+  pointing to record[0] and is already unpacked.
   This is the slow path as we need to unpack into record[0]
  */
-bool INLINE_ATTR select_exec::eval_cond() {
-  if (unlikely(m_filter_count > 0)) {
+bool INLINE_ATTR select_exec::eval_cond(uint filter_count) {
+  if (unlikely(filter_count > 0)) {
     auto where_list = m_parser.get_cond_list();
-    for (uint i = 0; i < m_filter_count; ++i) {
+    for (uint i = 0; i < filter_count; ++i) {
       // Let MySQL evaluate the conditional expression with item pointing to
       // the field record. At least this is better than MySQL where index_key=A
       // are always evaluated even though it is not necessary
@@ -1606,15 +1774,22 @@ bool INLINE_ATTR select_exec::unpack_for_pk(const rocksdb::Slice &rkey,
   return false;
 }
 
+/*
+  Unpack the row found in the secondary index into record[0].
+  sk_match is set to false if the row is already rejected by filters on
+  secondary index columns, in which case the row is not fully unpacked.
+ */
 bool INLINE_ATTR select_exec::unpack_for_sk(txn_wrapper *txn,
                                             const rocksdb::Slice &rkey,
-                                            const rocksdb::Slice &rvalue) {
+                                            const rocksdb::Slice &rvalue,
+                                            bool *sk_match) {
   bool covers_lookup =
       m_keyread_only || m_key_def->covers_lookup(&rvalue, &m_lookup_bitmap);
 
   // SECONDARY KEY - there are a few cases to take care of:
   // 1. Secondary index covers the entire look up
-  // 2. Unpack everything using PK index + value
+  // 2. Filters on secondary index columns reject the row
+  // 3. Unpack everything using PK index + value
   int rc = 0;
   if (covers_lookup) {
     // SK covers the entire lookup
@@ -1630,6 +1805,23 @@ bool INLINE_ATTR select_exec::unpack_for_sk(txn_wrapper *txn,
     return false;
   }
 
+  if (m_sk_filter_count > 0) {
+    // Only the columns in the SK are unpacked here, which is all these
+    // filters need
+    rc =
+        m_key_def->unpack_record(m_table, m_table->record[0], &rkey, &rvalue,
+                                 m_converter->get_verify_row_debug_checksums());
+    if (rc) {
+      m_handler->print_error(rc, 0);
+      return true;
+    }
+
+    if (!eval_cond(m_sk_filter_count)) {
+      *sk_match = false;
+      return false;
+    }
+  }
+
   // Unpack PK index + value
   uint pk_tuple_size = 0;
   pk_tuple_size = m_key_def->get_primary_key_tuple(m_table, *m_pk_def, &rkey,
@@ -1658,9 +1850,15 @@ bool INLINE_ATTR select_exec::unpack_for_sk(txn_wrapper *txn,
   return false;
 }
 
-int INLINE_ATTR select_exec::eval_and_send() {
+int INLINE_ATTR select_exec::eval_and_send(bool sk_match) {
+  if (!sk_match) {
+    // Rejected by filters on SK columns before the PK lookup. Just like index
+    // condition pushdown in the handler these are not counted as read
+    return 0;
+  }
+
   m_examined_rows++;
-  if (eval_cond()) {
+  if (eval_cond(m_filter_count)) {
     m_row_count++;
     if (m_row_count > m_offset_limit) {
       if (m_debug_row_delay > 0) {
@@ -1840,17 +2038,18 @@ bool INLINE_ATTR select_exec::run_range_query(txn_wrapper *txn) {
       // skipping the first N items in LIMIT, but this is low priority
       // for now
       const rocksdb::Slice rvalue = m_scan_it->value();
+      bool sk_match = true;
       if (m_index_is_pk) {
         if (unlikely(unpack_for_pk(rkey, rvalue))) {
           return true;
         }
       } else {
-        if (unlikely(unpack_for_sk(txn, rkey, rvalue))) {
+        if (unlikely(unpack_for_sk(txn, rkey, rvalue, &sk_match))) {
           return true;
         }
       }
 
-      int ret = eval_and_send();
+      int ret = eval_and_send(sk_match);
       if (unlikely(ret > 0)) {
         // failure
         return true;
@@ -126,6 +126,22 @@ const char *const INDEX_STATS_THREAD_NAME = "myrocks-is";
 */
 const char *const MANUAL_COMPACTION_THREAD_NAME = "myrocks-mc";
 
+/*
+  Name for the threads that run pipelined MRR MultiGet calls.
+*/
+const char *const MRR_FETCH_THREAD_NAME = "myrocks-mrr";
+
+/*
+  Name for the threads that sort and merge a key range of a secondary index
+  during parallel inplace index creation.
+*/
+const char *const INDEX_MERGE_THREAD_NAME = "myrocks-merge";
+
+/*
+  Name for the threads that build the SST files of bulk loads.
+*/
+const char *const SST_WRITER_THREAD_NAME = "myrocks-sst";
+
 /*
   Separator between partition name and the qualifier. Sample usage:
 
@@ -35,20 +35,27 @@ my_core::PSI_stage_info stage_waiting_on_row_lock = {0, "Waiting for row lock",
 my_core::PSI_stage_info *all_rocksdb_stages[] = {&stage_waiting_on_row_lock};
 
 my_core::PSI_thread_key rdb_background_psi_thread_key,
-    rdb_drop_idx_psi_thread_key, rdb_is_psi_thread_key, rdb_mc_psi_thread_key;
+    rdb_drop_idx_psi_thread_key, rdb_is_psi_thread_key, rdb_mc_psi_thread_key,
+    rdb_mrr_fetch_psi_thread_key, rdb_index_merge_psi_thread_key,
+    rdb_sst_writer_psi_thread_key;
 
 my_core::PSI_thread_info all_rocksdb_threads[] = {
     {&rdb_background_psi_thread_key, "background", PSI_FLAG_GLOBAL},
     {&rdb_drop_idx_psi_thread_key, "drop index", PSI_FLAG_GLOBAL},
     {&rdb_is_psi_thread_key, "index stats calculation", PSI_FLAG_GLOBAL},
     {&rdb_mc_psi_thread_key, "manual compaction", PSI_FLAG_GLOBAL},
+    {&rdb_mrr_fetch_psi_thread_key, "mrr fetch", PSI_FLAG_GLOBAL},
+    {&rdb_index_merge_psi_thread_key, "index merge", PSI_FLAG_GLOBAL},
+    {&rdb_sst_writer_psi_thread_key, "sst writer", PSI_FLAG_GLOBAL},
 };
 
 my_core::PSI_mutex_key rdb_psi_open_tbls_mutex_key, rdb_signal_bg_psi_mutex_key,
     rdb_signal_drop_idx_psi_mutex_key, rdb_signal_is_psi_mutex_key,
-    rdb_signal_mc_psi_mutex_key, rdb_collation_data_mutex_key,
-    rdb_mem_cmp_space_mutex_key, key_mutex_tx_list, rdb_sysvars_psi_mutex_key,
-    rdb_cfm_mutex_key, rdb_sst_commit_key, rdb_block_cache_resize_mutex_key,
+    rdb_signal_mc_psi_mutex_key, rdb_signal_mrr_fetch_psi_mutex_key,
+    rdb_signal_index_merge_psi_mutex_key, rdb_signal_sst_writer_psi_mutex_key,
+    rdb_collation_data_mutex_key, rdb_mem_cmp_space_mutex_key,
+    key_mutex_tx_list, rdb_sysvars_psi_mutex_key, rdb_cfm_mutex_key,
+    rdb_sst_commit_key, rdb_block_cache_resize_mutex_key,
     rdb_bottom_pri_background_compactions_resize_mutex_key;
 
 my_core::PSI_mutex_info all_rocksdb_mutexes[] = {
@@ -58,6 +65,12 @@ my_core::PSI_mutex_info all_rocksdb_mutexes[] = {
     {&rdb_signal_is_psi_mutex_key, "signal index stats calculation",
      PSI_FLAG_GLOBAL},
     {&rdb_signal_mc_psi_mutex_key, "signal manual compaction", PSI_FLAG_GLOBAL},
+    {&rdb_signal_mrr_fetch_psi_mutex_key, "signal mrr fetch",
+     PSI_FLAG_GLOBAL},
+    {&rdb_signal_index_merge_psi_mutex_key, "signal index merge",
+     PSI_FLAG_GLOBAL},
+    {&rdb_signal_sst_writer_psi_mutex_key, "signal sst writer",
+     PSI_FLAG_GLOBAL},
     {&rdb_collation_data_mutex_key, "collation data init", PSI_FLAG_GLOBAL},
     {&rdb_mem_cmp_space_mutex_key, "collation space char data init",
      PSI_FLAG_GLOBAL},
@@ -84,7 +97,8 @@ my_core::PSI_rwlock_info all_rocksdb_rwlocks[] = {
 
 my_core::PSI_cond_key rdb_signal_bg_psi_cond_key,
     rdb_signal_drop_idx_psi_cond_key, rdb_signal_is_psi_cond_key,
-    rdb_signal_mc_psi_cond_key;
+    rdb_signal_mc_psi_cond_key, rdb_signal_mrr_fetch_psi_cond_key,
+    rdb_signal_index_merge_psi_cond_key, rdb_signal_sst_writer_psi_cond_key;
 
 my_core::PSI_cond_info all_rocksdb_conds[] = {
     {&rdb_signal_bg_psi_cond_key, "cond signal background", PSI_FLAG_GLOBAL},
@@ -94,6 +108,12 @@ my_core::PSI_cond_info all_rocksdb_conds[] = {
      PSI_FLAG_GLOBAL},
     {&rdb_signal_mc_psi_cond_key, "cond signal manual compaction",
      PSI_FLAG_GLOBAL},
+    {&rdb_signal_mrr_fetch_psi_cond_key, "cond signal mrr fetch",
+     PSI_FLAG_GLOBAL},
+    {&rdb_signal_index_merge_psi_cond_key, "cond signal index merge",
+     PSI_FLAG_GLOBAL},
+    {&rdb_signal_sst_writer_psi_cond_key, "cond signal sst writer",
+     PSI_FLAG_GLOBAL},
 };
 
 void init_rocksdb_psi_keys() {
@@ -36,13 +36,17 @@ extern my_core::PSI_stage_info stage_waiting_on_row_lock;
 
 #ifdef HAVE_PSI_INTERFACE
 extern my_core::PSI_thread_key rdb_background_psi_thread_key,
-    rdb_drop_idx_psi_thread_key, rdb_is_psi_thread_key, rdb_mc_psi_thread_key;
+    rdb_drop_idx_psi_thread_key, rdb_is_psi_thread_key, rdb_mc_psi_thread_key,
+    rdb_mrr_fetch_psi_thread_key, rdb_index_merge_psi_thread_key,
+    rdb_sst_writer_psi_thread_key;
 
 extern my_core::PSI_mutex_key rdb_psi_open_tbls_mutex_key,
     rdb_signal_bg_psi_mutex_key, rdb_signal_drop_idx_psi_mutex_key,
     rdb_signal_is_psi_mutex_key, rdb_signal_mc_psi_mutex_key,
-    rdb_collation_data_mutex_key, rdb_mem_cmp_space_mutex_key,
-    key_mutex_tx_list, rdb_sysvars_psi_mutex_key, rdb_cfm_mutex_key,
+    rdb_signal_mrr_fetch_psi_mutex_key, rdb_signal_index_merge_psi_mutex_key,
+    rdb_signal_sst_writer_psi_mutex_key, rdb_collation_data_mutex_key,
+    rdb_mem_cmp_space_mutex_key, key_mutex_tx_list, rdb_sysvars_psi_mutex_key,
+    rdb_cfm_mutex_key,
     rdb_sst_commit_key, rdb_block_cache_resize_mutex_key,
     rdb_bottom_pri_background_compactions_resize_mutex_key;
 
@@ -51,7 +55,8 @@ extern my_core::PSI_rwlock_key key_rwlock_collation_exception_list,
 
 extern my_core::PSI_cond_key rdb_signal_bg_psi_cond_key,
     rdb_signal_drop_idx_psi_cond_key, rdb_signal_is_psi_cond_key,
-    rdb_signal_mc_psi_cond_key;
+    rdb_signal_mc_psi_cond_key, rdb_signal_mrr_fetch_psi_cond_key,
+    rdb_signal_index_merge_psi_cond_key, rdb_signal_sst_writer_psi_cond_key;
 #endif  // HAVE_PSI_INTERFACE
 
 void init_rocksdb_psi_keys();
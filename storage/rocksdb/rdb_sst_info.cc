@@ -19,6 +19,7 @@
 
 /* C++ standard header files */
 #include <cstdio>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -312,7 +313,8 @@ Rdb_sst_info::Rdb_sst_info(rocksdb::DB *const db, const std::string &tablename,
       m_done(false),
       m_sst_file(nullptr),
       m_tracing(tracing),
-      m_print_client_error(true) {
+      m_print_client_error(true),
+      m_pipelined(!m_writer_threads.empty()) {
   m_prefix = db->GetName() + "/";
 
   std::string normalized_table;
@@ -339,6 +341,12 @@ Rdb_sst_info::Rdb_sst_info(rocksdb::DB *const db, const std::string &tablename,
   } else {
     // Set the maximum size to 3 times the cf's target size
     m_max_size = cf_descr.options.target_file_size_base * 3;
+
+    // The keys of every file in flight are buffered in memory, keep them
+    // to the cf's target size
+    if (m_pipelined) {
+      m_max_size = cf_descr.options.target_file_size_base;
+    }
   }
   mysql_mutex_init(rdb_sst_commit_key, &m_commit_mutex, MY_MUTEX_INIT_FAST);
 }
@@ -346,6 +354,12 @@ Rdb_sst_info::Rdb_sst_info(rocksdb::DB *const db, const std::string &tablename,
 Rdb_sst_info::~Rdb_sst_info() {
   DBUG_ASSERT(m_sst_file == nullptr);
 
+  // Writer threads may still be using the buffers of an aborted load
+  for (const auto &write : m_writes) {
+    write->m_done.wait();
+  }
+  m_writes.clear();
+
   for (const auto &sst_file : m_committed_files) {
     // In case something went wrong attempt to delete the temporary file.
     // If everything went fine that file will have been renamed and this
@@ -363,6 +377,13 @@ int Rdb_sst_info::open_new_sst_file() {
   // Create the new sst file's name
   const std::string name = m_prefix + std::to_string(m_sst_count++) + m_suffix;
 
+  if (m_pipelined) {
+    // The file is created by the writer thread once it is full
+    m_curr_name = name;
+    m_curr_size = 0;
+    return HA_EXIT_SUCCESS;
+  }
+
   // Create the new sst file object
   m_sst_file = new Rdb_sst_file_ordered(m_db, m_cf, m_db_options, name,
                                         m_tracing, m_max_size);
@@ -394,9 +415,15 @@ void Rdb_sst_info::commit_sst_file(Rdb_sst_file_ordered *sst_file) {
 }
 
 void Rdb_sst_info::close_curr_sst_file() {
-  DBUG_ASSERT(m_sst_file != nullptr);
   DBUG_ASSERT(m_curr_size > 0);
 
+  if (m_pipelined) {
+    write_sst_file_async();
+    m_curr_size = 0;
+    return;
+  }
+
+  DBUG_ASSERT(m_sst_file != nullptr);
   commit_sst_file(m_sst_file);
 
   // Reset for next sst file
@@ -404,6 +431,90 @@ void Rdb_sst_info::close_curr_sst_file() {
   m_curr_size = 0;
 }
 
+static void rdb_sst_buffer_store(std::string *const buffer,
+                                 const rocksdb::Slice &slice) {
+  const uint64 len = slice.size();
+  buffer->append(reinterpret_cast<const char *>(&len), sizeof(len));
+  buffer->append(slice.data(), slice.size());
+}
+
+static rocksdb::Slice rdb_sst_buffer_read(const char **const ptr) {
+  uint64 len;
+  memcpy(&len, *ptr, sizeof(len));
+  const rocksdb::Slice slice(*ptr + sizeof(len), len);
+  *ptr += sizeof(len) + len;
+  return slice;
+}
+
+/*
+  Hand the keys buffered for the current SST file to a writer thread. Waits
+  for the oldest file in flight first if this load already has one per
+  writer thread queued or running, which bounds the memory used by a load.
+*/
+void Rdb_sst_info::write_sst_file_async() {
+  DBUG_ASSERT(m_pipelined);
+
+  if (m_writes.size() > m_writer_threads.size()) {
+    wait_for_oldest_write();
+  }
+
+  std::unique_ptr<Rdb_sst_write> write(new Rdb_sst_write());
+  write->m_name = m_curr_name;
+
+  Rdb_sst_write *const w = write.get();
+  const auto buffer = std::make_shared<std::string>();
+  buffer->swap(m_buffer);
+
+  const uint n = m_next_writer++ % m_writer_threads.size();
+  w->m_done = m_writer_threads[n]->submit([this, w, buffer]() {
+    w->m_status = write_sst_file(w->m_name, *buffer);
+  });
+
+  // As in commit_sst_file(), the file is listed even if it fails so that it
+  // gets removed
+  m_committed_files.push_back(m_curr_name);
+  m_writes.push_back(std::move(write));
+}
+
+// This function is run by a writer thread
+rocksdb::Status Rdb_sst_info::write_sst_file(const std::string &name,
+                                             const std::string &buffer) const {
+  Rdb_sst_file_ordered sst_file(m_db, m_cf, m_db_options, name, m_tracing,
+                                m_max_size);
+
+  rocksdb::Status s = sst_file.open();
+  if (!s.ok()) {
+    return s;
+  }
+
+  const char *ptr = buffer.data();
+  const char *const end = ptr + buffer.size();
+  while (ptr < end) {
+    const rocksdb::Slice key = rdb_sst_buffer_read(&ptr);
+    const rocksdb::Slice value = rdb_sst_buffer_read(&ptr);
+
+    s = sst_file.put(key, value);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  return sst_file.commit();
+}
+
+void Rdb_sst_info::wait_for_oldest_write() {
+  DBUG_ASSERT(!m_writes.empty());
+
+  const std::unique_ptr<Rdb_sst_write> write = std::move(m_writes.front());
+  m_writes.pop_front();
+
+  write->m_done.get();
+  if (!write->m_status.ok()) {
+    set_error_msg(write->m_name, write->m_status);
+    set_background_error(HA_ERR_ROCKSDB_BULK_LOAD);
+  }
+}
+
 int Rdb_sst_info::put(const rocksdb::Slice &key, const rocksdb::Slice &value) {
   int rc;
 
@@ -428,6 +539,13 @@ int Rdb_sst_info::put(const rocksdb::Slice &key, const rocksdb::Slice &value) {
     }
   }
 
+  if (m_pipelined) {
+    rdb_sst_buffer_store(&m_buffer, key);
+    rdb_sst_buffer_store(&m_buffer, value);
+    m_curr_size += key.size() + value.size();
+    return HA_EXIT_SUCCESS;
+  }
+
   DBUG_ASSERT(m_sst_file != nullptr);
 
   // Add the key/value to the current sst file
@@ -469,6 +587,10 @@ int Rdb_sst_info::finish(Rdb_sst_commit_info *commit_info,
     close_curr_sst_file();
   }
 
+  while (!m_writes.empty()) {
+    wait_for_oldest_write();
+  }
+
   // This checks out the list of files so that the caller can collect/group
   // them and ingest them all in one go, and any racing calls to commit
   // won't see them at all
@@ -546,4 +668,42 @@ void Rdb_sst_info::init(const rocksdb::DB *const db) {
 
 std::atomic<uint64_t> Rdb_sst_info::m_prefix_counter(0);
 std::string Rdb_sst_info::m_suffix = ".bulk_load.tmp";
+std::vector<std::unique_ptr<Rdb_task_thread>> Rdb_sst_info::m_writer_threads;
+std::atomic<uint> Rdb_sst_info::m_next_writer(0);
+
+/*
+  Start the threads that build and compress the SST files of bulk loads.
+  Only bulk loads that start afterwards use them.
+*/
+int Rdb_sst_info::start_writer_threads(const uint n_threads) {
+  for (uint i = 0; i < n_threads; i++) {
+    std::unique_ptr<Rdb_task_thread> thread(new Rdb_task_thread());
+#ifdef HAVE_PSI_INTERFACE
+    thread->init(rdb_signal_sst_writer_psi_mutex_key,
+                 rdb_signal_sst_writer_psi_cond_key);
+    const int err = thread->create_thread(SST_WRITER_THREAD_NAME,
+                                          rdb_sst_writer_psi_thread_key);
+#else
+    thread->init();
+    const int err = thread->create_thread(SST_WRITER_THREAD_NAME);
+#endif
+    if (err != 0) {
+      thread->uninit();
+      return err;
+    }
+    m_writer_threads.push_back(std::move(thread));
+  }
+
+  return HA_EXIT_SUCCESS;
+}
+
+void Rdb_sst_info::stop_writer_threads() {
+  for (const auto &thread : m_writer_threads) {
+    thread->signal(true);
+  }
+  for (const auto &thread : m_writer_threads) {
+    thread->join();
+  }
+  m_writer_threads.clear();
+}
 }  // namespace myrocks
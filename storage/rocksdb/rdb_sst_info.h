@@ -19,6 +19,9 @@
 /* C++ standard header files */
 #include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <stack>
@@ -32,6 +35,7 @@
 #include "rocksdb/sst_file_writer.h"
 
 /* MyRocks header files */
+#include "./rdb_threads.h"
 #include "./rdb_utils.h"
 
 namespace myrocks {
@@ -136,10 +140,34 @@ class Rdb_sst_info {
   const bool m_tracing;
   bool m_print_client_error;
 
+  /*
+    With writer threads (see start_writer_threads()) put() only buffers the
+    keys of the current SST file in m_buffer. Full files are built and
+    compressed by a writer thread while the next one is being filled.
+  */
+  struct Rdb_sst_write {
+    std::string m_name;
+    rocksdb::Status m_status;
+    std::future<void> m_done;
+  };
+
+  const bool m_pipelined;
+  std::string m_curr_name;
+  std::string m_buffer;
+  std::deque<std::unique_ptr<Rdb_sst_write>> m_writes;
+
+  static std::vector<std::unique_ptr<Rdb_task_thread>> m_writer_threads;
+  static std::atomic<uint> m_next_writer;
+
   int open_new_sst_file();
   void close_curr_sst_file();
   void commit_sst_file(Rdb_sst_file_ordered *sst_file);
 
+  void write_sst_file_async();
+  rocksdb::Status write_sst_file(const std::string &name,
+                                 const std::string &buffer) const;
+  void wait_for_oldest_write();
+
   void set_error_msg(const std::string &sst_file_name,
                      const rocksdb::Status &s);
 
@@ -258,6 +286,9 @@ class Rdb_sst_info {
 
   static void init(const rocksdb::DB *const db);
 
+  static int start_writer_threads(const uint n_threads);
+  static void stop_writer_threads();
+
   static void report_error_msg(const rocksdb::Status &s,
                                const char *sst_file_name);
 };
@@ -83,4 +83,38 @@ void Rdb_thread::signal(const bool stop_thread) {
   RDB_MUTEX_UNLOCK_CHECK(m_signal_mutex);
 }
 
+std::future<void> Rdb_task_thread::submit(std::function<void()> &&task) {
+  std::packaged_task<void()> request(std::move(task));
+  std::future<void> result = request.get_future();
+
+  RDB_MUTEX_LOCK_CHECK(m_signal_mutex);
+  m_requests.push_back(std::move(request));
+  mysql_cond_signal(&m_signal_cond);
+  RDB_MUTEX_UNLOCK_CHECK(m_signal_mutex);
+
+  return result;
+}
+
+void Rdb_task_thread::run() {
+  RDB_MUTEX_LOCK_CHECK(m_signal_mutex);
+  for (;;) {
+    while (m_requests.empty() && !m_killed) {
+      mysql_cond_wait(&m_signal_cond, &m_signal_mutex);
+    }
+
+    // Run whatever is still queued before stopping, somebody waits for it
+    if (m_requests.empty()) {
+      break;
+    }
+
+    std::packaged_task<void()> task = std::move(m_requests.front());
+    m_requests.pop_front();
+
+    RDB_MUTEX_UNLOCK_CHECK(m_signal_mutex);
+    task();
+    RDB_MUTEX_LOCK_CHECK(m_signal_mutex);
+  }
+  RDB_MUTEX_UNLOCK_CHECK(m_signal_mutex);
+}
+
 }  // namespace myrocks
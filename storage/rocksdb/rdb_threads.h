@@ -18,6 +18,8 @@
 
 /* C++ standard header files */
 #include <deque>
+#include <functional>
+#include <future>
 #include <map>
 #include <string>
 #include <utility>
@@ -217,4 +219,27 @@ struct Rdb_drop_index_thread : public Rdb_thread {
   virtual void run() override;
 };
 
+/*
+  Runs queued tasks one at a time, in submission order. Used for the MultiGet
+  calls of pipelined Multi-Range-Read scans, so that the next batch of primary
+  key lookups is in flight while the rows of the current batch are being
+  returned to the SQL layer, and for the per key range sort/merge workers of
+  parallel inplace index creation.
+*/
+
+class Rdb_task_thread : public Rdb_thread {
+ private:
+  // Protected by m_signal_mutex
+  std::deque<std::packaged_task<void()>> m_requests;
+
+ public:
+  virtual void run() override;
+
+  /*
+    Queue a task. The returned future becomes ready once it has run; the
+    caller must wait for it before touching any buffer the task writes to.
+  */
+  std::future<void> submit(std::function<void()> &&task);
+};
+
 }  // namespace myrocks
@@ -0,0 +1,204 @@
+/* Copyright (c) 2016, Facebook, Inc. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "test_utils.h"
+#include "bench_utils.h"
+#include "sql_base.h"
+#include "sql_class.h"
+
+/*
+  Tests of the registry of active statements used to cap duplicate
+  executions (sql_maximum_duplicate_executions), and a benchmark of the
+  register/remove cost with 1 to 128 concurrent sessions, all running
+  the same statement or each running its own.
+*/
+
+namespace active_sql_unittest {
+
+using my_testing::Server_initializer;
+using my_testing::Bench_op;
+using my_testing::bench_report;
+using my_testing::bench_thread_counts;
+using my_testing::run_threads;
+
+const ulonglong total_ops= 1 << 18;
+
+static void prepare_select(THD *thd)
+{
+  lex_start(thd);
+  thd->lex->sql_command= SQLCOM_SELECT;
+}
+
+
+/* Registers and removes one statement, on a session of its own. */
+class Register_op : public Bench_op
+{
+public:
+  explicit Register_op(const std::string &query)
+    : m_query(query), m_thd(NULL), m_failures(0)
+  {}
+
+  void thread_begin()
+  {
+    THD *thd= new THD(false);
+    thd->thread_stack= (char*) &thd;
+    thd->store_globals();
+    prepare_select(thd);
+    m_thd= thd;
+  }
+
+  void thread_end()
+  {
+    delete m_thd;
+  }
+
+  void operator()(ulonglong)
+  {
+    if (register_active_sql(m_thd, const_cast<char*>(m_query.c_str()),
+                            m_query.length()) ||
+        !m_thd->mt_key_is_set(THD::SQL_HASH))
+      m_failures++;
+    remove_active_sql(m_thd);
+    free_root(m_thd->mem_root, MYF(MY_KEEP_PREALLOC));
+  }
+
+  ulonglong failures() { return m_failures; }
+
+private:
+  std::string m_query;
+  THD *m_thd;
+  ulonglong m_failures;
+};
+
+
+class ActiveSqlTest : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    initializer.SetUp();
+    init_global_active_sql();
+    saved_max= sql_maximum_duplicate_executions;
+    saved_control= sql_duplicate_executions_control;
+    sql_duplicate_executions_control= CONTROL_LEVEL_ERROR;
+  }
+
+  virtual void TearDown()
+  {
+    sql_maximum_duplicate_executions= saved_max;
+    sql_duplicate_executions_control= saved_control;
+    release_active_sql_pins(thd());
+    free_global_active_sql();
+    initializer.TearDown();
+  }
+
+  THD *thd() { return initializer.thd(); }
+
+  /*
+    Run total register/remove pairs on nthreads sessions, and return the
+    elapsed microseconds.
+  */
+  ulonglong run_sessions(uint nthreads, bool same_query, ulonglong total)
+  {
+    std::vector<Register_op*> ops;
+    for (uint i= 0; i < nthreads; i++)
+      ops.push_back(new Register_op("select * from t1 where a = " +
+                                    std::to_string(same_query ? 0 : i)));
+
+    const ulonglong usecs= run_threads(ops, total);
+
+    ulonglong failures= 0;
+    for (uint i= 0; i < nthreads; i++)
+    {
+      failures+= ops[i]->failures();
+      delete ops[i];
+    }
+    EXPECT_EQ(0U, failures);
+    return usecs;
+  }
+
+  Server_initializer initializer;
+  uint saved_max;
+  ulong saved_control;
+};
+
+
+TEST_F(ActiveSqlTest, CapDuplicates)
+{
+  char query[]= "select /* first */ 1";
+  char same_query[]= "select /* second */ 1";
+  char other_query[]= "select '/*' 1";
+  THD *second= new THD(false);
+  second->thread_stack= (char*) &second;
+  second->store_globals();
+  prepare_select(second);
+  thd()->store_globals();
+  prepare_select(thd());
+
+  sql_maximum_duplicate_executions= 1;
+  EXPECT_FALSE(register_active_sql(thd(), query, strlen(query)));
+  EXPECT_TRUE(thd()->mt_key_is_set(THD::SQL_HASH));
+
+  // Comments do not make statements different
+  initializer.set_expected_error(ER_DUPLICATE_STATEMENT_EXECUTION);
+  EXPECT_TRUE(register_active_sql(second, same_query, strlen(same_query)));
+  EXPECT_FALSE(second->mt_key_is_set(THD::SQL_HASH));
+  initializer.set_expected_error(0);
+  second->clear_error();
+
+  // Comment starts inside strings are not comments
+  EXPECT_FALSE(register_active_sql(second, other_query,
+                                   strlen(other_query)));
+  remove_active_sql(second);
+  EXPECT_FALSE(second->mt_key_is_set(THD::SQL_HASH));
+
+  // Once the first execution is done the next one is accepted
+  remove_active_sql(thd());
+  EXPECT_FALSE(register_active_sql(second, same_query, strlen(same_query)));
+  remove_active_sql(second);
+
+  delete second;
+  thd()->store_globals();
+}
+
+
+TEST_F(ActiveSqlTest, ConcurrentRegister)
+{
+  sql_maximum_duplicate_executions= UINT_MAX;
+  run_sessions(4, true, 1 << 12);
+  run_sessions(4, false, 1 << 12);
+}
+
+
+TEST_F(ActiveSqlTest, DISABLED_RegisterBench)
+{
+  sql_maximum_duplicate_executions= UINT_MAX;
+  for (uint i= 0; i < array_elements(bench_thread_counts); i++)
+  {
+    const uint nthreads= bench_thread_counts[i];
+    bench_report("same", nthreads, total_ops,
+                 run_sessions(nthreads, true, total_ops));
+    bench_report("distinct", nthreads, total_ops,
+                 run_sessions(nthreads, false, total_ops));
+  }
+}
+
+}  // namespace active_sql_unittest
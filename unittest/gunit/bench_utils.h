@@ -0,0 +1,119 @@
+/* Copyright (c) 2016, Facebook, Inc. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+#ifndef BENCH_UTILS_INCLUDED
+#define BENCH_UTILS_INCLUDED
+
+#include <stdio.h>
+#include <vector>
+
+#include "my_sys.h"
+#include "thread_utils.h"
+
+/*
+  Harness for the multi-threaded throughput benchmarks of the unit
+  tests. Benchmarks are named DISABLED_* so that they only run with
+  --gtest_also_run_disabled_tests, and report as TAP comments.
+*/
+
+namespace my_testing {
+
+/* Thread counts every benchmark is run with. */
+static const uint bench_thread_counts[]= { 1, 16, 64, 128 };
+
+/**
+  Base of benchmark operations. An operation is called as (*op)(i) for
+  every iteration i of a thread; thread_begin() and thread_end() run on
+  the same thread around the timed loop, for per thread set up.
+*/
+class Bench_op
+{
+public:
+  void thread_begin() {}
+  void thread_end() {}
+};
+
+
+template <typename Op>
+class Bench_thread : public thread::Thread
+{
+public:
+  Bench_thread(thread::Notification *go, Op *op, ulonglong ops)
+    : m_go(go), m_op(op), m_ops(ops)
+  {}
+
+  virtual void run()
+  {
+    m_op->thread_begin();
+    m_go->wait_for_notification();
+    for (ulonglong i= 0; i < m_ops; i++)
+      (*m_op)(i);
+    m_op->thread_end();
+  }
+
+private:
+  thread::Notification *m_go;
+  Op *m_op;
+  ulonglong m_ops;
+};
+
+
+/**
+  Run total_ops iterations split over one thread per element of ops,
+  all released at once, and return the elapsed microseconds.
+*/
+template <typename Op>
+ulonglong run_threads(const std::vector<Op*> &ops, ulonglong total_ops)
+{
+  thread::Notification go;
+  std::vector<Bench_thread<Op>*> threads;
+
+  for (size_t i= 0; i < ops.size(); i++)
+  {
+    threads.push_back(new Bench_thread<Op>(&go, ops[i],
+                                           total_ops / ops.size()));
+    threads.back()->start();
+  }
+
+  ulonglong start= my_micro_time();
+  go.notify();
+  for (size_t i= 0; i < threads.size(); i++)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+  return my_micro_time() - start;
+}
+
+
+/** Run total_ops iterations of op shared by nthreads threads. */
+template <typename Op>
+ulonglong run_threads(Op *op, uint nthreads, ulonglong total_ops)
+{
+  return run_threads(std::vector<Op*>(nthreads, op), total_ops);
+}
+
+
+/** Print the throughput of a benchmark run. */
+inline void bench_report(const char *name, uint nthreads,
+                         ulonglong total_ops, ulonglong usecs)
+{
+  printf("# %-16s %3u threads: %10.0f ops/ms\n", name, nthreads,
+         usecs ? total_ops * 1000.0 / usecs : 0.0);
+}
+
+}  // namespace my_testing
+
+#endif  // BENCH_UTILS_INCLUDED
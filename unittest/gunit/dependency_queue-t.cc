@@ -0,0 +1,510 @@
+/* Copyright (c) 2016, Facebook, Inc. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "my_sys.h"
+#include "thread_utils.h"
+#include "dependency_queue.h"
+
+/*
+  Tests of the ring and the key map that dependency replication uses to
+  hand transactions to its workers, and an apply benchmark which only
+  runs with --gtest_also_run_disabled_tests.
+
+  The benchmark replays a stream of transactions the way the coordinator
+  and the Dependency_slave_worker threads use these structures: the
+  coordinator looks up the last writer of each key of a transaction,
+  publishes the transaction as the new last writer and queues it, and 8
+  to 64 workers take transactions off the queue and retract their keys.
+  It runs once with a std::deque and an std::unordered_map under one
+  mutex each, as before, and once with Dependency_queue and
+  Dependency_key_map. It prints the transactions per second and the time
+  threads spent blocked on locks and conditions per transaction.
+*/
+
+namespace dependency_queue_unittest {
+
+using thread::Notification;
+using thread::Thread;
+
+const ulonglong total_trxs= 1 << 17;
+const uint keys_per_trx= 4;
+/* Keys are drawn from hot_keys keys for one in hot_interval keys */
+const ulonglong hot_keys= 1024;
+const ulonglong hot_interval= 4;
+const ulonglong queue_size= 1000;
+
+struct Bench_trx
+{
+  ulonglong id;
+  ulonglong keys[keys_per_trx];
+};
+
+/** Build the transaction stream, the same for every run. */
+static void make_stream(std::vector<Bench_trx> *stream)
+{
+  ulonglong seed= 17;
+  stream->resize(total_trxs);
+  for (ulonglong i= 0; i < total_trxs; i++)
+  {
+    (*stream)[i].id= i + 1;
+    for (uint k= 0; k < keys_per_trx; k++)
+    {
+      seed= seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      const ulonglong r= seed >> 33;
+      (*stream)[i].keys[k]= r % hot_interval ? r : r % hot_keys;
+    }
+  }
+}
+
+/** Lock mutex, add the time it was blocked to wait_usecs. */
+static void timed_lock(mysql_mutex_t *mutex, ulonglong *wait_usecs)
+{
+  if (mysql_mutex_trylock(mutex))
+  {
+    const ulonglong start= my_micro_time();
+    mysql_mutex_lock(mutex);
+    *wait_usecs+= my_micro_time() - start;
+  }
+}
+
+static void timed_wait(mysql_cond_t *cond, mysql_mutex_t *mutex,
+                       ulonglong *wait_usecs)
+{
+  const ulonglong start= my_micro_time();
+  struct timespec abstime;
+  set_timespec_nsec(abstime, 1000000ULL);
+  mysql_cond_timedwait(cond, mutex, &abstime);
+  *wait_usecs+= my_micro_time() - start;
+}
+
+
+/** Queue and key lookup under one mutex each. */
+class Locked_state
+{
+public:
+  Locked_state() : m_done(false)
+  {
+    mysql_mutex_init(0, &m_queue_lock, MY_MUTEX_INIT_FAST);
+    mysql_mutex_init(0, &m_lookup_lock, MY_MUTEX_INIT_FAST);
+    mysql_cond_init(0, &m_empty_cond, NULL);
+    mysql_cond_init(0, &m_full_cond, NULL);
+  }
+
+  ~Locked_state()
+  {
+    mysql_mutex_destroy(&m_queue_lock);
+    mysql_mutex_destroy(&m_lookup_lock);
+    mysql_cond_destroy(&m_empty_cond);
+    mysql_cond_destroy(&m_full_cond);
+  }
+
+  uint schedule(const Bench_trx *trx, ulonglong *wait_usecs)
+  {
+    uint deps= 0;
+    timed_lock(&m_lookup_lock, wait_usecs);
+    for (uint k= 0; k < keys_per_trx; k++)
+    {
+      ulonglong &last= m_lookup[trx->keys[k]];
+      deps+= last != 0;
+      last= trx->id;
+    }
+    mysql_mutex_unlock(&m_lookup_lock);
+
+    timed_lock(&m_queue_lock, wait_usecs);
+    while (m_queue.size() >= queue_size)
+      timed_wait(&m_full_cond, &m_queue_lock, wait_usecs);
+    m_queue.push_back(trx);
+    mysql_cond_signal(&m_empty_cond);
+    mysql_mutex_unlock(&m_queue_lock);
+    return deps;
+  }
+
+  const Bench_trx *next(ulonglong *wait_usecs)
+  {
+    const Bench_trx *trx= NULL;
+    timed_lock(&m_queue_lock, wait_usecs);
+    while (m_queue.empty() && !m_done)
+      timed_wait(&m_empty_cond, &m_queue_lock, wait_usecs);
+    if (!m_queue.empty())
+    {
+      trx= m_queue.front();
+      m_queue.pop_front();
+      if (m_queue.size() < queue_size * 60 / 100)
+        mysql_cond_signal(&m_full_cond);
+    }
+    mysql_mutex_unlock(&m_queue_lock);
+    return trx;
+  }
+
+  void finalize(const Bench_trx *trx, ulonglong *wait_usecs)
+  {
+    timed_lock(&m_lookup_lock, wait_usecs);
+    for (uint k= 0; k < keys_per_trx; k++)
+    {
+      const auto it= m_lookup.find(trx->keys[k]);
+      if (it != m_lookup.end() && it->second == trx->id)
+        m_lookup.erase(it);
+    }
+    mysql_mutex_unlock(&m_lookup_lock);
+  }
+
+  void done()
+  {
+    mysql_mutex_lock(&m_queue_lock);
+    m_done= true;
+    mysql_cond_broadcast(&m_empty_cond);
+    mysql_mutex_unlock(&m_queue_lock);
+  }
+
+private:
+  std::deque<const Bench_trx*> m_queue;
+  std::unordered_map<ulonglong, ulonglong> m_lookup;
+  mysql_mutex_t m_queue_lock;
+  mysql_mutex_t m_lookup_lock;
+  mysql_cond_t m_empty_cond;
+  mysql_cond_t m_full_cond;
+  bool m_done;
+};
+
+
+/**
+  Dependency_queue and Dependency_key_map, with the same slow paths as
+  Relay_log_info::enqueue_dep() and Dependency_slave_worker.
+*/
+class Lock_free_state
+{
+public:
+  Lock_free_state() : m_waiting(0), m_full(false), m_done(false)
+  {
+    m_queue.init(queue_size);
+    mysql_mutex_init(0, &m_lock, MY_MUTEX_INIT_FAST);
+    mysql_cond_init(0, &m_empty_cond, NULL);
+    mysql_cond_init(0, &m_full_cond, NULL);
+  }
+
+  ~Lock_free_state()
+  {
+    mysql_mutex_destroy(&m_lock);
+    mysql_cond_destroy(&m_empty_cond);
+    mysql_cond_destroy(&m_full_cond);
+  }
+
+  uint schedule(const Bench_trx *trx, ulonglong *wait_usecs)
+  {
+    uint deps= 0;
+    for (uint k= 0; k < keys_per_trx; k++)
+    {
+      ulonglong last;
+      deps+= m_lookup.find(trx->keys[k], &last);
+      m_lookup.set(trx->keys[k], trx->id);
+    }
+
+    if (m_queue.size() >= queue_size)
+    {
+      timed_lock(&m_lock, wait_usecs);
+      m_full= true;
+      while (m_full && m_queue.size() >= queue_size * 60 / 100)
+        timed_wait(&m_full_cond, &m_lock, wait_usecs);
+      m_full= false;
+      mysql_mutex_unlock(&m_lock);
+    }
+    while (!m_queue.enqueue(trx))
+      my_sleep(1);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_waiting > 0)
+    {
+      timed_lock(&m_lock, wait_usecs);
+      mysql_cond_signal(&m_empty_cond);
+      mysql_mutex_unlock(&m_lock);
+    }
+    return deps;
+  }
+
+  const Bench_trx *next(ulonglong *wait_usecs)
+  {
+    const Bench_trx *trx= NULL;
+    if (!m_queue.dequeue(&trx))
+    {
+      timed_lock(&m_lock, wait_usecs);
+      for (;;)
+      {
+        ++m_waiting;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const bool found= m_queue.dequeue(&trx);
+        if (found || m_done)
+        {
+          --m_waiting;
+          break;
+        }
+        timed_wait(&m_empty_cond, &m_lock, wait_usecs);
+        --m_waiting;
+      }
+      mysql_mutex_unlock(&m_lock);
+    }
+
+    if (trx && m_full && m_queue.size() < queue_size * 60 / 100)
+    {
+      timed_lock(&m_lock, wait_usecs);
+      mysql_cond_signal(&m_full_cond);
+      mysql_mutex_unlock(&m_lock);
+    }
+    return trx;
+  }
+
+  void finalize(const Bench_trx *trx, ulonglong *)
+  {
+    const ulonglong id= trx->id;
+    for (uint k= 0; k < keys_per_trx; k++)
+      m_lookup.erase_if(trx->keys[k],
+                        [id](ulonglong last) { return last == id; });
+  }
+
+  void done()
+  {
+    mysql_mutex_lock(&m_lock);
+    m_done= true;
+    mysql_cond_broadcast(&m_empty_cond);
+    mysql_mutex_unlock(&m_lock);
+  }
+
+private:
+  Dependency_queue<const Bench_trx*> m_queue;
+  Dependency_key_map<ulonglong, ulonglong> m_lookup;
+  mysql_mutex_t m_lock;
+  mysql_cond_t m_empty_cond;
+  mysql_cond_t m_full_cond;
+  std::atomic<ulonglong> m_waiting;
+  std::atomic<bool> m_full;
+  std::atomic<bool> m_done;
+};
+
+
+template <typename State>
+class Worker_thread : public Thread
+{
+public:
+  Worker_thread(Notification *go, State *state)
+    : m_go(go), m_state(state), m_applied(0), m_wait_usecs(0)
+  {}
+
+  virtual void run()
+  {
+    m_go->wait_for_notification();
+    while (const Bench_trx *trx= m_state->next(&m_wait_usecs))
+    {
+      m_state->finalize(trx, &m_wait_usecs);
+      m_applied++;
+    }
+  }
+
+  ulonglong applied() { return m_applied; }
+  ulonglong wait_usecs() { return m_wait_usecs; }
+
+private:
+  Notification *m_go;
+  State *m_state;
+  ulonglong m_applied;
+  ulonglong m_wait_usecs;
+};
+
+
+class DependencyQueueTest : public ::testing::TestWithParam<uint>
+{
+protected:
+  virtual void SetUp()
+  {
+    nworkers= GetParam();
+  }
+
+  /* Replay the stream on nworkers workers, the caller is the coordinator */
+  template <typename State>
+  void replay(const char *name, const std::vector<Bench_trx> &stream)
+  {
+    State state;
+    Notification go;
+    std::vector<Worker_thread<State>*> workers;
+    ulonglong wait_usecs= 0;
+
+    for (uint i= 0; i < nworkers; i++)
+    {
+      workers.push_back(new Worker_thread<State>(&go, &state));
+      workers.back()->start();
+    }
+
+    const ulonglong start= my_micro_time();
+    go.notify();
+    for (ulonglong i= 0; i < stream.size(); i++)
+      state.schedule(&stream[i], &wait_usecs);
+    state.done();
+
+    ulonglong applied= 0;
+    for (uint i= 0; i < nworkers; i++)
+    {
+      workers[i]->join();
+      applied+= workers[i]->applied();
+      wait_usecs+= workers[i]->wait_usecs();
+      delete workers[i];
+    }
+    const ulonglong usecs= my_micro_time() - start;
+
+    printf("# %-10s %3u workers: %10.0f trx/s %8.2f usec wait/trx\n",
+           name, nworkers, usecs ? stream.size() * 1000000.0 / usecs : 0.0,
+           (double) wait_usecs / stream.size());
+    EXPECT_EQ(stream.size(), applied);
+  }
+
+  uint nworkers;
+};
+
+INSTANTIATE_TEST_CASE_P(Workers, DependencyQueueTest,
+                        ::testing::Values(8U, 16U, 32U, 64U));
+
+
+TEST_P(DependencyQueueTest, DISABLED_ApplyBench)
+{
+  std::vector<Bench_trx> stream;
+  make_stream(&stream);
+
+  replay<Locked_state>("locked", stream);
+  replay<Lock_free_state>("lock-free", stream);
+}
+
+
+class Ring_thread : public Thread
+{
+public:
+  Ring_thread(Dependency_queue<ulonglong> *ring, bool producer,
+              ulonglong first, ulonglong count,
+              std::vector<std::atomic<uint>> *seen)
+    : m_ring(ring), m_producer(producer), m_first(first), m_count(count),
+      m_seen(seen)
+  {}
+
+  virtual void run()
+  {
+    for (ulonglong i= 0; i < m_count; i++)
+    {
+      if (m_producer)
+      {
+        while (!m_ring->enqueue(m_first + i))
+          my_sleep(1);
+      }
+      else
+      {
+        ulonglong value;
+        while (!m_ring->dequeue(&value))
+          my_sleep(1);
+        (*m_seen)[value]++;
+      }
+    }
+  }
+
+private:
+  Dependency_queue<ulonglong> *m_ring;
+  bool m_producer;
+  ulonglong m_first;
+  ulonglong m_count;
+  std::vector<std::atomic<uint>> *m_seen;
+};
+
+
+TEST(DependencyQueue, EveryElementOnce)
+{
+  const uint nthreads= 4;
+  const ulonglong per_thread= 1 << 16;
+  Dependency_queue<ulonglong> ring;
+  std::vector<std::atomic<uint>> seen(nthreads * per_thread);
+  std::vector<Ring_thread*> threads;
+
+  EXPECT_FALSE(ring.init(60));
+  EXPECT_EQ(64U, ring.capacity());
+  for (ulonglong i= 0; i < seen.size(); i++)
+    seen[i]= 0;
+
+  for (uint i= 0; i < nthreads; i++)
+  {
+    threads.push_back(new Ring_thread(&ring, true, i * per_thread,
+                                      per_thread, &seen));
+    threads.push_back(new Ring_thread(&ring, false, 0, per_thread, &seen));
+  }
+  for (uint i= 0; i < threads.size(); i++)
+    threads[i]->start();
+  for (uint i= 0; i < threads.size(); i++)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+
+  EXPECT_TRUE(ring.empty());
+  for (ulonglong i= 0; i < seen.size(); i++)
+    EXPECT_EQ(1U, seen[i].load()) << "element " << i;
+}
+
+
+TEST(DependencyQueue, FullAndEmpty)
+{
+  Dependency_queue<ulonglong> ring;
+  ulonglong value;
+
+  EXPECT_FALSE(ring.dequeue(&value));
+  EXPECT_FALSE(ring.init(4));
+  for (ulonglong i= 1; i <= 4; i++)
+    EXPECT_TRUE(ring.enqueue(i));
+  EXPECT_FALSE(ring.enqueue(5));
+  EXPECT_EQ(4U, ring.size());
+
+  for (ulonglong i= 1; i <= 4; i++)
+  {
+    EXPECT_TRUE(ring.dequeue(&value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_FALSE(ring.dequeue(&value));
+  EXPECT_TRUE(ring.empty());
+}
+
+
+TEST(DependencyKeyMap, EraseOnlyOwnValue)
+{
+  Dependency_key_map<ulonglong, ulonglong> map;
+  ulonglong value;
+
+  EXPECT_TRUE(map.empty());
+  map.set(1, 10);
+  map.set(2, 10);
+  map.set(2, 20);
+  EXPECT_TRUE(map.find(2, &value));
+  EXPECT_EQ(20U, value);
+
+  // trx 10 is done, key 2 belongs to trx 20 now
+  map.erase_if(1, [](ulonglong v) { return v == 10; });
+  map.erase_if(2, [](ulonglong v) { return v == 10; });
+  EXPECT_FALSE(map.find(1, &value));
+  EXPECT_TRUE(map.find(2, &value));
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+}
+
+}  // namespace dependency_queue_unittest
@@ -16,9 +16,12 @@
 // First include (the generated) my_config.h, to get correct platform defines.
 #include "my_config.h"
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "filesort_utils.h"
+#include "sql_sort.h"
 #include "table.h"
 
 namespace filesort_buffer_unittest {
@@ -86,4 +89,120 @@ TEST_F(FileSortBufferTest, AssignmentOperator)
 }
 
 
+class Int_runs_compare
+{
+public:
+  Int_runs_compare(const std::vector<std::vector<int> > *runs,
+                   const std::vector<size_t> *pos)
+    : m_runs(runs), m_pos(pos)
+  {}
+
+  int operator()(uint a, uint b) const
+  {
+    const int x= (*m_runs)[a][(*m_pos)[a]];
+    const int y= (*m_runs)[b][(*m_pos)[b]];
+    return x < y ? -1 : (x > y ? 1 : 0);
+  }
+
+private:
+  const std::vector<std::vector<int> > *m_runs;
+  const std::vector<size_t> *m_pos;
+};
+
+
+TEST_F(FileSortBufferTest, LoserTree)
+{
+  for (uint num_runs= 1; num_runs <= 9; num_runs++)
+  {
+    std::vector<std::vector<int> > runs(num_runs);
+    std::vector<int> expected;
+    for (uint i= 0; i < num_runs; i++)
+    {
+      for (uint j= 0; j <= (i * 7) % 5; j++)
+        runs[i].push_back((int) ((i * 13 + j * 5) % 11));
+      std::sort(runs[i].begin(), runs[i].end());
+      expected.insert(expected.end(), runs[i].begin(), runs[i].end());
+    }
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<size_t> pos(num_runs, 0);
+    std::vector<int> merged;
+    Loser_tree<Int_runs_compare> tree(Int_runs_compare(&runs, &pos));
+    tree.init(num_runs);
+    while (tree.active() > 0)
+    {
+      const uint run= tree.top();
+      merged.push_back(runs[run][pos[run]++]);
+      if (pos[run] == runs[run].size())
+        tree.remove_top();
+      else
+        tree.replace_top();
+    }
+    EXPECT_EQ(expected, merged);
+  }
+}
+
+
+/*
+  Keys are a sort_length prefix of few distinct values followed by the
+  input position, so the order of equal keys shows if the sort is stable.
+*/
+class ParallelSortTest : public FileSortBufferTest,
+                         public ::testing::WithParamInterface<uint>
+{
+protected:
+  static void SetUpTestCase() { filesort_workers_init(); }
+  static void TearDownTestCase() { filesort_workers_end(); }
+
+  void sort_and_check(uint sort_threads, uint count)
+  {
+    const uint sort_length= GetParam();
+    const uint record_length= sort_length + sizeof(uint);
+    fs_info.alloc_sort_buffer(count, record_length);
+    for (uint ix= 0; ix < count; ++ix)
+    {
+      uchar *record= fs_info.get_record_buffer(ix);
+      memset(record, 0, sort_length);
+      record[sort_length - 1]= (uchar) ((ix * 2654435761U) >> 24) % 37;
+      memcpy(record + sort_length, &ix, sizeof(ix));
+    }
+
+    Sort_param param;
+    param.sort_length= sort_length;
+    param.sort_threads= sort_threads;
+    fs_info.sort_buffer(&param, count);
+
+    uchar **keys= fs_info.get_sort_keys();
+    uint failures= 0;
+    for (uint ix= 1; ix < count; ++ix)
+    {
+      const int res= memcmp(keys[ix - 1], keys[ix], sort_length);
+      uint prev, cur;
+      memcpy(&prev, keys[ix - 1] + sort_length, sizeof(prev));
+      memcpy(&cur, keys[ix] + sort_length, sizeof(cur));
+      if (res > 0 || (res == 0 && prev >= cur))
+        failures++;
+    }
+    EXPECT_EQ(0U, failures);
+  }
+};
+
+INSTANTIATE_TEST_CASE_P(SortLength, ParallelSortTest,
+                        ::testing::Values(2U, 24U));
+
+
+TEST_P(ParallelSortTest, Serial)
+{
+  sort_and_check(1, 4 * FILESORT_MIN_KEYS_PER_THREAD);
+}
+
+
+TEST_P(ParallelSortTest, Parallel)
+{
+  sort_and_check(4, 4 * FILESORT_MIN_KEYS_PER_THREAD);
+  fs_info.free_sort_buffer();
+  // Too few keys for every thread, some of them are left out.
+  sort_and_check(8, 3 * FILESORT_MIN_KEYS_PER_THREAD + 1);
+}
+
 }  // namespace
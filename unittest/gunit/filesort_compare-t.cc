@@ -323,6 +323,15 @@ TEST_F(FileSortCompareTest, RadixSort)
   }
 }
 
+TEST_F(FileSortCompareTest, PrefixedSort)
+{
+  for (int ix= 0; ix < num_iterations; ++ix)
+  {
+    std::vector<uchar*> keys(sort_keys, sort_keys + num_records);
+    EXPECT_FALSE(sort_prefixed_keys(&keys[0], num_records, record_size));
+  }
+}
+
 TEST_F(FileSortCompareTest, MyQsort)
 {
   size_t size= record_size;
@@ -463,4 +472,84 @@ TEST_F(FileSortCompareTest, DISABLED_StdStableSortIntIntIntInt)
   }
 }
 
+/*
+  Benchmark of the sort of filesort buffers, with keys of several widths
+  and row counts: the sort of the pointers to the keys, with radixsort
+  when it is appliccable and std::stable_sort otherwise, against
+  sort_prefixed_keys(). Many keys share their first bytes, so that the
+  prefixes do not decide every comparison. Only the small sorts of the
+  correctness check run by default.
+*/
+class FileSortPrefixBench : public ::testing::Test
+{
+protected:
+  void run(uint key_width, uint num_rows, bool report)
+  {
+    std::vector<uchar> records(static_cast<size_t>(key_width) * num_rows);
+    std::vector<uchar*> keys(num_rows);
+    uint32 seed= 42;
+    for (uint ix= 0; ix < num_rows; ++ix)
+    {
+      uchar *key= &records[static_cast<size_t>(key_width) * ix];
+      for (uint iy= 0; iy < key_width; ++iy)
+      {
+        seed= seed * 1103515245 + 12345;
+        key[iy]= static_cast<uchar>(seed >> 16);
+      }
+      // Half of the keys start with one of a few values.
+      if (ix % 2 == 0)
+        memset(key, ix % 7, std::min(key_width, 6U));
+      keys[ix]= key;
+    }
+
+    std::vector<uchar*> pointer_keys(keys);
+    ulonglong start= my_micro_time();
+    std::pair<uchar**, ptrdiff_t> buffer(NULL, 0);
+    if (radixsort_is_appliccable(num_rows, key_width) &&
+        (buffer= std::get_temporary_buffer<uchar*>(num_rows)).second ==
+        static_cast<ptrdiff_t>(num_rows))
+      radixsort_for_str_ptr(&pointer_keys[0], num_rows, key_width,
+                            buffer.first);
+    else
+      std::stable_sort(pointer_keys.begin(), pointer_keys.end(),
+                       Mem_compare_memcmp(key_width));
+    std::return_temporary_buffer(buffer.first);
+    const ulonglong pointer_usecs= my_micro_time() - start;
+
+    std::vector<uchar*> prefixed_keys(keys);
+    start= my_micro_time();
+    EXPECT_FALSE(sort_prefixed_keys(&prefixed_keys[0], num_rows, key_width));
+    const ulonglong prefixed_usecs= my_micro_time() - start;
+
+    // Both sorts are stable.
+    EXPECT_TRUE(pointer_keys == prefixed_keys);
+    if (report)
+      printf("# %3u byte keys %8u rows: pointers %9.3f ms, "
+             "prefixed %9.3f ms\n", key_width, num_rows,
+             pointer_usecs / 1000.0, prefixed_usecs / 1000.0);
+  }
+};
+
+
+static const uint bench_key_widths[]= { 4, 8, 16, 64 };
+
+
+// Both sorts give the same order, without timing them.
+TEST_F(FileSortPrefixBench, SameOrder)
+{
+  for (int ix= 0; ix < array_size(bench_key_widths); ++ix)
+    run(bench_key_widths[ix], 5000, false);
+}
+
+
+TEST_F(FileSortPrefixBench, DISABLED_KeyWidthsAndRows)
+{
+  static const uint row_counts[]= { 1000, 50000, 1000000 };
+  for (int ix= 0; ix < array_size(bench_key_widths); ++ix)
+  {
+    for (int iy= 0; iy < array_size(row_counts); ++iy)
+      run(bench_key_widths[ix], row_counts[iy], true);
+  }
+}
+
 }  // namespace
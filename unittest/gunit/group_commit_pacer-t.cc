@@ -0,0 +1,96 @@
+/* Copyright (c) 2016, Facebook, Inc. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include "binlog.h"
+
+/*
+  Tests of the sizing of the binlog sync stage groups by
+  Group_commit_pacer.
+*/
+
+namespace group_commit_pacer_unittest {
+
+/* Feed the pacer rounds of groups of count sessions every period_usecs. */
+static void steady_load(Group_commit_pacer *pacer, uint rounds,
+                        ulonglong period_usecs, uint count,
+                        ulonglong fsync_usecs)
+{
+  ulonglong now= 1000000;
+  for (uint i= 0; i < rounds; i++)
+  {
+    pacer->record_group(now, count);
+    pacer->record_fsync(fsync_usecs);
+    now+= period_usecs;
+  }
+}
+
+
+TEST(GroupCommitPacerTest, NoSamples)
+{
+  Group_commit_pacer pacer;
+  EXPECT_EQ(0U, pacer.get_delay(0, 1000));
+
+  // A single group tells nothing about the arrival rate yet
+  pacer.record_group(1000000, 10);
+  pacer.record_fsync(1000);
+  EXPECT_EQ(0U, pacer.get_delay(0, 1000));
+}
+
+
+TEST(GroupCommitPacerTest, BusyServerWaits)
+{
+  Group_commit_pacer pacer;
+  // 10 sessions per ms and 1ms fsyncs: 100us between sessions
+  steady_load(&pacer, 100, 1000, 10, 1000);
+
+  EXPECT_EQ(800U, pacer.get_delay(2, 10000));
+  EXPECT_EQ(500U, pacer.get_delay(2, 500));
+  // Disabled
+  EXPECT_EQ(0U, pacer.get_delay(2, 0));
+  // All the sessions of one fsync are queued already
+  EXPECT_EQ(0U, pacer.get_delay(10, 10000));
+}
+
+
+TEST(GroupCommitPacerTest, IdleServerDoesNotWait)
+{
+  Group_commit_pacer pacer;
+  // One session every 10ms, fsyncs of 1ms
+  steady_load(&pacer, 100, 10000, 1, 1000);
+  EXPECT_EQ(0U, pacer.get_delay(0, 10000));
+  EXPECT_EQ(0U, pacer.get_delay(1, 10000));
+}
+
+
+TEST(GroupCommitPacerTest, AdaptsToLoad)
+{
+  Group_commit_pacer pacer;
+  steady_load(&pacer, 100, 10000, 1, 1000);
+  EXPECT_EQ(0U, pacer.get_delay(1, 10000));
+
+  // The load goes up, the pacer starts to batch
+  steady_load(&pacer, 100, 1000, 10, 1000);
+  EXPECT_LT(0U, pacer.get_delay(1, 10000));
+
+  // Faster disk, fewer sessions to wait for
+  steady_load(&pacer, 100, 1000, 10, 100);
+  EXPECT_EQ(0U, pacer.get_delay(1, 10000));
+}
+
+}  // namespace group_commit_pacer_unittest
@@ -425,6 +425,78 @@ TEST_F(MDLTest, SharedLocksBetweenContexts)
 
   m_mdl_context.release_transactional_locks();
   mdl_context2.release_transactional_locks();
+  mdl_context2.destroy();
+}
+
+
+/*
+  Verifies that a shared lock granted on the fast path in one context
+  blocks an exclusive lock in another one, and that shared locks are
+  not granted on the fast path while the exclusive lock is held.
+ */
+TEST_F(MDLTest, FastPathConflictsBetweenContexts)
+{
+  MDL_context  mdl_context2;
+  mdl_context2.init(this);
+  MDL_request request_2;
+  MDL_request global_request_2;
+  m_request.init(MDL_key::TABLE, db_name, table_name1, MDL_SHARED_READ,
+                 MDL_TRANSACTION);
+  request_2.init(MDL_key::TABLE, db_name, table_name1, MDL_EXCLUSIVE,
+                 MDL_TRANSACTION);
+  global_request_2.init(MDL_key::GLOBAL, "", "", MDL_INTENTION_EXCLUSIVE,
+                        MDL_TRANSACTION);
+
+  EXPECT_FALSE(m_mdl_context.try_acquire_lock(&m_request));
+  ASSERT_NE(m_null_ticket, m_request.ticket);
+
+  EXPECT_FALSE(mdl_context2.try_acquire_lock(&global_request_2));
+  ASSERT_NE(m_null_ticket, global_request_2.ticket);
+  EXPECT_FALSE(mdl_context2.try_acquire_lock(&request_2));
+  EXPECT_EQ(m_null_ticket, request_2.ticket);
+
+  m_mdl_context.release_transactional_locks();
+  m_request.ticket= NULL;
+  EXPECT_FALSE(mdl_context2.try_acquire_lock(&request_2));
+  ASSERT_NE(m_null_ticket, request_2.ticket);
+
+  EXPECT_FALSE(m_mdl_context.try_acquire_lock(&m_request));
+  EXPECT_EQ(m_null_ticket, m_request.ticket);
+
+  mdl_context2.release_transactional_locks();
+  EXPECT_FALSE(m_mdl_context.try_acquire_lock(&m_request));
+  EXPECT_NE(m_null_ticket, m_request.ticket);
+
+  m_mdl_context.release_transactional_locks();
+  mdl_context2.destroy();
+}
+
+
+/*
+  Verifies that a shared lock granted on the fast path does not block
+  an exclusive lock on the same table in the same context.
+ */
+TEST_F(MDLTest, FastPathOwnLockDoesNotConflict)
+{
+  MDL_request request_2;
+  m_request.init(MDL_key::TABLE, db_name, table_name1, MDL_SHARED_WRITE,
+                 MDL_TRANSACTION);
+  request_2.init(MDL_key::TABLE, db_name, table_name1, MDL_EXCLUSIVE,
+                 MDL_TRANSACTION);
+
+  EXPECT_FALSE(m_mdl_context.try_acquire_lock(&m_request));
+  ASSERT_NE(m_null_ticket, m_request.ticket);
+  EXPECT_FALSE(m_mdl_context.try_acquire_lock(&m_global_request));
+  ASSERT_NE(m_null_ticket, m_global_request.ticket);
+
+  EXPECT_FALSE(m_mdl_context.try_acquire_lock(&request_2));
+  ASSERT_NE(m_null_ticket, request_2.ticket);
+  EXPECT_TRUE(m_mdl_context.
+              is_lock_owner(MDL_key::TABLE, db_name, table_name1,
+                            MDL_EXCLUSIVE));
+
+  m_mdl_context.release_transactional_locks();
+  EXPECT_FALSE(m_mdl_context.has_locks());
 }
 
 
@@ -0,0 +1,303 @@
+/* Copyright (c) 2016, Facebook, Inc. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+// First include (the generated) my_config.h, to get correct platform defines.
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "my_sys.h"
+#include "bench_utils.h"
+#include "shardedlocks.h"
+
+/*
+  Tests and contention benchmark for the per-CPU sharded primitives in
+  shardedlocks.h.
+
+  Every benchmark does the same total amount of work split over 1, 16,
+  64 and 128 threads, once with the single instance primitive and once
+  with the sharded one. It checks that no update got lost and prints the
+  throughput of both as TAP comments.
+*/
+
+namespace sharded_locks_unittest {
+
+using my_testing::Bench_op;
+using my_testing::bench_report;
+using my_testing::bench_thread_counts;
+using my_testing::run_threads;
+
+const ulonglong total_ops= 1 << 20;
+
+/* Work of the correctness tests, which run by default. */
+const ulonglong check_ops= 1 << 14;
+const uint check_threads= 4;
+
+/* Every write_interval-th operation of the rwlock tests is a write. */
+const ulonglong write_interval= 64;
+
+struct MY_ALIGNED(CPU_LEVEL1_DCACHE_LINESIZE) Padded_counter
+{
+  ulonglong value;
+};
+
+static uint bench_shards()
+{
+  return std::min((uint) my_getncpus(), (uint) MAX_CPU_SHARDS);
+}
+
+
+class Mutex_op : public Bench_op
+{
+public:
+  Mutex_op() : m_count(0) { mysql_mutex_init(0, &m_mutex, MY_MUTEX_INIT_FAST); }
+  ~Mutex_op() { mysql_mutex_destroy(&m_mutex); }
+
+  void operator()(ulonglong)
+  {
+    mysql_mutex_lock(&m_mutex);
+    m_count++;
+    mysql_mutex_unlock(&m_mutex);
+  }
+
+  ulonglong total() { return m_count; }
+
+private:
+  mysql_mutex_t m_mutex;
+  ulonglong m_count;
+};
+
+
+class Sharded_mutex_op : public Bench_op
+{
+public:
+  Sharded_mutex_op()
+  {
+    m_mutex.init(
+#ifdef HAVE_PSI_INTERFACE
+                 0,
+#endif
+                 bench_shards());
+    memset(m_counts, 0, sizeof(m_counts));
+  }
+  ~Sharded_mutex_op() { m_mutex.destroy(); }
+
+  void operator()(ulonglong)
+  {
+    uint shard= m_mutex.lock();
+    m_counts[shard].value++;
+    m_mutex.unlock(shard);
+  }
+
+  ulonglong total()
+  {
+    ulonglong sum= 0;
+    m_mutex.lock_all();
+    for (uint i= 0; i < m_mutex.size(); i++)
+      sum+= m_counts[i].value;
+    m_mutex.unlock_all();
+    return sum;
+  }
+
+private:
+  ShardedMutex m_mutex;
+  Padded_counter m_counts[MAX_CPU_SHARDS];
+};
+
+
+class Rwlock_op : public Bench_op
+{
+public:
+  Rwlock_op() : m_writes(0) { mysql_rwlock_init(0, &m_lock); }
+  ~Rwlock_op() { mysql_rwlock_destroy(&m_lock); }
+
+  void operator()(ulonglong i)
+  {
+    if (i % write_interval == 0)
+    {
+      mysql_rwlock_wrlock(&m_lock);
+      m_writes++;
+      mysql_rwlock_unlock(&m_lock);
+    }
+    else
+    {
+      mysql_rwlock_rdlock(&m_lock);
+      m_last_read= m_writes;
+      mysql_rwlock_unlock(&m_lock);
+    }
+  }
+
+  ulonglong writes() { return m_writes; }
+
+private:
+  mysql_rwlock_t m_lock;
+  ulonglong m_writes;
+  /* Readers store here so that the read cannot be optimized away. */
+  volatile ulonglong m_last_read;
+};
+
+
+class Sharded_rwlock_op : public Bench_op
+{
+public:
+  Sharded_rwlock_op() : m_writes(0)
+  {
+    m_lock.init(
+#ifdef HAVE_PSI_INTERFACE
+                0,
+#endif
+                bench_shards());
+  }
+  ~Sharded_rwlock_op() { m_lock.destroy(); }
+
+  void operator()(ulonglong i)
+  {
+    if (i % write_interval == 0)
+    {
+      m_lock.wrlock();
+      m_writes++;
+      m_lock.wrunlock();
+    }
+    else
+    {
+      uint shard= m_lock.rdlock();
+      m_last_read= m_writes;
+      m_lock.rdunlock(shard);
+    }
+  }
+
+  ulonglong writes() { return m_writes; }
+
+private:
+  ShardedRWLock m_lock;
+  ulonglong m_writes;
+  volatile ulonglong m_last_read;
+};
+
+
+class Counter_op : public Bench_op
+{
+public:
+  Counter_op() : m_count(0) {}
+
+  void operator()(ulonglong)
+  {
+    m_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  ulonglong total() { return m_count.load(); }
+
+private:
+  std::atomic<ulonglong> m_count;
+};
+
+
+class Sharded_counter_op : public Bench_op
+{
+public:
+  Sharded_counter_op() { m_count.reset(); }
+
+  void operator()(ulonglong) { m_count.inc(); }
+
+  ulonglong total() { return m_count.sum(); }
+
+private:
+  ShardedCounter m_count;
+};
+
+
+/* Expected writes of the rwlock operations for ops split over nthreads */
+static ulonglong expected_writes(ulonglong ops, uint nthreads)
+{
+  return nthreads * ((ops / nthreads + write_interval - 1) / write_interval);
+}
+
+
+TEST(ShardedLocksTest, NoLostUpdates)
+{
+  Sharded_mutex_op mutex;
+  run_threads(&mutex, check_threads, check_ops);
+  EXPECT_EQ(check_ops, mutex.total());
+
+  Sharded_rwlock_op rwlock;
+  run_threads(&rwlock, check_threads, check_ops);
+  EXPECT_EQ(expected_writes(check_ops, check_threads), rwlock.writes());
+
+  Sharded_counter_op counter;
+  run_threads(&counter, check_threads, check_ops);
+  EXPECT_EQ(check_ops, counter.total());
+}
+
+
+class ShardedLocksBench : public ::testing::TestWithParam<uint>
+{
+protected:
+  virtual void SetUp()
+  {
+    nthreads= GetParam();
+  }
+
+  template <typename Op>
+  void run(const char *primitive, Op *op)
+  {
+    bench_report(primitive, nthreads, total_ops,
+                 run_threads(op, nthreads, total_ops));
+  }
+
+  uint nthreads;
+};
+
+INSTANTIATE_TEST_CASE_P(Threads, ShardedLocksBench,
+                        ::testing::ValuesIn(bench_thread_counts));
+
+
+TEST_P(ShardedLocksBench, DISABLED_Mutex)
+{
+  Mutex_op plain;
+  run("mutex", &plain);
+  EXPECT_EQ(total_ops, plain.total());
+
+  Sharded_mutex_op sharded;
+  run("sharded mutex", &sharded);
+  EXPECT_EQ(total_ops, sharded.total());
+}
+
+
+TEST_P(ShardedLocksBench, DISABLED_RWLock)
+{
+  Rwlock_op plain;
+  run("rwlock", &plain);
+  EXPECT_EQ(expected_writes(total_ops, nthreads), plain.writes());
+
+  Sharded_rwlock_op sharded;
+  run("sharded rwlock", &sharded);
+  EXPECT_EQ(expected_writes(total_ops, nthreads), sharded.writes());
+}
+
+
+TEST_P(ShardedLocksBench, DISABLED_Counter)
+{
+  Counter_op plain;
+  run("atomic counter", &plain);
+  EXPECT_EQ(total_ops, plain.total());
+
+  Sharded_counter_op sharded;
+  run("sharded counter", &sharded);
+  EXPECT_EQ(total_ops, sharded.total());
+}
+
+}  // namespace sharded_locks_unittest
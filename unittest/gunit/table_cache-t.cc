@@ -17,6 +17,9 @@
 #include "my_config.h"
 #include <gtest/gtest.h>
 #include "test_utils.h"
+#include "bench_utils.h"
+
+#include <vector>
 
 #include "table_cache.h"
 
@@ -31,6 +34,10 @@ extern handlerton *example_hton;
 namespace table_cache_unittest {
 
 using my_testing::Server_initializer;
+using my_testing::Bench_op;
+using my_testing::bench_report;
+using my_testing::bench_thread_counts;
+using my_testing::run_threads;
 
 
 /**
@@ -111,6 +118,22 @@ protected:
 };
 
 
+/**
+  Fixture with as many Table_cache instances as there are CPUs, so
+  that every connection opens tables in the instance of its CPU.
+*/
+
+class TableCacheCpuCacheTest : public TableCacheSingleCacheTest
+{
+protected:
+  virtual uint CachesNumber()
+  {
+    return std::min((uint) my_getncpus(),
+                    (uint) Table_cache_manager::MAX_TABLE_CACHES);
+  }
+};
+
+
 /**
   Class for mock TABLE_SHARE object which also allows to create
   associated TABLE objects which are usable with Table_cache.
@@ -251,12 +274,12 @@ TEST_F(TableCacheBasicDeathTest, ManagerCreateAndDestroy)
 
   // There should be two different caches in the manager
   Table_cache *cache_1, *cache_2, *cache_3;
-  cache_1= table_cache_manager.get_cache(get_thd(0));
-  cache_2= table_cache_manager.get_cache(get_thd(1));
-  cache_3= table_cache_manager.get_cache(get_thd(2));
+  cache_1= table_cache_manager.get_cache(0U);
+  cache_2= table_cache_manager.get_cache(1U);
   EXPECT_TRUE(cache_1 != cache_2);
-  // And not three !
-  EXPECT_TRUE(cache_3 == cache_1);
+  // And connections get one of them, picked by the CPU they run on
+  cache_3= table_cache_manager.get_cache(get_thd(2));
+  EXPECT_TRUE(cache_3 == cache_1 || cache_3 == cache_2);
 
   // Both caches should be empty
   EXPECT_EQ(0U, cache_1->cached_tables());
@@ -563,8 +586,8 @@ TEST_F(TableCacheDoubleCacheTest, ManagerFreeAllUnused)
   THD *thd_1= get_thd(0);
   THD *thd_2= get_thd(1);
 
-  Table_cache *table_cache_1= table_cache_manager.get_cache(thd_1);
-  Table_cache *table_cache_2= table_cache_manager.get_cache(thd_2);
+  Table_cache *table_cache_1= table_cache_manager.get_cache(0U);
+  Table_cache *table_cache_2= table_cache_manager.get_cache(1U);
 
   // There should be no TABLE instances in all cachea.
   EXPECT_EQ(0U, table_cache_manager.cached_tables());
@@ -651,8 +674,8 @@ TEST_F(TableCacheDoubleCacheTest, ManagerCachedTables)
   THD *thd_1= get_thd(0);
   THD *thd_2= get_thd(1);
 
-  Table_cache *table_cache_1= table_cache_manager.get_cache(thd_1);
-  Table_cache *table_cache_2= table_cache_manager.get_cache(thd_2);
+  Table_cache *table_cache_1= table_cache_manager.get_cache(0U);
+  Table_cache *table_cache_2= table_cache_manager.get_cache(1U);
 
   // There should be no TABLE instances in all cachea.
   EXPECT_EQ(0U, table_cache_1->cached_tables());
@@ -727,6 +750,47 @@ TEST_F(TableCacheDoubleCacheTest, ManagerCachedTables)
 }
 
 
+/*
+  Test that TABLE objects go back to the Table_cache instance which
+  holds them, whatever instance their connection would pick now.
+*/
+
+TEST_F(TableCacheDoubleCacheTest, ManagerGetCacheOfTable)
+{
+  THD *thd= get_thd(0);
+
+  Table_cache *table_cache_1= table_cache_manager.get_cache(0U);
+  Table_cache *table_cache_2= table_cache_manager.get_cache(1U);
+
+  Mock_share share_1("share_1");
+  TABLE *table_1= share_1.create_table(thd);
+  TABLE *table_2= share_1.create_table(thd);
+
+  table_cache_manager.lock_all_and_tdc();
+
+  table_cache_1->add_used_table(thd, table_1);
+  table_cache_2->add_used_table(thd, table_2);
+
+  EXPECT_TRUE(table_cache_manager.get_cache(table_1) == table_cache_1);
+  EXPECT_TRUE(table_cache_manager.get_cache(table_2) == table_cache_2);
+
+  // Released TABLE objects stay in the instance which holds them
+  table_cache_manager.get_cache(table_2)->release_table(thd, table_2);
+  EXPECT_EQ(1U, table_cache_1->cached_tables());
+  EXPECT_EQ(1U, table_cache_2->cached_tables());
+
+  table_cache_manager.get_cache(table_1)->remove_table(table_1);
+  table_cache_manager.get_cache(table_2)->remove_table(table_2);
+
+  EXPECT_EQ(0U, table_cache_manager.cached_tables());
+
+  table_cache_manager.unlock_all_and_tdc();
+
+  share_1.destroy_table(table_1);
+  share_1.destroy_table(table_2);
+}
+
+
 /*
   Coverage for lock and unlock methods of Table_cache_manager class.
 */
@@ -748,8 +812,8 @@ TEST_F(TableCacheDoubleCacheDeathTest, ManagerLockAndUnlock)
 
   // In addition to Table_cache_manager method we check this by
   // calling Table_cache methods and asserting state of LOCK_open.
-  Table_cache *cache_1= table_cache_manager.get_cache(get_thd(0));
-  Table_cache *cache_2= table_cache_manager.get_cache(get_thd(1));
+  Table_cache *cache_1= table_cache_manager.get_cache(0U);
+  Table_cache *cache_2= table_cache_manager.get_cache(1U);
 
   cache_1->assert_owner();
   cache_2->assert_owner();
@@ -776,8 +840,8 @@ TEST_F(TableCacheDoubleCacheDeathTest, ManagerFreeTable)
   THD *thd_1= get_thd(0);
   THD *thd_2= get_thd(1);
 
-  Table_cache *table_cache_1= table_cache_manager.get_cache(thd_1);
-  Table_cache *table_cache_2= table_cache_manager.get_cache(thd_2);
+  Table_cache *table_cache_1= table_cache_manager.get_cache(0U);
+  Table_cache *table_cache_2= table_cache_manager.get_cache(1U);
 
   Mock_share share_1("share_1");
   Mock_share share_2("share_2");
@@ -914,8 +978,8 @@ TEST_F(TableCacheDoubleCacheTest, Iterator)
   // Attempt to iterate behind the end should not give anything.
   EXPECT_TRUE(it++ == NULL);
 
-  Table_cache *table_cache_1= table_cache_manager.get_cache(thd_1);
-  Table_cache *table_cache_2= table_cache_manager.get_cache(thd_2);
+  Table_cache *table_cache_1= table_cache_manager.get_cache(0U);
+  Table_cache *table_cache_2= table_cache_manager.get_cache(1U);
   TABLE *table_1= share_1.create_table(thd_1);
   TABLE *table_2= share_1.create_table(thd_1);
   TABLE *table_3= share_2.create_table(thd_1);
@@ -1023,4 +1087,141 @@ TEST_F(TableCacheDoubleCacheTest, Iterator)
   share_2.destroy_table(table_5);
 }
 
+
+
+/*
+  Benchmark of opening and closing the same table from 1 to 128
+  concurrent connections, the way open_table() and close_thread_table()
+  use the table cache. Connections pick the instance of their CPU to
+  open the table and give the TABLE back to the instance which holds it.
+*/
+
+const ulonglong total_opens= 1 << 18;
+
+class Open_op : public Bench_op
+{
+public:
+  Open_op(Mock_share *share, mysql_mutex_t *share_lock)
+    : m_share(share), m_share_lock(share_lock), m_thd(NULL),
+      m_hash_value(0), m_failures(0)
+  {}
+
+  void thread_begin()
+  {
+    THD *thd= new THD(false);
+    thd->thread_stack= (char*) &thd;
+    thd->store_globals();
+    m_thd= thd;
+    m_hash_value= my_calc_hash(&table_def_cache,
+                               (uchar*) m_share->table_cache_key.str,
+                               m_share->table_cache_key.length);
+  }
+
+  void thread_end()
+  {
+    delete m_thd;
+  }
+
+  void operator()(ulonglong)
+  {
+    const char *key= m_share->table_cache_key.str;
+    const uint key_length= m_share->table_cache_key.length;
+    TABLE_SHARE *share;
+    Table_cache *tc= table_cache_manager.get_cache(m_thd);
+
+    tc->lock();
+    TABLE *table= tc->get_table(m_thd, m_hash_value, key, key_length, &share);
+    if (!table)
+    {
+      // Mock_share allocates handlers on its own MEM_ROOT.
+      mysql_mutex_lock(m_share_lock);
+      table= m_share->create_table(m_thd);
+      mysql_mutex_unlock(m_share_lock);
+      if (tc->add_used_table(m_thd, table))
+      {
+        m_failures++;
+        m_share->destroy_table(table);
+        tc->unlock();
+        return;
+      }
+      m_tables.push_back(table);
+    }
+    tc->unlock();
+
+    tc= table_cache_manager.get_cache(table);
+    tc->lock();
+    if (table->in_use != m_thd)
+      m_failures++;
+    tc->release_table(m_thd, table);
+    tc->unlock();
+  }
+
+  ulonglong failures() { return m_failures; }
+
+  /* TABLE objects this thread has added to the table cache. */
+  std::vector<TABLE*> &tables() { return m_tables; }
+
+private:
+  Mock_share *m_share;
+  mysql_mutex_t *m_share_lock;
+  THD *m_thd;
+  my_hash_value_type m_hash_value;
+  ulonglong m_failures;
+  std::vector<TABLE*> m_tables;
+};
+
+
+static void run_open_bench(const char *name)
+{
+  Mock_share share_1("share_1");
+  mysql_mutex_t share_lock;
+
+  // No TABLE objects should be freed because the cache is full.
+  table_cache_size_per_instance= 1000;
+  mysql_mutex_init(0, &share_lock, MY_MUTEX_INIT_FAST);
+
+  for (uint i= 0; i < array_elements(bench_thread_counts); i++)
+  {
+    const uint nthreads= bench_thread_counts[i];
+    std::vector<Open_op*> ops;
+    for (uint j= 0; j < nthreads; j++)
+      ops.push_back(new Open_op(&share_1, &share_lock));
+
+    bench_report(name, nthreads, total_opens,
+                 run_threads(ops, total_opens));
+
+    ulonglong failures= 0;
+    for (uint j= 0; j < nthreads; j++)
+    {
+      failures+= ops[j]->failures();
+      std::vector<TABLE*> &tables= ops[j]->tables();
+      for (size_t k= 0; k < tables.size(); k++)
+      {
+        Table_cache *tc= table_cache_manager.get_cache(tables[k]);
+        tc->lock();
+        tc->remove_table(tables[k]);
+        tc->unlock();
+        share_1.destroy_table(tables[k]);
+      }
+      delete ops[j];
+    }
+    EXPECT_EQ(0U, failures);
+    EXPECT_EQ(0U, table_cache_manager.cached_tables());
+  }
+
+  mysql_mutex_destroy(&share_lock);
+}
+
+
+TEST_F(TableCacheSingleCacheTest, DISABLED_OpenBench)
+{
+  run_open_bench("single cache");
+}
+
+
+TEST_F(TableCacheCpuCacheTest, DISABLED_OpenBench)
+{
+  run_open_bench("cache per cpu");
+}
+
 }